@@ -11,11 +11,13 @@
 #include <cfgrpt/config_report.h>
 #include <config/command_mgr.h>
 #include <dhcp/libdhcp++.h>
+#include <dhcp/packet_queue_priority.h>
 #include <dhcp4/ctrl_dhcp4_srv.h>
 #include <dhcp4/dhcp4_log.h>
 #include <dhcp4/dhcp4to6_ipc.h>
 #include <dhcp4/json_config_parser.h>
 #include <dhcp4/parser_context.h>
+#include <dhcpsrv/alloc_engine.h>
 #include <dhcpsrv/cfg_db_access.h>
 #include <dhcpsrv/cfg_multi_threading.h>
 #include <dhcpsrv/cfgmgr.h>
@@ -410,6 +412,9 @@ ControlledDhcpv4Srv::commandConfigSetHandler(const string&,
 
         // Use new configuration.
         CfgMgr::instance().commit();
+
+        // Set up the allocation engine for the new configuration.
+        configureAllocEngine();
     } else {
         // Ok, we applied the logging from the upcoming configuration, but
         // there were problems with the config. As such, we need to back off
@@ -665,6 +670,15 @@ ControlledDhcpv4Srv::commandStatusGetHandler(const string&,
         queue_stats->add(Element::create(mt_mgr.getThreadPool().getQueueStat(100)));
         queue_stats->add(Element::create(mt_mgr.getThreadPool().getQueueStat(1000)));
         status->set("packet-queue-statistics", queue_stats);
+        if (mt_mgr.getThreadPool().getAffinity()) {
+            ElementPtr affinity_counts = Element::createList();
+            for (auto count : mt_mgr.getThreadPool().getAffinityCounts()) {
+                affinity_counts->add(Element::create(static_cast<int64_t>(count)));
+            }
+            status->set("packet-queue-affinity-counts", affinity_counts);
+            status->set("packet-queue-imbalance",
+                        Element::create(mt_mgr.getThreadPool().getAffinityImbalance()));
+        }
 
     } else {
         status->set("multi-threading-enabled", Element::create(false));
@@ -848,6 +862,21 @@ ControlledDhcpv4Srv::processConfig(isc::data::ConstElementPtr config) {
         if (IfaceMgr::instance().configureDHCPPacketQueue(AF_INET, qc)) {
             LOG_INFO(dhcp4_logger, DHCP4_CONFIG_PACKET_QUEUE)
                      .arg(IfaceMgr::instance().getPacketQueue4()->getInfoStr());
+
+            // Report the drops of the priority queue to the statistics.
+            boost::shared_ptr<PacketQueuePriority4> priority_queue =
+                boost::dynamic_pointer_cast<PacketQueuePriority4>
+                (IfaceMgr::instance().getPacketQueue4());
+            if (priority_queue) {
+                priority_queue->setDropCallback(
+                    [](PacketQueuePriority4::Lane lane, uint64_t count) {
+                        StatsMgr::instance().addValue("pkt4-queue-drop-" +
+                            PacketQueuePriority4::laneToText(lane),
+                            static_cast<int64_t>(count));
+                        StatsMgr::instance().addValue("pkt4-receive-drop",
+                            static_cast<int64_t>(count));
+                    });
+            }
         }
 
     } catch (const std::exception& ex) {
@@ -856,6 +885,42 @@ ControlledDhcpv4Srv::processConfig(isc::data::ConstElementPtr config) {
         return (isc::config::createAnswer(1, err.str()));
     }
 
+    // Configure socket sharding: when enabled with multi-threading, the
+    // sockets are opened once per packet processing thread. This must be
+    // done before the sockets are reopened.
+    try {
+        bool enabled = false;
+        uint32_t thread_count = 0;
+        uint32_t queue_size = 0;
+        CfgMultiThreading::extract(CfgMgr::instance().getStagingCfg()->getDHCPMultiThreading(),
+                                   enabled, thread_count, queue_size);
+        if (enabled && !thread_count) {
+            thread_count = MultiThreadingMgr::detectThreadCount();
+        }
+        size_t shards = 1;
+        if (CfgMgr::instance().getStagingCfg()->getCfgIface()->getSocketSharding() &&
+            enabled &&
+            (thread_count > 1)) {
+            shards = thread_count;
+            if (shards > IfaceMgr::MAX_SOCKET_SHARDS) {
+                shards = IfaceMgr::MAX_SOCKET_SHARDS;
+            }
+            LOG_INFO(dhcp4_logger, DHCP4_SOCKET_SHARDS_INFO).arg(shards);
+        }
+        IfaceMgr::instance().setSocketShards(shards);
+    } catch (const std::exception& ex) {
+        err << "Error setting socket sharding after server reconfiguration: "
+            << ex.what();
+        return (isc::config::createAnswer(1, err.str()));
+    }
+
+    // Unpack the options of the queries lazily when configured. Hook
+    // libraries may walk the options of the queries directly, so they are
+    // unpacked eagerly when any library is loaded.
+    srv->setLazyOptionUnpack(
+        CfgMgr::instance().getStagingCfg()->getCfgIface()->getLazyOptionUnpack() &&
+        HooksManager::getLibraryNames().empty());
+
     // Configuration may change active interfaces. Therefore, we have to reopen
     // sockets according to new configuration. It is possible that this
     // operation will fail for some interfaces but the openSockets function
@@ -1156,6 +1221,35 @@ ControlledDhcpv4Srv::deleteExpiredReclaimedLeases(const uint32_t secs) {
     TimerMgr::instance()->setup(CfgExpiration::FLUSH_RECLAIMED_TIMER_NAME);
 }
 
+void
+ControlledDhcpv4Srv::configureAllocEngine() {
+    if (!alloc_engine_) {
+        return;
+    }
+    try {
+        SrvConfigPtr cfg = CfgMgr::instance().getCurrentCfg();
+
+        // Configure the expired leases reclamation: the leases are written
+        // by batches and reclaimed in parallel by subnet when
+        // multi-threading is enabled.
+        CfgExpirationPtr cfg_expiration = cfg->getCfgExpiration();
+        bool enabled = false;
+        uint32_t thread_count = 0;
+        uint32_t queue_size = 0;
+        CfgMultiThreading::extract(cfg->getDHCPMultiThreading(),
+                                   enabled, thread_count, queue_size);
+        alloc_engine_->setReclaimBatchSize(cfg_expiration->getReclaimBatchSize());
+        alloc_engine_->setReclaimThreads(enabled ?
+                                         cfg_expiration->getReclaimThreads() : 0);
+
+        // Fill the free lease queues from the subnets using the free lease
+        // queue allocator and the leases of the lease database.
+        alloc_engine_->initFreeLeaseQueues(cfg->getCfgSubnets4());
+    } catch (const std::exception& ex) {
+        LOG_ERROR(dhcp4_logger, DHCP4_ALLOC_ENGINE_CONFIG_FAIL).arg(ex.what());
+    }
+}
+
 bool
 ControlledDhcpv4Srv::dbLostCallback(ReconnectCtlPtr db_reconnect_ctl) {
     // Disable service until the connection is recovered.
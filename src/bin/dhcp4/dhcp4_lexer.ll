@@ -295,6 +295,42 @@ ControlCharacterFill            [^"\\]|\\["\\/bfnrtu]
     }
 }
 
+\"fd-event-handler\" {
+    switch(driver.ctx_) {
+    case isc::dhcp::Parser4Context::INTERFACES_CONFIG:
+        return isc::dhcp::Dhcp4Parser::make_FD_EVENT_HANDLER(driver.loc_);
+    default:
+        return isc::dhcp::Dhcp4Parser::make_STRING("fd-event-handler", driver.loc_);
+    }
+}
+
+\"packet-mmap\" {
+    switch(driver.ctx_) {
+    case isc::dhcp::Parser4Context::INTERFACES_CONFIG:
+        return isc::dhcp::Dhcp4Parser::make_PACKET_MMAP(driver.loc_);
+    default:
+        return isc::dhcp::Dhcp4Parser::make_STRING("packet-mmap", driver.loc_);
+    }
+}
+
+\"socket-sharding\" {
+    switch(driver.ctx_) {
+    case isc::dhcp::Parser4Context::INTERFACES_CONFIG:
+        return isc::dhcp::Dhcp4Parser::make_SOCKET_SHARDING(driver.loc_);
+    default:
+        return isc::dhcp::Dhcp4Parser::make_STRING("socket-sharding", driver.loc_);
+    }
+}
+
+\"lazy-option-unpack\" {
+    switch(driver.ctx_) {
+    case isc::dhcp::Parser4Context::INTERFACES_CONFIG:
+        return isc::dhcp::Dhcp4Parser::make_LAZY_OPTION_UNPACK(driver.loc_);
+    default:
+        return isc::dhcp::Dhcp4Parser::make_STRING("lazy-option-unpack", driver.loc_);
+    }
+}
+
 \"lease-database\" {
     switch(driver.ctx_) {
     case isc::dhcp::Parser4Context::DHCP4:
@@ -472,6 +508,42 @@ ControlCharacterFill            [^"\\]|\\["\\/bfnrtu]
     }
 }
 
+\"flush-records\" {
+    switch(driver.ctx_) {
+    case isc::dhcp::Parser4Context::LEASE_DATABASE:
+        return isc::dhcp::Dhcp4Parser::make_FLUSH_RECORDS(driver.loc_);
+    default:
+        return isc::dhcp::Dhcp4Parser::make_STRING("flush-records", driver.loc_);
+    }
+}
+
+\"flush-interval\" {
+    switch(driver.ctx_) {
+    case isc::dhcp::Parser4Context::LEASE_DATABASE:
+        return isc::dhcp::Dhcp4Parser::make_FLUSH_INTERVAL(driver.loc_);
+    default:
+        return isc::dhcp::Dhcp4Parser::make_STRING("flush-interval", driver.loc_);
+    }
+}
+
+\"write-queue-size\" {
+    switch(driver.ctx_) {
+    case isc::dhcp::Parser4Context::LEASE_DATABASE:
+        return isc::dhcp::Dhcp4Parser::make_WRITE_QUEUE_SIZE(driver.loc_);
+    default:
+        return isc::dhcp::Dhcp4Parser::make_STRING("write-queue-size", driver.loc_);
+    }
+}
+
+\"write-queue-full\" {
+    switch(driver.ctx_) {
+    case isc::dhcp::Parser4Context::LEASE_DATABASE:
+        return isc::dhcp::Dhcp4Parser::make_WRITE_QUEUE_FULL(driver.loc_);
+    default:
+        return isc::dhcp::Dhcp4Parser::make_STRING("write-queue-full", driver.loc_);
+    }
+}
+
 \"connect-timeout\" {
     switch(driver.ctx_) {
     case isc::dhcp::Parser4Context::LEASE_DATABASE:
@@ -959,6 +1031,17 @@ ControlCharacterFill            [^"\\]|\\["\\/bfnrtu]
     }
 }
 
+\"allocator\" {
+    switch(driver.ctx_) {
+    case isc::dhcp::Parser4Context::DHCP4:
+    case isc::dhcp::Parser4Context::SUBNET4:
+    case isc::dhcp::Parser4Context::SHARED_NETWORK:
+        return isc::dhcp::Dhcp4Parser::make_ALLOCATOR(driver.loc_);
+    default:
+        return isc::dhcp::Dhcp4Parser::make_STRING("allocator", driver.loc_);
+    }
+}
+
 \"disabled\" {
     switch(driver.ctx_) {
     case isc::dhcp::Parser4Context::RESERVATION_MODE:
@@ -1479,6 +1562,24 @@ ControlCharacterFill            [^"\\]|\\["\\/bfnrtu]
     }
 }
 
+\"reclaim-batch-size\" {
+    switch(driver.ctx_) {
+    case isc::dhcp::Parser4Context::EXPIRED_LEASES_PROCESSING:
+        return isc::dhcp::Dhcp4Parser::make_RECLAIM_BATCH_SIZE(driver.loc_);
+    default:
+        return isc::dhcp::Dhcp4Parser::make_STRING("reclaim-batch-size", driver.loc_);
+    }
+}
+
+\"reclaim-threads\" {
+    switch(driver.ctx_) {
+    case isc::dhcp::Parser4Context::EXPIRED_LEASES_PROCESSING:
+        return isc::dhcp::Dhcp4Parser::make_RECLAIM_THREADS(driver.loc_);
+    default:
+        return isc::dhcp::Dhcp4Parser::make_STRING("reclaim-threads", driver.loc_);
+    }
+}
+
 \"dhcp4o6-port\" {
     switch(driver.ctx_) {
     case isc::dhcp::Parser4Context::DHCP4:
@@ -1524,6 +1625,15 @@ ControlCharacterFill            [^"\\]|\\["\\/bfnrtu]
     }
 }
 
+\"client-affinity\" {
+    switch(driver.ctx_) {
+    case isc::dhcp::Parser4Context::DHCP_MULTI_THREADING:
+        return isc::dhcp::Dhcp4Parser::make_CLIENT_AFFINITY(driver.loc_);
+    default:
+        return isc::dhcp::Dhcp4Parser::make_STRING("client-affinity", driver.loc_);
+    }
+}
+
 \"control-socket\" {
     switch(driver.ctx_) {
     case isc::dhcp::Parser4Context::DHCP4:
@@ -64,6 +64,10 @@ using namespace std;
   SAME_AS_INBOUND "same-as-inbound"
   USE_ROUTING "use-routing"
   RE_DETECT "re-detect"
+  FD_EVENT_HANDLER "fd-event-handler"
+  SOCKET_SHARDING "socket-sharding"
+  LAZY_OPTION_UNPACK "lazy-option-unpack"
+  PACKET_MMAP "packet-mmap"
 
   SANITY_CHECKS "sanity-checks"
   LEASE_CHECKS "lease-checks"
@@ -101,6 +105,10 @@ using namespace std;
   TCP_KEEPALIVE "tcp-keepalive"
   TCP_NODELAY "tcp-nodelay"
   MAX_ROW_ERRORS "max-row-errors"
+  FLUSH_RECORDS "flush-records"
+  FLUSH_INTERVAL "flush-interval"
+  WRITE_QUEUE_SIZE "write-queue-size"
+  WRITE_QUEUE_FULL "write-queue-full"
 
   VALID_LIFETIME "valid-lifetime"
   MIN_VALID_LIFETIME "min-valid-lifetime"
@@ -125,6 +133,7 @@ using namespace std;
   DDNS_UPDATE_ON_RENEW "ddns-update-on-renew"
   DDNS_USE_CONFLICT_RESOLUTION "ddns-use-conflict-resolution"
   STORE_EXTENDED_INFO "store-extended-info"
+  ALLOCATOR "allocator"
   SUBNET4 "subnet4"
   SUBNET_4O6_INTERFACE "4o6-interface"
   SUBNET_4O6_INTERFACE_ID "4o6-interface-id"
@@ -191,11 +200,14 @@ using namespace std;
   MAX_RECLAIM_LEASES "max-reclaim-leases"
   MAX_RECLAIM_TIME "max-reclaim-time"
   UNWARNED_RECLAIM_CYCLES "unwarned-reclaim-cycles"
+  RECLAIM_BATCH_SIZE "reclaim-batch-size"
+  RECLAIM_THREADS "reclaim-threads"
 
   DHCP4O6_PORT "dhcp4o6-port"
 
   DHCP_MULTI_THREADING "multi-threading"
   ENABLE_MULTI_THREADING "enable-multi-threading"
+  CLIENT_AFFINITY "client-affinity"
   THREAD_POOL_SIZE "thread-pool-size"
   PACKET_QUEUE_SIZE "packet-queue-size"
 
@@ -494,6 +506,7 @@ global_param: valid_lifetime
             | t2_percent
             | cache_threshold
             | cache_max_age
+            | allocator
             | loggers
             | hostname_char_set
             | hostname_char_replacement
@@ -573,6 +586,15 @@ cache_max_age: CACHE_MAX_AGE COLON INTEGER {
     ctx.stack_.back()->set("cache-max-age", cm);
 };
 
+allocator: ALLOCATOR {
+    ctx.unique("allocator", ctx.loc2pos(@1));
+    ctx.enter(ctx.NO_KEYWORD);
+} COLON STRING {
+    ElementPtr a(new StringElement($4, ctx.loc2pos(@4)));
+    ctx.stack_.back()->set("allocator", a);
+    ctx.leave();
+};
+
 decline_probation_period: DECLINE_PROBATION_PERIOD COLON INTEGER {
     ctx.unique("decline-probation-period", ctx.loc2pos(@1));
     ElementPtr dpp(new IntElement($3, ctx.loc2pos(@3)));
@@ -743,6 +765,10 @@ interfaces_config_param: interfaces_list
                        | dhcp_socket_type
                        | outbound_interface
                        | re_detect
+                       | fd_event_handler
+                       | socket_sharding
+                       | lazy_option_unpack
+                       | packet_mmap
                        | user_context
                        | comment
                        | unknown_map_entry
@@ -800,6 +826,33 @@ re_detect: RE_DETECT COLON BOOLEAN {
     ctx.stack_.back()->set("re-detect", b);
 };
 
+fd_event_handler: FD_EVENT_HANDLER {
+    ctx.unique("fd-event-handler", ctx.loc2pos(@1));
+    ctx.enter(ctx.NO_KEYWORD);
+} COLON STRING {
+    ElementPtr h(new StringElement($4, ctx.loc2pos(@4)));
+    ctx.stack_.back()->set("fd-event-handler", h);
+    ctx.leave();
+};
+
+socket_sharding: SOCKET_SHARDING COLON BOOLEAN {
+    ctx.unique("socket-sharding", ctx.loc2pos(@1));
+    ElementPtr b(new BoolElement($3, ctx.loc2pos(@3)));
+    ctx.stack_.back()->set("socket-sharding", b);
+};
+
+lazy_option_unpack: LAZY_OPTION_UNPACK COLON BOOLEAN {
+    ctx.unique("lazy-option-unpack", ctx.loc2pos(@1));
+    ElementPtr b(new BoolElement($3, ctx.loc2pos(@3)));
+    ctx.stack_.back()->set("lazy-option-unpack", b);
+};
+
+packet_mmap: PACKET_MMAP COLON BOOLEAN {
+    ctx.unique("packet-mmap", ctx.loc2pos(@1));
+    ElementPtr b(new BoolElement($3, ctx.loc2pos(@3)));
+    ctx.stack_.back()->set("packet-mmap", b);
+};
+
 
 lease_database: LEASE_DATABASE {
     ctx.unique("lease-database", ctx.loc2pos(@1));
@@ -915,6 +968,10 @@ database_map_param: database_type
                   | consistency
                   | serial_consistency
                   | max_row_errors
+                  | flush_records
+                  | flush_interval
+                  | write_queue_size
+                  | write_queue_full
                   | unknown_map_entry
                   ;
 
@@ -1070,6 +1127,33 @@ max_row_errors: MAX_ROW_ERRORS COLON INTEGER {
     ctx.stack_.back()->set("max-row-errors", n);
 };
 
+flush_records: FLUSH_RECORDS COLON INTEGER {
+    ctx.unique("flush-records", ctx.loc2pos(@1));
+    ElementPtr n(new IntElement($3, ctx.loc2pos(@3)));
+    ctx.stack_.back()->set("flush-records", n);
+};
+
+flush_interval: FLUSH_INTERVAL COLON INTEGER {
+    ctx.unique("flush-interval", ctx.loc2pos(@1));
+    ElementPtr n(new IntElement($3, ctx.loc2pos(@3)));
+    ctx.stack_.back()->set("flush-interval", n);
+};
+
+write_queue_size: WRITE_QUEUE_SIZE COLON INTEGER {
+    ctx.unique("write-queue-size", ctx.loc2pos(@1));
+    ElementPtr n(new IntElement($3, ctx.loc2pos(@3)));
+    ctx.stack_.back()->set("write-queue-size", n);
+};
+
+write_queue_full: WRITE_QUEUE_FULL {
+    ctx.unique("write-queue-full", ctx.loc2pos(@1));
+    ctx.enter(ctx.NO_KEYWORD);
+} COLON STRING {
+    ElementPtr f(new StringElement($4, ctx.loc2pos(@4)));
+    ctx.stack_.back()->set("write-queue-full", f);
+    ctx.leave();
+};
+
 
 host_reservation_identifiers: HOST_RESERVATION_IDENTIFIERS {
     ctx.unique("host-reservation-identifiers", ctx.loc2pos(@1));
@@ -1140,6 +1224,7 @@ multi_threading_params: multi_threading_param
 multi_threading_param: enable_multi_threading
                      | thread_pool_size
                      | packet_queue_size
+                     | client_affinity
                      | user_context
                      | comment
                      | unknown_map_entry
@@ -1163,6 +1248,12 @@ packet_queue_size: PACKET_QUEUE_SIZE COLON INTEGER {
     ctx.stack_.back()->set("packet-queue-size", prf);
 };
 
+client_affinity: CLIENT_AFFINITY COLON BOOLEAN {
+    ctx.unique("client-affinity", ctx.loc2pos(@1));
+    ElementPtr b(new BoolElement($3, ctx.loc2pos(@3)));
+    ctx.stack_.back()->set("client-affinity", b);
+};
+
 hooks_libraries: HOOKS_LIBRARIES {
     ctx.unique("hooks-libraries", ctx.loc2pos(@1));
     ElementPtr l(new ListElement(ctx.loc2pos(@1)));
@@ -1251,6 +1342,8 @@ expired_leases_param: reclaim_timer_wait_time
                     | max_reclaim_leases
                     | max_reclaim_time
                     | unwarned_reclaim_cycles
+                    | reclaim_batch_size
+                    | reclaim_threads
                     ;
 
 reclaim_timer_wait_time: RECLAIM_TIMER_WAIT_TIME COLON INTEGER {
@@ -1289,6 +1382,18 @@ unwarned_reclaim_cycles: UNWARNED_RECLAIM_CYCLES COLON INTEGER {
     ctx.stack_.back()->set("unwarned-reclaim-cycles", value);
 };
 
+reclaim_batch_size: RECLAIM_BATCH_SIZE COLON INTEGER {
+    ctx.unique("reclaim-batch-size", ctx.loc2pos(@1));
+    ElementPtr value(new IntElement($3, ctx.loc2pos(@3)));
+    ctx.stack_.back()->set("reclaim-batch-size", value);
+};
+
+reclaim_threads: RECLAIM_THREADS COLON INTEGER {
+    ctx.unique("reclaim-threads", ctx.loc2pos(@1));
+    ElementPtr value(new IntElement($3, ctx.loc2pos(@3)));
+    ctx.stack_.back()->set("reclaim-threads", value);
+};
+
 // --- subnet4 ------------------------------------------
 // This defines subnet4 as a list of maps.
 // "subnet4": [ ... ]
@@ -1393,6 +1498,7 @@ subnet4_param: valid_lifetime
              | t2_percent
              | cache_threshold
              | cache_max_age
+             | allocator
              | ddns_send_updates
              | ddns_override_no_update
              | ddns_override_client_update
@@ -1573,6 +1679,7 @@ shared_network_param: name
                     | t2_percent
                     | cache_threshold
                     | cache_max_age
+                    | allocator
                     | ddns_send_updates
                     | ddns_override_no_update
                     | ddns_override_client_update
@@ -64,6 +64,7 @@
 
 #include <boost/algorithm/string.hpp>
 #include <boost/foreach.hpp>
+#include <boost/functional/hash.hpp>
 #include <boost/pointer_cast.hpp>
 #include <boost/shared_ptr.hpp>
 
@@ -605,7 +606,8 @@ Dhcpv4Srv::Dhcpv4Srv(uint16_t server_port, uint16_t client_port,
       alloc_engine_(), use_bcast_(use_bcast),
       network_state_(new NetworkState(NetworkState::DHCPv4)),
       cb_control_(new CBControlDHCPv4()),
-      test_send_responses_to_source_(false) {
+      test_send_responses_to_source_(false), shard_threads_stop_(false),
+      lazy_option_unpack_(false) {
 
     const char* env = std::getenv("KEA_TEST_SEND_RESPONSES_TO_SOURCE");
     if (env) {
@@ -637,6 +639,9 @@ Dhcpv4Srv::Dhcpv4Srv(uint16_t server_port, uint16_t client_port,
         alloc_engine_.reset(new AllocEngine(AllocEngine::ALLOC_ITERATIVE, 0,
                                             false /* false = IPv4 */));
 
+        // The lease commands report their lease changes to the engine.
+        CfgMgr::instance().setAllocEngine(alloc_engine_);
+
         /// @todo call loadLibraries() when handling configuration changes
 
     } catch (const std::exception &e) {
@@ -661,9 +666,15 @@ void Dhcpv4Srv::setPacketStatisticsDefaults() {
 }
 
 Dhcpv4Srv::~Dhcpv4Srv() {
+    // Stop the socket shard threads before the sockets are closed.
+    MultiThreadingMgr::instance().removeCriticalSectionCallbacks("DHCPV4_SHARDS");
+    stopShardThreads();
+
     // Discard any parked packets
     discardPackets();
 
+    CfgMgr::instance().setAllocEngine(AllocEnginePtr());
+
     try {
         stopD2();
     } catch(const std::exception& ex) {
@@ -914,6 +925,11 @@ Dhcpv4Srv::receivePacket(int timeout) {
     return (IfaceMgr::instance().receive4(timeout));
 }
 
+Pkt4Collection
+Dhcpv4Srv::receivePackets(int timeout) {
+    return (IfaceMgr::instance().receive4Batch(timeout));
+}
+
 void
 Dhcpv4Srv::sendPacket(const Pkt4Ptr& packet) {
     IfaceMgr::instance().send(packet);
@@ -921,6 +937,13 @@ Dhcpv4Srv::sendPacket(const Pkt4Ptr& packet) {
 
 int
 Dhcpv4Srv::run() {
+    // The socket shard threads are stopped when entering a critical
+    // section and started again when leaving it, like the thread pool.
+    MultiThreadingMgr::instance().removeCriticalSectionCallbacks("DHCPV4_SHARDS");
+    MultiThreadingMgr::instance().addCriticalSectionCallbacks("DHCPV4_SHARDS",
+        std::bind(&Dhcpv4Srv::stopShardThreads, this),
+        std::bind(&Dhcpv4Srv::startShardThreads, this));
+
 #ifdef ENABLE_AFL
     // Set up structures needed for fuzzing.
     Fuzz fuzzer(4, server_port_);
@@ -950,6 +973,10 @@ Dhcpv4Srv::run() {
         }
     }
 
+    // stopping the socket shard threads
+    MultiThreadingMgr::instance().removeCriticalSectionCallbacks("DHCPV4_SHARDS");
+    stopShardThreads();
+
     // destroying the thread pool
     MultiThreadingMgr::instance().apply(false, 0, 0);
 
@@ -958,15 +985,26 @@ Dhcpv4Srv::run() {
 
 void
 Dhcpv4Srv::run_one() {
-    // client's message and server's response
-    Pkt4Ptr query;
+    // client's messages
+    Pkt4Collection queries;
+
+    // Start the socket shard threads if the sockets were sharded by the
+    // last configuration. It does nothing if they are already running.
+    startShardThreads();
 
     try {
         // Set select() timeout to 1s. This value should not be modified
         // because it is important that the select() returns control
         // frequently so as the IOService can be polled for ready handlers.
         uint32_t timeout = 1;
-        query = receivePacket(timeout);
+        if (IfaceMgr::instance().getReceiveBatchSize() > 1) {
+            queries = receivePackets(timeout);
+        } else {
+            Pkt4Ptr query = receivePacket(timeout);
+            if (query) {
+                queries.push_back(query);
+            }
+        }
 
         // Log if packet has arrived. We can't log the detailed information
         // about the DHCP message because it hasn't been unpacked/parsed
@@ -974,7 +1012,7 @@ Dhcpv4Srv::run_one() {
         // have to process it first. The only information available at this
         // point are: the interface, source address and destination addresses
         // and ports.
-        if (query) {
+        for (auto query : queries) {
             LOG_DEBUG(packet4_logger, DBG_DHCP4_BASIC, DHCP4_BUFFER_RECEIVED)
                 .arg(query->getRemoteAddr().toText())
                 .arg(query->getRemotePort())
@@ -1024,31 +1062,141 @@ Dhcpv4Srv::run_one() {
     // Timeout may be reached or signal received, which breaks select()
     // with no reception occurred. No need to log anything here because
     // we have logged right after the call to receivePacket().
-    if (!query) {
+    if (queries.empty()) {
         return;
     }
 
-    // If the DHCP service has been globally disabled, drop the packet.
+    // If the DHCP service has been globally disabled, drop the packets.
     if (!network_state_->isServiceEnabled()) {
-        LOG_DEBUG(bad_packet4_logger, DBG_DHCP4_BASIC,
-                  DHCP4_PACKET_DROP_0008)
-            .arg(query->getLabel());
+        for (auto query : queries) {
+            LOG_DEBUG(bad_packet4_logger, DBG_DHCP4_BASIC,
+                      DHCP4_PACKET_DROP_0008)
+                .arg(query->getLabel());
+        }
         return;
     } else {
         if (MultiThreadingMgr::instance().getMode()) {
             typedef function<void()> CallBack;
-            boost::shared_ptr<CallBack> call_back =
-                boost::make_shared<CallBack>(std::bind(&Dhcpv4Srv::processPacketAndSendResponseNoThrow,
-                                                       this, query));
-            if (!MultiThreadingMgr::instance().getThreadPool().add(call_back)) {
+            auto& thread_pool = MultiThreadingMgr::instance().getThreadPool();
+            bool queued = true;
+            if (thread_pool.getAffinity()) {
+                // Each query is handed to the thread of its client.
+                for (auto query : queries) {
+                    boost::shared_ptr<CallBack> call_back =
+                        boost::make_shared<CallBack>(std::bind(&Dhcpv4Srv::processPacketAndSendResponseNoThrow,
+                                                               this, query));
+                    if (!thread_pool.add(call_back, getClientAffinityKey(query))) {
+                        queued = false;
+                    }
+                }
+            } else {
+                // The whole batch is handed to the thread pool at once.
+                std::vector<boost::shared_ptr<CallBack> > call_backs;
+                call_backs.reserve(queries.size());
+                for (auto query : queries) {
+                    call_backs.push_back(
+                        boost::make_shared<CallBack>(std::bind(&Dhcpv4Srv::processPacketAndSendResponseNoThrow,
+                                                               this, query)));
+                }
+                queued = thread_pool.add(call_backs);
+            }
+            if (!queued) {
                 LOG_DEBUG(dhcp4_logger, DBG_DHCP4_BASIC, DHCP4_PACKET_QUEUE_FULL);
             }
+        } else if (queries.size() == 1) {
+            processPacketAndSendResponse(queries.front());
         } else {
-            processPacketAndSendResponse(query);
+            // Do not let an error with one packet of the batch prevent
+            // processing of the remaining ones.
+            for (auto query : queries) {
+                processPacketAndSendResponseNoThrow(query);
+            }
         }
     }
 }
 
+void
+Dhcpv4Srv::startShardThreads() {
+    auto& mt_mgr = MultiThreadingMgr::instance();
+    size_t shards = IfaceMgr::instance().getSocketShards();
+    if (!shard_threads_.empty() || (shards <= 1) || !mt_mgr.getMode() ||
+        mt_mgr.isInCriticalSection()) {
+        return;
+    }
+    shard_threads_stop_ = false;
+    IfaceMgr::instance().resumeShardReceivers();
+    for (size_t shard = 0; shard < shards; ++shard) {
+        shard_threads_.push_back(boost::make_shared<std::thread>(
+            std::bind(&Dhcpv4Srv::runShard, this, shard)));
+    }
+}
+
+void
+Dhcpv4Srv::stopShardThreads() {
+    if (shard_threads_.empty()) {
+        return;
+    }
+    shard_threads_stop_ = true;
+    IfaceMgr::instance().interruptShardReceivers();
+    for (auto const& thread : shard_threads_) {
+        thread->join();
+    }
+    shard_threads_.clear();
+    IfaceMgr::instance().resumeShardReceivers();
+    shard_threads_stop_ = false;
+}
+
+void
+Dhcpv4Srv::runShard(const size_t shard) {
+    while (!shard_threads_stop_) {
+        Pkt4Collection queries;
+        try {
+            // The timeout only bounds the time to notice that the sockets
+            // were reopened: the thread is woken up when it must stop.
+            queries = IfaceMgr::instance().receive4Shard(shard, 1);
+        } catch (const std::exception& e) {
+            LOG_ERROR(packet4_logger, DHCP4_BUFFER_RECEIVE_FAIL).arg(e.what());
+            continue;
+        }
+
+        for (auto query : queries) {
+            LOG_DEBUG(packet4_logger, DBG_DHCP4_BASIC, DHCP4_BUFFER_RECEIVED)
+                .arg(query->getRemoteAddr().toText())
+                .arg(query->getRemotePort())
+                .arg(query->getLocalAddr().toText())
+                .arg(query->getLocalPort())
+                .arg(query->getIface());
+
+            // If the DHCP service has been globally disabled, drop the packet.
+            if (!network_state_->isServiceEnabled()) {
+                LOG_DEBUG(bad_packet4_logger, DBG_DHCP4_BASIC,
+                          DHCP4_PACKET_DROP_0008)
+                    .arg(query->getLabel());
+                continue;
+            }
+
+            processPacketAndSendResponseNoThrow(query);
+        }
+    }
+}
+
+size_t
+Dhcpv4Srv::getClientAffinityKey(const Pkt4Ptr& query) {
+    // The hardware address length is at offset 2 of the fixed header and
+    // the hardware address at offset 28.
+    const OptionBuffer& data = query->data_;
+    if (data.size() > 2) {
+        size_t hlen = data[2];
+        if (hlen > Pkt4::MAX_CHADDR_LEN) {
+            hlen = Pkt4::MAX_CHADDR_LEN;
+        }
+        if ((hlen > 0) && (data.size() >= 28 + hlen)) {
+            return (boost::hash_range(data.begin() + 28, data.begin() + 28 + hlen));
+        }
+    }
+    return (hash_value(query->getRemoteAddr()));
+}
+
 void
 Dhcpv4Srv::processPacketAndSendResponseNoThrow(Pkt4Ptr& query) {
     try {
@@ -1141,6 +1289,7 @@ Dhcpv4Srv::processPacket(Pkt4Ptr& query, Pkt4Ptr& rsp, bool allow_packet_park) {
                 .arg(query->getRemoteAddr().toText())
                 .arg(query->getLocalAddr().toText())
                 .arg(query->getIface());
+            query->setLazyUnpack(lazy_option_unpack_);
             query->unpack();
         } catch (const SkipRemainingOptionsError& e) {
             // An option failed to unpack but we are to attempt to process it
@@ -3177,6 +3326,9 @@ Dhcpv4Srv::processRelease(Pkt4Ptr& release, AllocEngine::ClientContext4Ptr& cont
 
             if (success) {
 
+                // The address can be allocated again.
+                alloc_engine_->leaseFreed(lease);
+
                 context.reset(new AllocEngine::ClientContext4());
                 context->old_lease_ = lease;
 
@@ -3189,6 +3341,8 @@ Dhcpv4Srv::processRelease(Pkt4Ptr& release, AllocEngine::ClientContext4Ptr& cont
                 StatsMgr::instance().addValue(
                     StatsMgr::generateName("subnet", lease->subnet_id_, "assigned-addresses"),
                     static_cast<int64_t>(-1));
+                CfgMgr::instance().getCurrentCfg()->getCfgSubnets4()->
+                    updatePoolAssigned(lease->subnet_id_, lease->addr_, -1);
 
                 // Remove existing DNS entries for the lease, if any.
                 queueNCR(CHG_REMOVE, lease);
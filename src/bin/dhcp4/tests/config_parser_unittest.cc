@@ -7384,6 +7384,99 @@ TEST_F(Dhcp4ParserTest, storeExtendedInfoGlobal) {
     EXPECT_TRUE(subnet2->getStoreExtendedInfo());
 }
 
+// This test checks that the allocator parameter is inherited from the
+// global scope and the shared networks and that the value specified at
+// a lower level overrides the inherited one.
+TEST_F(Dhcp4ParserTest, allocator) {
+    std::string config = "{ " + genIfaceConfig() + "," +
+        "\"rebind-timer\": 2000, "
+        "\"renew-timer\": 1000, "
+        "\"allocator\": \"flq\","
+        "\"shared-networks\": [ {"
+        "    \"name\": \"frog\","
+        "    \"allocator\": \"random\","
+        "    \"subnet4\": [ "
+        "    {"
+        "        \"pools\": [ { \"pool\": \"192.0.1.1 - 192.0.1.100\" } ],"
+        "        \"subnet\": \"192.0.1.0/24\""
+        "    },"
+        "    {"
+        "        \"allocator\": \"hashed\","
+        "        \"pools\": [ { \"pool\": \"192.0.4.1 - 192.0.4.100\" } ],"
+        "        \"subnet\": \"192.0.4.0/24\""
+        "    } ]"
+        "} ],"
+        "\"subnet4\": [ "
+        "{"
+        "    \"allocator\": \"iterative\","
+        "    \"pools\": [ { \"pool\": \"192.0.2.1 - 192.0.2.100\" } ],"
+        "    \"subnet\": \"192.0.2.0/24\""
+        "},"
+        "{"
+        "    \"pools\": [ { \"pool\": \"192.0.3.1 - 192.0.3.100\" } ],"
+        "    \"subnet\": \"192.0.3.0/24\""
+        "} ],"
+        "\"valid-lifetime\": 4000 }";
+
+    ConstElementPtr json;
+    ASSERT_NO_THROW(json = parseDHCP4(config));
+    extractConfig(config);
+
+    ConstElementPtr status;
+    ASSERT_NO_THROW(status = configureDhcp4Server(*srv_, json));
+    checkResult(status, 0);
+
+    checkGlobal("allocator", "flq");
+
+    CfgSubnets4Ptr cfg = CfgMgr::instance().getStagingCfg()->getCfgSubnets4();
+    const std::vector<std::pair<std::string, std::string> > expected = {
+        { "192.0.1.1", "random" },
+        { "192.0.2.1", "iterative" },
+        { "192.0.3.1", "flq" },
+        { "192.0.4.1", "hashed" }
+    };
+    for (auto exp : expected) {
+        SCOPED_TRACE(exp.first);
+        Subnet4Ptr subnet = cfg->selectSubnet(IOAddress(exp.first));
+        ASSERT_TRUE(subnet);
+        // Reset the fetch global function to staging (vs current) config.
+        subnet->setFetchGlobalsFn([]() -> ConstElementPtr {
+            return (CfgMgr::instance().getStagingCfg()->getConfiguredGlobals());
+        });
+        EXPECT_EQ(exp.second, subnet->getAllocatorType().get());
+    }
+}
+
+// This test checks that an unsupported allocator is rejected.
+TEST_F(Dhcp4ParserTest, allocatorInvalid) {
+    const std::vector<std::string> configs = {
+        "{ \"allocator\": \"sequential\","
+        "  \"valid-lifetime\": 4000 }",
+
+        "{ \"subnet4\": [ {"
+        "    \"allocator\": \"sequential\","
+        "    \"pools\": [ { \"pool\": \"192.0.2.1 - 192.0.2.100\" } ],"
+        "    \"subnet\": \"192.0.2.0/24\""
+        "  } ],"
+        "  \"valid-lifetime\": 4000 }",
+
+        "{ \"shared-networks\": [ {"
+        "    \"name\": \"frog\","
+        "    \"allocator\": \"sequential\""
+        "  } ],"
+        "  \"valid-lifetime\": 4000 }"
+    };
+    for (auto config : configs) {
+        SCOPED_TRACE(config);
+        ConstElementPtr json;
+        ASSERT_NO_THROW(json = parseDHCP4(config));
+
+        ConstElementPtr status;
+        ASSERT_NO_THROW(status = configureDhcp4Server(*srv_, json));
+        checkResult(status, 1);
+    }
+}
+
 /// This test checks that the statistic-default-sample-count and age
 /// global parameters are committed to the stats manager as expected.
 TEST_F(Dhcp4ParserTest, statsDefaultLimits) {
@@ -4187,6 +4187,43 @@ TEST_F(Dhcpv4SrvTest, tooLongClientId) {
     EXPECT_NO_THROW(client.doDORA());
 }
 
+// This test verifies that the queries of a client are dispatched to the
+// packet processing threads with the same key.
+TEST_F(Dhcpv4SrvTest, clientAffinityKey) {
+    // Returns the query received from the wire format of a query.
+    auto receive = [](const Pkt4Ptr& query) {
+        query->pack();
+        const isc::util::OutputBuffer& buf = query->getBuffer();
+        Pkt4Ptr received(new Pkt4(static_cast<const uint8_t*>(buf.getData()),
+                                  buf.getLength()));
+        received->setRemoteAddr(IOAddress("192.0.2.1"));
+        return (received);
+    };
+
+    HWAddrPtr hwaddr1(new HWAddr(HWAddr::fromText("00:01:02:03:04:05")));
+    HWAddrPtr hwaddr2(new HWAddr(HWAddr::fromText("00:01:02:03:04:06")));
+
+    Pkt4Ptr discover(new Pkt4(DHCPDISCOVER, 1234));
+    discover->setHWAddr(hwaddr1);
+    Pkt4Ptr request(new Pkt4(DHCPREQUEST, 5678));
+    request->setHWAddr(hwaddr1);
+    request->addOption(OptionPtr(new Option(Option::V4, DHO_DHCP_CLIENT_IDENTIFIER,
+                                            OptionBuffer(8, 1))));
+    Pkt4Ptr other(new Pkt4(DHCPDISCOVER, 1234));
+    other->setHWAddr(hwaddr2);
+
+    // The key only depends on the hardware address.
+    size_t key = Dhcpv4Srv::getClientAffinityKey(receive(discover));
+    EXPECT_EQ(key, Dhcpv4Srv::getClientAffinityKey(receive(request)));
+    EXPECT_NE(key, Dhcpv4Srv::getClientAffinityKey(receive(other)));
+
+    // Without hardware address the source address is used.
+    Pkt4Ptr received = receive(other);
+    received->data_[2] = 0;
+    EXPECT_EQ(hash_value(IOAddress("192.0.2.1")),
+              Dhcpv4Srv::getClientAffinityKey(received));
+}
+
 // Checks if user-contexts are parsed properly.
 TEST_F(Dhcpv4SrvTest, userContext) {
 
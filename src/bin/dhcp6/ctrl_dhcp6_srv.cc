@@ -11,11 +11,13 @@
 #include <cfgrpt/config_report.h>
 #include <config/command_mgr.h>
 #include <dhcp/libdhcp++.h>
+#include <dhcp/packet_queue_priority.h>
 #include <dhcp6/ctrl_dhcp6_srv.h>
 #include <dhcp6/dhcp6_log.h>
 #include <dhcp6/dhcp6to4_ipc.h>
 #include <dhcp6/json_config_parser.h>
 #include <dhcp6/parser_context.h>
+#include <dhcpsrv/alloc_engine.h>
 #include <dhcpsrv/cfg_db_access.h>
 #include <dhcpsrv/cfg_multi_threading.h>
 #include <dhcpsrv/cfgmgr.h>
@@ -413,6 +415,9 @@ ControlledDhcpv6Srv::commandConfigSetHandler(const string&,
 
         // Use new configuration.
         CfgMgr::instance().commit();
+
+        // Set up the allocation engine for the new configuration.
+        configureAllocEngine();
     } else {
         // Ok, we applied the logging from the upcoming configuration, but
         // there were problems with the config. As such, we need to back off
@@ -668,6 +673,15 @@ ControlledDhcpv6Srv::commandStatusGetHandler(const string&,
         queue_stats->add(Element::create(mt_mgr.getThreadPool().getQueueStat(100)));
         queue_stats->add(Element::create(mt_mgr.getThreadPool().getQueueStat(1000)));
         status->set("packet-queue-statistics", queue_stats);
+        if (mt_mgr.getThreadPool().getAffinity()) {
+            ElementPtr affinity_counts = Element::createList();
+            for (auto count : mt_mgr.getThreadPool().getAffinityCounts()) {
+                affinity_counts->add(Element::create(static_cast<int64_t>(count)));
+            }
+            status->set("packet-queue-affinity-counts", affinity_counts);
+            status->set("packet-queue-imbalance",
+                        Element::create(mt_mgr.getThreadPool().getAffinityImbalance()));
+        }
 
     } else {
         status->set("multi-threading-enabled", Element::create(false));
@@ -870,6 +884,21 @@ ControlledDhcpv6Srv::processConfig(isc::data::ConstElementPtr config) {
         if (IfaceMgr::instance().configureDHCPPacketQueue(AF_INET6, qc)) {
             LOG_INFO(dhcp6_logger, DHCP6_CONFIG_PACKET_QUEUE)
                      .arg(IfaceMgr::instance().getPacketQueue6()->getInfoStr());
+
+            // Report the drops of the priority queue to the statistics.
+            boost::shared_ptr<PacketQueuePriority6> priority_queue =
+                boost::dynamic_pointer_cast<PacketQueuePriority6>
+                (IfaceMgr::instance().getPacketQueue6());
+            if (priority_queue) {
+                priority_queue->setDropCallback(
+                    [](PacketQueuePriority6::Lane lane, uint64_t count) {
+                        StatsMgr::instance().addValue("pkt6-queue-drop-" +
+                            PacketQueuePriority6::laneToText(lane),
+                            static_cast<int64_t>(count));
+                        StatsMgr::instance().addValue("pkt6-receive-drop",
+                            static_cast<int64_t>(count));
+                    });
+            }
         }
 
     } catch (const std::exception& ex) {
@@ -878,6 +907,42 @@ ControlledDhcpv6Srv::processConfig(isc::data::ConstElementPtr config) {
         return (isc::config::createAnswer(1, err.str()));
     }
 
+    // Configure socket sharding: when enabled with multi-threading, the
+    // sockets are opened once per packet processing thread. This must be
+    // done before the sockets are reopened.
+    try {
+        bool enabled = false;
+        uint32_t thread_count = 0;
+        uint32_t queue_size = 0;
+        CfgMultiThreading::extract(CfgMgr::instance().getStagingCfg()->getDHCPMultiThreading(),
+                                   enabled, thread_count, queue_size);
+        if (enabled && !thread_count) {
+            thread_count = MultiThreadingMgr::detectThreadCount();
+        }
+        size_t shards = 1;
+        if (CfgMgr::instance().getStagingCfg()->getCfgIface()->getSocketSharding() &&
+            enabled &&
+            (thread_count > 1)) {
+            shards = thread_count;
+            if (shards > IfaceMgr::MAX_SOCKET_SHARDS) {
+                shards = IfaceMgr::MAX_SOCKET_SHARDS;
+            }
+            LOG_INFO(dhcp6_logger, DHCP6_SOCKET_SHARDS_INFO).arg(shards);
+        }
+        IfaceMgr::instance().setSocketShards(shards);
+    } catch (const std::exception& ex) {
+        err << "Error setting socket sharding after server reconfiguration: "
+            << ex.what();
+        return (isc::config::createAnswer(1, err.str()));
+    }
+
+    // Unpack the options of the queries lazily when configured. Hook
+    // libraries may walk the options of the queries directly, so they are
+    // unpacked eagerly when any library is loaded.
+    srv->setLazyOptionUnpack(
+        CfgMgr::instance().getStagingCfg()->getCfgIface()->getLazyOptionUnpack() &&
+        HooksManager::getLibraryNames().empty());
+
     // Configuration may change active interfaces. Therefore, we have to reopen
     // sockets according to new configuration. It is possible that this
     // operation will fail for some interfaces but the openSockets function
@@ -1175,6 +1240,35 @@ ControlledDhcpv6Srv::deleteExpiredReclaimedLeases(const uint32_t secs) {
     TimerMgr::instance()->setup(CfgExpiration::FLUSH_RECLAIMED_TIMER_NAME);
 }
 
+void
+ControlledDhcpv6Srv::configureAllocEngine() {
+    if (!alloc_engine_) {
+        return;
+    }
+    try {
+        SrvConfigPtr cfg = CfgMgr::instance().getCurrentCfg();
+
+        // Configure the expired leases reclamation: the leases are written
+        // by batches and reclaimed in parallel by subnet when
+        // multi-threading is enabled.
+        CfgExpirationPtr cfg_expiration = cfg->getCfgExpiration();
+        bool enabled = false;
+        uint32_t thread_count = 0;
+        uint32_t queue_size = 0;
+        CfgMultiThreading::extract(cfg->getDHCPMultiThreading(),
+                                   enabled, thread_count, queue_size);
+        alloc_engine_->setReclaimBatchSize(cfg_expiration->getReclaimBatchSize());
+        alloc_engine_->setReclaimThreads(enabled ?
+                                         cfg_expiration->getReclaimThreads() : 0);
+
+        // Fill the free lease queues from the subnets using the free lease
+        // queue allocator and the leases of the lease database.
+        alloc_engine_->initFreeLeaseQueues(cfg->getCfgSubnets6());
+    } catch (const std::exception& ex) {
+        LOG_ERROR(dhcp6_logger, DHCP6_ALLOC_ENGINE_CONFIG_FAIL).arg(ex.what());
+    }
+}
+
 bool
 ControlledDhcpv6Srv::dbLostCallback(ReconnectCtlPtr db_reconnect_ctl) {
     // Disable service until the connection is recovered.
@@ -387,6 +387,14 @@ private:
     /// deleted.
     void deleteExpiredReclaimedLeases(const uint32_t secs);
 
+    /// @brief Sets up the allocation engine for the current configuration.
+    ///
+    /// It is called when a new configuration was committed: it configures
+    /// the expired leases reclamation and fills the free lease queues of
+    /// the allocation engine. Errors are logged: the new configuration is
+    /// used anyway.
+    void configureAllocEngine();
+
     /// @brief Callback DB backends should invoke upon loss of the connectivity
     ///
     /// This function is invoked by DB backends when they detect a loss of
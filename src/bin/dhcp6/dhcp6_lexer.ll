@@ -473,6 +473,33 @@ ControlCharacterFill            [^"\\]|\\["\\/bfnrtu]
     }
 }
 
+\"fd-event-handler\" {
+    switch(driver.ctx_) {
+    case isc::dhcp::Parser6Context::INTERFACES_CONFIG:
+        return isc::dhcp::Dhcp6Parser::make_FD_EVENT_HANDLER(driver.loc_);
+    default:
+        return isc::dhcp::Dhcp6Parser::make_STRING("fd-event-handler", driver.loc_);
+    }
+}
+
+\"socket-sharding\" {
+    switch(driver.ctx_) {
+    case isc::dhcp::Parser6Context::INTERFACES_CONFIG:
+        return isc::dhcp::Dhcp6Parser::make_SOCKET_SHARDING(driver.loc_);
+    default:
+        return isc::dhcp::Dhcp6Parser::make_STRING("socket-sharding", driver.loc_);
+    }
+}
+
+\"lazy-option-unpack\" {
+    switch(driver.ctx_) {
+    case isc::dhcp::Parser6Context::INTERFACES_CONFIG:
+        return isc::dhcp::Dhcp6Parser::make_LAZY_OPTION_UNPACK(driver.loc_);
+    default:
+        return isc::dhcp::Dhcp6Parser::make_STRING("lazy-option-unpack", driver.loc_);
+    }
+}
+
 \"sanity-checks\" {
     switch(driver.ctx_) {
     case isc::dhcp::Parser6Context::DHCP6:
@@ -670,6 +697,42 @@ ControlCharacterFill            [^"\\]|\\["\\/bfnrtu]
     }
 }
 
+\"flush-records\" {
+    switch(driver.ctx_) {
+    case isc::dhcp::Parser6Context::LEASE_DATABASE:
+        return isc::dhcp::Dhcp6Parser::make_FLUSH_RECORDS(driver.loc_);
+    default:
+        return isc::dhcp::Dhcp6Parser::make_STRING("flush-records", driver.loc_);
+    }
+}
+
+\"flush-interval\" {
+    switch(driver.ctx_) {
+    case isc::dhcp::Parser6Context::LEASE_DATABASE:
+        return isc::dhcp::Dhcp6Parser::make_FLUSH_INTERVAL(driver.loc_);
+    default:
+        return isc::dhcp::Dhcp6Parser::make_STRING("flush-interval", driver.loc_);
+    }
+}
+
+\"write-queue-size\" {
+    switch(driver.ctx_) {
+    case isc::dhcp::Parser6Context::LEASE_DATABASE:
+        return isc::dhcp::Dhcp6Parser::make_WRITE_QUEUE_SIZE(driver.loc_);
+    default:
+        return isc::dhcp::Dhcp6Parser::make_STRING("write-queue-size", driver.loc_);
+    }
+}
+
+\"write-queue-full\" {
+    switch(driver.ctx_) {
+    case isc::dhcp::Parser6Context::LEASE_DATABASE:
+        return isc::dhcp::Dhcp6Parser::make_WRITE_QUEUE_FULL(driver.loc_);
+    default:
+        return isc::dhcp::Dhcp6Parser::make_STRING("write-queue-full", driver.loc_);
+    }
+}
+
 \"connect-timeout\" {
     switch(driver.ctx_) {
     case isc::dhcp::Parser6Context::LEASE_DATABASE:
@@ -1269,6 +1332,17 @@ ControlCharacterFill            [^"\\]|\\["\\/bfnrtu]
     }
 }
 
+\"allocator\" {
+    switch(driver.ctx_) {
+    case isc::dhcp::Parser6Context::DHCP6:
+    case isc::dhcp::Parser6Context::SUBNET6:
+    case isc::dhcp::Parser6Context::SHARED_NETWORK:
+        return isc::dhcp::Dhcp6Parser::make_ALLOCATOR(driver.loc_);
+    default:
+        return isc::dhcp::Dhcp6Parser::make_STRING("allocator", driver.loc_);
+    }
+}
+
 \"disabled\" {
     switch(driver.ctx_) {
     case isc::dhcp::Parser6Context::RESERVATION_MODE:
@@ -1869,6 +1943,24 @@ ControlCharacterFill            [^"\\]|\\["\\/bfnrtu]
     }
 }
 
+\"reclaim-batch-size\" {
+    switch(driver.ctx_) {
+    case isc::dhcp::Parser6Context::EXPIRED_LEASES_PROCESSING:
+        return isc::dhcp::Dhcp6Parser::make_RECLAIM_BATCH_SIZE(driver.loc_);
+    default:
+        return isc::dhcp::Dhcp6Parser::make_STRING("reclaim-batch-size", driver.loc_);
+    }
+}
+
+\"reclaim-threads\" {
+    switch(driver.ctx_) {
+    case isc::dhcp::Parser6Context::EXPIRED_LEASES_PROCESSING:
+        return isc::dhcp::Dhcp6Parser::make_RECLAIM_THREADS(driver.loc_);
+    default:
+        return isc::dhcp::Dhcp6Parser::make_STRING("reclaim-threads", driver.loc_);
+    }
+}
+
 \"dhcp4o6-port\" {
     switch(driver.ctx_) {
     case isc::dhcp::Parser6Context::DHCP6:
@@ -1914,6 +2006,15 @@ ControlCharacterFill            [^"\\]|\\["\\/bfnrtu]
     }
 }
 
+\"client-affinity\" {
+    switch(driver.ctx_) {
+    case isc::dhcp::Parser6Context::DHCP_MULTI_THREADING:
+        return isc::dhcp::Dhcp6Parser::make_CLIENT_AFFINITY(driver.loc_);
+    default:
+        return isc::dhcp::Dhcp6Parser::make_STRING("client-affinity", driver.loc_);
+    }
+}
+
 \"control-socket\" {
     switch(driver.ctx_) {
     case isc::dhcp::Parser6Context::DHCP6:
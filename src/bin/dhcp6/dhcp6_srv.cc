@@ -67,6 +67,7 @@
 #include <dhcpsrv/memfile_lease_mgr.h>
 
 #include <boost/foreach.hpp>
+#include <boost/functional/hash.hpp>
 #include <boost/tokenizer.hpp>
 #include <boost/algorithm/string/erase.hpp>
 #include <boost/algorithm/string/join.hpp>
@@ -211,7 +212,8 @@ Dhcpv6Srv::Dhcpv6Srv(uint16_t server_port, uint16_t client_port)
       client_port_(client_port), serverid_(), shutdown_(true),
       alloc_engine_(), name_change_reqs_(),
       network_state_(new NetworkState(NetworkState::DHCPv6)),
-      cb_control_(new CBControlDHCPv6()) {
+      cb_control_(new CBControlDHCPv6()), shard_threads_stop_(false),
+      lazy_option_unpack_(false) {
     LOG_DEBUG(dhcp6_logger, DBG_DHCP6_START, DHCP6_OPEN_SOCKET)
         .arg(server_port);
 
@@ -237,6 +239,9 @@ Dhcpv6Srv::Dhcpv6Srv(uint16_t server_port, uint16_t client_port)
         // attempts depending on the pool size.
         alloc_engine_.reset(new AllocEngine(AllocEngine::ALLOC_ITERATIVE, 0));
 
+        // The lease commands report their lease changes to the engine.
+        CfgMgr::instance().setAllocEngine(alloc_engine_);
+
         /// @todo call loadLibraries() when handling configuration changes
 
     } catch (const std::exception &e) {
@@ -261,9 +266,15 @@ void Dhcpv6Srv::setPacketStatisticsDefaults() {
 }
 
 Dhcpv6Srv::~Dhcpv6Srv() {
+    // Stop the socket shard threads before the sockets are closed.
+    MultiThreadingMgr::instance().removeCriticalSectionCallbacks("DHCPV6_SHARDS");
+    stopShardThreads();
+
     // Discard any parked packets
     discardPackets();
 
+    CfgMgr::instance().setAllocEngine(AllocEnginePtr());
+
     try {
         stopD2();
     } catch(const std::exception& ex) {
@@ -306,6 +317,10 @@ Pkt6Ptr Dhcpv6Srv::receivePacket(int timeout) {
     return (IfaceMgr::instance().receive6(timeout));
 }
 
+Pkt6Collection Dhcpv6Srv::receivePackets(int timeout) {
+    return (IfaceMgr::instance().receive6Batch(timeout));
+}
+
 void Dhcpv6Srv::sendPacket(const Pkt6Ptr& packet) {
     IfaceMgr::instance().send(packet);
 }
@@ -500,6 +515,13 @@ Dhcpv6Srv::initContext(const Pkt6Ptr& pkt,
 }
 
 int Dhcpv6Srv::run() {
+    // The socket shard threads are stopped when entering a critical
+    // section and started again when leaving it, like the thread pool.
+    MultiThreadingMgr::instance().removeCriticalSectionCallbacks("DHCPV6_SHARDS");
+    MultiThreadingMgr::instance().addCriticalSectionCallbacks("DHCPV6_SHARDS",
+        std::bind(&Dhcpv6Srv::stopShardThreads, this),
+        std::bind(&Dhcpv6Srv::startShardThreads, this));
+
 #ifdef ENABLE_AFL
     // Set up structures needed for fuzzing.
     Fuzz fuzzer(6, server_port_);
@@ -529,6 +551,10 @@ int Dhcpv6Srv::run() {
         }
     }
 
+    // stopping the socket shard threads
+    MultiThreadingMgr::instance().removeCriticalSectionCallbacks("DHCPV6_SHARDS");
+    stopShardThreads();
+
     // destroying the thread pool
     MultiThreadingMgr::instance().apply(false, 0, 0);
 
@@ -536,15 +562,26 @@ int Dhcpv6Srv::run() {
 }
 
 void Dhcpv6Srv::run_one() {
-    // client's message and server's response
-    Pkt6Ptr query;
+    // client's messages
+    Pkt6Collection queries;
+
+    // Start the socket shard threads if the sockets were sharded by the
+    // last configuration. It does nothing if they are already running.
+    startShardThreads();
 
     try {
         // Set select() timeout to 1s. This value should not be modified
         // because it is important that the select() returns control
         // frequently so as the IOService can be polled for ready handlers.
         uint32_t timeout = 1;
-        query = receivePacket(timeout);
+        if (IfaceMgr::instance().getReceiveBatchSize() > 1) {
+            queries = receivePackets(timeout);
+        } else {
+            Pkt6Ptr query = receivePacket(timeout);
+            if (query) {
+                queries.push_back(query);
+            }
+        }
 
         // Log if packet has arrived. We can't log the detailed information
         // about the DHCP message because it hasn't been unpacked/parsed
@@ -552,7 +589,7 @@ void Dhcpv6Srv::run_one() {
         // have to process it first. The only information available at this
         // point are: the interface, source address and destination addresses
         // and ports.
-        if (query) {
+        for (auto query : queries) {
             LOG_DEBUG(packet6_logger, DBG_DHCP6_BASIC, DHCP6_BUFFER_RECEIVED)
                 .arg(query->getRemoteAddr().toText())
                 .arg(query->getRemotePort())
@@ -605,31 +642,164 @@ void Dhcpv6Srv::run_one() {
 
     // Timeout may be reached or signal received, which breaks select()
     // with no packet received
-    if (!query) {
+    if (queries.empty()) {
         return;
     }
 
-    // If the DHCP service has been globally disabled, drop the packet.
+    // If the DHCP service has been globally disabled, drop the packets.
     if (!network_state_->isServiceEnabled()) {
-        LOG_DEBUG(bad_packet6_logger, DBG_DHCP6_DETAIL_DATA,
-                  DHCP6_PACKET_DROP_DHCP_DISABLED)
-            .arg(query->getLabel());
+        for (auto query : queries) {
+            LOG_DEBUG(bad_packet6_logger, DBG_DHCP6_DETAIL_DATA,
+                      DHCP6_PACKET_DROP_DHCP_DISABLED)
+                .arg(query->getLabel());
+        }
         return;
     } else {
         if (MultiThreadingMgr::instance().getMode()) {
             typedef function<void()> CallBack;
-            boost::shared_ptr<CallBack> call_back =
-                boost::make_shared<CallBack>(std::bind(&Dhcpv6Srv::processPacketAndSendResponseNoThrow,
-                                                       this, query));
-            if (!MultiThreadingMgr::instance().getThreadPool().add(call_back)) {
+            auto& thread_pool = MultiThreadingMgr::instance().getThreadPool();
+            bool queued = true;
+            if (thread_pool.getAffinity()) {
+                // Each query is handed to the thread of its client.
+                for (auto query : queries) {
+                    boost::shared_ptr<CallBack> call_back =
+                        boost::make_shared<CallBack>(std::bind(&Dhcpv6Srv::processPacketAndSendResponseNoThrow,
+                                                               this, query));
+                    if (!thread_pool.add(call_back, getClientAffinityKey(query))) {
+                        queued = false;
+                    }
+                }
+            } else {
+                // The whole batch is handed to the thread pool at once.
+                std::vector<boost::shared_ptr<CallBack> > call_backs;
+                call_backs.reserve(queries.size());
+                for (auto query : queries) {
+                    call_backs.push_back(
+                        boost::make_shared<CallBack>(std::bind(&Dhcpv6Srv::processPacketAndSendResponseNoThrow,
+                                                               this, query)));
+                }
+                queued = thread_pool.add(call_backs);
+            }
+            if (!queued) {
                 LOG_DEBUG(dhcp6_logger, DBG_DHCP6_BASIC, DHCP6_PACKET_QUEUE_FULL);
             }
+        } else if (queries.size() == 1) {
+            processPacketAndSendResponse(queries.front());
         } else {
-            processPacketAndSendResponse(query);
+            // Do not let an error with one packet of the batch prevent
+            // processing of the remaining ones.
+            for (auto query : queries) {
+                processPacketAndSendResponseNoThrow(query);
+            }
         }
     }
 }
 
+void
+Dhcpv6Srv::startShardThreads() {
+    auto& mt_mgr = MultiThreadingMgr::instance();
+    size_t shards = IfaceMgr::instance().getSocketShards();
+    if (!shard_threads_.empty() || (shards <= 1) || !mt_mgr.getMode() ||
+        mt_mgr.isInCriticalSection()) {
+        return;
+    }
+    shard_threads_stop_ = false;
+    IfaceMgr::instance().resumeShardReceivers();
+    for (size_t shard = 0; shard < shards; ++shard) {
+        shard_threads_.push_back(boost::make_shared<std::thread>(
+            std::bind(&Dhcpv6Srv::runShard, this, shard)));
+    }
+}
+
+void
+Dhcpv6Srv::stopShardThreads() {
+    if (shard_threads_.empty()) {
+        return;
+    }
+    shard_threads_stop_ = true;
+    IfaceMgr::instance().interruptShardReceivers();
+    for (auto const& thread : shard_threads_) {
+        thread->join();
+    }
+    shard_threads_.clear();
+    IfaceMgr::instance().resumeShardReceivers();
+    shard_threads_stop_ = false;
+}
+
+void
+Dhcpv6Srv::runShard(const size_t shard) {
+    while (!shard_threads_stop_) {
+        Pkt6Collection queries;
+        try {
+            // The timeout only bounds the time to notice that the sockets
+            // were reopened: the thread is woken up when it must stop.
+            queries = IfaceMgr::instance().receive6Shard(shard, 1);
+        } catch (const std::exception& e) {
+            LOG_ERROR(packet6_logger, DHCP6_PACKET_RECEIVE_FAIL).arg(e.what());
+            continue;
+        }
+
+        for (auto query : queries) {
+            LOG_DEBUG(packet6_logger, DBG_DHCP6_BASIC, DHCP6_BUFFER_RECEIVED)
+                .arg(query->getRemoteAddr().toText())
+                .arg(query->getRemotePort())
+                .arg(query->getLocalAddr().toText())
+                .arg(query->getLocalPort())
+                .arg(query->getIface());
+
+            StatsMgr::instance().addValue("pkt6-received", static_cast<int64_t>(1));
+
+            // If the DHCP service has been globally disabled, drop the packet.
+            if (!network_state_->isServiceEnabled()) {
+                LOG_DEBUG(bad_packet6_logger, DBG_DHCP6_DETAIL_DATA,
+                          DHCP6_PACKET_DROP_DHCP_DISABLED)
+                    .arg(query->getLabel());
+                continue;
+            }
+
+            processPacketAndSendResponseNoThrow(query);
+        }
+    }
+}
+
+size_t
+Dhcpv6Srv::getClientAffinityKey(const Pkt6Ptr& query) {
+    // Walk the options of the message, entering the relay message option
+    // of each relay, until the client identifier option is found.
+    const OptionBuffer& data = query->data_;
+    size_t offset = 0;
+    size_t end = data.size();
+    while (offset < end) {
+        const bool relayed = ((data[offset] == DHCPV6_RELAY_FORW) ||
+                              (data[offset] == DHCPV6_RELAY_REPL));
+        offset += (relayed ? Pkt6::DHCPV6_RELAY_HDR_LEN : Pkt6::DHCPV6_PKT_HDR_LEN);
+        size_t relay_msg_end = 0;
+        while (offset + 4 <= end) {
+            uint16_t opt_type = readUint16(&data[offset], 2);
+            uint16_t opt_len = readUint16(&data[offset + 2], 2);
+            offset += 4;
+            if (opt_len > end - offset) {
+                // Truncated option.
+                break;
+            }
+            if (!relayed && (opt_type == D6O_CLIENTID) && (opt_len > 0)) {
+                return (boost::hash_range(data.begin() + offset,
+                                          data.begin() + offset + opt_len));
+            }
+            if (relayed && (opt_type == D6O_RELAY_MSG)) {
+                relay_msg_end = offset + opt_len;
+                break;
+            }
+            offset += opt_len;
+        }
+        if (!relay_msg_end) {
+            break;
+        }
+        end = relay_msg_end;
+    }
+    return (hash_value(query->getRemoteAddr()));
+}
+
 void
 Dhcpv6Srv::processPacketAndSendResponseNoThrow(Pkt6Ptr& query) {
     try {
@@ -716,6 +886,7 @@ Dhcpv6Srv::processPacket(Pkt6Ptr& query, Pkt6Ptr& rsp) {
                 .arg(query->getRemoteAddr().toText())
                 .arg(query->getLocalAddr().toText())
                 .arg(query->getIface());
+            query->setLazyUnpack(lazy_option_unpack_);
             query->unpack();
         } catch (const SkipRemainingOptionsError& e) {
             // An option failed to unpack but we are to attempt to process it
@@ -1726,6 +1897,10 @@ Dhcpv6Srv::assignLeases(const Pkt6Ptr& question, Pkt6Ptr& answer,
     // responses in answer message (ADVERTISE or REPLY).
     //
     // @todo: IA_TA once we implement support for temporary addresses.
+    // The options are iterated directly and looking up an option not
+    // unpacked yet would add it to the collection: unpack them all.
+    question->unpackLazyOptions();
+
     for (OptionCollection::iterator opt = question->options_.begin();
          opt != question->options_.end(); ++opt) {
         switch (opt->second->getType()) {
@@ -2606,6 +2781,10 @@ Dhcpv6Srv::extendLeases(const Pkt6Ptr& query, Pkt6Ptr& reply,
     // Save the originally selected subnet.
     Subnet6Ptr orig_subnet = ctx.subnet_;
 
+    // The options are iterated directly and looking up an option not
+    // unpacked yet would add it to the collection: unpack them all.
+    query->unpackLazyOptions();
+
     for (OptionCollection::iterator opt = query->options_.begin();
          opt != query->options_.end(); ++opt) {
         switch (opt->second->getType()) {
@@ -2659,6 +2838,10 @@ Dhcpv6Srv::releaseLeases(const Pkt6Ptr& release, Pkt6Ptr& reply,
     // handled properly. Therefore the releaseIA_NA and releaseIA_PD options
     // may turn the status code to some error, but can't turn it back to success.
     int general_status = STATUS_Success;
+    // The options are iterated directly and looking up an option not
+    // unpacked yet would add it to the collection: unpack them all.
+    release->unpackLazyOptions();
+
     for (OptionCollection::iterator opt = release->options_.begin();
          opt != release->options_.end(); ++opt) {
         Lease6Ptr old_lease;
@@ -2829,6 +3012,10 @@ Dhcpv6Srv::releaseIA_NA(const DuidPtr& duid, const Pkt6Ptr& query,
 
     if (!skip) {
         success = LeaseMgrFactory::instance().deleteLease(lease);
+        if (success) {
+            // The address can be allocated again.
+            alloc_engine_->leaseFreed(lease);
+        }
     }
 
     // Here the success should be true if we removed lease successfully
@@ -2860,6 +3047,8 @@ Dhcpv6Srv::releaseIA_NA(const DuidPtr& duid, const Pkt6Ptr& query,
         StatsMgr::instance().addValue(
             StatsMgr::generateName("subnet", lease->subnet_id_, "assigned-nas"),
             static_cast<int64_t>(-1));
+        CfgMgr::instance().getCurrentCfg()->getCfgSubnets6()->
+            updatePoolAssigned(lease->subnet_id_, Lease::TYPE_NA, lease->addr_, -1);
 
         // Check if a lease has flags indicating that the FQDN update has
         // been performed. If so, create NameChangeRequest which removes
@@ -2987,6 +3176,10 @@ Dhcpv6Srv::releaseIA_PD(const DuidPtr& duid, const Pkt6Ptr& query,
 
     if (!skip) {
         success = LeaseMgrFactory::instance().deleteLease(lease);
+        if (success) {
+            // The prefix can be allocated again.
+            alloc_engine_->leaseFreed(lease);
+        }
     } else {
         // Callouts decided to skip the next processing step. The next
         // processing step would to send the packet, so skip at this
@@ -3025,6 +3218,8 @@ Dhcpv6Srv::releaseIA_PD(const DuidPtr& duid, const Pkt6Ptr& query,
         StatsMgr::instance().addValue(
             StatsMgr::generateName("subnet", lease->subnet_id_, "assigned-pds"),
             static_cast<int64_t>(-1));
+        CfgMgr::instance().getCurrentCfg()->getCfgSubnets6()->
+            updatePoolAssigned(lease->subnet_id_, Lease::TYPE_PD, lease->addr_, -1);
     }
 
     return (ia_rsp);
@@ -3358,6 +3553,10 @@ Dhcpv6Srv::declineLeases(const Pkt6Ptr& decline, Pkt6Ptr& reply,
     // may turn the status code to some error, but can't turn it back to success.
     int general_status = STATUS_Success;
 
+    // The options are iterated directly and looking up an option not
+    // unpacked yet would add it to the collection: unpack them all.
+    decline->unpackLazyOptions();
+
     for (OptionCollection::iterator opt = decline->options_.begin();
          opt != decline->options_.end(); ++opt) {
         switch (opt->second->getType()) {
@@ -28,9 +28,12 @@
 #include <hooks/callout_handle.h>
 #include <process/daemon.h>
 
+#include <atomic>
 #include <functional>
 #include <iostream>
 #include <queue>
+#include <thread>
+#include <vector>
 
 // Undefine the macro OPTIONAL which is defined in some operating
 // systems but conflicts with a member of the RequirementLevel enum in
@@ -144,11 +147,43 @@ public:
 
     /// @brief Main server processing step.
     ///
-    /// Main server processing step. Receives one incoming packet, calls
-    /// the processing packet routing and (if necessary) transmits
+    /// Main server processing step. Receives one incoming packet, or a
+    /// batch of packets when the receive batch size is greater than 1,
+    /// calls the processing packet routing and (if necessary) transmits
     /// a response.
     void run_one();
 
+    /// @brief Starts the socket shard threads.
+    ///
+    /// When the sockets are sharded (see @c IfaceMgr::setSocketShards)
+    /// and multi-threading is enabled, one thread is started per shard.
+    /// Each thread receives the packets of its shard, processes them and
+    /// sends the responses, so the main thread does not receive them.
+    /// It does nothing when the threads are already running or inside a
+    /// critical section.
+    void startShardThreads();
+
+    /// @brief Stops the socket shard threads.
+    ///
+    /// Interrupts the shard receivers and waits for the threads to
+    /// finish processing their current packets.
+    void stopShardThreads();
+
+    /// @brief Returns the key dispatching a query to a packet processing
+    /// thread.
+    ///
+    /// With the client affinity (see @c MultiThreadingMgr::setClientAffinity)
+    /// the queries with the same key are processed in order by the same
+    /// thread, so the queries of a client do not compete for the client
+    /// handler. The query is not unpacked yet: the key is a hash of the
+    /// client identifier option read from the received buffer, in the
+    /// innermost message of a relayed query, or of the source address when
+    /// the client identifier is not found.
+    ///
+    /// @param query The received query.
+    /// @return The key of the client of the query.
+    static size_t getClientAffinityKey(const Pkt6Ptr& query);
+
     /// @brief Process a single incoming DHCPv6 packet and sends the response.
     ///
     /// It verifies correctness of the passed packet, calls per-type processXXX
@@ -255,6 +290,21 @@ public:
     /// Called during reconfigure and shutdown.
     void discardPackets();
 
+    /// @brief Enables or disables lazy option unpacking of the queries.
+    ///
+    /// When enabled the options of the received queries are indexed by
+    /// @c unpack and parsed on first access (see @c Pkt::setLazyUnpack).
+    ///
+    /// @param lazy_option_unpack true to enable lazy option unpacking.
+    void setLazyOptionUnpack(const bool lazy_option_unpack) {
+        lazy_option_unpack_ = lazy_option_unpack;
+    }
+
+    /// @brief Checks if lazy option unpacking of the queries is enabled.
+    bool getLazyOptionUnpack() const {
+        return (lazy_option_unpack_);
+    }
+
 protected:
 
     /// @brief This function sets statistics related to DHCPv6 packets processing
@@ -799,6 +849,13 @@ protected:
     /// simulates reception of a packet. For that purpose it is protected.
     virtual Pkt6Ptr receivePacket(int timeout);
 
+    /// @brief dummy wrapper around IfaceMgr::receive6Batch
+    ///
+    /// This method is used instead of @c receivePacket when the receive
+    /// batch size is greater than 1. It is useful for testing purposes,
+    /// where its replacement simulates reception of packets.
+    virtual Pkt6Collection receivePackets(int timeout);
+
     /// @brief dummy wrapper around IfaceMgr::send()
     ///
     /// This method is useful for testing purposes, where its replacement
@@ -1165,6 +1222,22 @@ protected:
 
     /// @brief Controls access to the configuration backends.
     CBControlDHCPv6Ptr cb_control_;
+
+private:
+
+    /// @brief Main loop of a socket shard thread.
+    ///
+    /// @param shard index of the shard served by the thread.
+    void runShard(const size_t shard);
+
+    /// @brief The socket shard threads.
+    std::vector<boost::shared_ptr<std::thread> > shard_threads_;
+
+    /// @brief Indicates if the socket shard threads must stop.
+    std::atomic<bool> shard_threads_stop_;
+
+    /// @brief Indicates if the options of the queries are unpacked lazily.
+    bool lazy_option_unpack_;
 };
 
 }  // namespace dhcp
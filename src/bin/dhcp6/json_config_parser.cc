@@ -201,6 +201,12 @@ public:
         // Set the server's logical name
         std::string server_tag = getString(global, "server-tag");
         srv_config->setServerTag(server_tag);
+
+        // Check the global lease allocator, it is inherited by the
+        // subnets and shared networks.
+        if (global->contains("allocator")) {
+            BaseNetworkParser::getAllocatorType(global);
+        }
     }
 
     /// @brief Sets global parameters before other parameters are parsed.
@@ -791,7 +797,8 @@ configureDhcp6Server(Dhcpv6Srv& server, isc::data::ConstElementPtr config_set,
                  (config_pair.first == "store-extended-info") ||
                  (config_pair.first == "statistic-default-sample-count") ||
                  (config_pair.first == "statistic-default-sample-age") ||
-                 (config_pair.first == "ip-reservations-unique")) {
+                 (config_pair.first == "ip-reservations-unique") ||
+                 (config_pair.first == "allocator")) {
                 CfgMgr::instance().getStagingCfg()->addConfiguredGlobal(config_pair.first,
                                                                         config_pair.second);
                 continue;
@@ -8002,6 +8002,100 @@ TEST_F(Dhcp6ParserTest, storeExtendedInfoNoGlobal) {
     EXPECT_TRUE(subnet->getStoreExtendedInfo());
 }
 
+// This test checks that the allocator parameter is inherited from the
+// global scope and the shared networks and that the value specified at
+// a lower level overrides the inherited one.
+TEST_F(Dhcp6ParserTest, allocator) {
+    std::string config = "{ " + genIfaceConfig() + "," +
+        "\"preferred-lifetime\": 3000,"
+        "\"rebind-timer\": 2000, "
+        "\"renew-timer\": 1000, "
+        "\"allocator\": \"flq\","
+        "\"shared-networks\": [ {"
+        "    \"name\": \"frog\","
+        "    \"allocator\": \"random\","
+        "    \"subnet6\": [ "
+        "    {"
+        "        \"pools\": [ { \"pool\": \"2001:db8:1::1 - 2001:db8:1::ffff\" } ],"
+        "        \"subnet\": \"2001:db8:1::/64\""
+        "    },"
+        "    {"
+        "        \"allocator\": \"hashed\","
+        "        \"pools\": [ { \"pool\": \"2001:db8:4::1 - 2001:db8:4::ffff\" } ],"
+        "        \"subnet\": \"2001:db8:4::/64\""
+        "    } ]"
+        "} ],"
+        "\"subnet6\": [ "
+        "{"
+        "    \"allocator\": \"iterative\","
+        "    \"pools\": [ { \"pool\": \"2001:db8:2::1 - 2001:db8:2::ffff\" } ],"
+        "    \"subnet\": \"2001:db8:2::/64\""
+        "},"
+        "{"
+        "    \"pools\": [ { \"pool\": \"2001:db8:3::1 - 2001:db8:3::ffff\" } ],"
+        "    \"subnet\": \"2001:db8:3::/64\""
+        "} ],"
+        "\"valid-lifetime\": 4000 }";
+
+    ConstElementPtr json;
+    ASSERT_NO_THROW(json = parseDHCP6(config));
+    extractConfig(config);
+
+    ConstElementPtr status;
+    EXPECT_NO_THROW(status = configureDhcp6Server(srv_, json));
+    checkResult(status, 0);
+
+    checkGlobal("allocator", "flq");
+
+    CfgSubnets6Ptr cfg = CfgMgr::instance().getStagingCfg()->getCfgSubnets6();
+    const std::vector<std::pair<std::string, std::string> > expected = {
+        { "2001:db8:1::", "random" },
+        { "2001:db8:2::", "iterative" },
+        { "2001:db8:3::", "flq" },
+        { "2001:db8:4::", "hashed" }
+    };
+    for (auto exp : expected) {
+        SCOPED_TRACE(exp.first);
+        Subnet6Ptr subnet = cfg->selectSubnet(IOAddress(exp.first));
+        ASSERT_TRUE(subnet);
+        // Reset the fetch global function to staging (vs current) config.
+        subnet->setFetchGlobalsFn([]() -> ConstElementPtr {
+            return (CfgMgr::instance().getStagingCfg()->getConfiguredGlobals());
+        });
+        EXPECT_EQ(exp.second, subnet->getAllocatorType().get());
+    }
+}
+
+// This test checks that an unsupported allocator is rejected.
+TEST_F(Dhcp6ParserTest, allocatorInvalid) {
+    const std::vector<std::string> configs = {
+        "{ \"allocator\": \"sequential\","
+        "  \"valid-lifetime\": 4000 }",
+
+        "{ \"subnet6\": [ {"
+        "    \"allocator\": \"sequential\","
+        "    \"pools\": [ { \"pool\": \"2001:db8:1::1 - 2001:db8:1::ffff\" } ],"
+        "    \"subnet\": \"2001:db8:1::/64\""
+        "  } ],"
+        "  \"valid-lifetime\": 4000 }",
+
+        "{ \"shared-networks\": [ {"
+        "    \"name\": \"frog\","
+        "    \"allocator\": \"sequential\""
+        "  } ],"
+        "  \"valid-lifetime\": 4000 }"
+    };
+    for (auto config : configs) {
+        SCOPED_TRACE(config);
+        ConstElementPtr json;
+        ASSERT_NO_THROW(json = parseDHCP6(config));
+
+        ConstElementPtr status;
+        EXPECT_NO_THROW(status = configureDhcp6Server(srv_, json));
+        checkResult(status, 1);
+    }
+}
+
 /// This test checks that the statistic-default-sample-count and age
 /// global parameters are committed to the stats manager as expected.
 TEST_F(Dhcp6ParserTest, statsDefaultLimits) {
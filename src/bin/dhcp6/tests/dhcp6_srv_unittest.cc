@@ -2704,6 +2704,52 @@ TEST_F(Dhcpv6SrvTest, receiveParseFailedStat) {
     EXPECT_EQ(1, recv_drop->getInteger().first);
 }
 
+// This test verifies that the queries of a client are dispatched to the
+// packet processing threads with the same key.
+TEST_F(Dhcpv6SrvTest, clientAffinityKey) {
+    // Returns the query received from the wire format of a query.
+    auto receive = [](const Pkt6Ptr& query) {
+        query->pack();
+        const OutputBuffer& buf = query->getBuffer();
+        Pkt6Ptr received(new Pkt6(static_cast<const uint8_t*>(buf.getData()),
+                                  buf.getLength()));
+        received->setRemoteAddr(IOAddress("fe80::1"));
+        return (received);
+    };
+
+    OptionPtr clientid1(new Option(Option::V6, D6O_CLIENTID, OptionBuffer(10, 1)));
+    OptionPtr clientid2(new Option(Option::V6, D6O_CLIENTID, OptionBuffer(10, 2)));
+
+    Pkt6Ptr solicit(new Pkt6(DHCPV6_SOLICIT, 1234));
+    solicit->addOption(clientid1);
+    Pkt6Ptr request(new Pkt6(DHCPV6_REQUEST, 5678));
+    request->addOption(OptionPtr(new Option(Option::V6, D6O_SERVERID,
+                                            OptionBuffer(10, 3))));
+    request->addOption(clientid1);
+    Pkt6Ptr relayed(new Pkt6(DHCPV6_SOLICIT, 1234));
+    relayed->addOption(clientid1);
+    Pkt6::RelayInfo relay;
+    relay.linkaddr_ = IOAddress("2001:db8:2::1234");
+    relay.peeraddr_ = IOAddress("fe80::2");
+    relay.options_.insert(make_pair(D6O_INTERFACE_ID,
+                                    OptionPtr(new Option(Option::V6, D6O_INTERFACE_ID,
+                                                         OptionBuffer(4, 4)))));
+    relayed->relay_info_.push_back(relay);
+    Pkt6Ptr other(new Pkt6(DHCPV6_SOLICIT, 1234));
+    other->addOption(clientid2);
+
+    // The key only depends on the client identifier, even when relayed.
+    size_t key = Dhcpv6Srv::getClientAffinityKey(receive(solicit));
+    EXPECT_EQ(key, Dhcpv6Srv::getClientAffinityKey(receive(request)));
+    EXPECT_EQ(key, Dhcpv6Srv::getClientAffinityKey(receive(relayed)));
+    EXPECT_NE(key, Dhcpv6Srv::getClientAffinityKey(receive(other)));
+
+    // Without client identifier the source address is used.
+    Pkt6Ptr anonymous(new Pkt6(DHCPV6_SOLICIT, 1234));
+    EXPECT_EQ(hash_value(IOAddress("fe80::1")),
+              Dhcpv6Srv::getClientAffinityKey(receive(anonymous)));
+}
+
 // This test verifies that the server is able to handle an empty DUID (client-id)
 // in incoming client message.
 TEST_F(Dhcpv6SrvTest, emptyClientId) {
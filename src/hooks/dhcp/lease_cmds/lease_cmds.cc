@@ -11,6 +11,7 @@
 #include <cc/data.h>
 #include <asiolink/io_address.h>
 #include <database/db_exceptions.h>
+#include <dhcpsrv/alloc_engine.h>
 #include <dhcpsrv/cfgmgr.h>
 #include <dhcpsrv/dhcpsrv_exceptions.h>
 #include <dhcpsrv/lease_mgr.h>
@@ -45,6 +46,76 @@ using namespace isc::stats;
 using namespace isc::util;
 using namespace std;
 
+namespace {
+
+/// @brief Updates the assigned leases counter of the pool of a lease.
+///
+/// @param lease the lease.
+/// @param delta the change of the number of assigned leases.
+void
+updatePoolAssigned(const Lease4Ptr& lease, int64_t delta) {
+    CfgMgr::instance().getCurrentCfg()->getCfgSubnets4()->
+        updatePoolAssigned(lease->subnet_id_, lease->addr_, delta);
+}
+
+/// @brief Updates the assigned leases counter of the pool of a lease.
+///
+/// @param lease the lease.
+/// @param delta the change of the number of assigned leases.
+void
+updatePoolAssigned(const Lease6Ptr& lease, int64_t delta) {
+    CfgMgr::instance().getCurrentCfg()->getCfgSubnets6()->
+        updatePoolAssigned(lease->subnet_id_, lease->type_, lease->addr_, delta);
+}
+
+/// @brief Tells the allocation engine whether the address or prefix of an
+/// added or updated lease is used.
+///
+/// The free lease queues of the server are filled when it is configured,
+/// so the lease changes made by the commands must be reported to them.
+///
+/// @param lease the added or updated lease.
+template<typename LeasePtrType>
+void
+updateFreeLeaseQueue(const LeasePtrType& lease) {
+    AllocEnginePtr alloc_engine = CfgMgr::instance().getAllocEngine();
+    if (!alloc_engine) {
+        return;
+    }
+    if (lease->stateExpiredReclaimed()) {
+        alloc_engine->leaseFreed(lease);
+    } else {
+        alloc_engine->leaseUsed(lease);
+    }
+}
+
+/// @brief Tells the allocation engine that the address or prefix of a
+/// deleted lease is free.
+///
+/// @param lease the deleted lease.
+template<typename LeasePtrType>
+void
+freeLease(const LeasePtrType& lease) {
+    AllocEnginePtr alloc_engine = CfgMgr::instance().getAllocEngine();
+    if (alloc_engine) {
+        alloc_engine->leaseFreed(lease);
+    }
+}
+
+/// @brief Tells the allocation engine that the leases of a subnet were
+/// wiped.
+///
+/// @param subnet the subnet.
+void
+freeSubnetLeases(const Subnet& subnet) {
+    AllocEnginePtr alloc_engine = CfgMgr::instance().getAllocEngine();
+    if (alloc_engine) {
+        alloc_engine->leasesWiped(subnet);
+    }
+}
+
+} // end of anonymous namespace
+
 namespace isc {
 namespace lease_cmds {
 
@@ -454,6 +525,7 @@ LeaseCmdsImpl::updateStatsOnAdd(const Lease4Ptr& lease) {
             StatsMgr::generateName("subnet", lease->subnet_id_,
                                    "assigned-addresses"),
             int64_t(1));
+        updatePoolAssigned(lease, 1);
         if (lease->stateDeclined()) {
             StatsMgr::instance().addValue("declined-addresses", int64_t(1));
 
@@ -473,6 +545,7 @@ LeaseCmdsImpl::updateStatsOnAdd(const Lease6Ptr& lease) {
                                    lease->type_ == Lease::TYPE_NA ?
                                    "assigned-nas" : "assigned-pds"),
             int64_t(1));
+        updatePoolAssigned(lease, 1);
         if (lease->stateDeclined()) {
             StatsMgr::instance().addValue("declined-addresses", int64_t(1));
 
@@ -494,6 +567,7 @@ LeaseCmdsImpl::updateStatsOnUpdate(const Lease4Ptr& existing,
                 StatsMgr::generateName("subnet", existing->subnet_id_,
                                        "assigned-addresses"),
                 int64_t(-1));
+            updatePoolAssigned(existing, -1);
         }
         if (existing->stateDeclined()) {
             // old lease is declined
@@ -511,6 +585,7 @@ LeaseCmdsImpl::updateStatsOnUpdate(const Lease4Ptr& existing,
                     StatsMgr::generateName("subnet", lease->subnet_id_,
                                            "assigned-addresses"),
                     int64_t(1));
+                updatePoolAssigned(lease, 1);
             }
             if (lease->stateDeclined()) {
                 // new lease is declined
@@ -530,6 +605,7 @@ LeaseCmdsImpl::updateStatsOnUpdate(const Lease4Ptr& existing,
                 StatsMgr::generateName("subnet", lease->subnet_id_,
                                        "assigned-addresses"),
                 int64_t(1));
+            updatePoolAssigned(lease, 1);
             if (lease->stateDeclined()) {
                 // new lease is declined
                 StatsMgr::instance().addValue("declined-addresses", int64_t(1));
@@ -554,6 +630,7 @@ LeaseCmdsImpl::updateStatsOnUpdate(const Lease6Ptr& existing,
                                        lease->type_ == Lease::TYPE_NA ?
                                        "assigned-nas" : "assigned-pds"),
                 int64_t(-1));
+            updatePoolAssigned(existing, -1);
         }
         if (existing->stateDeclined()) {
             // old lease is declined
@@ -572,6 +649,7 @@ LeaseCmdsImpl::updateStatsOnUpdate(const Lease6Ptr& existing,
                                            lease->type_ == Lease::TYPE_NA ?
                                            "assigned-nas" : "assigned-pds"),
                     int64_t(1));
+                updatePoolAssigned(lease, 1);
             }
             if (lease->stateDeclined()) {
                 // new lease is declined
@@ -592,6 +670,7 @@ LeaseCmdsImpl::updateStatsOnUpdate(const Lease6Ptr& existing,
                                        lease->type_ == Lease::TYPE_NA ?
                                        "assigned-nas" : "assigned-pds"),
                 int64_t(1));
+            updatePoolAssigned(lease, 1);
             if (lease->stateDeclined()) {
                 // new lease is declined
                 StatsMgr::instance().addValue("declined-addresses", int64_t(1));
@@ -612,6 +691,7 @@ LeaseCmdsImpl::updateStatsOnDelete(const Lease4Ptr& lease) {
             StatsMgr::generateName("subnet", lease->subnet_id_,
                                    "assigned-addresses"),
             int64_t(-1));
+        updatePoolAssigned(lease, -1);
         if (lease->stateDeclined()) {
             StatsMgr::instance().addValue("declined-addresses", int64_t(-1));
 
@@ -631,6 +711,7 @@ LeaseCmdsImpl::updateStatsOnDelete(const Lease6Ptr& lease) {
                                    lease->type_ == Lease::TYPE_NA ?
                                    "assigned-nas" : "assigned-pds"),
             int64_t(-1));
+        updatePoolAssigned(lease, -1);
         if (lease->stateDeclined()) {
             StatsMgr::instance().addValue("declined-addresses", int64_t(-1));
 
@@ -652,6 +733,7 @@ LeaseCmdsImpl::addOrUpdate4(Lease4Ptr lease, bool force_create) {
                       "lost race between calls to get and add");
         }
         LeaseCmdsImpl::updateStatsOnAdd(lease);
+        updateFreeLeaseQueue(lease);
         return (true);
     }
     if (existing) {
@@ -670,6 +752,7 @@ LeaseCmdsImpl::addOrUpdate4(Lease4Ptr lease, bool force_create) {
     }
 
     LeaseCmdsImpl::updateStatsOnUpdate(existing, lease);
+    updateFreeLeaseQueue(lease);
     return (false);
 }
 
@@ -684,6 +767,7 @@ LeaseCmdsImpl::addOrUpdate6(Lease6Ptr lease, bool force_create) {
                       "lost race between calls to get and add");
         }
         LeaseCmdsImpl::updateStatsOnAdd(lease);
+        updateFreeLeaseQueue(lease);
         return (true);
     }
     if (existing) {
@@ -702,6 +786,7 @@ LeaseCmdsImpl::addOrUpdate6(Lease6Ptr lease, bool force_create) {
     }
 
     LeaseCmdsImpl::updateStatsOnUpdate(existing, lease);
+    updateFreeLeaseQueue(lease);
     return (false);
 }
 
@@ -760,6 +845,7 @@ LeaseCmdsImpl::leaseAddHandler(CalloutHandle& handle) {
                     isc_throw(db::DuplicateEntry, "IPv4 lease already exists.");
                 }
                 LeaseCmdsImpl::updateStatsOnAdd(lease4);
+                updateFreeLeaseQueue(lease4);
                 resp << "Lease for address " << lease4->addr_.toText()
                      << ", subnet-id " << lease4->subnet_id_ << " added.";
             }
@@ -795,6 +881,7 @@ LeaseCmdsImpl::leaseAddHandler(CalloutHandle& handle) {
                     isc_throw(db::DuplicateEntry, "IPv6 lease already exists.");
                 }
                 LeaseCmdsImpl::updateStatsOnAdd(lease6);
+                updateFreeLeaseQueue(lease6);
                 if (lease6->type_ == Lease::TYPE_NA) {
                     resp << "Lease for address " << lease6->addr_.toText()
                          << ", subnet-id " << lease6->subnet_id_ << " added.";
@@ -1509,6 +1596,7 @@ LeaseCmdsImpl::lease4DelHandler(CalloutHandle& handle) {
         if (LeaseMgrFactory::instance().deleteLease(lease4)) {
             setSuccessResponse(handle, "IPv4 lease deleted.");
             LeaseCmdsImpl::updateStatsOnDelete(lease4);
+            freeLease(lease4);
         } else {
             setErrorResponse (handle, "IPv4 lease not found.", CONTROL_RESULT_EMPTY);
         }
@@ -1614,6 +1702,7 @@ LeaseCmdsImpl::lease6BulkApplyHandler(CalloutHandle& handle) {
                         if (LeaseMgrFactory::instance().deleteLease(lease)) {
                             ++success_count;
                             LeaseCmdsImpl::updateStatsOnDelete(lease);
+                            freeLease(lease);
 
                         } else {
                             // Lazy creation of the list of leases which failed to delete.
@@ -1775,6 +1864,7 @@ LeaseCmdsImpl::lease6DelHandler(CalloutHandle& handle) {
         if (LeaseMgrFactory::instance().deleteLease(lease6)) {
             setSuccessResponse(handle, "IPv6 lease deleted.");
             LeaseCmdsImpl::updateStatsOnDelete(lease6);
+            freeLease(lease6);
         } else {
             setErrorResponse (handle, "IPv6 lease not found.", CONTROL_RESULT_EMPTY);
         }
@@ -1933,6 +2023,13 @@ LeaseCmdsImpl::lease4WipeHandler(CalloutHandle& handle) {
                 StatsMgr::generateName("subnet", id, "assigned-addresses"),
                 int64_t(0));
 
+            ConstSubnet4Ptr subnet = CfgMgr::instance().getCurrentCfg()->
+                getCfgSubnets4()->getBySubnetId(id);
+            if (subnet) {
+                subnet->resetPoolAssigned(Lease::TYPE_V4);
+                freeSubnetLeases(*subnet);
+            }
+
             StatsMgr::instance().setValue(
                 StatsMgr::generateName("subnet", id, "declined-addresses"),
                 int64_t(0));
@@ -1951,6 +2048,8 @@ LeaseCmdsImpl::lease4WipeHandler(CalloutHandle& handle) {
                 StatsMgr::instance().setValue(
                     StatsMgr::generateName("subnet", sub->getID(), "assigned-addresses"),
                     int64_t(0));
+                sub->resetPoolAssigned(Lease::TYPE_V4);
+                freeSubnetLeases(*sub);
 
                 StatsMgr::instance().setValue(
                     StatsMgr::generateName("subnet", sub->getID(), "declined-addresses"),
@@ -2017,6 +2116,15 @@ LeaseCmdsImpl::lease6WipeHandler(CalloutHandle& handle) {
                 StatsMgr::generateName("subnet", id, "assigned-pds"),
                 int64_t(0));
 
+            ConstSubnet6Ptr subnet = CfgMgr::instance().getCurrentCfg()->
+                getCfgSubnets6()->getBySubnetId(id);
+            if (subnet) {
+                subnet->resetPoolAssigned(Lease::TYPE_NA);
+                subnet->resetPoolAssigned(Lease::TYPE_TA);
+                subnet->resetPoolAssigned(Lease::TYPE_PD);
+                freeSubnetLeases(*subnet);
+            }
+
             StatsMgr::instance().setValue(
                 StatsMgr::generateName("subnet", id, "declined-addresses"),
                 int64_t(0));
@@ -2039,6 +2147,10 @@ LeaseCmdsImpl::lease6WipeHandler(CalloutHandle& handle) {
                 StatsMgr::instance().setValue(
                     StatsMgr::generateName("subnet", sub->getID(), "assigned-pds"),
                     int64_t(0));
+                sub->resetPoolAssigned(Lease::TYPE_NA);
+                sub->resetPoolAssigned(Lease::TYPE_TA);
+                sub->resetPoolAssigned(Lease::TYPE_PD);
+                freeSubnetLeases(*sub);
 
                 StatsMgr::instance().setValue(
                     StatsMgr::generateName("subnet", sub->getID(), "declined-addresses"),
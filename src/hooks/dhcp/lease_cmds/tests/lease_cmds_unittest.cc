@@ -9,6 +9,7 @@
 #include <exceptions/exceptions.h>
 #include <hooks/hooks_manager.h>
 #include <config/command_mgr.h>
+#include <dhcpsrv/alloc_engine.h>
 #include <dhcpsrv/lease_mgr.h>
 #include <dhcpsrv/lease_mgr_factory.h>
 #include <dhcpsrv/ncr_generator.h>
@@ -288,6 +289,7 @@ public:
         // destroys lease manager first because the other order triggers
         // a clang/boost bug
         LeaseMgrFactory::destroy();
+        CfgMgr::instance().setAllocEngine(AllocEnginePtr());
         disableD2();
         unloadLibs();
         lmptr_ = 0;
@@ -1199,6 +1201,10 @@ public:
     /// deleted.
     void testLease4WipeNoLeasesAll();
 
+    /// @brief Check that lease4-add, lease4-update, lease4-del and
+    /// lease4-wipe keep the free lease queue of the server up to date.
+    void testLease4FreeLeaseQueue();
+
     /// @brief Check that lease6-wipe can remove leases.
     void testLease6Wipe();
 
@@ -7146,6 +7152,136 @@ TEST_F(LeaseCmdsTest, lease4WipeNoLeasesAllMultiThreading) {
     testLease4WipeNoLeasesAll();
 }
 
+void LeaseCmdsTest::testLease4FreeLeaseQueue() {
+
+    // Initialize lease manager (false = v4, false = don't add leases)
+    initLeaseMgr(false, false);
+
+    // Subnet 44 picks the addresses of its pool from a free lease queue.
+    Subnet4Ptr subnet = CfgMgr::instance().getCurrentCfg()->
+        getCfgSubnets4()->getSubnet(44);
+    ASSERT_TRUE(subnet);
+    subnet->addPool(Pool4Ptr(new Pool4(IOAddress("192.0.2.1"),
+                                       IOAddress("192.0.2.3"))));
+    subnet->setAllocatorType("flq");
+
+    AllocEnginePtr engine(new AllocEngine(AllocEngine::ALLOC_ITERATIVE,
+                                          0, false));
+    ASSERT_NO_THROW(engine->initFreeLeaseQueues(CfgMgr::instance().
+        getCurrentCfg()->getCfgSubnets4()));
+    CfgMgr::instance().setAllocEngine(engine);
+
+    // Returns the free addresses of the queue.
+    auto free_addresses = [&engine, &subnet]() {
+        auto allocator = engine->getAllocator(Lease::TYPE_V4,
+                                              AllocEngine::ALLOC_FLQ);
+        std::set<std::string> addresses;
+        for (int i = 0; i < 3; ++i) {
+            IOAddress address = allocator->pickAddress(subnet, ClientClasses(),
+                                                       DuidPtr(),
+                                                       IOAddress("0.0.0.0"));
+            if (!address.isV4Zero()) {
+                addresses.insert(address.toText());
+            }
+        }
+        return (addresses);
+    };
+    EXPECT_EQ(3, free_addresses().size());
+
+    // Add a lease.
+    string cmd =
+        "{\n"
+        "    \"command\": \"lease4-add\",\n"
+        "    \"arguments\": {"
+        "        \"subnet-id\": 44,\n"
+        "        \"ip-address\": \"192.0.2.1\",\n"
+        "        \"hw-address\": \"1a:1b:1c:1d:1e:1f\"\n"
+        "    }\n"
+        "}";
+    testCommand(cmd, CONTROL_RESULT_SUCCESS,
+                "Lease for address 192.0.2.1, subnet-id 44 added.");
+    std::set<std::string> expected = { "192.0.2.2", "192.0.2.3" };
+    EXPECT_EQ(expected, free_addresses());
+
+    // Create another lease by updating it.
+    cmd =
+        "{\n"
+        "    \"command\": \"lease4-update\",\n"
+        "    \"arguments\": {"
+        "        \"subnet-id\": 44,\n"
+        "        \"ip-address\": \"192.0.2.2\",\n"
+        "        \"hw-address\": \"2a:2b:2c:2d:2e:2f\",\n"
+        "        \"force-create\": true"
+        "    }\n"
+        "}";
+    testCommand(cmd, CONTROL_RESULT_SUCCESS, "IPv4 lease added.");
+    expected = { "192.0.2.3" };
+    EXPECT_EQ(expected, free_addresses());
+
+    // Delete the first lease.
+    cmd =
+        "{\n"
+        "    \"command\": \"lease4-del\",\n"
+        "    \"arguments\": {"
+        "        \"ip-address\": \"192.0.2.1\""
+        "    }\n"
+        "}";
+    testCommand(cmd, CONTROL_RESULT_SUCCESS, "IPv4 lease deleted.");
+    expected = { "192.0.2.1", "192.0.2.3" };
+    EXPECT_EQ(expected, free_addresses());
+
+    // An expired-reclaimed lease is free.
+    cmd =
+        "{\n"
+        "    \"command\": \"lease4-update\",\n"
+        "    \"arguments\": {"
+        "        \"subnet-id\": 44,\n"
+        "        \"ip-address\": \"192.0.2.2\",\n"
+        "        \"hw-address\": \"2a:2b:2c:2d:2e:2f\",\n"
+        "        \"state\": 2"
+        "    }\n"
+        "}";
+    testCommand(cmd, CONTROL_RESULT_SUCCESS, "IPv4 lease updated.");
+    EXPECT_EQ(3, free_addresses().size());
+
+    // Use all the addresses again, then wipe the leases of the subnet.
+    ASSERT_TRUE(lmptr_->addLease(createLease4("192.0.2.1", 44, 0x08, 0x42)));
+    engine->leaseUsed(lmptr_->getLease4(IOAddress("192.0.2.1")));
+    ASSERT_TRUE(lmptr_->addLease(createLease4("192.0.2.3", 44, 0x09, 0x56)));
+    engine->leaseUsed(lmptr_->getLease4(IOAddress("192.0.2.3")));
+    cmd =
+        "{\n"
+        "    \"command\": \"lease4-update\",\n"
+        "    \"arguments\": {"
+        "        \"subnet-id\": 44,\n"
+        "        \"ip-address\": \"192.0.2.2\",\n"
+        "        \"hw-address\": \"2a:2b:2c:2d:2e:2f\""
+        "    }\n"
+        "}";
+    testCommand(cmd, CONTROL_RESULT_SUCCESS, "IPv4 lease updated.");
+    EXPECT_TRUE(free_addresses().empty());
+
+    cmd =
+        "{\n"
+        "    \"command\": \"lease4-wipe\",\n"
+        "    \"arguments\": {"
+        "        \"subnet-id\": 44"
+        "    }\n"
+        "}";
+    testCommand(cmd, CONTROL_RESULT_SUCCESS,
+                "Deleted 3 IPv4 lease(s) from subnet(s) 44");
+    EXPECT_EQ(3, free_addresses().size());
+}
+
+TEST_F(LeaseCmdsTest, lease4FreeLeaseQueue) {
+    testLease4FreeLeaseQueue();
+}
+
+TEST_F(LeaseCmdsTest, lease4FreeLeaseQueueMultiThreading) {
+    MultiThreadingTest mt(true);
+    testLease4FreeLeaseQueue();
+}
+
 void LeaseCmdsTest::testLease6Wipe() {
 
     // Initialize lease manager (true = v6, true = add leases)
@@ -425,6 +425,52 @@ IOAddress offsetAddress(const IOAddress& addr, uint64_t offset) {
     return (IOAddress::fromBytes(AF_INET6, &addr_bytes[0]));
 }
 
+IOAddress offsetPrefix(const IOAddress& prefix, uint64_t index,
+                       const uint8_t delegated_len) {
+    if (!prefix.isV6()) {
+        isc_throw(BadValue, "Prefix " << prefix << " is not an IPv6 prefix");
+    }
+    if (delegated_len > 128) {
+        isc_throw(BadValue, "Invalid delegated prefix length "
+                  << static_cast<unsigned>(delegated_len));
+    }
+
+    // There is nothing to do if the index is 0 or the prefix length 0.
+    unsigned shift = 128 - delegated_len;
+    if ((index == 0) || (shift == 128)) {
+        return (prefix);
+    }
+
+    // The offset is index << shift: its bits begin at the bit shift of
+    // the address, i.e. in the byte (shift / 8) counted from the end.
+    auto addr_bytes = prefix.toBytes();
+    int byte_idx = 15 - static_cast<int>(shift / 8);
+    unsigned bit_shift = shift % 8;
+
+    // Sum up the bytes from the first byte of the offset. The offset spans
+    // 64 + bit_shift bits, i.e. up to 9 bytes.
+    uint16_t carry = 0;
+    uint64_t remaining = index;
+    uint8_t spill = 0;
+    for (int i = byte_idx; (i >= 0) && ((remaining > 0) || (spill > 0) ||
+                                        (carry > 0)); --i) {
+        // The next byte of the offset is the low bits of the remaining
+        // index shifted left, plus the bits shifted out of the previous
+        // byte.
+        uint16_t offset_byte = static_cast<uint8_t>(remaining << bit_shift) | spill;
+        spill = (bit_shift > 0) ?
+            static_cast<uint8_t>((remaining & 0xff) >> (8 - bit_shift)) : 0;
+        remaining = remaining >> 8;
+
+        uint16_t sum = static_cast<uint16_t>(addr_bytes[i]) + offset_byte + carry;
+        addr_bytes[i] = sum % 256;
+        carry = sum / 256;
+    }
+
+    // Reconstruct IPv6 prefix from the vector.
+    return (IOAddress::fromBytes(AF_INET6, &addr_bytes[0]));
+}
+
 
 };
 };
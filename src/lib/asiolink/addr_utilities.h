@@ -92,6 +92,24 @@ uint64_t prefixesInRange(const uint8_t pool_len, const uint8_t delegated_len);
 /// @return address being offset greater than the input address
 IOAddress offsetAddress(const IOAddress& addr, uint64_t offset);
 
+/// @brief Finds the prefix following an IPv6 prefix by a number of prefixes.
+///
+/// Adds index times the size of the delegated prefixes to the IPv6 prefix.
+/// Unlike @c offsetAddress the offset may exceed 64 bits, e.g. the 1000th
+/// /48 prefix after 2001:db8::. The result wraps around when the sum
+/// exceeds the maximum IPv6 address.
+///
+/// @param prefix input prefix
+/// @param index number of delegated prefixes between the input prefix and
+///        the returned prefix
+/// @param delegated_len length of the delegated prefixes
+/// @return prefix being index delegated prefixes greater than the input
+/// prefix
+/// @throw BadValue if the input prefix is not an IPv6 prefix or the
+/// delegated prefix length is greater than 128.
+IOAddress offsetPrefix(const IOAddress& prefix, uint64_t index,
+                       const uint8_t delegated_len);
+
 };
 };
 
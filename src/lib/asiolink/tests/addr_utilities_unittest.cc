@@ -383,4 +383,22 @@ TEST(AddrUtilitiesTest, offsetIPv6Address) {
     EXPECT_EQ("3000::1c", offsetAddress(IOAddress("3000::15"), 7).toText());
 }
 
+// Checks the function which finds an IPv6 prefix from input prefix and index.
+TEST(AddrUtilitiesTest, offsetPrefix) {
+    EXPECT_EQ("2001:db8::", offsetPrefix(IOAddress("2001:db8::"), 0, 48).toText());
+    EXPECT_EQ("2001:db8:3e8::", offsetPrefix(IOAddress("2001:db8::"), 1000, 48).toText());
+    EXPECT_EQ("2001:db8:0:10::", offsetPrefix(IOAddress("2001:db8::"), 1, 60).toText());
+    EXPECT_EQ("2001:db8:0:1f0::", offsetPrefix(IOAddress("2001:db8::"), 31, 60).toText());
+    EXPECT_EQ("3000::1c", offsetPrefix(IOAddress("3000::15"), 7, 128).toText());
+    // The offset exceeds 64 bits.
+    EXPECT_EQ("2001:db9::", offsetPrefix(IOAddress("2001:db8:ffff::"), 1, 48).toText());
+    EXPECT_EQ("2001:db8:ffff:ffff:ffff:ffff::",
+              offsetPrefix(IOAddress("2001:db8::"), 0xFFFFFFFFFFFFFFFF, 96).toText());
+    EXPECT_EQ("3fff:ffff:ffff:ffff:e000::",
+              offsetPrefix(IOAddress("2000::"), 0xFFFFFFFFFFFFFFFF, 3 + 64).toText());
+    // Only IPv6 prefixes and valid lengths are accepted.
+    EXPECT_THROW(offsetPrefix(IOAddress("10.0.0.0"), 1, 24), isc::BadValue);
+    EXPECT_THROW(offsetPrefix(IOAddress("2001:db8::"), 1, 129), isc::BadValue);
+}
+
 }; // end of anonymous namespace
@@ -221,7 +221,10 @@ DatabaseConnection::toElement(const ParameterMap& params) {
             (keyword == "request-timeout") ||
             (keyword == "tcp-keepalive") ||
             (keyword == "port") ||
-            (keyword == "max-row-errors")) {
+            (keyword == "max-row-errors") ||
+            (keyword == "flush-records") ||
+            (keyword == "flush-interval") ||
+            (keyword == "write-queue-size")) {
             // integer parameters
             int64_t int_value;
             try {
@@ -250,7 +253,8 @@ DatabaseConnection::toElement(const ParameterMap& params) {
                    (keyword == "contact-points") ||
                    (keyword == "consistency") ||
                    (keyword == "serial-consistency") ||
-                   (keyword == "keyspace")) {
+                   (keyword == "keyspace") ||
+                   (keyword == "write-queue-full")) {
             result->set(keyword, isc::data::Element::create(value));
         } else {
             LOG_ERROR(database_logger, DATABASE_TO_JSON_ERROR)
@@ -55,6 +55,9 @@ DbAccessParser::parse(std::string& access_string,
     int64_t request_timeout = 0;
     int64_t tcp_keepalive = 0;
     int64_t max_row_errors = 0;
+    int64_t flush_records = 1;
+    int64_t flush_interval = 0;
+    int64_t write_queue_size = 0;
 
     // 2. Update the copy with the passed keywords.
     for (std::pair<std::string, ConstElementPtr> param : database_config->mapValue()) {
@@ -104,6 +107,21 @@ DbAccessParser::parse(std::string& access_string,
                 max_row_errors = param.second->intValue();
                 values_copy[param.first] =
                     boost::lexical_cast<std::string>(max_row_errors);
+
+            } else if (param.first == "flush-records") {
+                flush_records = param.second->intValue();
+                values_copy[param.first] =
+                    boost::lexical_cast<std::string>(flush_records);
+
+            } else if (param.first == "flush-interval") {
+                flush_interval = param.second->intValue();
+                values_copy[param.first] =
+                    boost::lexical_cast<std::string>(flush_interval);
+
+            } else if (param.first == "write-queue-size") {
+                write_queue_size = param.second->intValue();
+                values_copy[param.first] =
+                    boost::lexical_cast<std::string>(write_queue_size);
             } else {
 
                 // all remaining string parameters
@@ -116,6 +134,7 @@ DbAccessParser::parse(std::string& access_string,
                 // keyspace
                 // consistency
                 // serial-consistency
+                // write-queue-full
                 values_copy[param.first] = param.second->stringValue();
             }
         } catch (const isc::data::TypeError& ex) {
@@ -191,6 +210,47 @@ DbAccessParser::parse(std::string& access_string,
                   << " (" << value->getPosition() << ")");
     }
 
+    // g. Check that the flush-records is within a reasonable range.
+    if ((flush_records < 0) ||
+        (flush_records > std::numeric_limits<uint32_t>::max())) {
+        ConstElementPtr value = database_config->get("flush-records");
+        isc_throw(DbConfigError, "flush-records value: " << flush_records
+                  << " is out of range, expected value: 0.."
+                  << std::numeric_limits<uint32_t>::max()
+                  << " (" << value->getPosition() << ")");
+    }
+
+    // h. Check that the flush-interval is within a reasonable range.
+    if ((flush_interval < 0) ||
+        (flush_interval > std::numeric_limits<uint32_t>::max())) {
+        ConstElementPtr value = database_config->get("flush-interval");
+        isc_throw(DbConfigError, "flush-interval value: " << flush_interval
+                  << " is out of range, expected value: 0.."
+                  << std::numeric_limits<uint32_t>::max()
+                  << " (" << value->getPosition() << ")");
+    }
+
+    // i. Check that the write-queue-size is within a reasonable range.
+    if ((write_queue_size < 0) ||
+        (write_queue_size > std::numeric_limits<uint32_t>::max())) {
+        ConstElementPtr value = database_config->get("write-queue-size");
+        isc_throw(DbConfigError, "write-queue-size value: " << write_queue_size
+                  << " is out of range, expected value: 0.."
+                  << std::numeric_limits<uint32_t>::max()
+                  << " (" << value->getPosition() << ")");
+    }
+
+    // j. Check that the write-queue-full is a known policy.
+    ConstElementPtr write_queue_full = database_config->get("write-queue-full");
+    if (write_queue_full &&
+        (write_queue_full->stringValue() != "block") &&
+        (write_queue_full->stringValue() != "drop")) {
+        isc_throw(DbConfigError, "write-queue-full value: "
+                  << write_queue_full->stringValue()
+                  << " is invalid, expected value: block or drop"
+                  << " (" << write_queue_full->getPosition() << ")");
+    }
+
     // Check that the max-reconnect-tries is reasonable.
     if (max_reconnect_tries < 0) {
         ConstElementPtr value = database_config->get("max-reconnect-tries");
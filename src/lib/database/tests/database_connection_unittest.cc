@@ -527,6 +527,8 @@ TEST(DatabaseConnection, toElementDbAccessStringValid) {
         "\"connect-timeout\" : 200, \n"
         "\"contact-points\": \"contact_str\", \n"
         "\"consistency\": \"quorum\", \n"
+        "\"flush-interval\" : 10, \n"
+        "\"flush-records\" : 64, \n"
         "\"serial-consistency\": \"serial\", \n"
         "\"host\": \"host_str\", \n"
         "\"keyspace\": \"keyspace_str\", \n"
@@ -544,6 +546,8 @@ TEST(DatabaseConnection, toElementDbAccessStringValid) {
         "\"tcp-nodelay\": false, \n"
         "\"type\": \"memfile\", \n"
         "\"user\": \"user_str\", \n"
+        "\"write-queue-full\": \"drop\", \n"
+        "\"write-queue-size\": 1024, \n"
         "\"max-row-errors\": 50 \n"
         "}\n"
     };
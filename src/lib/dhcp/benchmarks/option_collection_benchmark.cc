@@ -0,0 +1,145 @@
+// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <benchmark/benchmark.h>
+#include <dhcp/libdhcp++.h>
+#include <dhcp/option.h>
+#include <util/buffer.h>
+
+#include <map>
+#include <vector>
+
+using namespace isc::dhcp;
+using namespace isc::util;
+
+namespace {
+
+/// @brief The option collection used before the flat collection, for
+/// comparison.
+typedef std::multimap<unsigned int, OptionPtr> OptionMultimap;
+
+/// @brief Creates options.
+///
+/// The option codes are spread over the DHCPv4 code space and the
+/// options are created in a shuffled order, as when a server builds a
+/// response.
+///
+/// @param count number of options.
+std::vector<OptionPtr>
+createOptions(size_t count) {
+    std::vector<OptionPtr> options;
+    for (size_t i = 0; i < count; ++i) {
+        uint16_t code = static_cast<uint16_t>(1 + (i * 97) % 250);
+        OptionBuffer data(4, static_cast<uint8_t>(i));
+        options.push_back(OptionPtr(new Option(Option::V4, code, data)));
+    }
+    return (options);
+}
+
+/// @brief Fills a collection with options.
+///
+/// @param options the options.
+/// @param [out] collection the collection.
+template<typename Collection>
+void
+fillCollection(const std::vector<OptionPtr>& options, Collection& collection) {
+    for (auto const& option : options) {
+        collection.insert(std::make_pair(option->getType(), option));
+    }
+}
+
+/// @brief Benchmarks building a collection.
+///
+/// @param state benchmark state, the range is the number of options.
+template<typename Collection>
+void
+buildCollection(benchmark::State& state) {
+    std::vector<OptionPtr> options = createOptions(state.range(0));
+    for (auto _ : state) {
+        Collection collection;
+        fillCollection(options, collection);
+        benchmark::DoNotOptimize(collection);
+    }
+}
+
+/// @brief Number of collections used by the lookup benchmarks.
+///
+/// A server handles many packets at once: the lookups rotate over many
+/// collections, filled together, so they don't all stay in the caches.
+const size_t COLLECTION_COUNT = 1024;
+
+/// @brief Benchmarks looking up each option of collections and as many
+/// missing options.
+///
+/// @param state benchmark state, the range is the number of options.
+template<typename Collection>
+void
+lookupCollection(benchmark::State& state) {
+    std::vector<OptionPtr> options = createOptions(state.range(0));
+    std::vector<Collection> collections(COLLECTION_COUNT);
+    for (auto const& option : options) {
+        for (auto& collection : collections) {
+            collection.insert(std::make_pair(option->getType(), option));
+        }
+    }
+    size_t index = 0;
+    for (auto _ : state) {
+        const Collection& collection = collections[index];
+        for (auto const& option : options) {
+            benchmark::DoNotOptimize(collection.find(option->getType()));
+            benchmark::DoNotOptimize(collection.find(option->getType() + 1));
+        }
+        index = (index + 1) % COLLECTION_COUNT;
+    }
+}
+
+/// @brief Benchmarks packing the options of a collection.
+///
+/// @param state benchmark state, the range is the number of options.
+template<typename Collection>
+void
+packCollection(benchmark::State& state) {
+    std::vector<OptionPtr> options = createOptions(state.range(0));
+    Collection collection;
+    fillCollection(options, collection);
+    OutputBuffer buf(1024);
+    for (auto _ : state) {
+        buf.clear();
+        for (auto const& option : collection) {
+            option.second->pack(buf);
+        }
+        benchmark::DoNotOptimize(buf.getData());
+    }
+}
+
+/// @brief Benchmarks packing the options of a packet.
+///
+/// @param state benchmark state, the range is the number of options.
+void
+packOptions4(benchmark::State& state) {
+    std::vector<OptionPtr> options = createOptions(state.range(0));
+    OptionCollection collection;
+    fillCollection(options, collection);
+    OutputBuffer buf(1024);
+    for (auto _ : state) {
+        buf.clear();
+        LibDHCP::packOptions4(buf, collection);
+        benchmark::DoNotOptimize(buf.getData());
+    }
+}
+
+}
+
+/// A packet carries from a few options to a few tens of options.
+BENCHMARK_TEMPLATE(buildCollection, OptionMultimap)->Range(4, 64);
+BENCHMARK_TEMPLATE(buildCollection, OptionCollection)->Range(4, 64);
+BENCHMARK_TEMPLATE(lookupCollection, OptionMultimap)->Range(4, 64);
+BENCHMARK_TEMPLATE(lookupCollection, OptionCollection)->Range(4, 64);
+BENCHMARK_TEMPLATE(packCollection, OptionMultimap)->Range(4, 64);
+BENCHMARK_TEMPLATE(packCollection, OptionCollection)->Range(4, 64);
+BENCHMARK(packOptions4)->Range(4, 64);
@@ -73,18 +73,22 @@ DUID::EMPTY() {
 }
 
 std::string DUID::toText() const {
-    std::stringstream tmp;
-    tmp << std::hex;
+    // This is called for each lease written to the lease file so the
+    // digits are appended directly rather than through a string stream.
+    static const char digits[] = "0123456789abcdef";
+    std::string text;
+    text.reserve(duid_.size() * 3);
     bool delim = false;
     for (std::vector<uint8_t>::const_iterator it = duid_.begin();
          it != duid_.end(); ++it) {
         if (delim) {
-            tmp << ":";
+            text += ':';
         }
-        tmp << std::setw(2) << std::setfill('0') << static_cast<unsigned int>(*it);
+        text += digits[*it >> 4];
+        text += digits[*it & 0xf];
         delim = true;
     }
-    return (tmp.str());
+    return (text);
 }
 
 bool DUID::operator==(const DUID& other) const {
@@ -49,21 +49,25 @@ HWAddr::HWAddr(const std::vector<uint8_t>& hwaddr, uint16_t htype)
 }
 
 std::string HWAddr::toText(bool include_htype) const {
-    std::stringstream tmp;
+    // This is called for each lease written to the lease file so the
+    // digits are appended directly rather than through a string stream.
+    static const char digits[] = "0123456789abcdef";
+    std::string text;
     if (include_htype) {
-        tmp << "hwtype=" << static_cast<unsigned int>(htype_) << " ";
+        text = "hwtype=" + std::to_string(static_cast<unsigned int>(htype_)) + " ";
     }
-    tmp << std::hex;
+    text.reserve(text.size() + hwaddr_.size() * 3);
     bool delim = false;
     for (std::vector<uint8_t>::const_iterator it = hwaddr_.begin();
          it != hwaddr_.end(); ++it) {
         if (delim) {
-            tmp << ":";
+            text += ':';
         }
-        tmp << std::setw(2) << std::setfill('0') << static_cast<unsigned int>(*it);
+        text += digits[*it >> 4];
+        text += digits[*it & 0xf];
         delim = true;
     }
-    return (tmp.str());
+    return (text);
 }
 
 HWAddr
@@ -187,7 +187,16 @@ IfaceMgr::IfaceMgr()
     : packet_filter_(new PktFilterInet()),
       packet_filter6_(new PktFilterInet6()),
       test_mode_(false),
-      allow_loopback_(false) {
+      allow_loopback_(false),
+      receive_batch_size_(1),
+      fd_event_handler_type_(FDEventHandler::TYPE_SELECT),
+      fd_event_handler_(new SelectEventHandler()),
+      fd_set_content_(FD_SET_NONE),
+      sockets_generation_(1), fd_set_generation_(0),
+      packet_mmap_(false),
+      socket_shards_(1),
+      shard_receivers_(1), shard_interrupt_(new WatchSocket()),
+      queue_ready_(new WatchEvent()) {
 
     // Ensure that PQMs have been created to guarantee we have
     // default packet queues in place.
@@ -293,6 +302,8 @@ void IfaceMgr::closeSockets() {
     for (IfacePtr iface : ifaces_) {
         iface->closeSockets();
     }
+
+    ++sockets_generation_;
 }
 
 void IfaceMgr::stopDHCPReceiver() {
@@ -301,6 +312,8 @@ void IfaceMgr::stopDHCPReceiver() {
     }
 
     dhcp_receiver_.reset();
+    queue_ready_->clearReady();
+    ++sockets_generation_;
 
     if (getPacketQueue4()) {
         getPacketQueue4()->clear();
@@ -341,6 +354,7 @@ IfaceMgr::addExternalSocket(int socketfd, SocketCallback callback) {
     x.socket_ = socketfd;
     x.callback_ = callback;
     callbacks_.push_back(x);
+    ++sockets_generation_;
 }
 
 void
@@ -355,6 +369,7 @@ IfaceMgr::deleteExternalSocketInternal(int socketfd) {
          s != callbacks_.end(); ++s) {
         if (s->socket_ == socketfd) {
             callbacks_.erase(s);
+            ++sockets_generation_;
             return;
         }
     }
@@ -382,6 +397,7 @@ void
 IfaceMgr::deleteAllExternalSockets() {
     std::lock_guard<std::mutex> lock(callbacks_mutex_);
     callbacks_.clear();
+    ++sockets_generation_;
 }
 
 void
@@ -750,6 +766,7 @@ IfaceMgr::startDHCPReceiver(const uint16_t family) {
 
         dhcp_receiver_.reset(new WatchedThread());
         dhcp_receiver_->start(std::bind(&IfaceMgr::receiveDHCP4Packets, this));
+        ++sockets_generation_;
         break;
     case AF_INET6:
         // If the queue doesn't exist, packet queing has been configured
@@ -760,6 +777,7 @@ IfaceMgr::startDHCPReceiver(const uint16_t family) {
 
         dhcp_receiver_.reset(new WatchedThread());
         dhcp_receiver_->start(std::bind(&IfaceMgr::receiveDHCP6Packets, this));
+        ++sockets_generation_;
         break;
     default:
         isc_throw (BadValue, "startDHCPReceiver: invalid family: " << family);
@@ -778,6 +796,7 @@ IfaceMgr::addInterface(const IfacePtr& iface) {
         }
     }
     ifaces_.push_back(iface);
+    ++sockets_generation_;
 }
 
 void
@@ -899,6 +918,7 @@ IfaceMgr::getIface(const PktPtr& pkt) {
 void
 IfaceMgr::clearIfaces() {
     ifaces_.clear();
+    ++sockets_generation_;
 }
 
 void
@@ -1090,13 +1110,51 @@ IfaceMgr::openSocket4(Iface& iface, const IOAddress& addr,
                           const bool send_bcast) {
 
     // Assuming that packet filter is not null, because its modifier checks it.
+    if (socket_shards_ > 1) {
+        return (addSocketShards(iface,
+                                packet_filter_->openSocketShards(iface, addr, port,
+                                                                 receive_bcast,
+                                                                 send_bcast,
+                                                                 socket_shards_)));
+    }
     SocketInfo info = packet_filter_->openSocket(iface, addr, port,
                                                  receive_bcast, send_bcast);
     iface.addSocket(info);
+    ++sockets_generation_;
 
     return (info.sockfd_);
 }
 
+int
+IfaceMgr::addSocketShards(Iface& iface, std::vector<SocketInfo> sockets) {
+    for (size_t shard = 0; shard < sockets.size(); ++shard) {
+        sockets[shard].shard_ = shard;
+        iface.addSocket(sockets[shard]);
+    }
+    ++sockets_generation_;
+
+    return (sockets.empty() ? -1 : sockets[0].sockfd_);
+}
+
+void
+IfaceMgr::delSocketShards(Iface& iface, const int sockfd) {
+    std::vector<int> shards;
+    for (const SocketInfo& s : iface.getSockets()) {
+        if (s.sockfd_ == sockfd) {
+            for (const SocketInfo& other : iface.getSockets()) {
+                if ((other.addr_ == s.addr_) && (other.port_ == s.port_)) {
+                    shards.push_back(other.sockfd_);
+                }
+            }
+            break;
+        }
+    }
+    for (int fd : shards) {
+        iface.delSocket(fd);
+    }
+    ++sockets_generation_;
+}
+
 bool
 IfaceMgr::send(const Pkt6Ptr& pkt) {
     IfacePtr iface = getIface(pkt);
@@ -1123,66 +1181,357 @@ IfaceMgr::send(const Pkt4Ptr& pkt) {
     return (packet_filter_->send(*iface, getSocket(pkt).sockfd_, pkt) == 0);
 }
 
-Pkt4Ptr IfaceMgr::receive4(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */) {
+void
+IfaceMgr::setReceiveBatchSize(const size_t batch_size) {
+    if ((batch_size == 0) || (batch_size > MAX_RECEIVE_BATCH_SIZE)) {
+        isc_throw(BadValue, "receive batch size must be between 1 and "
+                  << MAX_RECEIVE_BATCH_SIZE << ", got " << batch_size);
+    }
+    receive_batch_size_ = batch_size;
+}
+
+void
+IfaceMgr::setFDEventHandlerType(const FDEventHandler::HandlerType type) {
     if (isDHCPReceiverRunning()) {
-        return (receive4Indirect(timeout_sec, timeout_usec));
+        isc_throw(InvalidOperation, "Cannot change the event handler"
+                  " while DHCP receiver thread is running");
     }
+    if (type == fd_event_handler_type_) {
+        return;
+    }
+    // This throws when the type is not supported so the current handler
+    // is kept.
+    fd_event_handler_ = FDEventHandlerFactory::factoryFDEventHandler(type);
+    fd_event_handler_type_ = type;
+    fd_set_content_ = FD_SET_NONE;
+    fd_set_ifaces_.clear();
+    ++sockets_generation_;
+}
 
-    return (receive4Direct(timeout_sec, timeout_usec));
+void
+IfaceMgr::setSocketShards(const size_t shards) {
+    if ((shards == 0) || (shards > MAX_SOCKET_SHARDS)) {
+        isc_throw(BadValue, "number of socket shards must be between 1 and "
+                  << MAX_SOCKET_SHARDS << ", got " << shards);
+    }
+    if (shards == socket_shards_) {
+        return;
+    }
+    socket_shards_ = shards;
+    shard_receivers_.clear();
+    shard_receivers_.resize(shards);
+    ++sockets_generation_;
 }
 
-Pkt4Ptr IfaceMgr::receive4Indirect(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */) {
-    // Sanity check for microsecond timeout.
-    if (timeout_usec >= 1000000) {
-        isc_throw(BadValue, "fractional timeout must be shorter than"
-                  " one million microseconds");
+void
+IfaceMgr::interruptShardReceivers() {
+    shard_interrupt_->markReady();
+}
+
+void
+IfaceMgr::resumeShardReceivers() {
+    shard_interrupt_->clearReady();
+}
+
+void
+IfaceMgr::prepareFDEventHandler(const FDSetContent content) {
+    uint64_t generation = sockets_generation_;
+    if ((fd_set_generation_ == generation) && (fd_set_content_ == content)) {
+        return;
     }
 
-    fd_set sockets;
-    int maxfd = 0;
+    // Take the generation first so a change made while the set is rebuilt
+    // triggers another rebuild.
+    fd_set_generation_ = generation;
+    fd_set_content_ = FD_SET_NONE;
+    fd_set_ifaces_.clear();
+    fd_event_handler_->clear();
+
+    // When the sockets are sharded they are watched by the shard receivers.
+    if (((content == FD_SET_SOCKETS4) || (content == FD_SET_SOCKETS6)) &&
+        (socket_shards_ <= 1)) {
+        for (IfacePtr iface : ifaces_) {
+            for (const SocketInfo& s : iface->getSockets()) {
+                // Only deal with addresses of the requested family.
+                if ((content == FD_SET_SOCKETS4) ? s.addr_.isV4() :
+                    s.addr_.isV6()) {
+                    fd_event_handler_->add(s.sockfd_);
+                    fd_set_ifaces_[s.sockfd_] = iface;
+                }
+            }
+        }
+    } else if (content == FD_SET_QUEUE) {
+        // Add queue ready watch event
+        fd_event_handler_->add(queue_ready_->getSelectFd());
 
-    FD_ZERO(&sockets);
+        // Add Receiver error watch socket
+        fd_event_handler_->add(dhcp_receiver_->getWatchFd(WatchedThread::ERROR));
+    }
 
     // if there are any callbacks for external sockets registered...
     {
         std::lock_guard<std::mutex> lock(callbacks_mutex_);
-        if (!callbacks_.empty()) {
-            for (SocketCallbackInfo s : callbacks_) {
-                // Add this socket to listening set
-                addFDtoSet(s.socket_, maxfd, &sockets);
+        for (SocketCallbackInfo s : callbacks_) {
+            // Add this socket to listening set
+            fd_event_handler_->add(s.socket_);
+        }
+    }
+
+    fd_set_content_ = content;
+}
+
+bool
+IfaceMgr::handleExternalSockets() {
+    SocketCallbackInfo ex_sock;
+    bool found = false;
+    {
+        std::lock_guard<std::mutex> lock(callbacks_mutex_);
+        for (SocketCallbackInfo s : callbacks_) {
+            if (!fd_event_handler_->readReady(s.socket_)) {
+                continue;
+            }
+            found = true;
+
+            // something received over external socket
+            if (s.callback_) {
+                // Note the external socket to call its callback without
+                // the lock taken so it can be deleted.
+                ex_sock = s;
+                break;
+            }
+        }
+    }
+
+    if (ex_sock.callback_) {
+        // Calling the external socket's callback provides its service
+        // layer access without integrating any specific features
+        // in IfaceMgr
+        ex_sock.callback_(ex_sock.socket_);
+    }
+
+    return (found);
+}
+
+const SocketInfo*
+IfaceMgr::findReadySocket(IfacePtr& recv_if) {
+    for (int fd : fd_event_handler_->readyFds()) {
+        auto it = fd_set_ifaces_.find(fd);
+        if (it == fd_set_ifaces_.end()) {
+            continue;
+        }
+        for (const SocketInfo& s : it->second->getSockets()) {
+            if (s.sockfd_ == fd) {
+                recv_if = it->second;
+                return (&s);
             }
         }
     }
 
-    // Add Receiver ready watch socket
-    addFDtoSet(dhcp_receiver_->getWatchFd(WatchedThread::READY), maxfd, &sockets);
+    // The socket has been closed or the interface has been removed
+    // behind our back: rebuild the interest set on the next wait.
+    ++sockets_generation_;
+    isc_throw(SocketReadError, "received data over unknown socket");
+}
 
-    // Add Receiver error watch socket
-    addFDtoSet(dhcp_receiver_->getWatchFd(WatchedThread::ERROR), maxfd, &sockets);
+IfaceMgr::ShardReceiverPtr
+IfaceMgr::waitForShard(const size_t shard, const uint16_t family,
+                       uint32_t timeout_sec, uint32_t timeout_usec) {
+    // Sanity check for microsecond timeout.
+    if (timeout_usec >= 1000000) {
+        isc_throw(BadValue, "fractional timeout must be shorter than"
+                  " one million microseconds");
+    }
+    if (shard >= shard_receivers_.size()) {
+        isc_throw(BadValue, "invalid socket shard " << shard << ", the number"
+                  " of shards is " << shard_receivers_.size());
+    }
+
+    // Each shard is served by its own thread so it has its own event
+    // handler, which is rebuilt only when the sockets have changed.
+    ShardReceiverPtr& receiver = shard_receivers_[shard];
+    uint64_t generation = sockets_generation_;
+    if (!receiver || (receiver->generation_ != generation) ||
+        (receiver->family_ != family) ||
+        (receiver->handler_->type() != fd_event_handler_type_)) {
+        ShardReceiverPtr fresh(new ShardReceiver());
+        fresh->handler_ =
+            FDEventHandlerFactory::factoryFDEventHandler(fd_event_handler_type_);
+        fresh->generation_ = generation;
+        fresh->family_ = family;
+        for (IfacePtr iface : ifaces_) {
+            for (const SocketInfo& s : iface->getSockets()) {
+                if ((s.family_ == family) && (s.shard_ == shard)) {
+                    fresh->handler_->add(s.sockfd_);
+                    fresh->sockets_.push_back(std::make_pair(iface, s));
+                }
+            }
+        }
+        fresh->handler_->add(shard_interrupt_->getSelectFd());
+        receiver = fresh;
+    }
+
+    // zero out the errno to be safe
+    errno = 0;
 
-    // Set timeout for our next select() call.  If there are
+    int result = receiver->handler_->waitEvent(timeout_sec, timeout_usec);
+
+    if (result == 0) {
+        // nothing received and timeout has been reached
+        return (ShardReceiverPtr());
+
+    } else if (result < 0) {
+        // Signals are handled by the main thread.
+        if (errno == EINTR) {
+            return (ShardReceiverPtr());
+        } else if (errno == EBADF) {
+            // A watched descriptor was closed: rebuild the interest set
+            // on the next wait.
+            receiver->generation_ = 0;
+            isc_throw(SocketReadError, "wait interrupted by an invalid"
+                      " socket of shard " << shard);
+        } else {
+            isc_throw(SocketReadError, strerror(errno));
+        }
+    }
+
+    if (receiver->handler_->readReady(shard_interrupt_->getSelectFd())) {
+        return (ShardReceiverPtr());
+    }
+
+    return (receiver);
+}
+
+Pkt4Collection
+IfaceMgr::receive4Shard(const size_t shard, uint32_t timeout_sec,
+                        uint32_t timeout_usec /* = 0 */) {
+    Pkt4Collection pkts;
+    ShardReceiverPtr receiver = waitForShard(shard, AF_INET, timeout_sec,
+                                             timeout_usec);
+    if (!receiver) {
+        return (pkts);
+    }
+
+    for (auto const& s : receiver->sockets_) {
+        if (!receiver->handler_->readReady(s.second.sockfd_)) {
+            continue;
+        }
+        // Assuming that packet filter is not null, because its modifier
+        // checks it.
+        Pkt4Collection received =
+            packet_filter_->receiveBatch(*s.first, s.second,
+                                         receive_batch_size_);
+        pkts.insert(pkts.end(), received.begin(), received.end());
+    }
+
+    return (pkts);
+}
+
+Pkt6Collection
+IfaceMgr::receive6Shard(const size_t shard, uint32_t timeout_sec,
+                        uint32_t timeout_usec /* = 0 */) {
+    Pkt6Collection pkts;
+    ShardReceiverPtr receiver = waitForShard(shard, AF_INET6, timeout_sec,
+                                             timeout_usec);
+    if (!receiver) {
+        return (pkts);
+    }
+
+    for (auto const& s : receiver->sockets_) {
+        if (!receiver->handler_->readReady(s.second.sockfd_)) {
+            continue;
+        }
+        // Assuming that packet filter is not null, because its modifier
+        // checks it.
+        Pkt6Collection received =
+            packet_filter6_->receiveBatch(s.second, receive_batch_size_);
+        pkts.insert(pkts.end(), received.begin(), received.end());
+    }
+
+    return (pkts);
+}
+
+Pkt4Ptr IfaceMgr::receive4(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */) {
+    if (isDHCPReceiverRunning()) {
+        return (receive4Indirect(timeout_sec, timeout_usec));
+    }
+
+    return (receive4Direct(timeout_sec, timeout_usec));
+}
+
+Pkt4Collection
+IfaceMgr::receive4Batch(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */) {
+    if (isDHCPReceiverRunning()) {
+        return (receive4IndirectBatch(timeout_sec, timeout_usec));
+    }
+
+    return (receive4DirectBatch(timeout_sec, timeout_usec));
+}
+
+Pkt4Ptr IfaceMgr::receive4Indirect(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */) {
+    if (!waitForQueue4(timeout_sec, timeout_usec)) {
+        return (Pkt4Ptr());
+    }
+
+    // If we're here it should only be because there are DHCP packets waiting.
+    Pkt4Ptr pkt = getPacketQueue4()->dequeuePacket();
+    if (!pkt) {
+        queue_ready_->clearReady();
+    }
+
+    return (pkt);
+}
+
+Pkt4Collection
+IfaceMgr::receive4IndirectBatch(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */) {
+    Pkt4Collection pkts;
+    if (!waitForQueue4(timeout_sec, timeout_usec)) {
+        return (pkts);
+    }
+
+    // Drain up to a batch worth of packets from the queue.
+    while (pkts.size() < receive_batch_size_) {
+        Pkt4Ptr pkt = getPacketQueue4()->dequeuePacket();
+        if (!pkt) {
+            queue_ready_->clearReady();
+            break;
+        }
+        pkts.push_back(pkt);
+    }
+
+    return (pkts);
+}
+
+bool
+IfaceMgr::waitForQueue4(uint32_t timeout_sec, uint32_t timeout_usec) {
+    // Sanity check for microsecond timeout.
+    if (timeout_usec >= 1000000) {
+        isc_throw(BadValue, "fractional timeout must be shorter than"
+                  " one million microseconds");
+    }
+
+    // Watch the external sockets and the receiver ready and error watch
+    // sockets.
+    prepareFDEventHandler(FD_SET_QUEUE);
+
+    // Set timeout for our next wait.  If there are
     // no DHCP packets to read, then we'll wait for a finite
     // amount of time for an IO event.  Otherwise, we'll
     // poll (timeout = 0 secs).  We need to poll, even if
     // DHCP packets are waiting so we don't starve external
     // sockets under heavy DHCP load.
-    struct timeval select_timeout;
-    if (getPacketQueue4()->empty()) {
-        select_timeout.tv_sec = timeout_sec;
-        select_timeout.tv_usec = timeout_usec;
-    } else {
-        select_timeout.tv_sec = 0;
-        select_timeout.tv_usec = 0;
+    if (!getPacketQueue4()->empty()) {
+        timeout_sec = 0;
+        timeout_usec = 0;
     }
 
     // zero out the errno to be safe
     errno = 0;
 
-    int result = select(maxfd + 1, &sockets, 0, 0, &select_timeout);
+    int result = fd_event_handler_->waitEvent(timeout_sec, timeout_usec);
 
     if ((result == 0) && getPacketQueue4()->empty()) {
         // nothing received and timeout has been reached
-        return (Pkt4Ptr());
+        return (false);
     } else if (result < 0) {
         // In most cases we would like to know whether select() returned
         // an error because of a signal being received  or for some other
@@ -1194,6 +1543,9 @@ Pkt4Ptr IfaceMgr::receive4Indirect(uint32_t timeout_sec, uint32_t timeout_usec /
         if (errno == EINTR) {
             isc_throw(SignalInterruptOnSelect, strerror(errno));
         } else if (errno == EBADF) {
+            // A watched descriptor was closed: rebuild the interest set
+            // on the next wait.
+            ++sockets_generation_;
             int cnt = purgeBadSockets();
             isc_throw(SocketReadError,
                       "SELECT interrupted by one invalid sockets, purged "
@@ -1213,94 +1565,62 @@ Pkt4Ptr IfaceMgr::receive4Indirect(uint32_t timeout_sec, uint32_t timeout_usec /
         }
 
         // Let's find out which external socket has the data
-        SocketCallbackInfo ex_sock;
-        bool found = false;
-        {
-            std::lock_guard<std::mutex> lock(callbacks_mutex_);
-            for (SocketCallbackInfo s : callbacks_) {
-                if (!FD_ISSET(s.socket_, &sockets)) {
-                    continue;
-                }
-                found = true;
-
-                // something received over external socket
-                if (s.callback_) {
-                    // Note the external socket to call its callback without
-                    // the lock taken so it can be deleted.
-                    ex_sock = s;
-                    break;
-                }
-            }
+        if (handleExternalSockets()) {
+            return (false);
         }
+    }
 
-        if (ex_sock.callback_) {
-            // Calling the external socket's callback provides its service
-            // layer access without integrating any specific features
-            // in IfaceMgr
-            ex_sock.callback_(ex_sock.socket_);
-        }
-        if (found) {
-            return (Pkt4Ptr());
-        }
+    return (true);
+}
+
+Pkt4Ptr IfaceMgr::receive4Direct(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */) {
+    IfacePtr recv_if;
+    const SocketInfo* candidate = waitForSocket4(timeout_sec, timeout_usec,
+                                                 recv_if);
+    if (!candidate) {
+        return (Pkt4Ptr()); // null
     }
 
-    // If we're here it should only be because there are DHCP packets waiting.
-    Pkt4Ptr pkt = getPacketQueue4()->dequeuePacket();
-    if (!pkt) {
-        dhcp_receiver_->clearReady(WatchedThread::READY);
+    // Now we have a socket, let's get some data from it!
+    // Assuming that packet filter is not null, because its modifier checks it.
+    return (packet_filter_->receive(*recv_if, *candidate));
+}
+
+Pkt4Collection
+IfaceMgr::receive4DirectBatch(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */) {
+    IfacePtr recv_if;
+    const SocketInfo* candidate = waitForSocket4(timeout_sec, timeout_usec,
+                                                 recv_if);
+    if (!candidate) {
+        return (Pkt4Collection());
     }
 
-    return (pkt);
+    // Assuming that packet filter is not null, because its modifier checks it.
+    return (packet_filter_->receiveBatch(*recv_if, *candidate,
+                                         receive_batch_size_));
 }
 
-Pkt4Ptr IfaceMgr::receive4Direct(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */) {
+const SocketInfo*
+IfaceMgr::waitForSocket4(uint32_t timeout_sec, uint32_t timeout_usec,
+                         IfacePtr& recv_if) {
     // Sanity check for microsecond timeout.
     if (timeout_usec >= 1000000) {
         isc_throw(BadValue, "fractional timeout must be shorter than"
                   " one million microseconds");
     }
-    boost::scoped_ptr<SocketInfo> candidate;
-    fd_set sockets;
-    int maxfd = 0;
-
-    FD_ZERO(&sockets);
-
-    /// @todo: marginal performance optimization. We could create the set once
-    /// and then use its copy for select(). Please note that select() modifies
-    /// provided set to indicated which sockets have something to read.
-    for (IfacePtr iface : ifaces_) {
-        for (SocketInfo s : iface->getSockets()) {
-            // Only deal with IPv4 addresses.
-            if (s.addr_.isV4()) {
-                // Add this socket to listening set
-                addFDtoSet(s.sockfd_, maxfd, &sockets);
-            }
-        }
-    }
-
-    // if there are any callbacks for external sockets registered...
-    {
-        std::lock_guard<std::mutex> lock(callbacks_mutex_);
-        if (!callbacks_.empty()) {
-            for (SocketCallbackInfo s : callbacks_) {
-                // Add this socket to listening set
-                addFDtoSet(s.socket_, maxfd, &sockets);
-            }
-        }
-    }
 
-    struct timeval select_timeout;
-    select_timeout.tv_sec = timeout_sec;
-    select_timeout.tv_usec = timeout_usec;
+    // The IPv4 sockets and the external sockets stay in the interest set
+    // between calls, it is only rebuilt when they change.
+    prepareFDEventHandler(FD_SET_SOCKETS4);
 
     // zero out the errno to be safe
     errno = 0;
 
-    int result = select(maxfd + 1, &sockets, 0, 0, &select_timeout);
+    int result = fd_event_handler_->waitEvent(timeout_sec, timeout_usec);
 
     if (result == 0) {
         // nothing received and timeout has been reached
-        return (Pkt4Ptr()); // null
+        return (0);
 
     } else if (result < 0) {
         // In most cases we would like to know whether select() returned
@@ -1313,6 +1633,9 @@ Pkt4Ptr IfaceMgr::receive4Direct(uint32_t timeout_sec, uint32_t timeout_usec /*
         if (errno == EINTR) {
             isc_throw(SignalInterruptOnSelect, strerror(errno));
         } else if (errno == EBADF) {
+            // A watched descriptor was closed: rebuild the interest set
+            // on the next wait.
+            ++sockets_generation_;
             int cnt = purgeBadSockets();
             isc_throw(SocketReadError,
                       "SELECT interrupted by one invalid sockets, purged "
@@ -1323,58 +1646,12 @@ Pkt4Ptr IfaceMgr::receive4Direct(uint32_t timeout_sec, uint32_t timeout_usec /*
     }
 
     // Let's find out which socket has the data
-    SocketCallbackInfo ex_sock;
-    bool found = false;
-    {
-        std::lock_guard<std::mutex> lock(callbacks_mutex_);
-        for (SocketCallbackInfo s : callbacks_) {
-            if (!FD_ISSET(s.socket_, &sockets)) {
-                continue;
-            }
-            found = true;
-
-            // something received over external socket
-            if (s.callback_) {
-                // Note the external socket to call its callback without
-                // the lock taken so it can be deleted.
-                ex_sock = s;
-                break;
-            }
-        }
-    }
-
-    if (ex_sock.callback_) {
-        // Calling the external socket's callback provides its service
-        // layer access without integrating any specific features
-        // in IfaceMgr
-        ex_sock.callback_(ex_sock.socket_);
-    }
-    if (found) {
-        return (Pkt4Ptr());
+    if (handleExternalSockets()) {
+        return (0);
     }
 
     // Let's find out which interface/socket has the data
-    IfacePtr recv_if;
-    for (IfacePtr iface : ifaces_) {
-        for (SocketInfo s : iface->getSockets()) {
-            if (FD_ISSET(s.sockfd_, &sockets)) {
-                candidate.reset(new SocketInfo(s));
-                break;
-            }
-        }
-        if (candidate) {
-            recv_if = iface;
-            break;
-        }
-    }
-
-    if (!candidate || !recv_if) {
-        isc_throw(SocketReadError, "received data over unknown socket");
-    }
-
-    // Now we have a socket, let's get some data from it!
-    // Assuming that packet filter is not null, because its modifier checks it.
-    return (packet_filter_->receive(*recv_if, *candidate));
+    return (findReadySocket(recv_if));
 }
 
 Pkt6Ptr
@@ -1386,6 +1663,15 @@ IfaceMgr::receive6(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */) {
     return (receive6Direct(timeout_sec, timeout_usec));
 }
 
+Pkt6Collection
+IfaceMgr::receive6Batch(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */) {
+    if (isDHCPReceiverRunning()) {
+        return (receive6IndirectBatch(timeout_sec, timeout_usec));
+    }
+
+    return (receive6DirectBatch(timeout_sec, timeout_usec));
+}
+
 void
 IfaceMgr::addFDtoSet(int fd, int& maxfd, fd_set* sockets) {
     if (!sockets) {
@@ -1400,54 +1686,46 @@ IfaceMgr::addFDtoSet(int fd, int& maxfd, fd_set* sockets) {
 
 Pkt6Ptr
 IfaceMgr::receive6Direct(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */ ) {
-    // Sanity check for microsecond timeout.
-    if (timeout_usec >= 1000000) {
-        isc_throw(BadValue, "fractional timeout must be shorter than"
-                  " one million microseconds");
+    const SocketInfo* candidate = waitForSocket6(timeout_sec, timeout_usec);
+    if (!candidate) {
+        return (Pkt6Ptr()); // null
     }
 
-    boost::scoped_ptr<SocketInfo> candidate;
-    fd_set sockets;
-    int maxfd = 0;
-
-    FD_ZERO(&sockets);
+    // Assuming that packet filter is not null, because its modifier checks it.
+    return (packet_filter6_->receive(*candidate));
+}
 
-    /// @todo: marginal performance optimization. We could create the set once
-    /// and then use its copy for select(). Please note that select() modifies
-    /// provided set to indicated which sockets have something to read.
-    for (IfacePtr iface : ifaces_) {
-        for (SocketInfo s : iface->getSockets()) {
-            // Only deal with IPv6 addresses.
-            if (s.addr_.isV6()) {
-                // Add this socket to listening set
-                addFDtoSet(s.sockfd_, maxfd, &sockets);
-            }
-        }
+Pkt6Collection
+IfaceMgr::receive6DirectBatch(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */ ) {
+    const SocketInfo* candidate = waitForSocket6(timeout_sec, timeout_usec);
+    if (!candidate) {
+        return (Pkt6Collection());
     }
 
-    // if there are any callbacks for external sockets registered...
-    {
-        std::lock_guard<std::mutex> lock(callbacks_mutex_);
-        if (!callbacks_.empty()) {
-            for (SocketCallbackInfo s : callbacks_) {
-                // Add this socket to listening set
-                addFDtoSet(s.socket_, maxfd, &sockets);
-            }
-        }
+    // Assuming that packet filter is not null, because its modifier checks it.
+    return (packet_filter6_->receiveBatch(*candidate, receive_batch_size_));
+}
+
+const SocketInfo*
+IfaceMgr::waitForSocket6(uint32_t timeout_sec, uint32_t timeout_usec) {
+    // Sanity check for microsecond timeout.
+    if (timeout_usec >= 1000000) {
+        isc_throw(BadValue, "fractional timeout must be shorter than"
+                  " one million microseconds");
     }
 
-    struct timeval select_timeout;
-    select_timeout.tv_sec = timeout_sec;
-    select_timeout.tv_usec = timeout_usec;
+    // The IPv6 sockets and the external sockets stay in the interest set
+    // between calls, it is only rebuilt when they change.
+    prepareFDEventHandler(FD_SET_SOCKETS6);
 
     // zero out the errno to be safe
     errno = 0;
 
-    int result = select(maxfd + 1, &sockets, 0, 0, &select_timeout);
+    int result = fd_event_handler_->waitEvent(timeout_sec, timeout_usec);
 
     if (result == 0) {
         // nothing received and timeout has been reached
-        return (Pkt6Ptr()); // null
+        return (0);
 
     } else if (result < 0) {
         // In most cases we would like to know whether select() returned
@@ -1460,6 +1738,9 @@ IfaceMgr::receive6Direct(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */ )
         if (errno == EINTR) {
             isc_throw(SignalInterruptOnSelect, strerror(errno));
         } else if (errno == EBADF) {
+            // A watched descriptor was closed: rebuild the interest set
+            // on the next wait.
+            ++sockets_generation_;
             int cnt = purgeBadSockets();
             isc_throw(SocketReadError,
                       "SELECT interrupted by one invalid sockets, purged "
@@ -1470,109 +1751,81 @@ IfaceMgr::receive6Direct(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */ )
     }
 
     // Let's find out which socket has the data
-    SocketCallbackInfo ex_sock;
-    bool found = false;
-    {
-        std::lock_guard<std::mutex> lock(callbacks_mutex_);
-        for (SocketCallbackInfo s : callbacks_) {
-            if (!FD_ISSET(s.socket_, &sockets)) {
-                continue;
-            }
-            found = true;
+    if (handleExternalSockets()) {
+        return (0);
+    }
 
-            // something received over external socket
-            if (s.callback_) {
-                // Note the external socket to call its callback without
-                // the lock taken so it can be deleted.
-                ex_sock = s;
-                break;
-            }
-        }
+    // Let's find out which interface/socket has the data
+    IfacePtr recv_if;
+    return (findReadySocket(recv_if));
+}
+
+Pkt6Ptr
+IfaceMgr::receive6Indirect(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */ ) {
+    if (!waitForQueue6(timeout_sec, timeout_usec)) {
+        return (Pkt6Ptr());
     }
 
-    if (ex_sock.callback_) {
-        // Calling the external socket's callback provides its service
-        // layer access without integrating any specific features
-        // in IfaceMgr
-        ex_sock.callback_(ex_sock.socket_);
+    // If we're here it should only be because there are DHCP packets waiting.
+    Pkt6Ptr pkt = getPacketQueue6()->dequeuePacket();
+    if (!pkt) {
+        queue_ready_->clearReady();
     }
-    if (found) {
-        return (Pkt6Ptr());
+
+    return (pkt);
+}
+
+Pkt6Collection
+IfaceMgr::receive6IndirectBatch(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */ ) {
+    Pkt6Collection pkts;
+    if (!waitForQueue6(timeout_sec, timeout_usec)) {
+        return (pkts);
     }
 
-    // Let's find out which interface/socket has the data
-    for (IfacePtr iface : ifaces_) {
-        for (SocketInfo s : iface->getSockets()) {
-            if (FD_ISSET(s.sockfd_, &sockets)) {
-                candidate.reset(new SocketInfo(s));
-                break;
-            }
-        }
-        if (candidate) {
+    // Drain up to a batch worth of packets from the queue.
+    while (pkts.size() < receive_batch_size_) {
+        Pkt6Ptr pkt = getPacketQueue6()->dequeuePacket();
+        if (!pkt) {
+            queue_ready_->clearReady();
             break;
         }
+        pkts.push_back(pkt);
     }
 
-    if (!candidate) {
-        isc_throw(SocketReadError, "received data over unknown socket");
-    }
-    // Assuming that packet filter is not null, because its modifier checks it.
-    return (packet_filter6_->receive(*candidate));
+    return (pkts);
 }
 
-Pkt6Ptr
-IfaceMgr::receive6Indirect(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */ ) {
+bool
+IfaceMgr::waitForQueue6(uint32_t timeout_sec, uint32_t timeout_usec) {
     // Sanity check for microsecond timeout.
     if (timeout_usec >= 1000000) {
         isc_throw(BadValue, "fractional timeout must be shorter than"
                   " one million microseconds");
     }
 
-    fd_set sockets;
-    int maxfd = 0;
+    // Watch the external sockets and the receiver ready and error watch
+    // sockets.
+    prepareFDEventHandler(FD_SET_QUEUE);
 
-    FD_ZERO(&sockets);
-
-    // if there are any callbacks for external sockets registered...
-    {
-        std::lock_guard<std::mutex> lock(callbacks_mutex_);
-        if (!callbacks_.empty()) {
-            for (SocketCallbackInfo s : callbacks_) {
-                // Add this socket to listening set
-                addFDtoSet(s.socket_, maxfd, &sockets);
-            }
-        }
-    }
-
-    // Add Receiver ready watch socket
-    addFDtoSet(dhcp_receiver_->getWatchFd(WatchedThread::READY), maxfd, &sockets);
-
-    // Add Receiver error watch socket
-    addFDtoSet(dhcp_receiver_->getWatchFd(WatchedThread::ERROR), maxfd, &sockets);
-
-    // Set timeout for our next select() call.  If there are
+    // Set timeout for our next wait.  If there are
     // no DHCP packets to read, then we'll wait for a finite
     // amount of time for an IO event.  Otherwise, we'll
     // poll (timeout = 0 secs).  We need to poll, even if
     // DHCP packets are waiting so we don't starve external
     // sockets under heavy DHCP load.
-    struct timeval select_timeout;
-    if (getPacketQueue6()->empty()) {
-        select_timeout.tv_sec = timeout_sec;
-        select_timeout.tv_usec = timeout_usec;
-    } else {
-        select_timeout.tv_sec = 0;
-        select_timeout.tv_usec = 0;
+    if (!getPacketQueue6()->empty()) {
+        timeout_sec = 0;
+        timeout_usec = 0;
     }
 
     // zero out the errno to be safe
     errno = 0;
 
-    int result = select(maxfd + 1, &sockets, 0, 0, &select_timeout);
+    int result = fd_event_handler_->waitEvent(timeout_sec, timeout_usec);
 
     if ((result == 0) && getPacketQueue6()->empty()) {
         // nothing received and timeout has been reached
-        return (Pkt6Ptr());
+        return (false);
     } else if (result < 0) {
         // In most cases we would like to know whether select() returned
         // an error because of a signal being received  or for some other
@@ -1584,6 +1837,9 @@ IfaceMgr::receive6Indirect(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */
         if (errno == EINTR) {
             isc_throw(SignalInterruptOnSelect, strerror(errno));
         } else if (errno == EBADF) {
+            // A watched descriptor was closed: rebuild the interest set
+            // on the next wait.
+            ++sockets_generation_;
             int cnt = purgeBadSockets();
             isc_throw(SocketReadError,
                       "SELECT interrupted by one invalid sockets, purged "
@@ -1603,65 +1859,42 @@ IfaceMgr::receive6Indirect(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */
         }
 
         // Let's find out which external socket has the data
-        SocketCallbackInfo ex_sock;
-        bool found = false;
-        {
-            std::lock_guard<std::mutex> lock(callbacks_mutex_);
-            for (SocketCallbackInfo s : callbacks_) {
-                if (!FD_ISSET(s.socket_, &sockets)) {
-                    continue;
-                }
-                found = true;
-
-                // something received over external socket
-                if (s.callback_) {
-                    // Note the external socket to call its callback without
-                    // the lock taken so it can be deleted.
-                    ex_sock = s;
-                    break;
-                }
-            }
-        }
-
-        if (ex_sock.callback_) {
-            // Calling the external socket's callback provides its service
-            // layer access without integrating any specific features
-            // in IfaceMgr
-            ex_sock.callback_(ex_sock.socket_);
-        }
-        if (found) {
-            return (Pkt6Ptr());
+        if (handleExternalSockets()) {
+            return (false);
         }
     }
 
-    // If we're here it should only be because there are DHCP packets waiting.
-    Pkt6Ptr pkt = getPacketQueue6()->dequeuePacket();
-    if (!pkt) {
-        dhcp_receiver_->clearReady(WatchedThread::READY);
-    }
-
-    return (pkt);
+    return (true);
 }
 
 void
 IfaceMgr::receiveDHCP4Packets() {
-    fd_set sockets;
-    int maxfd = 0;
+    // The receiver thread has its own event handler. The sockets can't
+    // change while the thread runs so the interest set is built once.
+    FDEventHandlerPtr fd_event_handler =
+        FDEventHandlerFactory::factoryFDEventHandler(fd_event_handler_type_);
+    std::unordered_map<int, std::pair<IfacePtr, SocketInfo> > sockets;
 
-    FD_ZERO(&sockets);
-
-    // Add terminate watch socket.
-    addFDtoSet(dhcp_receiver_->getWatchFd(WatchedThread::TERMINATE), maxfd, &sockets);
+    try {
+        // Add terminate watch socket.
+        fd_event_handler->add(dhcp_receiver_->getWatchFd(WatchedThread::TERMINATE));
 
-    // Add Interface sockets.
-    for (IfacePtr iface : ifaces_) {
-        for (SocketInfo s : iface->getSockets()) {
-            // Only deal with IPv4 addresses.
-            if (s.addr_.isV4()) {
-                // Add this socket to listening set.
-                addFDtoSet(s.sockfd_, maxfd, &sockets);
+        // Add Interface sockets.
+        for (IfacePtr iface : ifaces_) {
+            for (SocketInfo s : iface->getSockets()) {
+                // Only deal with IPv4 addresses.
+                if (s.addr_.isV4()) {
+                    // Add this socket to listening set.
+                    fd_event_handler->add(s.sockfd_);
+                    sockets.insert(std::make_pair(s.sockfd_,
+                                                  std::make_pair(iface, s)));
+                }
             }
         }
+    } catch (const std::exception& ex) {
+        // Signal the error to receive4.
+        dhcp_receiver_->setError(ex.what());
+        return;
     }
 
     for (;;) {
@@ -1670,14 +1903,11 @@ IfaceMgr::receiveDHCP4Packets() {
             return;
         }
 
-        fd_set rd_set;
-        FD_COPY(&sockets, &rd_set);
-
         // zero out the errno to be safe.
         errno = 0;
 
-        // Select with null timeouts to wait indefinetly an event
-        int result = select(maxfd + 1, &rd_set, 0, 0, 0);
+        // Wait indefinitely for an event.
+        int result = fd_event_handler->waitEvent(0, 0, false);
 
         // Re-check the watch socket.
         if (dhcp_receiver_->shouldTerminate()) {
@@ -1702,40 +1932,48 @@ IfaceMgr::receiveDHCP4Packets() {
         }
 
         // Let's find out which interface/socket has data.
-        for (IfacePtr iface : ifaces_) {
-            for (SocketInfo s : iface->getSockets()) {
-                if (FD_ISSET(s.sockfd_, &sockets)) {
-                    receiveDHCP4Packet(*iface, s);
-                    // Can take time so check one more time the watch socket.
-                    if (dhcp_receiver_->shouldTerminate()) {
-                        return;
-                    }
-                }
+        for (int fd : fd_event_handler->readyFds()) {
+            auto it = sockets.find(fd);
+            if (it == sockets.end()) {
+                continue;
+            }
+            receiveDHCP4Packet(*it->second.first, it->second.second);
+            // Can take time so check one more time the watch socket.
+            if (dhcp_receiver_->shouldTerminate()) {
+                return;
             }
         }
     }
-
 }
 
 void
 IfaceMgr::receiveDHCP6Packets() {
-    fd_set sockets;
-    int maxfd = 0;
-
-    FD_ZERO(&sockets);
+    // The receiver thread has its own event handler. The sockets can't
+    // change while the thread runs so the interest set is built once.
+    FDEventHandlerPtr fd_event_handler =
+        FDEventHandlerFactory::factoryFDEventHandler(fd_event_handler_type_);
+    std::unordered_map<int, std::pair<IfacePtr, SocketInfo> > sockets;
 
-    // Add terminate watch socket.
-    addFDtoSet(dhcp_receiver_->getWatchFd(WatchedThread::TERMINATE), maxfd, &sockets);
+    try {
+        // Add terminate watch socket.
+        fd_event_handler->add(dhcp_receiver_->getWatchFd(WatchedThread::TERMINATE));
 
-    // Add Interface sockets.
-    for (IfacePtr iface : ifaces_) {
-        for (SocketInfo s : iface->getSockets()) {
-            // Only deal with IPv6 addresses.
-            if (s.addr_.isV6()) {
-                // Add this socket to listening set.
-                addFDtoSet(s.sockfd_ , maxfd, &sockets);
+        // Add Interface sockets.
+        for (IfacePtr iface : ifaces_) {
+            for (SocketInfo s : iface->getSockets()) {
+                // Only deal with IPv6 addresses.
+                if (s.addr_.isV6()) {
+                    // Add this socket to listening set.
+                    fd_event_handler->add(s.sockfd_);
+                    sockets.insert(std::make_pair(s.sockfd_,
+                                                  std::make_pair(iface, s)));
+                }
             }
         }
+    } catch (const std::exception& ex) {
+        // Signal the error to receive6.
+        dhcp_receiver_->setError(ex.what());
+        return;
     }
 
     for (;;) {
@@ -1744,14 +1982,11 @@ IfaceMgr::receiveDHCP6Packets() {
             return;
         }
 
-        fd_set rd_set;
-        FD_COPY(&sockets, &rd_set);
-
         // zero out the errno to be safe.
         errno = 0;
 
-        // Note we wait until something happen.
-        int result = select(maxfd + 1, &rd_set, 0, 0, 0);
+        // Wait indefinitely for an event.
+        int result = fd_event_handler->waitEvent(0, 0, false);
 
         // Re-check the watch socket.
         if (dhcp_receiver_->shouldTerminate()) {
@@ -1761,6 +1996,7 @@ IfaceMgr::receiveDHCP6Packets() {
         if (result == 0) {
             // nothing received?
             continue;
+
         } else if (result < 0) {
             // This thread should not get signals?
             if (errno != EINTR) {
@@ -1775,15 +2011,15 @@ IfaceMgr::receiveDHCP6Packets() {
         }
 
         // Let's find out which interface/socket has data.
-        for (IfacePtr iface : ifaces_) {
-            for (SocketInfo s : iface->getSockets()) {
-                if (FD_ISSET(s.sockfd_, &sockets)) {
-                    receiveDHCP6Packet(s);
-                    // Can take time so check one more time the watch socket.
-                    if (dhcp_receiver_->shouldTerminate()) {
-                        return;
-                    }
-                }
+        for (int fd : fd_event_handler->readyFds()) {
+            auto it = sockets.find(fd);
+            if (it == sockets.end()) {
+                continue;
+            }
+            receiveDHCP6Packet(it->second.second);
+            // Can take time so check one more time the watch socket.
+            if (dhcp_receiver_->shouldTerminate()) {
+                return;
             }
         }
     }
@@ -1804,19 +2040,22 @@ IfaceMgr::receiveDHCP4Packet(Iface& iface, const SocketInfo& socket_info) {
         return;
     }
 
-    Pkt4Ptr pkt;
+    Pkt4Collection pkts;
 
     try {
-        pkt = packet_filter_->receive(iface, socket_info);
+        pkts = packet_filter_->receiveBatch(iface, socket_info,
+                                            receive_batch_size_);
     } catch (const std::exception& ex) {
         dhcp_receiver_->setError(strerror(errno));
     } catch (...) {
         dhcp_receiver_->setError("packet filter receive() failed");
     }
 
-    if (pkt) {
-        getPacketQueue4()->enqueuePacket(pkt, socket_info);
-        dhcp_receiver_->markReady(WatchedThread::READY);
+    if (!pkts.empty()) {
+        for (auto pkt : pkts) {
+            getPacketQueue4()->enqueuePacket(pkt, socket_info);
+        }
+        queue_ready_->markReady();
     }
 }
 
@@ -1835,19 +2074,21 @@ IfaceMgr::receiveDHCP6Packet(const SocketInfo& socket_info) {
         return;
     }
 
-    Pkt6Ptr pkt;
+    Pkt6Collection pkts;
 
     try {
-        pkt = packet_filter6_->receive(socket_info);
+        pkts = packet_filter6_->receiveBatch(socket_info, receive_batch_size_);
     } catch (const std::exception& ex) {
         dhcp_receiver_->setError(ex.what());
     } catch (...) {
         dhcp_receiver_->setError("packet filter receive() failed");
     }
 
-    if (pkt) {
-        getPacketQueue6()->enqueuePacket(pkt, socket_info);
-        dhcp_receiver_->markReady(WatchedThread::READY);
+    if (!pkts.empty()) {
+        for (auto pkt : pkts) {
+            getPacketQueue6()->enqueuePacket(pkt, socket_info);
+        }
+        queue_ready_->markReady();
     }
 }
 
@@ -1958,6 +2199,16 @@ IfaceMgr::configureDHCPPacketQueue(uint16_t family, data::ConstElementPtr queue_
         }
     }
 
+    // The receive batch size applies to both direct and queued reception,
+    // so it is configured regardless of whether the queue is enabled.
+    size_t batch_size = 1;
+    if (queue_control && queue_control->contains("receive-batch-size")) {
+        batch_size = data::SimpleParser::getInteger(queue_control,
+                                                    "receive-batch-size", 1,
+                                                    MAX_RECEIVE_BATCH_SIZE);
+    }
+    setReceiveBatchSize(batch_size);
+
     if (enable_queue) {
         // Try to create the queue as configured.
         if (family == AF_INET) {
@@ -16,7 +16,9 @@
 #include <dhcp/packet_queue_mgr6.h>
 #include <dhcp/pkt_filter.h>
 #include <dhcp/pkt_filter6.h>
+#include <util/fd_event_handler.h>
 #include <util/optional.h>
+#include <util/watch_event.h>
 #include <util/watch_socket.h>
 #include <util/watched_thread.h>
 
@@ -28,8 +30,10 @@
 #include <boost/scoped_array.hpp>
 #include <boost/shared_ptr.hpp>
 
+#include <atomic>
 #include <functional>
 #include <list>
+#include <unordered_map>
 #include <vector>
 #include <mutex>
 
@@ -656,6 +660,15 @@ public:
     /// we don't support packets larger than 1500.
     static const uint32_t RCVBUFSIZE = 1500;
 
+    /// @brief Maximum number of packets received in a batch.
+    ///
+    /// This is the largest number of messages the Linux kernel accepts
+    /// in a single recvmmsg() call.
+    static const size_t MAX_RECEIVE_BATCH_SIZE = 1024;
+
+    /// @brief Maximum number of socket shards.
+    static const size_t MAX_SOCKET_SHARDS = 256;
+
     /// IfaceMgr is a singleton class. This method returns reference
     /// to its sole instance.
     ///
@@ -867,6 +880,161 @@ public:
     /// @return Pkt4 object representing received packet (or null)
     Pkt4Ptr receive4(uint32_t timeout_sec, uint32_t timeout_usec = 0);
 
+    /// @brief Receive a batch of IPv6 packets or data from external sockets
+    ///
+    /// Works like @c receive6 but returns up to the configured receive
+    /// batch size of packets. When the packets are received directly from
+    /// a socket, all of them come from the same socket and are fetched
+    /// with as few system calls as the packet filter allows. When packet
+    /// queueing is enabled, the packets are taken from the queue.
+    ///
+    /// @param timeout_sec specifies integral part of the timeout (in seconds)
+    /// @param timeout_usec specifies fractional part of the timeout
+    /// (in microseconds)
+    ///
+    /// @return Collection of received packets (possibly empty).
+    Pkt6Collection receive6Batch(uint32_t timeout_sec,
+                                 uint32_t timeout_usec = 0);
+
+    /// @brief Receive a batch of IPv4 packets or data from external sockets
+    ///
+    /// Works like @c receive4 but returns up to the configured receive
+    /// batch size of packets. When the packets are received directly from
+    /// a socket, all of them come from the same socket and are fetched
+    /// with as few system calls as the packet filter allows. When packet
+    /// queueing is enabled, the packets are taken from the queue.
+    ///
+    /// @param timeout_sec specifies integral part of the timeout (in seconds)
+    /// @param timeout_usec specifies fractional part of the timeout
+    /// (in microseconds)
+    ///
+    /// @return Collection of received packets (possibly empty).
+    Pkt4Collection receive4Batch(uint32_t timeout_sec,
+                                 uint32_t timeout_usec = 0);
+
+    /// @brief Sets the maximum number of packets received in a batch.
+    ///
+    /// The batch size is used by @c receive4Batch, @c receive6Batch and
+    /// by the receiver thread which fills the packet queue. The value of 1
+    /// (default) disables batching.
+    ///
+    /// @param batch_size new batch size.
+    /// @throw BadValue if the batch size is 0 or is greater than
+    /// @c MAX_RECEIVE_BATCH_SIZE.
+    void setReceiveBatchSize(const size_t batch_size);
+
+    /// @brief Returns the maximum number of packets received in a batch.
+    size_t getReceiveBatchSize() const {
+        return (receive_batch_size_);
+    }
+
+    /// @brief Sets the type of the event handler used to wait for data.
+    ///
+    /// The event handler watches the DHCP sockets, the external sockets
+    /// and the receiver thread watch sockets. The select() handler is
+    /// used by default. The epoll() handler keeps the interest set in the
+    /// kernel so the cost of a wait does not grow with the number of
+    /// sockets, and it is not limited by FD_SETSIZE.
+    ///
+    /// @param type new event handler type.
+    /// @throw InvalidOperation if the receiver thread is currently running.
+    /// @throw NotImplemented if the type is not supported on this system.
+    void setFDEventHandlerType(const util::FDEventHandler::HandlerType type);
+
+    /// @brief Returns the type of the event handler used to wait for data.
+    util::FDEventHandler::HandlerType getFDEventHandlerType() const {
+        return (fd_event_handler_type_);
+    }
+
+    /// @brief Enables or disables the memory mapped receive ring.
+    ///
+    /// When enabled, the packet filter installed by
+    /// @c setMatchingPacketFilter for direct responses receives the
+    /// frames from a ring buffer shared with the kernel instead of
+    /// copying each of them with a system call. It is only supported
+    /// by the Linux Packet Filtering (see @c PktFilterLPF) and it takes
+    /// effect when the sockets are reopened.
+    ///
+    /// @param packet_mmap true to use the memory mapped ring.
+    void setPacketMmap(const bool packet_mmap) {
+        packet_mmap_ = packet_mmap;
+    }
+
+    /// @brief Checks if the memory mapped receive ring is enabled.
+    bool getPacketMmap() const {
+        return (packet_mmap_);
+    }
+
+    /// @brief Sets the number of socket shards.
+    ///
+    /// When the number is greater than 1, the sockets opened afterwards
+    /// are sharded: several sockets are opened for each address and port,
+    /// using @c PktFilter::openSocketShards, and the traffic is spread
+    /// over them so all packets of a client go to the same shard. Each
+    /// shard is then served by its own thread calling @c receive4Shard or
+    /// @c receive6Shard, and @c receive4 and @c receive6 only handle the
+    /// external sockets. Packet filters which don't support sharding open
+    /// a single socket which belongs to the first shard.
+    ///
+    /// It takes effect when the sockets are reopened and must not be
+    /// called while the shards are being received from.
+    ///
+    /// @param shards number of shards, 1 (default) disables sharding.
+    /// @throw BadValue if the number is 0 or greater than
+    /// @c MAX_SOCKET_SHARDS.
+    void setSocketShards(const size_t shards);
+
+    /// @brief Returns the number of socket shards.
+    size_t getSocketShards() const {
+        return (socket_shards_);
+    }
+
+    /// @brief Receives DHCPv4 packets from the sockets of a shard.
+    ///
+    /// Waits for data on the IPv4 sockets of the shard and receives up to
+    /// the receive batch size packets from each ready socket. It is meant
+    /// to be called by the thread serving the shard, each shard having
+    /// its own event handler. The external sockets are not watched.
+    ///
+    /// @param shard index of the shard.
+    /// @param timeout_sec specifies integral part of the timeout (in seconds)
+    /// @param timeout_usec specifies fractional part of the timeout
+    /// (in microseconds)
+    ///
+    /// @return Collection of received packets. It is empty on timeout,
+    /// when the wait is interrupted by a signal or when the shard
+    /// receivers are interrupted.
+    /// @throw BadValue if the shard index is out of range.
+    /// @throw isc::dhcp::SocketReadError if an error occurred while
+    /// waiting for data or reading it.
+    Pkt4Collection receive4Shard(const size_t shard, uint32_t timeout_sec,
+                                 uint32_t timeout_usec = 0);
+
+    /// @brief Receives DHCPv6 packets from the sockets of a shard.
+    ///
+    /// @param shard index of the shard.
+    /// @param timeout_sec specifies integral part of the timeout (in seconds)
+    /// @param timeout_usec specifies fractional part of the timeout
+    /// (in microseconds)
+    ///
+    /// @return Collection of received packets (possibly empty).
+    /// @throw BadValue if the shard index is out of range.
+    /// @throw isc::dhcp::SocketReadError if an error occurred while
+    /// waiting for data or reading it.
+    Pkt6Collection receive6Shard(const size_t shard, uint32_t timeout_sec,
+                                 uint32_t timeout_usec = 0);
+
+    /// @brief Interrupts the waits of the shard receivers.
+    ///
+    /// Pending and subsequent calls to @c receive4Shard and
+    /// @c receive6Shard return immediately without packets until
+    /// @c resumeShardReceivers is called. This allows the threads serving
+    /// the shards to be stopped promptly.
+    void interruptShardReceivers();
+
+    /// @brief Resumes the waits of the shard receivers.
+    void resumeShardReceivers();
+
     /// Opens UDP/IP socket and binds it to address, interface and port.
     ///
     /// Specific type of socket (UDP/IPv4 or UDP/IPv6) depends on passed addr
@@ -1325,6 +1493,26 @@ protected:
     /// @return Pkt4 object representing received packet (or null)
     Pkt4Ptr receive4Direct(uint32_t timeout_sec, uint32_t timeout_usec = 0);
 
+    /// @brief Receive a batch of IPv4 packets directly or data from external
+    /// sockets.
+    ///
+    /// Works like @c receive4Direct but receives up to the configured batch
+    /// size of packets from the socket which has data.
+    ///
+    /// @param timeout_sec specifies integral part of the timeout (in seconds)
+    /// @param timeout_usec specifies fractional part of the timeout
+    /// (in microseconds)
+    ///
+    /// @throw isc::BadValue if timeout_usec is greater than one million
+    /// @throw isc::dhcp::SocketReadError if error occurred when receiving a
+    /// packet.
+    /// @throw isc::dhcp::SignalInterruptOnSelect when a call to select() is
+    /// interrupted by a signal.
+    ///
+    /// @return Collection of received packets (possibly empty).
+    Pkt4Collection receive4DirectBatch(uint32_t timeout_sec,
+                                       uint32_t timeout_usec = 0);
+
     /// @brief Receive IPv4 packets indirectly or data from external sockets.
     ///
     /// Attempts to receive a single DHCPv4 message from the packet queue.
@@ -1347,6 +1535,26 @@ protected:
     /// @return Pkt4 object representing received packet (or null)
     Pkt4Ptr receive4Indirect(uint32_t timeout_sec, uint32_t timeout_usec = 0);
 
+    /// @brief Receive a batch of IPv4 packets indirectly or data from
+    /// external sockets.
+    ///
+    /// Works like @c receive4Indirect but takes up to the configured batch
+    /// size of packets from the packet queue.
+    ///
+    /// @param timeout_sec specifies integral part of the timeout (in seconds)
+    /// @param timeout_usec specifies fractional part of the timeout
+    /// (in microseconds)
+    ///
+    /// @throw isc::BadValue if timeout_usec is greater than one million
+    /// @throw isc::dhcp::SocketReadError if error occurred when receiving a
+    /// packet.
+    /// @throw isc::dhcp::SignalInterruptOnSelect when a call to select() is
+    /// interrupted by a signal.
+    ///
+    /// @return Collection of received packets (possibly empty).
+    Pkt4Collection receive4IndirectBatch(uint32_t timeout_sec,
+                                         uint32_t timeout_usec = 0);
+
     /// @brief Opens IPv6 socket.
     ///
     /// Please do not use this method directly. Use openSocket instead.
@@ -1386,6 +1594,26 @@ protected:
     /// @return Pkt6 object representing received packet (or null)
     Pkt6Ptr receive6Direct(uint32_t timeout_sec, uint32_t timeout_usec = 0);
 
+    /// @brief Receive a batch of IPv6 packets directly or data from external
+    /// sockets.
+    ///
+    /// Works like @c receive6Direct but receives up to the configured batch
+    /// size of packets from the socket which has data.
+    ///
+    /// @param timeout_sec specifies integral part of the timeout (in seconds)
+    /// @param timeout_usec specifies fractional part of the timeout
+    /// (in microseconds)
+    ///
+    /// @throw isc::BadValue if timeout_usec is greater than one million
+    /// @throw isc::dhcp::SocketReadError if error occurred when receiving a
+    /// packet.
+    /// @throw isc::dhcp::SignalInterruptOnSelect when a call to select() is
+    /// interrupted by a signal.
+    ///
+    /// @return Collection of received packets (possibly empty).
+    Pkt6Collection receive6DirectBatch(uint32_t timeout_sec,
+                                       uint32_t timeout_usec = 0);
+
     /// @brief Receive IPv6 packets indirectly or data from external sockets.
     ///
     /// Attempts to receive a single DHCPv6 message from the packet queue.
@@ -1408,6 +1636,26 @@ protected:
     /// @return Pkt6 object representing received packet (or null)
     Pkt6Ptr receive6Indirect(uint32_t timeout_sec, uint32_t timeout_usec = 0);
 
+    /// @brief Receive a batch of IPv6 packets indirectly or data from
+    /// external sockets.
+    ///
+    /// Works like @c receive6Indirect but takes up to the configured batch
+    /// size of packets from the packet queue.
+    ///
+    /// @param timeout_sec specifies integral part of the timeout (in seconds)
+    /// @param timeout_usec specifies fractional part of the timeout
+    /// (in microseconds)
+    ///
+    /// @throw isc::BadValue if timeout_usec is greater than one million
+    /// @throw isc::dhcp::SocketReadError if error occurred when receiving a
+    /// packet.
+    /// @throw isc::dhcp::SignalInterruptOnSelect when a call to select() is
+    /// interrupted by a signal.
+    ///
+    /// @return Collection of received packets (possibly empty).
+    Pkt6Collection receive6IndirectBatch(uint32_t timeout_sec,
+                                         uint32_t timeout_usec = 0);
+
 
     /// @brief Stub implementation of network interface detection.
     ///
@@ -1475,15 +1723,91 @@ private:
                              const uint16_t port,
                              IfaceMgrErrorMsgCallback error_handler = 0);
 
+    /// @brief Waits for data on IPv4 sockets or external sockets.
+    ///
+    /// Waits for the data on any of the open IPv4 sockets or registered
+    /// external sockets. If an external socket has data, its callback is
+    /// invoked. This function doesn't read any data from the IPv4 sockets.
+    ///
+    /// @param timeout_sec specifies integral part of the timeout (in seconds)
+    /// @param timeout_usec specifies fractional part of the timeout
+    /// (in microseconds)
+    /// @param [out] recv_if interface of the socket which has data.
+    ///
+    /// @throw isc::BadValue if timeout_usec is greater than one million
+    /// @throw isc::dhcp::SocketReadError if error occurred when waiting.
+    /// @throw isc::dhcp::SignalInterruptOnSelect when a call to select() is
+    /// interrupted by a signal.
+    ///
+    /// @return Pointer to the socket which has DHCPv4 data or null if the
+    /// timeout has been reached or an external socket has been handled.
+    const SocketInfo* waitForSocket4(uint32_t timeout_sec,
+                                     uint32_t timeout_usec,
+                                     IfacePtr& recv_if);
+
+    /// @brief Waits for data on IPv6 sockets or external sockets.
+    ///
+    /// Waits for the data on any of the open IPv6 sockets or registered
+    /// external sockets. If an external socket has data, its callback is
+    /// invoked. This function doesn't read any data from the IPv6 sockets.
+    ///
+    /// @param timeout_sec specifies integral part of the timeout (in seconds)
+    /// @param timeout_usec specifies fractional part of the timeout
+    /// (in microseconds)
+    ///
+    /// @throw isc::BadValue if timeout_usec is greater than one million
+    /// @throw isc::dhcp::SocketReadError if error occurred when waiting.
+    /// @throw isc::dhcp::SignalInterruptOnSelect when a call to select() is
+    /// interrupted by a signal.
+    ///
+    /// @return Pointer to the socket which has DHCPv6 data or null if the
+    /// timeout has been reached or an external socket has been handled.
+    const SocketInfo* waitForSocket6(uint32_t timeout_sec,
+                                     uint32_t timeout_usec);
+
+    /// @brief Waits for DHCPv4 packets in the queue or data on external
+    /// sockets.
+    ///
+    /// @param timeout_sec specifies integral part of the timeout (in seconds)
+    /// @param timeout_usec specifies fractional part of the timeout
+    /// (in microseconds)
+    ///
+    /// @throw isc::BadValue if timeout_usec is greater than one million
+    /// @throw isc::dhcp::SocketReadError if error occurred when waiting or
+    /// the receiver thread reported an error.
+    /// @throw isc::dhcp::SignalInterruptOnSelect when a call to select() is
+    /// interrupted by a signal.
+    ///
+    /// @return true if packets should be taken from the queue, false if the
+    /// timeout has been reached or an external socket has been handled.
+    bool waitForQueue4(uint32_t timeout_sec, uint32_t timeout_usec);
+
+    /// @brief Waits for DHCPv6 packets in the queue or data on external
+    /// sockets.
+    ///
+    /// @param timeout_sec specifies integral part of the timeout (in seconds)
+    /// @param timeout_usec specifies fractional part of the timeout
+    /// (in microseconds)
+    ///
+    /// @throw isc::BadValue if timeout_usec is greater than one million
+    /// @throw isc::dhcp::SocketReadError if error occurred when waiting or
+    /// the receiver thread reported an error.
+    /// @throw isc::dhcp::SignalInterruptOnSelect when a call to select() is
+    /// interrupted by a signal.
+    ///
+    /// @return true if packets should be taken from the queue, false if the
+    /// timeout has been reached or an external socket has been handled.
+    bool waitForQueue6(uint32_t timeout_sec, uint32_t timeout_usec);
+
     /// @brief DHCPv4 receiver method.
     ///
     /// Loops forever reading DHCPv4 packets from the interface sockets
     /// and adds them to the packet queue.  It monitors the "terminate"
     /// watch socket, and exits if it is marked ready.  This is method
     /// is used as the worker function in the thread created by @c
-    /// startDHCP4Receiver().  It currently uses select() to monitor
-    /// socket readiness.  If the select errors out (other than EINTR),
-    /// it marks the "error" watch socket as ready.
+    /// startDHCP4Receiver().  It uses its own event handler of the
+    /// configured type to monitor socket readiness.  If the wait errors
+    /// out (other than EINTR), it marks the "error" watch socket as ready.
     void receiveDHCP4Packets();
 
     /// @brief Receives a single DHCPv4 packet from an interface socket
@@ -1504,9 +1828,9 @@ private:
     /// and adds them to the packet queue.  It monitors the "terminate"
     /// watch socket, and exits if it is marked ready.  This is method
     /// is used as the worker function in the thread created by @c
-    /// startDHCP6Receiver().  It currently uses select() to monitor
-    /// socket readiness.  If the select errors out (other than EINTR),
-    /// it marks the "error" watch socket as ready.
+    /// startDHCP6Receiver().  It uses its own event handler of the
+    /// configured type to monitor socket readiness.  If the wait errors
+    /// out (other than EINTR), it marks the "error" watch socket as ready.
     void receiveDHCP6Packets();
 
     /// @brief Receives a single DHCPv6 packet from an interface socket
@@ -1525,6 +1849,91 @@ private:
     /// @param socketfd socket descriptor
     void deleteExternalSocketInternal(int socketfd);
 
+    /// @brief Sets of descriptors watched by the main thread event handler.
+    enum FDSetContent {
+        FD_SET_NONE,        ///< Nothing is watched yet.
+        FD_SET_SOCKETS4,    ///< IPv4 sockets and external sockets.
+        FD_SET_SOCKETS6,    ///< IPv6 sockets and external sockets.
+        FD_SET_QUEUE        ///< Receiver watch sockets and external sockets.
+    };
+
+    /// @brief Prepares the main thread event handler for a wait.
+    ///
+    /// The interest set of the event handler is persistent. It is only
+    /// rebuilt when the sockets or the external sockets have changed since
+    /// the last wait, or when the requested content differs from the one
+    /// used by the last wait.
+    ///
+    /// @param content the set of descriptors to watch.
+    void prepareFDEventHandler(const FDSetContent content);
+
+    /// @brief Invokes the callback of an external socket which has data.
+    ///
+    /// Must be called after a successful wait of the main thread event
+    /// handler.
+    ///
+    /// @return true if one of the external sockets is ready, false
+    /// otherwise.
+    bool handleExternalSockets();
+
+    /// @brief Adds the shards of a socket to an interface.
+    ///
+    /// @param iface the interface.
+    /// @param sockets the sockets returned by the packet filter, ordered
+    /// by shard.
+    /// @return The descriptor of the first socket.
+    int addSocketShards(Iface& iface, std::vector<SocketInfo> sockets);
+
+    /// @brief Closes a socket and the other shards of its address.
+    ///
+    /// @param iface the interface.
+    /// @param sockfd the descriptor of one of the shards.
+    void delSocketShards(Iface& iface, const int sockfd);
+
+    /// @brief Receive state of a socket shard.
+    struct ShardReceiver {
+        /// @brief Event handler watching the sockets of the shard.
+        util::FDEventHandlerPtr handler_;
+
+        /// @brief Sockets of the shard and their interfaces.
+        std::vector<std::pair<IfacePtr, SocketInfo> > sockets_;
+
+        /// @brief Value of @c sockets_generation_ when the sockets were
+        /// collected.
+        uint64_t generation_;
+
+        /// @brief Family of the sockets.
+        uint16_t family_;
+    };
+
+    /// @brief Pointer to the receive state of a socket shard.
+    typedef boost::shared_ptr<ShardReceiver> ShardReceiverPtr;
+
+    /// @brief Waits for data on the sockets of a shard.
+    ///
+    /// The event handler of the shard is rebuilt when the sockets have
+    /// changed since the last wait.
+    ///
+    /// @param shard index of the shard.
+    /// @param family AF_INET or AF_INET6.
+    /// @param timeout_sec specifies integral part of the timeout (in seconds)
+    /// @param timeout_usec specifies fractional part of the timeout
+    /// (in microseconds)
+    /// @return The receive state of the shard or null if no socket is
+    /// ready.
+    ShardReceiverPtr waitForShard(const size_t shard, const uint16_t family,
+                                  uint32_t timeout_sec, uint32_t timeout_usec);
+
+    /// @brief Finds the DHCP socket which has data.
+    ///
+    /// Must be called after a successful wait of the main thread event
+    /// handler.
+    ///
+    /// @param [out] recv_if interface of the socket which has data.
+    /// @return Pointer to the socket which has data.
+    /// @throw isc::dhcp::SocketReadError if no known socket has data.
+    const SocketInfo* findReadySocket(IfacePtr& recv_if);
+
     /// Holds instance of a class derived from PktFilter, used by the
     /// IfaceMgr to open sockets and send/receive packets through these
     /// sockets. It is possible to supply custom object using
@@ -1553,6 +1962,46 @@ private:
     /// @brief Allows to use loopback
     bool allow_loopback_;
 
+    /// @brief Maximum number of packets received in a batch.
+    size_t receive_batch_size_;
+
+    /// @brief Type of the event handlers.
+    util::FDEventHandler::HandlerType fd_event_handler_type_;
+
+    /// @brief Event handler used by the main thread to wait for data.
+    util::FDEventHandlerPtr fd_event_handler_;
+
+    /// @brief Set of descriptors currently in @c fd_event_handler_.
+    FDSetContent fd_set_content_;
+
+    /// @brief Generation of the sockets.
+    ///
+    /// It is incremented when sockets are opened or closed and when
+    /// external sockets are added or deleted, possibly from other threads.
+    /// The event handlers are rebuilt when it has changed since they
+    /// were prepared.
+    std::atomic<uint64_t> sockets_generation_;
+
+    /// @brief Value of @c sockets_generation_ when @c fd_event_handler_
+    /// was prepared.
+    uint64_t fd_set_generation_;
+
+    /// @brief Interfaces of the DHCP sockets in @c fd_event_handler_,
+    /// indexed by socket descriptor.
+    std::unordered_map<int, IfacePtr> fd_set_ifaces_;
+
+    /// @brief Indicates if the memory mapped receive ring is used.
+    bool packet_mmap_;
+
+    /// @brief Number of socket shards.
+    size_t socket_shards_;
+
+    /// @brief Receive states of the socket shards, indexed by shard.
+    std::vector<ShardReceiverPtr> shard_receivers_;
+
+    /// @brief Watch socket used to interrupt the shard receivers.
+    util::WatchSocketPtr shard_interrupt_;
+
     /// @brief Manager for DHCPv4 packet implementations and queues
     PacketQueueMgr4Ptr packet_queue_mgr4_;
 
@@ -1561,6 +2010,12 @@ private:
 
     /// DHCP packet receiver.
     isc::util::WatchedThreadPtr dhcp_receiver_;
+
+    /// @brief Marked by the DHCP packet receiver when packets are queued.
+    ///
+    /// Marks are coalesced, so a burst of packets costs a single wake up
+    /// of the thread dequeuing them.
+    isc::util::WatchEventPtr queue_ready_;
 };
 
 }; // namespace isc::dhcp
@@ -526,7 +526,7 @@ void Iface::setFlags(uint64_t flags) {
 void
 IfaceMgr::setMatchingPacketFilter(const bool direct_response_desired) {
     if (direct_response_desired) {
-        setPacketFilter(PktFilterPtr(new PktFilterLPF()));
+        setPacketFilter(PktFilterPtr(new PktFilterLPF(packet_mmap_)));
 
     } else {
         setPacketFilter(PktFilterPtr(new PktFilterInet()));
@@ -576,7 +576,7 @@ IfaceMgr::openMulticastSocket(Iface& iface,
             // has failed. We have to close the socket we previously
             // bound to link-local address - this is everything or
             // nothing strategy.
-            iface.delSocket(sock);
+            delSocketShards(iface, sock);
             IFACEMGR_ERROR(SocketConfigError, error_handler,
                            "Failed to open multicast socket on"
                            " interface " << iface.getName()
@@ -592,9 +592,16 @@ int
 IfaceMgr::openSocket6(Iface& iface, const IOAddress& addr, uint16_t port,
                       const bool join_multicast) {
     // Assuming that packet filter is not NULL, because its modifier checks it.
+    if (socket_shards_ > 1) {
+        return (addSocketShards(iface,
+                                packet_filter6_->openSocketShards(iface, addr, port,
+                                                                  join_multicast,
+                                                                  socket_shards_)));
+    }
     SocketInfo info = packet_filter6_->openSocket(iface, addr, port,
                                                   join_multicast);
     iface.addSocket(info);
+    ++sockets_generation_;
 
     return (info.sockfd_);
 }
@@ -156,9 +156,16 @@ int
 IfaceMgr::openSocket6(Iface& iface, const IOAddress& addr, uint16_t port,
                       const bool join_multicast) {
     IOAddress actual_address = join_multicast ? IOAddress("::") : addr;
+    if (socket_shards_ > 1) {
+        return (addSocketShards(iface,
+                                packet_filter6_->openSocketShards(iface, actual_address,
+                                                                  port, join_multicast,
+                                                                  socket_shards_)));
+    }
     SocketInfo info = packet_filter6_->openSocket(iface, actual_address, port,
                                                   join_multicast);
     iface.addSocket(info);
+    ++sockets_generation_;
     return (info.sockfd_);
 }
 
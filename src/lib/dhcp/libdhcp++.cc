@@ -824,7 +824,7 @@ LibDHCP::packOptions4(isc::util::OutputBuffer& buf,
     if (top) {
         auto x = options.find(DHO_DHCP_MESSAGE_TYPE);
         if (x != options.end()) {
-            x->second->pack(buf);
+            x->second->toWire(buf);
         }
     }
 
@@ -842,19 +842,19 @@ LibDHCP::packOptions4(isc::util::OutputBuffer& buf,
                 end = it->second;
                 break;
             default:
-                it->second->pack(buf);
+                it->second->toWire(buf);
                 break;
         }
     }
 
     // Add the RAI option if it exists.
     if (agent) {
-       agent->pack(buf);
+       agent->toWire(buf);
     }
 
     // And at the end the END option.
     if (end)  {
-       end->pack(buf);
+       end->toWire(buf);
     }
 }
 
@@ -863,7 +863,7 @@ LibDHCP::packOptions6(isc::util::OutputBuffer& buf,
                       const OptionCollection& options) {
     for (OptionCollection::const_iterator it = options.begin();
          it != options.end(); ++it) {
-        it->second->pack(buf);
+        it->second->toWire(buf);
     }
 }
 
@@ -183,7 +183,8 @@ public:
     /// @ref Pkt4::pack(). That call leads to it being called recursively in
     /// @ref Option::packOptions(). Thus the logic used to output the
     /// message type should only be executed by the top-most. This is governed
-    /// by the paramater top, below.
+    /// by the paramater top, below. Options having wire data, see
+    /// @ref Option::createWireData, are copied from it.
     ///
     /// @param buf output buffer (assembled options will be stored here)
     /// @param options collection of options to store to
@@ -204,7 +205,8 @@ public:
     /// too many options etc.)
     ///
     /// Currently there's no special logic in it. Options are stored in
-    /// the order of their option codes.
+    /// the order of their option codes. Options having wire data, see
+    /// @ref Option::createWireData, are copied from it.
     ///
     /// @param buf output buffer (assembled options will be stored here)
     /// @param options collection of options to store to
@@ -56,7 +56,7 @@ Option::Option(Universe u, uint16_t type, OptionBufferConstIter first,
 Option::Option(const Option& option)
     : universe_(option.universe_), type_(option.type_),
       data_(option.data_), options_(),
-      encapsulated_space_(option.encapsulated_space_) {
+      encapsulated_space_(option.encapsulated_space_), wire_data_() {
     option.getOptionsCopy(options_);
 }
 
@@ -78,6 +78,7 @@ Option::operator=(const Option& rhs) {
         data_ = rhs.data_;
         rhs.getOptionsCopy(options_);
         encapsulated_space_ = rhs.encapsulated_space_;
+        clearWireData();
     }
     return (*this);
 }
@@ -122,6 +123,32 @@ void Option::pack(isc::util::OutputBuffer& buf) const {
     packOptions(buf);
 }
 
+void
+Option::createWireData() {
+    clearWireData();
+    for (auto const& option : options_) {
+        option.second->createWireData();
+    }
+    isc::util::OutputBuffer buf(len());
+    pack(buf);
+    const uint8_t* data = static_cast<const uint8_t*>(buf.getData());
+    wire_data_.assign(data, data + buf.getLength());
+}
+
+bool
+Option::hasWireData() const {
+    if (wire_data_.empty()) {
+        return (false);
+    }
+    // A sub-option may have been modified since the wire data was created.
+    for (auto const& option : options_) {
+        if (!option.second->hasWireData()) {
+            return (false);
+        }
+    }
+    return (true);
+}
+
 void
 Option::packHeader(isc::util::OutputBuffer& buf) const {
     if (universe_ == V4) {
@@ -235,6 +262,7 @@ bool Option::delOption(uint16_t opt_type) {
     isc::dhcp::OptionCollection::iterator x = options_.find(opt_type);
     if ( x != options_.end() ) {
         options_.erase(x);
+        clearWireData();
         return true; // delete successful
     }
     return (false); // option not found, can't delete
@@ -354,6 +382,7 @@ void Option::addOption(OptionPtr opt) {
         }
     }
     options_.insert(make_pair(opt->getType(), opt));
+    clearWireData();
 }
 
 uint8_t Option::getUint8() const {
@@ -377,16 +406,19 @@ uint32_t Option::getUint32() const {
 void Option::setUint8(uint8_t value) {
     data_.resize(sizeof(value));
     data_[0] = value;
+    clearWireData();
 }
 
 void Option::setUint16(uint16_t value) {
     data_.resize(sizeof(value));
     writeUint16(value, &data_[0], data_.size());
+    clearWireData();
 }
 
 void Option::setUint32(uint32_t value) {
     data_.resize(sizeof(value));
     writeUint32(value, &data_[0], data_.size());
+    clearWireData();
 }
 
 bool Option::equals(const OptionPtr& other) const {
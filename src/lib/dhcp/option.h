@@ -8,10 +8,11 @@
 #define OPTION_H
 
 #include <util/buffer.h>
+#include <util/flat_multimap.h>
+#include <util/thread_cache.h>
 
 #include <boost/shared_ptr.hpp>
 
-#include <map>
 #include <string>
 #include <vector>
 
@@ -37,7 +38,15 @@ class Option;
 typedef boost::shared_ptr<Option> OptionPtr;
 
 /// A collection of DHCP (v4 or v6) options
-typedef std::multimap<unsigned int, OptionPtr> OptionCollection;
+///
+/// The options are stored in a vector sorted by option code, which is
+/// allocated from the cache of the calling thread. As opposed to a
+/// @c std::multimap, adding or removing an option invalidates the
+/// iterators of the collection.
+typedef util::FlatMultimap<unsigned int, OptionPtr, std::less<unsigned int>,
+                           util::ThreadCacheAllocator<std::pair<unsigned int,
+                                                                OptionPtr> > >
+OptionCollection;
 /// A pointer to an OptionCollection
 typedef boost::shared_ptr<OptionCollection> OptionCollectionPtr;
 
@@ -242,6 +251,46 @@ public:
     /// @throw BadValue Universe of the option is neither V4 nor V6.
     virtual void pack(isc::util::OutputBuffer& buf) const;
 
+    /// @brief Writes option in wire-format to a buffer, using the wire data
+    /// created by @ref createWireData when it is still valid.
+    ///
+    /// @param buf pointer to a buffer
+    ///
+    /// @throw as @ref pack when the option has no valid wire data.
+    void toWire(isc::util::OutputBuffer& buf) const {
+        if (hasWireData()) {
+            buf.writeData(&wire_data_[0], wire_data_.size());
+        } else {
+            pack(buf);
+        }
+    }
+
+    /// @brief Creates the wire data of the option and of its sub-options.
+    ///
+    /// The option is packed once and the result is kept: @ref toWire
+    /// then copies it instead of packing the option again. It is used
+    /// for the configured options, which are included as they are in
+    /// many responses. The wire data is cleared by every setter of the
+    /// option classes and when sub-options are added or deleted. The
+    /// wire data of an option is not used when the wire data of one of
+    /// its sub-options was cleared.
+    ///
+    /// @throw as @ref pack.
+    void createWireData();
+
+    /// @brief Clears the wire data of the option.
+    void clearWireData() {
+        if (!wire_data_.empty()) {
+            OptionBuffer().swap(wire_data_);
+        }
+    }
+
+    /// @brief Checks if the option has valid wire data.
+    ///
+    /// @return true if @ref createWireData was called and neither the
+    /// option nor its sub-options were modified since then.
+    bool hasWireData() const;
+
     /// @brief Parses received buffer.
     ///
     /// @param begin iterator to first byte of option data
@@ -407,6 +456,7 @@ public:
     template<typename InputIterator>
     void setData(InputIterator first, InputIterator last) {
         data_.assign(first, last);
+        clearWireData();
     }
 
     /// @brief Sets the name of the option space encapsulated by this option.
@@ -415,6 +465,7 @@ public:
     /// this option.
     void setEncapsulatedSpace(const std::string& encapsulated_space) {
         encapsulated_space_ = encapsulated_space;
+        clearWireData();
     }
 
     /// @brief Returns the name of the option space encapsulated by this option.
@@ -427,6 +478,24 @@ public:
     /// just to force that every option has virtual dtor
     virtual ~Option();
 
+    /// @brief Allocates an option from the cache of the calling thread.
+    ///
+    /// Options are created and destroyed for each packet, so their
+    /// memory is recycled by @c util::ThreadBlockCache.
+    ///
+    /// @param size size of the option object.
+    static void* operator new(size_t size) {
+        return (util::ThreadBlockCache::allocate(size));
+    }
+
+    /// @brief Frees an option to the cache of the calling thread.
+    ///
+    /// @param ptr pointer to the option object.
+    /// @param size size of the option object.
+    static void operator delete(void* ptr, size_t size) {
+        util::ThreadBlockCache::deallocate(ptr, size);
+    }
+
     /// @brief Checks if options are equal.
     ///
     /// This method calls a virtual @c equals function to compare objects.
@@ -565,6 +634,10 @@ protected:
     /// Name of the option space being encapsulated by this option.
     std::string encapsulated_space_;
 
+    /// Option in wire-format, see @ref createWireData. It is not copied
+    /// with the option.
+    OptionBuffer wire_data_;
+
     /// @todo probably 2 different containers have to be used for v4 (unique
     /// options) and v6 (options with the same type can repeat)
 };
@@ -91,6 +91,7 @@ void Option4AddrLst::setAddress(const isc::asiolink::IOAddress& addr) {
     }
     addrs_.clear();
     addAddress(addr);
+    clearWireData();
 }
 
 void Option4AddrLst::setAddresses(const AddressContainer& addrs) {
@@ -102,6 +103,7 @@ void Option4AddrLst::setAddresses(const AddressContainer& addrs) {
          addr != addrs.end(); ++addr) {
         addAddress(*addr);
     }
+    clearWireData();
 }
 
 
@@ -111,6 +113,7 @@ void Option4AddrLst::addAddress(const isc::asiolink::IOAddress& addr) {
                   << "Option4AddrLst option");
     }
     addrs_.push_back(addr);
+    clearWireData();
 }
 
 uint16_t Option4AddrLst::len() const {
@@ -410,6 +410,7 @@ Option4ClientFqdn::setFlag(const uint8_t flag, const bool set_flag) {
     // bits are not set.
     Option4ClientFqdnImpl::checkFlags(new_flag, true);
     impl_->flags_ = new_flag;
+    clearWireData();
 }
 
 std::pair<Option4ClientFqdn::Rcode, Option4ClientFqdn::Rcode>
@@ -421,11 +422,13 @@ void
 Option4ClientFqdn::setRcode(const Rcode& rcode) {
     impl_->rcode1_ = rcode;
     impl_->rcode2_ = rcode;
+    clearWireData();
 }
 
 void
 Option4ClientFqdn::resetFlags() {
     impl_->flags_ = 0;
+    clearWireData();
 }
 
 std::string
@@ -471,11 +474,13 @@ void
 Option4ClientFqdn::setDomainName(const std::string& domain_name,
                                  const DomainNameType domain_name_type) {
     impl_->setDomainName(domain_name, domain_name_type);
+    clearWireData();
 }
 
 void
 Option4ClientFqdn::resetDomainName() {
     setDomainName("", PARTIAL);
+    clearWireData();
 }
 
 Option4ClientFqdn::DomainNameType
@@ -54,11 +54,13 @@ Option6AddrLst::setAddress(const isc::asiolink::IOAddress& addr) {
 
     addrs_.clear();
     addrs_.push_back(addr);
+    clearWireData();
 }
 
 void
 Option6AddrLst::setAddresses(const AddressContainer& addrs) {
     addrs_ = addrs;
+    clearWireData();
 }
 
 void Option6AddrLst::pack(isc::util::OutputBuffer& buf) const {
@@ -76,27 +76,42 @@ public:
     /// Set protocol type
     ///
     /// @param proto protocol type to be set
-    void setProtocol(uint8_t proto) { protocol_ = proto; }
+    void setProtocol(uint8_t proto) {
+        protocol_ = proto;
+        clearWireData();
+    }
 
     /// Set hash alogrithm type
     ///
     /// @param algo hash alogrithm type to be set
-    void setHashAlgo(uint8_t algo) { algorithm_ = algo; }
+    void setHashAlgo(uint8_t algo) {
+        algorithm_ = algo;
+        clearWireData();
+    }
 
     /// Set replay detection method type
     ///
     /// @param method replay detection method to be set
-    void setReplyDetectionMethod(uint8_t method) { rdm_method_ = method; }
+    void setReplyDetectionMethod(uint8_t method) {
+        rdm_method_ = method;
+        clearWireData();
+    }
 
     /// Set replay detection method value
     ///
     /// @param value replay detection method value to be set
-    void setReplyDetectionValue(uint64_t value) { rdm_value_ = value; }
+    void setReplyDetectionValue(uint64_t value) {
+        rdm_value_ = value;
+        clearWireData();
+    }
 
     /// Set authentication information 
     ///
     /// @param auth_info authentication information to be set
-    void setAuthInfo(const std::vector<uint8_t>& auth_info) { auth_info_ = auth_info; }
+    void setAuthInfo(const std::vector<uint8_t>& auth_info) {
+        auth_info_ = auth_info;
+        clearWireData();
+    }
 
     /// Returns protocol type
     ///
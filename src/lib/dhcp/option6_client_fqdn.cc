@@ -349,11 +349,13 @@ Option6ClientFqdn::setFlag(const uint8_t flag, const bool set_flag) {
     // Check new flags. If they are valid, apply them.
     Option6ClientFqdnImpl::checkFlags(new_flag, true);
     impl_->flags_ = new_flag;
+    clearWireData();
 }
 
 void
 Option6ClientFqdn::resetFlags() {
     impl_->flags_ = 0;
+    clearWireData();
 }
 
 std::string
@@ -390,11 +392,13 @@ void
 Option6ClientFqdn::setDomainName(const std::string& domain_name,
                                  const DomainNameType domain_name_type) {
     impl_->setDomainName(domain_name, domain_name_type);
+    clearWireData();
 }
 
 void
 Option6ClientFqdn::resetDomainName() {
     setDomainName("", PARTIAL);
+    clearWireData();
 }
 
 Option6ClientFqdn::DomainNameType
@@ -85,6 +85,7 @@ public:
     /// @param status_code New numeric status code.
     void setStatusCode(const uint16_t status_code) {
         status_code_ = status_code;
+        clearWireData();
     }
 
     /// @brief Returns status message.
@@ -97,6 +98,7 @@ public:
     /// @param status_message New status message (empty string is allowed).
     void setStatusMessage(const std::string& status_message) {
         status_message_ = status_message;
+        clearWireData();
     }
 
 private:
@@ -179,6 +181,7 @@ public:
     /// @param mandatory_flag New numeric status code.
     void setMandatoryFlag(const bool mandatory_flag) {
         mandatory_flag_ = mandatory_flag;
+        clearWireData();
     }
 
     /// @brief Returns scope list.
@@ -191,6 +194,7 @@ public:
     /// @param scope_list New scope list (empty string is allowed).
     void setScopeList(std::string& scope_list) {
         scope_list_ = scope_list;
+        clearWireData();
     }
 
 private:
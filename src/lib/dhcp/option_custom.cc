@@ -63,6 +63,7 @@ OptionCustom::addArrayDataField(const IOAddress& address) {
     OptionBuffer buf;
     OptionDataTypeUtil::writeAddress(address, buf);
     buffers_.push_back(buf);
+    clearWireData();
 }
 
 void
@@ -74,6 +75,7 @@ OptionCustom::addArrayDataField(const std::string& value) {
     OptionBuffer buf;
     OptionDataTypeUtil::writeTuple(value, lft, buf);
     buffers_.push_back(buf);
+    clearWireData();
 }
 
 void
@@ -83,6 +85,7 @@ OptionCustom::addArrayDataField(const OpaqueDataTuple& value) {
     OptionBuffer buf;
     OptionDataTypeUtil::writeTuple(value, buf);
     buffers_.push_back(buf);
+    clearWireData();
 }
 
 void
@@ -92,6 +95,7 @@ OptionCustom::addArrayDataField(const bool value) {
     OptionBuffer buf;
     OptionDataTypeUtil::writeBool(value, buf);
     buffers_.push_back(buf);
+    clearWireData();
 }
 
 void
@@ -107,6 +111,7 @@ OptionCustom::addArrayDataField(const PrefixLen& prefix_len,
     OptionBuffer buf;
     OptionDataTypeUtil::writePrefix(prefix_len, prefix, buf);
     buffers_.push_back(buf);
+    clearWireData();
 }
 
 void
@@ -122,6 +127,7 @@ OptionCustom::addArrayDataField(const PSIDLen& psid_len, const PSID& psid) {
     OptionBuffer buf;
     OptionDataTypeUtil::writePsid(psid_len, psid, buf);
     buffers_.push_back(buf);
+    clearWireData();
 }
 
 void
@@ -510,6 +516,7 @@ OptionCustom::writeAddress(const IOAddress& address,
     OptionBuffer buf;
     OptionDataTypeUtil::writeAddress(address, buf);
     std::swap(buf, buffers_[index]);
+    clearWireData();
 }
 
 const OptionBuffer&
@@ -523,6 +530,7 @@ OptionCustom::writeBinary(const OptionBuffer& buf,
                           const uint32_t index) {
     checkIndex(index);
     buffers_[index] = buf;
+    clearWireData();
 }
 
 std::string
@@ -548,6 +556,7 @@ OptionCustom::writeTuple(const std::string& value, const uint32_t index) {
     OpaqueDataTuple::LengthFieldType lft = getUniverse() == Option::V4 ?
         OpaqueDataTuple::LENGTH_1_BYTE : OpaqueDataTuple::LENGTH_2_BYTES;
     OptionDataTypeUtil::writeTuple(value, lft, buffers_[index]);
+    clearWireData();
 }
 
 void
@@ -556,6 +565,7 @@ OptionCustom::writeTuple(const OpaqueDataTuple& value, const uint32_t index) {
 
     buffers_[index].clear();
     OptionDataTypeUtil::writeTuple(value, buffers_[index]);
+    clearWireData();
 }
 
 bool
@@ -570,6 +580,7 @@ OptionCustom::writeBoolean(const bool value, const uint32_t index) {
 
     buffers_[index].clear();
     OptionDataTypeUtil::writeBool(value, buffers_[index]);
+    clearWireData();
 }
 
 std::string
@@ -593,6 +604,7 @@ OptionCustom::writeFqdn(const std::string& fqdn, const uint32_t index) {
     // We can move the contents of the temporary buffer to the
     // target buffer.
     std::swap(buffers_[index], buf);
+    clearWireData();
 }
 
 PrefixTuple
@@ -612,6 +624,7 @@ OptionCustom::writePrefix(const PrefixLen& prefix_len,
     // If there are no errors while writing PSID to a buffer, we can
     // replace the current buffer with a new buffer.
     std::swap(buffers_[index], buf);
+    clearWireData();
 }
 
 
@@ -631,6 +644,7 @@ OptionCustom::writePsid(const PSIDLen& psid_len, const PSID& psid,
     // If there are no errors while writing PSID to a buffer, we can
     // replace the current buffer with a new buffer.
     std::swap(buffers_[index], buf);
+    clearWireData();
 }
 
 
@@ -653,6 +667,7 @@ OptionCustom::writeString(const std::string& text, const uint32_t index) {
     if (!text.empty()) {
         OptionDataTypeUtil::writeString(text, buffers_[index]);
     }
+    clearWireData();
 }
 
 void
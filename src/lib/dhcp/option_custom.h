@@ -116,6 +116,7 @@ public:
         OptionBuffer buf;
         OptionDataTypeUtil::writeInt<T>(value, buf);
         buffers_.push_back(buf);
+        clearWireData();
     }
 
     /// @brief Create new buffer and store tuple value in it
@@ -283,6 +284,7 @@ public:
         OptionDataTypeUtil::writeInt<T>(value, buf);
         // If successful, replace the old buffer with new one.
         std::swap(buffers_[index], buf);
+        clearWireData();
     }
 
     /// @brief Read a buffer as variable length prefix.
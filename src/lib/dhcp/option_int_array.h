@@ -131,6 +131,7 @@ public:
     /// @param value a value being added.
     void addValue(const T value) {
         values_.push_back(value);
+        clearWireData();
     }
 
     /// Writes option in wire-format to buf, returns pointer to first unused
@@ -232,7 +233,10 @@ public:
     /// @brief Set option values.
     ///
     /// @param values collection of values to be set for option.
-    void setValues(const std::vector<T>& values) { values_ = values; }
+    void setValues(const std::vector<T>& values) {
+        values_ = values;
+        clearWireData();
+    }
 
     /// @brief returns complete length of option
     ///
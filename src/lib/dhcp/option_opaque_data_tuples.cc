@@ -71,6 +71,7 @@ OptionOpaqueDataTuples::addTuple(const OpaqueDataTuple& tuple) {
     }
 
     tuples_.push_back(tuple);
+    clearWireData();
 }
 
 
@@ -88,6 +89,7 @@ OptionOpaqueDataTuples::setTuple(const size_t at, const OpaqueDataTuple& tuple)
     }
 
     tuples_[at] = tuple;
+    clearWireData();
 }
 
 OpaqueDataTuple
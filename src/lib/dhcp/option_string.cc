@@ -62,6 +62,7 @@ OptionString::setValue(const std::string& value) {
 
     // Now set the value.
     setData(begin, end);
+    clearWireData();
 }
 
 
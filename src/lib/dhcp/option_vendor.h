@@ -76,7 +76,10 @@ public:
     /// @brief Sets enterprise identifier
     ///
     /// @param vendor_id vendor identifier
-    void setVendorId(const uint32_t vendor_id) { vendor_id_ = vendor_id; }
+    void setVendorId(const uint32_t vendor_id) {
+        vendor_id_ = vendor_id;
+        clearWireData();
+    }
 
     /// @brief Returns enterprise identifier
     ///
@@ -101,6 +101,7 @@ OptionVendorClass::addTuple(const OpaqueDataTuple& tuple) {
     }
 
     tuples_.push_back(tuple);
+    clearWireData();
 }
 
 
@@ -118,6 +119,7 @@ OptionVendorClass::setTuple(const size_t at, const OpaqueDataTuple& tuple) {
     }
 
     tuples_[at] = tuple;
+    clearWireData();
 }
 
 OpaqueDataTuple
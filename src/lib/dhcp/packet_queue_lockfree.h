@@ -0,0 +1,287 @@
+// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef PACKET_QUEUE_LOCKFREE_H
+#define PACKET_QUEUE_LOCKFREE_H
+
+#include <dhcp/packet_queue.h>
+
+#include <boost/scoped_array.hpp>
+
+#include <atomic>
+#include <sstream>
+
+namespace isc {
+
+namespace dhcp {
+
+/// @brief Provides a lock-free ring-buffer implementation of the
+/// PacketQueue interface.
+///
+/// The queue is a bounded array of slots, each with a sequence number
+/// telling whether it is free for the next producer or filled for the
+/// next consumer. Producers and consumers claim positions with a compare
+/// and swap on the shared tail or head counter and never block each
+/// other, so any number of producers and consumers may use the queue.
+///
+/// Like @c PacketQueueRing, when the queue is full the oldest packet is
+/// discarded to make room for the new one.
+///
+/// @tparam PacketTypePtr Type of packet the queue contains.
+/// This expected to be either isc::dhcp::Pkt4Ptr or isc::dhcp::Pkt6Ptr
+template<typename PacketTypePtr>
+class PacketQueueLockFreeRing : public PacketQueue<PacketTypePtr> {
+public:
+    /// @brief Minimum queue capacity permitted.
+    static const size_t MIN_RING_CAPACITY = 5;
+
+    /// @brief Constructor
+    ///
+    /// @param queue_type logical name of the queue implementation
+    /// @param capacity maximum number of packets the queue can hold
+    ///
+    /// @throw BadValue if capacity is too low.
+    PacketQueueLockFreeRing(const std::string& queue_type, size_t capacity)
+        : PacketQueue<PacketTypePtr>(queue_type), capacity_(capacity),
+          head_(0), tail_(0) {
+        if (capacity < MIN_RING_CAPACITY) {
+            isc_throw(BadValue, "Queue capacity of " << capacity
+                      << " is invalid.  It must be at least "
+                      << MIN_RING_CAPACITY);
+        }
+        slots_.reset(new Slot[capacity_]);
+        for (size_t i = 0; i < capacity_; ++i) {
+            slots_[i].sequence_.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /// @brief virtual Destructor
+    virtual ~PacketQueueLockFreeRing(){};
+
+    /// @brief Adds a packet to the queue
+    ///
+    /// Calls @c shouldDropPacket to determine if the packet should be queued
+    /// or dropped.  If it should be queued it is added to the end of the
+    /// queue, discarding the oldest packet if the queue is full.
+    ///
+    /// @param packet packet to enqueue
+    /// @param source socket the packet came from
+    virtual void enqueuePacket(PacketTypePtr packet, const SocketInfo& source) {
+        if (!shouldDropPacket(packet, source)) {
+            pushPacket(packet);
+        }
+    }
+
+    /// @brief Dequeues the next packet from the queue
+    ///
+    /// @return A pointer to dequeued packet, or an empty pointer
+    /// if the queue is empty.
+    virtual PacketTypePtr dequeuePacket() {
+        return (popPacket());
+    }
+
+    /// @brief Determines if a packet should be discarded.
+    ///
+    /// This function is called in @c enqueuePacket. The default
+    /// implementation simply returns false (i.e. keep the packet).
+    /// Derivations must keep it thread safe.
+    ///
+    /// @return true if the packet should be dropped, false if it should be
+    /// kept.
+    virtual bool shouldDropPacket(PacketTypePtr /* packet */,
+                                  const SocketInfo& /* source */) {
+        return (false);
+    }
+
+    /// @brief Pushes a packet at the end of the queue.
+    ///
+    /// If the queue is full the oldest packet is discarded.
+    ///
+    /// @param packet packet to add to the queue
+    void pushPacket(PacketTypePtr& packet) {
+        while (!tryPush(packet)) {
+            // Full: make room by discarding the oldest packet. Another
+            // consumer may have made room in the meantime, which is fine.
+            static_cast<void>(popPacket());
+        }
+    }
+
+    /// @brief Pops the packet at the front of the queue.
+    ///
+    /// @return A pointer to dequeued packet, or an empty pointer
+    /// if the queue is empty.
+    PacketTypePtr popPacket() {
+        PacketTypePtr packet;
+        size_t pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots_[pos % capacity_];
+            size_t seq = slot.sequence_.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) -
+                            static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                // The slot is filled: try to claim it.
+                if (head_.compare_exchange_weak(pos, pos + 1,
+                                                std::memory_order_relaxed)) {
+                    packet.swap(slot.packet_);
+                    // Free the slot for the producer of the next lap.
+                    slot.sequence_.store(pos + capacity_,
+                                         std::memory_order_release);
+                    return (packet);
+                }
+                // Claimed by another consumer: pos was reloaded.
+            } else if (diff < 0) {
+                // Empty.
+                return (packet);
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// @brief Returns True if the queue is empty.
+    virtual bool empty() const {
+        return (getSize() == 0);
+    }
+
+    /// @brief Returns the maximum number of packets allowed in the buffer.
+    size_t getCapacity() const {
+        return (capacity_);
+    }
+
+    /// @brief Returns the current number of packets in the buffer.
+    ///
+    /// The value is a snapshot which may be outdated when it is returned
+    /// if other threads use the queue.
+    virtual size_t getSize() const {
+        size_t head = head_.load(std::memory_order_acquire);
+        size_t tail = tail_.load(std::memory_order_acquire);
+        // A packet being popped may be counted out before it is counted
+        // in, in which case the queue is considered empty.
+        return (tail > head ? tail - head : 0);
+    }
+
+    /// @brief Discards all packets currently in the buffer.
+    virtual void clear() {
+        while (popPacket()) {
+        }
+    }
+
+    /// @brief Fetches pertinent information
+    virtual data::ElementPtr getInfo() const {
+       data::ElementPtr info = PacketQueue<PacketTypePtr>::getInfo();
+       info->set("capacity", data::Element::create(static_cast<int64_t>(getCapacity())));
+       info->set("size", data::Element::create(static_cast<int64_t>(getSize())));
+       return(info);
+    }
+
+private:
+
+    /// @brief Tries to push a packet at the end of the queue.
+    ///
+    /// @param packet packet to add to the queue
+    /// @return false if the queue is full.
+    bool tryPush(PacketTypePtr& packet) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots_[pos % capacity_];
+            size_t seq = slot.sequence_.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) -
+                            static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                // The slot is free: try to claim it.
+                if (tail_.compare_exchange_weak(pos, pos + 1,
+                                                std::memory_order_relaxed)) {
+                    slot.packet_ = packet;
+                    // Publish the packet to the consumers.
+                    slot.sequence_.store(pos + 1, std::memory_order_release);
+                    return (true);
+                }
+                // Claimed by another producer: pos was reloaded.
+            } else if (diff < 0) {
+                // Full.
+                return (false);
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// @brief A slot of the ring.
+    struct Slot {
+        /// @brief Sequence number of the slot.
+        ///
+        /// It is equal to the position of the next push in the slot when
+        /// the slot is free and to that position plus one once the packet
+        /// is published.
+        std::atomic<size_t> sequence_;
+
+        /// @brief The packet.
+        PacketTypePtr packet_;
+    };
+
+    /// @brief Capacity of the ring.
+    const size_t capacity_;
+
+    /// @brief The slots.
+    boost::scoped_array<Slot> slots_;
+
+    /// @brief Padding between the counters so producers and consumers
+    /// do not share a cache line.
+    char pad0_[64];
+
+    /// @brief Position of the next pop.
+    std::atomic<size_t> head_;
+
+    /// @brief Padding between the counters.
+    char pad1_[64];
+
+    /// @brief Position of the next push.
+    std::atomic<size_t> tail_;
+
+    /// @brief Padding after the counters.
+    char pad2_[64];
+};
+
+/// @brief DHCPv4 lock-free packet queue buffer implementation
+///
+/// This implementation does not (currently) add any drop
+/// logic, it operates as a verbatim ring queue for DHCPv4 packets.
+class PacketQueueLockFreeRing4 : public PacketQueueLockFreeRing<Pkt4Ptr> {
+public:
+    /// @brief Constructor
+    ///
+    /// @param queue_type logical name of the queue implementation
+    /// @param capacity maximum number of packets the queue can hold
+    PacketQueueLockFreeRing4(const std::string& queue_type, size_t capacity)
+        : PacketQueueLockFreeRing(queue_type, capacity) {
+    };
+
+    /// @brief virtual Destructor
+    virtual ~PacketQueueLockFreeRing4(){}
+};
+
+/// @brief DHCPv6 lock-free packet queue buffer implementation
+///
+/// This implementation does not (currently) add any drop
+/// logic, it operates as a verbatim ring queue for DHCPv6 packets.
+class PacketQueueLockFreeRing6 : public PacketQueueLockFreeRing<Pkt6Ptr> {
+public:
+    /// @brief Constructor
+    ///
+    /// @param queue_type logical name of the queue implementation
+    /// @param capacity maximum number of packets the queue can hold
+    PacketQueueLockFreeRing6(const std::string& queue_type, size_t capacity)
+        : PacketQueueLockFreeRing(queue_type, capacity) {
+    };
+
+    /// @brief virtual Destructor
+    virtual ~PacketQueueLockFreeRing6(){}
+};
+
+}; // namespace isc::dhcp
+}; // namespace isc
+
+#endif // PACKET_QUEUE_LOCKFREE_H
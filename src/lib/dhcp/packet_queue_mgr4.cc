@@ -5,15 +5,21 @@
 // file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
 #include <config.h>
+#include <dhcp/packet_queue_lockfree.h>
+#include <dhcp/packet_queue_priority.h>
 #include <dhcp/packet_queue_ring.h>
 #include <dhcp/packet_queue_mgr4.h>
 
 #include <boost/scoped_ptr.hpp>
 
+#include <limits>
+
 namespace isc {
 namespace dhcp {
 
 const std::string PacketQueueMgr4::DEFAULT_QUEUE_TYPE4 = "kea-ring4";
+const std::string PacketQueueMgr4::LOCKFREE_QUEUE_TYPE4 = "kea-ring4-lockfree";
+const std::string PacketQueueMgr4::PRIORITY_QUEUE_TYPE4 = "kea-priority4";
 
 PacketQueueMgr4::PacketQueueMgr4() {
     // Register default queue factory
@@ -30,6 +36,48 @@ PacketQueueMgr4::PacketQueueMgr4() {
             PacketQueue4Ptr queue(new PacketQueueRing4(DEFAULT_QUEUE_TYPE4, capacity));
             return (queue);
         });
+
+    // Register the lock-free queue factory
+    registerPacketQueueFactory(LOCKFREE_QUEUE_TYPE4, [](data::ConstElementPtr parameters)
+                                          -> PacketQueue4Ptr {
+            size_t capacity;
+            try {
+                capacity = data::SimpleParser::getInteger(parameters, "capacity");
+            } catch (const std::exception& ex) {
+                isc_throw(InvalidQueueParameter, LOCKFREE_QUEUE_TYPE4 << " factory:"
+                          " 'capacity' parameter is missing/invalid: " << ex.what());
+            }
+
+            PacketQueue4Ptr queue(new PacketQueueLockFreeRing4(LOCKFREE_QUEUE_TYPE4, capacity));
+            return (queue);
+        });
+
+    // Register the priority queue factory
+    registerPacketQueueFactory(PRIORITY_QUEUE_TYPE4, [](data::ConstElementPtr parameters)
+                                          -> PacketQueue4Ptr {
+            size_t capacity;
+            try {
+                capacity = data::SimpleParser::getInteger(parameters, "capacity");
+            } catch (const std::exception& ex) {
+                isc_throw(InvalidQueueParameter, PRIORITY_QUEUE_TYPE4 << " factory:"
+                          " 'capacity' parameter is missing/invalid: " << ex.what());
+            }
+
+            uint32_t max_age = 0;
+            if (parameters->contains("max-age")) {
+                try {
+                    max_age = data::SimpleParser::getInteger(parameters, "max-age", 0,
+                                                             std::numeric_limits<uint32_t>::max());
+                } catch (const std::exception& ex) {
+                    isc_throw(InvalidQueueParameter, PRIORITY_QUEUE_TYPE4 << " factory:"
+                              " 'max-age' parameter is invalid: " << ex.what());
+                }
+            }
+
+            PacketQueue4Ptr queue(new PacketQueuePriority4(PRIORITY_QUEUE_TYPE4,
+                                                           capacity, max_age));
+            return (queue);
+        });
 }
 
 } // end of isc::dhcp namespace
@@ -25,6 +25,14 @@ public:
     /// @brief Logical name of the pre-registered, default queue implementation
     static const std::string DEFAULT_QUEUE_TYPE4;
 
+    /// @brief Logical name of the pre-registered lock-free queue
+    /// implementation
+    static const std::string LOCKFREE_QUEUE_TYPE4;
+
+    /// @brief Logical name of the pre-registered priority queue
+    /// implementation
+    static const std::string PRIORITY_QUEUE_TYPE4;
+
     /// It registers a default factory for DHCPv4 queues. 
     PacketQueueMgr4();
 
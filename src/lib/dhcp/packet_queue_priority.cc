@@ -0,0 +1,181 @@
+// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <dhcp/dhcp4.h>
+#include <dhcp/dhcp6.h>
+#include <dhcp/packet_queue_priority.h>
+
+namespace isc {
+namespace dhcp {
+
+namespace {
+
+/// @brief Maximum number of relay encapsulations followed when
+/// classifying a DHCPv6 packet.
+const int MAX_RELAY_HOPS = 32;
+
+/// @brief Finds a DHCPv6 option in a buffer of options.
+///
+/// @param data the options.
+/// @param len length of the options.
+/// @param code the option code.
+/// @param [out] option_len length of the option data.
+/// @return A pointer to the option data or null if it is not found.
+const uint8_t*
+findOption6(const uint8_t* data, size_t len, uint16_t code,
+            size_t& option_len) {
+    size_t offset = 0;
+    while (offset + 4 <= len) {
+        uint16_t opt_code = (data[offset] << 8) | data[offset + 1];
+        uint16_t opt_len = (data[offset + 2] << 8) | data[offset + 3];
+        offset += 4;
+        if (offset + opt_len > len) {
+            break;
+        }
+        if (opt_code == code) {
+            option_len = opt_len;
+            return (data + offset);
+        }
+        offset += opt_len;
+    }
+    return (0);
+}
+
+}
+
+PacketQueuePriority4::Lane
+PacketQueuePriority4::classify(const Pkt4Ptr& packet, std::string& key) const {
+    key.clear();
+    const OptionBuffer& data = packet->data_;
+    const size_t options_offset = Pkt4::DHCPV4_PKT_HDR_LEN + 4;
+    if (data.size() < options_offset) {
+        return (LANE_NORMAL);
+    }
+
+    // Walk the options after the magic cookie.
+    uint8_t type = 0;
+    const uint8_t* client_id = 0;
+    size_t client_id_len = 0;
+    uint32_t cookie = (data[Pkt4::DHCPV4_PKT_HDR_LEN] << 24) |
+        (data[Pkt4::DHCPV4_PKT_HDR_LEN + 1] << 16) |
+        (data[Pkt4::DHCPV4_PKT_HDR_LEN + 2] << 8) |
+        data[Pkt4::DHCPV4_PKT_HDR_LEN + 3];
+    if (cookie == DHCP_OPTIONS_COOKIE) {
+        size_t offset = options_offset;
+        while (offset < data.size()) {
+            uint8_t code = data[offset];
+            if (code == DHO_PAD) {
+                ++offset;
+                continue;
+            }
+            if ((code == DHO_END) || (offset + 1 >= data.size())) {
+                break;
+            }
+            size_t len = data[offset + 1];
+            offset += 2;
+            if (offset + len > data.size()) {
+                break;
+            }
+            if ((code == DHO_DHCP_MESSAGE_TYPE) && (len == 1)) {
+                type = data[offset];
+            } else if ((code == DHO_DHCP_CLIENT_IDENTIFIER) && (len > 0)) {
+                client_id = &data[offset];
+                client_id_len = len;
+            }
+            offset += len;
+        }
+    }
+
+    // The key is the message type followed by the client identifier or,
+    // if there is none, by the hardware type and address.
+    key.push_back(static_cast<char>(type));
+    if (client_id) {
+        key.push_back('i');
+        key.append(reinterpret_cast<const char*>(client_id), client_id_len);
+    } else {
+        size_t hlen = data[2];
+        if (hlen > Pkt4::MAX_CHADDR_LEN) {
+            hlen = Pkt4::MAX_CHADDR_LEN;
+        }
+        if (hlen == 0) {
+            key.clear();
+        } else {
+            key.push_back('h');
+            key.push_back(static_cast<char>(data[1]));
+            key.append(reinterpret_cast<const char*>(&data[28]), hlen);
+        }
+    }
+
+    switch (type) {
+    case DHCPREQUEST:
+    case DHCPDECLINE:
+    case DHCPRELEASE:
+        return (LANE_HIGH);
+    case DHCPINFORM:
+        return (LANE_LOW);
+    default:
+        return (LANE_NORMAL);
+    }
+}
+
+PacketQueuePriority6::Lane
+PacketQueuePriority6::classify(const Pkt6Ptr& packet, std::string& key) const {
+    key.clear();
+    const OptionBuffer& data = packet->data_;
+    if (data.size() < Pkt6::DHCPV6_PKT_HDR_LEN) {
+        return (LANE_NORMAL);
+    }
+
+    // Find the client message in the relay encapsulations.
+    const uint8_t* msg = &data[0];
+    size_t len = data.size();
+    for (int hops = 0; (msg[0] == DHCPV6_RELAY_FORW) && (hops < MAX_RELAY_HOPS);
+         ++hops) {
+        if (len < Pkt6::DHCPV6_RELAY_HDR_LEN + Pkt6::DHCPV6_PKT_HDR_LEN) {
+            return (LANE_NORMAL);
+        }
+        size_t relay_msg_len = 0;
+        const uint8_t* relay_msg =
+            findOption6(msg + Pkt6::DHCPV6_RELAY_HDR_LEN,
+                        len - Pkt6::DHCPV6_RELAY_HDR_LEN, D6O_RELAY_MSG,
+                        relay_msg_len);
+        if (!relay_msg || (relay_msg_len < Pkt6::DHCPV6_PKT_HDR_LEN)) {
+            return (LANE_NORMAL);
+        }
+        msg = relay_msg;
+        len = relay_msg_len;
+    }
+
+    uint8_t type = msg[0];
+    size_t client_id_len = 0;
+    const uint8_t* client_id =
+        findOption6(msg + Pkt6::DHCPV6_PKT_HDR_LEN,
+                    len - Pkt6::DHCPV6_PKT_HDR_LEN, D6O_CLIENTID,
+                    client_id_len);
+    if (client_id && client_id_len) {
+        key.push_back(static_cast<char>(type));
+        key.append(reinterpret_cast<const char*>(client_id), client_id_len);
+    }
+
+    switch (type) {
+    case DHCPV6_REQUEST:
+    case DHCPV6_CONFIRM:
+    case DHCPV6_RENEW:
+    case DHCPV6_REBIND:
+    case DHCPV6_RELEASE:
+    case DHCPV6_DECLINE:
+        return (LANE_HIGH);
+    case DHCPV6_INFORMATION_REQUEST:
+        return (LANE_LOW);
+    default:
+        return (LANE_NORMAL);
+    }
+}
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
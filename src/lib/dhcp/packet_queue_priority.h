@@ -0,0 +1,459 @@
+// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef PACKET_QUEUE_PRIORITY_H
+#define PACKET_QUEUE_PRIORITY_H
+
+#include <dhcp/packet_queue.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+
+namespace isc {
+
+namespace dhcp {
+
+/// @brief Provides a packet queue which prioritizes packets by message type.
+///
+/// Received packets are classified without being unpacked, by looking at
+/// the message type and client identifier in their raw data, into three
+/// lanes:
+/// - high: messages of clients extending or using their leases, e.g.
+///   DHCPREQUEST (which includes renewals) or DHCPv6 RENEW,
+/// - normal: new clients, e.g. DHCPDISCOVER and SOLICIT, and anything
+///   which is not classified in another lane,
+/// - low: information requests, e.g. DHCPINFORM.
+///
+/// Packets are dequeued from the highest priority lane which is not empty.
+/// When the queue is full, a new packet replaces the oldest packet of the
+/// lowest priority lane which is not higher than its own. It is dropped
+/// when all queued packets have a higher priority. A packet from a client
+/// which already has a packet of the same message type in the queue is a
+/// retransmission and is dropped. When a maximum age is set, packets which
+/// waited longer are dropped when they reach the front of their lane.
+///
+/// The drops are counted per lane. They are reported by @c getInfo and,
+/// when a drop callback is set, to the callback. The callback is invoked
+/// by the thread calling @c dequeuePacket, e.g. to update statistics from
+/// the thread processing the packets.
+///
+/// @tparam PacketTypePtr Type of packet the queue contains.
+/// This expected to be either isc::dhcp::Pkt4Ptr or isc::dhcp::Pkt6Ptr
+template<typename PacketTypePtr>
+class PacketQueuePriority : public PacketQueue<PacketTypePtr> {
+public:
+    /// @brief Minimum queue capacity permitted.
+    static const size_t MIN_RING_CAPACITY = 5;
+
+    /// @brief Priority lanes.
+    enum Lane {
+        LANE_HIGH = 0,
+        LANE_NORMAL = 1,
+        LANE_LOW = 2,
+        LANE_COUNT = 3
+    };
+
+    /// @brief Callback invoked with the number of packets dropped from a
+    /// lane since the last invocation.
+    typedef std::function<void(Lane, uint64_t)> DropCallback;
+
+    /// @brief Constructor
+    ///
+    /// @param queue_type logical name of the queue implementation
+    /// @param capacity maximum number of packets the queue can hold
+    /// @param max_age maximum time in milliseconds a packet may wait in
+    /// the queue, 0 for no limit.
+    ///
+    /// @throw BadValue if capacity is too low.
+    PacketQueuePriority(const std::string& queue_type, size_t capacity,
+                        uint32_t max_age)
+        : PacketQueue<PacketTypePtr>(queue_type), capacity_(capacity),
+          max_age_(max_age), size_(0) {
+        if (capacity < MIN_RING_CAPACITY) {
+            isc_throw(BadValue, "Queue capacity of " << capacity
+                      << " is invalid.  It must be at least "
+                      << MIN_RING_CAPACITY);
+        }
+        for (int lane = LANE_HIGH; lane < LANE_COUNT; ++lane) {
+            pending_drops_[lane] = 0;
+        }
+    }
+
+    /// @brief virtual Destructor
+    virtual ~PacketQueuePriority(){};
+
+    /// @brief Returns the name of a lane.
+    ///
+    /// @param lane the lane.
+    /// @return "high", "normal" or "low".
+    static std::string laneToText(Lane lane) {
+        switch (lane) {
+        case LANE_HIGH:
+            return ("high");
+        case LANE_NORMAL:
+            return ("normal");
+        case LANE_LOW:
+            return ("low");
+        default:
+            return ("unknown");
+        }
+    }
+
+    /// @brief Classifies a packet from its raw data.
+    ///
+    /// @param packet the packet, not yet unpacked.
+    /// @param [out] key set to a value identifying the client and the
+    /// message type, or left empty if they can't be found.
+    /// @return The lane of the packet.
+    virtual Lane classify(const PacketTypePtr& packet, std::string& key) const = 0;
+
+    /// @brief Adds a packet to the queue
+    ///
+    /// @param packet packet to enqueue
+    /// @param source socket the packet came from
+    virtual void enqueuePacket(PacketTypePtr packet, const SocketInfo& source) {
+        if (shouldDropPacket(packet, source)) {
+            return;
+        }
+
+        Entry entry;
+        entry.packet_ = packet;
+        Lane lane = classify(packet, entry.key_);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        // Drop retransmissions of queued packets.
+        if (!entry.key_.empty() && keys_.count(entry.key_)) {
+            countDrop(lane, stats_[lane].dropped_duplicate_);
+            return;
+        }
+
+        if (size_ >= capacity_) {
+            // Make room in the lowest priority lane not higher than the
+            // lane of the packet.
+            int victim = LANE_COUNT - 1;
+            while ((victim > static_cast<int>(lane)) && lanes_[victim].empty()) {
+                --victim;
+            }
+            if (lanes_[victim].empty()) {
+                countDrop(lane, stats_[lane].dropped_overflow_);
+                return;
+            }
+            Lane victim_lane = static_cast<Lane>(victim);
+            popEntry(victim_lane);
+            countDrop(victim_lane, stats_[victim_lane].dropped_overflow_);
+        }
+
+        if (!entry.key_.empty()) {
+            keys_.insert(entry.key_);
+        }
+        lanes_[lane].push_back(entry);
+        ++size_;
+    }
+
+    /// @brief Dequeues the next packet from the queue
+    ///
+    /// Returns the oldest packet of the highest priority lane which is not
+    /// empty, after discarding the packets which waited too long.
+    ///
+    /// @return A pointer to dequeued packet, or an empty pointer
+    /// if the queue is empty.
+    virtual PacketTypePtr dequeuePacket() {
+        PacketTypePtr packet;
+        uint64_t drops[LANE_COUNT];
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            boost::posix_time::ptime now =
+                boost::posix_time::microsec_clock::universal_time();
+            for (int lane = LANE_HIGH; lane < LANE_COUNT && !packet; ++lane) {
+                while (!lanes_[lane].empty()) {
+                    Entry entry = popEntry(static_cast<Lane>(lane));
+                    if (tooOld(entry.packet_, now)) {
+                        countDrop(static_cast<Lane>(lane),
+                                  stats_[lane].dropped_age_);
+                        continue;
+                    }
+                    packet = entry.packet_;
+                    break;
+                }
+            }
+            for (int lane = LANE_HIGH; lane < LANE_COUNT; ++lane) {
+                drops[lane] = pending_drops_[lane];
+                pending_drops_[lane] = 0;
+            }
+        }
+
+        // Report the drops without holding the lock.
+        if (drop_callback_) {
+            for (int lane = LANE_HIGH; lane < LANE_COUNT; ++lane) {
+                if (drops[lane]) {
+                    drop_callback_(static_cast<Lane>(lane), drops[lane]);
+                }
+            }
+        }
+
+        return (packet);
+    }
+
+    /// @brief Determines if a packet should be discarded.
+    ///
+    /// This function is called in @c enqueuePacket before the packet is
+    /// classified. The default implementation simply returns false
+    /// (i.e. keep the packet).
+    ///
+    /// @return true if the packet should be dropped, false if it should be
+    /// kept.
+    virtual bool shouldDropPacket(PacketTypePtr /* packet */,
+                                  const SocketInfo& /* source */) {
+        return (false);
+    }
+
+    /// @brief Sets the drop callback.
+    ///
+    /// It must be set before packets are queued.
+    ///
+    /// @param drop_callback the callback, or an empty function.
+    void setDropCallback(const DropCallback& drop_callback) {
+        drop_callback_ = drop_callback;
+    }
+
+    /// @brief Returns True if the queue is empty.
+    virtual bool empty() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return (size_ == 0);
+    }
+
+    /// @brief Returns the maximum number of packets allowed in the queue.
+    size_t getCapacity() const {
+        return (capacity_);
+    }
+
+    /// @brief Returns the maximum age of the packets in milliseconds.
+    uint32_t getMaxAge() const {
+        return (max_age_);
+    }
+
+    /// @brief Returns the current number of packets in the queue.
+    virtual size_t getSize() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return (size_);
+    }
+
+    /// @brief Returns the current number of packets in a lane.
+    ///
+    /// @param lane the lane.
+    size_t getLaneSize(Lane lane) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return (lanes_[lane].size());
+    }
+
+    /// @brief Discards all packets currently in the queue.
+    ///
+    /// The packets are not counted as dropped.
+    virtual void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int lane = LANE_HIGH; lane < LANE_COUNT; ++lane) {
+            lanes_[lane].clear();
+        }
+        keys_.clear();
+        size_ = 0;
+    }
+
+    /// @brief Fetches pertinent information
+    ///
+    /// In addition to the capacity and size, it contains for each lane
+    /// its size and the number of packets dropped because the queue was
+    /// full, because they waited too long or because they were client
+    /// retransmissions.
+    virtual data::ElementPtr getInfo() const {
+        data::ElementPtr info = PacketQueue<PacketTypePtr>::getInfo();
+        std::lock_guard<std::mutex> lock(mutex_);
+        info->set("capacity", data::Element::create(static_cast<int64_t>(capacity_)));
+        info->set("size", data::Element::create(static_cast<int64_t>(size_)));
+        info->set("max-age", data::Element::create(static_cast<int64_t>(max_age_)));
+        data::ElementPtr lanes = data::Element::createMap();
+        for (int lane = LANE_HIGH; lane < LANE_COUNT; ++lane) {
+            data::ElementPtr lane_info = data::Element::createMap();
+            lane_info->set("size",
+                           data::Element::create(static_cast<int64_t>(lanes_[lane].size())));
+            lane_info->set("dropped-overflow",
+                           data::Element::create(static_cast<int64_t>(stats_[lane].dropped_overflow_)));
+            lane_info->set("dropped-age",
+                           data::Element::create(static_cast<int64_t>(stats_[lane].dropped_age_)));
+            lane_info->set("dropped-duplicate",
+                           data::Element::create(static_cast<int64_t>(stats_[lane].dropped_duplicate_)));
+            lanes->set(laneToText(static_cast<Lane>(lane)), lane_info);
+        }
+        info->set("lanes", lanes);
+        return (info);
+    }
+
+private:
+
+    /// @brief A queued packet.
+    struct Entry {
+        /// @brief The packet.
+        PacketTypePtr packet_;
+
+        /// @brief The client and message type key, empty if unknown.
+        std::string key_;
+    };
+
+    /// @brief Drop counters of a lane.
+    struct LaneStats {
+        /// @brief Constructor.
+        LaneStats()
+            : dropped_overflow_(0), dropped_age_(0), dropped_duplicate_(0) {
+        }
+
+        /// @brief Packets dropped because the queue was full.
+        uint64_t dropped_overflow_;
+
+        /// @brief Packets dropped because they waited too long.
+        uint64_t dropped_age_;
+
+        /// @brief Packets dropped as client retransmissions.
+        uint64_t dropped_duplicate_;
+    };
+
+    /// @brief Removes the oldest entry of a lane.
+    ///
+    /// Must be called with the mutex locked on a lane which is not empty.
+    ///
+    /// @param lane the lane.
+    /// @return The removed entry.
+    Entry popEntry(Lane lane) {
+        Entry entry = lanes_[lane].front();
+        lanes_[lane].pop_front();
+        if (!entry.key_.empty()) {
+            keys_.erase(entry.key_);
+        }
+        --size_;
+        return (entry);
+    }
+
+    /// @brief Counts a dropped packet.
+    ///
+    /// Must be called with the mutex locked.
+    ///
+    /// @param lane the lane of the packet.
+    /// @param counter the counter of the drop reason.
+    void countDrop(Lane lane, uint64_t& counter) {
+        ++counter;
+        ++pending_drops_[lane];
+    }
+
+    /// @brief Checks if a packet waited too long.
+    ///
+    /// @param packet the packet.
+    /// @param now the current time.
+    bool tooOld(const PacketTypePtr& packet,
+                const boost::posix_time::ptime& now) const {
+        if (!max_age_) {
+            return (false);
+        }
+        return ((now - packet->getTimestamp()).total_milliseconds() >
+                static_cast<int64_t>(max_age_));
+    }
+
+    /// @brief Maximum number of packets in the queue.
+    const size_t capacity_;
+
+    /// @brief Maximum age of the packets in milliseconds, 0 for no limit.
+    const uint32_t max_age_;
+
+    /// @brief Number of packets in the queue.
+    size_t size_;
+
+    /// @brief The lanes, indexed by priority.
+    std::deque<Entry> lanes_[LANE_COUNT];
+
+    /// @brief Keys of the queued packets.
+    std::unordered_set<std::string> keys_;
+
+    /// @brief Drop counters, indexed by lane.
+    LaneStats stats_[LANE_COUNT];
+
+    /// @brief Drops not yet reported to the callback, indexed by lane.
+    uint64_t pending_drops_[LANE_COUNT];
+
+    /// @brief The drop callback.
+    DropCallback drop_callback_;
+
+    /// @brief Mutex for protecting queue accesses.
+    mutable std::mutex mutex_;
+};
+
+/// @brief DHCPv4 priority packet queue.
+class PacketQueuePriority4 : public PacketQueuePriority<Pkt4Ptr> {
+public:
+    /// @brief Constructor
+    ///
+    /// @param queue_type logical name of the queue implementation
+    /// @param capacity maximum number of packets the queue can hold
+    /// @param max_age maximum time in milliseconds a packet may wait in
+    /// the queue, 0 for no limit.
+    PacketQueuePriority4(const std::string& queue_type, size_t capacity,
+                         uint32_t max_age = 0)
+        : PacketQueuePriority(queue_type, capacity, max_age) {
+    };
+
+    /// @brief virtual Destructor
+    virtual ~PacketQueuePriority4(){}
+
+    /// @brief Classifies a DHCPv4 packet from its raw data.
+    ///
+    /// DHCPREQUEST, DHCPDECLINE and DHCPRELEASE go to the high lane,
+    /// DHCPINFORM to the low lane and the others (including BOOTP and
+    /// malformed packets) to the normal lane. The key is built from the
+    /// client identifier option or, when there is none, from the client
+    /// hardware address.
+    ///
+    /// @param packet the packet, not yet unpacked.
+    /// @param [out] key the client and message type key.
+    /// @return The lane of the packet.
+    virtual Lane classify(const Pkt4Ptr& packet, std::string& key) const;
+};
+
+/// @brief DHCPv6 priority packet queue.
+class PacketQueuePriority6 : public PacketQueuePriority<Pkt6Ptr> {
+public:
+    /// @brief Constructor
+    ///
+    /// @param queue_type logical name of the queue implementation
+    /// @param capacity maximum number of packets the queue can hold
+    /// @param max_age maximum time in milliseconds a packet may wait in
+    /// the queue, 0 for no limit.
+    PacketQueuePriority6(const std::string& queue_type, size_t capacity,
+                         uint32_t max_age = 0)
+        : PacketQueuePriority(queue_type, capacity, max_age) {
+    };
+
+    /// @brief virtual Destructor
+    virtual ~PacketQueuePriority6(){}
+
+    /// @brief Classifies a DHCPv6 packet from its raw data.
+    ///
+    /// Relayed messages are classified by the innermost client message.
+    /// REQUEST, RENEW, REBIND, CONFIRM, RELEASE and DECLINE go to the high
+    /// lane, INFORMATION-REQUEST to the low lane and the others to the
+    /// normal lane. The key is built from the client identifier option.
+    ///
+    /// @param packet the packet, not yet unpacked.
+    /// @param [out] key the client and message type key.
+    /// @return The lane of the packet.
+    virtual Lane classify(const Pkt6Ptr& packet, std::string& key) const;
+};
+
+}; // namespace isc::dhcp
+}; // namespace isc
+
+#endif // PACKET_QUEUE_PRIORITY_H
@@ -25,7 +25,9 @@ Pkt::Pkt(uint32_t transid, const isc::asiolink::IOAddress& local_addr,
      local_port_(local_port),
      remote_port_(remote_port),
      buffer_out_(0),
-     copy_retrieved_options_(false)
+     copy_retrieved_options_(false),
+     lazy_unpack_(false),
+     data_owner_(0)
 {
 }
 
@@ -40,25 +42,77 @@ Pkt::Pkt(const uint8_t* buf, uint32_t len, const isc::asiolink::IOAddress& local
      local_port_(local_port),
      remote_port_(remote_port),
      buffer_out_(0),
-     copy_retrieved_options_(false)
+     copy_retrieved_options_(false),
+     lazy_unpack_(false),
+     data_owner_(0)
 {
 
     if (len != 0) {
         if (buf == NULL) {
             isc_throw(InvalidParameter, "data buffer passed to Pkt is NULL");
         }
-        data_.resize(len);
-        memcpy(&data_[0], buf, len);
+        data_owner_ = util::ThreadBufferCache::assign(data_, buf, len);
     }
 }
 
 void
 Pkt::addOption(const OptionPtr& opt) {
+    // Keep the received options of the same code first.
+    unpackLazyOption(opt->getType());
     options_.insert(std::pair<int, OptionPtr>(opt->getType(), opt));
 }
 
+void
+Pkt::unpackLazyOption(uint16_t type) const {
+    if (!lazy_options_.empty()) {
+        // Packets are never const objects: the const accessors
+        // unpack the options they look for.
+        const_cast<Pkt*>(this)->unpackLazy(type, false);
+    }
+}
+
+void
+Pkt::unpackLazyOptions() const {
+    if (!lazy_options_.empty()) {
+        const_cast<Pkt*>(this)->unpackLazy(0, true);
+    }
+}
+
+void
+Pkt::unpackLazy(uint16_t type, bool all) {
+    size_t i = 0;
+    while (i < lazy_options_.size()) {
+        LazyOption lazy = lazy_options_[i];
+        if (!all && (lazy.code_ != type)) {
+            ++i;
+            continue;
+        }
+        lazy_options_.erase(lazy_options_.begin() + i);
+        OptionBuffer buf(data_.begin() + lazy.offset_,
+                         data_.begin() + lazy.offset_ + lazy.len_);
+        try {
+            unpackLazyBuffer(buf);
+        } catch (const SkipRemainingOptionsError&) {
+            // Ignore the options which follow, as when unpacking eagerly.
+            size_t kept = 0;
+            for (size_t j = 0; j < lazy_options_.size(); ++j) {
+                if (lazy_options_[j].offset_ < lazy.offset_) {
+                    lazy_options_[kept++] = lazy_options_[j];
+                }
+            }
+            lazy_options_.resize(kept);
+            return;
+        }
+    }
+}
+
+void
+Pkt::unpackLazyBuffer(const OptionBuffer&) {
+}
+
 OptionPtr
 Pkt::getNonCopiedOption(const uint16_t type) const {
+    unpackLazyOption(type);
     OptionCollection::const_iterator x = options_.find(type);
     if (x != options_.end()) {
         return (x->second);
@@ -68,6 +122,7 @@ Pkt::getNonCopiedOption(const uint16_t type) const {
 
 OptionPtr
 Pkt::getOption(const uint16_t type) {
+    unpackLazyOption(type);
     OptionCollection::iterator x = options_.find(type);
     if (x != options_.end()) {
         if (copy_retrieved_options_) {
@@ -82,6 +137,7 @@ Pkt::getOption(const uint16_t type) {
 bool
 Pkt::delOption(uint16_t type) {
 
+    unpackLazyOption(type);
     isc::dhcp::OptionCollection::iterator x = options_.find(type);
     if (x!=options_.end()) {
         options_.erase(x);
@@ -9,6 +9,7 @@
 
 #include <asiolink/io_address.h>
 #include <util/buffer.h>
+#include <util/thread_cache.h>
 #include <dhcp/option.h>
 #include <dhcp/hwaddr.h>
 #include <dhcp/classify.h>
@@ -192,6 +193,48 @@ public:
     /// @return true if option was deleted, false if no such option existed
     bool delOption(uint16_t type);
 
+    /// @brief Enables or disables lazy unpacking of the options.
+    ///
+    /// When enabled before @c unpack is called, unpacking only records
+    /// the location of the options in the received data. The options of
+    /// a given code are unpacked when they are first retrieved, e.g. by
+    /// @c getOption, and all of them when the whole collection is needed,
+    /// e.g. by @c pack or @c toText. Code iterating over @c options_
+    /// directly must call @c unpackLazyOptions first: retrieving an
+    /// option during the iteration could add options to the collection
+    /// and invalidate the iterators.
+    ///
+    /// @param lazy true to unpack the options lazily.
+    void setLazyUnpack(bool lazy) {
+        lazy_unpack_ = lazy;
+    }
+
+    /// @brief Returns true if the options are unpacked lazily.
+    bool getLazyUnpack() const {
+        return (lazy_unpack_);
+    }
+
+    /// @brief Returns true if some options are not unpacked yet.
+    bool hasLazyOptions() const {
+        return (!lazy_options_.empty());
+    }
+
+    /// @brief Unpacks the options of a given code not unpacked yet.
+    ///
+    /// Does nothing if there is none. It is const as the options are
+    /// unpacked by the const accessors too.
+    ///
+    /// @param type option code.
+    /// @throw any exception thrown by the option factories, except
+    /// @c SkipRemainingOptionsError: as when unpacking eagerly, the
+    /// options which follow the offending one are then ignored.
+    void unpackLazyOption(uint16_t type) const;
+
+    /// @brief Unpacks all options not unpacked yet.
+    ///
+    /// @throw as @c unpackLazyOption.
+    void unpackLazyOptions() const;
+
     /// @brief Returns text representation primary packet identifiers
     ///
     /// This method is intended to be used to provide as a consistent way to
@@ -581,10 +624,28 @@ public:
 
     /// @brief Virtual destructor.
     ///
-    /// There is nothing to clean up here, but since there are virtual methods,
-    /// we define virtual destructor to ensure that derived classes will have
-    /// a virtual one, too.
+    /// Gives the data buffer back to the cache of the thread which
+    /// received the packet.
     virtual ~Pkt() {
+        util::ThreadBufferCache::release(data_, data_owner_);
+    }
+
+    /// @brief Allocates a packet from the cache of the calling thread.
+    ///
+    /// Packets are created and destroyed for each exchange, so their
+    /// memory is recycled by @c util::ThreadBlockCache.
+    ///
+    /// @param size size of the packet object.
+    static void* operator new(size_t size) {
+        return (util::ThreadBlockCache::allocate(size));
+    }
+
+    /// @brief Frees a packet to the cache of the calling thread.
+    ///
+    /// @param ptr pointer to the packet object.
+    /// @param size size of the packet object.
+    static void operator delete(void* ptr, size_t size) {
+        util::ThreadBlockCache::deallocate(ptr, size);
     }
 
     /// @brief Classes this packet belongs to.
@@ -772,11 +833,62 @@ protected:
     /// packet timestamp
     boost::posix_time::ptime timestamp_;
 
+    /// @brief Location of an option not unpacked yet.
+    struct LazyOption {
+        /// @brief Option code.
+        uint16_t code_;
+
+        /// @brief Offset of the option header in @c data_.
+        size_t offset_;
+
+        /// @brief Length of the option, header included.
+        size_t len_;
+    };
+
+    /// @brief Records an option to be unpacked on demand.
+    ///
+    /// @param code option code.
+    /// @param offset offset of the option header in @c data_.
+    /// @param len length of the option, header included.
+    void addLazyOption(uint16_t code, size_t offset, size_t len) {
+        LazyOption lazy;
+        lazy.code_ = code;
+        lazy.offset_ = offset;
+        lazy.len_ = len;
+        lazy_options_.push_back(lazy);
+    }
+
+    /// @brief Unpacks options from the wire into @c options_.
+    ///
+    /// Called by @c unpackLazyOption and @c unpackLazyOptions with a
+    /// buffer holding one option. The @c Pkt4 and @c Pkt6 classes
+    /// implement it with the same function they use to unpack eagerly.
+    ///
+    /// @param buf buffer holding the option, header included.
+    virtual void unpackLazyBuffer(const OptionBuffer& buf);
+
+    /// @brief Indicates if the options are unpacked lazily.
+    bool lazy_unpack_;
+
+    /// @brief Options not unpacked yet, in wire order.
+    std::vector<LazyOption> lazy_options_;
+
     // remote HW address (src if receiving packet, dst if sending packet)
     HWAddrPtr remote_hwaddr_;
 
 private:
 
+    /// @brief Caches of the thread which filled the data buffer, null
+    /// when the packet was not received.
+    util::ThreadCaches* data_owner_;
+
+    /// @brief Unpacks options not unpacked yet.
+    ///
+    /// @param type option code.
+    /// @param all true to unpack all the options, false to unpack the
+    /// options of the given code.
+    void unpackLazy(uint16_t type, bool all);
+
     /// @brief Generic method that validates and sets HW address.
     ///
     /// This is a generic method used by all modifiers of this class
@@ -73,6 +73,7 @@ Pkt4::Pkt4(const uint8_t* data, size_t len)
 
 size_t
 Pkt4::len() {
+    unpackLazyOptions();
     size_t length = DHCPV4_PKT_HDR_LEN; // DHCPv4 header
 
     // ... and sum of lengths of all options
@@ -91,6 +92,9 @@ Pkt4::pack() {
         isc_throw(InvalidOperation, "Can't build Pkt4 packet. HWAddr not set.");
     }
 
+    // Options not unpacked yet are packed as well.
+    unpackLazyOptions();
+
     // Clear the output buffer to make sure that consecutive calls to pack()
     // will not result in concatenation of multiple packet copies.
     buffer_out_.clear();
@@ -198,6 +202,11 @@ Pkt4::unpack() {
         isc_throw(Unexpected, "Invalid or missing DHCP magic cookie");
     }
 
+    if (lazy_unpack_) {
+        indexOptions(buffer_in.getPosition());
+        return;
+    }
+
     size_t opts_len = buffer_in.getLength() - buffer_in.getPosition();
     vector<uint8_t> opts_buffer;
 
@@ -229,6 +238,44 @@ Pkt4::unpack() {
     // so we'll be able to log more detailed drop reason.
 }
 
+void
+Pkt4::indexOptions(size_t offset) {
+    // This follows the framing rules of LibDHCP::unpackOptions4 for the
+    // dhcp4 option space: options are recorded up to the END option, a
+    // truncated option or the end of the packet.
+    lazy_options_.clear();
+    while (offset < data_.size()) {
+        uint8_t opt_type = data_[offset];
+        if (opt_type == DHO_END) {
+            return;
+        }
+        if (opt_type == DHO_PAD) {
+            ++offset;
+            continue;
+        }
+        if (offset + 2 > data_.size()) {
+            return;
+        }
+        size_t opt_len = data_[offset + 1];
+        if (offset + 2 + opt_len > data_.size()) {
+            return;
+        }
+        // Deferred options are known before the options are unpacked.
+        if (LibDHCP::shouldDeferOptionUnpack(DHCP4_OPTION_SPACE, opt_type)) {
+            deferred_options_.push_back(opt_type);
+        }
+        addLazyOption(opt_type, offset, opt_len + 2);
+        offset += opt_len + 2;
+    }
+}
+
+void
+Pkt4::unpackLazyBuffer(const OptionBuffer& buf) {
+    // The deferred options were recorded by indexOptions.
+    std::list<uint16_t> deferred;
+    LibDHCP::unpackOptions4(buf, DHCP4_OPTION_SPACE, options_, deferred, false);
+}
+
 uint8_t Pkt4::getType() const {
     OptionPtr generic = getNonCopiedOption(DHO_DHCP_MESSAGE_TYPE);
     if (!generic) {
@@ -415,6 +462,12 @@ Pkt4::makeLabel(const HWAddrPtr& hwaddr, const ClientIdPtr& client_id) {
 
 std::string
 Pkt4::toText() const {
+    try {
+        unpackLazyOptions();
+    } catch (...) {
+        // Print the options which could be unpacked.
+    }
+
     stringstream output;
     output << "local_address=" << local_addr_ << ":" << local_port_
         << ", remote_address=" << remote_addr_
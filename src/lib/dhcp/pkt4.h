@@ -491,6 +491,17 @@ protected:
         return(HWAddrPtr());
     }
 
+    /// @brief Records the location of the options for lazy unpacking.
+    ///
+    /// @param offset offset of the first option in @c data_, after the
+    /// magic cookie.
+    void indexOptions(size_t offset);
+
+    /// @brief Unpacks DHCPv4 options from the wire into @c options_.
+    ///
+    /// @param buf buffer holding the option, header included.
+    virtual void unpackLazyBuffer(const OptionBuffer& buf);
+
     /// @brief local HW address (dst if receiving packet, src if sending packet)
     HWAddrPtr local_hwaddr_;
 
@@ -545,6 +556,9 @@ protected:
 /// @brief A pointer to Pkt4 object.
 typedef boost::shared_ptr<Pkt4> Pkt4Ptr;
 
+/// @brief A collection of pointers to Pkt4 objects.
+typedef std::vector<Pkt4Ptr> Pkt4Collection;
+
 } // isc::dhcp namespace
 
 } // isc namespace
@@ -252,6 +252,7 @@ uint16_t Pkt6::calculateRelaySizes() {
 }
 
 uint16_t Pkt6::directLen() const {
+    unpackLazyOptions();
     uint16_t length = DHCPV6_PKT_HDR_LEN; // DHCPv6 header
 
     for (OptionCollection::const_iterator it = options_.begin();
@@ -281,6 +282,9 @@ Pkt6::pack() {
 void
 Pkt6::packUDP() {
     try {
+        // Options not unpacked yet are packed as well.
+        unpackLazyOptions();
+
         // Make sure that the buffer is empty before we start writing to it.
         buffer_out_.clear();
 
@@ -413,6 +417,12 @@ Pkt6::unpackMsg(OptionBuffer::const_iterator begin,
     // perhaps for stats gathering we can uncomment this.
     //    size -= sizeof(uint32_t); // We just parsed 4 bytes header
 
+    if (lazy_unpack_) {
+        indexOptions(std::distance(data_.cbegin(), begin),
+                     std::distance(data_.cbegin(), end));
+        return;
+    }
+
     OptionBuffer opt_buffer(begin, end);
 
     // If custom option parsing function has been set, use this function
@@ -436,6 +446,27 @@ Pkt6::unpackMsg(OptionBuffer::const_iterator begin,
     (void)offset;
 }
 
+void
+Pkt6::indexOptions(size_t offset, size_t end) {
+    // This follows the framing rules of LibDHCP::unpackOptions6: options
+    // are recorded up to a truncated option or the end of the message.
+    lazy_options_.clear();
+    while (offset + Option::OPTION6_HDR_LEN <= end) {
+        uint16_t opt_type = isc::util::readUint16(&data_[offset], 2);
+        uint16_t opt_len = isc::util::readUint16(&data_[offset + 2], 2);
+        if (offset + Option::OPTION6_HDR_LEN + opt_len > end) {
+            return;
+        }
+        addLazyOption(opt_type, offset, Option::OPTION6_HDR_LEN + opt_len);
+        offset += Option::OPTION6_HDR_LEN + opt_len;
+    }
+}
+
+void
+Pkt6::unpackLazyBuffer(const OptionBuffer& buf) {
+    LibDHCP::unpackOptions6(buf, DHCP6_OPTION_SPACE, options_);
+}
+
 void
 Pkt6::unpackRelayMsg() {
 
@@ -622,6 +653,12 @@ Pkt6::getLabel() const {
 
 std::string
 Pkt6::toText() const {
+    try {
+        unpackLazyOptions();
+    } catch (...) {
+        // Print the options which could be unpacked.
+    }
+
     stringstream tmp;
 
     // First print the basics
@@ -670,6 +707,7 @@ Pkt6::getClientId() const {
 
 isc::dhcp::OptionCollection
 Pkt6::getNonCopiedOptions(const uint16_t opt_type) const {
+    unpackLazyOption(opt_type);
     std::pair<OptionCollection::const_iterator,
               OptionCollection::const_iterator> range = options_.equal_range(opt_type);
     return (OptionCollection(range.first, range.second));
@@ -677,6 +715,7 @@ Pkt6::getNonCopiedOptions(const uint16_t opt_type) const {
 
 isc::dhcp::OptionCollection
 Pkt6::getOptions(const uint16_t opt_type) {
+    unpackLazyOption(opt_type);
     OptionCollection options_copy;
 
     std::pair<OptionCollection::iterator,
@@ -18,6 +18,7 @@
 
 #include <iostream>
 #include <set>
+#include <vector>
 
 #include <time.h>
 
@@ -30,6 +31,9 @@ class Pkt6;
 /// @brief A pointer to Pkt6 packet
 typedef boost::shared_ptr<Pkt6> Pkt6Ptr;
 
+/// @brief A collection of pointers to Pkt6 objects.
+typedef std::vector<Pkt6Ptr> Pkt6Collection;
+
 /// @brief Represents a DHCPv6 packet
 ///
 /// This class represents a single DHCPv6 packet. It handles both incoming
@@ -548,6 +552,17 @@ protected:
     void unpackMsg(OptionBuffer::const_iterator begin,
                    OptionBuffer::const_iterator end);
 
+    /// @brief Records the location of the options for lazy unpacking.
+    ///
+    /// @param offset offset of the first option in @c data_.
+    /// @param end offset of the end of the message in @c data_.
+    void indexOptions(size_t offset, size_t end);
+
+    /// @brief Unpacks DHCPv6 options from the wire into @c options_.
+    ///
+    /// @param buf buffer holding the option, header included.
+    virtual void unpackLazyBuffer(const OptionBuffer& buf);
+
     /// @brief Unpacks relayed message (RELAY-FORW or RELAY-REPL).
     ///
     /// This method is called from unpackUDP() when received message
@@ -67,6 +67,26 @@ PktFilter::openFallbackSocket(const isc::asiolink::IOAddress& addr,
     return (sock);
 }
 
+std::vector<SocketInfo>
+PktFilter::openSocketShards(Iface& iface, const isc::asiolink::IOAddress& addr,
+                            const uint16_t port, const bool receive_bcast,
+                            const bool send_bcast, const size_t) {
+    std::vector<SocketInfo> sockets;
+    sockets.push_back(openSocket(iface, addr, port, receive_bcast, send_bcast));
+    return (sockets);
+}
+
+Pkt4Collection
+PktFilter::receiveBatch(Iface& iface, const SocketInfo& socket_info,
+                        const size_t) {
+    Pkt4Collection pkts;
+    Pkt4Ptr pkt = receive(iface, socket_info);
+    if (pkt) {
+        pkts.push_back(pkt);
+    }
+    return (pkts);
+}
+
 
 } // end of isc::dhcp namespace
 } // end of isc namespace
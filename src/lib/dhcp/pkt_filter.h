@@ -11,6 +11,8 @@
 #include <asiolink/io_address.h>
 #include <boost/shared_ptr.hpp>
 
+#include <vector>
+
 namespace isc {
 namespace dhcp {
 
@@ -84,6 +86,33 @@ public:
                                   const bool receive_bcast,
                                   const bool send_bcast) = 0;
 
+    /// @brief Open a set of sockets sharing the traffic of an address.
+    ///
+    /// Opens up to @c count primary sockets for the same address and
+    /// port which receive distinct subsets of the traffic: each packet is
+    /// delivered to exactly one of them (a shard) and all the packets sent
+    /// by a client are delivered to the same shard. This allows each shard
+    /// to be served by a different thread without a central dispatcher.
+    ///
+    /// The default implementation doesn't support sharding and opens a
+    /// single socket using @c openSocket.
+    ///
+    /// @param iface Interface descriptor.
+    /// @param addr Address on the interface to be used to send packets.
+    /// @param port Port number.
+    /// @param receive_bcast Configure sockets to receive broadcast messages
+    /// @param send_bcast configure sockets to send broadcast messages.
+    /// @param count Requested number of shards.
+    ///
+    /// @return Structures describing the sockets, ordered by shard. Only
+    /// the first one may have a fallback socket.
+    virtual std::vector<SocketInfo> openSocketShards(Iface& iface,
+                                                     const isc::asiolink::IOAddress& addr,
+                                                     const uint16_t port,
+                                                     const bool receive_bcast,
+                                                     const bool send_bcast,
+                                                     const size_t count);
+
     /// @brief Receive packet over specified socket.
     ///
     /// @param iface interface
@@ -103,6 +132,22 @@ public:
     virtual int send(const Iface& iface, uint16_t sockfd,
                      const Pkt4Ptr& pkt) = 0;
 
+    /// @brief Receive multiple packets over specified socket.
+    ///
+    /// This function receives up to @c max_count packets which are already
+    /// waiting in the socket's receive buffer. The default implementation
+    /// receives a single packet using @c receive. Derived classes may
+    /// override it to fetch several datagrams with a single system call.
+    ///
+    /// @param iface interface
+    /// @param socket_info structure holding socket information
+    /// @param max_count maximum number of packets to be received.
+    ///
+    /// @return Collection of received packets. It may be empty.
+    virtual Pkt4Collection receiveBatch(Iface& iface,
+                                        const SocketInfo& socket_info,
+                                        const size_t max_count);
+
 protected:
 
     /// @brief Default implementation to open a fallback socket.
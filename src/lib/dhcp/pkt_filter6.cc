@@ -7,6 +7,7 @@
 #include <config.h>
 
 #include <dhcp/pkt_filter6.h>
+#include <dhcp/socket_info.h>
 
 namespace isc {
 namespace dhcp {
@@ -33,6 +34,26 @@ PktFilter6::joinMulticast(int sock, const std::string& ifname,
     return (true);
 }
 
+std::vector<SocketInfo>
+PktFilter6::openSocketShards(const Iface& iface,
+                             const isc::asiolink::IOAddress& addr,
+                             const uint16_t port, const bool join_multicast,
+                             const size_t) {
+    std::vector<SocketInfo> sockets;
+    sockets.push_back(openSocket(iface, addr, port, join_multicast));
+    return (sockets);
+}
+
+Pkt6Collection
+PktFilter6::receiveBatch(const SocketInfo& socket_info, const size_t) {
+    Pkt6Collection pkts;
+    Pkt6Ptr pkt = receive(socket_info);
+    if (pkt) {
+        pkts.push_back(pkt);
+    }
+    return (pkts);
+}
+
 
 } // end of isc::dhcp namespace
 } // end of isc namespace
@@ -10,6 +10,8 @@
 #include <asiolink/io_address.h>
 #include <dhcp/pkt6.h>
 
+#include <vector>
+
 namespace isc {
 namespace dhcp {
 
@@ -91,6 +93,32 @@ public:
                                   const uint16_t port,
                                   const bool join_multicast) = 0;
 
+    /// @brief Opens a set of sockets sharing the traffic of an address.
+    ///
+    /// Opens up to @c count sockets for the same address and port which
+    /// receive distinct subsets of the traffic: each message is delivered
+    /// to exactly one of them (a shard) and all the messages sent by a
+    /// client are delivered to the same shard. This allows each shard to
+    /// be served by a different thread without a central dispatcher.
+    ///
+    /// The default implementation doesn't support sharding and opens a
+    /// single socket using @c openSocket.
+    ///
+    /// @param iface Interface descriptor.
+    /// @param addr Address on the interface to be used to send packets.
+    /// @param port Port number.
+    /// @param join_multicast A boolean parameter which indicates whether
+    /// sockets should join All_DHCP_Relay_Agents_and_servers multicast
+    /// group.
+    /// @param count Requested number of shards.
+    ///
+    /// @return Structures describing the sockets, ordered by shard.
+    virtual std::vector<SocketInfo> openSocketShards(const Iface& iface,
+                                                     const isc::asiolink::IOAddress& addr,
+                                                     const uint16_t port,
+                                                     const bool join_multicast,
+                                                     const size_t count);
+
     /// @brief Receives DHCPv6 message on the interface.
     ///
     /// This function receives a single DHCPv6 message through using a socket
@@ -115,6 +143,20 @@ public:
     virtual int send(const Iface& iface, uint16_t sockfd,
                      const Pkt6Ptr& pkt) = 0;
 
+    /// @brief Receives multiple DHCPv6 messages on the interface.
+    ///
+    /// This function receives up to @c max_count messages which are already
+    /// waiting in the socket's receive buffer. The default implementation
+    /// receives a single message using @c receive. Derived classes may
+    /// override it to fetch several datagrams with a single system call.
+    ///
+    /// @param socket_info A structure holding socket information.
+    /// @param max_count Maximum number of messages to be received.
+    ///
+    /// @return Collection of received messages. It may be empty.
+    virtual Pkt6Collection receiveBatch(const SocketInfo& socket_info,
+                                        const size_t max_count);
+
     /// @brief Joins IPv6 multicast group on a socket.
     ///
     /// This function joins the socket to the specified multicast group.
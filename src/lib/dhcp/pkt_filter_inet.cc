@@ -11,9 +11,86 @@
 #include <errno.h>
 #include <cstring>
 #include <fcntl.h>
+#include <vector>
+
+#if defined (OS_LINUX)
+#include <linux/filter.h>
+#endif
 
 using namespace isc::asiolink;
 
+namespace {
+
+#if defined (OS_LINUX) && defined (SO_ATTACH_REUSEPORT_CBPF)
+
+/// @brief Offset of the last four bytes of the client hardware address
+/// in a DHCPv4 message.
+///
+/// The chaddr field starts at offset 28 and Ethernet addresses are six
+/// bytes long.
+const uint32_t CHADDR_HASH_OFFSET = 30;
+
+/// @brief Length of the UDP header.
+const uint32_t UDP_HEADER_LEN = 8;
+
+/// @brief Builds the program selecting the shard of a DHCPv4 message.
+///
+/// The program is attached to a SO_REUSEPORT group. It runs with the
+/// DHCPv4 message at offset 0 and returns the index of the socket in
+/// the group.
+///
+/// @param count Number of shards.
+/// @return The program.
+std::vector<struct sock_filter>
+steeringProgram(const size_t count) {
+    std::vector<struct sock_filter> program = {
+        BPF_STMT(BPF_LD + BPF_W + BPF_ABS, CHADDR_HASH_OFFSET),
+        BPF_STMT(BPF_ALU + BPF_MOD + BPF_K, static_cast<uint32_t>(count)),
+        BPF_STMT(BPF_RET + BPF_A, 0)
+    };
+    return (program);
+}
+
+/// @brief Builds the filter accepting the DHCPv4 messages of a shard.
+///
+/// The filter is attached to each socket of a SO_REUSEPORT group. It
+/// runs with the UDP header at offset 0. It is required because the
+/// broadcast messages are delivered to all the sockets of the group.
+///
+/// @param shard Index of the shard.
+/// @param count Number of shards.
+/// @return The program.
+std::vector<struct sock_filter>
+shardFilterProgram(const size_t shard, const size_t count) {
+    std::vector<struct sock_filter> program = {
+        BPF_STMT(BPF_LD + BPF_W + BPF_ABS, UDP_HEADER_LEN + CHADDR_HASH_OFFSET),
+        BPF_STMT(BPF_ALU + BPF_MOD + BPF_K, static_cast<uint32_t>(count)),
+        BPF_JUMP(BPF_JMP + BPF_JEQ + BPF_K, static_cast<uint32_t>(shard), 0, 1),
+        BPF_STMT(BPF_RET + BPF_K, 0xffffffff),
+        BPF_STMT(BPF_RET + BPF_K, 0)
+    };
+    return (program);
+}
+
+/// @brief Attaches a program to a socket.
+///
+/// @param sock Socket descriptor.
+/// @param option SO_ATTACH_FILTER or SO_ATTACH_REUSEPORT_CBPF.
+/// @param program The program.
+/// @return The result of setsockopt().
+int
+attachProgram(int sock, int option, std::vector<struct sock_filter>& program) {
+    struct sock_fprog fprog;
+    memset(&fprog, 0, sizeof(fprog));
+    fprog.len = program.size();
+    fprog.filter = &program[0];
+    return (setsockopt(sock, SOL_SOCKET, option, &fprog, sizeof(fprog)));
+}
+
+#endif
+
+} // end of anonymous namespace
+
 namespace isc {
 namespace dhcp {
 
@@ -26,6 +103,59 @@ PktFilterInet::openSocket(Iface& iface,
                           const uint16_t port,
                           const bool receive_bcast,
                           const bool send_bcast) {
+    return (openSocketInternal(iface, addr, port, receive_bcast, send_bcast,
+                               0, 1));
+}
+
+std::vector<SocketInfo>
+PktFilterInet::openSocketShards(Iface& iface,
+                                const isc::asiolink::IOAddress& addr,
+                                const uint16_t port,
+                                const bool receive_bcast,
+                                const bool send_bcast,
+                                const size_t count) {
+#if defined (OS_LINUX) && defined (SO_ATTACH_REUSEPORT_CBPF)
+    if (count <= 1) {
+        return (PktFilter::openSocketShards(iface, addr, port, receive_bcast,
+                                            send_bcast, count));
+    }
+
+    std::vector<SocketInfo> sockets;
+    try {
+        for (size_t shard = 0; shard < count; ++shard) {
+            sockets.push_back(openSocketInternal(iface, addr, port,
+                                                 receive_bcast, send_bcast,
+                                                 shard, count));
+        }
+        // The steering program applies to the whole group.
+        std::vector<struct sock_filter> program = steeringProgram(count);
+        if (attachProgram(sockets[0].sockfd_, SO_ATTACH_REUSEPORT_CBPF,
+                          program) < 0) {
+            isc_throw(SocketConfigError, "Failed to attach the steering"
+                      " program to socket " << sockets[0].sockfd_
+                      << ": " << strerror(errno));
+        }
+    } catch (...) {
+        for (auto const& s : sockets) {
+            close(s.sockfd_);
+        }
+        throw;
+    }
+    return (sockets);
+#else
+    return (PktFilter::openSocketShards(iface, addr, port, receive_bcast,
+                                        send_bcast, count));
+#endif
+}
+
+SocketInfo
+PktFilterInet::openSocketInternal(Iface& iface,
+                                  const isc::asiolink::IOAddress& addr,
+                                  const uint16_t port,
+                                  const bool receive_bcast,
+                                  const bool send_bcast,
+                                  const size_t shard,
+                                  const size_t count) {
     struct sockaddr_in addr4;
     memset(&addr4, 0, sizeof(sockaddr));
     addr4.sin_family = AF_INET;
@@ -73,6 +203,28 @@ PktFilterInet::openSocket(Iface& iface,
         }
     }
 
+#if defined (OS_LINUX) && defined (SO_ATTACH_REUSEPORT_CBPF)
+    if (count > 1) {
+        // All the shards are bound to the same address and port.
+        int flag = 1;
+        if (setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &flag, sizeof(flag)) < 0) {
+            close(sock);
+            isc_throw(SocketConfigError, "Failed to set SO_REUSEPORT option"
+                      << " on socket " << sock);
+        }
+        // Only accept the broadcast messages of this shard.
+        std::vector<struct sock_filter> program = shardFilterProgram(shard, count);
+        if (attachProgram(sock, SO_ATTACH_FILTER, program) < 0) {
+            close(sock);
+            isc_throw(SocketConfigError, "Failed to attach the shard filter"
+                      << " to socket " << sock);
+        }
+    }
+#else
+    static_cast<void>(shard);
+    static_cast<void>(count);
+#endif
+
     if (bind(sock, (struct sockaddr *)&addr4, sizeof(addr4)) < 0) {
         close(sock);
         isc_throw(SocketConfigError, "Failed to bind socket " << sock
@@ -103,52 +255,32 @@ PktFilterInet::openSocket(Iface& iface,
 
 }
 
+namespace {
+
+/// @brief Creates a packet from the datagram received with recvmsg().
+///
+/// @param iface interface over which the datagram has been received.
+/// @param socket_info structure holding socket information.
+/// @param buf buffer holding the datagram.
+/// @param len length of the datagram.
+/// @param m message header filled by the system call. The @c msg_name
+/// must point to a @c sockaddr_in structure.
+///
+/// @return Created packet.
 Pkt4Ptr
-PktFilterInet::receive(Iface& iface, const SocketInfo& socket_info) {
-    struct sockaddr_in from_addr;
-    uint8_t buf[IfaceMgr::RCVBUFSIZE];
-    uint8_t control_buf[CONTROL_BUF_LEN];
-
-    memset(&control_buf[0], 0, CONTROL_BUF_LEN);
-    memset(&from_addr, 0, sizeof(from_addr));
-
-    // Initialize our message header structure.
-    struct msghdr m;
-    memset(&m, 0, sizeof(m));
-
-    // Point so we can get the from address.
-    m.msg_name = &from_addr;
-    m.msg_namelen = sizeof(from_addr);
-
-    struct iovec v;
-    v.iov_base = static_cast<void*>(buf);
-    v.iov_len = IfaceMgr::RCVBUFSIZE;
-    m.msg_iov = &v;
-    m.msg_iovlen = 1;
-
-    // Getting the interface is a bit more involved.
-    //
-    // We set up some space for a "control message". We have
-    // previously asked the kernel to give us packet
-    // information (when we initialized the interface), so we
-    // should get the destination address from that.
-    m.msg_control = &control_buf[0];
-    m.msg_controllen = CONTROL_BUF_LEN;
-
-    int result = recvmsg(socket_info.sockfd_, &m, 0);
-    if (result < 0) {
-        isc_throw(SocketReadError, "failed to receive UDP4 data");
-    }
-
+createPacket(Iface& iface, const SocketInfo& socket_info, const uint8_t* buf,
+             const size_t len, struct msghdr& m) {
     // We have all data let's create Pkt4 object.
-    Pkt4Ptr pkt = Pkt4Ptr(new Pkt4(buf, result));
+    Pkt4Ptr pkt = Pkt4Ptr(new Pkt4(buf, len));
 
     pkt->updateTimestamp();
 
     unsigned int ifindex = iface.getIndex();
 
-    IOAddress from(htonl(from_addr.sin_addr.s_addr));
-    uint16_t from_port = htons(from_addr.sin_port);
+    const struct sockaddr_in* from_addr =
+        static_cast<const struct sockaddr_in*>(m.msg_name);
+    IOAddress from(htonl(from_addr->sin_addr.s_addr));
+    uint16_t from_port = htons(from_addr->sin_port);
 
     // Set receiving interface based on information, which socket was used to
     // receive data. OS-specific info (see os_receive4()) may be more reliable,
@@ -205,19 +337,26 @@ PktFilterInet::receive(Iface& iface, const SocketInfo& socket_info) {
     return (pkt);
 }
 
-int
-PktFilterInet::send(const Iface&, uint16_t sockfd, const Pkt4Ptr& pkt) {
-    uint8_t control_buf[CONTROL_BUF_LEN];
-    memset(&control_buf[0], 0, CONTROL_BUF_LEN);
+/// @brief Initializes the message header used to send a packet.
+///
+/// @param pkt packet to be sent.
+/// @param m message header to be initialized.
+/// @param to structure to be filled with the destination address.
+/// @param v structure to be filled with the location of the packet data.
+/// @param control_buf buffer for the control message.
+/// @param control_buf_len length of the control message buffer.
+void
+initSendMessage(const Pkt4Ptr& pkt, struct msghdr& m, sockaddr_in& to,
+                struct iovec& v, uint8_t* control_buf,
+                const size_t control_buf_len) {
+    memset(control_buf, 0, control_buf_len);
 
     // Set the target address we're sending to.
-    sockaddr_in to;
     memset(&to, 0, sizeof(to));
     to.sin_family = AF_INET;
     to.sin_port = htons(pkt->getRemotePort());
     to.sin_addr.s_addr = htonl(pkt->getRemoteAddr().toUint32());
 
-    struct msghdr m;
     // Initialize our message header structure.
     memset(&m, 0, sizeof(m));
     m.msg_name = &to;
@@ -226,7 +365,6 @@ PktFilterInet::send(const Iface&, uint16_t sockfd, const Pkt4Ptr& pkt) {
     // Set the data buffer we're sending. (Using this wacky
     // "scatter-gather" stuff... we only have a single chunk
     // of data to send, so we declare a single vector entry.)
-    struct iovec v;
     memset(&v, 0, sizeof(v));
     // iov_base field is of void * type. We use it for packet
     // transmission, so this buffer will not be modified.
@@ -244,8 +382,8 @@ PktFilterInet::send(const Iface&, uint16_t sockfd, const Pkt4Ptr& pkt) {
     // We have to create a "control message", and set that to
     // define the IPv4 packet information. We set the source address
     // to handle correctly interfaces with multiple addresses.
-    m.msg_control = &control_buf[0];
-    m.msg_controllen = CONTROL_BUF_LEN;
+    m.msg_control = control_buf;
+    m.msg_controllen = control_buf_len;
     struct cmsghdr* cmsg = CMSG_FIRSTHDR(&m);
     cmsg->cmsg_level = IPPROTO_IP;
     cmsg->cmsg_type = IP_PKTINFO;
@@ -269,6 +407,159 @@ PktFilterInet::send(const Iface&, uint16_t sockfd, const Pkt4Ptr& pkt) {
 
     m.msg_controllen = CMSG_SPACE(sizeof(struct in_pktinfo));
 #endif
+}
+
+} // end of anonymous namespace
+
+Pkt4Ptr
+PktFilterInet::receive(Iface& iface, const SocketInfo& socket_info) {
+    struct sockaddr_in from_addr;
+    uint8_t buf[IfaceMgr::RCVBUFSIZE];
+    uint8_t control_buf[CONTROL_BUF_LEN];
+
+    memset(&control_buf[0], 0, CONTROL_BUF_LEN);
+    memset(&from_addr, 0, sizeof(from_addr));
+
+    // Initialize our message header structure.
+    struct msghdr m;
+    memset(&m, 0, sizeof(m));
+
+    // Point so we can get the from address.
+    m.msg_name = &from_addr;
+    m.msg_namelen = sizeof(from_addr);
+
+    struct iovec v;
+    v.iov_base = static_cast<void*>(buf);
+    v.iov_len = IfaceMgr::RCVBUFSIZE;
+    m.msg_iov = &v;
+    m.msg_iovlen = 1;
+
+    // Getting the interface is a bit more involved.
+    //
+    // We set up some space for a "control message". We have
+    // previously asked the kernel to give us packet
+    // information (when we initialized the interface), so we
+    // should get the destination address from that.
+    m.msg_control = &control_buf[0];
+    m.msg_controllen = CONTROL_BUF_LEN;
+
+    int result = recvmsg(socket_info.sockfd_, &m, 0);
+    if (result < 0) {
+        isc_throw(SocketReadError, "failed to receive UDP4 data");
+    }
+
+    return (createPacket(iface, socket_info, buf, result, m));
+}
+
+#if defined (OS_LINUX)
+
+struct PktFilterInet::ReceiveBatch {
+    /// @brief Constructor.
+    ///
+    /// Allocates the buffers and points the message headers to them.
+    /// The buffers are not initialized as they are written by the kernel.
+    ///
+    /// @param max_count maximum number of packets to be received.
+    ReceiveBatch(const size_t max_count)
+        : max_count_(max_count),
+          bufs_(new uint8_t[max_count * IfaceMgr::RCVBUFSIZE]),
+          control_bufs_(new uint8_t[max_count * CONTROL_BUF_LEN]),
+          from_addrs_(max_count), iovs_(max_count), msgs_(max_count) {
+        for (size_t i = 0; i < max_count; ++i) {
+            iovs_[i].iov_base = static_cast<void*>(&bufs_[i * IfaceMgr::RCVBUFSIZE]);
+            iovs_[i].iov_len = IfaceMgr::RCVBUFSIZE;
+            struct msghdr& m = msgs_[i].msg_hdr;
+            memset(&m, 0, sizeof(m));
+            m.msg_name = &from_addrs_[i];
+            m.msg_iov = &iovs_[i];
+            m.msg_iovlen = 1;
+            m.msg_control = &control_bufs_[i * CONTROL_BUF_LEN];
+        }
+    }
+
+    /// @brief Maximum number of packets to be received.
+    size_t max_count_;
+
+    /// @brief The data buffers, one slot per datagram.
+    boost::scoped_array<uint8_t> bufs_;
+
+    /// @brief The control buffers, one slot per datagram.
+    boost::scoped_array<uint8_t> control_bufs_;
+
+    /// @brief The source addresses.
+    std::vector<struct sockaddr_in> from_addrs_;
+
+    /// @brief The data buffer descriptors.
+    std::vector<struct iovec> iovs_;
+
+    /// @brief The message headers.
+    std::vector<struct mmsghdr> msgs_;
+};
+
+PktFilterInet::ReceiveBatchPtr
+PktFilterInet::getReceiveBatch(const int sockfd, const size_t max_count) {
+    std::lock_guard<std::mutex> lock(receive_batches_mutex_);
+    ReceiveBatchPtr& batch = receive_batches_[sockfd];
+    if (!batch || (batch->max_count_ != max_count)) {
+        batch.reset(new ReceiveBatch(max_count));
+    }
+    return (batch);
+}
+
+#endif
+
+Pkt4Collection
+PktFilterInet::receiveBatch(Iface& iface, const SocketInfo& socket_info,
+                            const size_t max_count) {
+#if defined (OS_LINUX)
+    if (max_count <= 1) {
+        return (PktFilter::receiveBatch(iface, socket_info, max_count));
+    }
+
+    ReceiveBatchPtr batch = getReceiveBatch(socket_info.sockfd_, max_count);
+    std::vector<struct mmsghdr>& msgs = batch->msgs_;
+
+    // The system call overwrites the lengths of the address and control
+    // buffers, so they are reset before each call.
+    for (size_t i = 0; i < max_count; ++i) {
+        msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+        msgs[i].msg_hdr.msg_controllen = CONTROL_BUF_LEN;
+    }
+
+    // The caller has checked that there is data on the socket, so the
+    // non-blocking call returns at least one datagram in most cases. It
+    // returns whatever is already queued, up to max_count, without waiting
+    // for the remaining slots to be filled.
+    int result = recvmmsg(socket_info.sockfd_, &msgs[0], max_count,
+                          MSG_DONTWAIT, 0);
+    if (result < 0) {
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+            return (Pkt4Collection());
+        }
+        isc_throw(SocketReadError, "failed to receive UDP4 data: "
+                  << strerror(errno));
+    }
+
+    Pkt4Collection pkts;
+    pkts.reserve(result);
+    for (int i = 0; i < result; ++i) {
+        pkts.push_back(createPacket(iface, socket_info,
+                                    &batch->bufs_[i * IfaceMgr::RCVBUFSIZE],
+                                    msgs[i].msg_len, msgs[i].msg_hdr));
+    }
+    return (pkts);
+#else
+    return (PktFilter::receiveBatch(iface, socket_info, max_count));
+#endif
+}
+
+int
+PktFilterInet::send(const Iface&, uint16_t sockfd, const Pkt4Ptr& pkt) {
+    uint8_t control_buf[CONTROL_BUF_LEN];
+    sockaddr_in to;
+    struct iovec v;
+    struct msghdr m;
+    initSendMessage(pkt, m, to, v, control_buf, CONTROL_BUF_LEN);
 
     pkt->updateTimestamp();
 
@@ -9,6 +9,9 @@
 
 #include <dhcp/pkt_filter.h>
 #include <boost/scoped_array.hpp>
+#include <boost/shared_ptr.hpp>
+#include <map>
+#include <mutex>
 
 namespace isc {
 namespace dhcp {
@@ -48,6 +51,33 @@ public:
                                   const bool receive_bcast,
                                   const bool send_bcast);
 
+    /// @brief Open a set of sockets sharing the traffic of an address.
+    ///
+    /// On Linux the sockets are bound with the SO_REUSEPORT option and a
+    /// program attached with SO_ATTACH_REUSEPORT_CBPF selects the socket
+    /// of a unicast packet by hashing the last four bytes of the client
+    /// hardware address (chaddr). The same hash is used by a filter
+    /// attached to each socket to drop the broadcast packets, which are
+    /// delivered to all sockets, of the other shards. On other systems a
+    /// single socket is opened.
+    ///
+    /// @param iface Interface descriptor.
+    /// @param addr Address on the interface to be used to send packets.
+    /// @param port Port number.
+    /// @param receive_bcast Configure sockets to receive broadcast messages
+    /// @param send_bcast Configure sockets to send broadcast messages.
+    /// @param count Requested number of shards.
+    ///
+    /// @return Structures describing the sockets, ordered by shard.
+    /// @throw isc::dhcp::SocketConfigError if error occurs when opening,
+    /// binding or configuring one of the sockets.
+    virtual std::vector<SocketInfo> openSocketShards(Iface& iface,
+                                                     const isc::asiolink::IOAddress& addr,
+                                                     const uint16_t port,
+                                                     const bool receive_bcast,
+                                                     const bool send_bcast,
+                                                     const size_t count);
+
     /// @brief Receive packet over specified socket.
     ///
     /// @param iface interface
@@ -60,6 +90,25 @@ public:
     /// message parsing fails.
     virtual Pkt4Ptr receive(Iface& iface, const SocketInfo& socket_info);
 
+    /// @brief Receive multiple packets over specified socket.
+    ///
+    /// On Linux this function uses recvmmsg() to receive up to @c max_count
+    /// datagrams already queued on the socket with a single system call.
+    /// It doesn't block waiting for more datagrams. On other systems, or
+    /// when @c max_count is lower than 2, it falls back to @c receive.
+    ///
+    /// @param iface interface
+    /// @param socket_info structure holding socket information
+    /// @param max_count maximum number of packets to be received.
+    ///
+    /// @return Collection of received packets. It may be empty if the
+    /// socket had no data.
+    /// @throw isc::dhcp::SocketReadError if an error occurs during reception
+    /// of the packets.
+    virtual Pkt4Collection receiveBatch(Iface& iface,
+                                        const SocketInfo& socket_info,
+                                        const size_t max_count);
+
     /// @brief Send packet over specified socket.
     ///
     /// This function will use local address specified in the @c pkt as a source
@@ -79,8 +128,52 @@ public:
     virtual int send(const Iface& iface, uint16_t sockfd, const Pkt4Ptr& pkt);
 
 private:
+    /// @brief Opens a socket, possibly as a shard of a set of sockets.
+    ///
+    /// @param iface Interface descriptor.
+    /// @param addr Address on the interface to be used to send packets.
+    /// @param port Port number.
+    /// @param receive_bcast Configure socket to receive broadcast messages
+    /// @param send_bcast Configure socket to send broadcast messages.
+    /// @param shard Index of the shard.
+    /// @param count Number of shards, 1 when the socket is not sharded.
+    ///
+    /// @return A structure describing the socket.
+    SocketInfo openSocketInternal(Iface& iface,
+                                  const isc::asiolink::IOAddress& addr,
+                                  const uint16_t port,
+                                  const bool receive_bcast,
+                                  const bool send_bcast,
+                                  const size_t shard,
+                                  const size_t count);
+
     /// Length of the socket control buffer.
     static const size_t CONTROL_BUF_LEN;
+
+    /// @brief Buffers and message headers used by @c receiveBatch.
+    struct ReceiveBatch;
+
+    /// @brief Pointer to the buffers used by @c receiveBatch.
+    typedef boost::shared_ptr<ReceiveBatch> ReceiveBatchPtr;
+
+    /// @brief Returns the receive buffers of a socket.
+    ///
+    /// The buffers are allocated by the first call for the socket, or when
+    /// the batch size was changed, and are reused by the following calls.
+    /// Each socket is read by a single thread, so the buffers of a socket
+    /// are not used concurrently.
+    ///
+    /// @param sockfd socket descriptor.
+    /// @param max_count maximum number of packets to be received.
+    ///
+    /// @return the buffers of the socket.
+    ReceiveBatchPtr getReceiveBatch(const int sockfd, const size_t max_count);
+
+    /// @brief Receive buffers by socket descriptor.
+    std::map<int, ReceiveBatchPtr> receive_batches_;
+
+    /// @brief Mutex protecting the receive buffers map.
+    std::mutex receive_batches_mutex_;
 };
 
 } // namespace isc::dhcp
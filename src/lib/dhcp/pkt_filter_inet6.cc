@@ -12,11 +12,112 @@
 #include <exceptions/isc_assert.h>
 #include <util/io/pktinfo_utilities.h>
 
+#include <boost/scoped_array.hpp>
+
 #include <fcntl.h>
 #include <netinet/in.h>
+#include <vector>
+
+#if defined (OS_LINUX)
+#include <linux/filter.h>
+#endif
 
 using namespace isc::asiolink;
 
+namespace {
+
+#if defined (OS_LINUX) && defined (SO_ATTACH_REUSEPORT_CBPF)
+
+/// @brief Offset of the last four bytes of the peer address in a
+/// Relay-forward message.
+///
+/// The peer-address field follows the message type, the hop count and
+/// the 16 bytes long link-address.
+const uint32_t PEER_ADDR_HASH_OFFSET = 30;
+
+/// @brief Offset of the last four bytes of the source address in the
+/// IPv6 header, relative to the network header.
+const uint32_t SRC_ADDR_HASH_OFFSET = SKF_NET_OFF + 20;
+
+/// @brief Length of the UDP header.
+const uint32_t UDP_HEADER_LEN = 8;
+
+/// @brief Builds the program computing the shard of a DHCPv6 message.
+///
+/// The hash is the peer address of the Relay-forward messages, so the
+/// messages relayed for a client go to the same shard, and the source
+/// address of the other messages.
+///
+/// @param offset Offset of the DHCPv6 message in the packet seen by the
+/// program.
+/// @param count Number of shards.
+/// @return The program, which leaves the shard index in the accumulator.
+std::vector<struct sock_filter>
+hashProgram(const uint32_t offset, const size_t count) {
+    std::vector<struct sock_filter> program = {
+        BPF_STMT(BPF_LD + BPF_B + BPF_ABS, offset),
+        BPF_JUMP(BPF_JMP + BPF_JEQ + BPF_K, DHCPV6_RELAY_FORW, 0, 2),
+        BPF_STMT(BPF_LD + BPF_W + BPF_ABS, offset + PEER_ADDR_HASH_OFFSET),
+        BPF_STMT(BPF_JMP + BPF_JA, 1),
+        BPF_STMT(BPF_LD + BPF_W + BPF_ABS, SRC_ADDR_HASH_OFFSET),
+        BPF_STMT(BPF_ALU + BPF_MOD + BPF_K, static_cast<uint32_t>(count))
+    };
+    return (program);
+}
+
+/// @brief Builds the program selecting the shard of a DHCPv6 message.
+///
+/// The program is attached to a SO_REUSEPORT group. It runs with the
+/// DHCPv6 message at offset 0 and returns the index of the socket in
+/// the group.
+///
+/// @param count Number of shards.
+/// @return The program.
+std::vector<struct sock_filter>
+steeringProgram(const size_t count) {
+    std::vector<struct sock_filter> program = hashProgram(0, count);
+    program.push_back(BPF_STMT(BPF_RET + BPF_A, 0));
+    return (program);
+}
+
+/// @brief Builds the filter accepting the DHCPv6 messages of a shard.
+///
+/// The filter is attached to each socket of a SO_REUSEPORT group. It
+/// runs with the UDP header at offset 0. It is required because the
+/// multicast messages are delivered to all the sockets of the group.
+///
+/// @param shard Index of the shard.
+/// @param count Number of shards.
+/// @return The program.
+std::vector<struct sock_filter>
+shardFilterProgram(const size_t shard, const size_t count) {
+    std::vector<struct sock_filter> program = hashProgram(UDP_HEADER_LEN, count);
+    program.push_back(BPF_JUMP(BPF_JMP + BPF_JEQ + BPF_K,
+                               static_cast<uint32_t>(shard), 0, 1));
+    program.push_back(BPF_STMT(BPF_RET + BPF_K, 0xffffffff));
+    program.push_back(BPF_STMT(BPF_RET + BPF_K, 0));
+    return (program);
+}
+
+/// @brief Attaches a program to a socket.
+///
+/// @param sock Socket descriptor.
+/// @param option SO_ATTACH_FILTER or SO_ATTACH_REUSEPORT_CBPF.
+/// @param program The program.
+/// @return The result of setsockopt().
+int
+attachProgram(int sock, int option, std::vector<struct sock_filter>& program) {
+    struct sock_fprog fprog;
+    memset(&fprog, 0, sizeof(fprog));
+    fprog.len = program.size();
+    fprog.filter = &program[0];
+    return (setsockopt(sock, SOL_SOCKET, option, &fprog, sizeof(fprog)));
+}
+
+#endif
+
+} // end of anonymous namespace
+
 namespace isc {
 namespace dhcp {
 
@@ -28,6 +129,55 @@ PktFilterInet6::openSocket(const Iface& iface,
                            const isc::asiolink::IOAddress& addr,
                            const uint16_t port,
                            const bool join_multicast) {
+    return (openSocketInternal(iface, addr, port, join_multicast, 0, 1));
+}
+
+std::vector<SocketInfo>
+PktFilterInet6::openSocketShards(const Iface& iface,
+                                 const isc::asiolink::IOAddress& addr,
+                                 const uint16_t port,
+                                 const bool join_multicast,
+                                 const size_t count) {
+#if defined (OS_LINUX) && defined (SO_ATTACH_REUSEPORT_CBPF)
+    if (count <= 1) {
+        return (PktFilter6::openSocketShards(iface, addr, port, join_multicast,
+                                             count));
+    }
+
+    std::vector<SocketInfo> sockets;
+    try {
+        for (size_t shard = 0; shard < count; ++shard) {
+            sockets.push_back(openSocketInternal(iface, addr, port,
+                                                 join_multicast, shard, count));
+        }
+        // The steering program applies to the whole group.
+        std::vector<struct sock_filter> program = steeringProgram(count);
+        if (attachProgram(sockets[0].sockfd_, SO_ATTACH_REUSEPORT_CBPF,
+                          program) < 0) {
+            isc_throw(SocketConfigError, "Failed to attach the steering"
+                      " program to IPv6 socket " << sockets[0].sockfd_
+                      << ": " << strerror(errno));
+        }
+    } catch (...) {
+        for (auto const& s : sockets) {
+            close(s.sockfd_);
+        }
+        throw;
+    }
+    return (sockets);
+#else
+    return (PktFilter6::openSocketShards(iface, addr, port, join_multicast,
+                                         count));
+#endif
+}
+
+SocketInfo
+PktFilterInet6::openSocketInternal(const Iface& iface,
+                                   const isc::asiolink::IOAddress& addr,
+                                   const uint16_t port,
+                                   const bool join_multicast,
+                                   const size_t shard,
+                                   const size_t count) {
     struct sockaddr_in6 addr6;
     memset(&addr6, 0, sizeof(addr6));
     addr6.sin6_family = AF_INET6;
@@ -101,6 +251,22 @@ PktFilterInet6::openSocket(const Iface& iface,
     }
 #endif
 
+#if defined (OS_LINUX) && defined (SO_ATTACH_REUSEPORT_CBPF)
+    if (count > 1) {
+        // Only accept the multicast messages of this shard. The
+        // SO_REUSEPORT option has been set above.
+        std::vector<struct sock_filter> program = shardFilterProgram(shard, count);
+        if (attachProgram(sock, SO_ATTACH_FILTER, program) < 0) {
+            close(sock);
+            isc_throw(SocketConfigError, "Failed to attach the shard filter"
+                      " to IPv6 socket.");
+        }
+    }
+#else
+    static_cast<void>(shard);
+    static_cast<void>(count);
+#endif
+
     if (bind(sock, (struct sockaddr *)&addr6, sizeof(addr6)) < 0) {
         // Get the error message immediately after the bind because the
         // invocation to close() below would override the errno.
@@ -141,76 +307,48 @@ PktFilterInet6::openSocket(const Iface& iface,
     return (SocketInfo(addr, port, sock));
 }
 
+namespace {
+
+/// @brief Creates a packet from the datagram received with recvmsg().
+///
+/// @param socket_info A structure holding socket information.
+/// @param buf A buffer holding the datagram.
+/// @param len A length of the datagram.
+/// @param m A message header filled by the system call. The @c msg_name
+/// must point to a @c sockaddr_in6 structure.
+///
+/// @return Created packet or null if the packet should be dropped.
+/// @throw isc::dhcp::SocketReadError if the packet can't be created.
 Pkt6Ptr
-PktFilterInet6::receive(const SocketInfo& socket_info) {
-    // Now we have a socket, let's get some data from it!
-    uint8_t buf[IfaceMgr::RCVBUFSIZE];
-    uint8_t control_buf[CONTROL_BUF_LEN];
-    memset(&control_buf[0], 0, CONTROL_BUF_LEN);
-    struct sockaddr_in6 from;
-    memset(&from, 0, sizeof(from));
-
-    // Initialize our message header structure.
-    struct msghdr m;
-    memset(&m, 0, sizeof(m));
-
-    // Point so we can get the from address.
-    m.msg_name = &from;
-    m.msg_namelen = sizeof(from);
-
-    // Set the data buffer we're receiving. (Using this wacky
-    // "scatter-gather" stuff... but we that doesn't really make
-    // sense for us, so we use a single vector entry.)
-    struct iovec v;
-    memset(&v, 0, sizeof(v));
-    v.iov_base = static_cast<void*>(buf);
-    v.iov_len = IfaceMgr::RCVBUFSIZE;
-    m.msg_iov = &v;
-    m.msg_iovlen = 1;
-
-    // Getting the interface is a bit more involved.
-    //
-    // We set up some space for a "control message". We have
-    // previously asked the kernel to give us packet
-    // information (when we initialized the interface), so we
-    // should get the destination address from that.
-    m.msg_control = &control_buf[0];
-    m.msg_controllen = CONTROL_BUF_LEN;
-
-    int result = recvmsg(socket_info.sockfd_, &m, 0);
-
+createPacket(const SocketInfo& socket_info, const uint8_t* buf,
+             const size_t len, struct msghdr& m) {
     struct in6_addr to_addr;
     memset(&to_addr, 0, sizeof(to_addr));
 
     int ifindex = -1;
-    if (result >= 0) {
-        struct in6_pktinfo* pktinfo = NULL;
-
-
-        // If we did read successfully, then we need to loop
-        // through the control messages we received and
-        // find the one with our destination address.
-        //
-        // We also keep a flag to see if we found it. If we
-        // didn't, then we consider this to be an error.
-        bool found_pktinfo = false;
-        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&m);
-        while (cmsg != NULL) {
-            if ((cmsg->cmsg_level == IPPROTO_IPV6) &&
-                (cmsg->cmsg_type == IPV6_PKTINFO)) {
-                pktinfo = util::io::internal::convertPktInfo6(CMSG_DATA(cmsg));
-                to_addr = pktinfo->ipi6_addr;
-                ifindex = pktinfo->ipi6_ifindex;
-                found_pktinfo = true;
-                break;
-            }
-            cmsg = CMSG_NXTHDR(&m, cmsg);
-        }
-        if (!found_pktinfo) {
-            isc_throw(SocketReadError, "unable to find pktinfo");
+    struct in6_pktinfo* pktinfo = NULL;
+
+    // If we did read successfully, then we need to loop
+    // through the control messages we received and
+    // find the one with our destination address.
+    //
+    // We also keep a flag to see if we found it. If we
+    // didn't, then we consider this to be an error.
+    bool found_pktinfo = false;
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&m);
+    while (cmsg != NULL) {
+        if ((cmsg->cmsg_level == IPPROTO_IPV6) &&
+            (cmsg->cmsg_type == IPV6_PKTINFO)) {
+            pktinfo = util::io::internal::convertPktInfo6(CMSG_DATA(cmsg));
+            to_addr = pktinfo->ipi6_addr;
+            ifindex = pktinfo->ipi6_ifindex;
+            found_pktinfo = true;
+            break;
         }
-    } else {
-        isc_throw(SocketReadError, "failed to receive data");
+        cmsg = CMSG_NXTHDR(&m, cmsg);
+    }
+    if (!found_pktinfo) {
+        isc_throw(SocketReadError, "unable to find pktinfo");
     }
 
     // Filter out packets sent to global unicast address (not link local and
@@ -227,18 +365,19 @@ PktFilterInet6::receive(const SocketInfo& socket_info) {
     // Let's create a packet.
     Pkt6Ptr pkt;
     try {
-        pkt = Pkt6Ptr(new Pkt6(buf, result));
+        pkt = Pkt6Ptr(new Pkt6(buf, len));
     } catch (const std::exception& ex) {
         isc_throw(SocketReadError, "failed to create new packet");
     }
 
     pkt->updateTimestamp();
 
-    pkt->setLocalAddr(IOAddress::fromBytes(AF_INET6,
-                      reinterpret_cast<const uint8_t*>(&to_addr)));
+    const struct sockaddr_in6* from =
+        static_cast<const struct sockaddr_in6*>(m.msg_name);
+    pkt->setLocalAddr(local_addr);
     pkt->setRemoteAddr(IOAddress::fromBytes(AF_INET6,
-                       reinterpret_cast<const uint8_t*>(&from.sin6_addr)));
-    pkt->setRemotePort(ntohs(from.sin6_port));
+                       reinterpret_cast<const uint8_t*>(&from->sin6_addr)));
+    pkt->setRemotePort(ntohs(from->sin6_port));
     pkt->setIndex(ifindex);
 
     IfacePtr received = IfaceMgr::instance().getIface(pkt->getIndex());
@@ -250,16 +389,23 @@ PktFilterInet6::receive(const SocketInfo& socket_info) {
     }
 
     return (pkt);
-
 }
 
-int
-PktFilterInet6::send(const Iface&, uint16_t sockfd, const Pkt6Ptr& pkt) {
-    uint8_t control_buf[CONTROL_BUF_LEN];
-    memset(&control_buf[0], 0, CONTROL_BUF_LEN);
+/// @brief Initializes the message header used to send a packet.
+///
+/// @param pkt A packet to be sent.
+/// @param m A message header to be initialized.
+/// @param to A structure to be filled with the destination address.
+/// @param v A structure to be filled with the location of the packet data.
+/// @param control_buf A buffer for the control message.
+/// @param control_buf_len A length of the control message buffer.
+void
+initSendMessage(const Pkt6Ptr& pkt, struct msghdr& m, sockaddr_in6& to,
+                struct iovec& v, uint8_t* control_buf,
+                const size_t control_buf_len) {
+    memset(control_buf, 0, control_buf_len);
 
     // Set the target address we're sending to.
-    sockaddr_in6 to;
     memset(&to, 0, sizeof(to));
     to.sin6_family = AF_INET6;
     to.sin6_port = htons(pkt->getRemotePort());
@@ -269,7 +415,6 @@ PktFilterInet6::send(const Iface&, uint16_t sockfd, const Pkt6Ptr& pkt) {
     to.sin6_scope_id = pkt->getIndex();
 
     // Initialize our message header structure.
-    struct msghdr m;
     memset(&m, 0, sizeof(m));
     m.msg_name = &to;
     m.msg_namelen = sizeof(to);
@@ -285,7 +430,6 @@ PktFilterInet6::send(const Iface&, uint16_t sockfd, const Pkt6Ptr& pkt) {
     // (defined as void*) we must use const cast from void *.
     // Otherwise C++ compiler would complain that we are trying
     // to assign const void* to void*.
-    struct iovec v;
     memset(&v, 0, sizeof(v));
     v.iov_base = const_cast<void *>(pkt->getBuffer().getData());
     v.iov_len = pkt->getBuffer().getLength();
@@ -298,8 +442,8 @@ PktFilterInet6::send(const Iface&, uint16_t sockfd, const Pkt6Ptr& pkt) {
     // define the IPv6 packet information. We could set the
     // source address if we wanted, but we can safely let the
     // kernel decide what that should be.
-    m.msg_control = &control_buf[0];
-    m.msg_controllen = CONTROL_BUF_LEN;
+    m.msg_control = control_buf;
+    m.msg_controllen = control_buf_len;
     struct cmsghdr *cmsg = CMSG_FIRSTHDR(&m);
 
     // FIXME: Code below assumes that cmsg is not NULL, but
@@ -324,6 +468,163 @@ PktFilterInet6::send(const Iface&, uint16_t sockfd, const Pkt6Ptr& pkt) {
     // which causes sendmsg to return EINVAL if the CMSG_LEN is
     // used to set the msg_controllen value.
     m.msg_controllen = CMSG_SPACE(sizeof(struct in6_pktinfo));
+}
+
+} // end of anonymous namespace
+
+Pkt6Ptr
+PktFilterInet6::receive(const SocketInfo& socket_info) {
+    // Now we have a socket, let's get some data from it!
+    uint8_t buf[IfaceMgr::RCVBUFSIZE];
+    uint8_t control_buf[CONTROL_BUF_LEN];
+    memset(&control_buf[0], 0, CONTROL_BUF_LEN);
+    struct sockaddr_in6 from;
+    memset(&from, 0, sizeof(from));
+
+    // Initialize our message header structure.
+    struct msghdr m;
+    memset(&m, 0, sizeof(m));
+
+    // Point so we can get the from address.
+    m.msg_name = &from;
+    m.msg_namelen = sizeof(from);
+
+    // Set the data buffer we're receiving. (Using this wacky
+    // "scatter-gather" stuff... but we that doesn't really make
+    // sense for us, so we use a single vector entry.)
+    struct iovec v;
+    memset(&v, 0, sizeof(v));
+    v.iov_base = static_cast<void*>(buf);
+    v.iov_len = IfaceMgr::RCVBUFSIZE;
+    m.msg_iov = &v;
+    m.msg_iovlen = 1;
+
+    // Getting the interface is a bit more involved.
+    //
+    // We set up some space for a "control message". We have
+    // previously asked the kernel to give us packet
+    // information (when we initialized the interface), so we
+    // should get the destination address from that.
+    m.msg_control = &control_buf[0];
+    m.msg_controllen = CONTROL_BUF_LEN;
+
+    int result = recvmsg(socket_info.sockfd_, &m, 0);
+    if (result < 0) {
+        isc_throw(SocketReadError, "failed to receive data");
+    }
+
+    return (createPacket(socket_info, buf, result, m));
+}
+
+#if defined (OS_LINUX)
+
+struct PktFilterInet6::ReceiveBatch {
+    /// @brief Constructor.
+    ///
+    /// Allocates the buffers and points the message headers to them.
+    /// The buffers are not initialized as they are written by the kernel.
+    ///
+    /// @param max_count maximum number of packets to be received.
+    ReceiveBatch(const size_t max_count)
+        : max_count_(max_count),
+          bufs_(new uint8_t[max_count * IfaceMgr::RCVBUFSIZE]),
+          control_bufs_(new uint8_t[max_count * CONTROL_BUF_LEN]),
+          from_addrs_(max_count), iovs_(max_count), msgs_(max_count) {
+        for (size_t i = 0; i < max_count; ++i) {
+            iovs_[i].iov_base = static_cast<void*>(&bufs_[i * IfaceMgr::RCVBUFSIZE]);
+            iovs_[i].iov_len = IfaceMgr::RCVBUFSIZE;
+            struct msghdr& m = msgs_[i].msg_hdr;
+            memset(&m, 0, sizeof(m));
+            m.msg_name = &from_addrs_[i];
+            m.msg_iov = &iovs_[i];
+            m.msg_iovlen = 1;
+            m.msg_control = &control_bufs_[i * CONTROL_BUF_LEN];
+        }
+    }
+
+    /// @brief Maximum number of packets to be received.
+    size_t max_count_;
+
+    /// @brief The data buffers, one slot per datagram.
+    boost::scoped_array<uint8_t> bufs_;
+
+    /// @brief The control buffers, one slot per datagram.
+    boost::scoped_array<uint8_t> control_bufs_;
+
+    /// @brief The source addresses.
+    std::vector<struct sockaddr_in6> from_addrs_;
+
+    /// @brief The data buffer descriptors.
+    std::vector<struct iovec> iovs_;
+
+    /// @brief The message headers.
+    std::vector<struct mmsghdr> msgs_;
+};
+
+PktFilterInet6::ReceiveBatchPtr
+PktFilterInet6::getReceiveBatch(const int sockfd, const size_t max_count) {
+    std::lock_guard<std::mutex> lock(receive_batches_mutex_);
+    ReceiveBatchPtr& batch = receive_batches_[sockfd];
+    if (!batch || (batch->max_count_ != max_count)) {
+        batch.reset(new ReceiveBatch(max_count));
+    }
+    return (batch);
+}
+
+#endif
+
+Pkt6Collection
+PktFilterInet6::receiveBatch(const SocketInfo& socket_info,
+                             const size_t max_count) {
+#if defined (OS_LINUX)
+    if (max_count <= 1) {
+        return (PktFilter6::receiveBatch(socket_info, max_count));
+    }
+
+    ReceiveBatchPtr batch = getReceiveBatch(socket_info.sockfd_, max_count);
+    std::vector<struct mmsghdr>& msgs = batch->msgs_;
+
+    // The system call overwrites the lengths of the address and control
+    // buffers, so they are reset before each call.
+    for (size_t i = 0; i < max_count; ++i) {
+        msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in6);
+        msgs[i].msg_hdr.msg_controllen = CONTROL_BUF_LEN;
+    }
+
+    // Only fetch what is already queued on the socket.
+    int result = recvmmsg(socket_info.sockfd_, &msgs[0], max_count,
+                          MSG_DONTWAIT, 0);
+    if (result < 0) {
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+            return (Pkt6Collection());
+        }
+        isc_throw(SocketReadError, "failed to receive data: "
+                  << strerror(errno));
+    }
+
+    Pkt6Collection pkts;
+    pkts.reserve(result);
+    for (int i = 0; i < result; ++i) {
+        Pkt6Ptr pkt = createPacket(socket_info,
+                                   &batch->bufs_[i * IfaceMgr::RCVBUFSIZE],
+                                   msgs[i].msg_len, msgs[i].msg_hdr);
+        if (pkt) {
+            pkts.push_back(pkt);
+        }
+    }
+    return (pkts);
+#else
+    return (PktFilter6::receiveBatch(socket_info, max_count));
+#endif
+}
+
+int
+PktFilterInet6::send(const Iface&, uint16_t sockfd, const Pkt6Ptr& pkt) {
+    uint8_t control_buf[CONTROL_BUF_LEN];
+    sockaddr_in6 to;
+    struct iovec v;
+    struct msghdr m;
+    initSendMessage(pkt, m, to, v, control_buf, CONTROL_BUF_LEN);
 
     pkt->updateTimestamp();
 
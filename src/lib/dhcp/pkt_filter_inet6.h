@@ -9,6 +9,9 @@
 
 #include <dhcp/pkt_filter6.h>
 #include <boost/scoped_array.hpp>
+#include <boost/shared_ptr.hpp>
+#include <map>
+#include <mutex>
 
 namespace isc {
 namespace dhcp {
@@ -43,6 +46,34 @@ public:
                                   const uint16_t port,
                                   const bool join_multicast);
 
+    /// @brief Opens a set of sockets sharing the traffic of an address.
+    ///
+    /// On Linux the sockets are bound with the SO_REUSEPORT option and a
+    /// program attached with SO_ATTACH_REUSEPORT_CBPF selects the socket
+    /// of a unicast message by hashing the last four bytes of the peer
+    /// address of a Relay-forward message, or of the source address of
+    /// other messages. The same hash is used by a filter attached to each
+    /// socket to drop the multicast messages, which are delivered to all
+    /// sockets, of the other shards. On other systems a single socket is
+    /// opened.
+    ///
+    /// @param iface Interface descriptor.
+    /// @param addr Address on the interface to be used to send packets.
+    /// @param port Port number.
+    /// @param join_multicast A boolean parameter which indicates whether
+    /// sockets should join All_DHCP_Relay_Agents_and_servers multicast
+    /// group.
+    /// @param count Requested number of shards.
+    ///
+    /// @return Structures describing the sockets, ordered by shard.
+    /// @throw isc::dhcp::SocketConfigError if error occurred when opening
+    /// or configuring one of the sockets.
+    virtual std::vector<SocketInfo> openSocketShards(const Iface& iface,
+                                                     const isc::asiolink::IOAddress& addr,
+                                                     const uint16_t port,
+                                                     const bool join_multicast,
+                                                     const size_t count);
+
     /// @brief Receives DHCPv6 message on the interface.
     ///
     /// This function receives a single DHCPv6 message through a socket
@@ -62,6 +93,24 @@ public:
     /// reception.
     virtual Pkt6Ptr receive(const SocketInfo& socket_info);
 
+    /// @brief Receives multiple DHCPv6 messages on the interface.
+    ///
+    /// On Linux this function uses recvmmsg() to receive up to @c max_count
+    /// datagrams already queued on the socket with a single system call.
+    /// It doesn't block waiting for more datagrams. On other systems, or
+    /// when @c max_count is lower than 2, it falls back to @c receive.
+    /// Messages which @c receive would drop are not included in the
+    /// returned collection.
+    ///
+    /// @param socket_info A structure holding socket information.
+    /// @param max_count Maximum number of messages to be received.
+    ///
+    /// @return Collection of received messages. It may be empty.
+    /// @throw isc::dhcp::SocketReadError if error occurred during packet
+    /// reception.
+    virtual Pkt6Collection receiveBatch(const SocketInfo& socket_info,
+                                        const size_t max_count);
+
     /// @brief Sends DHCPv6 message through a specified interface and socket.
     ///
     /// The function sends a DHCPv6 message through a specified interface and
@@ -78,8 +127,52 @@ public:
     virtual int send(const Iface& iface, uint16_t sockfd, const Pkt6Ptr& pkt);
 
 private:
+    /// @brief Opens a socket, possibly as a shard of a set of sockets.
+    ///
+    /// @param iface Interface descriptor.
+    /// @param addr Address on the interface to be used to send packets.
+    /// @param port Port number.
+    /// @param join_multicast A boolean parameter which indicates whether
+    /// socket should join All_DHCP_Relay_Agents_and_servers multicast
+    /// group.
+    /// @param shard Index of the shard.
+    /// @param count Number of shards, 1 when the socket is not sharded.
+    ///
+    /// @return A structure describing the socket.
+    SocketInfo openSocketInternal(const Iface& iface,
+                                  const isc::asiolink::IOAddress& addr,
+                                  const uint16_t port,
+                                  const bool join_multicast,
+                                  const size_t shard,
+                                  const size_t count);
+
     /// Length of the socket control buffer.
     static const size_t CONTROL_BUF_LEN;
+
+    /// @brief Buffers and message headers used by @c receiveBatch.
+    struct ReceiveBatch;
+
+    /// @brief Pointer to the buffers used by @c receiveBatch.
+    typedef boost::shared_ptr<ReceiveBatch> ReceiveBatchPtr;
+
+    /// @brief Returns the receive buffers of a socket.
+    ///
+    /// The buffers are allocated by the first call for the socket, or when
+    /// the batch size was changed, and are reused by the following calls.
+    /// Each socket is read by a single thread, so the buffers of a socket
+    /// are not used concurrently.
+    ///
+    /// @param sockfd socket descriptor.
+    /// @param max_count maximum number of packets to be received.
+    ///
+    /// @return the buffers of the socket.
+    ReceiveBatchPtr getReceiveBatch(const int sockfd, const size_t max_count);
+
+    /// @brief Receive buffers by socket descriptor.
+    std::map<int, ReceiveBatchPtr> receive_batches_;
+
+    /// @brief Mutex protecting the receive buffers map.
+    std::mutex receive_batches_mutex_;
 };
 
 } // namespace isc::dhcp
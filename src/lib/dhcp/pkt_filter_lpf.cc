@@ -1,4 +1,4 @@
-// Copyright (C) 2013-2020 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2013-2021 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -16,6 +16,13 @@
 #include <linux/filter.h>
 #include <linux/if_ether.h>
 #include <linux/if_packet.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <boost/noncopyable.hpp>
+
+#include <atomic>
+#include <vector>
 
 namespace {
 
@@ -121,6 +128,206 @@ struct sock_filter dhcp_sock_filter [] = {
     BPF_STMT(BPF_RET + BPF_K, 0),
 };
 
+/// @brief Discards the data received on the fallback socket.
+///
+/// @param fallbackfd fallback socket descriptor.
+void
+drainFallbackSocket(int fallbackfd) {
+    // Only the first of sharded sockets has a fallback socket.
+    if (fallbackfd < 0) {
+        return;
+    }
+    uint8_t raw_buf[IfaceMgr::RCVBUFSIZE];
+    // The data will be discarded but we don't want the socket buffer to
+    // bloat. We get the packets from the socket in loop but most of the
+    // time the loop will end after receiving one packet. The call to recv
+    // returns immediately when there is no data left on the socket because
+    // the socket is non-blocking.
+    // @todo In the normal conditions, both the primary socket and the fallback
+    // socket are in sync as they are set to receive packets on the same
+    // address and port. The reception of packets on the fallback socket
+    // shouldn't cause significant lags in packet reception. If we find in the
+    // future that it does, the sort of threshold could be set for the maximum
+    // bytes received on the fallback socket in a single round. Further
+    // optimizations would include an asynchronous read from the fallback socket
+    // when the DHCP server is idle.
+    int datalen;
+    do {
+        datalen = recv(fallbackfd, raw_buf, sizeof(raw_buf), 0);
+    } while (datalen > 0);
+}
+
+/// @brief Closes a fallback socket if it is open.
+///
+/// @param fallbackfd fallback socket descriptor or -1.
+void
+closeFallbackSocket(int fallbackfd) {
+    if (fallbackfd >= 0) {
+        close(fallbackfd);
+    }
+}
+
+/// @brief Fanout program selecting the socket of a DHCPv4 frame.
+///
+/// The program returns the last four bytes of the client hardware address
+/// (chaddr), the kernel takes it modulo the number of sockets in the group.
+/// The offsets are relative to the network header so they don't depend on
+/// the link layer.
+///
+/// Non-IP frames hash to the first socket; they are dropped by the socket
+/// filter anyway.
+struct sock_filter dhcp_fanout_filter [] = {
+    // Load the IP header length in X.
+    BPF_STMT(BPF_LDX + BPF_B + BPF_MSH, static_cast<uint32_t>(SKF_NET_OFF)),
+    // Load the word at offset 30 of the DHCPv4 message which follows the
+    // 8 bytes long UDP header.
+    BPF_STMT(BPF_LD + BPF_W + BPF_IND, static_cast<uint32_t>(SKF_NET_OFF + 8 + 30)),
+    BPF_STMT(BPF_RET + BPF_A, 0)
+};
+
+/// @brief Makes the sockets of an interface join a fanout group.
+///
+/// The group identifier is allocated by the kernel when the first socket
+/// joins the group, if the kernel supports it.
+///
+/// @param sockets the sockets, which must be bound to the interface.
+/// @throw SocketConfigError if a socket can't join the group.
+void
+joinFanoutGroup(const std::vector<SocketInfo>& sockets) {
+    int fanout_arg = PACKET_FANOUT_CBPF << 16;
+#if defined (PACKET_FANOUT_FLAG_UNIQUEID)
+    fanout_arg |= PACKET_FANOUT_FLAG_UNIQUEID << 16;
+#else
+    // Use the process identifier and the first descriptor to avoid
+    // joining the group of another process.
+    fanout_arg |= (getpid() ^ (sockets[0].sockfd_ << 8)) & 0xffff;
+#endif
+    for (size_t shard = 0; shard < sockets.size(); ++shard) {
+        int sock = sockets[shard].sockfd_;
+        if (setsockopt(sock, SOL_PACKET, PACKET_FANOUT, &fanout_arg,
+                       sizeof(fanout_arg)) < 0) {
+            isc_throw(SocketConfigError, "Failed to add LPF socket '" << sock
+                      << "' to fanout group: " << strerror(errno));
+        }
+        if (shard > 0) {
+            continue;
+        }
+#if defined (PACKET_FANOUT_FLAG_UNIQUEID)
+        // Get the identifier allocated by the kernel for the next sockets.
+        int group = 0;
+        socklen_t len = sizeof(group);
+        if (getsockopt(sock, SOL_PACKET, PACKET_FANOUT, &group, &len) < 0) {
+            isc_throw(SocketConfigError, "Failed to get fanout group of LPF"
+                      " socket '" << sock << "': " << strerror(errno));
+        }
+        fanout_arg = (PACKET_FANOUT_CBPF << 16) | (group & 0xffff);
+#endif
+        // The program applies to the whole group.
+        struct sock_fprog fanout_program;
+        memset(&fanout_program, 0, sizeof(fanout_program));
+        fanout_program.filter = dhcp_fanout_filter;
+        fanout_program.len = sizeof(dhcp_fanout_filter) / sizeof(struct sock_filter);
+        if (setsockopt(sock, SOL_PACKET, PACKET_FANOUT_DATA, &fanout_program,
+                       sizeof(fanout_program)) < 0) {
+            isc_throw(SocketConfigError, "Failed to install fanout program"
+                      " on LPF socket '" << sock << "': " << strerror(errno));
+        }
+    }
+}
+
+/// @brief Creates a DHCPv4 packet from an Ethernet frame.
+///
+/// @param iface interface on which the frame was received.
+/// @param data pointer to the beginning of the frame.
+/// @param data_len length of the frame.
+///
+/// @return Pointer to the packet.
+Pkt4Ptr
+decodeFrame(Iface& iface, const uint8_t* data, const size_t data_len) {
+    isc::util::InputBuffer buf(data, data_len);
+
+    // @todo: This is awkward way to solve the chicken and egg problem
+    // whereby we don't know the offset where DHCP data start in the
+    // received buffer when we create the packet object. In general case,
+    // the IP header has variable length. The information about its length
+    // is stored in one of its fields. Therefore, we have to decode the
+    // packet to get the offset of the DHCP data. The dummy object is
+    // created so as we can pass it to the functions which decode IP stack
+    // and find actual offset of the DHCP data.
+    // Once we find the offset we can create another Pkt4 object from
+    // the reminder of the input buffer and set the IP addresses and
+    // ports from the dummy packet. We should consider doing it
+    // in some more elegant way.
+    Pkt4Ptr dummy_pkt = Pkt4Ptr(new Pkt4(DHCPDISCOVER, 0));
+
+    // Decode ethernet, ip and udp headers.
+    decodeEthernetHeader(buf, dummy_pkt);
+    decodeIpUdpHeader(buf, dummy_pkt);
+
+    // Decode DHCP data into the Pkt4 object. The data is read in place
+    // and copied only once by the Pkt4 constructor.
+    Pkt4Ptr pkt = Pkt4Ptr(new Pkt4(data + buf.getPosition(),
+                                   buf.getLength() - buf.getPosition()));
+
+    // Set the appropriate packet members using data collected from
+    // the decoded headers.
+    pkt->setIndex(iface.getIndex());
+    pkt->setIface(iface.getName());
+    pkt->setLocalAddr(dummy_pkt->getLocalAddr());
+    pkt->setRemoteAddr(dummy_pkt->getRemoteAddr());
+    pkt->setLocalPort(dummy_pkt->getLocalPort());
+    pkt->setRemotePort(dummy_pkt->getRemotePort());
+    pkt->setLocalHWAddr(dummy_pkt->getLocalHWAddr());
+    pkt->setRemoteHWAddr(dummy_pkt->getRemoteHWAddr());
+
+    return (pkt);
+}
+
+/// @brief Builds the Ethernet frame carrying a DHCPv4 packet.
+///
+/// @param iface interface to be used to send the packet.
+/// @param pkt packet to be sent.
+/// @param buf buffer receiving the frame.
+void
+writeFrame(const Iface& iface, const Pkt4Ptr& pkt,
+           isc::util::OutputBuffer& buf) {
+    // Some interfaces may have no HW address - e.g. loopback interface.
+    // For these interfaces the HW address length is 0. If this is the case,
+    // then we will rely on the functions which construct the IP/UDP headers
+    // to provide a default HW addres. Otherwise, create the HW address
+    // object using the HW address of the interface.
+    if (iface.getMacLen() > 0) {
+        HWAddrPtr hwaddr(new HWAddr(iface.getMac(), iface.getMacLen(),
+                                    iface.getHWType()));
+        pkt->setLocalHWAddr(hwaddr);
+    }
+
+
+    // Ethernet frame header.
+    // Note that we don't validate whether HW addresses in 'pkt'
+    // are valid because they are checked by the function called.
+    writeEthernetHeader(pkt, buf);
+
+    // IP and UDP header
+    writeIpUdpHeader(pkt, buf);
+
+    // DHCPv4 message
+    buf.writeData(pkt->getBuffer().getData(), pkt->getBuffer().getLength());
+}
+
+/// @brief Initializes the link layer address frames are sent to.
+///
+/// @param iface interface to be used to send the frames.
+/// @param [out] sa the address.
+void
+initSendAddress(const Iface& iface, sockaddr_ll& sa) {
+    memset(&sa, 0x0, sizeof(sa));
+    sa.sll_family = AF_PACKET;
+    sa.sll_ifindex = iface.getIndex();
+    sa.sll_protocol = htons(ETH_P_IP);
+    sa.sll_halen = 6;
+}
+
 }
 
 using namespace isc::util;
@@ -128,29 +335,241 @@ using namespace isc::util;
 namespace isc {
 namespace dhcp {
 
+/// The ring is made of @c PktFilterLPF::RING_BLOCK_NR blocks which are
+/// owned either by the kernel or by the process. The blocks are passed
+/// to the process in order, so the frames are read from the current
+/// block until it is exhausted and returned to the kernel, then from the
+/// next one.
+class PktFilterLPF::Ring : public boost::noncopyable {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// Switches the socket to TPACKET_V3, creates the receive ring and
+    /// maps it in memory.
+    ///
+    /// @param sockfd raw socket descriptor.
+    /// @throw SocketConfigError if the ring can't be set up.
+    explicit Ring(int sockfd)
+        : sockfd_(sockfd), dev_(0), ino_(0), map_(0),
+          map_len_(RING_BLOCK_SIZE * RING_BLOCK_NR), block_(0),
+          frame_(0), frames_left_(0) {
+        // The socket is identified by its inode to detect when the
+        // descriptor has been closed and reused.
+        struct stat st;
+        if (fstat(sockfd, &st) < 0) {
+            isc_throw(SocketConfigError, "failed to stat the LPF socket "
+                      << sockfd << ": " << strerror(errno));
+        }
+        dev_ = st.st_dev;
+        ino_ = st.st_ino;
+
+        int version = TPACKET_V3;
+        if (setsockopt(sockfd, SOL_PACKET, PACKET_VERSION, &version,
+                       sizeof(version)) < 0) {
+            isc_throw(SocketConfigError, "failed to set TPACKET_V3 on the"
+                      " LPF socket " << sockfd << ": " << strerror(errno));
+        }
+
+        struct tpacket_req3 req;
+        memset(&req, 0, sizeof(req));
+        req.tp_block_size = RING_BLOCK_SIZE;
+        req.tp_block_nr = RING_BLOCK_NR;
+        req.tp_frame_size = RING_FRAME_SIZE;
+        req.tp_frame_nr = (RING_BLOCK_SIZE / RING_FRAME_SIZE) * RING_BLOCK_NR;
+        req.tp_retire_blk_tov = RING_BLOCK_TIMEOUT;
+        if (setsockopt(sockfd, SOL_PACKET, PACKET_RX_RING, &req,
+                       sizeof(req)) < 0) {
+            isc_throw(SocketConfigError, "failed to create the receive ring"
+                      " of the LPF socket " << sockfd << ": "
+                      << strerror(errno));
+        }
+
+        void* map = mmap(0, map_len_, PROT_READ | PROT_WRITE, MAP_SHARED,
+                         sockfd, 0);
+        if (map == MAP_FAILED) {
+            isc_throw(SocketConfigError, "failed to map the receive ring"
+                      " of the LPF socket " << sockfd << ": "
+                      << strerror(errno));
+        }
+        map_ = static_cast<uint8_t*>(map);
+    }
+
+    /// @brief Destructor.
+    ///
+    /// Unmaps the ring. The mapping holds a reference to the socket so
+    /// the socket is released only at this point.
+    ~Ring() {
+        munmap(map_, map_len_);
+    }
+
+    /// @brief Checks if the socket descriptor still refers to the socket
+    /// of the ring.
+    bool isSocketOpen() const {
+        struct stat st;
+        return ((fstat(sockfd_, &st) == 0) && (st.st_dev == dev_) &&
+                (st.st_ino == ino_));
+    }
+
+    /// @brief Returns the current frame.
+    ///
+    /// @return Pointer to the frame header or null if the kernel has not
+    /// passed any frame to the process.
+    const struct tpacket3_hdr* current() {
+        while (!frame_) {
+            struct tpacket_block_desc* desc = getBlock();
+            if ((desc->hdr.bh1.block_status & TP_STATUS_USER) == 0) {
+                return (0);
+            }
+            // Don't read the block before the kernel is done with it.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            frames_left_ = desc->hdr.bh1.num_pkts;
+            if (frames_left_ == 0) {
+                releaseBlock();
+                continue;
+            }
+            frame_ = reinterpret_cast<struct tpacket3_hdr*>(
+                reinterpret_cast<uint8_t*>(desc) +
+                desc->hdr.bh1.offset_to_first_pkt);
+        }
+        return (frame_);
+    }
+
+    /// @brief Moves to the next frame.
+    ///
+    /// The block is returned to the kernel after its last frame.
+    void next() {
+        if (!frame_) {
+            return;
+        }
+        if (--frames_left_ > 0) {
+            frame_ = reinterpret_cast<struct tpacket3_hdr*>(
+                reinterpret_cast<uint8_t*>(frame_) + frame_->tp_next_offset);
+        } else {
+            releaseBlock();
+        }
+    }
+
+private:
+
+    /// @brief Returns the descriptor of the current block.
+    struct tpacket_block_desc* getBlock() const {
+        return (reinterpret_cast<struct tpacket_block_desc*>(
+                    map_ + block_ * RING_BLOCK_SIZE));
+    }
+
+    /// @brief Returns the current block to the kernel.
+    void releaseBlock() {
+        // The frames must have been read before the kernel reuses the block.
+        std::atomic_thread_fence(std::memory_order_release);
+        getBlock()->hdr.bh1.block_status = TP_STATUS_KERNEL;
+        block_ = (block_ + 1) % RING_BLOCK_NR;
+        frame_ = 0;
+        frames_left_ = 0;
+    }
+
+    /// @brief Socket descriptor.
+    int sockfd_;
+
+    /// @brief Device of the socket inode.
+    dev_t dev_;
+
+    /// @brief Socket inode.
+    ino_t ino_;
+
+    /// @brief Mapped ring.
+    uint8_t* map_;
+
+    /// @brief Length of the mapped ring.
+    size_t map_len_;
+
+    /// @brief Index of the current block.
+    uint32_t block_;
+
+    /// @brief Current frame in the current block or null.
+    struct tpacket3_hdr* frame_;
+
+    /// @brief Number of frames left in the current block, including the
+    /// current one.
+    uint32_t frames_left_;
+};
+
+PktFilterLPF::PktFilterLPF(const bool use_ring)
+    : use_ring_(use_ring) {
+}
+
+PktFilterLPF::~PktFilterLPF() {
+}
+
 SocketInfo
 PktFilterLPF::openSocket(Iface& iface,
                          const isc::asiolink::IOAddress& addr,
                          const uint16_t port, const bool,
                          const bool) {
 
+    // Unmap the rings of the sockets closed since the last call, so their
+    // descriptors can be reused.
+    releaseClosedRings();
+
+    return (openSocketInternal(iface, addr, port, true));
+}
+
+std::vector<SocketInfo>
+PktFilterLPF::openSocketShards(Iface& iface,
+                               const isc::asiolink::IOAddress& addr,
+                               const uint16_t port,
+                               const bool receive_bcast,
+                               const bool send_bcast,
+                               const size_t count) {
+    if (count <= 1) {
+        return (PktFilter::openSocketShards(iface, addr, port, receive_bcast,
+                                            send_bcast, count));
+    }
+
+    releaseClosedRings();
+
+    std::vector<SocketInfo> sockets;
+    try {
+        // Only the first shard has a fallback socket.
+        for (size_t shard = 0; shard < count; ++shard) {
+            sockets.push_back(openSocketInternal(iface, addr, port,
+                                                 shard == 0));
+        }
+        joinFanoutGroup(sockets);
+    } catch (...) {
+        for (auto const& s : sockets) {
+            close(s.sockfd_);
+            if (s.fallbackfd_ >= 0) {
+                close(s.fallbackfd_);
+            }
+        }
+        releaseClosedRings();
+        throw;
+    }
+    return (sockets);
+}
+
+SocketInfo
+PktFilterLPF::openSocketInternal(Iface& iface,
+                                 const isc::asiolink::IOAddress& addr,
+                                 const uint16_t port, const bool fallback_socket) {
     // Open fallback socket first. If it fails, it will give us an indication
     // that there is another service (perhaps DHCP server) running.
     // The function will throw an exception and effectively cease opening
     // raw socket below.
-    int fallback = openFallbackSocket(addr, port);
+    int fallback = fallback_socket ? openFallbackSocket(addr, port) : -1;
 
     // The fallback is open, so we are good to open primary socket.
     int sock = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
     if (sock < 0) {
-        close(fallback);
+        closeFallbackSocket(fallback);
         isc_throw(SocketConfigError, "Failed to create raw LPF socket");
     }
 
     // Set the close-on-exec flag.
     if (fcntl(sock, F_SETFD, FD_CLOEXEC) < 0) {
         close(sock);
-        close(fallback);
+        closeFallbackSocket(fallback);
         isc_throw(SocketConfigError, "Failed to set close-on-exec flag"
                   << " on the socket " << sock);
     }
@@ -175,11 +594,24 @@ PktFilterLPF::openSocket(Iface& iface,
     if (setsockopt(sock, SOL_SOCKET, SO_ATTACH_FILTER, &filter_program,
                    sizeof(filter_program)) < 0) {
         close(sock);
-        close(fallback);
+        closeFallbackSocket(fallback);
         isc_throw(SocketConfigError, "Failed to install packet filtering program"
                   << " on the socket " << sock);
     }
 
+    // Create the receive ring before binding the socket so that all
+    // frames go through it.
+    RingPtr ring;
+    if (use_ring_) {
+        try {
+            ring.reset(new Ring(sock));
+        } catch (...) {
+            close(sock);
+            closeFallbackSocket(fallback);
+            throw;
+        }
+    }
+
     struct sockaddr_ll sa;
     memset(&sa, 0, sizeof(sockaddr_ll));
     sa.sll_family = AF_PACKET;
@@ -192,7 +624,7 @@ PktFilterLPF::openSocket(Iface& iface,
     if (bind(sock, reinterpret_cast<const struct sockaddr*>(&sa),
              sizeof(sa)) < 0) {
         close(sock);
-        close(fallback);
+        closeFallbackSocket(fallback);
         isc_throw(SocketConfigError, "Failed to bind LPF socket '" << sock
                   << "' to interface '" << iface.getName() << "'");
     }
@@ -203,40 +635,75 @@ PktFilterLPF::openSocket(Iface& iface,
         // invocation to close() below would override the errno.
         char* errmsg = strerror(errno);
         close(sock);
-        close(fallback);
+        closeFallbackSocket(fallback);
         isc_throw(SocketConfigError, "failed to set SO_NONBLOCK option on the"
                   " LPF socket '" << sock << "' to interface '"
                   << iface.getName() << "'" << ", reason: " << errmsg);
     }
 
+    if (ring) {
+        rings_[sock] = ring;
+    }
+
     return (SocketInfo(addr, port, sock, fallback));
 
 }
 
+PktFilterLPF::RingPtr
+PktFilterLPF::getRing(int sockfd) const {
+    auto ring = rings_.find(sockfd);
+    if (ring == rings_.end()) {
+        return (RingPtr());
+    }
+    return (ring->second);
+}
+
+void
+PktFilterLPF::releaseClosedRings() {
+    for (auto ring = rings_.begin(); ring != rings_.end(); ) {
+        if (ring->second->isSocketOpen()) {
+            ++ring;
+        } else {
+            ring = rings_.erase(ring);
+        }
+    }
+}
+
+Pkt4Ptr
+PktFilterLPF::receiveFromRing(Iface& iface, Ring& ring) {
+    const struct tpacket3_hdr* frame = ring.current();
+    if (!frame) {
+        return (Pkt4Ptr());
+    }
+
+    // The frame is decoded in place and handed back to the kernel even
+    // if it is malformed.
+    Pkt4Ptr pkt;
+    try {
+        pkt = decodeFrame(iface, reinterpret_cast<const uint8_t*>(frame) +
+                          frame->tp_mac, frame->tp_snaplen);
+    } catch (...) {
+        ring.next();
+        throw;
+    }
+    ring.next();
+    return (pkt);
+}
+
 Pkt4Ptr
 PktFilterLPF::receive(Iface& iface, const SocketInfo& socket_info) {
-    uint8_t raw_buf[IfaceMgr::RCVBUFSIZE];
-    // First let's get some data from the fallback socket. The data will be
-    // discarded but we don't want the socket buffer to bloat. We get the
-    // packets from the socket in loop but most of the time the loop will
-    // end after receiving one packet. The call to recv returns immediately
-    // when there is no data left on the socket because the socket is
-    // non-blocking.
-    // @todo In the normal conditions, both the primary socket and the fallback
-    // socket are in sync as they are set to receive packets on the same
-    // address and port. The reception of packets on the fallback socket
-    // shouldn't cause significant lags in packet reception. If we find in the
-    // future that it does, the sort of threshold could be set for the maximum
-    // bytes received on the fallback socket in a single round. Further
-    // optimizations would include an asynchronous read from the fallback socket
-    // when the DHCP server is idle.
-    int datalen;
-    do {
-        datalen = recv(socket_info.fallbackfd_, raw_buf, sizeof(raw_buf), 0);
-    } while (datalen > 0);
+    // First let's get some data from the fallback socket.
+    drainFallbackSocket(socket_info.fallbackfd_);
+
+    // Take the frame from the receive ring when there is one.
+    RingPtr ring = getRing(socket_info.sockfd_);
+    if (ring) {
+        return (receiveFromRing(iface, *ring));
+    }
 
     // Now that we finished getting data from the fallback socket, we
     // have to get the data from the raw socket too.
+    uint8_t raw_buf[IfaceMgr::RCVBUFSIZE];
     int data_len = read(socket_info.sockfd_, raw_buf, sizeof(raw_buf));
     // If negative value is returned by read(), it indicates that an
     // error occurred. If returned value is 0, no data was read from the
@@ -247,81 +714,48 @@ PktFilterLPF::receive(Iface& iface, const SocketInfo& socket_info) {
         return Pkt4Ptr();
     }
 
-    InputBuffer buf(raw_buf, data_len);
-
-    // @todo: This is awkward way to solve the chicken and egg problem
-    // whereby we don't know the offset where DHCP data start in the
-    // received buffer when we create the packet object. In general case,
-    // the IP header has variable length. The information about its length
-    // is stored in one of its fields. Therefore, we have to decode the
-    // packet to get the offset of the DHCP data. The dummy object is
-    // created so as we can pass it to the functions which decode IP stack
-    // and find actual offset of the DHCP data.
-    // Once we find the offset we can create another Pkt4 object from
-    // the reminder of the input buffer and set the IP addresses and
-    // ports from the dummy packet. We should consider doing it
-    // in some more elegant way.
-    Pkt4Ptr dummy_pkt = Pkt4Ptr(new Pkt4(DHCPDISCOVER, 0));
-
-    // Decode ethernet, ip and udp headers.
-    decodeEthernetHeader(buf, dummy_pkt);
-    decodeIpUdpHeader(buf, dummy_pkt);
-
-    // Read the DHCP data.
-    std::vector<uint8_t> dhcp_buf;
-    buf.readVector(dhcp_buf, buf.getLength() - buf.getPosition());
-
-    // Decode DHCP data into the Pkt4 object.
-    Pkt4Ptr pkt = Pkt4Ptr(new Pkt4(&dhcp_buf[0], dhcp_buf.size()));
+    return (decodeFrame(iface, raw_buf, data_len));
+}
 
-    // Set the appropriate packet members using data collected from
-    // the decoded headers.
-    pkt->setIndex(iface.getIndex());
-    pkt->setIface(iface.getName());
-    pkt->setLocalAddr(dummy_pkt->getLocalAddr());
-    pkt->setRemoteAddr(dummy_pkt->getRemoteAddr());
-    pkt->setLocalPort(dummy_pkt->getLocalPort());
-    pkt->setRemotePort(dummy_pkt->getRemotePort());
-    pkt->setLocalHWAddr(dummy_pkt->getLocalHWAddr());
-    pkt->setRemoteHWAddr(dummy_pkt->getRemoteHWAddr());
+Pkt4Collection
+PktFilterLPF::receiveBatch(Iface& iface, const SocketInfo& socket_info,
+                           const size_t max_count) {
+    RingPtr ring = getRing(socket_info.sockfd_);
+    if (!ring || (max_count <= 1)) {
+        return (PktFilter::receiveBatch(iface, socket_info, max_count));
+    }
 
-    return (pkt);
+    drainFallbackSocket(socket_info.fallbackfd_);
+
+    Pkt4Collection pkts;
+    while (pkts.size() < max_count) {
+        Pkt4Ptr pkt;
+        try {
+            pkt = receiveFromRing(iface, *ring);
+        } catch (...) {
+            // Report the error unless it would drop the packets already
+            // received, in which case the malformed frame is skipped.
+            if (pkts.empty()) {
+                throw;
+            }
+            continue;
+        }
+        if (!pkt) {
+            break;
+        }
+        pkts.push_back(pkt);
+    }
+    return (pkts);
 }
 
 int
 PktFilterLPF::send(const Iface& iface, uint16_t sockfd, const Pkt4Ptr& pkt) {
 
     OutputBuffer buf(14);
-
-    // Some interfaces may have no HW address - e.g. loopback interface.
-    // For these interfaces the HW address length is 0. If this is the case,
-    // then we will rely on the functions which construct the IP/UDP headers
-    // to provide a default HW addres. Otherwise, create the HW address
-    // object using the HW address of the interface.
-    if (iface.getMacLen() > 0) {
-        HWAddrPtr hwaddr(new HWAddr(iface.getMac(), iface.getMacLen(),
-                                    iface.getHWType()));
-        pkt->setLocalHWAddr(hwaddr);
-    }
-
-
-    // Ethernet frame header.
-    // Note that we don't validate whether HW addresses in 'pkt'
-    // are valid because they are checked by the function called.
-    writeEthernetHeader(pkt, buf);
-
-    // IP and UDP header
-    writeIpUdpHeader(pkt, buf);
-
-    // DHCPv4 message
-    buf.writeData(pkt->getBuffer().getData(), pkt->getBuffer().getLength());
+    writeFrame(iface, pkt, buf);
 
     sockaddr_ll sa;
-    memset(&sa, 0x0, sizeof(sa));
-    sa.sll_family = AF_PACKET;
-    sa.sll_ifindex = iface.getIndex();
-    sa.sll_protocol = htons(ETH_P_IP);
-    sa.sll_halen = 6;
+    initSendAddress(iface, sa);
 
     int result = sendto(sockfd, buf.getData(), buf.getLength(), 0,
                         reinterpret_cast<const struct sockaddr*>(&sa),
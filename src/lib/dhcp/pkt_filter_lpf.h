@@ -1,4 +1,4 @@
-// Copyright (C) 2013-2017 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2013-2021 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -11,6 +11,10 @@
 
 #include <util/buffer.h>
 
+#include <boost/shared_ptr.hpp>
+
+#include <map>
+
 namespace isc {
 namespace dhcp {
 
@@ -20,9 +24,52 @@ namespace dhcp {
 /// sockets and Linux Packet Filtering. It is used by @c isc::dhcp::IfaceMgr
 /// to send DHCPv4 messages to the hosts which don't have an IPv4 address
 /// assigned yet.
+///
+/// By default each frame is copied from the socket with a system call.
+/// When the memory mapped ring is enabled, a TPACKET_V3 receive ring is
+/// attached to each raw socket: the kernel stores the frames in blocks
+/// of a buffer shared with the process, the frames are decoded in place
+/// and each block is handed back to the kernel once all its frames have
+/// been read. A block is passed to the process when it is full or when
+/// @c RING_BLOCK_TIMEOUT expires, which bounds the added latency when
+/// the traffic is low.
+///
+/// The ring of a socket is unmapped when the packet filter is destroyed
+/// or when a new socket is opened after the socket has been closed.
+/// The sockets must not be opened while other threads receive packets
+/// using the same packet filter.
 class PktFilterLPF : public PktFilter {
 public:
 
+    /// @brief Size of a receive ring block.
+    static const uint32_t RING_BLOCK_SIZE = 1 << 17;
+
+    /// @brief Number of blocks in a receive ring.
+    static const uint32_t RING_BLOCK_NR = 32;
+
+    /// @brief Nominal size of a frame in a receive ring.
+    static const uint32_t RING_FRAME_SIZE = 2048;
+
+    /// @brief Timeout in milliseconds after which the kernel passes a
+    /// partially filled block to the process.
+    static const uint32_t RING_BLOCK_TIMEOUT = 4;
+
+    /// @brief Constructor.
+    ///
+    /// @param use_ring true if the sockets should use a memory mapped
+    /// receive ring.
+    explicit PktFilterLPF(const bool use_ring = false);
+
+    /// @brief Destructor.
+    ///
+    /// Unmaps the receive rings.
+    virtual ~PktFilterLPF();
+
+    /// @brief Checks if the memory mapped receive ring is used.
+    bool isRingEnabled() const {
+        return (use_ring_);
+    }
+
     /// @brief Check if packet can be sent to the host without address directly.
     ///
     /// This class supports direct responses to the host without address.
@@ -47,6 +94,31 @@ public:
                                   const bool receive_bcast,
                                   const bool send_bcast);
 
+    /// @brief Open a set of raw sockets sharing the traffic of an interface.
+    ///
+    /// The sockets join a PACKET_FANOUT group whose program selects the
+    /// socket of a frame by hashing the last four bytes of the client
+    /// hardware address (chaddr) of the DHCPv4 message. Only the first
+    /// socket has a fallback socket. Each socket has its own receive ring
+    /// when the ring is enabled.
+    ///
+    /// @param iface Interface descriptor.
+    /// @param addr Address on the interface to be used to send packets.
+    /// @param port Port number.
+    /// @param receive_bcast Configure socket to receive broadcast messages
+    /// @param send_bcast Configure socket to send broadcast messages.
+    /// @param count Requested number of shards.
+    ///
+    /// @return Structures describing the sockets, ordered by shard.
+    /// @throw isc::dhcp::SocketConfigError if one of the sockets can't be
+    /// opened or can't join the fanout group.
+    virtual std::vector<SocketInfo> openSocketShards(Iface& iface,
+                                                     const isc::asiolink::IOAddress& addr,
+                                                     const uint16_t port,
+                                                     const bool receive_bcast,
+                                                     const bool send_bcast,
+                                                     const size_t count);
+
     /// @brief Receive packet over specified socket.
     ///
     /// @param iface interface
@@ -67,6 +139,64 @@ public:
     virtual int send(const Iface& iface, uint16_t sockfd,
                      const Pkt4Ptr& pkt);
 
+    /// @brief Receive multiple packets over specified socket.
+    ///
+    /// When the memory mapped ring is used, this function returns up to
+    /// @c max_count frames already passed to the process by the kernel.
+    /// Otherwise a single packet is received.
+    ///
+    /// @param iface interface
+    /// @param socket_info structure holding socket information
+    /// @param max_count maximum number of packets to be received.
+    ///
+    /// @return Collection of received packets. It may be empty.
+    virtual Pkt4Collection receiveBatch(Iface& iface,
+                                        const SocketInfo& socket_info,
+                                        const size_t max_count);
+
+private:
+
+    /// @brief Memory mapped receive ring of a socket.
+    class Ring;
+
+    /// @brief Pointer to a receive ring.
+    typedef boost::shared_ptr<Ring> RingPtr;
+
+    /// @brief Returns the receive ring of a socket.
+    ///
+    /// @param sockfd socket descriptor.
+    /// @return Pointer to the ring or null if the socket has none.
+    RingPtr getRing(int sockfd) const;
+
+    /// @brief Unmaps the rings of the sockets which have been closed.
+    void releaseClosedRings();
+
+    /// @brief Opens a raw socket bound to an interface.
+    ///
+    /// @param iface Interface descriptor.
+    /// @param addr Address on the interface to be used to send packets.
+    /// @param port Port number.
+    /// @param fallback_socket Open a fallback socket too.
+    ///
+    /// @return A structure describing the socket.
+    SocketInfo openSocketInternal(Iface& iface,
+                                  const isc::asiolink::IOAddress& addr,
+                                  const uint16_t port,
+                                  const bool fallback_socket);
+
+    /// @brief Receives the next frame from a receive ring.
+    ///
+    /// @param iface interface
+    /// @param ring the receive ring of the socket
+    ///
+    /// @return Received packet or null if the ring holds no frame.
+    Pkt4Ptr receiveFromRing(Iface& iface, Ring& ring);
+
+    /// @brief Indicates if the sockets use a memory mapped receive ring.
+    bool use_ring_;
+
+    /// @brief Receive rings indexed by socket descriptor.
+    std::map<int, RingPtr> rings_;
 };
 
 } // namespace isc::dhcp
@@ -49,6 +49,14 @@ struct SocketInfo {
     /// the fallback socket is closed (not open).
     int fallbackfd_;
 
+    /// @brief Index of the shard the socket belongs to.
+    ///
+    /// When socket sharding is enabled several primary sockets are opened
+    /// for the same address and port, each of them receiving the traffic
+    /// of a subset of the clients. The value is 0 when sharding is not
+    /// used.
+    size_t shard_;
+
     /// @brief SocketInfo constructor.
     ///
     /// @param addr An address the socket is bound to.
@@ -58,7 +66,7 @@ struct SocketInfo {
     SocketInfo(const isc::asiolink::IOAddress& addr, const uint16_t port,
                const int sockfd, const int fallbackfd = -1)
         : addr_(addr), port_(port), family_(addr.getFamily()),
-          sockfd_(sockfd), fallbackfd_(fallbackfd) { }
+          sockfd_(sockfd), fallbackfd_(fallbackfd), shard_(0) { }
 
 };
 
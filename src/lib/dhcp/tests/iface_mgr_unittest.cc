@@ -470,8 +470,12 @@ public:
     /// @param dhcp_queue_control dhcp-queue-control contents to use for the test
     /// @param exp_queue_enabled flag that indicates if packet queuing is expected
     /// to be enabled.
-    void sendReceive6Test(data::ConstElementPtr dhcp_queue_control, bool exp_queue_enabled) {
+    /// @param handler_type type of the handler waiting for data on the sockets.
+    void sendReceive6Test(data::ConstElementPtr dhcp_queue_control, bool exp_queue_enabled,
+                          const util::FDEventHandler::HandlerType handler_type =
+                          util::FDEventHandler::TYPE_SELECT) {
         scoped_ptr<NakedIfaceMgr> ifacemgr(new NakedIfaceMgr());
+        ASSERT_NO_THROW(ifacemgr->setFDEventHandlerType(handler_type));
 
         // Testing socket operation in a portable way is tricky
         // without interface detection implemented
@@ -557,8 +561,12 @@ public:
     /// @param dhcp_queue_control dhcp-queue-control contents to use for the test
     /// @param exp_queue_enabled flag that indicates if packet queuing is expected
     /// to be enabled.
-    void sendReceive4Test(data::ConstElementPtr dhcp_queue_control, bool exp_queue_enabled) {
+    /// @param handler_type type of the handler waiting for data on the sockets.
+    void sendReceive4Test(data::ConstElementPtr dhcp_queue_control, bool exp_queue_enabled,
+                          const util::FDEventHandler::HandlerType handler_type =
+                          util::FDEventHandler::TYPE_SELECT) {
         scoped_ptr<NakedIfaceMgr> ifacemgr(new NakedIfaceMgr());
+        ASSERT_NO_THROW(ifacemgr->setFDEventHandlerType(handler_type));
 
         // Testing socket operation in a portable way is tricky
         // without interface detection implemented.
@@ -663,7 +671,10 @@ public:
         // thread is already inside the select when the socket is closed,
         // and (at least under Centos 7.5), this does not interrupt the
         // select.  For now, we'll only test this for direct receive.
-        if (!queue_enabled) {
+        // The kernel silently removes closed sockets from an epoll
+        // instance so there is no error to report with epoll().
+        if (!queue_enabled &&
+            (ifacemgr->getFDEventHandlerType() == util::FDEventHandler::TYPE_SELECT)) {
             EXPECT_THROW(ifacemgr->receive4(10), SocketReadError);
         }
 
@@ -676,6 +687,332 @@ public:
         ASSERT_FALSE(ifacemgr->isDHCPReceiverRunning());
     }
 
+    /// @brief Tests the ability to send and receive batches of DHCPv4 packets
+    ///
+    /// This test configures the receive batch size and the packet queue
+    /// using the given dhcp-queue-control, sends a collection of DISCOVER
+    /// packets over the loop back interface and receives them with
+    /// @c IfaceMgr::receive4Batch.
+    ///
+    /// @param dhcp_queue_control dhcp-queue-control contents to use for the test
+    /// @param exp_queue_enabled flag that indicates if packet queuing is expected
+    /// to be enabled.
+    void sendReceiveBatch4Test(data::ConstElementPtr dhcp_queue_control,
+                               bool exp_queue_enabled) {
+        scoped_ptr<NakedIfaceMgr> ifacemgr(new NakedIfaceMgr());
+
+        IOAddress lo_addr("127.0.0.1");
+        int socket1 = 0;
+        EXPECT_NO_THROW(
+            socket1 = ifacemgr->openSocket(LOOPBACK_NAME, lo_addr,
+                                           DHCP4_SERVER_PORT + 10000);
+        );
+        EXPECT_GE(socket1, 0);
+
+        // Configure packet queueing and the receive batch size.
+        bool queue_enabled = false;
+        ASSERT_NO_THROW(queue_enabled = ifacemgr->configureDHCPPacketQueue(AF_INET, dhcp_queue_control));
+        ASSERT_EQ(exp_queue_enabled, queue_enabled);
+        ASSERT_EQ(8, ifacemgr->getReceiveBatchSize());
+
+        ASSERT_NO_THROW(ifacemgr->startDHCPReceiver(AF_INET));
+        ASSERT_TRUE(queue_enabled == ifacemgr->isDHCPReceiverRunning());
+
+        // Build the packets to send. Each one has its own transaction id.
+        Pkt4Collection sendPkts;
+        for (uint32_t transid = 1; transid <= 5; ++transid) {
+            Pkt4Ptr sendPkt(new Pkt4(DHCPDISCOVER, transid));
+            sendPkt->setLocalAddr(IOAddress("127.0.0.1"));
+            sendPkt->setLocalPort(DHCP4_SERVER_PORT + 10000 + 1);
+            sendPkt->setRemotePort(DHCP4_SERVER_PORT + 10000);
+            sendPkt->setRemoteAddr(IOAddress("127.0.0.1"));
+            sendPkt->setIndex(LOOPBACK_INDEX);
+            sendPkt->setIface(string(LOOPBACK_NAME));
+            ASSERT_NO_THROW(sendPkt->pack());
+            sendPkts.push_back(sendPkt);
+        }
+
+        // Send all packets.
+        for (auto sendPkt : sendPkts) {
+            bool result = false;
+            EXPECT_NO_THROW(result = ifacemgr->send(sendPkt));
+            EXPECT_TRUE(result);
+        }
+
+        // Receive them. The receiver thread may have queued only some of
+        // them so far, hence the loop.
+        Pkt4Collection rcvPkts;
+        for (int i = 0; (i < 10) && (rcvPkts.size() < sendPkts.size()); ++i) {
+            Pkt4Collection batch;
+            ASSERT_NO_THROW(batch = ifacemgr->receive4Batch(1));
+            ASSERT_LE(batch.size(), ifacemgr->getReceiveBatchSize());
+            rcvPkts.insert(rcvPkts.end(), batch.begin(), batch.end());
+        }
+        ASSERT_EQ(sendPkts.size(), rcvPkts.size());
+
+        // The packets are received in the order they were sent.
+        for (size_t i = 0; i < rcvPkts.size(); ++i) {
+            ASSERT_NO_THROW(rcvPkts[i]->unpack());
+            EXPECT_EQ(DHCPDISCOVER, rcvPkts[i]->getType());
+            EXPECT_EQ(sendPkts[i]->getTransid(), rcvPkts[i]->getTransid());
+            EXPECT_EQ(sendPkts[i]->getRemotePort(), rcvPkts[i]->getLocalPort());
+        }
+
+        ASSERT_NO_THROW(ifacemgr->stopDHCPReceiver());
+        ASSERT_FALSE(ifacemgr->isDHCPReceiverRunning());
+    }
+
+    /// @brief Tests the ability to send and receive batches of DHCPv6 packets
+    ///
+    /// This test configures the receive batch size and the packet queue
+    /// using the given dhcp-queue-control, sends a collection of packets
+    /// over the loop back interface and receives them with
+    /// @c IfaceMgr::receive6Batch.
+    ///
+    /// @param dhcp_queue_control dhcp-queue-control contents to use for the test
+    /// @param exp_queue_enabled flag that indicates if packet queuing is expected
+    /// to be enabled.
+    void sendReceiveBatch6Test(data::ConstElementPtr dhcp_queue_control,
+                               bool exp_queue_enabled) {
+        scoped_ptr<NakedIfaceMgr> ifacemgr(new NakedIfaceMgr());
+
+        IOAddress lo_addr("::1");
+        int socket1 = 0;
+        EXPECT_NO_THROW(
+            socket1 = ifacemgr->openSocket(LOOPBACK_NAME, lo_addr, 10547);
+        );
+        EXPECT_GE(socket1, 0);
+
+        // Configure packet queueing and the receive batch size.
+        bool queue_enabled = false;
+        ASSERT_NO_THROW(queue_enabled = ifacemgr->configureDHCPPacketQueue(AF_INET6, dhcp_queue_control));
+        ASSERT_EQ(exp_queue_enabled, queue_enabled);
+        ASSERT_EQ(8, ifacemgr->getReceiveBatchSize());
+
+        ASSERT_NO_THROW(ifacemgr->startDHCPReceiver(AF_INET6));
+        ASSERT_TRUE(queue_enabled == ifacemgr->isDHCPReceiverRunning());
+
+        // Build the packets to send. Each one has its own transaction id.
+        Pkt6Collection sendPkts;
+        for (uint32_t transid = 1; transid <= 5; ++transid) {
+            Pkt6Ptr sendPkt(new Pkt6(DHCPV6_SOLICIT, transid));
+            sendPkt->setRemotePort(10547);
+            sendPkt->setRemoteAddr(IOAddress("::1"));
+            sendPkt->setIndex(LOOPBACK_INDEX);
+            sendPkt->setIface(LOOPBACK_NAME);
+            ASSERT_NO_THROW(sendPkt->pack());
+            sendPkts.push_back(sendPkt);
+        }
+
+        // Send all packets.
+        for (auto sendPkt : sendPkts) {
+            bool result = false;
+            EXPECT_NO_THROW(result = ifacemgr->send(sendPkt));
+            EXPECT_TRUE(result);
+        }
+
+        // Receive them. The receiver thread may have queued only some of
+        // them so far, hence the loop.
+        Pkt6Collection rcvPkts;
+        for (int i = 0; (i < 10) && (rcvPkts.size() < sendPkts.size()); ++i) {
+            Pkt6Collection batch;
+            ASSERT_NO_THROW(batch = ifacemgr->receive6Batch(1));
+            ASSERT_LE(batch.size(), ifacemgr->getReceiveBatchSize());
+            rcvPkts.insert(rcvPkts.end(), batch.begin(), batch.end());
+        }
+        ASSERT_EQ(sendPkts.size(), rcvPkts.size());
+
+        // The packets are received in the order they were sent.
+        for (size_t i = 0; i < rcvPkts.size(); ++i) {
+            ASSERT_NO_THROW(rcvPkts[i]->unpack());
+            EXPECT_EQ(DHCPV6_SOLICIT, rcvPkts[i]->getType());
+            EXPECT_EQ(sendPkts[i]->getTransid(), rcvPkts[i]->getTransid());
+        }
+
+        ASSERT_NO_THROW(ifacemgr->stopDHCPReceiver());
+        ASSERT_FALSE(ifacemgr->isDHCPReceiverRunning());
+    }
+
+    /// @brief Tests the reception of DHCPv4 packets over sharded sockets.
+    ///
+    /// This test opens four shards of a socket on the loop back interface,
+    /// sends packets with distinct client hardware addresses and checks
+    /// that each shard receives the packets of the clients hashing to it
+    /// with @c IfaceMgr::receive4Shard.
+    ///
+    /// @param handler_type type of the event handler to use.
+    void sendReceiveShards4Test(const util::FDEventHandler::HandlerType handler_type) {
+        scoped_ptr<NakedIfaceMgr> ifacemgr(new NakedIfaceMgr());
+        ASSERT_NO_THROW(ifacemgr->setFDEventHandlerType(handler_type));
+
+        const size_t shards = 4;
+        ASSERT_NO_THROW(ifacemgr->setSocketShards(shards));
+        ASSERT_EQ(shards, ifacemgr->getSocketShards());
+
+        IOAddress lo_addr("127.0.0.1");
+        int socket1 = -1;
+        ASSERT_NO_THROW(
+            socket1 = ifacemgr->openSocket(LOOPBACK_NAME, lo_addr,
+                                           DHCP4_SERVER_PORT + 10000);
+        );
+        ASSERT_GE(socket1, 0);
+
+        // One socket per shard has been opened for the address.
+        IfacePtr lo = ifacemgr->getIface(LOOPBACK_NAME);
+        ASSERT_TRUE(lo);
+        ASSERT_EQ(shards, lo->getSockets().size());
+        size_t shard = 0;
+        for (const SocketInfo& s : lo->getSockets()) {
+            EXPECT_EQ(lo_addr, s.addr_);
+            EXPECT_EQ(shard++, s.shard_);
+        }
+        EXPECT_EQ(socket1, lo->getSockets().front().sockfd_);
+
+        // Send two packets per shard, the last byte of the hardware
+        // address selects the shard.
+        Pkt4Collection sendPkts;
+        for (uint8_t client = 0; client < 2 * shards; ++client) {
+            Pkt4Ptr sendPkt(new Pkt4(DHCPDISCOVER, 1000 + client));
+            std::vector<uint8_t> mac = { 0, 1, 2, 3, 4, client };
+            sendPkt->setHWAddr(HTYPE_ETHER, mac.size(), mac);
+            sendPkt->setLocalAddr(lo_addr);
+            sendPkt->setRemotePort(DHCP4_SERVER_PORT + 10000);
+            sendPkt->setRemoteAddr(lo_addr);
+            sendPkt->setIndex(LOOPBACK_INDEX);
+            sendPkt->setIface(string(LOOPBACK_NAME));
+            ASSERT_NO_THROW(sendPkt->pack());
+            sendPkts.push_back(sendPkt);
+        }
+        for (auto sendPkt : sendPkts) {
+            bool result = false;
+            EXPECT_NO_THROW(result = ifacemgr->send(sendPkt));
+            EXPECT_TRUE(result);
+        }
+
+        // The sharded sockets are not watched by the main receive.
+        Pkt4Ptr pkt;
+        ASSERT_NO_THROW(pkt = ifacemgr->receive4(0, 10000));
+        EXPECT_FALSE(pkt);
+
+        // Each shard receives the packets of its clients.
+        for (shard = 0; shard < shards; ++shard) {
+            Pkt4Collection rcvPkts;
+            for (int i = 0; (i < 10) && (rcvPkts.size() < 2); ++i) {
+                Pkt4Collection batch;
+                ASSERT_NO_THROW(batch = ifacemgr->receive4Shard(shard, 1));
+                rcvPkts.insert(rcvPkts.end(), batch.begin(), batch.end());
+            }
+            ASSERT_EQ(2, rcvPkts.size()) << "shard " << shard;
+            for (auto rcvPkt : rcvPkts) {
+                ASSERT_NO_THROW(rcvPkt->unpack());
+                EXPECT_EQ(shard, rcvPkt->getHWAddr()->hwaddr_[5] % shards);
+            }
+        }
+
+        // Nothing is left.
+        Pkt4Collection none;
+        ASSERT_NO_THROW(none = ifacemgr->receive4Shard(0, 0, 10000));
+        EXPECT_TRUE(none.empty());
+
+        // An interrupted shard receiver returns immediately.
+        ASSERT_NO_THROW(ifacemgr->interruptShardReceivers());
+        ASSERT_NO_THROW(none = ifacemgr->receive4Shard(1, 10));
+        EXPECT_TRUE(none.empty());
+        ASSERT_NO_THROW(ifacemgr->resumeShardReceivers());
+
+        // Out of range shards are rejected.
+        EXPECT_THROW(ifacemgr->receive4Shard(shards, 0), BadValue);
+    }
+
+    /// @brief Tests the reception of DHCPv6 packets over sharded sockets.
+    ///
+    /// This test opens four shards of a socket on the loop back interface
+    /// and sends relayed packets with distinct peer addresses and direct
+    /// packets. Each shard must receive the relayed packets of the peers
+    /// hashing to it, while all the direct packets, which share the same
+    /// source address, must be received by a single shard.
+    ///
+    /// @param handler_type type of the event handler to use.
+    void sendReceiveShards6Test(const util::FDEventHandler::HandlerType handler_type) {
+        scoped_ptr<NakedIfaceMgr> ifacemgr(new NakedIfaceMgr());
+        ASSERT_NO_THROW(ifacemgr->setFDEventHandlerType(handler_type));
+
+        const size_t shards = 4;
+        ASSERT_NO_THROW(ifacemgr->setSocketShards(shards));
+
+        IOAddress lo_addr("::1");
+        int socket1 = -1;
+        ASSERT_NO_THROW(
+            socket1 = ifacemgr->openSocket(LOOPBACK_NAME, lo_addr, 10547);
+        );
+        ASSERT_GE(socket1, 0);
+
+        IfacePtr lo = ifacemgr->getIface(LOOPBACK_NAME);
+        ASSERT_TRUE(lo);
+        ASSERT_EQ(shards, lo->getSockets().size());
+
+        // Two relayed packets per shard, the last byte of the peer
+        // address selects the shard.
+        Pkt6Collection sendPkts;
+        for (uint8_t peer = 0; peer < 2 * shards; ++peer) {
+            Pkt6Ptr sendPkt(new Pkt6(DHCPV6_SOLICIT, 1000 + peer));
+            Pkt6::RelayInfo relay;
+            relay.msg_type_ = DHCPV6_RELAY_FORW;
+            relay.linkaddr_ = IOAddress("2001:db8::1");
+            relay.peeraddr_ = IOAddress("fe80::" + std::to_string(peer));
+            sendPkt->addRelayInfo(relay);
+            sendPkt->setRemotePort(10547);
+            sendPkt->setRemoteAddr(lo_addr);
+            sendPkt->setIndex(LOOPBACK_INDEX);
+            sendPkt->setIface(LOOPBACK_NAME);
+            ASSERT_NO_THROW(sendPkt->pack());
+            sendPkts.push_back(sendPkt);
+        }
+        // And two direct packets from ::1.
+        for (uint32_t transid = 1; transid <= 2; ++transid) {
+            Pkt6Ptr sendPkt(new Pkt6(DHCPV6_SOLICIT, transid));
+            sendPkt->setRemotePort(10547);
+            sendPkt->setRemoteAddr(lo_addr);
+            sendPkt->setIndex(LOOPBACK_INDEX);
+            sendPkt->setIface(LOOPBACK_NAME);
+            ASSERT_NO_THROW(sendPkt->pack());
+            sendPkts.push_back(sendPkt);
+        }
+        for (auto sendPkt : sendPkts) {
+            bool result = false;
+            EXPECT_NO_THROW(result = ifacemgr->send(sendPkt));
+            EXPECT_TRUE(result);
+        }
+
+        // The sharded sockets are not watched by the main receive.
+        Pkt6Ptr pkt;
+        ASSERT_NO_THROW(pkt = ifacemgr->receive6(0, 10000));
+        EXPECT_FALSE(pkt);
+
+        // The direct packets hash on the last byte of ::1.
+        const size_t direct_shard = 1 % shards;
+        for (size_t shard = 0; shard < shards; ++shard) {
+            const size_t expected = (shard == direct_shard ? 4 : 2);
+            Pkt6Collection rcvPkts;
+            for (int i = 0; (i < 10) && (rcvPkts.size() < expected); ++i) {
+                Pkt6Collection batch;
+                ASSERT_NO_THROW(batch = ifacemgr->receive6Shard(shard, 1));
+                rcvPkts.insert(rcvPkts.end(), batch.begin(), batch.end());
+            }
+            ASSERT_EQ(expected, rcvPkts.size()) << "shard " << shard;
+            for (auto rcvPkt : rcvPkts) {
+                ASSERT_NO_THROW(rcvPkt->unpack());
+                if (rcvPkt->relay_info_.empty()) {
+                    EXPECT_EQ(direct_shard, shard);
+                } else {
+                    std::vector<uint8_t> peer =
+                        rcvPkt->relay_info_[0].peeraddr_.toBytes();
+                    EXPECT_EQ(shard, peer[15] % shards);
+                }
+            }
+        }
+    }
+
     /// @brief Verifies that IfaceMgr DHCPv4 receive calls detect and
     /// purge external sockets that have gone bad without affecting
     /// affecting normal operations.  It can be run with or without
@@ -1553,6 +1890,197 @@ TEST_F(IfaceMgrTest, sendReceive4) {
     sendReceive4Test(queue_control, true);
 }
 
+// Verifies that batches of DHCPv6 packets are sent and received
+// in either direct or indirect mode.
+TEST_F(IfaceMgrTest, sendReceiveBatch6) {
+    // With queueing disabled, we should use direct reception.
+    data::ElementPtr queue_control =
+        makeQueueConfig(PacketQueueMgr6::DEFAULT_QUEUE_TYPE6, 500, false);
+    queue_control->set("receive-batch-size", data::Element::create(8));
+    sendReceiveBatch6Test(queue_control, false);
+
+    // Queuing enabled, indirection reception should work.
+    queue_control->set("enable-queue", data::Element::create(true));
+    sendReceiveBatch6Test(queue_control, true);
+
+    // Same with the lock-free queue.
+    queue_control->set("queue-type",
+                       data::Element::create(PacketQueueMgr6::LOCKFREE_QUEUE_TYPE6));
+    sendReceiveBatch6Test(queue_control, true);
+}
+
+// Verifies that batches of DHCPv4 packets are sent and received
+// in either direct or indirect mode.
+TEST_F(IfaceMgrTest, sendReceiveBatch4) {
+    // With queueing disabled, we should use direct reception.
+    data::ElementPtr queue_control =
+        makeQueueConfig(PacketQueueMgr4::DEFAULT_QUEUE_TYPE4, 500, false);
+    queue_control->set("receive-batch-size", data::Element::create(8));
+    sendReceiveBatch4Test(queue_control, false);
+
+    // Queuing enabled, indirection reception should work.
+    queue_control->set("enable-queue", data::Element::create(true));
+    sendReceiveBatch4Test(queue_control, true);
+
+    // Same with the lock-free queue.
+    queue_control->set("queue-type",
+                       data::Element::create(PacketQueueMgr4::LOCKFREE_QUEUE_TYPE4));
+    sendReceiveBatch4Test(queue_control, true);
+}
+
+// Verifies that the receive batch size is set by configureDHCPPacketQueue()
+// and that invalid values are rejected.
+TEST_F(IfaceMgrTest, receiveBatchSize) {
+    scoped_ptr<NakedIfaceMgr> ifacemgr(new NakedIfaceMgr());
+
+    // Packets are received one by one by default.
+    EXPECT_EQ(1, ifacemgr->getReceiveBatchSize());
+
+    // The batch size may be set regardless of the queue being enabled.
+    data::ElementPtr queue_control =
+        makeQueueConfig(PacketQueueMgr4::DEFAULT_QUEUE_TYPE4, 500, false);
+    queue_control->set("receive-batch-size", data::Element::create(64));
+    ASSERT_NO_THROW(ifacemgr->configureDHCPPacketQueue(AF_INET, queue_control));
+    EXPECT_EQ(64, ifacemgr->getReceiveBatchSize());
+
+    // Out of range values are rejected.
+    queue_control->set("receive-batch-size", data::Element::create(0));
+    EXPECT_THROW(ifacemgr->configureDHCPPacketQueue(AF_INET, queue_control),
+                 isc::OutOfRange);
+    queue_control->set("receive-batch-size",
+                       data::Element::create(static_cast<long long>(IfaceMgr::MAX_RECEIVE_BATCH_SIZE + 1)));
+    EXPECT_THROW(ifacemgr->configureDHCPPacketQueue(AF_INET, queue_control),
+                 isc::OutOfRange);
+    EXPECT_THROW(ifacemgr->setReceiveBatchSize(0), BadValue);
+
+    // Omitting the parameter restores the default.
+    queue_control->remove("receive-batch-size");
+    ASSERT_NO_THROW(ifacemgr->configureDHCPPacketQueue(AF_INET, queue_control));
+    EXPECT_EQ(1, ifacemgr->getReceiveBatchSize());
+}
+
+// Verifies that the file descriptor event handler type can be changed
+// while the sockets are not watched by the receiver thread.
+TEST_F(IfaceMgrTest, fdEventHandlerType) {
+    scoped_ptr<NakedIfaceMgr> ifacemgr(new NakedIfaceMgr());
+
+    // select() is used by default.
+    EXPECT_EQ(util::FDEventHandler::TYPE_SELECT,
+              ifacemgr->getFDEventHandlerType());
+
+#if defined (OS_LINUX)
+    ASSERT_NO_THROW(ifacemgr->setFDEventHandlerType(util::FDEventHandler::TYPE_EPOLL));
+    EXPECT_EQ(util::FDEventHandler::TYPE_EPOLL,
+              ifacemgr->getFDEventHandlerType());
+    ASSERT_NO_THROW(ifacemgr->setFDEventHandlerType(util::FDEventHandler::TYPE_SELECT));
+    EXPECT_EQ(util::FDEventHandler::TYPE_SELECT,
+              ifacemgr->getFDEventHandlerType());
+#else
+    // epoll is not available.
+    EXPECT_THROW(ifacemgr->setFDEventHandlerType(util::FDEventHandler::TYPE_EPOLL),
+                 NotImplemented);
+#endif
+
+    // The handler can't be changed while the receiver thread is running.
+    data::ConstElementPtr queue_control =
+        makeQueueConfig(PacketQueueMgr4::DEFAULT_QUEUE_TYPE4, 500);
+    ASSERT_NO_THROW(ifacemgr->configureDHCPPacketQueue(AF_INET, queue_control));
+    ASSERT_NO_THROW(ifacemgr->startDHCPReceiver(AF_INET));
+    ASSERT_TRUE(ifacemgr->isDHCPReceiverRunning());
+    EXPECT_THROW(ifacemgr->setFDEventHandlerType(util::FDEventHandler::TYPE_EPOLL),
+                 InvalidOperation);
+    ASSERT_NO_THROW(ifacemgr->stopDHCPReceiver());
+}
+
+// Verifies that the use of the memory mapped receive ring can be set
+// and that the matching packet filter still supports direct responses.
+TEST_F(IfaceMgrTest, packetMmap) {
+    scoped_ptr<NakedIfaceMgr> ifacemgr(new NakedIfaceMgr());
+
+    // The ring is not used by default.
+    EXPECT_FALSE(ifacemgr->getPacketMmap());
+
+    ifacemgr->setPacketMmap(true);
+    EXPECT_TRUE(ifacemgr->getPacketMmap());
+
+    // It still supports direct responses.
+    EXPECT_NO_THROW(ifacemgr->setMatchingPacketFilter(true));
+    EXPECT_TRUE(ifacemgr->isDirectResponseSupported());
+
+    ifacemgr->setPacketMmap(false);
+    EXPECT_FALSE(ifacemgr->getPacketMmap());
+}
+
+// Verifies that the number of socket shards can be set and that invalid
+// numbers of shards are rejected.
+TEST_F(IfaceMgrTest, socketShards) {
+    scoped_ptr<NakedIfaceMgr> ifacemgr(new NakedIfaceMgr());
+
+    // Sockets are not sharded by default.
+    EXPECT_EQ(1, ifacemgr->getSocketShards());
+
+    EXPECT_NO_THROW(ifacemgr->setSocketShards(8));
+    EXPECT_EQ(8, ifacemgr->getSocketShards());
+    EXPECT_THROW(ifacemgr->setSocketShards(0), BadValue);
+    EXPECT_THROW(ifacemgr->setSocketShards(IfaceMgr::MAX_SOCKET_SHARDS + 1),
+                 BadValue);
+    EXPECT_EQ(8, ifacemgr->getSocketShards());
+}
+
+#if defined (OS_LINUX)
+
+// Verifies that DHCPv4 packets are spread over sharded sockets according
+// to the client hardware address.
+TEST_F(IfaceMgrTest, sendReceiveShards4) {
+    sendReceiveShards4Test(util::FDEventHandler::TYPE_SELECT);
+}
+
+// Verifies that DHCPv4 packets are spread over sharded sockets with the
+// epoll() event handler.
+TEST_F(IfaceMgrTest, sendReceiveShards4Epoll) {
+    sendReceiveShards4Test(util::FDEventHandler::TYPE_EPOLL);
+}
+
+// Verifies that DHCPv6 packets are spread over sharded sockets according
+// to the relay peer address or the source address.
+TEST_F(IfaceMgrTest, sendReceiveShards6) {
+    sendReceiveShards6Test(util::FDEventHandler::TYPE_SELECT);
+}
+
+// Verifies that DHCPv6 packets are spread over sharded sockets with the
+// epoll() event handler.
+TEST_F(IfaceMgrTest, sendReceiveShards6Epoll) {
+    sendReceiveShards6Test(util::FDEventHandler::TYPE_EPOLL);
+}
+
+// Verifies that basic DHPCv6 packet send and receive operates
+// in either direct or indirect mode with the epoll() event handler.
+TEST_F(IfaceMgrTest, sendReceive6Epoll) {
+    // With queueing disabled, we should use direct reception.
+    data::ElementPtr queue_control =
+        makeQueueConfig(PacketQueueMgr6::DEFAULT_QUEUE_TYPE6, 500, false);
+    sendReceive6Test(queue_control, false, util::FDEventHandler::TYPE_EPOLL);
+
+    // Queuing enabled, indirection reception should work.
+    queue_control->set("enable-queue", data::Element::create(true));
+    sendReceive6Test(queue_control, true, util::FDEventHandler::TYPE_EPOLL);
+}
+
+// Verifies that basic DHPCv4 packet send and receive operates
+// in either direct or indirect mode with the epoll() event handler.
+TEST_F(IfaceMgrTest, sendReceive4Epoll) {
+    // With queueing disabled, we should use direct reception.
+    data::ElementPtr queue_control =
+        makeQueueConfig(PacketQueueMgr4::DEFAULT_QUEUE_TYPE4, 500, false);
+    sendReceive4Test(queue_control, false, util::FDEventHandler::TYPE_EPOLL);
+
+    // Queuing enabled, indirection reception should work.
+    queue_control->set("enable-queue", data::Element::create(true));
+    sendReceive4Test(queue_control, true, util::FDEventHandler::TYPE_EPOLL);
+}
+
+#endif
+
 // Verifies that it is possible to set custom packet filter object
 // to handle sockets opening and send/receive operation.
 TEST_F(IfaceMgrTest, setPacketFilter) {
@@ -3053,6 +3581,64 @@ TEST_F(IfaceMgrTest, DeleteExternalSockets4) {
     close(secondpipe[0]);
 }
 
+#if defined (OS_LINUX)
+
+// Verifies that external sockets added and deleted between calls to
+// receive4() are watched by the epoll() event handler.
+TEST_F(IfaceMgrTest, externalSocketsEpoll4) {
+    callback_ok = false;
+    callback2_ok = false;
+
+    scoped_ptr<NakedIfaceMgr> ifacemgr(new NakedIfaceMgr());
+    ASSERT_NO_THROW(ifacemgr->setFDEventHandlerType(util::FDEventHandler::TYPE_EPOLL));
+
+    // Create first pipe and register it as extra socket
+    int pipefd[2];
+    EXPECT_TRUE(pipe(pipefd) == 0);
+    EXPECT_NO_THROW(ifacemgr->addExternalSocket(pipefd[0], my_callback));
+
+    // Nothing to read.
+    Pkt4Ptr pkt4;
+    ASSERT_NO_THROW(pkt4 = ifacemgr->receive4(RECEIVE_WAIT_MS(10)));
+    EXPECT_FALSE(callback_ok);
+    EXPECT_FALSE(pkt4);
+
+    // Register a second pipe after the first wait.
+    int secondpipe[2];
+    EXPECT_TRUE(pipe(secondpipe) == 0);
+    EXPECT_NO_THROW(ifacemgr->addExternalSocket(secondpipe[0], my_callback2));
+
+    // The new socket must be watched.
+    EXPECT_EQ(38, write(secondpipe[1], "Hi, this is a message sent over a pipe", 38));
+    ASSERT_NO_THROW(pkt4 = ifacemgr->receive4(RECEIVE_WAIT_MS(10)));
+    EXPECT_FALSE(callback_ok);
+    EXPECT_TRUE(callback2_ok);
+    EXPECT_FALSE(pkt4);
+
+    // Delete the second socket: it must no longer be watched even if it
+    // still has data to read.
+    callback2_ok = false;
+    EXPECT_NO_THROW(ifacemgr->deleteExternalSocket(secondpipe[0]));
+    ASSERT_NO_THROW(pkt4 = ifacemgr->receive4(RECEIVE_WAIT_MS(10)));
+    EXPECT_FALSE(callback_ok);
+    EXPECT_FALSE(callback2_ok);
+
+    // The first socket still works.
+    EXPECT_EQ(38, write(pipefd[1], "Hi, this is a message sent over a pipe", 38));
+    ASSERT_NO_THROW(pkt4 = ifacemgr->receive4(RECEIVE_WAIT_MS(10)));
+    EXPECT_TRUE(callback_ok);
+    EXPECT_FALSE(callback2_ok);
+
+    // close both pipe ends
+    close(pipefd[1]);
+    close(pipefd[0]);
+
+    close(secondpipe[1]);
+    close(secondpipe[0]);
+}
+
+#endif
+
 // Tests that an existing external socket that becomes invalid
 // is detected and purged, without affecting other sockets.
 // Tests uses receive4() without queuing.
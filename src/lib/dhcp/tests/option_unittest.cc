@@ -9,8 +9,12 @@
 #include <dhcp/dhcp6.h>
 #include <dhcp/libdhcp++.h>
 #include <dhcp/option.h>
+#include <dhcp/option_custom.h>
 #include <dhcp/option_int.h>
 #include <dhcp/option_space.h>
+#include <dhcp/option_string.h>
+#include <dhcp/option6_ia.h>
+#include <dhcp/option6_iaaddr.h>
 #include <exceptions/exceptions.h>
 #include <util/buffer.h>
 
@@ -18,6 +22,8 @@
 #include <boost/scoped_ptr.hpp>
 #include <gtest/gtest.h>
 
+#include <cstring>
+#include <functional>
 #include <iostream>
 #include <sstream>
 
@@ -634,4 +640,98 @@ TEST_F(OptionTest, createPayload) {
     EXPECT_EQ(buf_, option->getData());
 }
 
+// This test verifies that the wire data of an option is used to write
+// the option and that it is cleared when the option is modified.
+TEST_F(OptionTest, wireData) {
+    Option option(Option::V6, 1000, OptionBuffer(3, 1));
+    OptionUint8Ptr sub(new OptionUint8(Option::V6, 1001, 2));
+    option.addOption(sub);
+    EXPECT_FALSE(option.hasWireData());
+
+    OutputBuffer packed(0);
+    option.pack(packed);
+
+    ASSERT_NO_THROW(option.createWireData());
+    EXPECT_TRUE(option.hasWireData());
+    OutputBuffer wire(0);
+    option.toWire(wire);
+    ASSERT_EQ(packed.getLength(), wire.getLength());
+    EXPECT_EQ(0, memcmp(packed.getData(), wire.getData(), wire.getLength()));
+
+    // Modifying a sub-option invalidates the wire data of the option.
+    ASSERT_TRUE(sub->hasWireData());
+    sub->setValue(3);
+    EXPECT_FALSE(sub->hasWireData());
+    EXPECT_FALSE(option.hasWireData());
+    OutputBuffer repacked(0);
+    option.toWire(repacked);
+    ASSERT_EQ(packed.getLength(), repacked.getLength());
+    EXPECT_EQ(3, static_cast<const uint8_t*>(repacked.getData())[repacked.getLength() - 1]);
+
+    // Copies don't have the wire data.
+    option.createWireData();
+    Option copy(option);
+    EXPECT_FALSE(copy.hasWireData());
+    copy.createWireData();
+    copy = option;
+    EXPECT_FALSE(copy.hasWireData());
+
+    // The modifications of the option clear the wire data.
+    option.setData(buf_.begin(), buf_.begin() + 4);
+    EXPECT_FALSE(option.hasWireData());
+    option.createWireData();
+    option.setUint16(5);
+    EXPECT_FALSE(option.hasWireData());
+    option.createWireData();
+    option.delOption(1001);
+    EXPECT_FALSE(option.hasWireData());
+    option.createWireData();
+    option.addOption(sub);
+    EXPECT_FALSE(option.hasWireData());
+    option.createWireData();
+    option.setEncapsulatedSpace("foo");
+    EXPECT_FALSE(option.hasWireData());
+}
+
+// This test verifies that the setters of the derived option classes
+// invalidate the wire data.
+TEST_F(OptionTest, wireDataDerivedSetters) {
+    // Checks that the wire data follows a modification of the option.
+    auto check = [](const OptionPtr& option, std::function<void()> modify) {
+        ASSERT_NO_THROW(option->createWireData());
+        ASSERT_TRUE(option->hasWireData());
+        modify();
+        EXPECT_FALSE(option->hasWireData());
+        OutputBuffer packed(0);
+        option->pack(packed);
+        OutputBuffer wire(0);
+        option->toWire(wire);
+        ASSERT_EQ(packed.getLength(), wire.getLength());
+        EXPECT_EQ(0, memcmp(packed.getData(), wire.getData(), wire.getLength()));
+    };
+
+    OptionUint16Ptr uint16(new OptionUint16(Option::V6, 1000, 1));
+    check(uint16, [uint16]() { uint16->setValue(2); });
+
+    OptionStringPtr str(new OptionString(Option::V6, 1000, "foo"));
+    check(str, [str]() { str->setValue("foobar"); });
+
+    Option6IAPtr ia(new Option6IA(D6O_IA_NA, 1));
+    check(ia, [ia]() { ia->setT1(100); });
+    check(ia, [ia]() { ia->setT2(200); });
+
+    Option6IAAddrPtr iaaddr(new Option6IAAddr(D6O_IAADDR,
+                                              asiolink::IOAddress("2001:db8::1"),
+                                              300, 400));
+    check(iaaddr, [iaaddr]() { iaaddr->setValid(500); });
+
+    // The IA has an address: modifying the address invalidates the IA.
+    ia->addOption(iaaddr);
+    check(ia, [iaaddr]() { iaaddr->setPreferred(600); });
+
+    OptionDefinition def("foo", 1000, "uint32");
+    OptionCustomPtr custom(new OptionCustom(def, Option::V6));
+    check(custom, [custom]() { custom->writeInteger<uint32_t>(1234); });
+}
+
 }
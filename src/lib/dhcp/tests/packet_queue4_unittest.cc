@@ -6,12 +6,18 @@
 
 #include <config.h>
 
+#include <dhcp/packet_queue_lockfree.h>
+#include <dhcp/packet_queue_priority.h>
 #include <dhcp/packet_queue_ring.h>
 #include <dhcp/tests/packet_queue_testutils.h>
 
 #include <boost/shared_ptr.hpp>
 #include <gtest/gtest.h>
 
+#include <set>
+#include <thread>
+#include <vector>
+
 using namespace std;
 using namespace isc;
 using namespace isc::dhcp;
@@ -291,4 +297,265 @@ TEST(TestQueue4, eatPacketsTest) {
     EXPECT_EQ(2, q.getSize());
 }
 
+// Verifies use of the generic PacketQueue interface to
+// construct a lock-free queue implementation.
+TEST(PacketQueueLockFreeRing4, interfaceBasics) {
+    // Verify we can create a queue
+    PacketQueue4Ptr q(new PacketQueueLockFreeRing4("kea-ring4-lockfree", 100));
+    ASSERT_TRUE(q);
+
+    // It should be empty.
+    EXPECT_TRUE(q->empty());
+
+    // Type should match.
+    EXPECT_EQ("kea-ring4-lockfree", q->getQueueType());
+
+    // Fetch the queue info and verify it has all the expected values.
+    checkInfo(q, "{ \"capacity\": 100, \"queue-type\": \"kea-ring4-lockfree\", \"size\": 0 }");
+
+    // A capacity below the minimum is rejected.
+    EXPECT_THROW(PacketQueueLockFreeRing4("kea-ring4-lockfree", 4), BadValue);
+}
+
+// Verifies queueing and dequeueing from the lock-free ring buffer,
+// including when it wraps and when it overflows.
+TEST(PacketQueueLockFreeRing4, enqueueDequeueTest) {
+    PacketQueue4Ptr q(new PacketQueueLockFreeRing4("kea-ring4-lockfree", 5));
+    SocketInfo sock1(isc::asiolink::IOAddress("127.0.0.1"), 777, 10);
+
+    // Enqueue seven packets.  The first two should be pushed off.
+    for (int i = 1; i < 8; ++i) {
+        Pkt4Ptr pkt(new Pkt4(DHCPDISCOVER, 1000+i));
+        ASSERT_NO_THROW(q->enqueuePacket(pkt, sock1));
+    }
+    checkInfo(q, "{ \"capacity\": 5, \"queue-type\": \"kea-ring4-lockfree\", \"size\": 5 }");
+
+    // We should have transids 1003 to 1007.
+    Pkt4Ptr pkt;
+    for (int i = 3; i < 8; ++i) {
+        ASSERT_NO_THROW(pkt = q->dequeuePacket());
+        ASSERT_TRUE(pkt);
+        EXPECT_EQ(1000 + i, pkt->getTransid());
+    }
+
+    // Queue should be empty.
+    ASSERT_TRUE(q->empty());
+
+    // Dequeuing should fail safely, with an empty return.
+    ASSERT_NO_THROW(pkt = q->dequeuePacket());
+    ASSERT_FALSE(pkt);
+
+    // Several laps around the ring keep the order.
+    for (int i = 0; i < 20; ++i) {
+        Pkt4Ptr pkt(new Pkt4(DHCPDISCOVER, 2000+i));
+        ASSERT_NO_THROW(q->enqueuePacket(pkt, sock1));
+        Pkt4Ptr out;
+        ASSERT_NO_THROW(out = q->dequeuePacket());
+        ASSERT_TRUE(out);
+        EXPECT_EQ(2000 + i, out->getTransid());
+    }
+
+    // Enqueue three more packets and flush the buffer.
+    for (int i = 0; i < 3; ++i) {
+        Pkt4Ptr pkt(new Pkt4(DHCPDISCOVER, 1000+i));
+        ASSERT_NO_THROW(q->enqueuePacket(pkt, sock1));
+    }
+    checkIntStat(q, "size", 3);
+    q->clear();
+    EXPECT_TRUE(q->empty());
+    checkIntStat(q, "size", 0);
+}
+
+// Verifies that packets enqueued by several threads are all dequeued
+// once, in order for each producer.
+TEST(PacketQueueLockFreeRing4, concurrentProducers) {
+    const int producers = 4;
+    const int count = 10000;
+    PacketQueueLockFreeRing4 q("kea-ring4-lockfree", 64);
+    SocketInfo sock1(isc::asiolink::IOAddress("127.0.0.1"), 777, 10);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.push_back(std::thread([&q, &sock1, p, count]() {
+            for (int i = 0; i < count; ++i) {
+                Pkt4Ptr pkt(new Pkt4(DHCPDISCOVER, p * count + i));
+                q.enqueuePacket(pkt, sock1);
+            }
+        }));
+    }
+
+    // Consume concurrently.  Packets may be dropped when the queue is
+    // full but those received from a producer must be in order.
+    std::vector<int> last(producers, -1);
+    std::set<uint32_t> seen;
+    bool in_order = true;
+    size_t done = 0;
+    while (true) {
+        Pkt4Ptr pkt = q.dequeuePacket();
+        if (!pkt) {
+            if (done == threads.size()) {
+                break;
+            }
+            // Join the producers once they have finished.
+            done = 0;
+            for (auto& thread : threads) {
+                if (thread.joinable()) {
+                    thread.join();
+                }
+                ++done;
+            }
+            continue;
+        }
+        uint32_t transid = pkt->getTransid();
+        EXPECT_TRUE(seen.insert(transid).second);
+        int p = transid / count;
+        int i = transid % count;
+        ASSERT_LT(p, producers);
+        if (i <= last[p]) {
+            in_order = false;
+        }
+        last[p] = i;
+    }
+    EXPECT_TRUE(in_order);
+    EXPECT_FALSE(seen.empty());
+    EXPECT_TRUE(q.empty());
+}
+
+/// @brief Makes a raw DHCPv4 packet as received from the wire.
+///
+/// @param type message type.
+/// @param transid transaction id.
+/// @param mac last byte of the client hardware address.
+/// @return A packet which is not unpacked.
+Pkt4Ptr makeRawPkt4(uint8_t type, uint32_t transid, uint8_t mac) {
+    Pkt4 pkt(type, transid);
+    std::vector<uint8_t> hwaddr(6, 0);
+    hwaddr[5] = mac;
+    pkt.setHWAddr(HTYPE_ETHER, 6, hwaddr);
+    pkt.pack();
+    const isc::util::OutputBuffer& buf = pkt.getBuffer();
+    Pkt4Ptr raw(new Pkt4(static_cast<const uint8_t*>(buf.getData()),
+                         buf.getLength()));
+    // The transaction id is only known after unpacking: set it to track
+    // the packet.
+    raw->setTransid(transid);
+    return (raw);
+}
+
+// Verifies the classification of raw DHCPv4 packets.
+TEST(PacketQueuePriority4, classify) {
+    PacketQueuePriority4 q("kea-priority4", 10);
+    std::string key;
+    EXPECT_EQ(PacketQueuePriority4::LANE_HIGH,
+              q.classify(makeRawPkt4(DHCPREQUEST, 1, 1), key));
+    EXPECT_FALSE(key.empty());
+    EXPECT_EQ(PacketQueuePriority4::LANE_NORMAL,
+              q.classify(makeRawPkt4(DHCPDISCOVER, 2, 1), key));
+    EXPECT_EQ(PacketQueuePriority4::LANE_LOW,
+              q.classify(makeRawPkt4(DHCPINFORM, 3, 1), key));
+
+    // Malformed packets go to the normal lane without a key.
+    Pkt4Ptr runt(new Pkt4(DHCPREQUEST, 4));
+    EXPECT_EQ(PacketQueuePriority4::LANE_NORMAL, q.classify(runt, key));
+    EXPECT_TRUE(key.empty());
+}
+
+// Verifies that packets are dequeued by priority and that the queue
+// drops the lowest priority packets when it is full.
+TEST(PacketQueuePriority4, priorityAndOverflow) {
+    PacketQueue4Ptr q(new PacketQueuePriority4("kea-priority4", 5));
+    SocketInfo sock1(isc::asiolink::IOAddress("127.0.0.1"), 777, 10);
+
+    checkIntStat(q, "capacity", 5);
+    checkIntStat(q, "max-age", 0);
+
+    // Fill the queue with DISCOVERs and INFORMs.
+    q->enqueuePacket(makeRawPkt4(DHCPDISCOVER, 1, 1), sock1);
+    q->enqueuePacket(makeRawPkt4(DHCPINFORM, 2, 2), sock1);
+    q->enqueuePacket(makeRawPkt4(DHCPDISCOVER, 3, 3), sock1);
+    q->enqueuePacket(makeRawPkt4(DHCPINFORM, 4, 4), sock1);
+    q->enqueuePacket(makeRawPkt4(DHCPDISCOVER, 5, 5), sock1);
+    checkIntStat(q, "size", 5);
+
+    // REQUESTs push out the INFORMs, then the oldest DISCOVER.
+    q->enqueuePacket(makeRawPkt4(DHCPREQUEST, 6, 6), sock1);
+    q->enqueuePacket(makeRawPkt4(DHCPREQUEST, 7, 7), sock1);
+    q->enqueuePacket(makeRawPkt4(DHCPREQUEST, 8, 8), sock1);
+    checkIntStat(q, "size", 5);
+
+    // An INFORM is dropped as everything queued has a higher priority.
+    q->enqueuePacket(makeRawPkt4(DHCPINFORM, 9, 9), sock1);
+
+    data::ElementPtr info = q->getInfo();
+    data::ConstElementPtr lanes = info->get("lanes");
+    ASSERT_TRUE(lanes);
+    EXPECT_EQ(3, lanes->get("high")->get("size")->intValue());
+    EXPECT_EQ(2, lanes->get("normal")->get("size")->intValue());
+    EXPECT_EQ(1, lanes->get("normal")->get("dropped-overflow")->intValue());
+    EXPECT_EQ(0, lanes->get("low")->get("size")->intValue());
+    EXPECT_EQ(3, lanes->get("low")->get("dropped-overflow")->intValue());
+
+    // REQUESTs come first, then the DISCOVERs.
+    const uint32_t expected[] = { 6, 7, 8, 3, 5 };
+    for (auto transid : expected) {
+        Pkt4Ptr pkt = q->dequeuePacket();
+        ASSERT_TRUE(pkt);
+        EXPECT_EQ(transid, pkt->getTransid());
+    }
+    EXPECT_TRUE(q->empty());
+    EXPECT_FALSE(q->dequeuePacket());
+}
+
+// Verifies that client retransmissions are dropped and reported to
+// the drop callback.
+TEST(PacketQueuePriority4, duplicates) {
+    PacketQueuePriority4 q("kea-priority4", 10);
+    SocketInfo sock1(isc::asiolink::IOAddress("127.0.0.1"), 777, 10);
+    uint64_t drops[PacketQueuePriority4::LANE_COUNT] = { 0, 0, 0 };
+    q.setDropCallback([&drops](PacketQueuePriority4::Lane lane, uint64_t count) {
+        drops[lane] += count;
+    });
+
+    q.enqueuePacket(makeRawPkt4(DHCPREQUEST, 1, 1), sock1);
+    q.enqueuePacket(makeRawPkt4(DHCPREQUEST, 2, 1), sock1);
+    // Another message type or client is not a duplicate.
+    q.enqueuePacket(makeRawPkt4(DHCPDISCOVER, 3, 1), sock1);
+    q.enqueuePacket(makeRawPkt4(DHCPREQUEST, 4, 2), sock1);
+    EXPECT_EQ(3, q.getSize());
+
+    Pkt4Ptr pkt = q.dequeuePacket();
+    ASSERT_TRUE(pkt);
+    EXPECT_EQ(1, pkt->getTransid());
+    EXPECT_EQ(1, drops[PacketQueuePriority4::LANE_HIGH]);
+
+    // Once dequeued, the client may send again.
+    q.enqueuePacket(makeRawPkt4(DHCPREQUEST, 5, 1), sock1);
+    EXPECT_EQ(3, q.getSize());
+    EXPECT_EQ(1, q.getInfo()->get("lanes")->get("high")->
+              get("dropped-duplicate")->intValue());
+}
+
+// Verifies that packets which waited too long are dropped.
+TEST(PacketQueuePriority4, maxAge) {
+    PacketQueuePriority4 q("kea-priority4", 10, 100);
+    SocketInfo sock1(isc::asiolink::IOAddress("127.0.0.1"), 777, 10);
+
+    Pkt4Ptr old_pkt = makeRawPkt4(DHCPDISCOVER, 1, 1);
+    boost::posix_time::ptime timestamp = old_pkt->getTimestamp() -
+        boost::posix_time::milliseconds(500);
+    old_pkt->setTimestamp(timestamp);
+    q.enqueuePacket(old_pkt, sock1);
+    q.enqueuePacket(makeRawPkt4(DHCPDISCOVER, 2, 2), sock1);
+
+    Pkt4Ptr pkt = q.dequeuePacket();
+    ASSERT_TRUE(pkt);
+    EXPECT_EQ(2, pkt->getTransid());
+    EXPECT_TRUE(q.empty());
+    EXPECT_EQ(1, q.getInfo()->get("lanes")->get("normal")->
+              get("dropped-age")->intValue());
+
+    // A capacity below the minimum is rejected.
+    EXPECT_THROW(PacketQueuePriority4("kea-priority4", 4), BadValue);
+}
+
 } // end of anonymous namespace
@@ -7,12 +7,18 @@
 #include <config.h>
 
 #include <dhcp/dhcp6.h>
+#include <dhcp/packet_queue_lockfree.h>
+#include <dhcp/packet_queue_priority.h>
 #include <dhcp/packet_queue_ring.h>
 #include <dhcp/tests/packet_queue_testutils.h>
 
 #include <boost/shared_ptr.hpp>
 #include <gtest/gtest.h>
 
+#include <set>
+#include <thread>
+#include <vector>
+
 using namespace std;
 using namespace isc;
 using namespace isc::dhcp;
@@ -292,4 +298,229 @@ TEST(TestQueue6, eatPacketsTest) {
     EXPECT_EQ(2, q.getSize());
 }
 
+// Verifies use of the generic PacketQueue interface to
+// construct a lock-free queue implementation.
+TEST(PacketQueueLockFreeRing6, interfaceBasics) {
+    // Verify we can create a queue
+    PacketQueue6Ptr q(new PacketQueueLockFreeRing6("kea-ring6-lockfree", 100));
+    ASSERT_TRUE(q);
+
+    // It should be empty.
+    EXPECT_TRUE(q->empty());
+
+    // Type should match.
+    EXPECT_EQ("kea-ring6-lockfree", q->getQueueType());
+
+    // Fetch the queue info and verify it has all the expected values.
+    checkInfo(q, "{ \"capacity\": 100, \"queue-type\": \"kea-ring6-lockfree\", \"size\": 0 }");
+
+    // A capacity below the minimum is rejected.
+    EXPECT_THROW(PacketQueueLockFreeRing6("kea-ring6-lockfree", 4), BadValue);
+}
+
+// Verifies queueing and dequeueing from the lock-free ring buffer,
+// including when it wraps and when it overflows.
+TEST(PacketQueueLockFreeRing6, enqueueDequeueTest) {
+    PacketQueue6Ptr q(new PacketQueueLockFreeRing6("kea-ring6-lockfree", 5));
+    SocketInfo sock1(isc::asiolink::IOAddress("127.0.0.1"), 777, 10);
+
+    // Enqueue seven packets.  The first two should be pushed off.
+    for (int i = 1; i < 8; ++i) {
+        Pkt6Ptr pkt(new Pkt6(DHCPV6_SOLICIT, 1000+i));
+        ASSERT_NO_THROW(q->enqueuePacket(pkt, sock1));
+    }
+    checkInfo(q, "{ \"capacity\": 5, \"queue-type\": \"kea-ring6-lockfree\", \"size\": 5 }");
+
+    // We should have transids 1003 to 1007.
+    Pkt6Ptr pkt;
+    for (int i = 3; i < 8; ++i) {
+        ASSERT_NO_THROW(pkt = q->dequeuePacket());
+        ASSERT_TRUE(pkt);
+        EXPECT_EQ(1000 + i, pkt->getTransid());
+    }
+
+    // Queue should be empty.
+    ASSERT_TRUE(q->empty());
+
+    // Dequeuing should fail safely, with an empty return.
+    ASSERT_NO_THROW(pkt = q->dequeuePacket());
+    ASSERT_FALSE(pkt);
+
+    // Several laps around the ring keep the order.
+    for (int i = 0; i < 20; ++i) {
+        Pkt6Ptr pkt(new Pkt6(DHCPV6_SOLICIT, 2000+i));
+        ASSERT_NO_THROW(q->enqueuePacket(pkt, sock1));
+        Pkt6Ptr out;
+        ASSERT_NO_THROW(out = q->dequeuePacket());
+        ASSERT_TRUE(out);
+        EXPECT_EQ(2000 + i, out->getTransid());
+    }
+
+    // Enqueue three more packets and flush the buffer.
+    for (int i = 0; i < 3; ++i) {
+        Pkt6Ptr pkt(new Pkt6(DHCPV6_SOLICIT, 1000+i));
+        ASSERT_NO_THROW(q->enqueuePacket(pkt, sock1));
+    }
+    checkIntStat(q, "size", 3);
+    q->clear();
+    EXPECT_TRUE(q->empty());
+    checkIntStat(q, "size", 0);
+}
+
+// Verifies that packets enqueued by several threads are all dequeued
+// once, in order for each producer.
+TEST(PacketQueueLockFreeRing6, concurrentProducers) {
+    const int producers = 4;
+    const int count = 10000;
+    PacketQueueLockFreeRing6 q("kea-ring6-lockfree", 64);
+    SocketInfo sock1(isc::asiolink::IOAddress("127.0.0.1"), 777, 10);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.push_back(std::thread([&q, &sock1, p, count]() {
+            for (int i = 0; i < count; ++i) {
+                Pkt6Ptr pkt(new Pkt6(DHCPV6_SOLICIT, p * count + i));
+                q.enqueuePacket(pkt, sock1);
+            }
+        }));
+    }
+
+    // Consume concurrently.  Packets may be dropped when the queue is
+    // full but those received from a producer must be in order.
+    std::vector<int> last(producers, -1);
+    std::set<uint32_t> seen;
+    bool in_order = true;
+    size_t done = 0;
+    while (true) {
+        Pkt6Ptr pkt = q.dequeuePacket();
+        if (!pkt) {
+            if (done == threads.size()) {
+                break;
+            }
+            // Join the producers once they have finished.
+            done = 0;
+            for (auto& thread : threads) {
+                if (thread.joinable()) {
+                    thread.join();
+                }
+                ++done;
+            }
+            continue;
+        }
+        uint32_t transid = pkt->getTransid();
+        EXPECT_TRUE(seen.insert(transid).second);
+        int p = transid / count;
+        int i = transid % count;
+        ASSERT_LT(p, producers);
+        if (i <= last[p]) {
+            in_order = false;
+        }
+        last[p] = i;
+    }
+    EXPECT_TRUE(in_order);
+    EXPECT_FALSE(seen.empty());
+    EXPECT_TRUE(q.empty());
+}
+
+/// @brief Makes a raw DHCPv6 packet as received from the wire.
+///
+/// @param type message type.
+/// @param transid transaction id.
+/// @param duid last byte of the client DUID.
+/// @param relayed when true the packet is encapsulated in a RELAY-FORW.
+/// @return A packet which is not unpacked.
+Pkt6Ptr makeRawPkt6(uint8_t type, uint32_t transid, uint8_t duid,
+                    bool relayed = false) {
+    Pkt6 pkt(type, transid);
+    OptionBuffer client_id(8, 1);
+    client_id[7] = duid;
+    pkt.addOption(OptionPtr(new Option(Option::V6, D6O_CLIENTID, client_id)));
+    pkt.pack();
+    const isc::util::OutputBuffer& buf = pkt.getBuffer();
+    const uint8_t* data = static_cast<const uint8_t*>(buf.getData());
+    std::vector<uint8_t> wire(data, data + buf.getLength());
+    if (relayed) {
+        // Relay header: type, hop count, link and peer addresses,
+        // followed by the relay message option.
+        std::vector<uint8_t> relay(Pkt6::DHCPV6_RELAY_HDR_LEN, 0);
+        relay[0] = DHCPV6_RELAY_FORW;
+        relay.push_back(D6O_RELAY_MSG >> 8);
+        relay.push_back(D6O_RELAY_MSG & 0xff);
+        relay.push_back(wire.size() >> 8);
+        relay.push_back(wire.size() & 0xff);
+        relay.insert(relay.end(), wire.begin(), wire.end());
+        wire.swap(relay);
+    }
+    Pkt6Ptr raw(new Pkt6(&wire[0], wire.size()));
+    // The transaction id is only known after unpacking: set it to track
+    // the packet.
+    raw->setTransid(transid);
+    return (raw);
+}
+
+// Verifies the classification of raw DHCPv6 packets.
+TEST(PacketQueuePriority6, classify) {
+    PacketQueuePriority6 q("kea-priority6", 10);
+    std::string key;
+    EXPECT_EQ(PacketQueuePriority6::LANE_HIGH,
+              q.classify(makeRawPkt6(DHCPV6_RENEW, 1, 1), key));
+    EXPECT_FALSE(key.empty());
+    EXPECT_EQ(PacketQueuePriority6::LANE_NORMAL,
+              q.classify(makeRawPkt6(DHCPV6_SOLICIT, 2, 1), key));
+    EXPECT_EQ(PacketQueuePriority6::LANE_LOW,
+              q.classify(makeRawPkt6(DHCPV6_INFORMATION_REQUEST, 3, 1), key));
+
+    // Relayed packets are classified by the client message.
+    std::string relayed_key;
+    EXPECT_EQ(PacketQueuePriority6::LANE_HIGH,
+              q.classify(makeRawPkt6(DHCPV6_REQUEST, 4, 1, true), relayed_key));
+    EXPECT_EQ(PacketQueuePriority6::LANE_HIGH,
+              q.classify(makeRawPkt6(DHCPV6_REQUEST, 5, 1), key));
+    EXPECT_EQ(key, relayed_key);
+
+    // Malformed packets go to the normal lane without a key.
+    Pkt6Ptr runt(new Pkt6(DHCPV6_RENEW, 6));
+    EXPECT_EQ(PacketQueuePriority6::LANE_NORMAL, q.classify(runt, key));
+    EXPECT_TRUE(key.empty());
+}
+
+// Verifies that packets are dequeued by priority, that the queue drops
+// the lowest priority packets when it is full and that client
+// retransmissions are dropped.
+TEST(PacketQueuePriority6, priorityAndDrops) {
+    PacketQueue6Ptr q(new PacketQueuePriority6("kea-priority6", 5));
+    SocketInfo sock1(isc::asiolink::IOAddress("::1"), 777, 10);
+
+    q->enqueuePacket(makeRawPkt6(DHCPV6_SOLICIT, 1, 1), sock1);
+    q->enqueuePacket(makeRawPkt6(DHCPV6_INFORMATION_REQUEST, 2, 2), sock1);
+    q->enqueuePacket(makeRawPkt6(DHCPV6_SOLICIT, 3, 3), sock1);
+    q->enqueuePacket(makeRawPkt6(DHCPV6_SOLICIT, 4, 4), sock1);
+    q->enqueuePacket(makeRawPkt6(DHCPV6_SOLICIT, 5, 5), sock1);
+
+    // A retransmitted SOLICIT is dropped.
+    q->enqueuePacket(makeRawPkt6(DHCPV6_SOLICIT, 6, 3), sock1);
+    checkIntStat(q, "size", 5);
+
+    // RENEWs push out the INFORMATION-REQUEST then the oldest SOLICIT.
+    q->enqueuePacket(makeRawPkt6(DHCPV6_RENEW, 7, 7), sock1);
+    q->enqueuePacket(makeRawPkt6(DHCPV6_RENEW, 8, 8, true), sock1);
+    checkIntStat(q, "size", 5);
+
+    data::ConstElementPtr lanes = q->getInfo()->get("lanes");
+    ASSERT_TRUE(lanes);
+    EXPECT_EQ(2, lanes->get("high")->get("size")->intValue());
+    EXPECT_EQ(3, lanes->get("normal")->get("size")->intValue());
+    EXPECT_EQ(1, lanes->get("normal")->get("dropped-overflow")->intValue());
+    EXPECT_EQ(1, lanes->get("normal")->get("dropped-duplicate")->intValue());
+    EXPECT_EQ(1, lanes->get("low")->get("dropped-overflow")->intValue());
+
+    const uint32_t expected[] = { 7, 8, 3, 4, 5 };
+    for (auto transid : expected) {
+        Pkt6Ptr pkt = q->dequeuePacket();
+        ASSERT_TRUE(pkt);
+        EXPECT_EQ(transid, pkt->getTransid());
+    }
+    EXPECT_TRUE(q->empty());
+}
+
 } // end of anonymous namespace
@@ -6,6 +6,8 @@
 
 #include <config.h>
 
+#include <dhcp/packet_queue_lockfree.h>
+#include <dhcp/packet_queue_priority.h>
 #include <dhcp/packet_queue_ring.h>
 #include <dhcp/packet_queue_mgr6.h>
 #include <dhcp/tests/packet_queue_testutils.h>
@@ -101,6 +103,37 @@ TEST_F(PacketQueueMgr6Test, defaultQueue) {
                       << default_queue_type_ << "\", \"size\": 0 }");
 }
 
+// Verifies that DHCPv6 PQM provides a lock-free queue factory
+TEST_F(PacketQueueMgr6Test, lockFreeQueue) {
+    data::ConstElementPtr config =
+        makeQueueConfig(PacketQueueMgr6::LOCKFREE_QUEUE_TYPE6, 2000);
+    ASSERT_NO_THROW(mgr().createPacketQueue(config));
+    PacketQueue6Ptr queue = mgr().getPacketQueue();
+    ASSERT_TRUE(queue);
+    EXPECT_TRUE(boost::dynamic_pointer_cast<PacketQueueLockFreeRing6>(queue));
+    checkMyInfo("{ \"capacity\": 2000, \"queue-type\": \"kea-ring6-lockfree\", \"size\": 0 }");
+}
+
+// Verifies that DHCPv6 PQM provides a priority queue factory
+TEST_F(PacketQueueMgr6Test, priorityQueue) {
+    data::ElementPtr config =
+        makeQueueConfig(PacketQueueMgr6::PRIORITY_QUEUE_TYPE6, 2000);
+    config->set("max-age", data::Element::create(250));
+    ASSERT_NO_THROW(mgr().createPacketQueue(config));
+    PacketQueue6Ptr queue = mgr().getPacketQueue();
+    ASSERT_TRUE(queue);
+    boost::shared_ptr<PacketQueuePriority6> priority_queue =
+        boost::dynamic_pointer_cast<PacketQueuePriority6>(queue);
+    ASSERT_TRUE(priority_queue);
+    EXPECT_EQ(2000, priority_queue->getCapacity());
+    EXPECT_EQ(250, priority_queue->getMaxAge());
+    checkIntStat(queue, "size", 0);
+
+    // An invalid max-age is rejected.
+    config->set("max-age", data::Element::create(-1));
+    EXPECT_THROW(mgr().createPacketQueue(config), InvalidQueueParameter);
+}
+
 // Verifies that PQM registry and creation of custome queue implementations.
 TEST_F(PacketQueueMgr6Test, customQueueType) {
 
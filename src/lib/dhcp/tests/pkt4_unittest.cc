@@ -1386,4 +1386,122 @@ TEST_F(Pkt4Test, testSkipThisOptionError) {
     EXPECT_EQ("def", opstr->getValue());
 }
 
+// Verifies that received packets recycle their memory through the
+// thread caches.
+TEST_F(Pkt4Test, threadCache) {
+    vector<uint8_t> expectedFormat = generateTestPacket2();
+    expectedFormat.push_back(0x63); // magic cookie
+    expectedFormat.push_back(0x82);
+    expectedFormat.push_back(0x53);
+    expectedFormat.push_back(0x63);
+    expectedFormat.push_back(0x35); // message-type
+    expectedFormat.push_back(0x1);
+    expectedFormat.push_back(0x1);
+
+    util::ThreadBlockCache::clear();
+    util::ThreadBufferCache::clear();
+
+    const uint8_t* storage = 0;
+    {
+        Pkt4Ptr pkt(new Pkt4(&expectedFormat[0], expectedFormat.size()));
+        ASSERT_NO_THROW(pkt->unpack());
+        EXPECT_TRUE(pkt->getOption(DHO_DHCP_MESSAGE_TYPE));
+        storage = &pkt->data_[0];
+    }
+
+    // The packet, its option and the option collection node were cached,
+    // as was the data buffer.
+    EXPECT_LE(3, util::ThreadBlockCache::getCachedBlocks());
+    EXPECT_EQ(1, util::ThreadBufferCache::getCachedBuffers());
+
+    // The next packet reuses the data buffer.
+    Pkt4Ptr pkt(new Pkt4(&expectedFormat[0], expectedFormat.size()));
+    EXPECT_EQ(storage, &pkt->data_[0]);
+    EXPECT_EQ(0, util::ThreadBufferCache::getCachedBuffers());
+    ASSERT_NO_THROW(pkt->unpack());
+    EXPECT_EQ(DHCPDISCOVER, pkt->getType());
+}
+
+// Verifies that lazily unpacked options are unpacked on first access and
+// give the same packet as eagerly unpacked options.
+TEST_F(Pkt4Test, lazyUnpack) {
+    vector<uint8_t> expectedFormat = generateTestPacket2();
+    expectedFormat.push_back(0x63); // magic cookie
+    expectedFormat.push_back(0x82);
+    expectedFormat.push_back(0x53);
+    expectedFormat.push_back(0x63);
+    for (size_t i = 0; i < sizeof(v4_opts); i++) {
+        expectedFormat.push_back(v4_opts[i]);
+    }
+    // Vendor specific information, which unpacking is deferred.
+    expectedFormat.push_back(DHO_VENDOR_ENCAPSULATED_OPTIONS);
+    expectedFormat.push_back(2);
+    expectedFormat.push_back(1);
+    expectedFormat.push_back(0);
+    expectedFormat.push_back(DHO_END);
+
+    Pkt4Ptr eager(new Pkt4(&expectedFormat[0], expectedFormat.size()));
+    ASSERT_NO_THROW(eager->unpack());
+    ASSERT_NO_THROW(eager->pack());
+
+    Pkt4Ptr pkt(new Pkt4(&expectedFormat[0], expectedFormat.size()));
+    EXPECT_FALSE(pkt->getLazyUnpack());
+    pkt->setLazyUnpack(true);
+    ASSERT_NO_THROW(pkt->unpack());
+
+    // Nothing was unpacked but the deferred options are known.
+    EXPECT_TRUE(pkt->hasLazyOptions());
+    EXPECT_TRUE(pkt->options_.empty());
+    // The reserved option 254 is deferred too.
+    ASSERT_EQ(2, pkt->getDeferredOptions().size());
+    EXPECT_EQ(254, pkt->getDeferredOptions().front());
+    EXPECT_EQ(DHO_VENDOR_ENCAPSULATED_OPTIONS, pkt->getDeferredOptions().back());
+
+    // Getting the message type only unpacks this option.
+    EXPECT_EQ(DHCPOFFER, pkt->getType());
+    EXPECT_EQ(1, pkt->options_.size());
+    EXPECT_TRUE(pkt->hasLazyOptions());
+
+    verifyParsedOptions(pkt);
+    EXPECT_FALSE(pkt->getOption(127)); // no such option
+
+    // Packing the packet unpacks the remaining options.
+    ASSERT_NO_THROW(pkt->pack());
+    EXPECT_FALSE(pkt->hasLazyOptions());
+    EXPECT_EQ(eager->options_.size(), pkt->options_.size());
+    ASSERT_EQ(eager->getBuffer().getLength(), pkt->getBuffer().getLength());
+    EXPECT_EQ(0, memcmp(eager->getBuffer().getData(),
+                        pkt->getBuffer().getData(),
+                        pkt->getBuffer().getLength()));
+}
+
+// Verifies that a lazily unpacked option which can't be parsed is
+// reported on first access.
+TEST_F(Pkt4Test, lazyUnpackMalformed) {
+    vector<uint8_t> orig = generateTestPacket2();
+    orig.push_back(0x63); // magic cookie
+    orig.push_back(0x82);
+    orig.push_back(0x53);
+    orig.push_back(0x63);
+    orig.push_back(DHO_DHCP_MESSAGE_TYPE);
+    orig.push_back(1);
+    orig.push_back(DHCPDISCOVER);
+    // The subnet mask is an IPv4 address: 2 bytes are not enough.
+    orig.push_back(DHO_SUBNET_MASK);
+    orig.push_back(2);
+    orig.push_back(255);
+    orig.push_back(255);
+    // A truncated option is ignored as when unpacking eagerly.
+    orig.push_back(DHO_HOST_NAME);
+    orig.push_back(10);
+    orig.push_back('a');
+
+    Pkt4Ptr pkt(new Pkt4(&orig[0], orig.size()));
+    pkt->setLazyUnpack(true);
+    ASSERT_NO_THROW(pkt->unpack());
+    EXPECT_EQ(DHCPDISCOVER, pkt->getType());
+    EXPECT_FALSE(pkt->getOption(DHO_HOST_NAME));
+    EXPECT_THROW(pkt->getOption(DHO_SUBNET_MASK), isc::Exception);
+}
+
 } // end of anonymous namespace
@@ -509,12 +509,12 @@ TEST_F(Pkt6Test, getOptions) {
     // Make sure that the first option is returned. We're using the pointer
     // to opt1 to find the option.
     opt_it = std::find(options.begin(), options.end(),
-                       std::pair<const unsigned int, OptionPtr>(1, opt1));
+                       OptionCollection::value_type(1, opt1));
     EXPECT_TRUE(opt_it != options.end());
 
     // Make sure that the second option is returned.
     opt_it = std::find(options.begin(), options.end(),
-                       std::pair<const unsigned int, OptionPtr>(1, opt2));
+                       OptionCollection::value_type(1, opt2));
     EXPECT_TRUE(opt_it != options.end());
 
     // Retrieve options with option code 2.
@@ -522,11 +522,11 @@ TEST_F(Pkt6Test, getOptions) {
 
     // opt3 and opt4 should exist.
     opt_it = std::find(options.begin(), options.end(),
-                       std::pair<const unsigned int, OptionPtr>(2, opt3));
+                       OptionCollection::value_type(2, opt3));
     EXPECT_TRUE(opt_it != options.end());
 
     opt_it = std::find(options.begin(), options.end(),
-                       std::pair<const unsigned int, OptionPtr>(2, opt4));
+                       OptionCollection::value_type(2, opt4));
     EXPECT_TRUE(opt_it != options.end());
 
     // Enable copying options when they are retrieved.
@@ -539,11 +539,11 @@ TEST_F(Pkt6Test, getOptions) {
     // using option pointer should fail. Original pointers should have
     // been replaced with new instances.
     opt_it = std::find(options.begin(), options.end(),
-                       std::pair<const unsigned int, OptionPtr>(1, opt1));
+                       OptionCollection::value_type(1, opt1));
     EXPECT_TRUE(opt_it == options.end());
 
     opt_it = std::find(options.begin(), options.end(),
-                       std::pair<const unsigned int, OptionPtr>(1, opt2));
+                       OptionCollection::value_type(1, opt2));
     EXPECT_TRUE(opt_it == options.end());
 
     // Return instances of options with the option code 1 and make sure
@@ -562,11 +562,11 @@ TEST_F(Pkt6Test, getOptions) {
     ASSERT_EQ(2, options.size());
 
     opt_it = std::find(options.begin(), options.end(),
-                       std::pair<const unsigned int, OptionPtr>(2, opt3));
+                       OptionCollection::value_type(2, opt3));
     EXPECT_TRUE(opt_it != options.end());
 
     opt_it = std::find(options.begin(), options.end(),
-                       std::pair<const unsigned int, OptionPtr>(2, opt4));
+                       OptionCollection::value_type(2, opt4));
     EXPECT_TRUE(opt_it != options.end());
 }
 
@@ -2057,4 +2057,43 @@ TEST_F(Pkt6Test, relayDataOption) {
     EXPECT_EQ(orig_data, clone_data);
 }
 
+
+// Verifies that lazily unpacked options are unpacked on first access and
+// give the same packet as eagerly unpacked options.
+TEST_F(Pkt6Test, lazyUnpack) {
+    Pkt6Ptr eager(capture2());
+    ASSERT_NO_THROW(eager->unpack());
+    ASSERT_NO_THROW(eager->pack());
+
+    Pkt6Ptr msg(capture2());
+    EXPECT_FALSE(msg->getLazyUnpack());
+    msg->setLazyUnpack(true);
+    ASSERT_NO_THROW(msg->unpack());
+
+    // The relay options are unpacked, the options of the message are not.
+    EXPECT_EQ(DHCPV6_SOLICIT, msg->getType());
+    ASSERT_EQ(2, msg->relay_info_.size());
+    EXPECT_TRUE(msg->getRelayOption(D6O_INTERFACE_ID, 0));
+    EXPECT_TRUE(msg->hasLazyOptions());
+    EXPECT_TRUE(msg->options_.empty());
+
+    // Getting an option only unpacks the options of its code.
+    EXPECT_TRUE(msg->getOption(D6O_CLIENTID));
+    EXPECT_EQ(1, msg->options_.size());
+    EXPECT_EQ(eager->getOptions(D6O_IA_NA).size(),
+              msg->getOptions(D6O_IA_NA).size());
+    EXPECT_FALSE(msg->getOption(D6O_IA_PD));
+    EXPECT_TRUE(msg->hasLazyOptions());
+
+    // The length and the packing need all options.
+    EXPECT_EQ(217, msg->len());
+    EXPECT_FALSE(msg->hasLazyOptions());
+    EXPECT_EQ(eager->options_.size(), msg->options_.size());
+    ASSERT_NO_THROW(msg->pack());
+    ASSERT_EQ(eager->getBuffer().getLength(), msg->getBuffer().getLength());
+    EXPECT_EQ(0, memcmp(eager->getBuffer().getData(),
+                        msg->getBuffer().getData(),
+                        msg->getBuffer().getLength()));
+}
+
 }
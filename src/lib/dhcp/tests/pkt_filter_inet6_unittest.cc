@@ -131,4 +131,71 @@ TEST_F(PktFilterInet6Test, receive) {
     testRcvdMessage(rcvd_pkt);
     }
 
+// This test verifies that several DHCPv6 packets are received at once
+// via INET6 datagram socket.
+TEST_F(PktFilterInet6Test, receiveBatch) {
+
+    // Packets will be received over loopback interface.
+    Iface iface(ifname_, ifindex_);
+    IOAddress addr("::1");
+
+    // Create an instance of the class which we are testing.
+    PktFilterInet6 pkt_filter;
+    sock_info_ = pkt_filter.openSocket(iface, addr, PORT + 1, true);
+    ASSERT_GE(sock_info_.sockfd_, 0);
+
+    // Send three DHCPv6 messages to the local loopback address and
+    // server's port.
+    for (int i = 0; i < 3; ++i) {
+        sendMessage();
+    }
+
+    // Receive the packets. The batch is larger than the number of
+    // queued packets so all of them should be returned.
+    Pkt6Collection rcvd_pkts = pkt_filter.receiveBatch(sock_info_, 10);
+    ASSERT_EQ(3, rcvd_pkts.size());
+
+    for (auto rcvd_pkt : rcvd_pkts) {
+        ASSERT_TRUE(rcvd_pkt);
+        ASSERT_NO_THROW(rcvd_pkt->unpack());
+        testRcvdMessage(rcvd_pkt);
+    }
+
+    // There is nothing more to read so an empty collection is returned.
+    rcvd_pkts = pkt_filter.receiveBatch(sock_info_, 10);
+    EXPECT_TRUE(rcvd_pkts.empty());
+}
+
+// This test verifies that the buffers used to receive a batch of DHCPv6
+// packets are reused by the following batches of the socket.
+TEST_F(PktFilterInet6Test, receiveBatchReuse) {
+
+    // Packets will be received over loopback interface.
+    Iface iface(ifname_, ifindex_);
+    IOAddress addr("::1");
+
+    // Create an instance of the class which we are testing.
+    PktFilterInet6 pkt_filter;
+    sock_info_ = pkt_filter.openSocket(iface, addr, PORT + 1, true);
+    ASSERT_GE(sock_info_.sockfd_, 0);
+
+    // Each round receives a batch of a different size, with the same
+    // buffers. The received addresses and the control messages must be
+    // fully written each time.
+    for (int round = 1; round <= 3; ++round) {
+        for (int i = 0; i < round; ++i) {
+            sendMessage();
+        }
+
+        Pkt6Collection rcvd_pkts = pkt_filter.receiveBatch(sock_info_, 10);
+        ASSERT_EQ(round, rcvd_pkts.size());
+
+        for (auto rcvd_pkt : rcvd_pkts) {
+            ASSERT_TRUE(rcvd_pkt);
+            ASSERT_NO_THROW(rcvd_pkt->unpack());
+            testRcvdMessage(rcvd_pkt);
+        }
+    }
+}
+
 } // anonymous namespace
@@ -145,4 +145,73 @@ TEST_F(PktFilterInetTest, receive) {
     testRcvdMessageAddressPort(rcvd_pkt);
 }
 
+// This test verifies that several DHCPv4 packets are received at once
+// via INET datagram socket.
+TEST_F(PktFilterInetTest, receiveBatch) {
+
+    // Packets will be received over loopback interface.
+    Iface iface(ifname_, ifindex_);
+    IOAddress addr("127.0.0.1");
+
+    // Create an instance of the class which we are testing.
+    PktFilterInet pkt_filter;
+    sock_info_ = pkt_filter.openSocket(iface, addr, PORT, false, false);
+    ASSERT_GE(sock_info_.sockfd_, 0);
+
+    // Send three DHCPv4 messages to the local loopback address and
+    // server's port.
+    for (int i = 0; i < 3; ++i) {
+        sendMessage();
+    }
+
+    // Receive the packets. The batch is larger than the number of
+    // queued packets so all of them should be returned.
+    Pkt4Collection rcvd_pkts = pkt_filter.receiveBatch(iface, sock_info_, 10);
+    ASSERT_EQ(3, rcvd_pkts.size());
+
+    for (auto rcvd_pkt : rcvd_pkts) {
+        ASSERT_TRUE(rcvd_pkt);
+        ASSERT_NO_THROW(rcvd_pkt->unpack());
+        testRcvdMessage(rcvd_pkt);
+        testRcvdMessageAddressPort(rcvd_pkt);
+    }
+
+    // There is nothing more to read so an empty collection is returned.
+    rcvd_pkts = pkt_filter.receiveBatch(iface, sock_info_, 10);
+    EXPECT_TRUE(rcvd_pkts.empty());
+}
+
+// This test verifies that the buffers used to receive a batch of DHCPv4
+// packets are reused by the following batches of the socket.
+TEST_F(PktFilterInetTest, receiveBatchReuse) {
+
+    // Packets will be received over loopback interface.
+    Iface iface(ifname_, ifindex_);
+    IOAddress addr("127.0.0.1");
+
+    // Create an instance of the class which we are testing.
+    PktFilterInet pkt_filter;
+    sock_info_ = pkt_filter.openSocket(iface, addr, PORT, false, false);
+    ASSERT_GE(sock_info_.sockfd_, 0);
+
+    // Each round receives a batch of a different size, with the same
+    // buffers. The received addresses and the control messages must be
+    // fully written each time.
+    for (int round = 1; round <= 3; ++round) {
+        for (int i = 0; i < round; ++i) {
+            sendMessage();
+        }
+
+        Pkt4Collection rcvd_pkts = pkt_filter.receiveBatch(iface, sock_info_, 10);
+        ASSERT_EQ(round, rcvd_pkts.size());
+
+        for (auto rcvd_pkt : rcvd_pkts) {
+            ASSERT_TRUE(rcvd_pkt);
+            ASSERT_NO_THROW(rcvd_pkt->unpack());
+            testRcvdMessage(rcvd_pkt);
+            testRcvdMessageAddressPort(rcvd_pkt);
+        }
+    }
+}
+
 } // anonymous namespace
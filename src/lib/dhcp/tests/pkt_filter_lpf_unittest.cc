@@ -1,4 +1,4 @@
-// Copyright (C) 2013-2016 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2013-2021 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -18,6 +18,8 @@
 #include <linux/if_packet.h>
 #include <sys/socket.h>
 
+#include <set>
+
 using namespace isc::asiolink;
 using namespace isc::dhcp;
 using namespace isc::util;
@@ -35,6 +37,30 @@ class PktFilterLPFTest : public isc::dhcp::test::PktFilterTest {
 public:
     PktFilterLPFTest() : PktFilterTest(PORT) {
     }
+
+    /// @brief Waits until the socket under test is ready to read.
+    ///
+    /// @param timeout_sec timeout in seconds.
+    /// @return true if the socket is ready, false on timeout.
+    bool waitForData(const long timeout_sec = 5) {
+        return (waitForSocket(sock_info_.sockfd_, timeout_sec));
+    }
+
+    /// @brief Waits until a socket is ready to read.
+    ///
+    /// @param sockfd socket descriptor.
+    /// @param timeout_sec timeout in seconds.
+    /// @return true if the socket is ready, false on timeout.
+    bool waitForSocket(const int sockfd, const long timeout_sec) {
+        fd_set readfds;
+        FD_ZERO(&readfds);
+        FD_SET(sockfd, &readfds);
+
+        struct timeval timeout;
+        timeout.tv_sec = timeout_sec;
+        timeout.tv_usec = 0;
+        return (select(sockfd + 1, &readfds, NULL, NULL, &timeout) > 0);
+    }
 };
 
 // This test verifies that the PktFilterLPF class reports its capability
@@ -46,6 +72,16 @@ TEST_F(PktFilterLPFTest, isDirectResponseSupported) {
     EXPECT_TRUE(pkt_filter.isDirectResponseSupported());
 }
 
+// This test verifies that the memory mapped receive ring is only used
+// when requested.
+TEST_F(PktFilterLPFTest, isRingEnabled) {
+    PktFilterLPF pkt_filter;
+    EXPECT_FALSE(pkt_filter.isRingEnabled());
+
+    PktFilterLPF ring_filter(true);
+    EXPECT_TRUE(ring_filter.isRingEnabled());
+}
+
 // All tests below require root privileges to execute successfully. If
 // they are run as non-root user they will fail due to insufficient privileges
 // to open raw network sockets. Therefore, they should remain disabled by default
@@ -219,4 +255,135 @@ TEST_F(PktFilterLPFTest, DISABLED_filterOutUnicast) {
     ASSERT_LE(result, 0);
 }
 
+// This test verifies that the raw socket is switched to TPACKET_V3 when
+// the memory mapped receive ring is enabled.
+TEST_F(PktFilterLPFTest, DISABLED_openSocketRing) {
+    Iface iface(ifname_, ifindex_);
+    IOAddress addr("127.0.0.1");
+
+    PktFilterLPF pkt_filter(true);
+    sock_info_ = pkt_filter.openSocket(iface, addr, PORT, false, false);
+    ASSERT_GE(sock_info_.sockfd_, 0);
+    ASSERT_GE(sock_info_.fallbackfd_, 0);
+
+    int version = 0;
+    socklen_t version_len = sizeof(version);
+    ASSERT_EQ(0, getsockopt(sock_info_.sockfd_, SOL_PACKET, PACKET_VERSION,
+                            &version, &version_len));
+    EXPECT_EQ(TPACKET_V3, version);
+
+    // Reopening a socket once the previous one is closed must work even
+    // if the descriptor is reused.
+    close(sock_info_.sockfd_);
+    close(sock_info_.fallbackfd_);
+    sock_info_ = pkt_filter.openSocket(iface, addr, PORT, false, false);
+    ASSERT_GE(sock_info_.sockfd_, 0);
+}
+
+// This test verifies correctness of reception of the DHCP packet from
+// the memory mapped receive ring.
+TEST_F(PktFilterLPFTest, DISABLED_receiveRing) {
+    Iface iface(ifname_, ifindex_);
+    IOAddress addr("127.0.0.1");
+
+    PktFilterLPF pkt_filter(true);
+    sock_info_ = pkt_filter.openSocket(iface, addr, PORT, false, false);
+    ASSERT_GE(sock_info_.sockfd_, 0);
+
+    // Nothing has been received yet.
+    EXPECT_FALSE(pkt_filter.receive(iface, sock_info_));
+
+    // Send DHCPv4 message to the local loopback address and server's port.
+    sendMessage();
+
+    // The frame is available once the kernel has passed its block.
+    ASSERT_TRUE(waitForData());
+    Pkt4Ptr rcvd_pkt = pkt_filter.receive(iface, sock_info_);
+    ASSERT_TRUE(rcvd_pkt);
+
+    // Parse the packet.
+    ASSERT_NO_THROW(rcvd_pkt->unpack());
+
+    // Check if the received message is correct.
+    testRcvdMessage(rcvd_pkt);
+    testRcvdMessageAddressPort(rcvd_pkt);
+}
+
+// This test verifies that a batch of packets is sent and received using
+// the memory mapped receive ring.
+TEST_F(PktFilterLPFTest, DISABLED_sendReceiveBatchRing) {
+    Iface iface(ifname_, ifindex_);
+    IOAddress addr("127.0.0.1");
+
+    PktFilterLPF pkt_filter(true);
+    sock_info_ = pkt_filter.openSocket(iface, addr, PORT, false, false);
+    ASSERT_GE(sock_info_.sockfd_, 0);
+
+    // Send several copies of the test message.
+    const size_t count = 4;
+    for (size_t i = 0; i < count; ++i) {
+        ASSERT_NO_THROW(pkt_filter.send(iface, sock_info_.sockfd_,
+                                        test_message_));
+    }
+
+    // Get them back, possibly from several blocks.
+    Pkt4Collection rcvd_pkts;
+    while ((rcvd_pkts.size() < count) && waitForData()) {
+        Pkt4Collection batch = pkt_filter.receiveBatch(iface, sock_info_,
+                                                       count);
+        ASSERT_LE(batch.size(), count);
+        rcvd_pkts.insert(rcvd_pkts.end(), batch.begin(), batch.end());
+    }
+    ASSERT_GE(rcvd_pkts.size(), count);
+
+    for (auto rcvd_pkt : rcvd_pkts) {
+        ASSERT_NO_THROW(rcvd_pkt->unpack());
+        testRcvdMessage(rcvd_pkt);
+    }
+}
+
+// This test verifies that the frames are spread over the shards of a
+// socket according to the client hardware address.
+TEST_F(PktFilterLPFTest, DISABLED_openSocketShards) {
+    Iface iface(ifname_, ifindex_);
+    IOAddress addr("127.0.0.1");
+
+    PktFilterLPF pkt_filter;
+    const size_t shards = 2;
+    std::vector<SocketInfo> sockets;
+    ASSERT_NO_THROW(sockets = pkt_filter.openSocketShards(iface, addr, PORT,
+                                                          false, false,
+                                                          shards));
+    ASSERT_EQ(shards, sockets.size());
+    // The fixture closes the first shard and its fallback socket.
+    sock_info_ = sockets[0];
+    ASSERT_GE(sockets[0].fallbackfd_, 0);
+    EXPECT_LT(sockets[1].fallbackfd_, 0);
+
+    // Send messages from four clients.
+    for (uint8_t client = 0; client < 4; ++client) {
+        std::vector<uint8_t> mac = { 0, 1, 2, 3, 4, client };
+        test_message_->setHWAddr(HTYPE_ETHER, mac.size(), mac);
+        ASSERT_NO_THROW(test_message_->pack());
+        sendMessage();
+    }
+
+    // Each shard receives the messages of its clients.
+    for (size_t shard = 0; shard < shards; ++shard) {
+        SCOPED_TRACE("shard " + std::to_string(shard));
+        std::set<uint8_t> clients;
+        while (waitForSocket(sockets[shard].sockfd_, 1)) {
+            Pkt4Ptr rcvd_pkt = pkt_filter.receive(iface, sockets[shard]);
+            ASSERT_TRUE(rcvd_pkt);
+            ASSERT_NO_THROW(rcvd_pkt->unpack());
+            uint8_t client = rcvd_pkt->getHWAddr()->hwaddr_[5];
+            EXPECT_EQ(shard, client % shards);
+            clients.insert(client);
+        }
+        EXPECT_EQ(2, clients.size());
+    }
+
+    close(sockets[1].sockfd_);
+}
+
 } // anonymous namespace
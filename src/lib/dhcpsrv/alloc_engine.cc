@@ -6,6 +6,7 @@
 
 #include <config.h>
 
+#include <asiolink/addr_utilities.h>
 #include <dhcp/dhcp6.h>
 #include <dhcp/pkt4.h>
 #include <dhcp/pkt6.h>
@@ -27,6 +28,7 @@
 #include <dhcpsrv/callout_handle_store.h>
 #include <stats/stats_mgr.h>
 #include <util/encode/hex.h>
+#include <util/hash.h>
 #include <util/stopwatch.h>
 #include <hooks/server_hooks.h>
 #include <hooks/hooks_manager.h>
@@ -35,8 +37,10 @@
 #include <boost/make_shared.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <limits>
+#include <random>
 #include <sstream>
 #include <stdint.h>
 #include <string.h>
@@ -86,13 +90,183 @@ struct AllocEngineHooks {
 // module is called.
 AllocEngineHooks Hooks;
 
+/// @brief Updates the assigned leases counter of the pool of a lease.
+///
+/// The subnet is looked up in the current configuration as the lease
+/// may belong to another subnet than the one selected for the client.
+///
+/// @param lease the lease.
+/// @param delta the change of the number of assigned leases.
+void
+updatePoolAssigned(const Lease4Ptr& lease, int64_t delta) {
+    CfgMgr::instance().getCurrentCfg()->getCfgSubnets4()->
+        updatePoolAssigned(lease->subnet_id_, lease->addr_, delta);
+}
+
+/// @brief Updates the assigned leases counter of the pool of a lease.
+///
+/// @param lease the lease.
+/// @param delta the change of the number of assigned leases.
+void
+updatePoolAssigned(const Lease6Ptr& lease, int64_t delta) {
+    CfgMgr::instance().getCurrentCfg()->getCfgSubnets6()->
+        updatePoolAssigned(lease->subnet_id_, lease->type_, lease->addr_, delta);
+}
+
+/// @brief Updates or deletes a reclaimed lease in the lease database.
+///
+/// @param lease the reclaimed lease.
+/// @param remove_lease true if the lease is deleted.
+void
+writeReclaimedLease(const Lease4Ptr& lease, const bool remove_lease) {
+    LeaseMgr& lease_mgr = LeaseMgrFactory::instance();
+    if (remove_lease) {
+        lease_mgr.deleteLease(lease);
+    } else {
+        lease_mgr.updateLease4(lease);
+    }
+}
+
+/// @brief Updates or deletes a reclaimed lease in the lease database.
+///
+/// @param lease the reclaimed lease.
+/// @param remove_lease true if the lease is deleted.
+void
+writeReclaimedLease(const Lease6Ptr& lease, const bool remove_lease) {
+    LeaseMgr& lease_mgr = LeaseMgrFactory::instance();
+    if (remove_lease) {
+        lease_mgr.deleteLease(lease);
+    } else {
+        lease_mgr.updateLease6(lease);
+    }
+}
+
+/// @brief Updates and deletes a batch of reclaimed leases in the lease
+/// database.
+///
+/// @param updated_leases the leases to be updated.
+/// @param deleted_leases the leases to be deleted.
+void
+writeReclaimedLeases(const Lease4Collection& updated_leases,
+                     const Lease4Collection& deleted_leases) {
+    LeaseMgrFactory::instance().updateLeases4(updated_leases, deleted_leases);
+}
+
+/// @brief Updates and deletes a batch of reclaimed leases in the lease
+/// database.
+///
+/// @param updated_leases the leases to be updated.
+/// @param deleted_leases the leases to be deleted.
+void
+writeReclaimedLeases(const Lease6Collection& updated_leases,
+                     const Lease6Collection& deleted_leases) {
+    LeaseMgrFactory::instance().updateLeases6(updated_leases, deleted_leases);
+}
+
+/// @brief Logs the failure to reclaim a lease.
+///
+/// @param lease the lease.
+/// @param error the reason of the failure.
+void
+logReclamationFailure(const Lease4Ptr& lease, const std::string& error) {
+    LOG_ERROR(alloc_engine_logger, ALLOC_ENGINE_V4_LEASE_RECLAMATION_FAILED)
+        .arg(lease->addr_.toText())
+        .arg(error);
+}
+
+/// @brief Logs the failure to reclaim a lease.
+///
+/// @param lease the lease.
+/// @param error the reason of the failure.
+void
+logReclamationFailure(const Lease6Ptr& lease, const std::string& error) {
+    LOG_ERROR(alloc_engine_logger, ALLOC_ENGINE_V6_LEASE_RECLAMATION_FAILED)
+        .arg(lease->addr_.toText())
+        .arg(error);
+}
+
+/// @brief Walk over the subnets of a shared network for an allocation.
+///
+/// The subnets which pools are exhausted according to the pool free
+/// leases counters are skipped by the walk over the subnets and tried
+/// at its end. So the allocation does not waste attempts in exhausted
+/// subnets and still succeeds when the counters are off, e.g. after
+/// changes of the lease database by another server, or when all free
+/// leases of the subnet are expired leases not yet reclaimed.
+///
+/// @tparam SubnetPtrType type of the pointer to the subnets.
+template<typename SubnetPtrType>
+class AllocationSubnets {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// @param first_subnet the subnet the walk starts from.
+    AllocationSubnets(const SubnetPtrType& first_subnet)
+        : first_subnet_(first_subnet), skipping_(true), skipped_(),
+          next_skipped_(0) {
+    }
+
+    /// @brief Checks if a subnet must be tried later.
+    ///
+    /// @param subnet the subnet.
+    /// @param type the lease type.
+    /// @param classes the client classes.
+    /// @return true if the subnet must be skipped now.
+    bool skip(const SubnetPtrType& subnet, Lease::Type type,
+              const ClientClasses& classes) {
+        if (skipping_ && (subnet->getPoolFree(type, classes) == 0)) {
+            skipped_.push_back(subnet);
+            return (true);
+        }
+        return (false);
+    }
+
+    /// @brief Returns the next subnet to try.
+    ///
+    /// @param subnet the current subnet.
+    /// @param classes the client classes.
+    /// @return the next subnet or null at the end of the walk.
+    SubnetPtrType next(const SubnetPtrType& subnet,
+                       const ClientClasses& classes) {
+        if (skipping_) {
+            SubnetPtrType next_subnet = subnet->getNextSubnet(first_subnet_,
+                                                              classes);
+            if (next_subnet) {
+                return (next_subnet);
+            }
+            skipping_ = false;
+        }
+        if (next_skipped_ < skipped_.size()) {
+            return (skipped_[next_skipped_++]);
+        }
+        return (SubnetPtrType());
+    }
+
+private:
+
+    /// @brief The subnet the walk starts from.
+    SubnetPtrType first_subnet_;
+
+    /// @brief True until all subnets were visited once.
+    bool skipping_;
+
+    /// @brief The skipped subnets.
+    std::vector<SubnetPtrType> skipped_;
+
+    /// @brief Index of the next skipped subnet to try.
+    size_t next_skipped_;
+};
+
 }  // namespace
 
 namespace isc {
 namespace dhcp {
 
+const size_t AllocEngine::IterativeAllocator::SUBNET_MUTEXES;
+
 AllocEngine::IterativeAllocator::IterativeAllocator(Lease::Type lease_type)
-    : Allocator(lease_type) {
+    : Allocator(lease_type), subnet_mutexes_() {
 }
 
 isc::asiolink::IOAddress
@@ -288,73 +462,384 @@ AllocEngine::IterativeAllocator::pickAddressInternal(const SubnetPtr& subnet,
 }
 
 AllocEngine::HashedAllocator::HashedAllocator(Lease::Type lease_type)
-    : Allocator(lease_type) {
-    isc_throw(NotImplemented, "Hashed allocator is not implemented");
+    : IterativeAllocator(lease_type) {
+}
+
+PoolCollection
+AllocEngine::HashedAllocator::rankPools(const SubnetPtr& subnet,
+                                        const ClientClasses& client_classes,
+                                        const DuidPtr& duid) const {
+    // Score each allowed pool with the hash of the identifier followed
+    // by the first address of the pool.
+    std::vector<uint8_t> key = duid->getDuid();
+    size_t duid_len = key.size();
+    std::vector<std::pair<uint64_t, PoolPtr> > scored;
+    for (auto pool : subnet->getPools(pool_type_)) {
+        if (!pool->clientSupported(client_classes)) {
+            continue;
+        }
+        const std::vector<uint8_t>& first = pool->getFirstAddress().toBytes();
+        key.resize(duid_len);
+        key.insert(key.end(), first.begin(), first.end());
+        scored.push_back(std::make_pair(Hash64::hash(&key[0], key.size()), pool));
+    }
+
+    // The best ranked pool has the highest score.
+    std::stable_sort(scored.begin(), scored.end(),
+                     [](const std::pair<uint64_t, PoolPtr>& a,
+                        const std::pair<uint64_t, PoolPtr>& b) {
+                         return (a.first > b.first);
+                     });
+    PoolCollection ranked;
+    for (auto const& score : scored) {
+        ranked.push_back(score.second);
+    }
+    return (ranked);
+}
+
+IOAddress
+AllocEngine::HashedAllocator::getPoolSlot(const PoolPtr& pool,
+                                          const DuidPtr& duid) const {
+    uint64_t capacity = pool->getCapacity();
+    if (capacity == 0) {
+        return (pool->getFirstAddress());
+    }
+    const std::vector<uint8_t>& id = duid->getDuid();
+    uint64_t index = Hash64::hash(&id[0], id.size()) % capacity;
+    if (pool_type_ == Lease::TYPE_PD) {
+        Pool6Ptr pool6 = boost::dynamic_pointer_cast<Pool6>(pool);
+        if (!pool6) {
+            // Something is gravely wrong here
+            isc_throw(Unexpected, "Wrong type of pool: " << pool->toText()
+                      << " is not Pool6");
+        }
+        return (offsetPrefix(pool->getFirstAddress(), index, pool6->getLength()));
+    }
+    return (offsetAddress(pool->getFirstAddress(), index));
+}
+
+IOAddress
+AllocEngine::HashedAllocator::getPreferredAddress(const SubnetPtr& subnet,
+                                                  const ClientClasses& client_classes,
+                                                  const DuidPtr& duid) const {
+    PoolCollection ranked = rankPools(subnet, client_classes, duid);
+    if (ranked.empty()) {
+        return (pool_type_ == Lease::TYPE_V4 ?
+                IOAddress::IPV4_ZERO_ADDRESS() : IOAddress::IPV6_ZERO_ADDRESS());
+    }
+    return (getPoolSlot(ranked.front(), duid));
 }
 
 isc::asiolink::IOAddress
-AllocEngine::HashedAllocator::pickAddressInternal(const SubnetPtr&,
-                                                  const ClientClasses&,
-                                                  const DuidPtr&,
-                                                  const IOAddress&) {
-    isc_throw(NotImplemented, "Hashed allocator is not implemented");
+AllocEngine::HashedAllocator::pickAddressInternal(const SubnetPtr& subnet,
+                                                  const ClientClasses& client_classes,
+                                                  const DuidPtr& duid,
+                                                  const IOAddress& hint) {
+    // Clients without identifier are served as by the iterative allocator.
+    if (!duid) {
+        return (IterativeAllocator::pickAddressInternal(subnet, client_classes,
+                                                        duid, hint));
+    }
+
+    if (subnet->getPools(pool_type_).empty()) {
+        isc_throw(AllocFailed, "No pools defined in selected subnet");
+    }
+    PoolCollection ranked = rankPools(subnet, client_classes, duid);
+    if (ranked.empty()) {
+        isc_throw(AllocFailed, "No allowed pools defined in selected subnet");
+    }
+
+    // Find the pool of the previously picked address.
+    size_t rank = 0;
+    for (; rank < ranked.size(); ++rank) {
+        if (ranked[rank]->inRange(hint)) {
+            break;
+        }
+    }
+
+    // First pick: the preferred address.
+    if (rank == ranked.size()) {
+        return (getPoolSlot(ranked.front(), duid));
+    }
+
+    // Probe the next address of the pool, wrapping around at its end.
+    // When the whole pool was probed go to the next pool.
+    const PoolPtr& pool = ranked[rank];
+    bool prefix = pool_type_ == Lease::TYPE_PD;
+    uint8_t prefix_len = 0;
+    if (prefix) {
+        Pool6Ptr pool6 = boost::dynamic_pointer_cast<Pool6>(pool);
+        if (!pool6) {
+            // Something is gravely wrong here
+            isc_throw(Unexpected, "Wrong type of pool: " << pool->toText()
+                      << " is not Pool6");
+        }
+        prefix_len = pool6->getLength();
+    }
+    IOAddress next = IOAddress::IPV4_ZERO_ADDRESS();
+    if (hint == pool->getLastAddress()) {
+        next = pool->getFirstAddress();
+    } else {
+        next = increaseAddress(hint, prefix, prefix_len);
+        if (!pool->inRange(next)) {
+            next = pool->getFirstAddress();
+        }
+    }
+    if (next == getPoolSlot(pool, duid)) {
+        return (getPoolSlot(ranked[(rank + 1) % ranked.size()], duid));
+    }
+    return (next);
 }
 
 AllocEngine::RandomAllocator::RandomAllocator(Lease::Type lease_type)
     : Allocator(lease_type) {
-    isc_throw(NotImplemented, "Random allocator is not implemented");
 }
 
 isc::asiolink::IOAddress
-AllocEngine::RandomAllocator::pickAddressInternal(const SubnetPtr&,
-                                                  const ClientClasses&,
+AllocEngine::RandomAllocator::pickAddressInternal(const SubnetPtr& subnet,
+                                                  const ClientClasses& client_classes,
                                                   const DuidPtr&,
                                                   const IOAddress&) {
-    isc_throw(NotImplemented, "Random allocator is not implemented");
+    const PoolCollection& pools = subnet->getPools(pool_type_);
+    if (pools.empty()) {
+        isc_throw(AllocFailed, "No pools defined in selected subnet");
+    }
+
+    // Count the pools allowed for the client classes.
+    uint64_t allowed = 0;
+    for (auto pool : pools) {
+        if (pool->clientSupported(client_classes)) {
+            ++allowed;
+        }
+    }
+    if (allowed == 0) {
+        isc_throw(AllocFailed, "No allowed pools defined in selected subnet");
+    }
+
+    // Each thread uses its own generator so picking a pool doesn't
+    // require a lock.
+    thread_local std::mt19937 generator(std::random_device{}());
+    std::uniform_int_distribution<uint64_t> dist(0, allowed - 1);
+    uint64_t pick = dist(generator);
+    for (auto pool : pools) {
+        if (pool->clientSupported(client_classes)) {
+            if (pick == 0) {
+                return (pool->nextRandom());
+            }
+            --pick;
+        }
+    }
+
+    // Not reached: the picked pool is one of the allowed pools.
+    isc_throw(Unexpected, "random allocator failed to pick a pool");
+}
+
+const uint64_t AllocEngine::FreeLeaseQueueAllocator::MAX_QUEUED_CAPACITY;
+
+AllocEngine::FreeLeaseQueueAllocator::FreeLeaseQueueAllocator(Lease::Type lease_type)
+    : IterativeAllocator(lease_type), queue_() {
+}
+
+void
+AllocEngine::FreeLeaseQueueAllocator::clear() {
+    queue_ = FreeLeaseQueue();
+}
+
+void
+AllocEngine::FreeLeaseQueueAllocator::populate(const SubnetPtr& subnet,
+                                               const std::set<IOAddress>& used) {
+    bool prefix = pool_type_ == Lease::TYPE_PD;
+    for (auto pool : subnet->getPools(pool_type_)) {
+        // Large pools are not queued, addresses are picked as by the
+        // iterative allocator instead.
+        uint64_t capacity = pool->getCapacity();
+        if ((capacity == 0) || (capacity > MAX_QUEUED_CAPACITY)) {
+            continue;
+        }
+        uint8_t prefix_len = 128;
+        uint64_t range_index = 0;
+        try {
+            if (prefix) {
+                Pool6Ptr pool6 = boost::dynamic_pointer_cast<Pool6>(pool);
+                if (!pool6) {
+                    continue;
+                }
+                prefix_len = pool6->getLength();
+                PrefixRange range(pool->getFirstAddress(),
+                                  pool->getLastAddress(), prefix_len);
+                queue_.addRange(range);
+                range_index = queue_.getRangeIndex(range);
+            } else {
+                AddressRange range(pool->getFirstAddress(),
+                                   pool->getLastAddress());
+                queue_.addRange(range);
+                range_index = queue_.getRangeIndex(range);
+            }
+        } catch (const std::exception&) {
+            // The pool overlaps with a queued pool: it is not queued.
+            continue;
+        }
+        fillRange(pool, range_index, prefix_len, used);
+    }
+}
+
+void
+AllocEngine::FreeLeaseQueueAllocator::refill(const Subnet& subnet) {
+    if (MultiThreadingMgr::instance().getMode()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refillInternal(subnet);
+    } else {
+        refillInternal(subnet);
+    }
+}
+
+void
+AllocEngine::FreeLeaseQueueAllocator::fillRange(const PoolPtr& pool,
+                                                const uint64_t range_index,
+                                                const uint8_t prefix_len,
+                                                const std::set<IOAddress>& used) {
+    bool prefix = pool_type_ == Lease::TYPE_PD;
+    uint64_t capacity = pool->getCapacity();
+    IOAddress address = pool->getFirstAddress();
+    for (uint64_t i = 0; i < capacity; ++i) {
+        if (used.count(address) == 0) {
+            queue_.append(range_index, address);
+        }
+        if (i + 1 < capacity) {
+            address = increaseAddress(address, prefix, prefix_len);
+        }
+    }
+}
+
+void
+AllocEngine::FreeLeaseQueueAllocator::refillInternal(const Subnet& subnet) {
+    bool prefix = pool_type_ == Lease::TYPE_PD;
+    for (auto pool : subnet.getPools(pool_type_)) {
+        uint8_t prefix_len = 128;
+        uint64_t range_index = 0;
+        if (prefix) {
+            Pool6Ptr pool6 = boost::dynamic_pointer_cast<Pool6>(pool);
+            if (!pool6) {
+                continue;
+            }
+            prefix_len = pool6->getLength();
+            PrefixRange range(pool->getFirstAddress(),
+                              pool->getLastAddress(), prefix_len);
+            if (!queue_.hasRange(range)) {
+                continue;
+            }
+            range_index = queue_.getRangeIndex(range);
+        } else {
+            AddressRange range(pool->getFirstAddress(),
+                               pool->getLastAddress());
+            if (!queue_.hasRange(range)) {
+                continue;
+            }
+            range_index = queue_.getRangeIndex(range);
+        }
+        // The queue ignores the addresses it already holds.
+        fillRange(pool, range_index, prefix_len, std::set<IOAddress>());
+    }
+}
+
+isc::asiolink::IOAddress
+AllocEngine::FreeLeaseQueueAllocator::pickAddressInternal(const SubnetPtr& subnet,
+                                                          const ClientClasses& client_classes,
+                                                          const DuidPtr& duid,
+                                                          const IOAddress& hint) {
+    bool prefix = pool_type_ == Lease::TYPE_PD;
+    bool iterate = false;
+    for (auto pool : subnet->getPools(pool_type_)) {
+        if (!pool->clientSupported(client_classes)) {
+            continue;
+        }
+        IOAddress candidate = IOAddress::IPV6_ZERO_ADDRESS();
+        if (prefix) {
+            Pool6Ptr pool6 = boost::dynamic_pointer_cast<Pool6>(pool);
+            PrefixRange range(pool->getFirstAddress(), pool->getLastAddress(),
+                              pool6 ? pool6->getLength() : 128);
+            if (!queue_.hasRange(range)) {
+                iterate = true;
+                continue;
+            }
+            candidate = queue_.next(range);
+        } else {
+            AddressRange range(pool->getFirstAddress(), pool->getLastAddress());
+            if (!queue_.hasRange(range)) {
+                iterate = true;
+                continue;
+            }
+            candidate = queue_.next(range);
+        }
+        if (!candidate.isV4Zero() && !candidate.isV6Zero()) {
+            return (candidate);
+        }
+    }
+    // Some allowed pools are not queued: iterate over the pools.
+    if (iterate) {
+        return (IterativeAllocator::pickAddressInternal(subnet, client_classes,
+                                                        duid, hint));
+    }
+    // The queued pools are exhausted.
+    return (pool_type_ == Lease::TYPE_V4 ?
+            IOAddress::IPV4_ZERO_ADDRESS() : IOAddress::IPV6_ZERO_ADDRESS());
+}
+
+void
+AllocEngine::FreeLeaseQueueAllocator::addressUsedInternal(const IOAddress& address,
+                                                          const uint8_t prefix_len) {
+    if (pool_type_ == Lease::TYPE_PD) {
+        queue_.use(address, prefix_len);
+    } else {
+        queue_.use(address);
+    }
+}
+
+void
+AllocEngine::FreeLeaseQueueAllocator::addressFreedInternal(const IOAddress& address,
+                                                           const uint8_t prefix_len) {
+    if (pool_type_ == Lease::TYPE_PD) {
+        queue_.append(address, prefix_len);
+    } else {
+        queue_.append(address);
+    }
 }
 
 AllocEngine::AllocEngine(AllocType engine_type, uint64_t attempts,
                          bool ipv6)
-    : attempts_(attempts), incomplete_v4_reclamations_(0),
+    : attempts_(attempts), alloc_type_(engine_type),
+      free_lease_queues_(false),
+      reclaim_batch_size_(1), reclaim_threads_(0),
+      incomplete_v4_reclamations_(0),
       incomplete_v6_reclamations_(0) {
 
-    // Choose the basic (normal address) lease type
-    Lease::Type basic_type = ipv6 ? Lease::TYPE_NA : Lease::TYPE_V4;
-
-    // Initialize normal address allocators
     switch (engine_type) {
     case ALLOC_ITERATIVE:
-        allocators_[basic_type] = AllocatorPtr(new IterativeAllocator(basic_type));
-        break;
     case ALLOC_HASHED:
-        allocators_[basic_type] = AllocatorPtr(new HashedAllocator(basic_type));
-        break;
     case ALLOC_RANDOM:
-        allocators_[basic_type] = AllocatorPtr(new RandomAllocator(basic_type));
+    case ALLOC_FLQ:
         break;
     default:
         isc_throw(BadValue, "Invalid/unsupported allocation algorithm");
     }
 
+    // Choose the basic (normal address) lease type
+    Lease::Type basic_type = ipv6 ? Lease::TYPE_NA : Lease::TYPE_V4;
+    std::vector<Lease::Type> types = { basic_type };
+
     // If this is IPv6 allocation engine, initialize also temporary addrs
     // and prefixes
     if (ipv6) {
-        switch (engine_type) {
-        case ALLOC_ITERATIVE:
-            allocators_[Lease::TYPE_TA] = AllocatorPtr(new IterativeAllocator(Lease::TYPE_TA));
-            allocators_[Lease::TYPE_PD] = AllocatorPtr(new IterativeAllocator(Lease::TYPE_PD));
-            break;
-        case ALLOC_HASHED:
-            allocators_[Lease::TYPE_TA] = AllocatorPtr(new HashedAllocator(Lease::TYPE_TA));
-            allocators_[Lease::TYPE_PD] = AllocatorPtr(new HashedAllocator(Lease::TYPE_PD));
-            break;
-        case ALLOC_RANDOM:
-            allocators_[Lease::TYPE_TA] = AllocatorPtr(new RandomAllocator(Lease::TYPE_TA));
-            allocators_[Lease::TYPE_PD] = AllocatorPtr(new RandomAllocator(Lease::TYPE_PD));
-            break;
-        default:
-            isc_throw(BadValue, "Invalid/unsupported allocation algorithm");
-        }
+        types.push_back(Lease::TYPE_TA);
+        types.push_back(Lease::TYPE_PD);
+    }
+
+    // Initialize the allocators of each type, the subnets select theirs.
+    for (auto type : types) {
+        allocators_[ALLOC_ITERATIVE][type] = AllocatorPtr(new IterativeAllocator(type));
+        allocators_[ALLOC_HASHED][type] = AllocatorPtr(new HashedAllocator(type));
+        allocators_[ALLOC_RANDOM][type] = AllocatorPtr(new RandomAllocator(type));
+        allocators_[ALLOC_FLQ][type] = AllocatorPtr(new FreeLeaseQueueAllocator(type));
     }
 
     // Register hook points
@@ -363,15 +848,161 @@ AllocEngine::AllocEngine(AllocType engine_type, uint64_t attempts,
 }
 
 AllocEngine::AllocatorPtr AllocEngine::getAllocator(Lease::Type type) {
-    std::map<Lease::Type, AllocatorPtr>::const_iterator alloc = allocators_.find(type);
+    return (getAllocator(type, alloc_type_));
+}
 
-    if (alloc == allocators_.end()) {
+AllocEngine::AllocatorPtr AllocEngine::getAllocator(Lease::Type type,
+                                                    AllocType alloc_type) {
+    auto allocators = allocators_.find(alloc_type);
+    if (allocators == allocators_.end()) {
+        isc_throw(BadValue, "Invalid/unsupported allocation algorithm");
+    }
+    std::map<Lease::Type, AllocatorPtr>::const_iterator alloc =
+        allocators->second.find(type);
+
+    if (alloc == allocators->second.end()) {
         isc_throw(BadValue, "No allocator initialized for pool type "
                   << Lease::typeToText(type));
     }
     return (alloc->second);
 }
 
+AllocEngine::AllocType
+AllocEngine::getAllocType(const SubnetPtr& subnet) const {
+    if (!subnet) {
+        return (alloc_type_);
+    }
+    util::Optional<std::string> allocator = subnet->getAllocatorType();
+    if (allocator.unspecified()) {
+        return (alloc_type_);
+    }
+    if (allocator.get() == "iterative") {
+        return (ALLOC_ITERATIVE);
+    } else if (allocator.get() == "hashed") {
+        return (ALLOC_HASHED);
+    } else if (allocator.get() == "random") {
+        return (ALLOC_RANDOM);
+    } else if (allocator.get() == "flq") {
+        return (ALLOC_FLQ);
+    }
+    // Not reached: the allocator was checked by the configuration parser.
+    return (alloc_type_);
+}
+
+void
+AllocEngine::initFreeLeaseQueues(const CfgSubnets4Ptr& subnets) {
+    boost::shared_ptr<FreeLeaseQueueAllocator> allocator =
+        boost::dynamic_pointer_cast<FreeLeaseQueueAllocator>(getAllocator(Lease::TYPE_V4,
+                                                                          ALLOC_FLQ));
+    allocator->clear();
+    free_lease_queues_ = false;
+    LeaseMgr& lease_mgr = LeaseMgrFactory::instance();
+    for (auto subnet : *subnets->getAll()) {
+        if (subnet->getPools(Lease::TYPE_V4).empty() ||
+            (getAllocType(subnet) != ALLOC_FLQ)) {
+            continue;
+        }
+        // Reclaimed leases are free, others are used.
+        std::set<IOAddress> used;
+        for (auto lease : lease_mgr.getLeases4(subnet->getID())) {
+            if (!lease->stateExpiredReclaimed()) {
+                used.insert(lease->addr_);
+            }
+        }
+        allocator->populate(subnet, used);
+        free_lease_queues_ = true;
+    }
+}
+
+void
+AllocEngine::initFreeLeaseQueues(const CfgSubnets6Ptr& subnets) {
+    const Lease::Type types[] = { Lease::TYPE_NA, Lease::TYPE_TA, Lease::TYPE_PD };
+    std::map<Lease::Type, boost::shared_ptr<FreeLeaseQueueAllocator> > allocators;
+    for (auto type : types) {
+        allocators[type] = boost::dynamic_pointer_cast<
+            FreeLeaseQueueAllocator>(getAllocator(type, ALLOC_FLQ));
+        allocators[type]->clear();
+    }
+    free_lease_queues_ = false;
+    LeaseMgr& lease_mgr = LeaseMgrFactory::instance();
+    for (auto subnet : *subnets->getAll()) {
+        if ((subnet->getPools(Lease::TYPE_NA).empty() &&
+             subnet->getPools(Lease::TYPE_TA).empty() &&
+             subnet->getPools(Lease::TYPE_PD).empty()) ||
+            (getAllocType(subnet) != ALLOC_FLQ)) {
+            continue;
+        }
+        // Reclaimed leases are free, others are used.
+        std::map<Lease::Type, std::set<IOAddress> > used;
+        for (auto lease : lease_mgr.getLeases6(subnet->getID())) {
+            if (!lease->stateExpiredReclaimed()) {
+                used[lease->type_].insert(lease->addr_);
+            }
+        }
+        for (auto type : types) {
+            allocators[type]->populate(subnet, used[type]);
+        }
+        free_lease_queues_ = true;
+    }
+}
+
+void
+AllocEngine::leaseUsed(const Lease4Ptr& lease) const {
+    if (free_lease_queues_) {
+        const std::map<Lease::Type, AllocatorPtr>& allocators = allocators_.at(ALLOC_FLQ);
+        auto allocator = allocators.find(Lease::TYPE_V4);
+        if (allocator != allocators.end()) {
+            allocator->second->addressUsed(lease->addr_, 32);
+        }
+    }
+}
+
+void
+AllocEngine::leaseUsed(const Lease6Ptr& lease) const {
+    if (free_lease_queues_) {
+        const std::map<Lease::Type, AllocatorPtr>& allocators = allocators_.at(ALLOC_FLQ);
+        auto allocator = allocators.find(lease->type_);
+        if (allocator != allocators.end()) {
+            allocator->second->addressUsed(lease->addr_, lease->prefixlen_);
+        }
+    }
+}
+
+void
+AllocEngine::leaseFreed(const Lease4Ptr& lease) const {
+    if (free_lease_queues_) {
+        const std::map<Lease::Type, AllocatorPtr>& allocators = allocators_.at(ALLOC_FLQ);
+        auto allocator = allocators.find(Lease::TYPE_V4);
+        if (allocator != allocators.end()) {
+            allocator->second->addressFreed(lease->addr_, 32);
+        }
+    }
+}
+
+void
+AllocEngine::leaseFreed(const Lease6Ptr& lease) const {
+    if (free_lease_queues_) {
+        const std::map<Lease::Type, AllocatorPtr>& allocators = allocators_.at(ALLOC_FLQ);
+        auto allocator = allocators.find(lease->type_);
+        if (allocator != allocators.end()) {
+            allocator->second->addressFreed(lease->addr_, lease->prefixlen_);
+        }
+    }
+}
+
+void
+AllocEngine::leasesWiped(const Subnet& subnet) const {
+    if (free_lease_queues_) {
+        for (auto const& allocator : allocators_.at(ALLOC_FLQ)) {
+            boost::shared_ptr<FreeLeaseQueueAllocator> flq_allocator =
+                boost::dynamic_pointer_cast<FreeLeaseQueueAllocator>(allocator.second);
+            if (flq_allocator) {
+                flq_allocator->refill(subnet);
+            }
+        }
+    }
+}
+
 } // end of namespace isc::dhcp
 } // end of namespace isc
 
@@ -447,6 +1078,54 @@ inAllowedPool(AllocEngine::ClientContext6& ctx, const Lease::Type& lease_type,
     return (false);
 }
 
+/// @brief Returns the leases of the current IA of the client.
+///
+/// When the client sends several IAs, all the leases of its DUID are
+/// fetched by the first lookup and the leases of the other IAs are then
+/// taken from them. The prefetched leases are not used when one of them
+/// is expired, as the allocation for an IA may reuse it, nor when the
+/// leases of an IA are looked up again, as they may have been updated.
+///
+/// @param ctx Client context.
+///
+/// @return Leases of the client with the type and IAID of the current IA.
+Lease6Collection
+getIALeases6(AllocEngine::ClientContext6& ctx) {
+    const AllocEngine::ClientContext6::IAContext& ia = ctx.currentIA();
+    LeaseMgr& lease_mgr = LeaseMgrFactory::instance();
+
+    bool first_lookup = ctx.looked_up_ias_.empty();
+    if (!ctx.looked_up_ias_.insert(std::make_pair(ia.type_, ia.iaid_)).second) {
+        ctx.prefetched_leases_.clear();
+        ctx.leases_prefetched_ = false;
+
+    } else if (first_lookup && ctx.query_ &&
+               ((ctx.query_->getOptions(D6O_IA_NA).size() +
+                 ctx.query_->getOptions(D6O_IA_PD).size()) > 1)) {
+        ctx.prefetched_leases_ = lease_mgr.getLeases6(*ctx.duid_);
+        ctx.leases_prefetched_ = true;
+        for (auto const& lease : ctx.prefetched_leases_) {
+            if (lease->expired()) {
+                ctx.prefetched_leases_.clear();
+                ctx.leases_prefetched_ = false;
+                break;
+            }
+        }
+    }
+
+    if (!ctx.leases_prefetched_) {
+        return (lease_mgr.getLeases6(ia.type_, *ctx.duid_, ia.iaid_));
+    }
+
+    Lease6Collection leases;
+    for (auto const& lease : ctx.prefetched_leases_) {
+        if ((lease->type_ == ia.type_) && (lease->iaid_ == ia.iaid_)) {
+            leases.push_back(lease);
+        }
+    }
+    return (leases);
+}
+
 }
 
 // ##########################################################################
@@ -460,6 +1139,7 @@ AllocEngine::ClientContext6::ClientContext6()
     : query_(), fake_allocation_(false), subnet_(), host_subnet_(), duid_(),
       hwaddr_(), host_identifiers_(), hosts_(), fwd_dns_update_(false),
       rev_dns_update_(false), hostname_(), callout_handle_(), ias_(),
+      prefetched_leases_(), leases_prefetched_(false), looked_up_ias_(),
       ddns_params_() {
 }
 
@@ -475,7 +1155,8 @@ AllocEngine::ClientContext6::ClientContext6(const Subnet6Ptr& subnet,
       duid_(duid), hwaddr_(), host_identifiers_(), hosts_(),
       fwd_dns_update_(fwd_dns), rev_dns_update_(rev_dns), hostname_(hostname),
       callout_handle_(callout_handle), allocated_resources_(), new_leases_(),
-      ias_(), ddns_params_() {
+      ias_(), prefetched_leases_(), leases_prefetched_(false),
+      looked_up_ias_(), ddns_params_() {
 
     // Initialize host identifiers.
     if (duid) {
@@ -706,10 +1387,7 @@ AllocEngine::allocateLeases6(ClientContext6& ctx) {
         // Check if there are existing leases for that shared network and
         // DUID/IAID.
         Subnet6Ptr subnet = ctx.subnet_;
-        Lease6Collection all_leases =
-            LeaseMgrFactory::instance().getLeases6(ctx.currentIA().type_,
-                                                   *ctx.duid_,
-                                                   ctx.currentIA().iaid_);
+        Lease6Collection all_leases = getIALeases6(ctx);
 
         // Iterate over the leases and eliminate those that are outside of
         // our shared network.
@@ -875,13 +1553,6 @@ AllocEngine::allocateLeases6(ClientContext6& ctx) {
 Lease6Collection
 AllocEngine::allocateUnreservedLeases6(ClientContext6& ctx) {
 
-    AllocatorPtr allocator = getAllocator(ctx.currentIA().type_);
-
-    if (!allocator) {
-        isc_throw(InvalidOperation, "No allocator specified for "
-                  << Lease6::typeToText(ctx.currentIA().type_));
-    }
-
     Lease6Collection leases;
 
     IOAddress hint = IOAddress::IPV6_ZERO_ADDRESS();
@@ -1032,7 +1703,8 @@ AllocEngine::allocateUnreservedLeases6(ClientContext6& ctx) {
 
     ctx.subnet_ = subnet = original_subnet;
 
-    for (; subnet; subnet = subnet->getNextSubnet(original_subnet)) {
+    AllocationSubnets<Subnet6Ptr> subnets(original_subnet);
+    for (; subnet; subnet = subnets.next(subnet, ctx.query_->getClasses())) {
 
         if (!subnet->clientSupported(ctx.query_->getClasses())) {
             continue;
@@ -1051,6 +1723,10 @@ AllocEngine::allocateUnreservedLeases6(ClientContext6& ctx) {
         if (possible_attempts == 0) {
             continue;
         }
+        // Try the subnet last if its pools are exhausted.
+        if (subnets.skip(subnet, ctx.currentIA().type_, ctx.query_->getClasses())) {
+            continue;
+        }
         uint64_t max_attempts = (attempts_ > 0 ? attempts_  : possible_attempts);
         bool in_subnet = subnet->getReservationsInSubnet();
         bool out_of_pool = subnet->getReservationsOutOfPool();
@@ -1062,6 +1738,12 @@ AllocEngine::allocateUnreservedLeases6(ClientContext6& ctx) {
             ctx.callout_handle_->setStatus(CalloutHandle::NEXT_STEP_CONTINUE);
         }
 
+        // Each subnet selects its allocator.
+        AllocatorPtr allocator = getAllocator(ctx.currentIA().type_,
+                                              getAllocType(subnet));
+
+        // The allocator picks the next candidate from the last one.
+        IOAddress last_candidate = IOAddress::IPV6_ZERO_ADDRESS();
         for (uint64_t i = 0; i < max_attempts; ++i) {
 
             ++total_attempts;
@@ -1069,7 +1751,12 @@ AllocEngine::allocateUnreservedLeases6(ClientContext6& ctx) {
             IOAddress candidate = allocator->pickAddress(subnet,
                                                          ctx.query_->getClasses(),
                                                          ctx.duid_,
-                                                         hint);
+                                                         last_candidate);
+            last_candidate = candidate;
+            // The allocator has no free lease in the pools of the subnet.
+            if (candidate.isV6Zero()) {
+                break;
+            }
             // The first step is to find out prefix length. It is 128 for
             // non-PD leases.
             uint8_t prefix_len = 128;
@@ -1559,6 +2246,7 @@ AllocEngine::removeNonmatchingReservedLeases6(ClientContext6& ctx,
             // properly handle dns and stats updates.
             continue;
         }
+        leaseFreed(candidate);
 
         // Update DNS if needed.
         queueNCR(CHG_REMOVE, candidate);
@@ -1569,6 +2257,7 @@ AllocEngine::removeNonmatchingReservedLeases6(ClientContext6& ctx,
                                    ctx.currentIA().type_ == Lease::TYPE_NA ?
                                    "assigned-nas" : "assigned-pds"),
             static_cast<int64_t>(-1));
+        updatePoolAssigned(candidate, -1);
 
         // In principle, we could trigger a hook here, but we will do this
         // only if we get serious complaints from actual users. We want the
@@ -1606,6 +2295,7 @@ AllocEngine::removeNonmatchingReservedNoHostLeases6(ClientContext6& ctx,
             // properly handle dns and stats updates.
             continue;
         }
+        leaseFreed(candidate);
 
         // Update DNS if needed.
         queueNCR(CHG_REMOVE, candidate);
@@ -1616,6 +2306,7 @@ AllocEngine::removeNonmatchingReservedNoHostLeases6(ClientContext6& ctx,
                                    ctx.currentIA().type_ == Lease::TYPE_NA ?
                                    "assigned-nas" : "assigned-pds"),
             static_cast<int64_t>(-1));
+        updatePoolAssigned(candidate, -1);
 
         // Add this to the list of removed leases.
         ctx.currentIA().old_leases_.push_back(candidate);
@@ -1677,6 +2368,7 @@ AllocEngine::removeNonreservedLeases6(ClientContext6& ctx,
             // properly handle dns and stats updates.
             continue;
         }
+        leaseFreed(*lease);
 
         // Update DNS if required.
         queueNCR(CHG_REMOVE, *lease);
@@ -1687,6 +2379,7 @@ AllocEngine::removeNonreservedLeases6(ClientContext6& ctx,
                                    ctx.currentIA().type_ == Lease::TYPE_NA ?
                                    "assigned-nas" : "assigned-pds"),
             static_cast<int64_t>(-1));
+        updatePoolAssigned(*lease, -1);
 
         /// @todo: Probably trigger a hook here
 
@@ -1821,6 +2514,7 @@ AllocEngine::reuseExpiredLease(Lease6Ptr& expired, ClientContext6& ctx,
 
         // for REQUEST we do update the lease
         LeaseMgrFactory::instance().updateLease6(expired);
+        leaseUsed(expired);
 
         // If the lease is in the current subnet we need to account
         // for the re-assignment of The lease.
@@ -1830,6 +2524,7 @@ AllocEngine::reuseExpiredLease(Lease6Ptr& expired, ClientContext6& ctx,
                                        ctx.currentIA().type_ == Lease::TYPE_NA ?
                                        "assigned-nas" : "assigned-pds"),
                 static_cast<int64_t>(1));
+            ctx.subnet_->updatePoolAssigned(ctx.currentIA().type_, expired->addr_, 1);
             StatsMgr::instance().addValue(
                 StatsMgr::generateName("subnet", ctx.subnet_->getID(),
                                        ctx.currentIA().type_ == Lease::TYPE_NA ?
@@ -1932,6 +2627,8 @@ Lease6Ptr AllocEngine::createLease6(ClientContext6& ctx,
         bool status = LeaseMgrFactory::instance().addLease(lease);
 
         if (status) {
+            leaseUsed(lease);
+
             // The lease insertion succeeded - if the lease is in the
             // current subnet lets bump up the statistic.
             if (ctx.subnet_->inPool(ctx.currentIA().type_, addr)) {
@@ -1940,6 +2637,7 @@ Lease6Ptr AllocEngine::createLease6(ClientContext6& ctx,
                                            ctx.currentIA().type_ == Lease::TYPE_NA ?
                                            "assigned-nas" : "assigned-pds"),
                     static_cast<int64_t>(1));
+                ctx.subnet_->updatePoolAssigned(ctx.currentIA().type_, addr, 1);
                 StatsMgr::instance().addValue(
                     StatsMgr::generateName("subnet", ctx.subnet_->getID(),
                                            ctx.currentIA().type_ == Lease::TYPE_NA ?
@@ -1980,16 +2678,18 @@ AllocEngine::renewLeases6(ClientContext6& ctx) {
             isc_throw(InvalidOperation, "DUID is mandatory for allocation");
         }
 
-        // Check if there are any leases for this client.
+        // Check if there are any leases for this client. They are fetched
+        // by one lookup and filtered by subnet, rather than one lookup for
+        // each subnet of the shared network.
         Subnet6Ptr subnet = ctx.subnet_;
+        Lease6Collection all_leases = getIALeases6(ctx);
         Lease6Collection leases;
         while (subnet) {
-            Lease6Collection leases_subnet =
-                LeaseMgrFactory::instance().getLeases6(ctx.currentIA().type_,
-                                                       *ctx.duid_,
-                                                       ctx.currentIA().iaid_,
-                                                       subnet->getID());
-            leases.insert(leases.end(), leases_subnet.begin(), leases_subnet.end());
+            for (auto const& l : all_leases) {
+                if (l->subnet_id_ == subnet->getID()) {
+                    leases.push_back(l);
+                }
+            }
 
             subnet = subnet->getNextSubnet(ctx.subnet_);
         }
@@ -2101,6 +2801,7 @@ AllocEngine::extendLease6(ClientContext6& ctx, Lease6Ptr lease) {
             // properly handle dns and stats updates.
             return;
         }
+        leaseFreed(lease);
 
         // Updated DNS if required.
         queueNCR(CHG_REMOVE, lease);
@@ -2109,6 +2810,7 @@ AllocEngine::extendLease6(ClientContext6& ctx, Lease6Ptr lease) {
         StatsMgr::instance().addValue(
             StatsMgr::generateName("subnet", ctx.subnet_->getID(), "assigned-nas"),
             static_cast<int64_t>(-1));
+        updatePoolAssigned(lease, -1);
 
         // Add it to the removed leases list.
         ctx.currentIA().old_leases_.push_back(lease);
@@ -2218,6 +2920,7 @@ AllocEngine::extendLease6(ClientContext6& ctx, Lease6Ptr lease) {
         // Now that the lease has been reclaimed, we can go ahead and update it
         // in the lease database.
         LeaseMgrFactory::instance().updateLease6(lease);
+        leaseUsed(lease);
 
         if (update_stats) {
             StatsMgr::instance().addValue(
@@ -2225,6 +2928,7 @@ AllocEngine::extendLease6(ClientContext6& ctx, Lease6Ptr lease) {
                                        ctx.currentIA().type_ == Lease::TYPE_NA ?
                                        "assigned-nas" : "assigned-pds"),
                 static_cast<int64_t>(1));
+            ctx.subnet_->updatePoolAssigned(ctx.currentIA().type_, lease->addr_, 1);
             StatsMgr::instance().addValue(
                 StatsMgr::generateName("subnet", ctx.subnet_->getID(),
                                        ctx.currentIA().type_ == Lease::TYPE_NA ?
@@ -2283,11 +2987,14 @@ AllocEngine::updateLeaseData(ClientContext6& ctx, const Lease6Collection& leases
             }
 
             if (update_stats) {
+                leaseUsed(lease);
+
                 StatsMgr::instance().addValue(
                     StatsMgr::generateName("subnet", lease->subnet_id_,
                                            ctx.currentIA().type_ == Lease::TYPE_NA ?
                                            "assigned-nas" : "assigned-pds"),
                     static_cast<int64_t>(1));
+                updatePoolAssigned(lease, 1);
                 StatsMgr::instance().addValue(
                     StatsMgr::generateName("subnet", lease->subnet_id_,
                                            ctx.currentIA().type_ == Lease::TYPE_NA ?
@@ -2349,54 +3056,25 @@ AllocEngine::reclaimExpiredLeases6(const size_t max_leases, const uint16_t timeo
         lease_mgr.getExpiredLeases6(leases, max_leases);
     }
 
-    // Do not initialize the callout handle until we know if there are any
-    // lease6_expire callouts installed.
-    CalloutHandlePtr callout_handle;
-    if (!leases.empty() &&
-        HooksManager::calloutsPresent(Hooks.hook_index_lease6_expire_)) {
-        callout_handle = HooksManager::createCalloutHandle();
-    }
-
-    size_t leases_processed = 0;
-    BOOST_FOREACH(Lease6Ptr lease, leases) {
-
-        try {
-            // Reclaim the lease.
-            if (MultiThreadingMgr::instance().getMode()) {
-                // The reclamation is exclusive of packet processing.
-                WriteLockGuard exclusive(rw_mutex_);
-
-                reclaimExpiredLease(lease, remove_lease, callout_handle);
-                ++leases_processed;
-            } else {
-                reclaimExpiredLease(lease, remove_lease, callout_handle);
-                ++leases_processed;
+    // Reclaim the leases. The timeout is checked after each batch, because
+    // we always want to allow reclaiming at least one batch.
+    bool timed_out = false;
+    size_t leases_processed = reclaimLeases(leases, remove_lease,
+                                            Hooks.hook_index_lease6_expire_,
+                                            timeout, stopwatch, timed_out);
+    if (timed_out) {
+        // Timeout. This will likely mean that we haven't been able to process
+        // all leases we wanted to process. The reclamation pass will be
+        // probably marked as incomplete.
+        if (!incomplete_reclamation) {
+            if (leases_processed < leases.size()) {
+                incomplete_reclamation = true;
             }
-
-        } catch (const std::exception& ex) {
-            LOG_ERROR(alloc_engine_logger, ALLOC_ENGINE_V6_LEASE_RECLAMATION_FAILED)
-                .arg(lease->addr_.toText())
-                .arg(ex.what());
-        }
-
-        // Check if we have hit the timeout for running reclamation routine and
-        // return if we have. We're checking it here, because we always want to
-        // allow reclaiming at least one lease.
-        if ((timeout > 0) && (stopwatch.getTotalMilliseconds() >= timeout)) {
-            // Timeout. This will likely mean that we haven't been able to process
-            // all leases we wanted to process. The reclamation pass will be
-            // probably marked as incomplete.
-            if (!incomplete_reclamation) {
-                if (leases_processed < leases.size()) {
-                    incomplete_reclamation = true;
-                }
-            }
-
-            LOG_DEBUG(alloc_engine_logger, ALLOC_ENGINE_DBG_TRACE,
-                      ALLOC_ENGINE_V6_LEASES_RECLAMATION_TIMEOUT)
-                .arg(timeout);
-            break;
         }
+
+        LOG_DEBUG(alloc_engine_logger, ALLOC_ENGINE_DBG_TRACE,
+                  ALLOC_ENGINE_V6_LEASES_RECLAMATION_TIMEOUT)
+            .arg(timeout);
     }
 
     // Stop measuring the time.
@@ -2495,54 +3173,25 @@ AllocEngine::reclaimExpiredLeases4(const size_t max_leases, const uint16_t timeo
         lease_mgr.getExpiredLeases4(leases, max_leases);
     }
 
-    // Do not initialize the callout handle until we know if there are any
-    // lease4_expire callouts installed.
-    CalloutHandlePtr callout_handle;
-    if (!leases.empty() &&
-        HooksManager::calloutsPresent(Hooks.hook_index_lease4_expire_)) {
-        callout_handle = HooksManager::createCalloutHandle();
-    }
-
-    size_t leases_processed = 0;
-    BOOST_FOREACH(Lease4Ptr lease, leases) {
-
-        try {
-            // Reclaim the lease.
-            if (MultiThreadingMgr::instance().getMode()) {
-                // The reclamation is exclusive of packet processing.
-                WriteLockGuard exclusive(rw_mutex_);
-
-                reclaimExpiredLease(lease, remove_lease, callout_handle);
-                ++leases_processed;
-            } else {
-                reclaimExpiredLease(lease, remove_lease, callout_handle);
-                ++leases_processed;
-            }
-
-        } catch (const std::exception& ex) {
-            LOG_ERROR(alloc_engine_logger, ALLOC_ENGINE_V4_LEASE_RECLAMATION_FAILED)
-                .arg(lease->addr_.toText())
-                .arg(ex.what());
-        }
-
-        // Check if we have hit the timeout for running reclamation routine and
-        // return if we have. We're checking it here, because we always want to
-        // allow reclaiming at least one lease.
-        if ((timeout > 0) && (stopwatch.getTotalMilliseconds() >= timeout)) {
-            // Timeout. This will likely mean that we haven't been able to process
-            // all leases we wanted to process. The reclamation pass will be
-            // probably marked as incomplete.
-            if (!incomplete_reclamation) {
-                if (leases_processed < leases.size()) {
-                    incomplete_reclamation = true;
-                }
+    // Reclaim the leases. The timeout is checked after each batch, because
+    // we always want to allow reclaiming at least one batch.
+    bool timed_out = false;
+    size_t leases_processed = reclaimLeases(leases, remove_lease,
+                                            Hooks.hook_index_lease4_expire_,
+                                            timeout, stopwatch, timed_out);
+    if (timed_out) {
+        // Timeout. This will likely mean that we haven't been able to process
+        // all leases we wanted to process. The reclamation pass will be
+        // probably marked as incomplete.
+        if (!incomplete_reclamation) {
+            if (leases_processed < leases.size()) {
+                incomplete_reclamation = true;
             }
-
-            LOG_DEBUG(alloc_engine_logger, ALLOC_ENGINE_DBG_TRACE,
-                      ALLOC_ENGINE_V4_LEASES_RECLAMATION_TIMEOUT)
-                .arg(timeout);
-            break;
         }
+
+        LOG_DEBUG(alloc_engine_logger, ALLOC_ENGINE_DBG_TRACE,
+                  ALLOC_ENGINE_V4_LEASES_RECLAMATION_TIMEOUT)
+            .arg(timeout);
     }
 
     // Stop measuring the time.
@@ -2577,12 +3226,238 @@ AllocEngine::reclaimExpiredLeases4(const size_t max_leases, const uint16_t timeo
     }
 }
 
-template<typename LeasePtrType>
 void
-AllocEngine::reclaimExpiredLease(const LeasePtrType& lease, const bool remove_lease,
-                                 const CalloutHandlePtr& callout_handle) {
-    reclaimExpiredLease(lease, remove_lease ? DB_RECLAIM_REMOVE : DB_RECLAIM_UPDATE,
-                        callout_handle);
+AllocEngine::setReclaimBatchSize(const size_t batch_size) {
+    if ((batch_size == 0) || (batch_size > MAX_RECLAIM_BATCH_SIZE)) {
+        isc_throw(BadValue, "invalid lease reclamation batch size "
+                  << batch_size << ", expected a value between 1 and "
+                  << MAX_RECLAIM_BATCH_SIZE);
+    }
+    reclaim_batch_size_ = batch_size;
+}
+
+void
+AllocEngine::setReclaimThreads(const size_t thread_count) {
+    if (thread_count > MAX_RECLAIM_THREADS) {
+        isc_throw(BadValue, "invalid number of lease reclamation threads "
+                  << thread_count << ", expected a value between 0 and "
+                  << MAX_RECLAIM_THREADS);
+    }
+    if (thread_count == reclaim_threads_) {
+        return;
+    }
+    reclaim_pool_.reset();
+    if (thread_count > 0) {
+        reclaim_pool_.start(thread_count);
+    }
+    reclaim_threads_ = thread_count;
+}
+
+template<typename LeaseCollectionType>
+size_t
+AllocEngine::reclaimLeaseBatch(const LeaseCollectionType& leases,
+                               const size_t first, const size_t last,
+                               const DbReclaimMode& reclaim_mode,
+                               const CalloutHandlePtr& callout_handle) {
+    typedef typename LeaseCollectionType::value_type LeasePtrType;
+
+    // Start the reclamation of the leases: callouts, DNS removal and
+    // declined leases recovery. The database operations are collected.
+    std::vector<std::pair<LeasePtrType, ReclaimDbOp> > batch;
+    LeaseCollectionType updated_leases;
+    LeaseCollectionType deleted_leases;
+    for (size_t i = first; i < last; ++i) {
+        const LeasePtrType& lease = leases[i];
+        try {
+            ReclaimDbOp db_op = startLeaseReclamation(lease, reclaim_mode,
+                                                      callout_handle);
+            if (db_op == RECLAIM_DB_UPDATE) {
+                updated_leases.push_back(lease);
+            } else if (db_op == RECLAIM_DB_DELETE) {
+                deleted_leases.push_back(lease);
+            }
+            batch.push_back(std::make_pair(lease, db_op));
+
+        } catch (const std::exception& ex) {
+            logReclamationFailure(lease, ex.what());
+        }
+    }
+
+    // Write all the leases in one call. If it fails, the operations are
+    // retried one by one so a single lease can't fail the whole batch.
+    size_t db_ops = updated_leases.size() + deleted_leases.size();
+    bool retry = false;
+    std::string error;
+    if (db_ops > 0) {
+        try {
+            writeReclaimedLeases(updated_leases, deleted_leases);
+
+        } catch (const std::exception& ex) {
+            if (db_ops > 1) {
+                LOG_DEBUG(alloc_engine_logger, ALLOC_ENGINE_DBG_TRACE,
+                          ALLOC_ENGINE_LEASES_RECLAMATION_BATCH_FAILED)
+                    .arg(db_ops)
+                    .arg(ex.what());
+                retry = true;
+            } else {
+                error = ex.what();
+            }
+        }
+    }
+
+    // Complete the reclamation of the leases written to the database.
+    size_t leases_reclaimed = 0;
+    for (auto const& reclaimed : batch) {
+        if (reclaimed.second != RECLAIM_DB_NONE) {
+            if (retry) {
+                try {
+                    writeReclaimedLease(reclaimed.first,
+                                        reclaimed.second == RECLAIM_DB_DELETE);
+                } catch (const std::exception& ex) {
+                    logReclamationFailure(reclaimed.first, ex.what());
+                    continue;
+                }
+            } else if (!error.empty()) {
+                logReclamationFailure(reclaimed.first, error);
+                continue;
+            }
+        }
+        finishLeaseReclamation(reclaimed.first, reclaimed.second);
+        ++leases_reclaimed;
+    }
+
+    return (leases_reclaimed);
+}
+
+template<typename LeaseCollectionType>
+size_t
+AllocEngine::reclaimLeases(const LeaseCollectionType& leases,
+                           const bool remove_lease, const int hook_index,
+                           const uint16_t timeout,
+                           const util::Stopwatch& stopwatch,
+                           bool& timed_out) {
+    DbReclaimMode reclaim_mode = remove_lease ? DB_RECLAIM_REMOVE : DB_RECLAIM_UPDATE;
+    size_t batch_size = reclaim_batch_size_;
+    bool multi_threading = MultiThreadingMgr::instance().getMode();
+
+    // Do not initialize the callout handle until we know if there are any
+    // callouts installed. The reclamation threads get a handle each.
+    bool callouts = !leases.empty() && HooksManager::calloutsPresent(hook_index);
+
+    if (!multi_threading || (reclaim_threads_ == 0) ||
+        (leases.size() <= batch_size)) {
+        CalloutHandlePtr callout_handle;
+        if (callouts) {
+            callout_handle = HooksManager::createCalloutHandle();
+        }
+
+        size_t leases_processed = 0;
+        for (size_t first = 0; first < leases.size(); first += batch_size) {
+            size_t last = std::min(first + batch_size, leases.size());
+            if (multi_threading) {
+                // The reclamation is exclusive of packet processing.
+                WriteLockGuard exclusive(rw_mutex_);
+
+                leases_processed += reclaimLeaseBatch(leases, first, last,
+                                                      reclaim_mode,
+                                                      callout_handle);
+            } else {
+                leases_processed += reclaimLeaseBatch(leases, first, last,
+                                                      reclaim_mode,
+                                                      callout_handle);
+            }
+
+            // Check if we have hit the timeout for running reclamation
+            // routine and return if we have.
+            if ((timeout > 0) && (stopwatch.getTotalMilliseconds() >= timeout)) {
+                timed_out = true;
+                break;
+            }
+        }
+        return (leases_processed);
+    }
+
+    // Partition the leases by subnet, keeping the expiration order within
+    // a subnet. The largest subnets are given first to the least loaded
+    // partitions.
+    std::map<SubnetID, LeaseCollectionType> subnets;
+    for (auto const& lease : leases) {
+        subnets[lease->subnet_id_].push_back(lease);
+    }
+    std::vector<const LeaseCollectionType*> by_size;
+    for (auto const& subnet : subnets) {
+        by_size.push_back(&subnet.second);
+    }
+    std::stable_sort(by_size.begin(), by_size.end(),
+                     [](const LeaseCollectionType* a,
+                        const LeaseCollectionType* b) {
+                         return (a->size() > b->size());
+                     });
+    size_t partition_count = std::min(reclaim_threads_, subnets.size());
+    std::vector<LeaseCollectionType> partitions(partition_count);
+    for (auto const& subnet_leases : by_size) {
+        auto smallest = std::min_element(partitions.begin(), partitions.end(),
+                                         [](const LeaseCollectionType& a,
+                                            const LeaseCollectionType& b) {
+                                             return (a.size() < b.size());
+                                         });
+        smallest->insert(smallest->end(), subnet_leases->begin(),
+                         subnet_leases->end());
+    }
+
+    std::vector<CalloutHandlePtr> callout_handles(partition_count);
+    if (callouts) {
+        for (auto& callout_handle : callout_handles) {
+            callout_handle = HooksManager::createCalloutHandle();
+        }
+    }
+
+    // Each round reclaims a batch of every partition in parallel. The
+    // packet processing is resumed between the rounds.
+    std::atomic<size_t> leases_processed(0);
+    std::vector<size_t> offsets(partition_count, 0);
+    bool remaining = true;
+    while (remaining) {
+        {
+            // The reclamation is exclusive of packet processing.
+            WriteLockGuard exclusive(rw_mutex_);
+
+            for (size_t i = 0; i < partition_count; ++i) {
+                if (offsets[i] >= partitions[i].size()) {
+                    continue;
+                }
+                size_t first = offsets[i];
+                size_t last = std::min(first + batch_size, partitions[i].size());
+                reclaim_pool_.add(boost::make_shared<std::function<void()> >(
+                    [this, &partitions, &callout_handles, &leases_processed,
+                     reclaim_mode, i, first, last]() {
+                        leases_processed += reclaimLeaseBatch(partitions[i],
+                                                              first, last,
+                                                              reclaim_mode,
+                                                              callout_handles[i]);
+                    }));
+            }
+            reclaim_pool_.wait();
+        }
+
+        remaining = false;
+        for (size_t i = 0; i < partition_count; ++i) {
+            offsets[i] = std::min(offsets[i] + batch_size, partitions[i].size());
+            if (offsets[i] < partitions[i].size()) {
+                remaining = true;
+            }
+        }
+
+        // Check if we have hit the timeout for running reclamation
+        // routine and return if we have.
+        if (remaining && (timeout > 0) &&
+            (stopwatch.getTotalMilliseconds() >= timeout)) {
+            timed_out = true;
+            break;
+        }
+    }
+
+    return (leases_processed);
 }
 
 template<typename LeasePtrType>
@@ -2601,6 +3476,18 @@ void
 AllocEngine::reclaimExpiredLease(const Lease6Ptr& lease,
                                  const DbReclaimMode& reclaim_mode,
                                  const CalloutHandlePtr& callout_handle) {
+    ReclaimDbOp db_op = startLeaseReclamation(lease, reclaim_mode,
+                                              callout_handle);
+    if (db_op != RECLAIM_DB_NONE) {
+        writeReclaimedLease(lease, db_op == RECLAIM_DB_DELETE);
+    }
+    finishLeaseReclamation(lease, db_op);
+}
+
+AllocEngine::ReclaimDbOp
+AllocEngine::startLeaseReclamation(const Lease6Ptr& lease,
+                                   const DbReclaimMode& reclaim_mode,
+                                   const CalloutHandlePtr& callout_handle) {
 
     LOG_DEBUG(alloc_engine_logger, ALLOC_ENGINE_DBG_TRACE,
               ALLOC_ENGINE_V6_LEASE_RECLAIM)
@@ -2634,6 +3521,7 @@ AllocEngine::reclaimExpiredLease(const Lease6Ptr& lease,
     /// DROP status does not make sense here.
     /// Not sure if we need to support every possible status everywhere.
 
+    ReclaimDbOp db_op = RECLAIM_DB_NONE;
     if (!skipped) {
 
         // Generate removal name change request for D2, if required.
@@ -2659,13 +3547,36 @@ AllocEngine::reclaimExpiredLease(const Lease6Ptr& lease,
         if (reclaim_mode != DB_RECLAIM_LEAVE_UNCHANGED) {
             // Reclaim the lease - depending on the configuration, set the
             // expired-reclaimed state or simply remove it.
-            LeaseMgr& lease_mgr = LeaseMgrFactory::instance();
-            reclaimLeaseInDatabase<Lease6Ptr>(lease, remove_lease,
-                                              std::bind(&LeaseMgr::updateLease6,
-                                                        &lease_mgr, ph::_1));
+            if (remove_lease) {
+                db_op = RECLAIM_DB_DELETE;
+            } else {
+                // Clear FQDN information as we have already sent the
+                // name change request to remove the DNS record.
+                lease->hostname_.clear();
+                lease->fqdn_fwd_ = false;
+                lease->fqdn_rev_ = false;
+                lease->state_ = Lease::STATE_EXPIRED_RECLAIMED;
+                db_op = RECLAIM_DB_UPDATE;
+            }
         }
     }
 
+    return (db_op);
+}
+
+void
+AllocEngine::finishLeaseReclamation(const Lease6Ptr& lease,
+                                    const ReclaimDbOp& db_op) {
+    if (db_op != RECLAIM_DB_NONE) {
+        // The address or prefix can be allocated again.
+        leaseFreed(lease);
+
+        // Lease has been reclaimed.
+        LOG_DEBUG(alloc_engine_logger, ALLOC_ENGINE_DBG_TRACE,
+                  ALLOC_ENGINE_LEASE_RECLAIMED)
+            .arg(lease->addr_.toText());
+    }
+
     // Update statistics.
 
     // Decrease number of assigned leases.
@@ -2684,6 +3595,7 @@ AllocEngine::reclaimExpiredLease(const Lease6Ptr& lease,
                                       int64_t(-1));
 
     }
+    updatePoolAssigned(lease, -1);
 
     // Increase total number of reclaimed leases.
     StatsMgr::instance().addValue("reclaimed-leases", int64_t(1));
@@ -2699,6 +3611,18 @@ void
 AllocEngine::reclaimExpiredLease(const Lease4Ptr& lease,
                                  const DbReclaimMode& reclaim_mode,
                                  const CalloutHandlePtr& callout_handle) {
+    ReclaimDbOp db_op = startLeaseReclamation(lease, reclaim_mode,
+                                              callout_handle);
+    if (db_op != RECLAIM_DB_NONE) {
+        writeReclaimedLease(lease, db_op == RECLAIM_DB_DELETE);
+    }
+    finishLeaseReclamation(lease, db_op);
+}
+
+AllocEngine::ReclaimDbOp
+AllocEngine::startLeaseReclamation(const Lease4Ptr& lease,
+                                   const DbReclaimMode& reclaim_mode,
+                                   const CalloutHandlePtr& callout_handle) {
 
     LOG_DEBUG(alloc_engine_logger, ALLOC_ENGINE_DBG_TRACE,
               ALLOC_ENGINE_V4_LEASE_RECLAIM)
@@ -2730,6 +3654,7 @@ AllocEngine::reclaimExpiredLease(const Lease4Ptr& lease,
     /// DROP status does not make sense here.
     /// Not sure if we need to support every possible status everywhere.
 
+    ReclaimDbOp db_op = RECLAIM_DB_NONE;
     if (!skipped) {
 
         // Generate removal name change request for D2, if required.
@@ -2759,13 +3684,31 @@ AllocEngine::reclaimExpiredLease(const Lease4Ptr& lease,
         if (reclaim_mode != DB_RECLAIM_LEAVE_UNCHANGED) {
             // Reclaim the lease - depending on the configuration, set the
             // expired-reclaimed state or simply remove it.
-            LeaseMgr& lease_mgr = LeaseMgrFactory::instance();
-            reclaimLeaseInDatabase<Lease4Ptr>(lease, remove_lease,
-                                              std::bind(&LeaseMgr::updateLease4,
-                                                        &lease_mgr, ph::_1));
+            if (remove_lease) {
+                db_op = RECLAIM_DB_DELETE;
+            } else {
+                lease->state_ = Lease::STATE_EXPIRED_RECLAIMED;
+                db_op = RECLAIM_DB_UPDATE;
+            }
         }
     }
 
+    return (db_op);
+}
+
+void
+AllocEngine::finishLeaseReclamation(const Lease4Ptr& lease,
+                                    const ReclaimDbOp& db_op) {
+    if (db_op != RECLAIM_DB_NONE) {
+        // The address or prefix can be allocated again.
+        leaseFreed(lease);
+
+        // Lease has been reclaimed.
+        LOG_DEBUG(alloc_engine_logger, ALLOC_ENGINE_DBG_TRACE,
+                  ALLOC_ENGINE_LEASE_RECLAIMED)
+            .arg(lease->addr_.toText());
+    }
+
     // Update statistics.
 
     // Decrease number of assigned addresses.
@@ -2773,6 +3716,7 @@ AllocEngine::reclaimExpiredLease(const Lease4Ptr& lease,
                                                          lease->subnet_id_,
                                                          "assigned-addresses"),
                                   int64_t(-1));
+    updatePoolAssigned(lease, -1);
 
     // Increase total number of reclaimed leases.
     StatsMgr::instance().addValue("reclaimed-leases", int64_t(1));
@@ -2915,36 +3859,6 @@ AllocEngine::reclaimDeclined(const Lease6Ptr& lease) {
     return (true);
 }
 
-template<typename LeasePtrType>
-void AllocEngine::reclaimLeaseInDatabase(const LeasePtrType& lease,
-                                         const bool remove_lease,
-                                         const std::function<void (const LeasePtrType&)>&
-                                         lease_update_fun) const {
-
-    LeaseMgr& lease_mgr = LeaseMgrFactory::instance();
-
-    // Reclaim the lease - depending on the configuration, set the
-    // expired-reclaimed state or simply remove it.
-    if (remove_lease) {
-        lease_mgr.deleteLease(lease);
-    } else if (lease_update_fun) {
-        // Clear FQDN information as we have already sent the
-        // name change request to remove the DNS record.
-        lease->hostname_.clear();
-        lease->fqdn_fwd_ = false;
-        lease->fqdn_rev_ = false;
-        lease->state_ = Lease::STATE_EXPIRED_RECLAIMED;
-        lease_update_fun(lease);
-
-    } else {
-        return;
-    }
-
-    // Lease has been reclaimed.
-    LOG_DEBUG(alloc_engine_logger, ALLOC_ENGINE_DBG_TRACE,
-              ALLOC_ENGINE_LEASE_RECLAIMED)
-        .arg(lease->addr_.toText());
-}
 
 }  // namespace dhcp
 }  // namespace isc
@@ -3084,6 +3998,51 @@ hasAddressReservation(AllocEngine::ClientContext4& ctx) {
     return (false);
 }
 
+/// @brief Fetches the leases which may belong to the client.
+///
+/// The leases with the HW address or the client identifier of the client
+/// and, when a lease is requested, the lease for the requested or reserved
+/// address are fetched by one lookup into the client context.
+///
+/// @param [out] ctx Client context.
+void prefetchClientLeases4(AllocEngine::ClientContext4& ctx) {
+    ctx.prefetched_address_ = IOAddress::IPV4_ZERO_ADDRESS();
+    if (!ctx.fake_allocation_) {
+        if (!ctx.requested_address_.isV4Zero()) {
+            ctx.prefetched_address_ = ctx.requested_address_;
+        } else if (hasAddressReservation(ctx)) {
+            ctx.prefetched_address_ = ctx.currentHost()->getIPv4Reservation();
+        }
+    }
+    ctx.prefetched_leases_ =
+        LeaseMgrFactory::instance().getClientLeases4(ctx.hwaddr_, ctx.clientid_,
+                                                     ctx.prefetched_address_);
+    ctx.leases_prefetched_ = true;
+}
+
+/// @brief Returns the lease for an address.
+///
+/// The lease is taken from the leases prefetched in the client context
+/// when they include this address, else it is fetched from the lease
+/// database.
+///
+/// @param ctx Client context.
+/// @param address IPv4 address of the lease.
+///
+/// @return A pointer to the lease or null if the lease is not found.
+Lease4Ptr getClientLease4(const AllocEngine::ClientContext4& ctx,
+                          const IOAddress& address) {
+    if (ctx.leases_prefetched_ && (address == ctx.prefetched_address_)) {
+        for (auto const& lease : ctx.prefetched_leases_) {
+            if (lease->addr_ == address) {
+                return (lease);
+            }
+        }
+        return (Lease4Ptr());
+    }
+    return (LeaseMgrFactory::instance().getLease4(address));
+}
+
 /// @brief Finds existing lease in the database.
 ///
 /// This function searches for the lease in the database which belongs to the
@@ -3100,7 +4059,7 @@ hasAddressReservation(AllocEngine::ClientContext4& ctx) {
 /// @param [out] client_lease A pointer to the lease returned by this function
 /// or null value if no has been lease found.
 void findClientLease(AllocEngine::ClientContext4& ctx, Lease4Ptr& client_lease) {
-    LeaseMgr& lease_mgr = LeaseMgrFactory::instance();
+    prefetchClientLeases4(ctx);
 
     Subnet4Ptr original_subnet = ctx.subnet_;
 
@@ -3115,7 +4074,12 @@ void findClientLease(AllocEngine::ClientContext4& ctx, Lease4Ptr& client_lease)
         // Get all leases for this client identifier. When shared networks are
         // in use it is more efficient to make a single query rather than
         // multiple queries, one for each subnet.
-        Lease4Collection leases_client_id = lease_mgr.getLease4(*ctx.clientid_);
+        Lease4Collection leases_client_id;
+        for (auto const& lease : ctx.prefetched_leases_) {
+            if (lease->client_id_ && (*lease->client_id_ == *ctx.clientid_)) {
+                leases_client_id.push_back(lease);
+            }
+        }
 
         // Iterate over the subnets within the shared network to see if any client's
         // lease belongs to them.
@@ -3144,7 +4108,12 @@ void findClientLease(AllocEngine::ClientContext4& ctx, Lease4Ptr& client_lease)
     if (!client_lease && ctx.hwaddr_) {
 
         // Get all leases for this HW address.
-        Lease4Collection leases_hw_address = lease_mgr.getLease4(*ctx.hwaddr_);
+        Lease4Collection leases_hw_address;
+        for (auto const& lease : ctx.prefetched_leases_) {
+            if (lease->hwaddr_ && (lease->hwaddr_->hwaddr_ == ctx.hwaddr_->hwaddr_)) {
+                leases_hw_address.push_back(lease);
+            }
+        }
 
         for (Subnet4Ptr subnet = original_subnet; subnet;
              subnet = subnet->getNextSubnet(original_subnet,
@@ -3208,6 +4177,25 @@ inAllowedPool(AllocEngine::ClientContext4& ctx, const IOAddress& address) {
     return (false);
 }
 
+/// @brief Returns the identifier of a client hashed by the hashed allocator.
+///
+/// @param ctx Client context.
+/// @param subnet The subnet the address is picked from.
+///
+/// @return The client identifier when it is matched in the subnet, else
+/// the HW address, or null when the client has none of them.
+DuidPtr
+getHashedIdentifier4(const AllocEngine::ClientContext4& ctx,
+                     const Subnet4Ptr& subnet) {
+    if (ctx.clientid_ && subnet->getMatchClientId()) {
+        return (ctx.clientid_);
+    }
+    if (ctx.hwaddr_ && !ctx.hwaddr_->hwaddr_.empty()) {
+        return (DuidPtr(new DUID(ctx.hwaddr_->hwaddr_)));
+    }
+    return (DuidPtr());
+}
+
 }  // namespace
 
 namespace isc {
@@ -3219,7 +4207,9 @@ AllocEngine::ClientContext4::ClientContext4()
       fwd_dns_update_(false), rev_dns_update_(false),
       hostname_(""), callout_handle_(), fake_allocation_(false),
       old_lease_(), new_lease_(), hosts_(), conflicting_lease_(),
-      query_(), host_identifiers_(),
+      query_(), host_identifiers_(), prefetched_leases_(),
+      leases_prefetched_(false),
+      prefetched_address_(IOAddress::IPV4_ZERO_ADDRESS()),
       ddns_params_() {
 }
 
@@ -3236,7 +4226,9 @@ AllocEngine::ClientContext4::ClientContext4(const Subnet4Ptr& subnet,
       fwd_dns_update_(fwd_dns_update), rev_dns_update_(rev_dns_update),
       hostname_(hostname), callout_handle_(),
       fake_allocation_(fake_allocation), old_lease_(), new_lease_(),
-      hosts_(), host_identifiers_(),
+      hosts_(), host_identifiers_(), prefetched_leases_(),
+      leases_prefetched_(false),
+      prefetched_address_(IOAddress::IPV4_ZERO_ADDRESS()),
       ddns_params_(new DdnsParams()) {
 
     // Initialize host identifiers.
@@ -3295,6 +4287,10 @@ AllocEngine::allocateLease4(ClientContext4& ctx) {
     ctx.old_lease_.reset();
     ctx.new_lease_.reset();
 
+    // The leases prefetched by a previous allocation may be outdated.
+    ctx.prefetched_leases_.clear();
+    ctx.leases_prefetched_ = false;
+
     // Before we start allocation process, we need to make sure that the
     // selected subnet is allowed for this client. If not, we'll try to
     // use some other subnet within the shared network. If there are no
@@ -3441,13 +4437,50 @@ AllocEngine::findGlobalReservation(ClientContext4& ctx) {
     return (host);
 }
 
+Lease4Ptr
+AllocEngine::findPreferredLease4(ClientContext4& ctx) {
+    if (!ctx.subnet_ || (getAllocType(ctx.subnet_) != ALLOC_HASHED)) {
+        return (Lease4Ptr());
+    }
+    DuidPtr identifier = getHashedIdentifier4(ctx, ctx.subnet_);
+    if (!identifier) {
+        return (Lease4Ptr());
+    }
+
+    boost::shared_ptr<HashedAllocator> allocator =
+        boost::dynamic_pointer_cast<HashedAllocator>(getAllocator(Lease::TYPE_V4,
+                                                                  ALLOC_HASHED));
+    IOAddress preferred = allocator->getPreferredAddress(ctx.subnet_,
+                                                         ctx.query_->getClasses(),
+                                                         identifier);
+    Lease4Ptr lease;
+    if (!preferred.isV4Zero()) {
+        lease = LeaseMgrFactory::instance().getLease4(preferred);
+    }
+    ClientIdPtr client_id;
+    if (ctx.subnet_->getMatchClientId()) {
+        client_id = ctx.clientid_;
+    }
+    if (lease && (lease->subnet_id_ == ctx.subnet_->getID()) &&
+        lease->belongsToClient(ctx.hwaddr_, client_id)) {
+        StatsMgr::instance().addValue("v4-hashed-allocator-hits",
+                                      static_cast<int64_t>(1));
+        return (lease);
+    }
+    StatsMgr::instance().addValue("v4-hashed-allocator-misses",
+                                  static_cast<int64_t>(1));
+    return (Lease4Ptr());
+}
+
 Lease4Ptr
 AllocEngine::discoverLease4(AllocEngine::ClientContext4& ctx) {
     // Find an existing lease for this client. This function will return true
     // if there is a conflict with existing lease and the allocation should
     // not be continued.
-    Lease4Ptr client_lease;
-    findClientLease(ctx, client_lease);
+    Lease4Ptr client_lease = findPreferredLease4(ctx);
+    if (!client_lease) {
+        findClientLease(ctx, client_lease);
+    }
 
     // new_lease will hold the pointer to the lease that we will offer to the
     // caller.
@@ -3557,8 +4590,10 @@ AllocEngine::requestLease4(AllocEngine::ClientContext4& ctx) {
     // Find an existing lease for this client. This function will return true
     // if there is a conflict with existing lease and the allocation should
     // not be continued.
-    Lease4Ptr client_lease;
-    findClientLease(ctx, client_lease);
+    Lease4Ptr client_lease = findPreferredLease4(ctx);
+    if (!client_lease) {
+        findClientLease(ctx, client_lease);
+    }
 
     // When the client sends the DHCPREQUEST, it should always specify the
     // address which it is requesting or renewing. That is, the client should
@@ -3596,7 +4631,7 @@ AllocEngine::requestLease4(AllocEngine::ClientContext4& ctx) {
     if (!ctx.requested_address_.isV4Zero()) {
         // There is a specific address to be allocated. Let's find out if
         // the address is in use.
-        Lease4Ptr existing = LeaseMgrFactory::instance().getLease4(ctx.requested_address_);
+        Lease4Ptr existing = getClientLease4(ctx, ctx.requested_address_);
         // If the address is in use (allocated and not expired), we check
         // if the address is in use by our client or another client.
         // If it is in use by another client, the address can't be
@@ -3619,8 +4654,7 @@ AllocEngine::requestLease4(AllocEngine::ClientContext4& ctx) {
         // check if the address is in use.
         if (hasAddressReservation(ctx) &&
             (ctx.currentHost()->getIPv4Reservation() != ctx.requested_address_)) {
-            existing =
-                LeaseMgrFactory::instance().getLease4(ctx.currentHost()->getIPv4Reservation());
+            existing = getClientLease4(ctx, ctx.currentHost()->getIPv4Reservation());
             // If the reserved address is not in use, i.e. the lease doesn't
             // exist or is expired, and the client is requesting a different
             // address, return NULL. The client should go back to the
@@ -3722,11 +4756,14 @@ AllocEngine::requestLease4(AllocEngine::ClientContext4& ctx) {
             .arg(client_lease->addr_.toText());
 
         if (LeaseMgrFactory::instance().deleteLease(client_lease)) {
+            leaseFreed(client_lease);
+
             // Need to decrease statistic for assigned addresses.
             StatsMgr::instance().addValue(
                 StatsMgr::generateName("subnet", client_lease->subnet_id_,
                                        "assigned-addresses"),
                 static_cast<int64_t>(-1));
+            updatePoolAssigned(client_lease, -1);
         }
     }
 
@@ -3833,12 +4870,14 @@ AllocEngine::createLease4(const ClientContext4& ctx, const IOAddress& addr,
         // That is a real (REQUEST) allocation
         bool status = LeaseMgrFactory::instance().addLease(lease);
         if (status) {
+            leaseUsed(lease);
 
             // The lease insertion succeeded, let's bump up the statistic.
             StatsMgr::instance().addValue(
                 StatsMgr::generateName("subnet", ctx.subnet_->getID(),
                                        "assigned-addresses"),
                 static_cast<int64_t>(1));
+            ctx.subnet_->updatePoolAssigned(Lease::TYPE_V4, lease->addr_, 1);
             StatsMgr::instance().addValue(
                 StatsMgr::generateName("subnet", ctx.subnet_->getID(),
                                        "cumulative-assigned-addresses"),
@@ -3943,6 +4982,7 @@ AllocEngine::renewLease4(const Lease4Ptr& lease,
     if (!ctx.fake_allocation_ && !skip) {
         // for REQUEST we do update the lease
         LeaseMgrFactory::instance().updateLease4(lease);
+        leaseUsed(lease);
 
         // We need to account for the re-assignment of The lease.
         if (ctx.old_lease_->expired() || ctx.old_lease_->state_ == Lease::STATE_EXPIRED_RECLAIMED) {
@@ -3950,6 +4990,7 @@ AllocEngine::renewLease4(const Lease4Ptr& lease,
                 StatsMgr::generateName("subnet", ctx.subnet_->getID(),
                                        "assigned-addresses"),
                 static_cast<int64_t>(1));
+            ctx.subnet_->updatePoolAssigned(Lease::TYPE_V4, lease->addr_, 1);
             StatsMgr::instance().addValue(
                 StatsMgr::generateName("subnet", ctx.subnet_->getID(),
                                        "cumulative-assigned-addresses"),
@@ -4049,12 +5090,14 @@ AllocEngine::reuseExpiredLease4(Lease4Ptr& expired,
     if (!ctx.fake_allocation_) {
         // for REQUEST we do update the lease
         LeaseMgrFactory::instance().updateLease4(expired);
+        leaseUsed(expired);
 
         // We need to account for the re-assignment of The lease.
         StatsMgr::instance().addValue(
                 StatsMgr::generateName("subnet", ctx.subnet_->getID(),
                                        "assigned-addresses"),
                 static_cast<int64_t>(1));
+        ctx.subnet_->updatePoolAssigned(Lease::TYPE_V4, expired->addr_, 1);
         StatsMgr::instance().addValue(
                 StatsMgr::generateName("subnet", ctx.subnet_->getID(),
                                        "cumulative-assigned-addresses"),
@@ -4104,7 +5147,6 @@ AllocEngine::allocateOrReuseLease4(const IOAddress& candidate, ClientContext4& c
 Lease4Ptr
 AllocEngine::allocateUnreservedLease4(ClientContext4& ctx) {
     Lease4Ptr new_lease;
-    AllocatorPtr allocator = getAllocator(Lease::TYPE_V4);
     Subnet4Ptr subnet = ctx.subnet_;
 
     // Need to check if the subnet belongs to a shared network. If so,
@@ -4133,6 +5175,7 @@ AllocEngine::allocateUnreservedLease4(ClientContext4& ctx) {
     bool check_reservation_first = MultiThreadingMgr::instance().getMode();
 
     Subnet4Ptr original_subnet = subnet;
+    AllocationSubnets<Subnet4Ptr> subnets(original_subnet);
 
     uint64_t total_attempts = 0;
     while (subnet) {
@@ -4149,18 +5192,40 @@ AllocEngine::allocateUnreservedLease4(ClientContext4& ctx) {
         // Skip trying if there is no chance to get something
         if (possible_attempts == 0) {
             max_attempts = 0;
+        } else if (subnets.skip(subnet, Lease::TYPE_V4,
+                                ctx.query_->getClasses())) {
+            // Try the subnet last as its pools are exhausted.
+            max_attempts = 0;
+        }
+
+        // Each subnet selects its allocator.
+        AllocType alloc_type = getAllocType(subnet);
+        AllocatorPtr allocator = getAllocator(Lease::TYPE_V4, alloc_type);
+
+        // The hashed allocator falls back to the HW address when the
+        // client identifier is not used.
+        DuidPtr identifier = client_id;
+        if (alloc_type == ALLOC_HASHED) {
+            identifier = getHashedIdentifier4(ctx, subnet);
         }
 
         CalloutHandle::CalloutNextStep callout_status = CalloutHandle::NEXT_STEP_CONTINUE;
 
+        // The allocator picks the next candidate from the last one.
+        IOAddress last_candidate = IOAddress::IPV4_ZERO_ADDRESS();
         for (uint64_t i = 0; i < max_attempts; ++i) {
 
             ++total_attempts;
 
             IOAddress candidate = allocator->pickAddress(subnet,
                                                          ctx.query_->getClasses(),
-                                                         client_id,
-                                                         ctx.requested_address_);
+                                                         identifier,
+                                                         last_candidate);
+            last_candidate = candidate;
+            // The allocator has no free address in the pools of the subnet.
+            if (candidate.isV4Zero()) {
+                break;
+            }
             // First check for reservation when it is the choice.
             if (check_reservation_first && addressReserved(candidate, ctx)) {
                 // Don't allocate.
@@ -4207,7 +5272,7 @@ AllocEngine::allocateUnreservedLease4(ClientContext4& ctx) {
 
         // This pointer may be set to NULL if hooks set SKIP status.
         if (subnet) {
-            subnet = subnet->getNextSubnet(original_subnet, ctx.query_->getClasses());
+            subnet = subnets.next(subnet, ctx.query_->getClasses());
 
             if (subnet) {
                 ctx.subnet_ = subnet;
@@ -16,7 +16,10 @@
 #include <dhcp/option6_ia.h>
 #include <dhcp/option6_iaaddr.h>
 #include <dhcp/option6_iaprefix.h>
+#include <dhcpsrv/cfg_subnets4.h>
+#include <dhcpsrv/cfg_subnets6.h>
 #include <dhcpsrv/d2_client_cfg.h>
+#include <dhcpsrv/free_lease_queue.h>
 #include <dhcpsrv/host.h>
 #include <dhcpsrv/subnet.h>
 #include <dhcpsrv/lease_mgr.h>
@@ -24,10 +27,13 @@
 #include <hooks/callout_handle.h>
 #include <util/multi_threading_mgr.h>
 #include <util/readwrite_mutex.h>
+#include <util/stopwatch.h>
+#include <util/thread_pool.h>
 
 #include <boost/shared_ptr.hpp>
 #include <boost/noncopyable.hpp>
 
+#include <array>
 #include <functional>
 #include <list>
 #include <map>
@@ -91,7 +97,8 @@ protected:
         /// @param subnet next address will be returned from pool of that subnet
         /// @param client_classes list of classes client belongs to
         /// @param duid Client's DUID
-        /// @param hint Client's hint
+        /// @param hint the last address that was picked for the client in
+        ///        the subnet or the zero address for the first pick
         ///
         /// @return the next address
         virtual isc::asiolink::IOAddress
@@ -107,6 +114,41 @@ protected:
             }
         }
 
+        /// @brief Notifies the allocator that an address or prefix is leased
+        ///
+        /// It is called when a lease is added to the lease database or when
+        /// an expired lease is reused.
+        ///
+        /// @param address leased address or prefix
+        /// @param prefix_len length of the prefix (128 for IPv6 addresses,
+        ///        32 for IPv4 addresses)
+        void addressUsed(const isc::asiolink::IOAddress& address,
+                         const uint8_t prefix_len) {
+            if (isc::util::MultiThreadingMgr::instance().getMode()) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                addressUsedInternal(address, prefix_len);
+            } else {
+                addressUsedInternal(address, prefix_len);
+            }
+        }
+
+        /// @brief Notifies the allocator that an address or prefix is free
+        ///
+        /// It is called when a lease is released, deleted or reclaimed.
+        ///
+        /// @param address free address or prefix
+        /// @param prefix_len length of the prefix (128 for IPv6 addresses,
+        ///        32 for IPv4 addresses)
+        void addressFreed(const isc::asiolink::IOAddress& address,
+                          const uint8_t prefix_len) {
+            if (isc::util::MultiThreadingMgr::instance().getMode()) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                addressFreedInternal(address, prefix_len);
+            } else {
+                addressFreedInternal(address, prefix_len);
+            }
+        }
+
         /// @brief Default constructor
         ///
         /// Specifies which type of leases this allocator will assign
@@ -125,13 +167,25 @@ protected:
                             const DuidPtr& duid,
                             const isc::asiolink::IOAddress& hint) = 0;
 
+        /// @brief Notifies the allocator that an address or prefix is leased
+        ///
+        /// The allocators which don't track the free leases do nothing.
+        virtual void
+        addressUsedInternal(const isc::asiolink::IOAddress&, const uint8_t) {
+        }
+
+        /// @brief Notifies the allocator that an address or prefix is free
+        ///
+        /// The allocators which don't track the free leases do nothing.
+        virtual void
+        addressFreedInternal(const isc::asiolink::IOAddress&, const uint8_t) {
+        }
+
     protected:
 
         /// @brief Defines pool type allocation
         Lease::Type pool_type_;
 
-    private:
-
         /// @brief The mutex to protect the allocated lease
         std::mutex mutex_;
     };
@@ -145,16 +199,57 @@ protected:
     /// a pool iteratively, one after another. Once the last address is reached,
     /// it starts allocating from the beginning of the first pool (i.e. it loops
     /// over).
+    ///
+    /// The iteration state is kept by the subnet and its pools. It is
+    /// protected by a mutex per subnet, taken from @c SUBNET_MUTEXES mutexes
+    /// sharded by subnet identifier, instead of the mutex of the allocator:
+    /// threads picking from distinct subnets don't wait for each other.
     class IterativeAllocator : public Allocator {
     public:
 
+        /// @brief Number of the mutexes protecting the subnets.
+        static const size_t SUBNET_MUTEXES = 64;
+
         /// @brief Default constructor
         ///
         /// Does not do anything
         /// @param type - specifies allocation type
         IterativeAllocator(Lease::Type type);
 
-    private:
+        /// @brief Picks the next address
+        ///
+        /// It locks the mutex of the subnet instead of the mutex of the
+        /// allocator.
+        ///
+        /// @param subnet next address will be returned from pool of that subnet
+        /// @param client_classes list of classes client belongs to
+        /// @param duid Client's DUID (ignored)
+        /// @param hint the last address that was picked (ignored)
+        ///
+        /// @return the next address
+        virtual isc::asiolink::IOAddress
+        pickAddress(const SubnetPtr& subnet,
+                    const ClientClasses& client_classes,
+                    const DuidPtr& duid,
+                    const isc::asiolink::IOAddress& hint) {
+            if (isc::util::MultiThreadingMgr::instance().getMode()) {
+                std::lock_guard<std::mutex> lock(getSubnetMutex(subnet));
+                return pickAddressInternal(subnet, client_classes, duid, hint);
+            } else {
+                return pickAddressInternal(subnet, client_classes, duid, hint);
+            }
+        }
+
+    protected:
+
+        /// @brief Returns the mutex protecting the iteration state of a subnet
+        ///
+        /// @param subnet the subnet
+        ///
+        /// @return the mutex of the shard of the subnet
+        std::mutex& getSubnetMutex(const SubnetPtr& subnet) {
+            return (subnet_mutexes_[subnet->getID() % SUBNET_MUTEXES]);
+        }
 
         /// @brief Returns the next address from pools in a subnet
         ///
@@ -170,8 +265,6 @@ protected:
                             const DuidPtr& duid,
                             const isc::asiolink::IOAddress& hint);
 
-    protected:
-
         /// @brief Returns the next prefix
         ///
         /// This method works for IPv6 addresses only. It increases the
@@ -200,41 +293,129 @@ protected:
         static isc::asiolink::IOAddress
         increaseAddress(const isc::asiolink::IOAddress& address,
                         bool prefix, const uint8_t prefix_len);
+
+    private:
+
+        /// @brief The mutexes protecting the iteration state of the subnets
+        std::array<std::mutex, SUBNET_MUTEXES> subnet_mutexes_;
     };
 
     /// @brief Address/prefix allocator that gets an address based on a hash
     ///
-    /// @todo: This is a skeleton class for now and is missing an implementation.
-    class HashedAllocator : public Allocator {
+    /// The identifier of the client, i.e. its DUID, its client identifier
+    /// or its HW address, is hashed to a preferred address or prefix: the
+    /// pools allowed for the client classes are ranked by rendezvous hashing
+    /// of the identifier with the first address of each pool, and the
+    /// preferred address is the one at the hash of the identifier modulo
+    /// the pool capacity in the best ranked pool. It does not depend on
+    /// the state of the server, so a returning client gets the same address
+    /// after a restart or from the other server of a HA pair, and it is not
+    /// moved when other pools are added or removed.
+    ///
+    /// When the preferred address is taken, the following calls, which get
+    /// the previously picked address as hint, probe the next addresses of
+    /// the pool, wrapping around, then the preferred address of the next
+    /// ranked pool. Clients without identifier get addresses as from the
+    /// @c IterativeAllocator.
+    class HashedAllocator : public IterativeAllocator {
     public:
 
-        /// @brief Default constructor (does nothing)
+        /// @brief Default constructor
         ///
         /// @param type - specifies allocation type
         HashedAllocator(Lease::Type type);
 
+        /// @brief Picks an address
+        ///
+        /// It doesn't lock any mutex unless the client has no identifier:
+        /// the hashed addresses don't depend on any state of the allocator
+        /// or of the subnet.
+        ///
+        /// @param subnet an address will be picked from pool of that subnet
+        /// @param client_classes list of classes client belongs to
+        /// @param duid Client's identifier
+        /// @param hint the last address that was picked for the client
+        ///
+        /// @return the picked address
+        virtual isc::asiolink::IOAddress
+        pickAddress(const SubnetPtr& subnet,
+                    const ClientClasses& client_classes,
+                    const DuidPtr& duid,
+                    const isc::asiolink::IOAddress& hint) {
+            if (duid) {
+                return (pickAddressInternal(subnet, client_classes, duid, hint));
+            }
+            return (IterativeAllocator::pickAddress(subnet, client_classes,
+                                                    duid, hint));
+        }
+
+        /// @brief Returns the preferred address of a client
+        ///
+        /// @param subnet the address is in a pool of that subnet
+        /// @param client_classes list of classes client belongs to
+        /// @param duid Client's identifier
+        ///
+        /// @return the preferred address or the zero address when the
+        /// subnet has no pool allowed for the client classes.
+        isc::asiolink::IOAddress
+        getPreferredAddress(const SubnetPtr& subnet,
+                            const ClientClasses& client_classes,
+                            const DuidPtr& duid) const;
+
     private:
 
         /// @brief Returns an address based on hash calculated from client's DUID.
         ///
-        /// @todo: Implement this method
-        ///
         /// @param subnet an address will be picked from pool of that subnet
         /// @param client_classes list of classes client belongs to
-        /// @param duid Client's DUID
-        /// @param hint a hint (last address that was picked)
+        /// @param duid Client's identifier
+        /// @param hint the last address that was picked for the client or
+        ///        the zero address for the first pick
         ///
-        /// @return selected address
+        /// @return the preferred address when the hint is the zero address
+        /// or is not in an allowed pool, the address following the hint
+        /// otherwise
         virtual isc::asiolink::IOAddress
         pickAddressInternal(const SubnetPtr& subnet,
                             const ClientClasses& client_classes,
                             const DuidPtr& duid,
                             const isc::asiolink::IOAddress& hint);
+
+        /// @brief Returns the pools allowed for the client classes in
+        /// rendezvous hashing order for an identifier.
+        ///
+        /// @param subnet the subnet holding the pools
+        /// @param client_classes list of classes client belongs to
+        /// @param duid Client's identifier
+        ///
+        /// @return the allowed pools, best ranked first
+        PoolCollection
+        rankPools(const SubnetPtr& subnet,
+                  const ClientClasses& client_classes,
+                  const DuidPtr& duid) const;
+
+        /// @brief Returns the preferred address of an identifier in a pool.
+        ///
+        /// @param pool the pool
+        /// @param duid Client's identifier
+        ///
+        /// @return the address at the hash of the identifier modulo the
+        /// capacity of the pool
+        isc::asiolink::IOAddress
+        getPoolSlot(const PoolPtr& pool, const DuidPtr& duid) const;
     };
 
     /// @brief Random allocator that picks address randomly
     ///
-    /// @todo: This is a skeleton class for now and is missing an implementation.
+    /// This allocator picks one of the pools allowed for the client classes
+    /// at random and returns the next address or prefix of the permutation
+    /// of this pool, see @c Pool::nextRandom. The addresses or prefixes of
+    /// a pool are therefore returned in random order without repeats until
+    /// all of them were returned.
+    ///
+    /// The permutations are protected by a mutex per pool instead of the
+    /// mutex of the allocator: threads picking from distinct pools don't
+    /// wait for each other.
     class RandomAllocator : public Allocator {
     public:
 
@@ -243,12 +424,29 @@ protected:
         /// @param type - specifies allocation type
         RandomAllocator(Lease::Type type);
 
+        /// @brief Picks a random address
+        ///
+        /// It doesn't lock the mutex of the allocator: the state is kept
+        /// by the pools which protect it.
+        ///
+        /// @param subnet an address will be picked from pool of that subnet
+        /// @param client_classes list of classes client belongs to
+        /// @param duid Client's DUID (ignored)
+        /// @param hint the last address that was picked (ignored)
+        ///
+        /// @return a random address from the pool
+        virtual isc::asiolink::IOAddress
+        pickAddress(const SubnetPtr& subnet,
+                    const ClientClasses& client_classes,
+                    const DuidPtr& duid,
+                    const isc::asiolink::IOAddress& hint) {
+            return (pickAddressInternal(subnet, client_classes, duid, hint));
+        }
+
     private:
 
         /// @brief Returns a random address from pool of specified subnet
         ///
-        /// @todo: Implement this method
-        ///
         /// @param subnet an address will be picked from pool of that subnet
         /// @param client_classes list of classes client belongs to
         /// @param duid Client's DUID (ignored)
@@ -262,13 +460,144 @@ protected:
                             const isc::asiolink::IOAddress& hint);
     };
 
+    /// @brief Address/prefix allocator picking free leases from a queue
+    ///
+    /// The free addresses and delegated prefixes of the pools are put in
+    /// a @c FreeLeaseQueue when the server is configured, see @c populate.
+    /// Picking a lease then takes constant time instead of iterating over
+    /// the pools and looking up each candidate in the lease database. The
+    /// queue is kept up to date by @c addressUsed and @c addressFreed.
+    ///
+    /// Pools with more than @c MAX_QUEUED_CAPACITY leases, e.g. most IPv6
+    /// address pools, and pools which were not populated, e.g. pools added
+    /// by the configuration backend after the configuration, are iterated
+    /// over as by the @c IterativeAllocator.
+    class FreeLeaseQueueAllocator : public IterativeAllocator {
+    public:
+
+        /// @brief Maximum number of leases of a queued pool.
+        static const uint64_t MAX_QUEUED_CAPACITY = 1 << 20;
+
+        /// @brief Default constructor
+        ///
+        /// @param type - specifies allocation type
+        FreeLeaseQueueAllocator(Lease::Type type);
+
+        /// @brief Picks the next free address
+        ///
+        /// The queue is shared by all subnets: it locks the mutex of the
+        /// allocator, which also protects the iteration over pools which
+        /// are not queued.
+        ///
+        /// @param subnet next address will be returned from pool of that subnet
+        /// @param client_classes list of classes client belongs to
+        /// @param duid Client's DUID (ignored)
+        /// @param hint the last address that was picked (ignored)
+        ///
+        /// @return the next address
+        virtual isc::asiolink::IOAddress
+        pickAddress(const SubnetPtr& subnet,
+                    const ClientClasses& client_classes,
+                    const DuidPtr& duid,
+                    const isc::asiolink::IOAddress& hint) {
+            return (Allocator::pickAddress(subnet, client_classes, duid, hint));
+        }
+
+        /// @brief Removes all pools from the queue.
+        ///
+        /// It must be called when no packet is processed, e.g. when the
+        /// server is configured.
+        void clear();
+
+        /// @brief Puts the free leases of the pools of a subnet in the queue.
+        ///
+        /// It must be called when no packet is processed, e.g. when the
+        /// server is configured.
+        ///
+        /// @param subnet the pools of this subnet are populated
+        /// @param used addresses or prefixes of the subnet for which there
+        ///        is a lease which was not reclaimed
+        void populate(const SubnetPtr& subnet,
+                      const std::set<isc::asiolink::IOAddress>& used);
+
+        /// @brief Puts all the addresses or prefixes of the queued pools
+        /// of a subnet back in the queue.
+        ///
+        /// It is called when all the leases of the subnet were deleted,
+        /// possibly while packets are processed.
+        ///
+        /// @param subnet the pools of this subnet are refilled
+        void refill(const Subnet& subnet);
+
+    private:
+
+        /// @brief Appends the free addresses or prefixes of a pool to its
+        /// range in the queue.
+        ///
+        /// @param pool the queued pool
+        /// @param range_index the index of the range of the pool
+        /// @param prefix_len length of the delegated prefixes, 128 for the
+        ///        address pools
+        /// @param used addresses or prefixes of the pool which are not free
+        void fillRange(const PoolPtr& pool, const uint64_t range_index,
+                       const uint8_t prefix_len,
+                       const std::set<isc::asiolink::IOAddress>& used);
+
+        /// @brief Puts all the addresses or prefixes of the queued pools
+        /// of a subnet back in the queue.
+        ///
+        /// It must be called with the mutex held in multi-threading mode.
+        ///
+        /// @param subnet the pools of this subnet are refilled
+        void refillInternal(const Subnet& subnet);
+
+        /// @brief Returns the next free address or prefix from the queue
+        ///
+        /// Each call returns another free address or prefix of the pools
+        /// allowed for the client classes: the returned one is moved to the
+        /// end of the queue. It is removed when a lease is allocated for it.
+        ///
+        /// @param subnet next address will be returned from pool of that subnet
+        /// @param client_classes list of classes client belongs to
+        /// @param duid Client's DUID (ignored)
+        /// @param hint Client's hint (ignored)
+        ///
+        /// @return the next address or the zero address when there is no
+        /// free address in the allowed pools.
+        virtual isc::asiolink::IOAddress
+        pickAddressInternal(const SubnetPtr& subnet,
+                            const ClientClasses& client_classes,
+                            const DuidPtr& duid,
+                            const isc::asiolink::IOAddress& hint);
+
+        /// @brief Removes a leased address or prefix from the queue
+        ///
+        /// @param address leased address or prefix
+        /// @param prefix_len length of the prefix
+        virtual void
+        addressUsedInternal(const isc::asiolink::IOAddress& address,
+                            const uint8_t prefix_len);
+
+        /// @brief Appends a free address or prefix to the queue
+        ///
+        /// @param address free address or prefix
+        /// @param prefix_len length of the prefix
+        virtual void
+        addressFreedInternal(const isc::asiolink::IOAddress& address,
+                             const uint8_t prefix_len);
+
+        /// @brief The free leases of the populated pools.
+        FreeLeaseQueue queue_;
+    };
+
 public:
 
     /// @brief Specifies allocation type
     typedef enum {
         ALLOC_ITERATIVE, // iterative - one address after another
         ALLOC_HASHED,    // hashed - client's DUID/client-id is hashed
-        ALLOC_RANDOM     // random - an address is randomly selected
+        ALLOC_RANDOM,    // random - an address is randomly selected
+        ALLOC_FLQ        // flq - free leases are picked from a queue
     } AllocType;
 
     /// @brief Constructor.
@@ -278,7 +607,12 @@ public:
     /// network interaction. Will instantiate lease manager, and load
     /// old or create new DUID.
     ///
-    /// @param engine_type selects allocation algorithm
+    /// The engine holds an allocator of each type for each pool type: the
+    /// allocation algorithm is selected for each subnet by its allocator
+    /// parameter, see @c getAllocType.
+    ///
+    /// @param engine_type selects the default allocation algorithm, used
+    ///        for the subnets which don't specify an allocator
     /// @param attempts number of attempts for each lease allocation before
     ///        we give up (0 means unlimited)
     /// @param ipv6 specifies if the engine should work for IPv4 or IPv6
@@ -287,7 +621,7 @@ public:
     /// @brief Destructor.
     virtual ~AllocEngine() { }
 
-    /// @brief Returns allocator for a given pool type
+    /// @brief Returns the default allocator for a given pool type
     ///
     /// @param type type of pool (V4, IA, TA or PD)
     ///
@@ -296,21 +630,165 @@ public:
     /// @return pointer to allocator handling a given resource types
     AllocatorPtr getAllocator(Lease::Type type);
 
+    /// @brief Returns the allocator of a given type for a given pool type
+    ///
+    /// @param type type of pool (V4, IA, TA or PD)
+    /// @param alloc_type allocation type
+    ///
+    /// @throw BadValue if allocator for a given type is missing
+    ///
+    /// @return pointer to allocator handling a given resource types
+    AllocatorPtr getAllocator(Lease::Type type, AllocType alloc_type);
+
+    /// @brief Returns the allocation type given to the constructor.
+    AllocType getAllocType() const {
+        return (alloc_type_);
+    }
+
+    /// @brief Returns the allocation type of a subnet.
+    ///
+    /// The allocation type is given by the allocator parameter of the
+    /// subnet, inherited from its shared network and the global scope.
+    ///
+    /// @param subnet the subnet.
+    ///
+    /// @return the allocation type of the subnet, the type given to the
+    /// constructor when the subnet doesn't specify an allocator.
+    AllocType getAllocType(const SubnetPtr& subnet) const;
+
+    /// @brief Populates the free lease queues of the DHCPv4 allocator.
+    ///
+    /// The free lease queue is cleared and the free addresses of the pools
+    /// of the subnets using the @c ALLOC_FLQ allocation type are put in the
+    /// queue, according to the leases in the lease database. It must be
+    /// called when no packet is processed, after the configuration was
+    /// committed.
+    ///
+    /// @param subnets the configured subnets.
+    void initFreeLeaseQueues(const CfgSubnets4Ptr& subnets);
+
+    /// @brief Populates the free lease queues of the DHCPv6 allocators.
+    ///
+    /// This is the DHCPv6 version of the function above, it populates the
+    /// free lease queues of the IA_NA, IA_TA and IA_PD allocators.
+    ///
+    /// @param subnets the configured subnets.
+    void initFreeLeaseQueues(const CfgSubnets6Ptr& subnets);
+
+    /// @brief Tells the allocator that the address of a lease is used.
+    ///
+    /// It is called when a lease is added to the lease database or an
+    /// expired lease is reused. It does nothing unless free lease queues
+    /// were populated.
+    ///
+    /// @param lease the lease.
+    void leaseUsed(const Lease4Ptr& lease) const;
+
+    /// @brief Tells the allocator that the address or prefix of a lease
+    /// is used.
+    ///
+    /// @param lease the lease.
+    void leaseUsed(const Lease6Ptr& lease) const;
+
+    /// @brief Tells the allocator that the address of a lease is free.
+    ///
+    /// It is called when a lease is released, deleted or reclaimed,
+    /// including by the server, e.g. when processing a DHCPRELEASE. It
+    /// does nothing unless free lease queues were populated.
+    ///
+    /// @param lease the lease.
+    void leaseFreed(const Lease4Ptr& lease) const;
+
+    /// @brief Tells the allocator that the address or prefix of a lease
+    /// is free.
+    ///
+    /// @param lease the lease.
+    void leaseFreed(const Lease6Ptr& lease) const;
+
+    /// @brief Tells the allocators that all the leases of a subnet were
+    /// deleted.
+    ///
+    /// It is called when the leases of the subnet are wiped: all the
+    /// addresses and prefixes of its pools are free. It does nothing
+    /// unless free lease queues were populated.
+    ///
+    /// @param subnet the subnet.
+    void leasesWiped(const Subnet& subnet) const;
+
+    /// @brief Maximum number of leases in a reclamation batch.
+    static const size_t MAX_RECLAIM_BATCH_SIZE = 10000;
+
+    /// @brief Maximum number of lease reclamation threads.
+    static const size_t MAX_RECLAIM_THREADS = 256;
+
+    /// @brief Sets the number of expired leases reclaimed in a batch.
+    ///
+    /// The reclamation routines write the leases of a batch to the lease
+    /// database at once, using @c LeaseMgr::updateLeases4 or
+    /// @c LeaseMgr::updateLeases6, i.e. in a single transaction with the
+    /// SQL backends. When multi-threading is enabled, the packet processing
+    /// is suspended for the whole batch rather than for each lease.
+    ///
+    /// @param batch_size the number of leases per batch, between 1 (the
+    /// default, the leases are reclaimed one by one) and
+    /// @c MAX_RECLAIM_BATCH_SIZE.
+    /// @throw BadValue if the value is out of range.
+    void setReclaimBatchSize(const size_t batch_size);
+
+    /// @brief Returns the number of expired leases reclaimed in a batch.
+    size_t getReclaimBatchSize() const {
+        return (reclaim_batch_size_);
+    }
+
+    /// @brief Sets the number of threads reclaiming the expired leases.
+    ///
+    /// When this number is not 0 and multi-threading is enabled, the
+    /// expired leases are partitioned by subnet and each partition is
+    /// reclaimed by a thread of a dedicated pool, one batch at a time.
+    /// The packet processing is suspended while the threads reclaim
+    /// a batch of each partition.
+    ///
+    /// @param thread_count the number of threads, between 0 (the default,
+    /// the leases are reclaimed by the calling thread) and
+    /// @c MAX_RECLAIM_THREADS.
+    /// @throw BadValue if the value is out of range.
+    void setReclaimThreads(const size_t thread_count);
+
+    /// @brief Returns the number of threads reclaiming the expired leases.
+    size_t getReclaimThreads() const {
+        return (reclaim_threads_);
+    }
+
 private:
 
-    /// @brief A pointer to currently used allocator
+    /// @brief Allocators by allocation type
     ///
-    /// For IPv4, there will be only one allocator: TYPE_V4
-    /// For IPv6, there will be 3 allocators: TYPE_NA, TYPE_TA, TYPE_PD
-    std::map<Lease::Type, AllocatorPtr> allocators_;
+    /// For IPv4, there will be only one allocator per type: TYPE_V4
+    /// For IPv6, there will be 3 allocators per type: TYPE_NA, TYPE_TA, TYPE_PD
+    std::map<AllocType, std::map<Lease::Type, AllocatorPtr> > allocators_;
 
     /// @brief number of attempts before we give up lease allocation (0=unlimited)
     uint64_t attempts_;
 
+    /// @brief allocation type given to the constructor
+    AllocType alloc_type_;
+
+    /// @brief Flag indicating if subnets were put in the free lease queues
+    bool free_lease_queues_;
+
     /// @brief Hook name indexes (used in hooks callouts)
     int hook_index_lease4_select_; ///< index for lease4_select hook
     int hook_index_lease6_select_; ///< index for lease6_select hook
 
+    /// @brief Number of expired leases reclaimed in a batch.
+    size_t reclaim_batch_size_;
+
+    /// @brief Number of threads reclaiming the expired leases.
+    size_t reclaim_threads_;
+
+    /// @brief Thread pool reclaiming the expired leases by subnet.
+    isc::util::ThreadPool<std::function<void()> > reclaim_pool_;
+
 public:
 
     /// @brief Defines a single hint
@@ -596,6 +1074,19 @@ public:
         /// @brief Container holding IA specific contexts.
         std::vector<IAContext> ias_;
 
+        /// @brief Leases of the client prefetched from the lease database.
+        ///
+        /// When the client sends several IAs, all the leases of its DUID
+        /// are fetched by the first lookup and the leases of each IA are
+        /// taken from this collection, saving a lookup per IA.
+        Lease6Collection prefetched_leases_;
+
+        /// @brief Indicates if @c prefetched_leases_ can be used.
+        bool leases_prefetched_;
+
+        /// @brief Type and IAID of the IAs whose leases were looked up.
+        std::set<std::pair<Lease::Type, uint32_t> > looked_up_ias_;
+
         /// @brief Returns the set of DDNS behavioral parameters based on
         /// the selected subnet.
         ///
@@ -1205,22 +1696,6 @@ private:
         DB_RECLAIM_LEAVE_UNCHANGED
     };
 
-    /// @brief Reclaim DHCPv4 or DHCPv6 lease with updating lease database.
-    ///
-    /// This method is called by the lease reclamation routine to reclaim the
-    /// lease and update the lease database according to the value of the
-    /// @c remove_lease parameter.
-    ///
-    /// @param lease Pointer to the DHCPv4 or DHCPv6 lease.
-    /// @param remove_lease A boolean flag indicating if the lease should be
-    /// removed from the lease database (if true) upon reclamation.
-    /// @param callout_handle Pointer to the callout handle.
-    /// @tparam LeasePtrPtr Lease type, i.e. @c Lease4Ptr or @c Lease6Ptr.
-    template<typename LeasePtrType>
-    void reclaimExpiredLease(const LeasePtrType& lease,
-                             const bool remove_lease,
-                             const hooks::CalloutHandlePtr& callout_handle);
-
     /// @brief Reclaim DHCPv4 or DHCPv6 lease without updating lease database.
     ///
     /// This method is called by the methods allocating leases, when the lease
@@ -1263,29 +1738,112 @@ private:
                              const DbReclaimMode& reclaim_mode,
                              const hooks::CalloutHandlePtr& callout_handle);
 
-    /// @brief Marks lease as reclaimed in the database.
+    /// @brief Operation on the lease database reclaiming a lease.
+    enum ReclaimDbOp {
+        RECLAIM_DB_NONE,   ///< the lease is left unchanged
+        RECLAIM_DB_UPDATE, ///< the lease is set to "expired-reclaimed"
+        RECLAIM_DB_DELETE  ///< the lease is removed
+    };
+
+    /// @brief Starts the reclamation of a DHCPv6 lease.
     ///
-    /// This method is called internally by the leases reclamation routines.
-    /// Depending on the value of the @c remove_lease parameter this method
-    /// will delete the reclaimed lease from the database or set its sate
-    /// to "expired-reclaimed". In the latter case it will also clear the
-    /// FQDN information.
+    /// This method executes the steps preceding the lease database update:
+    /// the "lease6_expire" callouts, the DNS removal, the declined lease
+    /// recovery and the update of the lease to the "expired-reclaimed"
+    /// state, when it is kept in the database.
     ///
-    /// This method may throw exceptions if the operation on the lease database
-    /// fails for any reason.
+    /// @param lease Pointer to the DHCPv6 lease.
+    /// @param reclaim_mode Indicates what the method should do with the reclaimed
+    /// lease in the lease database.
+    /// @param callout_handle Pointer to the callout handle.
     ///
-    /// @param lease Pointer to the lease.
-    /// @param remove_lease Boolean flag indicating if the lease should be
-    /// removed from the database (if true).
-    /// @param lease_update_fun Pointer to the function in the @c LeaseMgr to
-    /// be used to update the lease if the @c remove_lease is set to false.
+    /// @return The operation to be executed on the lease database.
+    ReclaimDbOp startLeaseReclamation(const Lease6Ptr& lease,
+                                      const DbReclaimMode& reclaim_mode,
+                                      const hooks::CalloutHandlePtr& callout_handle);
+
+    /// @brief Starts the reclamation of a DHCPv4 lease.
     ///
-    /// @tparam LeasePtrType One of the @c Lease6Ptr or @c Lease4Ptr.
-    template<typename LeasePtrType>
-    void reclaimLeaseInDatabase(const LeasePtrType& lease,
-                                const bool remove_lease,
-                                const std::function<void (const LeasePtrType&)>&
-                                lease_update_fun) const;
+    /// See the DHCPv6 version above for details.
+    ///
+    /// @param lease Pointer to the DHCPv4 lease.
+    /// @param reclaim_mode Indicates what the method should do with the reclaimed
+    /// lease in the lease database.
+    /// @param callout_handle Pointer to the callout handle.
+    ///
+    /// @return The operation to be executed on the lease database.
+    ReclaimDbOp startLeaseReclamation(const Lease4Ptr& lease,
+                                      const DbReclaimMode& reclaim_mode,
+                                      const hooks::CalloutHandlePtr& callout_handle);
+
+    /// @brief Completes the reclamation of a DHCPv6 lease.
+    ///
+    /// Called once the lease database has been updated: gives the
+    /// address or prefix back to the allocator and updates the
+    /// statistics of assigned and reclaimed leases.
+    ///
+    /// @param lease Pointer to the DHCPv6 lease.
+    /// @param db_op The operation executed on the lease database.
+    void finishLeaseReclamation(const Lease6Ptr& lease, const ReclaimDbOp& db_op);
+
+    /// @brief Completes the reclamation of a DHCPv4 lease.
+    ///
+    /// @param lease Pointer to the DHCPv4 lease.
+    /// @param db_op The operation executed on the lease database.
+    void finishLeaseReclamation(const Lease4Ptr& lease, const ReclaimDbOp& db_op);
+
+    /// @brief Reclaims a batch of expired leases.
+    ///
+    /// Starts the reclamation of the leases, executes the operations on
+    /// the lease database at once, then completes the reclamation. When
+    /// the lease database fails the batch, the operations are retried one
+    /// by one. The leases which can't be reclaimed are logged.
+    ///
+    /// @param leases The expired leases.
+    /// @param first Index of the first lease of the batch.
+    /// @param last Index following the last lease of the batch.
+    /// @param reclaim_mode Indicates what the method should do with the reclaimed
+    /// lease in the lease database.
+    /// @param callout_handle Pointer to the callout handle.
+    ///
+    /// @return The number of reclaimed leases.
+    /// @tparam LeaseCollectionType One of the @c Lease6Collection or
+    /// @c Lease4Collection.
+    template<typename LeaseCollectionType>
+    size_t reclaimLeaseBatch(const LeaseCollectionType& leases,
+                             const size_t first, const size_t last,
+                             const DbReclaimMode& reclaim_mode,
+                             const hooks::CalloutHandlePtr& callout_handle);
+
+    /// @brief Reclaims expired leases in batches.
+    ///
+    /// This is the common part of the @c reclaimExpiredLeases4 and
+    /// @c reclaimExpiredLeases6. The leases are reclaimed by batches of
+    /// @c reclaim_batch_size_ leases. When multi-threading is enabled the
+    /// reclamation of a batch is exclusive of the packet processing and,
+    /// when reclamation threads were configured, the leases are partitioned
+    /// by subnet and the batches of the partitions are reclaimed in
+    /// parallel.
+    ///
+    /// @param leases The expired leases.
+    /// @param remove_lease A boolean value indicating if the lease should
+    /// be removed when it is reclaimed.
+    /// @param hook_index Index of the "lease4_expire" or "lease6_expire"
+    /// hook point.
+    /// @param timeout Maximum amount of time that the reclamation routine
+    /// may be processing expired leases, expressed in milliseconds.
+    /// @param stopwatch The stopwatch started by the reclamation routine.
+    /// @param [out] timed_out Set to true if the timeout was reached.
+    ///
+    /// @return The number of reclaimed leases.
+    /// @tparam LeaseCollectionType One of the @c Lease6Collection or
+    /// @c Lease4Collection.
+    template<typename LeaseCollectionType>
+    size_t reclaimLeases(const LeaseCollectionType& leases,
+                         const bool remove_lease, const int hook_index,
+                         const uint16_t timeout,
+                         const isc::util::Stopwatch& stopwatch,
+                         bool& timed_out);
 
     /// @anchor reclaimDeclinedLease4
     /// @brief Conducts steps necessary for reclaiming declined IPv4 lease.
@@ -1402,6 +1960,20 @@ public:
         /// received by the server.
         IdentifierList host_identifiers_;
 
+        /// @brief Leases of the client prefetched from the lease database.
+        ///
+        /// The leases with the HW address or the client identifier of the
+        /// client and the lease for the requested address are fetched by
+        /// one lookup, instead of one lookup for each. They are only used
+        /// before the allocation engine updates the lease database.
+        Lease4Collection prefetched_leases_;
+
+        /// @brief Indicates if @c prefetched_leases_ can be used.
+        bool leases_prefetched_;
+
+        /// @brief Address of the lease included in @c prefetched_leases_.
+        asiolink::IOAddress prefetched_address_;
+
         /// @brief Returns the set of DDNS behavioral parameters based on
         /// the selected subnet.
         ///
@@ -1786,6 +2358,21 @@ private:
     /// was not successful.
     Lease4Ptr allocateUnreservedLease4(ClientContext4& ctx);
 
+    /// @brief Looks up the lease at the preferred address of the client.
+    ///
+    /// With the hashed allocator a returning client usually holds the
+    /// lease at its preferred address in the selected subnet: a single
+    /// lookup by address then replaces the lookups by client identifier
+    /// and by HW address. The hits and misses are counted by the
+    /// v4-hashed-allocator-hits and v4-hashed-allocator-misses statistics.
+    ///
+    /// @param ctx Client context holding the data extracted from the
+    /// client's message.
+    ///
+    /// @return The lease at the preferred address when it belongs to the
+    /// client, null otherwise or when the allocator is not hashed.
+    Lease4Ptr findPreferredLease4(ClientContext4& ctx);
+
     /// @brief Updates the specified lease with the information from a context.
     ///
     /// The context, specified as an argument to this method, holds various
@@ -0,0 +1,360 @@
+// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <asiolink/io_address.h>
+#include <dhcp/duid.h>
+#include <dhcp/hwaddr.h>
+#include <dhcp/pkt4.h>
+#include <dhcpsrv/alloc_engine.h>
+#include <dhcpsrv/benchmarks/parameters.h>
+#include <dhcpsrv/lease_mgr_factory.h>
+#include <dhcpsrv/subnet.h>
+#include <util/multi_threading_mgr.h>
+
+#include <boost/scoped_ptr.hpp>
+
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace isc::asiolink;
+using namespace isc::dhcp;
+using namespace isc::dhcp::bench;
+using namespace isc::util;
+
+namespace {
+
+/// @brief Allocation engine exposing its allocators.
+class BenchAllocEngine : public AllocEngine {
+public:
+    using AllocEngine::Allocator;
+    using AllocEngine::IterativeAllocator;
+    using AllocEngine::RandomAllocator;
+};
+
+/// @brief Number of pools of the subnet used by the contention benchmarks.
+constexpr size_t CONTENTION_POOLS = 16;
+
+/// @brief Number of addresses of each pool of the contention benchmarks.
+constexpr size_t CONTENTION_POOL_SIZE = 256;
+
+/// @brief Number of subnets of the many subnets benchmarks.
+constexpr size_t CONTENTION_SUBNETS = 64;
+
+/// @brief Ratio of the addresses left free in the nearly full pools.
+constexpr size_t FREE_RATIO = 100;
+
+/// @brief This is a fixture class used for benchmarking the allocators
+/// picking addresses concurrently.
+///
+/// The subnet and the allocators are shared by the threads of the
+/// benchmarks.
+class AllocatorContentionBenchmark : public ::benchmark::Fixture {
+public:
+    /// @brief Constructor
+    ///
+    /// Creates a subnet with 16 pools of 256 addresses.
+    AllocatorContentionBenchmark()
+        : subnet_(new Subnet4(IOAddress("10.0.0.0"), 8, 1, 2, 3)),
+          iterative_(new BenchAllocEngine::IterativeAllocator(Lease::TYPE_V4)),
+          random_(new BenchAllocEngine::RandomAllocator(Lease::TYPE_V4)),
+          classes_(), clientid_() {
+        for (size_t i = 0; i < CONTENTION_POOLS; ++i) {
+            IOAddress first(static_cast<uint32_t>(0x0a000000 +
+                                                  i * CONTENTION_POOL_SIZE));
+            IOAddress last(first.toUint32() + CONTENTION_POOL_SIZE - 1);
+            subnet_->addPool(Pool4Ptr(new Pool4(first, last)));
+        }
+    }
+
+    /// @brief Enables the multi-threading mode.
+    ///
+    /// It is called by each thread.
+    void SetUp(::benchmark::State const&) override {
+        MultiThreadingMgr::instance().setMode(true);
+    }
+
+    void SetUp(::benchmark::State& s) override {
+        ::benchmark::State const& cs = s;
+        SetUp(cs);
+    }
+
+    /// @brief Disables the multi-threading mode.
+    ///
+    /// It is called by each thread once all of them stopped picking
+    /// addresses.
+    void TearDown(::benchmark::State const&) override {
+        MultiThreadingMgr::instance().setMode(false);
+    }
+
+    void TearDown(::benchmark::State& s) override {
+        ::benchmark::State const& cs = s;
+        TearDown(cs);
+    }
+
+    /// @brief Picks addresses until the benchmark ends.
+    ///
+    /// @param state Benchmark state.
+    /// @param allocator The allocator picking the addresses.
+    void benchPickAddress(::benchmark::State& state,
+                          BenchAllocEngine::Allocator& allocator) {
+        while (state.KeepRunning()) {
+            ::benchmark::DoNotOptimize(allocator.pickAddress(subnet_, classes_,
+                                                             clientid_,
+                                                             IOAddress::IPV4_ZERO_ADDRESS()));
+        }
+    }
+
+    /// @brief The subnet the addresses are picked from.
+    Subnet4Ptr subnet_;
+
+    /// @brief The iterative allocator.
+    boost::scoped_ptr<BenchAllocEngine::Allocator> iterative_;
+
+    /// @brief The random allocator.
+    boost::scoped_ptr<BenchAllocEngine::Allocator> random_;
+
+    /// @brief The client classes (none).
+    ClientClasses classes_;
+
+    /// @brief The client DUID (ignored by the allocators).
+    DuidPtr clientid_;
+};
+
+/// @brief This is a fixture class used for benchmarking the allocators
+/// picking addresses concurrently from many subnets.
+///
+/// Each thread picks from all subnets in turn, starting from a subnet
+/// chosen by its thread identifier, so the threads mostly pick from
+/// distinct subnets.
+class AllocatorSubnetsBenchmark : public ::benchmark::Fixture {
+public:
+    /// @brief Constructor
+    ///
+    /// Creates 64 subnets with a pool of 256 addresses each.
+    AllocatorSubnetsBenchmark()
+        : subnets_(),
+          iterative_(new BenchAllocEngine::IterativeAllocator(Lease::TYPE_V4)),
+          classes_(), clientid_() {
+        for (size_t i = 0; i < CONTENTION_SUBNETS; ++i) {
+            IOAddress prefix(static_cast<uint32_t>(0x0a000000 + (i << 16)));
+            Subnet4Ptr subnet(new Subnet4(prefix, 16, 1, 2, 3, i + 1));
+            IOAddress last(prefix.toUint32() + CONTENTION_POOL_SIZE - 1);
+            subnet->addPool(Pool4Ptr(new Pool4(prefix, last)));
+            subnets_.push_back(subnet);
+        }
+    }
+
+    /// @brief Enables the multi-threading mode.
+    ///
+    /// It is called by each thread.
+    void SetUp(::benchmark::State const&) override {
+        MultiThreadingMgr::instance().setMode(true);
+    }
+
+    void SetUp(::benchmark::State& s) override {
+        ::benchmark::State const& cs = s;
+        SetUp(cs);
+    }
+
+    /// @brief Disables the multi-threading mode.
+    ///
+    /// It is called by each thread once all of them stopped picking
+    /// addresses.
+    void TearDown(::benchmark::State const&) override {
+        MultiThreadingMgr::instance().setMode(false);
+    }
+
+    void TearDown(::benchmark::State& s) override {
+        ::benchmark::State const& cs = s;
+        TearDown(cs);
+    }
+
+    /// @brief Picks addresses until the benchmark ends.
+    ///
+    /// @param state Benchmark state.
+    /// @param allocator The allocator picking the addresses.
+    void benchPickAddress(::benchmark::State& state,
+                          BenchAllocEngine::Allocator& allocator) {
+        size_t next = std::hash<std::thread::id>()(std::this_thread::get_id());
+        while (state.KeepRunning()) {
+            const Subnet4Ptr& subnet = subnets_[next++ % subnets_.size()];
+            ::benchmark::DoNotOptimize(allocator.pickAddress(subnet, classes_,
+                                                             clientid_,
+                                                             IOAddress::IPV4_ZERO_ADDRESS()));
+        }
+    }
+
+    /// @brief The subnets the addresses are picked from.
+    std::vector<Subnet4Ptr> subnets_;
+
+    /// @brief The iterative allocator.
+    boost::scoped_ptr<BenchAllocEngine::Allocator> iterative_;
+
+    /// @brief The client classes (none).
+    ClientClasses classes_;
+
+    /// @brief The client DUID (ignored by the allocator).
+    DuidPtr clientid_;
+};
+
+/// @brief This is a fixture class used for benchmarking the allocation
+/// of leases in nearly full pools.
+///
+/// The pool holds as many addresses as the benchmark parameter and all
+/// but one in a hundred are leased. The allocation engine offers a lease,
+/// as for a DHCPDISCOVER, so the pool stays as full between the iterations.
+class AllocatorFullPoolBenchmark : public ::benchmark::Fixture {
+public:
+    /// @brief Setup routine.
+    ///
+    /// Starts a memfile lease manager without persistence.
+    void SetUp(::benchmark::State const&) override {
+        try {
+            LeaseMgrFactory::destroy();
+            LeaseMgrFactory::create("type=memfile universe=4 persist=false");
+        } catch (...) {
+            std::cerr << "ERROR: unable to start memfile backend." << std::endl;
+            throw;
+        }
+    }
+
+    void SetUp(::benchmark::State& s) override {
+        ::benchmark::State const& cs = s;
+        SetUp(cs);
+    }
+
+    /// @brief Cleans up after the test.
+    void TearDown(::benchmark::State const&) override {
+        engine_.reset();
+        LeaseMgrFactory::destroy();
+    }
+
+    void TearDown(::benchmark::State& s) override {
+        ::benchmark::State const& cs = s;
+        TearDown(cs);
+    }
+
+    /// @brief Creates the subnet, fills its pool and the engine.
+    ///
+    /// @param state Benchmark state.
+    /// @param alloc_type The allocator of the engine.
+    /// @param pool_size Number of addresses of the pool.
+    void setUpFullPool(::benchmark::State& state,
+                       AllocEngine::AllocType alloc_type,
+                       size_t pool_size) {
+        state.PauseTiming();
+        SetUp(state);
+        subnet_.reset(new Subnet4(IOAddress("10.0.0.0"), 8, 1, 2, 3600));
+        IOAddress first("10.0.0.1");
+        IOAddress last(first.toUint32() + pool_size - 1);
+        subnet_->addPool(Pool4Ptr(new Pool4(first, last)));
+
+        for (size_t i = 0; i < pool_size; ++i) {
+            if ((i % FREE_RATIO) == 0) {
+                continue;
+            }
+            std::vector<uint8_t> mac(6);
+            for (size_t j = 0; j < 4; ++j) {
+                mac[2 + j] = static_cast<uint8_t>(i >> (8 * (3 - j)));
+            }
+            HWAddrPtr hwaddr(new HWAddr(mac, HTYPE_ETHER));
+            Lease4Ptr lease(new Lease4(IOAddress(first.toUint32() + i), hwaddr,
+                                       ClientIdPtr(), 3600, time(NULL),
+                                       subnet_->getID()));
+            LeaseMgrFactory::instance().addLease(lease);
+        }
+
+        engine_.reset(new AllocEngine(alloc_type, 0, false));
+        std::vector<uint8_t> mac(6, 0xff);
+        hwaddr_.reset(new HWAddr(mac, HTYPE_ETHER));
+        state.ResumeTiming();
+    }
+
+    /// @brief Offers leases until the benchmark ends.
+    ///
+    /// @param state Benchmark state.
+    void benchOfferLease4(::benchmark::State& state) {
+        while (state.KeepRunning()) {
+            AllocEngine::ClientContext4 ctx(subnet_, ClientIdPtr(), hwaddr_,
+                                            IOAddress::IPV4_ZERO_ADDRESS(),
+                                            false, false, "", true);
+            ctx.query_.reset(new Pkt4(DHCPDISCOVER, 1234));
+            ::benchmark::DoNotOptimize(engine_->allocateLease4(ctx));
+        }
+    }
+
+    /// @brief The subnet the leases are allocated from.
+    Subnet4Ptr subnet_;
+
+    /// @brief The allocation engine.
+    boost::scoped_ptr<AllocEngine> engine_;
+
+    /// @brief The hardware address of the client.
+    HWAddrPtr hwaddr_;
+};
+
+// Defines a benchmark that measures the iterative allocator picking
+// addresses from concurrent threads.
+BENCHMARK_DEFINE_F(AllocatorContentionBenchmark, iterativePickAddress)(benchmark::State& state) {
+    benchPickAddress(state, *iterative_);
+}
+
+// Defines a benchmark that measures the random allocator picking
+// addresses from concurrent threads.
+BENCHMARK_DEFINE_F(AllocatorContentionBenchmark, randomPickAddress)(benchmark::State& state) {
+    benchPickAddress(state, *random_);
+}
+
+// Defines a benchmark that measures the iterative allocator picking
+// addresses from many subnets from concurrent threads.
+BENCHMARK_DEFINE_F(AllocatorSubnetsBenchmark, iterativePickAddress)(benchmark::State& state) {
+    benchPickAddress(state, *iterative_);
+}
+
+// Defines a benchmark that measures lease offers from a nearly full pool
+// with the iterative allocator.
+BENCHMARK_DEFINE_F(AllocatorFullPoolBenchmark, iterativeOfferLease4)(benchmark::State& state) {
+    const size_t pool_size = state.range(0);
+    setUpFullPool(state, AllocEngine::ALLOC_ITERATIVE, pool_size);
+    benchOfferLease4(state);
+}
+
+// Defines a benchmark that measures lease offers from a nearly full pool
+// with the random allocator.
+BENCHMARK_DEFINE_F(AllocatorFullPoolBenchmark, randomOfferLease4)(benchmark::State& state) {
+    const size_t pool_size = state.range(0);
+    setUpFullPool(state, AllocEngine::ALLOC_RANDOM, pool_size);
+    benchOfferLease4(state);
+}
+
+/// A benchmark that measures the iterative allocator with 1 to 16 threads.
+BENCHMARK_REGISTER_F(AllocatorContentionBenchmark, iterativePickAddress)
+    ->ThreadRange(1, 16)->UseRealTime()->Unit(UNIT);
+
+/// A benchmark that measures the random allocator with 1 to 16 threads.
+BENCHMARK_REGISTER_F(AllocatorContentionBenchmark, randomPickAddress)
+    ->ThreadRange(1, 16)->UseRealTime()->Unit(UNIT);
+
+/// A benchmark that measures the iterative allocator picking from many
+/// subnets with 1 to 16 threads.
+BENCHMARK_REGISTER_F(AllocatorSubnetsBenchmark, iterativePickAddress)
+    ->ThreadRange(1, 16)->UseRealTime()->Unit(UNIT);
+
+/// A benchmark that measures offers from a nearly full pool with the
+/// iterative allocator.
+BENCHMARK_REGISTER_F(AllocatorFullPoolBenchmark, iterativeOfferLease4)
+    ->Range(MIN_LEASE_COUNT, MAX_LEASE_COUNT)->Unit(UNIT);
+
+/// A benchmark that measures offers from a nearly full pool with the
+/// random allocator.
+BENCHMARK_REGISTER_F(AllocatorFullPoolBenchmark, randomOfferLease4)
+    ->Range(MIN_LEASE_COUNT, MAX_LEASE_COUNT)->Unit(UNIT);
+
+}  // namespace
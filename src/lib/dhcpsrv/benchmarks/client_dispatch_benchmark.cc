@@ -0,0 +1,144 @@
+// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <dhcpsrv/benchmarks/parameters.h>
+#include <util/thread_pool.h>
+
+#include <benchmark/benchmark.h>
+#include <boost/functional/hash.hpp>
+#include <boost/make_shared.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <unordered_set>
+
+using namespace isc::dhcp::bench;
+using namespace isc::util;
+
+namespace {
+
+/// @brief Number of clients sending queries.
+constexpr size_t CLIENT_COUNT = 256;
+
+/// @brief Number of consecutive queries of a client, e.g. a query and its
+/// retransmissions.
+constexpr size_t BURST_SIZE = 4;
+
+/// @brief Number of queries dispatched by iteration.
+constexpr size_t QUERY_COUNT = 4096;
+
+/// @brief Time spent processing a query.
+constexpr std::chrono::microseconds PROCESSING_TIME(10);
+
+/// @brief Type of the work items.
+typedef std::function<void()> CallBack;
+
+/// @brief This is a fixture class used for benchmarking the dispatch of
+/// the queries to the packet processing threads.
+///
+/// The queries arrive in bursts from the same client. As the client
+/// handler of the servers does, a query is dropped when another thread is
+/// processing a query of the same client. With the shared queue the
+/// queries of a burst are taken by distinct threads and conflict, with the
+/// client affinity they are processed in turn by the same thread.
+class ClientDispatchBenchmark : public ::benchmark::Fixture {
+public:
+
+    /// @brief Dispatches the queries until the benchmark ends.
+    ///
+    /// The number of threads is the benchmark parameter. The "conflicts"
+    /// counter is the number of dropped queries by iteration, the
+    /// "imbalance" counter is the imbalance of the thread queues (see
+    /// @c ThreadPool::getAffinityImbalance).
+    ///
+    /// @param state Benchmark state.
+    /// @param affinity Whether the queries are dispatched by client.
+    void benchDispatch(::benchmark::State& state, bool affinity) {
+        conflicts_ = 0;
+        busy_.clear();
+        thread_pool_.setAffinity(affinity);
+        thread_pool_.start(state.range(0));
+
+        while (state.KeepRunning()) {
+            for (size_t i = 0; i < QUERY_COUNT; ++i) {
+                size_t client = (i / BURST_SIZE * 7919) % CLIENT_COUNT;
+                auto call_back = boost::make_shared<CallBack>(
+                    std::bind(&ClientDispatchBenchmark::processQuery, this, client));
+                if (affinity) {
+                    thread_pool_.add(call_back, boost::hash<size_t>()(client));
+                } else {
+                    thread_pool_.add(call_back);
+                }
+            }
+            thread_pool_.wait();
+        }
+
+        state.counters["conflicts"] =
+            ::benchmark::Counter(static_cast<double>(conflicts_),
+                                 ::benchmark::Counter::kAvgIterations);
+        state.counters["imbalance"] = thread_pool_.getAffinityImbalance();
+        thread_pool_.reset();
+    }
+
+    /// @brief Processes a query or drops it when another thread is
+    /// processing a query of the same client.
+    ///
+    /// @param client Client of the query.
+    void processQuery(size_t client) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!busy_.insert(client).second) {
+                ++conflicts_;
+                return;
+            }
+        }
+        auto end = std::chrono::steady_clock::now() + PROCESSING_TIME;
+        while (std::chrono::steady_clock::now() < end) {
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        busy_.erase(client);
+    }
+
+    /// @brief The packet processing threads.
+    ThreadPool<CallBack> thread_pool_;
+
+    /// @brief Mutex protecting the busy clients.
+    std::mutex mutex_;
+
+    /// @brief The clients whose query is being processed.
+    std::unordered_set<size_t> busy_;
+
+    /// @brief The number of dropped queries.
+    std::atomic<uint64_t> conflicts_;
+};
+
+// Defines a benchmark that measures the dispatch of the queries to the
+// shared queue of the threads.
+BENCHMARK_DEFINE_F(ClientDispatchBenchmark, sharedQueue)(benchmark::State& state) {
+    benchDispatch(state, false);
+}
+
+// Defines a benchmark that measures the dispatch of the queries to the
+// queue of the thread of their client.
+BENCHMARK_DEFINE_F(ClientDispatchBenchmark, clientAffinity)(benchmark::State& state) {
+    benchDispatch(state, true);
+}
+
+/// A benchmark that measures the dispatch of the queries to the shared
+/// queue of 2, 4, 8 and 16 threads.
+BENCHMARK_REGISTER_F(ClientDispatchBenchmark, sharedQueue)
+    ->RangeMultiplier(2)->Range(2, 16)->UseRealTime()->Unit(UNIT);
+
+/// A benchmark that measures the dispatch of the queries to the queue of
+/// the thread of their client with 2, 4, 8 and 16 threads.
+BENCHMARK_REGISTER_F(ClientDispatchBenchmark, clientAffinity)
+    ->RangeMultiplier(2)->Range(2, 16)->UseRealTime()->Unit(UNIT);
+
+}  // namespace
@@ -0,0 +1,119 @@
+// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <asiolink/io_address.h>
+#include <dhcpsrv/benchmarks/parameters.h>
+#include <dhcpsrv/csv_lease_file4.h>
+
+#include <benchmark/benchmark.h>
+#include <boost/scoped_ptr.hpp>
+
+#include <cstdio>
+#include <sstream>
+#include <vector>
+
+using namespace isc::asiolink;
+using namespace isc::dhcp;
+using namespace isc::dhcp::bench;
+
+namespace {
+
+/// @brief Number of leases appended to the lease file by iteration.
+constexpr size_t LEASE_COUNT = 4096;
+
+/// @brief This is a fixture class used for benchmarking the appends of
+/// the lease changes to the memfile lease file.
+///
+/// The leases are appended to a DHCPv4 lease file which is flushed after
+/// the number of leases given by the benchmark parameter, as with the
+/// flush-records parameter of the memfile lease manager.
+class LeaseFileBenchmark : public ::benchmark::Fixture {
+public:
+
+    /// @brief Creates the leases and the lease file.
+    void setUpLeaseFile() {
+        leases_.clear();
+        for (size_t i = 0; i < LEASE_COUNT; ++i) {
+            Lease4Ptr lease(new Lease4());
+            lease->addr_ = IOAddress(static_cast<uint32_t>(0x0a000001 + i));
+            std::vector<uint8_t> hwaddr(6, 0);
+            hwaddr[4] = static_cast<uint8_t>(i >> 8);
+            hwaddr[5] = static_cast<uint8_t>(i);
+            lease->hwaddr_.reset(new HWAddr(hwaddr, HTYPE_ETHER));
+            std::vector<uint8_t> client_id(8, 1);
+            client_id[6] = static_cast<uint8_t>(i >> 8);
+            client_id[7] = static_cast<uint8_t>(i);
+            lease->client_id_.reset(new ClientId(client_id));
+            lease->valid_lft_ = 3600;
+            lease->cltt_ = time(0);
+            lease->subnet_id_ = 1;
+            std::ostringstream hostname;
+            hostname << "host" << i << ".example.org";
+            lease->hostname_ = hostname.str();
+            leases_.push_back(lease);
+        }
+
+        std::remove(getLeaseFilePath().c_str());
+        lease_file_.reset(new CSVLeaseFile4(getLeaseFilePath()));
+        lease_file_->open();
+    }
+
+    /// @brief Closes and removes the lease file.
+    void tearDownLeaseFile() {
+        lease_file_.reset();
+        std::remove(getLeaseFilePath().c_str());
+    }
+
+    /// @brief Appends the leases until the benchmark ends.
+    ///
+    /// The number of leases appended before the file is flushed is the
+    /// benchmark parameter, 0 to flush only when the file buffer is full.
+    ///
+    /// @param state Benchmark state.
+    void benchAppend(::benchmark::State& state) {
+        setUpLeaseFile();
+        lease_file_->setFlushRows(state.range(0));
+
+        while (state.KeepRunning()) {
+            for (auto const& lease : leases_) {
+                lease_file_->append(*lease);
+            }
+        }
+
+        lease_file_->flush();
+        state.SetItemsProcessed(state.iterations() * LEASE_COUNT);
+        tearDownLeaseFile();
+    }
+
+    /// @brief Returns the path to the lease file.
+    static std::string getLeaseFilePath() {
+        std::ostringstream s;
+        s << TEST_DATA_BUILDDIR << "/leasefile4_bench.csv";
+        return (s.str());
+    }
+
+    /// @brief The lease file.
+    boost::scoped_ptr<CSVLeaseFile4> lease_file_;
+
+    /// @brief The appended leases.
+    std::vector<Lease4Ptr> leases_;
+};
+
+// Defines a benchmark that measures the appends of the leases to the
+// lease file.
+BENCHMARK_DEFINE_F(LeaseFileBenchmark, append4)(benchmark::State& state) {
+    benchAppend(state);
+}
+
+/// A benchmark that measures the appends of the leases to the lease file
+/// flushed after each lease (the default), after 16 and 256 leases, and
+/// only when its buffer is full.
+BENCHMARK_REGISTER_F(LeaseFileBenchmark, append4)
+    ->Arg(1)->Arg(16)->Arg(256)->Arg(0)->Unit(UNIT);
+
+}  // namespace
@@ -0,0 +1,190 @@
+// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <asiolink/io_address.h>
+#include <dhcpsrv/benchmarks/parameters.h>
+#include <dhcpsrv/memfile_lease_mgr.h>
+#include <util/multi_threading_mgr.h>
+
+#include <benchmark/benchmark.h>
+#include <boost/scoped_ptr.hpp>
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace isc::asiolink;
+using namespace isc::db;
+using namespace isc::dhcp;
+using namespace isc::dhcp::bench;
+using namespace isc::util;
+
+namespace {
+
+/// @brief Number of leases in the lease storage.
+constexpr size_t LEASE_COUNT = 4096;
+
+/// @brief Number of queries processed by iteration.
+constexpr size_t QUERY_COUNT = 16384;
+
+/// @brief This is a fixture class used for benchmarking the memfile lease
+/// manager used by concurrent packet processing threads.
+///
+/// For each query a thread looks up the lease of the client by HW address,
+/// by client identifier and by address, as the allocation engine does. A
+/// thread processes the queries of its own clients so the updates of a
+/// lease are never concurrent. The lease changes are appended to the lease
+/// file by the thread processing the query, or by the lease file writer
+/// thread.
+class MemfileLeaseMgrMtBenchmark : public ::benchmark::Fixture {
+public:
+
+    /// @brief Creates the lease manager in multi-threading mode and adds
+    /// the leases.
+    ///
+    /// @param write_queue_size The size of the lease file write queue, 0
+    /// to append the lease changes without the writer thread.
+    void setUpLeases(size_t write_queue_size) {
+        std::remove(getLeaseFilePath().c_str());
+        MultiThreadingMgr::instance().setMode(true);
+
+        DatabaseConnection::ParameterMap pmap;
+        pmap["universe"] = "4";
+        pmap["name"] = getLeaseFilePath();
+        pmap["lfc-interval"] = "0";
+        pmap["write-queue-size"] = std::to_string(write_queue_size);
+        lease_mgr_.reset(new Memfile_LeaseMgr(pmap));
+
+        leases_.clear();
+        for (size_t i = 0; i < LEASE_COUNT; ++i) {
+            Lease4Ptr lease(new Lease4());
+            lease->addr_ = IOAddress(static_cast<uint32_t>(0x0a000001 + i));
+            std::vector<uint8_t> hwaddr(6, 0);
+            hwaddr[4] = static_cast<uint8_t>(i >> 8);
+            hwaddr[5] = static_cast<uint8_t>(i);
+            lease->hwaddr_.reset(new HWAddr(hwaddr, HTYPE_ETHER));
+            std::vector<uint8_t> client_id(8, 1);
+            client_id[6] = static_cast<uint8_t>(i >> 8);
+            client_id[7] = static_cast<uint8_t>(i);
+            lease->client_id_.reset(new ClientId(client_id));
+            lease->valid_lft_ = 3600;
+            lease->cltt_ = time(0);
+            lease->subnet_id_ = 1;
+            lease_mgr_->addLease(lease);
+            leases_.push_back(lease);
+        }
+    }
+
+    /// @brief Destroys the lease manager and removes the lease file.
+    void tearDownLeases() {
+        lease_mgr_.reset();
+        MultiThreadingMgr::instance().setMode(false);
+        std::remove(getLeaseFilePath().c_str());
+    }
+
+    /// @brief Processes the queries until the benchmark ends.
+    ///
+    /// The number of threads is the benchmark parameter.
+    ///
+    /// @param state Benchmark state.
+    /// @param update_interval A lease is updated every update_interval
+    /// queries, 0 for lookups only.
+    /// @param write_queue_size The size of the lease file write queue, 0
+    /// to append the lease changes without the writer thread.
+    void benchQueries(::benchmark::State& state, size_t update_interval,
+                      size_t write_queue_size = 0) {
+        setUpLeases(write_queue_size);
+        const size_t thread_count = state.range(0);
+
+        while (state.KeepRunning()) {
+            std::vector<std::thread> threads;
+            for (size_t t = 0; t < thread_count; ++t) {
+                threads.emplace_back(
+                    &MemfileLeaseMgrMtBenchmark::processQueries,
+                    this, t, thread_count, update_interval);
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        }
+
+        state.SetItemsProcessed(state.iterations() * QUERY_COUNT);
+        tearDownLeases();
+    }
+
+    /// @brief Processes the queries of the clients of a thread.
+    ///
+    /// @param index Index of the thread.
+    /// @param thread_count Number of threads.
+    /// @param update_interval A lease is updated every update_interval
+    /// queries, 0 for lookups only.
+    void processQueries(size_t index, size_t thread_count,
+                        size_t update_interval) {
+        for (size_t i = index; i < QUERY_COUNT; i += thread_count) {
+            const Lease4Ptr& lease = leases_[i % LEASE_COUNT];
+            ::benchmark::DoNotOptimize(lease_mgr_->getLease4(*lease->hwaddr_));
+            ::benchmark::DoNotOptimize(
+                lease_mgr_->getLease4(*lease->client_id_));
+            Lease4Ptr current = lease_mgr_->getLease4(lease->addr_);
+            if (update_interval && current && (i % update_interval == 0)) {
+                lease_mgr_->updateLease4(current);
+            }
+        }
+    }
+
+    /// @brief Returns the path to the lease file.
+    static std::string getLeaseFilePath() {
+        std::ostringstream s;
+        s << TEST_DATA_BUILDDIR << "/leasefile4_mt.csv";
+        return (s.str());
+    }
+
+    /// @brief The lease manager.
+    boost::scoped_ptr<Memfile_LeaseMgr> lease_mgr_;
+
+    /// @brief The leases of the clients.
+    std::vector<Lease4Ptr> leases_;
+};
+
+// Defines a benchmark that measures the lease lookups of concurrent
+// threads.
+BENCHMARK_DEFINE_F(MemfileLeaseMgrMtBenchmark, lookups4)(benchmark::State& state) {
+    benchQueries(state, 0);
+}
+
+// Defines a benchmark that measures the lease lookups of concurrent
+// threads with a lease update every four queries.
+BENCHMARK_DEFINE_F(MemfileLeaseMgrMtBenchmark, lookupsUpdates4)(benchmark::State& state) {
+    benchQueries(state, 4);
+}
+
+// Defines a benchmark that measures the lease lookups of concurrent
+// threads with a lease update every four queries appended to the lease
+// file by the writer thread.
+BENCHMARK_DEFINE_F(MemfileLeaseMgrMtBenchmark, lookupsUpdatesWriter4)(benchmark::State& state) {
+    benchQueries(state, 4, 1024);
+}
+
+/// A benchmark that measures the lease lookups of 1, 2, 4, 8 and 16
+/// threads.
+BENCHMARK_REGISTER_F(MemfileLeaseMgrMtBenchmark, lookups4)
+    ->RangeMultiplier(2)->Range(1, 16)->UseRealTime()->Unit(UNIT);
+
+/// A benchmark that measures the lease lookups and updates of 1, 2, 4, 8
+/// and 16 threads.
+BENCHMARK_REGISTER_F(MemfileLeaseMgrMtBenchmark, lookupsUpdates4)
+    ->RangeMultiplier(2)->Range(1, 16)->UseRealTime()->Unit(UNIT);
+
+/// A benchmark that measures the lease lookups and updates of 1, 2, 4, 8
+/// and 16 threads with the lease file writer thread.
+BENCHMARK_REGISTER_F(MemfileLeaseMgrMtBenchmark, lookupsUpdatesWriter4)
+    ->RangeMultiplier(2)->Range(1, 16)->UseRealTime()->Unit(UNIT);
+
+}  // namespace
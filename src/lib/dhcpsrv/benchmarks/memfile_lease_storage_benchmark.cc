@@ -0,0 +1,621 @@
+// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <asiolink/io_address.h>
+#include <dhcpsrv/memfile_lease_storage.h>
+
+#include <benchmark/benchmark.h>
+#include <boost/multi_index/composite_key.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/mem_fun.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index_container.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+using namespace isc::asiolink;
+using namespace isc::dhcp;
+
+namespace {
+
+/// @brief Number of lookups by iteration.
+constexpr size_t LOOKUP_COUNT = 1024;
+
+/// @brief One lease out of this number is declined, one lookup out of
+/// this number is done with an empty HW address or client id.
+constexpr size_t DECLINED_RATIO = 16;
+
+/// @brief A time unit used - an iteration takes a few milliseconds.
+constexpr benchmark::TimeUnit STORAGE_UNIT = benchmark::kMicrosecond;
+
+/// @brief Number of bytes currently allocated by the lease storages.
+size_t allocated_bytes = 0;
+
+/// @brief Allocator counting the bytes allocated by a lease storage.
+///
+/// @tparam T Type of the allocated objects.
+template<typename T>
+class CountingAllocator : public std::allocator<T> {
+public:
+    /// @brief Type of the allocated objects.
+    typedef T value_type;
+
+    /// @brief Rebinds the allocator to another type.
+    template<typename U>
+    struct rebind {
+        typedef CountingAllocator<U> other;
+    };
+
+    /// @brief Constructor.
+    CountingAllocator() = default;
+
+    /// @brief Copy constructor from an allocator of another type.
+    template<typename U>
+    CountingAllocator(const CountingAllocator<U>&) {
+    }
+
+    /// @brief Allocates objects.
+    ///
+    /// @param count Number of objects.
+    T* allocate(size_t count) {
+        allocated_bytes += count * sizeof(T);
+        return (std::allocator<T>::allocate(count));
+    }
+
+    /// @brief Deallocates objects.
+    ///
+    /// @param ptr Pointer to the objects.
+    /// @param count Number of objects.
+    void deallocate(T* ptr, size_t count) {
+        allocated_bytes -= count * sizeof(T);
+        std::allocator<T>::deallocate(ptr, count);
+    }
+};
+
+/// @brief Tag for the ordered index by HW address and subnet id.
+struct OrderedHWAddressSubnetIdTag { };
+
+/// @brief Tag for the ordered index by client id and subnet id.
+struct OrderedClientIdSubnetIdTag { };
+
+/// @brief Tag for the ordered index by client id, HW address and subnet id.
+struct OrderedClientIdHWAddressSubnetIdTag { };
+
+/// @brief DHCPv4 lease storage with ordered indexes only, as it was
+/// before the point lookup indexes were hashed.
+typedef boost::multi_index_container<
+    Lease4Ptr,
+    boost::multi_index::indexed_by<
+        boost::multi_index::ordered_unique<
+            boost::multi_index::tag<AddressIndexTag>,
+            boost::multi_index::member<Lease, IOAddress, &Lease::addr_>
+        >,
+        boost::multi_index::ordered_non_unique<
+            boost::multi_index::tag<OrderedHWAddressSubnetIdTag>,
+            boost::multi_index::composite_key<
+                Lease4,
+                boost::multi_index::const_mem_fun<Lease, const std::vector<uint8_t>&,
+                                                  &Lease::getHWAddrVector>,
+                boost::multi_index::member<Lease, SubnetID, &Lease::subnet_id_>
+            >
+        >,
+        boost::multi_index::ordered_non_unique<
+            boost::multi_index::tag<OrderedClientIdSubnetIdTag>,
+            boost::multi_index::composite_key<
+                Lease4,
+                boost::multi_index::const_mem_fun<Lease4, const std::vector<uint8_t>&,
+                                                  &Lease4::getClientIdVector>,
+                boost::multi_index::member<Lease, SubnetID, &Lease::subnet_id_>
+            >
+        >,
+        boost::multi_index::ordered_non_unique<
+            boost::multi_index::tag<OrderedClientIdHWAddressSubnetIdTag>,
+            boost::multi_index::composite_key<
+                Lease4,
+                boost::multi_index::const_mem_fun<Lease4, const std::vector<uint8_t>&,
+                                                  &Lease4::getClientIdVector>,
+                boost::multi_index::const_mem_fun<Lease, const std::vector<uint8_t>&,
+                                                  &Lease::getHWAddrVector>,
+                boost::multi_index::member<Lease, SubnetID, &Lease::subnet_id_>
+            >
+        >,
+        boost::multi_index::ordered_non_unique<
+            boost::multi_index::tag<ExpirationIndexTag>,
+            boost::multi_index::composite_key<
+                Lease4,
+                boost::multi_index::const_mem_fun<Lease, bool,
+                                                  &Lease::stateExpiredReclaimed>,
+                boost::multi_index::const_mem_fun<Lease, int64_t,
+                                                  &Lease::getExpirationTime>
+            >
+        >,
+        boost::multi_index::ordered_non_unique<
+            boost::multi_index::tag<SubnetIdIndexTag>,
+            boost::multi_index::member<Lease, SubnetID, &Lease::subnet_id_>
+        >,
+        boost::multi_index::ordered_non_unique<
+            boost::multi_index::tag<HostnameIndexTag>,
+            boost::multi_index::member<Lease, std::string, &Lease::hostname_>
+        >
+    >,
+    CountingAllocator<Lease4Ptr>
+> OrderedLease4Storage;
+
+/// @brief DHCPv4 lease storage used by the memfile lease manager.
+typedef boost::multi_index_container<
+    Lease4Ptr,
+    Lease4Storage::index_specifier_type_list,
+    CountingAllocator<Lease4Ptr>
+> HashedLease4Storage;
+
+/// @brief DHCPv4 lease storage by HW address used by the memfile lease
+/// manager.
+typedef boost::multi_index_container<
+    Lease4Ptr,
+    Lease4HWAddressStorage::index_specifier_type_list,
+    CountingAllocator<Lease4Ptr>
+> HashedLease4HWAddressStorage;
+
+/// @brief DHCPv4 lease storage by client id used by the memfile lease
+/// manager.
+typedef boost::multi_index_container<
+    Lease4Ptr,
+    Lease4ClientIdStorage::index_specifier_type_list,
+    CountingAllocator<Lease4Ptr>
+> HashedLease4ClientIdStorage;
+
+/// @brief DHCPv4 lease storage by HW address hashed by HW address only,
+/// as it was before the composite index by HW address and subnet id.
+typedef boost::multi_index_container<
+    Lease4Ptr,
+    boost::multi_index::indexed_by<
+        boost::multi_index::hashed_non_unique<
+            boost::multi_index::tag<HWAddressIndexTag>,
+            boost::multi_index::const_mem_fun<Lease, const std::vector<uint8_t>&,
+                                              &Lease::getHWAddrVector>
+        >
+    >,
+    CountingAllocator<Lease4Ptr>
+> KeyHashedLease4HWAddressStorage;
+
+/// @brief DHCPv4 lease storage by client id hashed by client id only,
+/// as it was before the composite index by client id and subnet id.
+typedef boost::multi_index_container<
+    Lease4Ptr,
+    boost::multi_index::indexed_by<
+        boost::multi_index::hashed_non_unique<
+            boost::multi_index::tag<ClientIdIndexTag>,
+            boost::multi_index::const_mem_fun<Lease4, const std::vector<uint8_t>&,
+                                              &Lease4::getClientIdVector>
+        >
+    >,
+    CountingAllocator<Lease4Ptr>
+> KeyHashedLease4ClientIdStorage;
+
+/// @brief Finds the lease of a client in a subnet using a composite
+/// index, as the memfile lease manager does.
+struct FindComposite {
+    /// @brief Finds the lease.
+    ///
+    /// @param idx The index by HW address or client id and subnet id.
+    /// @param key The HW address or client id.
+    /// @param subnet_id The subnet identifier.
+    template<typename IndexType>
+    Lease4Ptr operator()(const IndexType& idx,
+                         const std::vector<uint8_t>& key,
+                         SubnetID subnet_id) const {
+        auto lease = idx.find(boost::make_tuple(key, subnet_id));
+        if (lease == idx.end()) {
+            return (Lease4Ptr());
+        }
+        return (*lease);
+    }
+};
+
+/// @brief Finds the lease in a subnet among the leases of a client, as
+/// the memfile lease manager did before the composite indexes.
+struct FindInSubnet {
+    /// @brief Finds the lease.
+    ///
+    /// @param idx The index by HW address or client id.
+    /// @param key The HW address or client id.
+    /// @param subnet_id The subnet identifier.
+    template<typename IndexType>
+    Lease4Ptr operator()(const IndexType& idx,
+                         const std::vector<uint8_t>& key,
+                         SubnetID subnet_id) const {
+        auto range = idx.equal_range(key);
+        for (auto lease = range.first; lease != range.second; ++lease) {
+            if ((*lease)->subnet_id_ == subnet_id) {
+                return (*lease);
+            }
+        }
+        return (Lease4Ptr());
+    }
+};
+
+/// @brief DHCPv6 lease storage with ordered indexes only, as it was
+/// before the point lookup indexes were hashed.
+typedef boost::multi_index_container<
+    Lease6Ptr,
+    boost::multi_index::indexed_by<
+        boost::multi_index::ordered_unique<
+            boost::multi_index::tag<AddressIndexTag>,
+            boost::multi_index::member<Lease, IOAddress, &Lease::addr_>
+        >,
+        boost::multi_index::ordered_non_unique<
+            boost::multi_index::tag<DuidIaidTypeIndexTag>,
+            boost::multi_index::composite_key<
+                Lease6,
+                boost::multi_index::const_mem_fun<Lease6, const std::vector<uint8_t>&,
+                                                  &Lease6::getDuidVector>,
+                boost::multi_index::member<Lease6, uint32_t, &Lease6::iaid_>,
+                boost::multi_index::member<Lease6, Lease::Type, &Lease6::type_>
+            >
+        >,
+        boost::multi_index::ordered_non_unique<
+            boost::multi_index::tag<ExpirationIndexTag>,
+            boost::multi_index::composite_key<
+                Lease6,
+                boost::multi_index::const_mem_fun<Lease, bool,
+                                                  &Lease::stateExpiredReclaimed>,
+                boost::multi_index::const_mem_fun<Lease, int64_t,
+                                                  &Lease::getExpirationTime>
+            >
+        >,
+        boost::multi_index::ordered_non_unique<
+            boost::multi_index::tag<SubnetIdIndexTag>,
+            boost::multi_index::member<Lease, SubnetID, &Lease::subnet_id_>
+        >,
+        boost::multi_index::ordered_non_unique<
+            boost::multi_index::tag<DuidIndexTag>,
+            boost::multi_index::const_mem_fun<Lease6, const std::vector<uint8_t>&,
+                                              &Lease6::getDuidVector>
+        >,
+        boost::multi_index::ordered_non_unique<
+            boost::multi_index::tag<HostnameIndexTag>,
+            boost::multi_index::member<Lease, std::string, &Lease::hostname_>
+        >
+    >,
+    CountingAllocator<Lease6Ptr>
+> OrderedLease6Storage;
+
+/// @brief DHCPv6 lease storage used by the memfile lease manager.
+typedef boost::multi_index_container<
+    Lease6Ptr,
+    Lease6Storage::index_specifier_type_list,
+    CountingAllocator<Lease6Ptr>
+> HashedLease6Storage;
+
+/// @brief DHCPv6 lease storage by DUID used by the memfile lease manager.
+typedef boost::multi_index_container<
+    Lease6Ptr,
+    Lease6DuidStorage::index_specifier_type_list,
+    CountingAllocator<Lease6Ptr>
+> HashedLease6DuidStorage;
+
+/// @brief This is a fixture class used for benchmarking the memfile lease
+/// storage indexes.
+///
+/// The storage holds as many leases as the benchmark parameter. Each
+/// iteration looks up leases spread over the storage the way the lease
+/// manager does when processing packets. One DHCPv4 lease out of
+/// @c DECLINED_RATIO is declined, so it has an empty HW address and no
+/// client id, and one DHCPv4 lookup out of @c DECLINED_RATIO is done for
+/// a client without HW address or client id in a subnet, e.g. an
+/// InfiniBand client. The "bytes_per_lease" counter is
+/// the memory used by the storage indexes for a lease, not counting the
+/// lease itself. The hashed storages include the storages by HW address,
+/// client id and DUID the memfile lease manager keeps next to the storage
+/// by address, unsharded.
+class MemfileLeaseStorageBenchmark : public ::benchmark::Fixture {
+public:
+
+    /// @brief Creates the DHCPv4 leases.
+    ///
+    /// @param lease_count Number of leases.
+    void createLeases4(size_t lease_count) {
+        leases4_.clear();
+        leases4_.reserve(lease_count);
+        for (size_t i = 0; i < lease_count; ++i) {
+            Lease4Ptr lease(new Lease4());
+            lease->addr_ = IOAddress(static_cast<uint32_t>(0x0a000000 + i));
+            std::vector<uint8_t> hwaddr(6, 0);
+            hwaddr[3] = static_cast<uint8_t>(i >> 16);
+            hwaddr[4] = static_cast<uint8_t>(i >> 8);
+            hwaddr[5] = static_cast<uint8_t>(i);
+            lease->hwaddr_.reset(new HWAddr(hwaddr, HTYPE_ETHER));
+            std::vector<uint8_t> client_id(hwaddr);
+            client_id.insert(client_id.begin(), 1);
+            lease->client_id_.reset(new ClientId(client_id));
+            lease->valid_lft_ = 3600;
+            lease->cltt_ = 1000000 + i % 3600;
+            lease->subnet_id_ = static_cast<SubnetID>(1 + (i >> 16));
+            if (i % DECLINED_RATIO == 0) {
+                lease->decline(3600);
+                lease->cltt_ = 1000000 + i % 3600;
+            }
+            leases4_.push_back(lease);
+        }
+    }
+
+    /// @brief Creates the DHCPv6 leases.
+    ///
+    /// @param lease_count Number of leases.
+    void createLeases6(size_t lease_count) {
+        leases6_.clear();
+        leases6_.reserve(lease_count);
+        for (size_t i = 0; i < lease_count; ++i) {
+            std::vector<uint8_t> addr(16, 0);
+            addr[0] = 0x20;
+            addr[1] = 0x01;
+            addr[2] = 0x0d;
+            addr[3] = 0xb8;
+            addr[13] = static_cast<uint8_t>(i >> 16);
+            addr[14] = static_cast<uint8_t>(i >> 8);
+            addr[15] = static_cast<uint8_t>(i);
+            std::vector<uint8_t> duid(10, 0);
+            duid[1] = 3;
+            duid[7] = addr[13];
+            duid[8] = addr[14];
+            duid[9] = addr[15];
+            Lease6Ptr lease(new Lease6(Lease::TYPE_NA,
+                                       IOAddress::fromBytes(AF_INET6, &addr[0]),
+                                       DuidPtr(new DUID(duid)), 1, 1800, 3600,
+                                       static_cast<SubnetID>(1 + (i >> 16))));
+            lease->cltt_ = 1000000 + i % 3600;
+            leases6_.push_back(lease);
+        }
+    }
+
+    /// @brief Returns the index of a looked up lease.
+    ///
+    /// @param lookup Index of the lookup.
+    /// @param lease_count Number of leases.
+    static size_t pick(size_t lookup, size_t lease_count) {
+        return ((lookup * 7919 * 131) % lease_count);
+    }
+
+    /// @brief Fills a lease storage.
+    ///
+    /// @param storage The lease storage.
+    /// @param leases The leases.
+    template<typename StorageType, typename LeaseCollection>
+    static void fillStorage(StorageType& storage, const LeaseCollection& leases) {
+        for (auto const& lease : leases) {
+            storage.insert(lease);
+        }
+    }
+
+    /// @brief Sets the memory used by the storages for a lease.
+    ///
+    /// @param state Benchmark state.
+    /// @param before Number of bytes allocated before the storages were
+    /// filled.
+    /// @param lease_count Number of leases.
+    static void setBytesPerLease(::benchmark::State& state, size_t before,
+                                 size_t lease_count) {
+        state.counters["bytes_per_lease"] =
+            static_cast<double>(allocated_bytes - before) / lease_count;
+    }
+
+    /// @brief Looks up DHCPv4 leases in the ordered storage until the
+    /// benchmark ends.
+    ///
+    /// @param state Benchmark state.
+    void benchOrdered4(::benchmark::State& state) {
+        createLeases4(state.range(0));
+        size_t before = allocated_bytes;
+        OrderedLease4Storage storage;
+        fillStorage(storage, leases4_);
+        setBytesPerLease(state, before, leases4_.size());
+        auto const& address_idx = storage.get<AddressIndexTag>();
+        auto const& hwaddr_idx = storage.get<OrderedHWAddressSubnetIdTag>();
+        auto const& client_id_idx = storage.get<OrderedClientIdSubnetIdTag>();
+        benchLookups4(state, address_idx, hwaddr_idx, client_id_idx,
+                      FindComposite());
+    }
+
+    /// @brief Looks up DHCPv4 leases in the hashed storage until the
+    /// benchmark ends.
+    ///
+    /// @param state Benchmark state.
+    void benchHashed4(::benchmark::State& state) {
+        createLeases4(state.range(0));
+        size_t before = allocated_bytes;
+        HashedLease4Storage storage;
+        fillStorage(storage, leases4_);
+        HashedLease4HWAddressStorage hwaddr_storage;
+        fillStorage(hwaddr_storage, leases4_);
+        HashedLease4ClientIdStorage client_id_storage;
+        fillStorage(client_id_storage, leases4_);
+        setBytesPerLease(state, before, leases4_.size());
+        auto const& address_idx = storage.get<AddressHashIndexTag>();
+        auto const& hwaddr_idx = hwaddr_storage.get<HWAddressSubnetIdIndexTag>();
+        auto const& client_id_idx = client_id_storage.get<ClientIdSubnetIdIndexTag>();
+        benchLookups4(state, address_idx, hwaddr_idx, client_id_idx,
+                      FindComposite());
+    }
+
+    /// @brief Looks up DHCPv4 leases in the hashed storage with the
+    /// storages by HW address and client id hashed by key only until the
+    /// benchmark ends.
+    ///
+    /// @param state Benchmark state.
+    void benchKeyHashed4(::benchmark::State& state) {
+        createLeases4(state.range(0));
+        size_t before = allocated_bytes;
+        HashedLease4Storage storage;
+        fillStorage(storage, leases4_);
+        KeyHashedLease4HWAddressStorage hwaddr_storage;
+        fillStorage(hwaddr_storage, leases4_);
+        KeyHashedLease4ClientIdStorage client_id_storage;
+        fillStorage(client_id_storage, leases4_);
+        setBytesPerLease(state, before, leases4_.size());
+        auto const& address_idx = storage.get<AddressHashIndexTag>();
+        auto const& hwaddr_idx = hwaddr_storage.get<HWAddressIndexTag>();
+        auto const& client_id_idx = client_id_storage.get<ClientIdIndexTag>();
+        benchLookups4(state, address_idx, hwaddr_idx, client_id_idx,
+                      FindInSubnet());
+    }
+
+    /// @brief Looks up DHCPv4 leases by address, by HW address in a subnet
+    /// and by client id in a subnet until the benchmark ends.
+    ///
+    /// @param state Benchmark state.
+    /// @param address_idx The index by address.
+    /// @param hwaddr_idx The index by HW address.
+    /// @param client_id_idx The index by client id.
+    /// @param find The function object finding a lease by HW address or
+    /// client id in a subnet.
+    template<typename AddressIndex, typename HWAddressIndex,
+             typename ClientIdIndex, typename Find>
+    void benchLookups4(::benchmark::State& state,
+                       const AddressIndex& address_idx,
+                       const HWAddressIndex& hwaddr_idx,
+                       const ClientIdIndex& client_id_idx,
+                       Find find) {
+        const std::vector<uint8_t> empty;
+        size_t next = 0;
+        while (state.KeepRunning()) {
+            for (size_t i = 0; i < LOOKUP_COUNT; ++i) {
+                const Lease4Ptr& lease = leases4_[pick(next++, leases4_.size())];
+                ::benchmark::DoNotOptimize(address_idx.find(lease->addr_));
+                if (i % DECLINED_RATIO == 0) {
+                    ::benchmark::DoNotOptimize(find(hwaddr_idx, empty,
+                                                    lease->subnet_id_));
+                    ::benchmark::DoNotOptimize(find(client_id_idx, empty,
+                                                    lease->subnet_id_));
+                } else {
+                    ::benchmark::DoNotOptimize(find(hwaddr_idx,
+                        lease->getHWAddrVector(), lease->subnet_id_));
+                    ::benchmark::DoNotOptimize(find(client_id_idx,
+                        lease->getClientIdVector(), lease->subnet_id_));
+                }
+            }
+        }
+    }
+
+    /// @brief Looks up DHCPv6 leases in the ordered storage until the
+    /// benchmark ends.
+    ///
+    /// @param state Benchmark state.
+    void benchOrdered6(::benchmark::State& state) {
+        createLeases6(state.range(0));
+        size_t before = allocated_bytes;
+        OrderedLease6Storage storage;
+        fillStorage(storage, leases6_);
+        setBytesPerLease(state, before, leases6_.size());
+        benchLookups6(state, storage.get<AddressIndexTag>(),
+                      storage.get<DuidIaidTypeIndexTag>());
+    }
+
+    /// @brief Looks up DHCPv6 leases in the hashed storage until the
+    /// benchmark ends.
+    ///
+    /// @param state Benchmark state.
+    void benchHashed6(::benchmark::State& state) {
+        createLeases6(state.range(0));
+        size_t before = allocated_bytes;
+        HashedLease6Storage storage;
+        fillStorage(storage, leases6_);
+        HashedLease6DuidStorage duid_storage;
+        fillStorage(duid_storage, leases6_);
+        setBytesPerLease(state, before, leases6_.size());
+        benchLookups6(state, storage.get<AddressHashIndexTag>(),
+                      duid_storage.get<DuidIaidTypeIndexTag>());
+    }
+
+    /// @brief Looks up DHCPv6 leases by address and by DUID, IAID and
+    /// lease type until the benchmark ends.
+    ///
+    /// @param state Benchmark state.
+    /// @param address_idx The index by address.
+    /// @param duid_idx The index by DUID, IAID and lease type.
+    template<typename AddressIndex, typename DuidIndex>
+    void benchLookups6(::benchmark::State& state,
+                       const AddressIndex& address_idx,
+                       const DuidIndex& duid_idx) {
+        size_t next = 0;
+        while (state.KeepRunning()) {
+            for (size_t i = 0; i < LOOKUP_COUNT; ++i) {
+                const Lease6Ptr& lease = leases6_[pick(next++, leases6_.size())];
+                ::benchmark::DoNotOptimize(address_idx.find(lease->addr_));
+                ::benchmark::DoNotOptimize(duid_idx.equal_range(
+                    boost::make_tuple(lease->getDuidVector(), lease->iaid_,
+                                      lease->type_)));
+            }
+        }
+    }
+
+    /// @brief The DHCPv4 leases.
+    std::vector<Lease4Ptr> leases4_;
+
+    /// @brief The DHCPv6 leases.
+    std::vector<Lease6Ptr> leases6_;
+};
+
+// Defines a benchmark that measures the DHCPv4 lease lookups with the
+// ordered indexes.
+BENCHMARK_DEFINE_F(MemfileLeaseStorageBenchmark, ordered4)(benchmark::State& state) {
+    benchOrdered4(state);
+}
+
+// Defines a benchmark that measures the DHCPv4 lease lookups with the
+// hashed indexes.
+BENCHMARK_DEFINE_F(MemfileLeaseStorageBenchmark, hashed4)(benchmark::State& state) {
+    benchHashed4(state);
+}
+
+// Defines a benchmark that measures the DHCPv4 lease lookups with the
+// hashed indexes by HW address and client id only.
+BENCHMARK_DEFINE_F(MemfileLeaseStorageBenchmark, keyHashed4)(benchmark::State& state) {
+    benchKeyHashed4(state);
+}
+
+// Defines a benchmark that measures the DHCPv6 lease lookups with the
+// ordered indexes.
+BENCHMARK_DEFINE_F(MemfileLeaseStorageBenchmark, ordered6)(benchmark::State& state) {
+    benchOrdered6(state);
+}
+
+// Defines a benchmark that measures the DHCPv6 lease lookups with the
+// hashed indexes.
+BENCHMARK_DEFINE_F(MemfileLeaseStorageBenchmark, hashed6)(benchmark::State& state) {
+    benchHashed6(state);
+}
+
+/// A benchmark that measures the DHCPv4 lease lookups with the ordered
+/// indexes with 1M and 10M leases.
+BENCHMARK_REGISTER_F(MemfileLeaseStorageBenchmark, ordered4)
+    ->Arg(1000000)->Arg(10000000)->Unit(STORAGE_UNIT);
+
+/// A benchmark that measures the DHCPv4 lease lookups with the hashed
+/// indexes with 1M and 10M leases.
+BENCHMARK_REGISTER_F(MemfileLeaseStorageBenchmark, hashed4)
+    ->Arg(1000000)->Arg(10000000)->Unit(STORAGE_UNIT);
+
+/// A benchmark that measures the DHCPv4 lease lookups with the hashed
+/// indexes by HW address and client id only with 1M and 10M leases.
+BENCHMARK_REGISTER_F(MemfileLeaseStorageBenchmark, keyHashed4)
+    ->Arg(1000000)->Arg(10000000)->Unit(STORAGE_UNIT);
+
+/// A benchmark that measures the DHCPv6 lease lookups with the ordered
+/// indexes with 1M and 10M leases.
+BENCHMARK_REGISTER_F(MemfileLeaseStorageBenchmark, ordered6)
+    ->Arg(1000000)->Arg(10000000)->Unit(STORAGE_UNIT);
+
+/// A benchmark that measures the DHCPv6 lease lookups with the hashed
+/// indexes with 1M and 10M leases.
+BENCHMARK_REGISTER_F(MemfileLeaseStorageBenchmark, hashed6)
+    ->Arg(1000000)->Arg(10000000)->Unit(STORAGE_UNIT);
+
+}  // namespace
@@ -0,0 +1,282 @@
+// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <asiolink/io_address.h>
+#include <dhcpsrv/cfg_subnets4.h>
+#include <dhcpsrv/cfg_subnets6.h>
+#include <dhcpsrv/subnet.h>
+#include <dhcpsrv/subnet_selector.h>
+
+#include <benchmark/benchmark.h>
+#include <boost/scoped_ptr.hpp>
+
+#include <vector>
+
+using namespace isc::asiolink;
+using namespace isc::dhcp;
+
+namespace {
+
+/// @brief Number of distinct selectors used by the benchmarks.
+constexpr size_t SELECTOR_COUNT = 1024;
+
+/// @brief A time unit used - a subnet selection takes less than a
+/// microsecond with the index.
+constexpr benchmark::TimeUnit SELECTION_UNIT = benchmark::kNanosecond;
+
+/// @brief This is a fixture class used for benchmarking the subnet
+/// selection.
+///
+/// The configurations hold as many subnets as the benchmark parameter.
+/// Each IPv4 subnet is a /24 with its own relay address, each IPv6 subnet
+/// is a /64 with its own relay address. The selectors are spread over
+/// all subnets.
+class SubnetSelectionBenchmark : public ::benchmark::Fixture {
+public:
+
+    /// @brief Creates the subnets and the selectors.
+    ///
+    /// @param state Benchmark state.
+    /// @param indexed Whether the subnet selection index is built.
+    void setUpSubnets(::benchmark::State& state, bool indexed) {
+        state.PauseTiming();
+        const size_t subnet_count = state.range(0);
+        cfg4_.reset(new CfgSubnets4());
+        cfg6_.reset(new CfgSubnets6());
+        for (size_t i = 0; i < subnet_count; ++i) {
+            SubnetID id = static_cast<SubnetID>(i + 1);
+            Subnet4Ptr subnet4(new Subnet4(prefix4(i), 24, 1, 2, 3, id));
+            subnet4->addRelayAddress(relay4(i));
+            cfg4_->add(subnet4);
+            Subnet6Ptr subnet6(new Subnet6(prefix6(i), 64, 1, 2, 3, 4, id));
+            subnet6->addRelayAddress(relay6(i));
+            cfg6_->add(subnet6);
+        }
+        if (indexed) {
+            cfg4_->initSelectionIndex();
+            cfg6_->initSelectionIndex();
+        }
+
+        // Pick subnets spread over the configuration.
+        selectors4_.clear();
+        relayed4_.clear();
+        selectors6_.clear();
+        relayed6_.clear();
+        for (size_t i = 0; i < SELECTOR_COUNT; ++i) {
+            size_t index = (i * 7919) % subnet_count;
+            SubnetSelector selector;
+            selector.local_address_ = IOAddress("10.0.0.1");
+            selector.ciaddr_ = IOAddress(prefix4(index).toUint32() + 10);
+            selectors4_.push_back(selector);
+            selector.ciaddr_ = IOAddress::IPV4_ZERO_ADDRESS();
+            selector.giaddr_ = relay4(index);
+            relayed4_.push_back(selector);
+
+            selector = SubnetSelector();
+            selector.first_relay_linkaddr_ = IOAddress("::");
+            selector.remote_address_ = address6(index);
+            selectors6_.push_back(selector);
+            selector.first_relay_linkaddr_ = relay6(index);
+            relayed6_.push_back(selector);
+        }
+        state.ResumeTiming();
+    }
+
+    /// @brief Selects IPv4 subnets until the benchmark ends.
+    ///
+    /// @param state Benchmark state.
+    /// @param selectors The selectors to use in turn.
+    void benchSelectSubnet4(::benchmark::State& state,
+                            const std::vector<SubnetSelector>& selectors) {
+        size_t next = 0;
+        while (state.KeepRunning()) {
+            const SubnetSelector& selector = selectors[next++ % selectors.size()];
+            ::benchmark::DoNotOptimize(cfg4_->selectSubnet(selector));
+        }
+    }
+
+    /// @brief Selects IPv6 subnets until the benchmark ends.
+    ///
+    /// @param state Benchmark state.
+    /// @param selectors The selectors to use in turn.
+    void benchSelectSubnet6(::benchmark::State& state,
+                            const std::vector<SubnetSelector>& selectors) {
+        size_t next = 0;
+        while (state.KeepRunning()) {
+            const SubnetSelector& selector = selectors[next++ % selectors.size()];
+            ::benchmark::DoNotOptimize(cfg6_->selectSubnet(selector));
+        }
+    }
+
+    /// @brief Returns the prefix of an IPv4 subnet.
+    ///
+    /// @param index Index of the subnet.
+    static IOAddress prefix4(size_t index) {
+        return (IOAddress(static_cast<uint32_t>(0x0a000000 + (index << 8))));
+    }
+
+    /// @brief Returns the relay address of an IPv4 subnet.
+    ///
+    /// @param index Index of the subnet.
+    static IOAddress relay4(size_t index) {
+        return (IOAddress(static_cast<uint32_t>(0xac100000 + index)));
+    }
+
+    /// @brief Returns an IPv6 address with a subnet index in its /64 prefix.
+    ///
+    /// @param second Second byte of the address.
+    /// @param index Index of the subnet.
+    /// @param last Last byte of the address.
+    static IOAddress makeAddress6(uint8_t second, size_t index, uint8_t last) {
+        std::vector<uint8_t> bytes(16, 0);
+        bytes[0] = 0x20;
+        bytes[1] = second;
+        bytes[5] = static_cast<uint8_t>(index >> 16);
+        bytes[6] = static_cast<uint8_t>(index >> 8);
+        bytes[7] = static_cast<uint8_t>(index);
+        bytes[15] = last;
+        return (IOAddress::fromBytes(AF_INET6, &bytes[0]));
+    }
+
+    /// @brief Returns the prefix of an IPv6 subnet.
+    ///
+    /// @param index Index of the subnet.
+    static IOAddress prefix6(size_t index) {
+        return (makeAddress6(0x01, index, 0));
+    }
+
+    /// @brief Returns an address in an IPv6 subnet.
+    ///
+    /// @param index Index of the subnet.
+    static IOAddress address6(size_t index) {
+        return (makeAddress6(0x01, index, 10));
+    }
+
+    /// @brief Returns the relay address of an IPv6 subnet.
+    ///
+    /// @param index Index of the subnet.
+    static IOAddress relay6(size_t index) {
+        return (makeAddress6(0x02, index, 1));
+    }
+
+    /// @brief The IPv4 subnets.
+    boost::scoped_ptr<CfgSubnets4> cfg4_;
+
+    /// @brief The IPv6 subnets.
+    boost::scoped_ptr<CfgSubnets6> cfg6_;
+
+    /// @brief The IPv4 selectors of renewing clients.
+    std::vector<SubnetSelector> selectors4_;
+
+    /// @brief The IPv4 selectors of relayed clients.
+    std::vector<SubnetSelector> relayed4_;
+
+    /// @brief The IPv6 selectors of directly connected clients.
+    std::vector<SubnetSelector> selectors6_;
+
+    /// @brief The IPv6 selectors of relayed clients.
+    std::vector<SubnetSelector> relayed6_;
+};
+
+// Defines a benchmark that measures the IPv4 subnet selection by address
+// scanning all subnets.
+BENCHMARK_DEFINE_F(SubnetSelectionBenchmark, scanSelectSubnet4)(benchmark::State& state) {
+    setUpSubnets(state, false);
+    benchSelectSubnet4(state, selectors4_);
+}
+
+// Defines a benchmark that measures the IPv4 subnet selection by address
+// using the index.
+BENCHMARK_DEFINE_F(SubnetSelectionBenchmark, indexSelectSubnet4)(benchmark::State& state) {
+    setUpSubnets(state, true);
+    benchSelectSubnet4(state, selectors4_);
+}
+
+// Defines a benchmark that measures the IPv4 subnet selection by relay
+// address scanning all subnets.
+BENCHMARK_DEFINE_F(SubnetSelectionBenchmark, scanSelectSubnet4Relay)(benchmark::State& state) {
+    setUpSubnets(state, false);
+    benchSelectSubnet4(state, relayed4_);
+}
+
+// Defines a benchmark that measures the IPv4 subnet selection by relay
+// address using the index.
+BENCHMARK_DEFINE_F(SubnetSelectionBenchmark, indexSelectSubnet4Relay)(benchmark::State& state) {
+    setUpSubnets(state, true);
+    benchSelectSubnet4(state, relayed4_);
+}
+
+// Defines a benchmark that measures the IPv6 subnet selection by address
+// scanning all subnets.
+BENCHMARK_DEFINE_F(SubnetSelectionBenchmark, scanSelectSubnet6)(benchmark::State& state) {
+    setUpSubnets(state, false);
+    benchSelectSubnet6(state, selectors6_);
+}
+
+// Defines a benchmark that measures the IPv6 subnet selection by address
+// using the index.
+BENCHMARK_DEFINE_F(SubnetSelectionBenchmark, indexSelectSubnet6)(benchmark::State& state) {
+    setUpSubnets(state, true);
+    benchSelectSubnet6(state, selectors6_);
+}
+
+// Defines a benchmark that measures the IPv6 subnet selection by relay
+// address scanning all subnets.
+BENCHMARK_DEFINE_F(SubnetSelectionBenchmark, scanSelectSubnet6Relay)(benchmark::State& state) {
+    setUpSubnets(state, false);
+    benchSelectSubnet6(state, relayed6_);
+}
+
+// Defines a benchmark that measures the IPv6 subnet selection by relay
+// address using the index.
+BENCHMARK_DEFINE_F(SubnetSelectionBenchmark, indexSelectSubnet6Relay)(benchmark::State& state) {
+    setUpSubnets(state, true);
+    benchSelectSubnet6(state, relayed6_);
+}
+
+/// A benchmark that measures the IPv4 subnet selection by address without
+/// the index with 1k, 10k and 100k subnets.
+BENCHMARK_REGISTER_F(SubnetSelectionBenchmark, scanSelectSubnet4)
+    ->Arg(1000)->Arg(10000)->Arg(100000)->Unit(SELECTION_UNIT);
+
+/// A benchmark that measures the IPv4 subnet selection by address with
+/// the index with 1k, 10k and 100k subnets.
+BENCHMARK_REGISTER_F(SubnetSelectionBenchmark, indexSelectSubnet4)
+    ->Arg(1000)->Arg(10000)->Arg(100000)->Unit(SELECTION_UNIT);
+
+/// A benchmark that measures the IPv4 subnet selection by relay address
+/// without the index with 1k, 10k and 100k subnets.
+BENCHMARK_REGISTER_F(SubnetSelectionBenchmark, scanSelectSubnet4Relay)
+    ->Arg(1000)->Arg(10000)->Arg(100000)->Unit(SELECTION_UNIT);
+
+/// A benchmark that measures the IPv4 subnet selection by relay address
+/// with the index with 1k, 10k and 100k subnets.
+BENCHMARK_REGISTER_F(SubnetSelectionBenchmark, indexSelectSubnet4Relay)
+    ->Arg(1000)->Arg(10000)->Arg(100000)->Unit(SELECTION_UNIT);
+
+/// A benchmark that measures the IPv6 subnet selection by address without
+/// the index with 1k, 10k and 100k subnets.
+BENCHMARK_REGISTER_F(SubnetSelectionBenchmark, scanSelectSubnet6)
+    ->Arg(1000)->Arg(10000)->Arg(100000)->Unit(SELECTION_UNIT);
+
+/// A benchmark that measures the IPv6 subnet selection by address with
+/// the index with 1k, 10k and 100k subnets.
+BENCHMARK_REGISTER_F(SubnetSelectionBenchmark, indexSelectSubnet6)
+    ->Arg(1000)->Arg(10000)->Arg(100000)->Unit(SELECTION_UNIT);
+
+/// A benchmark that measures the IPv6 subnet selection by relay address
+/// without the index with 1k, 10k and 100k subnets.
+BENCHMARK_REGISTER_F(SubnetSelectionBenchmark, scanSelectSubnet6Relay)
+    ->Arg(1000)->Arg(10000)->Arg(100000)->Unit(SELECTION_UNIT);
+
+/// A benchmark that measures the IPv6 subnet selection by relay address
+/// with the index with 1k, 10k and 100k subnets.
+BENCHMARK_REGISTER_F(SubnetSelectionBenchmark, indexSelectSubnet6Relay)
+    ->Arg(1000)->Arg(10000)->Arg(100000)->Unit(SELECTION_UNIT);
+
+}  // namespace
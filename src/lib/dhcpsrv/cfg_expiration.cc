@@ -22,6 +22,8 @@ const uint32_t CfgExpiration::DEFAULT_HOLD_RECLAIMED_TIME = 3600;
 const uint32_t CfgExpiration::DEFAULT_MAX_RECLAIM_LEASES = 100;
 const uint16_t CfgExpiration::DEFAULT_MAX_RECLAIM_TIME = 250;
 const uint16_t CfgExpiration::DEFAULT_UNWARNED_RECLAIM_CYCLES = 5;
+const uint16_t CfgExpiration::DEFAULT_RECLAIM_BATCH_SIZE = 1;
+const uint16_t CfgExpiration::DEFAULT_RECLAIM_THREADS = 0;
 
 // Maximum values.
 const uint16_t CfgExpiration::LIMIT_RECLAIM_TIMER_WAIT_TIME =
@@ -35,6 +37,8 @@ const uint32_t CfgExpiration::LIMIT_MAX_RECLAIM_LEASES =
 const uint16_t CfgExpiration::LIMIT_MAX_RECLAIM_TIME = 10000;
 const uint16_t CfgExpiration::LIMIT_UNWARNED_RECLAIM_CYCLES =
     std::numeric_limits<uint16_t>::max();
+const uint16_t CfgExpiration::LIMIT_RECLAIM_BATCH_SIZE = 10000;
+const uint16_t CfgExpiration::LIMIT_RECLAIM_THREADS = 256;
 
 // Timers' names
 const std::string CfgExpiration::RECLAIM_EXPIRED_TIMER_NAME =
@@ -50,6 +54,8 @@ CfgExpiration::CfgExpiration(const bool test_mode)
       max_reclaim_leases_(DEFAULT_MAX_RECLAIM_LEASES),
       max_reclaim_time_(DEFAULT_MAX_RECLAIM_TIME),
       unwarned_reclaim_cycles_(DEFAULT_UNWARNED_RECLAIM_CYCLES),
+      reclaim_batch_size_(DEFAULT_RECLAIM_BATCH_SIZE),
+      reclaim_threads_(DEFAULT_RECLAIM_THREADS),
       timer_mgr_(TimerMgr::instance()),
       test_mode_(test_mode) {
 }
@@ -93,6 +99,23 @@ CfgExpiration::setUnwarnedReclaimCycles(const int64_t unwarned_reclaim_cycles) {
     unwarned_reclaim_cycles_ = unwarned_reclaim_cycles;
 }
 
+void
+CfgExpiration::setReclaimBatchSize(const int64_t reclaim_batch_size) {
+    rangeCheck(reclaim_batch_size, LIMIT_RECLAIM_BATCH_SIZE,
+               "reclaim-batch-size");
+    if (reclaim_batch_size == 0) {
+        isc_throw(OutOfRange, "value for configuration parameter"
+                  " 'reclaim-batch-size' must not be 0");
+    }
+    reclaim_batch_size_ = reclaim_batch_size;
+}
+
+void
+CfgExpiration::setReclaimThreads(const int64_t reclaim_threads) {
+    rangeCheck(reclaim_threads, LIMIT_RECLAIM_THREADS, "reclaim-threads");
+    reclaim_threads_ = reclaim_threads;
+}
+
 void
 CfgExpiration::rangeCheck(const int64_t value, const uint64_t max_value,
                           const std::string& config_parameter_name) const {
@@ -134,6 +157,18 @@ CfgExpiration::toElement() const {
     result->set("unwarned-reclaim-cycles",
                 Element::create(static_cast<long long>
                                 (unwarned_reclaim_cycles_)));
+    // Set reclaim-batch-size
+    if (reclaim_batch_size_ != DEFAULT_RECLAIM_BATCH_SIZE) {
+        result->set("reclaim-batch-size",
+                    Element::create(static_cast<long long>
+                                    (reclaim_batch_size_)));
+    }
+    // Set reclaim-threads
+    if (reclaim_threads_ != DEFAULT_RECLAIM_THREADS) {
+        result->set("reclaim-threads",
+                    Element::create(static_cast<long long>
+                                    (reclaim_threads_)));
+    }
     return (result);
 }
 
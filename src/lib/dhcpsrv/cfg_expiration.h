@@ -55,6 +55,13 @@ namespace dhcp {
 ///   there are still expired leases in the database. If this value is 0,
 ///   the warning is never issued.
 ///
+/// - reclaim-batch-size - is the number of reclaimed leases written to the
+///   lease database at once by the reclamation routine.
+///
+/// - reclaim-threads - is the number of threads reclaiming the expired
+///   leases in parallel, by subnet, when multi-threading is enabled. If
+///   this value is 0, the leases are reclaimed by the main thread.
+///
 /// The @c CfgExpiration class provides a collection of accessors and
 /// modifiers to manage the data. Each accessor checks if the given value
 /// is in range allowed for this value.
@@ -82,6 +89,12 @@ public:
     /// @brief Default value for unwarned-reclaim-cycles.
     static const uint16_t DEFAULT_UNWARNED_RECLAIM_CYCLES;
 
+    /// @brief Default value for reclaim-batch-size.
+    static const uint16_t DEFAULT_RECLAIM_BATCH_SIZE;
+
+    /// @brief Default value for reclaim-threads.
+    static const uint16_t DEFAULT_RECLAIM_THREADS;
+
     //@}
 
     /// @name Upper limits for the parameters
@@ -105,6 +118,12 @@ public:
     /// @brief Maximum value for unwarned-reclaim-cycles.
     static const uint16_t LIMIT_UNWARNED_RECLAIM_CYCLES;
 
+    /// @brief Maximum value for reclaim-batch-size.
+    static const uint16_t LIMIT_RECLAIM_BATCH_SIZE;
+
+    /// @brief Maximum value for reclaim-threads.
+    static const uint16_t LIMIT_RECLAIM_THREADS;
+
     //@}
 
     /// @name Timers' names
@@ -188,6 +207,28 @@ public:
     /// @param unwarned_reclaim_cycles New value.
     void setUnwarnedReclaimCycles(const int64_t unwarned_reclaim_cycles);
 
+    /// @brief Returns reclaim-batch-size.
+    uint16_t getReclaimBatchSize() const {
+        return (reclaim_batch_size_);
+    }
+
+    /// @brief Sets reclaim-batch-size.
+    ///
+    /// @param reclaim_batch_size New value.
+    ///
+    /// @throw isc::OutOfRange if the value is 0.
+    void setReclaimBatchSize(const int64_t reclaim_batch_size);
+
+    /// @brief Returns reclaim-threads.
+    uint16_t getReclaimThreads() const {
+        return (reclaim_threads_);
+    }
+
+    /// @brief Sets reclaim-threads.
+    ///
+    /// @param reclaim_threads New value.
+    void setReclaimThreads(const int64_t reclaim_threads);
+
     /// @brief Setup timers for the reclamation of expired leases according
     /// to the configuration parameters.
     ///
@@ -262,6 +303,12 @@ private:
     /// @brief unwarned-reclaim-cycles.
     uint16_t unwarned_reclaim_cycles_;
 
+    /// @brief reclaim-batch-size.
+    uint16_t reclaim_batch_size_;
+
+    /// @brief reclaim-threads.
+    uint16_t reclaim_threads_;
+
     /// @brief Pointer to the instance of the Timer Manager.
     TimerMgrPtr timer_mgr_;
 
@@ -23,7 +23,10 @@ const char* CfgIface::ALL_IFACES_KEYWORD = "*";
 
 CfgIface::CfgIface()
     : wildcard_used_(false), socket_type_(SOCKET_RAW), re_detect_(false),
-      outbound_iface_(SAME_AS_INBOUND) {
+      outbound_iface_(SAME_AS_INBOUND),
+      fd_event_handler_type_(util::FDEventHandler::TYPE_SELECT),
+      packet_mmap_(false), socket_sharding_(false),
+      lazy_option_unpack_(false) {
 }
 
 void
@@ -88,6 +91,8 @@ CfgIface::openSockets(const uint16_t family, const uint16_t port,
     iface_mgr.clearUnicasts();
     // Allow the loopback interface when required.
     iface_mgr.setAllowLoopBack(loopback_used_);
+    // The sockets are closed, so the event handler can be replaced.
+    iface_mgr.setFDEventHandlerType(fd_event_handler_type_);
     // For the DHCPv4 server, if the user has selected that raw sockets
     // should be used, we will try to configure the Interface Manager to
     // support the direct responses to the clients that don't have the
@@ -95,6 +100,7 @@ CfgIface::openSockets(const uint16_t family, const uint16_t port,
     // sockets. However, this may be unsupported on some operating
     // systems, so there is no guarantee.
     if ((family == AF_INET) && (!IfaceMgr::instance().isTestMode())) {
+        iface_mgr.setPacketMmap(packet_mmap_);
         iface_mgr.setMatchingPacketFilter(socket_type_ == SOCKET_RAW);
         if ((socket_type_ == SOCKET_RAW) &&
             !iface_mgr.isDirectResponseSupported()) {
@@ -492,6 +498,28 @@ CfgIface::toElement() const {
         result->set("outbound-interface", Element::create(outboundTypeToText()));
     }
 
+    // Set fd-event-handler
+    if (fd_event_handler_type_ != util::FDEventHandler::TYPE_SELECT) {
+        std::string handler =
+            util::FDEventHandler::typeToText(fd_event_handler_type_);
+        result->set("fd-event-handler", Element::create(handler));
+    }
+
+    // Set packet-mmap
+    if (packet_mmap_) {
+        result->set("packet-mmap", Element::create(packet_mmap_));
+    }
+
+    // Set socket-sharding
+    if (socket_sharding_) {
+        result->set("socket-sharding", Element::create(socket_sharding_));
+    }
+
+    // Set lazy-option-unpack
+    if (lazy_option_unpack_) {
+        result->set("lazy-option-unpack", Element::create(lazy_option_unpack_));
+    }
+
     // Set re-detect
     result->set("re-detect", Element::create(re_detect_));
 
@@ -11,6 +11,7 @@
 #include <dhcp/iface_mgr.h>
 #include <cc/cfg_to_element.h>
 #include <cc/user_context.h>
+#include <util/fd_event_handler.h>
 #include <boost/shared_ptr.hpp>
 #include <map>
 #include <set>
@@ -302,6 +303,67 @@ public:
         re_detect_ = re_detect;
     }
 
+    /// @brief Sets the type of the handler waiting for data on the sockets.
+    ///
+    /// The handler is installed in the @c IfaceMgr when the sockets are
+    /// opened.
+    ///
+    /// @param type the new handler type.
+    void setFDEventHandlerType(const util::FDEventHandler::HandlerType type) {
+        fd_event_handler_type_ = type;
+    }
+
+    /// @brief Returns the type of the handler waiting for data on the sockets.
+    util::FDEventHandler::HandlerType getFDEventHandlerType() const {
+        return (fd_event_handler_type_);
+    }
+
+    /// @brief Sets the use of the memory mapped receive ring.
+    ///
+    /// The ring is used by the raw sockets of the DHCPv4 server, on Linux,
+    /// when they are opened.
+    ///
+    /// @param packet_mmap true to use the memory mapped ring.
+    void setPacketMmap(const bool packet_mmap) {
+        packet_mmap_ = packet_mmap;
+    }
+
+    /// @brief Checks if the memory mapped receive ring is used.
+    bool getPacketMmap() const {
+        return (packet_mmap_);
+    }
+
+    /// @brief Enables or disables socket sharding.
+    ///
+    /// The server sets the number of socket shards in the @c IfaceMgr
+    /// according to its threading configuration when it is enabled.
+    ///
+    /// @param socket_sharding true to enable socket sharding.
+    void setSocketSharding(const bool socket_sharding) {
+        socket_sharding_ = socket_sharding;
+    }
+
+    /// @brief Checks if socket sharding is enabled.
+    bool getSocketSharding() const {
+        return (socket_sharding_);
+    }
+
+    /// @brief Enables or disables lazy option unpacking.
+    ///
+    /// When enabled, the server only unpacks the options of a query
+    /// when they are first accessed. It is ignored when hook libraries
+    /// are loaded.
+    ///
+    /// @param lazy_option_unpack true to enable lazy option unpacking.
+    void setLazyOptionUnpack(const bool lazy_option_unpack) {
+        lazy_option_unpack_ = lazy_option_unpack;
+    }
+
+    /// @brief Checks if lazy option unpacking is enabled.
+    bool getLazyOptionUnpack() const {
+        return (lazy_option_unpack_);
+    }
+
 private:
 
     /// @brief Checks if multiple IPv4 addresses has been activated on any
@@ -381,6 +443,18 @@ private:
 
     /// @brief Indicates how outbound interface is selected for relayed traffic.
     OutboundIface outbound_iface_;
+
+    /// @brief Type of the handler waiting for data on the sockets.
+    util::FDEventHandler::HandlerType fd_event_handler_type_;
+
+    /// @brief Use the memory mapped receive ring for the raw sockets.
+    bool packet_mmap_;
+
+    /// @brief Indicates if socket sharding is enabled.
+    bool socket_sharding_;
+
+    /// @brief Indicates if lazy option unpacking is enabled.
+    bool lazy_option_unpack_;
 };
 
 /// @brief A pointer to the @c CfgIface .
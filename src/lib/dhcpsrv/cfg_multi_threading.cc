@@ -23,6 +23,12 @@ CfgMultiThreading::apply(ConstElementPtr value) {
         uint32_t thread_count = 0;
         uint32_t queue_size = 0;
         CfgMultiThreading::extract(value, enabled, thread_count, queue_size);
+        // The client affinity must be known when the thread pool starts.
+        bool client_affinity = false;
+        if (value && value->get("client-affinity")) {
+            client_affinity = SimpleParser::getBoolean(value, "client-affinity");
+        }
+        MultiThreadingMgr::instance().setClientAffinity(client_affinity);
         MultiThreadingMgr::instance().apply(enabled, thread_count, queue_size);
 }
 
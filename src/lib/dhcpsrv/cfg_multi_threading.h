@@ -18,6 +18,8 @@ public:
 
     /// @brief apply multi threading configuration
     ///
+    /// The client affinity is set before the thread pool is started.
+    ///
     /// @param value The multi-threading configuration
     static void apply(data::ConstElementPtr value);
 
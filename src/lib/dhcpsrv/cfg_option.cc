@@ -252,6 +252,32 @@ CfgOption::encapsulate() {
     encapsulateInternal(DHCP6_OPTION_SPACE);
 }
 
+void
+CfgOption::createWireData() {
+    for (auto space : getOptionSpaceNames()) {
+        createWireDataInternal(getAll(space));
+    }
+    for (auto vendor_id : getVendorIds()) {
+        createWireDataInternal(getAll(vendor_id));
+    }
+}
+
+void
+CfgOption::createWireDataInternal(const OptionContainerPtr& options) {
+    for (auto desc : *options) {
+        if (!desc.option_) {
+            continue;
+        }
+        try {
+            desc.option_->createWireData();
+        } catch (const std::exception&) {
+            // The option will be packed, and fail, for each response
+            // as if it had no wire data.
+            desc.option_->clearWireData();
+        }
+    }
+}
+
 void
 CfgOption::encapsulateInternal(const std::string& option_space) {
     // Get all options for the particular option space.
@@ -370,7 +396,13 @@ CfgOption::del(const std::string& option_space, const uint16_t option_code) {
     }
 
     auto& idx = options->get<1>();
-    return (idx.erase(option_code));
+    size_t num_deleted = idx.erase(option_code);
+
+    // The options which indirectly encapsulated the deleted option lost
+    // their wire data.
+    createWireData();
+
+    return (num_deleted);
 }
 
 size_t
@@ -417,6 +449,7 @@ CfgOption::del(const uint64_t id) {
 
     // Let's encapsulate those options that remain in the configuration.
     encapsulate();
+    createWireData();
 
     // Return the number of deleted options.
     return (num_deleted);
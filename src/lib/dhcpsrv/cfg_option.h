@@ -504,6 +504,15 @@ public:
     /// options from this option space are appended to top-level options.
     void encapsulate();
 
+    /// @brief Creates the wire data of all options.
+    ///
+    /// It calls @c Option::createWireData for the options of all option
+    /// spaces, including the vendor option spaces, so the configured
+    /// options are not packed again for each response. It must be called
+    /// after @c encapsulate, when the options are complete. Options which
+    /// can't be packed are left without wire data.
+    void createWireData();
+
     /// @brief Returns all options for the specified option space.
     ///
     /// This method will not return vendor options, i.e. having option space
@@ -564,7 +573,8 @@ public:
     ///
     /// If the option is encapsulated within some non top level option space,
     /// it is also deleted from all option instances encapsulating this
-    /// option space.
+    /// option space. The wire data of the options is then created again
+    /// by @c createWireData().
     ///
     /// @param option_space Option space name.
     /// @param option_code Code of the option to be returned.
@@ -592,8 +602,8 @@ public:
     /// Both regular and vendor specific options are deleted with this
     /// method.
     ///
-    /// This method internally calls @c encapsulate() after deleting
-    /// options having the given id.
+    /// This method internally calls @c encapsulate() and
+    /// @c createWireData() after deleting options having the given id.
     ///
     /// @param id Identifier of the options to be deleted.
     ///
@@ -668,6 +678,11 @@ private:
     /// @param option which encapsulated options.
     void encapsulateInternal(const OptionPtr& option);
 
+    /// @brief Creates the wire data of the options of an option space.
+    ///
+    /// @param options the options of the option space.
+    void createWireDataInternal(const OptionContainerPtr& options);
+
     /// @brief Merges data from two option containers.
     ///
     /// This method merges options from one option container to another
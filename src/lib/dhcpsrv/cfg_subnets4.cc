@@ -39,6 +39,7 @@ CfgSubnets4::add(const Subnet4Ptr& subnet) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE, DHCPSRV_CFGMGR_ADD_SUBNET4)
               .arg(subnet->toText());
     static_cast<void>(subnets_.insert(subnet));
+    resetSelectionIndex();
 }
 
 Subnet4Ptr
@@ -52,6 +53,7 @@ CfgSubnets4::replace(const Subnet4Ptr& subnet) {
     }
     Subnet4Ptr old = *subnet_it;
     bool ret = index.replace(subnet_it, subnet);
+    resetSelectionIndex();
 
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE, DHCPSRV_CFGMGR_UPDATE_SUBNET4)
         .arg(subnet_id).arg(ret);
@@ -79,6 +81,7 @@ CfgSubnets4::del(const SubnetID& subnet_id) {
     Subnet4Ptr subnet = *subnet_it;
 
     index.erase(subnet_it);
+    resetSelectionIndex();
 
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE, DHCPSRV_CFGMGR_DEL_SUBNET4)
         .arg(subnet->toText());
@@ -90,6 +93,9 @@ CfgSubnets4::merge(CfgOptionDefPtr cfg_def, CfgSharedNetworks4Ptr networks,
     auto& index_id = subnets_.get<SubnetSubnetIdIndexTag>();
     auto& index_prefix = subnets_.get<SubnetPrefixIndexTag>();
 
+    // The subnets and their shared networks are changing.
+    resetSelectionIndex();
+
     // Iterate over the subnets to be merged. They will replace the existing
     // subnets with the same id. All new subnets will be inserted into the
     // configuration into which we're merging.
@@ -252,6 +258,26 @@ CfgSubnets4::initSelector(const Pkt4Ptr& query) {
 Subnet4Ptr
 CfgSubnets4::selectSubnet4o6(const SubnetSelector& selector) const {
 
+    if (selection_index4o6_) {
+        // Each match criteria gives its candidates in the identifier
+        // order: the first subnet matching any criteria is selected.
+        Subnet4Ptr selected;
+        auto select = [&selected](const SelectionIndex::SubnetList& subnets) {
+            if (!subnets.empty() &&
+                (!selected || (subnets.front()->getID() < selected->getID()))) {
+                selected = subnets.front();
+            }
+        };
+        select(selection_index4o6_->getByAddress(selector.remote_address_));
+        if (selector.interface_id_) {
+            select(selection_index4o6_->getByInterfaceId(selector.interface_id_));
+        }
+        if (!selector.iface_name_.empty()) {
+            select(selection_index4o6_->getByIface(selector.iface_name_));
+        }
+        return (selected);
+    }
+
     for (Subnet4Collection::const_iterator subnet = subnets_.begin();
          subnet != subnets_.end(); ++subnet) {
         Cfg4o6& cfg4o6 = (*subnet)->get4o6();
@@ -305,7 +331,15 @@ CfgSubnets4::selectSubnet(const SubnetSelector& selector) const {
     // possible that the relay address will not match with any of the relay
     // addresses across all subnets, but we need to verify that for all subnets
     // before we can try to use the giaddr to match with the subnet prefix.
-    if (!selector.giaddr_.isV4Zero()) {
+    if (!selector.giaddr_.isV4Zero() && selection_index_) {
+        for (auto const& subnet : selection_index_->getByRelay(selector.giaddr_)) {
+            // If a subnet meets the client class criteria return it.
+            if (subnet->clientSupported(selector.client_classes_)) {
+                return (subnet);
+            }
+        }
+
+    } else if (!selector.giaddr_.isV4Zero()) {
         for (Subnet4Collection::const_iterator subnet = subnets_.begin();
              subnet != subnets_.end(); ++subnet) {
 
@@ -392,6 +426,20 @@ CfgSubnets4::selectSubnet(const SubnetSelector& selector) const {
 Subnet4Ptr
 CfgSubnets4::selectSubnet(const std::string& iface,
                           const ClientClasses& client_classes) const {
+    if (selection_index_) {
+        for (auto const& subnet : selection_index_->getByIface(iface)) {
+            // If a subnet meets the client class criteria return it.
+            if (subnet->clientSupported(client_classes)) {
+                LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE,
+                          DHCPSRV_CFGMGR_SUBNET4_IFACE)
+                    .arg(subnet->toText())
+                    .arg(iface);
+                return (subnet);
+            }
+        }
+        return (Subnet4Ptr());
+    }
+
     for (Subnet4Collection::const_iterator subnet = subnets_.begin();
          subnet != subnets_.end(); ++subnet) {
 
@@ -448,6 +496,19 @@ CfgSubnets4::getSubnet(const SubnetID id) const {
 Subnet4Ptr
 CfgSubnets4::selectSubnet(const IOAddress& address,
                  const ClientClasses& client_classes) const {
+    if (selection_index_) {
+        for (auto const& subnet : selection_index_->getByAddress(address)) {
+            // If a subnet meets the client class criteria return it.
+            if (subnet->clientSupported(client_classes)) {
+                LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE, DHCPSRV_CFGMGR_SUBNET4_ADDR)
+                    .arg(subnet->toText())
+                    .arg(address.toText());
+                return (subnet);
+            }
+        }
+        return (Subnet4Ptr());
+    }
+
     for (Subnet4Collection::const_iterator subnet = subnets_.begin();
          subnet != subnets_.end(); ++subnet) {
 
@@ -469,6 +530,68 @@ CfgSubnets4::selectSubnet(const IOAddress& address,
     return (Subnet4Ptr());
 }
 
+void
+CfgSubnets4::initSelectionIndex() {
+    boost::shared_ptr<SelectionIndex> index(new SelectionIndex());
+    boost::shared_ptr<SelectionIndex> index4o6(new SelectionIndex());
+
+    // The subnets are iterated in the identifier order which is the
+    // order the candidates are checked in.
+    for (auto const& subnet : subnets_) {
+        std::pair<IOAddress, uint8_t> prefix = subnet->get();
+        index->addPrefix(prefix.first, prefix.second, subnet);
+
+        SharedNetwork4Ptr network;
+        subnet->getSharedNetwork(network);
+
+        // The relay addresses specified for the subnet take precedence
+        // over the relay addresses of its shared network.
+        if (subnet->hasRelays()) {
+            for (auto const& address : subnet->getRelayAddresses()) {
+                index->addRelay(address, subnet);
+            }
+        } else if (network) {
+            for (auto const& address : network->getRelayAddresses()) {
+                index->addRelay(address, subnet);
+            }
+        }
+
+        // Same for the interface name.
+        util::Optional<std::string> iface =
+            subnet->getIface(Network4::Inheritance::NONE);
+        if (!iface.empty()) {
+            index->addIface(iface.get(), subnet);
+        } else if (network) {
+            index->addIface(network->getIface(Network4::Inheritance::NONE).get(),
+                            subnet);
+        }
+
+        const Cfg4o6& cfg4o6 = subnet->get4o6();
+        if (!cfg4o6.enabled()) {
+            continue;
+        }
+        std::pair<IOAddress, uint8_t> pref = cfg4o6.getSubnet4o6();
+        if (!pref.first.isV6Zero()) {
+            index4o6->addPrefix(pref.first, pref.second, subnet);
+        }
+        if (cfg4o6.getInterfaceId()) {
+            index4o6->addInterfaceId(cfg4o6.getInterfaceId(), subnet);
+        }
+        if (!cfg4o6.getIface4o6().empty()) {
+            index4o6->addIface(cfg4o6.getIface4o6().get(), subnet);
+        }
+    }
+
+    selection_index_ = index;
+    selection_index4o6_ = index4o6;
+}
+
+void
+CfgSubnets4::resetSelectionIndex() {
+    selection_index_.reset();
+    selection_index4o6_.reset();
+}
+
 void
 CfgSubnets4::removeStatistics() {
     using namespace isc::stats;
@@ -495,6 +618,14 @@ CfgSubnets4::removeStatistics() {
 
         stats_mgr.del(StatsMgr::generateName("subnet", subnet_id,
                                              "reclaimed-leases"));
+
+        size_t pools = (*subnet4)->getPools(Lease::TYPE_V4).size();
+        for (size_t index = 0; index < pools; ++index) {
+            stats_mgr.del(Subnet::getPoolStatName(subnet_id, index,
+                                                  "total-addresses"));
+            stats_mgr.del(Subnet::getPoolStatName(subnet_id, index,
+                                                  "assigned-addresses"));
+        }
     }
 }
 
@@ -522,6 +653,48 @@ CfgSubnets4::updateStatistics() {
     // Only recount the stats if we have subnets.
     if (subnets_.begin() != subnets_.end()) {
         LeaseMgrFactory::instance().recountLeaseStats4();
+        recountPools();
+    }
+}
+
+void
+CfgSubnets4::recountPools() {
+    using namespace isc::stats;
+
+    StatsMgr& stats_mgr = StatsMgr::instance();
+    LeaseMgr& lease_mgr = LeaseMgrFactory::instance();
+    for (auto const& subnet : subnets_) {
+        const PoolCollection& pools = subnet->getPools(Lease::TYPE_V4);
+        for (auto const& pool : pools) {
+            pool->setAssigned(0);
+        }
+        for (auto const& lease : lease_mgr.getLeases4(subnet->getID())) {
+            if (lease->stateExpiredReclaimed()) {
+                continue;
+            }
+            PoolPtr pool = subnet->getPool(Lease::TYPE_V4, lease->addr_, false);
+            if (pool) {
+                pool->addAssigned(1);
+            }
+        }
+        for (size_t index = 0; index < pools.size(); ++index) {
+            stats_mgr.setValue(Subnet::getPoolStatName(subnet->getID(), index,
+                                                       "total-addresses"),
+                               static_cast<int64_t>(pools[index]->getCapacity()));
+            stats_mgr.setValue(Subnet::getPoolStatName(subnet->getID(), index,
+                                                       "assigned-addresses"),
+                               static_cast<int64_t>(pools[index]->getAssigned()));
+        }
+    }
+}
+
+void
+CfgSubnets4::updatePoolAssigned(const SubnetID& subnet_id,
+                                const IOAddress& address,
+                                int64_t delta) const {
+    ConstSubnet4Ptr subnet = getBySubnetId(subnet_id);
+    if (subnet) {
+        subnet->updatePoolAssigned(Lease::TYPE_V4, address, delta);
     }
 }
 
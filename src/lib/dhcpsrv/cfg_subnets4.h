@@ -13,6 +13,7 @@
 #include <dhcpsrv/cfg_shared_networks.h>
 #include <dhcpsrv/subnet.h>
 #include <dhcpsrv/subnet_id.h>
+#include <dhcpsrv/subnet_selection_index.h>
 #include <dhcpsrv/subnet_selector.h>
 #include <boost/shared_ptr.hpp>
 #include <string>
@@ -202,13 +203,10 @@ public:
     ///
     /// If the address matches with a subnet, the subnet is returned.
     ///
-    /// @todo This method requires performance improvement! It currently
-    /// iterates over all existing subnets (possibly a couple of times)
-    /// to find the one which fulfills the search criteria. The subnet storage
-    /// is implemented as a simple STL vector which precludes fast searches
-    /// using specific keys. Hence, full scan is required. To improve the
-    /// search performance a different container type is required, e.g.
-    /// multi-index container, or something of a similar functionality.
+    /// When several subnets match, the subnet with the lowest identifier
+    /// which supports the client classes is returned. The candidates are
+    /// looked up in the selection index when it is built, see
+    /// @c initSelectionIndex, otherwise all subnets are scanned.
     ///
     /// @param selector Const reference to the selector structure which holds
     /// various information extracted from the client's packet which are used
@@ -234,13 +232,8 @@ public:
     /// testing. This method is also called by the
     /// @c selectSubnet(SubnetSelector).
     ///
-    /// @todo This method requires performance improvement! It currently
-    /// iterates over all existing subnets to find the one which fulfills
-    /// the search criteria. The subnet storage is implemented as a simple
-    /// STL vector which precludes fast searches using specific keys.
-    /// Hence, full scan is required. To improve the search performance a
-    /// different container type is required, e.g. multi-index container,
-    /// or something of a similar functionality.
+    /// The candidates are looked up in the selection index when it is
+    /// built, otherwise all subnets are scanned.
     ///
     /// @param address Address for which the subnet is searched.
     /// @param client_classes Optional parameter specifying the classes that
@@ -259,13 +252,8 @@ public:
     /// not match a subnet definition. This method is also called by the
     /// @c selectSubnet(SubnetSelector).
     ///
-    /// @todo This method requires performance improvement! It currently
-    /// iterates over all existing subnets to find the one which fulfills
-    /// the search criteria. The subnet storage is implemented as a simple
-    /// STL vector which precludes fast searches using specific keys.
-    /// Hence, full scan is required. To improve the search performance a
-    /// different container type is required, e.g. multi-index container,
-    /// or something of a similar functionality.
+    /// The candidates are looked up in the selection index when it is
+    /// built, otherwise all subnets are scanned.
     ///
     /// @param iface name of the interface to be matched.
     /// @param client_classes Optional parameter specifying the classes that
@@ -297,6 +285,16 @@ public:
     Subnet4Ptr
     selectSubnet4o6(const SubnetSelector& selector) const;
 
+    /// @brief Indexes the subnets for the subnet selection.
+    ///
+    /// The index maps the subnet prefixes, relay addresses, interface
+    /// names and DHCPv4o6 parameters to the subnets so the subnet
+    /// selection doesn't scan all subnets. It is built when the
+    /// configuration is committed. Adding, replacing, removing or
+    /// merging subnets discards the index and the subnet selection
+    /// falls back to a full scan until the index is built again.
+    void initSelectionIndex();
+
     /// @brief Updates statistics.
     ///
     /// This method updates statistics that are affected by the newly committed
@@ -314,6 +312,20 @@ public:
     /// configuration and also subnet-ids may change.
     void removeStatistics();
 
+    /// @brief Updates the assigned leases counter of the pool containing
+    /// an address.
+    ///
+    /// It is called when an address is leased or freed, also by the
+    /// callers which only know the subnet identifier of the lease. It
+    /// does nothing if there is no such subnet or pool.
+    ///
+    /// @param subnet_id identifier of the subnet of the lease.
+    /// @param address the leased address.
+    /// @param delta the change of the number of assigned leases.
+    void updatePoolAssigned(const SubnetID& subnet_id,
+                            const asiolink::IOAddress& address,
+                            int64_t delta) const;
+
     /// @brief Unparse a configuration object
     ///
     /// @return a pointer to unparsed configuration
@@ -321,9 +333,30 @@ public:
 
 private:
 
+    /// @brief Counts the assigned leases of each pool.
+    ///
+    /// The counters of the pools are set from the lease database and the
+    /// per pool statistics are set accordingly. Leases in the
+    /// expired-reclaimed state are free, other leases are assigned.
+    void recountPools();
+
+    /// @brief Discards the subnet selection indexes.
+    ///
+    /// It is called when the subnets are modified.
+    void resetSelectionIndex();
+
     /// @brief A container for IPv4 subnets.
     Subnet4Collection subnets_;
 
+    /// @brief Type of the subnet selection index.
+    typedef SubnetSelectionIndex<Subnet4Ptr> SelectionIndex;
+
+    /// @brief Subnet selection index or null when not built.
+    boost::shared_ptr<SelectionIndex> selection_index_;
+
+    /// @brief DHCPv4o6 subnet selection index or null when not built.
+    boost::shared_ptr<SelectionIndex> selection_index4o6_;
+
 };
 
 /// @name Pointer to the @c CfgSubnets4 objects.
@@ -39,6 +39,7 @@ CfgSubnets6::add(const Subnet6Ptr& subnet) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE, DHCPSRV_CFGMGR_ADD_SUBNET6)
               .arg(subnet->toText());
     static_cast<void>(subnets_.insert(subnet));
+    resetSelectionIndex();
 }
 
 Subnet6Ptr
@@ -52,6 +53,7 @@ CfgSubnets6::replace(const Subnet6Ptr& subnet) {
     }
     Subnet6Ptr old = *subnet_it;
     bool ret = index.replace(subnet_it, subnet);
+    resetSelectionIndex();
 
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE, DHCPSRV_CFGMGR_UPDATE_SUBNET6)
         .arg(subnet_id).arg(ret);
@@ -79,6 +81,7 @@ CfgSubnets6::del(const SubnetID& subnet_id) {
     Subnet6Ptr subnet = *subnet_it;
 
     index.erase(subnet_it);
+    resetSelectionIndex();
 
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE, DHCPSRV_CFGMGR_DEL_SUBNET6)
         .arg(subnet->toText());
@@ -90,6 +93,9 @@ CfgSubnets6::merge(CfgOptionDefPtr cfg_def, CfgSharedNetworks6Ptr networks,
     auto& index_id = subnets_.get<SubnetSubnetIdIndexTag>();
     auto& index_prefix = subnets_.get<SubnetPrefixIndexTag>();
 
+    // The subnets and their shared networks are changing.
+    resetSelectionIndex();
+
     // Iterate over the subnets to be merged. They will replace the existing
     // subnets with the same id. All new subnets will be inserted into the
     // configuration into which we're merging.
@@ -266,6 +272,30 @@ CfgSubnets6::selectSubnet(const asiolink::IOAddress& address,
                           const ClientClasses& client_classes,
                           const bool is_relay_address) const {
 
+    if (selection_index_) {
+        // If the specified address is a relay address we first need to
+        // match it with the relay addresses specified for all subnets.
+        if (is_relay_address) {
+            for (auto const& subnet : selection_index_->getByRelay(address)) {
+                if (subnet->clientSupported(client_classes)) {
+                    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE,
+                              DHCPSRV_CFGMGR_SUBNET6_RELAY)
+                        .arg(subnet->toText()).arg(address.toText());
+                    return (subnet);
+                }
+            }
+        }
+
+        for (auto const& subnet : selection_index_->getByAddress(address)) {
+            if (subnet->clientSupported(client_classes)) {
+                LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE, DHCPSRV_CFGMGR_SUBNET6)
+                          .arg(subnet->toText()).arg(address.toText());
+                return (subnet);
+            }
+        }
+        return (Subnet6Ptr());
+    }
+
     // If the specified address is a relay address we first need to match
     // it with the relay addresses specified for all subnets.
     if (is_relay_address) {
@@ -320,7 +350,17 @@ CfgSubnets6::selectSubnet(const std::string& iface_name,
                           const ClientClasses& client_classes) const {
 
     // If empty interface specified, we can't select subnet by interface.
-    if (!iface_name.empty()) {
+    if (!iface_name.empty() && selection_index_) {
+        for (auto const& subnet : selection_index_->getByIface(iface_name)) {
+            if (subnet->clientSupported(client_classes)) {
+                LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE,
+                          DHCPSRV_CFGMGR_SUBNET6_IFACE)
+                    .arg(subnet->toText()).arg(iface_name);
+                return (subnet);
+            }
+        }
+
+    } else if (!iface_name.empty()) {
         for (Subnet6Collection::const_iterator subnet = subnets_.begin();
              subnet != subnets_.end(); ++subnet) {
 
@@ -347,7 +387,18 @@ CfgSubnets6::selectSubnet(const OptionPtr& interface_id,
                           const ClientClasses& client_classes) const {
     // We can only select subnet using an interface id, if the interface
     // id is known.
-    if (interface_id) {
+    if (interface_id && selection_index_) {
+        for (auto const& subnet :
+                 selection_index_->getByInterfaceId(interface_id)) {
+            if (subnet->clientSupported(client_classes)) {
+                LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE,
+                      DHCPSRV_CFGMGR_SUBNET6_IFACE_ID)
+                    .arg(subnet->toText());
+                return (subnet);
+            }
+        }
+
+    } else if (interface_id) {
         for (Subnet6Collection::const_iterator subnet = subnets_.begin();
              subnet != subnets_.end(); ++subnet) {
 
@@ -381,6 +432,48 @@ CfgSubnets6::getSubnet(const SubnetID id) const {
     return (Subnet6Ptr());
 }
 
+void
+CfgSubnets6::initSelectionIndex() {
+    boost::shared_ptr<SelectionIndex> index(new SelectionIndex());
+
+    // The subnets are iterated in the identifier order which is the
+    // order the candidates are checked in.
+    for (auto const& subnet : subnets_) {
+        std::pair<IOAddress, uint8_t> prefix = subnet->get();
+        index->addPrefix(prefix.first, prefix.second, subnet);
+
+        // The relay addresses specified for the subnet take precedence
+        // over the relay addresses of its shared network.
+        if (subnet->hasRelays()) {
+            for (auto const& address : subnet->getRelayAddresses()) {
+                index->addRelay(address, subnet);
+            }
+        } else {
+            SharedNetwork6Ptr network;
+            subnet->getSharedNetwork(network);
+            if (network) {
+                for (auto const& address : network->getRelayAddresses()) {
+                    index->addRelay(address, subnet);
+                }
+            }
+        }
+
+        // The interface name and identifier are inherited from the
+        // shared network.
+        index->addIface(subnet->getIface().get(), subnet);
+        if (subnet->getInterfaceId()) {
+            index->addInterfaceId(subnet->getInterfaceId(), subnet);
+        }
+    }
+
+    selection_index_ = index;
+}
+
+void
+CfgSubnets6::resetSelectionIndex() {
+    selection_index_.reset();
+}
+
 void
 CfgSubnets6::removeStatistics() {
     using namespace isc::stats;
@@ -414,6 +507,22 @@ CfgSubnets6::removeStatistics() {
 
         stats_mgr.del(StatsMgr::generateName("subnet", subnet_id,
                                              "reclaimed-leases"));
+
+        size_t pools = (*subnet6)->getPools(Lease::TYPE_NA).size();
+        for (size_t index = 0; index < pools; ++index) {
+            stats_mgr.del(Subnet::getPoolStatName(subnet_id, index,
+                                                  "total-nas"));
+            stats_mgr.del(Subnet::getPoolStatName(subnet_id, index,
+                                                  "assigned-nas"));
+        }
+
+        pools = (*subnet6)->getPools(Lease::TYPE_PD).size();
+        for (size_t index = 0; index < pools; ++index) {
+            stats_mgr.del(Subnet::getPoolStatName(subnet_id, index,
+                                                  "total-pds"));
+            stats_mgr.del(Subnet::getPoolStatName(subnet_id, index,
+                                                  "assigned-pds"));
+        }
     }
 }
 
@@ -453,6 +562,62 @@ CfgSubnets6::updateStatistics() {
     // Only recount the stats if we have subnets.
     if (subnets_.begin() != subnets_.end()) {
         LeaseMgrFactory::instance().recountLeaseStats6();
+        recountPools();
+    }
+}
+
+void
+CfgSubnets6::recountPools() {
+    using namespace isc::stats;
+
+    StatsMgr& stats_mgr = StatsMgr::instance();
+    LeaseMgr& lease_mgr = LeaseMgrFactory::instance();
+    const Lease::Type types[] = { Lease::TYPE_NA, Lease::TYPE_TA, Lease::TYPE_PD };
+    for (auto const& subnet : subnets_) {
+        for (auto type : types) {
+            for (auto const& pool : subnet->getPools(type)) {
+                pool->setAssigned(0);
+            }
+        }
+        for (auto const& lease : lease_mgr.getLeases6(subnet->getID())) {
+            if (lease->stateExpiredReclaimed()) {
+                continue;
+            }
+            PoolPtr pool = subnet->getPool(lease->type_, lease->addr_, false);
+            if (pool) {
+                pool->addAssigned(1);
+            }
+        }
+
+        // There are no statistics for temporary addresses.
+        const PoolCollection& nas = subnet->getPools(Lease::TYPE_NA);
+        for (size_t index = 0; index < nas.size(); ++index) {
+            stats_mgr.setValue(Subnet::getPoolStatName(subnet->getID(), index,
+                                                       "total-nas"),
+                               static_cast<int64_t>(nas[index]->getCapacity()));
+            stats_mgr.setValue(Subnet::getPoolStatName(subnet->getID(), index,
+                                                       "assigned-nas"),
+                               static_cast<int64_t>(nas[index]->getAssigned()));
+        }
+        const PoolCollection& pds = subnet->getPools(Lease::TYPE_PD);
+        for (size_t index = 0; index < pds.size(); ++index) {
+            stats_mgr.setValue(Subnet::getPoolStatName(subnet->getID(), index,
+                                                       "total-pds"),
+                               static_cast<int64_t>(pds[index]->getCapacity()));
+            stats_mgr.setValue(Subnet::getPoolStatName(subnet->getID(), index,
+                                                       "assigned-pds"),
+                               static_cast<int64_t>(pds[index]->getAssigned()));
+        }
+    }
+}
+
+void
+CfgSubnets6::updatePoolAssigned(const SubnetID& subnet_id, Lease::Type type,
+                                const IOAddress& address,
+                                int64_t delta) const {
+    ConstSubnet6Ptr subnet = getBySubnetId(subnet_id);
+    if (subnet) {
+        subnet->updatePoolAssigned(type, address, delta);
     }
 }
 
@@ -14,6 +14,7 @@
 #include <dhcpsrv/cfg_shared_networks.h>
 #include <dhcpsrv/subnet.h>
 #include <dhcpsrv/subnet_id.h>
+#include <dhcpsrv/subnet_selection_index.h>
 #include <dhcpsrv/subnet_selector.h>
 #include <util/optional.h>
 #include <boost/shared_ptr.hpp>
@@ -186,13 +187,10 @@ public:
     /// associated with any subnet. If not, it is checked if the link address
     /// is in range with any of the subnets.
     ///
-    /// @todo This method requires performance improvement! It currently
-    /// iterates over all existing subnets (possibly a couple of times)
-    /// to find the one which fulfills the search criteria. The subnet storage
-    /// is implemented as a simple STL vector which precludes fast searches
-    /// using specific keys. Hence, full scan is required. To improve the
-    /// search performance a different container type is required, e.g.
-    /// multi-index container, or something of a similar functionality.
+    /// When several subnets match, the subnet with the lowest identifier
+    /// which supports the client classes is returned. The candidates are
+    /// looked up in the selection index when it is built, see
+    /// @c initSelectionIndex, otherwise all subnets are scanned.
     ///
     /// @param selector Const reference to the selector structure which holds
     /// various information extracted from the client's packet which are used
@@ -227,13 +225,8 @@ public:
     /// address. For other purposes the @c selectSubnet(SubnetSelector) should
     /// rather be used instead.
     ///
-    /// @todo This method requires performance improvement! It currently
-    /// iterates over all existing subnets (possibly a couple of times)
-    /// to find the one which fulfills the search criteria. The subnet storage
-    /// is implemented as a simple STL vector which precludes fast searches
-    /// using specific keys. Hence, full scan is required. To improve the
-    /// search performance a different container type is required, e.g.
-    /// multi-index container, or something of a similar functionality.
+    /// The candidates are looked up in the selection index when it is
+    /// built, otherwise all subnets are scanned.
     ///
     /// @param address Address for which the subnet is searched.
     /// @param client_classes Optional parameter specifying the classes that
@@ -247,6 +240,16 @@ public:
                  const ClientClasses& client_classes = ClientClasses(),
                  const bool is_relay_address = false) const;
 
+    /// @brief Indexes the subnets for the subnet selection.
+    ///
+    /// The index maps the subnet prefixes, relay addresses, interface
+    /// names and interface identifiers to the subnets so the subnet
+    /// selection doesn't scan all subnets. It is built when the
+    /// configuration is committed. Adding, replacing, removing or
+    /// merging subnets discards the index and the subnet selection
+    /// falls back to a full scan until the index is built again.
+    void initSelectionIndex();
+
     /// @brief Updates statistics.
     ///
     /// This method updates statistics that are affected by the newly committed
@@ -264,6 +267,21 @@ public:
     /// configuration and also subnet-ids may change.
     void removeStatistics();
 
+    /// @brief Updates the assigned leases counter of the pool containing
+    /// an address or a prefix.
+    ///
+    /// It is called when an address or a prefix is leased or freed, also
+    /// by the callers which only know the subnet identifier of the lease.
+    /// It does nothing if there is no such subnet or pool.
+    ///
+    /// @param subnet_id identifier of the subnet of the lease.
+    /// @param type type of the lease.
+    /// @param address the leased address or prefix.
+    /// @param delta the change of the number of assigned leases.
+    void updatePoolAssigned(const SubnetID& subnet_id, Lease::Type type,
+                            const asiolink::IOAddress& address,
+                            int64_t delta) const;
+
     /// @brief Unparse a configuration object
     ///
     /// @return a pointer to unparsed configuration
@@ -271,19 +289,26 @@ public:
 
 private:
 
+    /// @brief Counts the assigned leases of each pool.
+    ///
+    /// The counters of the pools are set from the lease database and the
+    /// per pool statistics are set accordingly. Leases in the
+    /// expired-reclaimed state are free, other leases are assigned.
+    void recountPools();
+
+    /// @brief Discards the subnet selection index.
+    ///
+    /// It is called when the subnets are modified.
+    void resetSelectionIndex();
+
     /// @brief Selects a subnet using the interface name.
     ///
     /// This method searches for the subnet using the name of the interface.
     /// If any of the subnets is explicitly associated with the interface
     /// name, the subnet is returned.
     ///
-    /// @todo This method requires performance improvement! It currently
-    /// iterates over all existing subnets to find the one which fulfills
-    /// the search criteria. The subnet storage is implemented as a
-    /// simple STL vector which precludes fast searches using specific
-    /// keys. Hence, full scan is required. To improve the search
-    /// performance a different container type is required, e.g.
-    /// multi-index container, or something of a similar functionality.
+    /// The candidates are looked up in the selection index when it is
+    /// built, otherwise all subnets are scanned.
     ///
     /// @param iface_name Interface name.
     /// @param client_classes Optional parameter specifying the classes that
@@ -301,13 +326,8 @@ private:
     /// of the subnets is explicitly associated with that interface id, the
     /// subnet is returned.
     ///
-    /// @todo This method requires performance improvement! It currently
-    /// iterates over all existing subnets to find the one which fulfills
-    /// the search criteria. The subnet storage is implemented as a
-    /// simple STL vector which precludes fast searches using specific
-    /// keys. Hence, full scan is required. To improve the search
-    /// performance a different container type is required, e.g.
-    /// multi-index container, or something of a similar functionality.
+    /// The candidates are looked up in the selection index when it is
+    /// built, otherwise all subnets are scanned.
     ///
     /// @param interface_id An instance of the Interface ID option received
     /// from the client.
@@ -322,6 +342,12 @@ private:
     /// @brief A container for IPv6 subnets.
     Subnet6Collection subnets_;
 
+    /// @brief Type of the subnet selection index.
+    typedef SubnetSelectionIndex<Subnet6Ptr> SelectionIndex;
+
+    /// @brief Subnet selection index or null when not built.
+    boost::shared_ptr<SelectionIndex> selection_index_;
+
 };
 
 /// @name Pointer to the @c CfgSubnets6 objects.
@@ -67,6 +67,16 @@ CfgMgr::getD2ClientMgr() {
     return (d2_client_mgr_);
 }
 
+void
+CfgMgr::setAllocEngine(const AllocEnginePtr& alloc_engine) {
+    alloc_engine_ = alloc_engine;
+}
+
+AllocEnginePtr
+CfgMgr::getAllocEngine() const {
+    return (alloc_engine_);
+}
+
 void
 CfgMgr::ensureCurrentAllocated() {
     if (!configuration_ || configs_.empty()) {
@@ -114,6 +124,10 @@ CfgMgr::commit() {
 
     // Now we need to set the statistics back.
     configuration_->updateStatistics();
+
+    // Index the subnets for the subnet selection.
+    configuration_->getCfgSubnets4()->initSelectionIndex();
+    configuration_->getCfgSubnets6()->initSelectionIndex();
 }
 
 void
@@ -199,11 +213,18 @@ CfgMgr::mergeIntoCurrentCfg(const uint32_t seq) {
         mergeIntoCfg(getCurrentCfg(), seq);
 
     } catch (...) {
-        // Make sure the statistics is updated even if the merge failed.
+        // Make sure the statistics and the subnet selection indexes are
+        // updated even if the merge failed.
         getCurrentCfg()->updateStatistics();
+        getCurrentCfg()->getCfgSubnets4()->initSelectionIndex();
+        getCurrentCfg()->getCfgSubnets6()->initSelectionIndex();
         throw;
     }
     getCurrentCfg()->updateStatistics();
+
+    // The merge discarded the subnet selection indexes.
+    getCurrentCfg()->getCfgSubnets4()->initSelectionIndex();
+    getCurrentCfg()->getCfgSubnets6()->initSelectionIndex();
 }
 
 void
@@ -220,7 +241,8 @@ CfgMgr::mergeIntoCfg(const SrvConfigPtr& target_config, const uint32_t seq) {
 }
 
 CfgMgr::CfgMgr()
-    : datadir_(DHCP_DATA_DIR, true), d2_client_mgr_(), family_(AF_INET) {
+    : datadir_(DHCP_DATA_DIR, true), d2_client_mgr_(), alloc_engine_(),
+      family_(AF_INET) {
     // DHCP_DATA_DIR must be set set with -DDHCP_DATA_DIR="..." in Makefile.am
     // Note: the definition of DHCP_DATA_DIR needs to include quotation marks
     // See AM_CPPFLAGS definition in Makefile.am
@@ -38,6 +38,12 @@ public:
         isc::Exception(file, line, what) { };
 };
 
+/// @brief Forward declaration to the allocation engine.
+class AllocEngine;
+
+/// @brief A pointer to the allocation engine.
+typedef boost::shared_ptr<AllocEngine> AllocEnginePtr;
+
 /// @brief Configuration Manager
 ///
 /// This singleton class holds the whole configuration for DHCPv4 and DHCPv6
@@ -122,6 +128,20 @@ public:
     /// @return a reference to the DHCP-DDNS manager.
     D2ClientMgr& getD2ClientMgr();
 
+    /// @brief Sets the allocation engine of the server.
+    ///
+    /// The hook libraries adding or deleting leases, e.g. the lease
+    /// commands, use it to keep the free lease queues up to date.
+    ///
+    /// @param alloc_engine the allocation engine, null when the server
+    /// is destroyed.
+    void setAllocEngine(const AllocEnginePtr& alloc_engine);
+
+    /// @brief Returns the allocation engine of the server.
+    ///
+    /// @return the allocation engine, null if there is no server.
+    AllocEnginePtr getAllocEngine() const;
+
     /// @name Methods managing the collection of configurations.
     ///
     /// The following methods manage the process of preparing a configuration
@@ -320,6 +340,9 @@ private:
     /// @brief Manages the DHCP-DDNS client and its configuration.
     D2ClientMgr d2_client_mgr_;
 
+    /// @brief The allocation engine of the server.
+    AllocEnginePtr alloc_engine_;
+
     /// @brief Server configuration
     ///
     /// This is a structure that will hold all configuration.
@@ -136,6 +136,45 @@ FreeLeaseQueue::append(const PrefixRange& range, const asiolink::IOAddress& pref
     cont->insert(prefix);
 }
 
+bool
+FreeLeaseQueue::use(const IOAddress& address) {
+    // If there are no ranges defined, there is nothing to do.
+    if (ranges_.empty()) {
+        return (false);
+    }
+    // Find the range which may include the address like in append.
+    auto lb = ranges_.upper_bound(address);
+    if (lb == ranges_.begin()) {
+        return (false);
+    }
+    --lb;
+    if ((lb->range_end_ < address) || (address < lb->range_start_)) {
+        return (false);
+    }
+    AddressRange range(lb->range_start_, lb->range_end_);
+    return (use(range, address));
+}
+
+bool
+FreeLeaseQueue::use(const IOAddress& prefix, const uint8_t delegated_length) {
+    // If there are no ranges defined, there is nothing to do.
+    if (ranges_.empty()) {
+        return (false);
+    }
+    // Find the range which may include the prefix like in append.
+    auto lb = ranges_.upper_bound(prefix);
+    if (lb == ranges_.begin()) {
+        return (false);
+    }
+    --lb;
+    if ((lb->range_end_ < prefix) || (prefix < lb->range_start_) ||
+        (delegated_length != lb->delegated_length_)) {
+        return (false);
+    }
+    PrefixRange range(lb->range_start_, lb->range_end_, lb->delegated_length_);
+    return (use(range, prefix));
+}
+
 bool
 FreeLeaseQueue::use(const AddressRange& range, const IOAddress& address) {
     checkRangeBoundaries(range, address);
@@ -135,6 +135,17 @@ public:
         return (ranges_.get<1>().erase(range.start_) > 0);
     }
 
+    /// @brief Checks if the queue has a range.
+    ///
+    /// @param range range to be checked.
+    /// @tparam RangeType type of the range, i.e. @c AddressRange or @c PrefixRange.
+    /// @return true if the queue has a range starting at the start of the
+    /// specified range.
+    template<typename RangeType>
+    bool hasRange(const RangeType& range) const {
+        return (ranges_.get<1>().count(range.start_) > 0);
+    }
+
     /// @brief Appends an address to the end of the queue for a range.
     ///
     /// This method is typically called when a lease expires and is reclaimed.
@@ -201,6 +212,29 @@ public:
     /// specified range or if the given range does not exist.
     void append(const uint64_t range_index, const asiolink::IOAddress& ip);
 
+    /// @brief Removes the specified address from the free addresses.
+    ///
+    /// This method is typically called when a lease is allocated for an
+    /// address which was not picked from this queue, e.g. an address
+    /// requested by the client. The range is not specified by the caller.
+    /// The method identifies appropriate address range for that address.
+    ///
+    /// @param address address to remove.
+    /// @return true if the range was found and the address was removed,
+    /// false otherwise.
+    bool use(const asiolink::IOAddress& address);
+
+    /// @brief Removes the specified delegated prefix from the free prefixes.
+    ///
+    /// The range is not specified by the caller. The method identifies
+    /// appropriate prefix range for that prefix.
+    ///
+    /// @param prefix delegated prefix to remove.
+    /// @param delegated_length delegated prefix length.
+    /// @return true if the range was found and the prefix was removed,
+    /// false otherwise.
+    bool use(const asiolink::IOAddress& prefix, const uint8_t delegated_length);
+
     /// @brief Removes the specified address from the free addresses.
     ///
     /// This method should be called upon successful lease allocation for
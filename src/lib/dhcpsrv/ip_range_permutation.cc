@@ -9,23 +9,97 @@
 #include <dhcpsrv/ip_range_permutation.h>
 
 #include <iostream>
+#include <limits>
+#include <vector>
 
 using namespace isc::asiolink;
 
 namespace isc {
 namespace dhcp {
 
+namespace {
+
+/// @brief IPv6 address as a 128 bits number.
+struct Uint128 {
+    /// @brief Constructor.
+    ///
+    /// @param address IPv6 address.
+    Uint128(const IOAddress& address) : high_(0), low_(0) {
+        const std::vector<uint8_t>& bytes = address.toBytes();
+        for (size_t i = 0; i < 8; ++i) {
+            high_ = (high_ << 8) | bytes[i];
+            low_ = (low_ << 8) | bytes[i + 8];
+        }
+    }
+
+    /// @brief The upper 64 bits.
+    uint64_t high_;
+
+    /// @brief The lower 64 bits.
+    uint64_t low_;
+};
+
+/// @brief Returns the number of delegated prefixes between two prefixes.
+///
+/// @param start the first delegated prefix.
+/// @param end the last delegated prefix.
+/// @param delegated_length the delegated prefix length.
+/// @return The number of delegated prefixes, capped at the maximum value
+/// of uint64_t.
+uint64_t
+prefixesBetween(const IOAddress& start, const IOAddress& end,
+                uint8_t delegated_length) {
+    Uint128 first(start);
+    Uint128 last(end);
+    // Difference between the prefixes.
+    uint64_t high = last.high_ - first.high_ - (last.low_ < first.low_ ? 1 : 0);
+    uint64_t low = last.low_ - first.low_;
+    // Divided by the size of the delegated prefixes.
+    unsigned shift = 128 - delegated_length;
+    uint64_t count = 0;
+    if (shift >= 128) {
+        count = 0;
+    } else if (shift >= 64) {
+        count = high >> (shift - 64);
+    } else if ((shift > 0) && ((high >> shift) != 0)) {
+        return (std::numeric_limits<uint64_t>::max());
+    } else if (shift > 0) {
+        count = (high << (64 - shift)) | (low >> shift);
+    } else if (high != 0) {
+        return (std::numeric_limits<uint64_t>::max());
+    } else {
+        count = low;
+    }
+    if (count == std::numeric_limits<uint64_t>::max()) {
+        return (count);
+    }
+    return (count + 1);
+}
+
+}
+
 IPRangePermutation::IPRangePermutation(const AddressRange& range)
-    : range_start_(range.start_), step_(1), cursor_(addrsInRange(range_start_, range.end_) - 1),
+    : range_start_(range.start_), delegated_length_(128),
+      cursor_(addrsInRange(range_start_, range.end_) - 1),
       state_(), done_(false), generator_() {
     std::random_device rd;
     generator_.seed(rd());
 }
 
 IPRangePermutation::IPRangePermutation(const PrefixRange& range)
-    : range_start_(range.start_), step_(static_cast<uint64_t>(1) << (128 - range.delegated_length_)),
-      cursor_(prefixesInRange(range.prefix_length_, range.delegated_length_) - 1),
+    : range_start_(range.start_), delegated_length_(range.delegated_length_),
+      cursor_(prefixesBetween(range.start_, range.end_, range.delegated_length_) - 1),
       state_(), done_(false), generator_() {
+    std::random_device rd;
+    generator_.seed(rd());
+}
+
+IOAddress
+IPRangePermutation::addressAt(uint64_t position) const {
+    if (range_start_.isV4()) {
+        return (offsetAddress(range_start_, position));
+    }
+    return (offsetPrefix(range_start_, position, delegated_length_));
 }
 
 IOAddress
@@ -37,10 +111,15 @@ IPRangePermutation::next(bool& done) {
         return (range_start_.isV4() ? IOAddress::IPV4_ZERO_ADDRESS() : IOAddress::IPV6_ZERO_ADDRESS());
     }
 
-    // If there is one address left, return this address.
+    // If there is one address left, return this address. It is at the
+    // beginning of the range unless it was swapped.
     if (cursor_ == 0) {
         done = done_ = true;
-        return (state_.at(0));
+        auto first = state_.find(0);
+        if (first != state_.end()) {
+            return (first->second);
+        }
+        return (range_start_);
     }
 
     // We're not done.
@@ -50,7 +129,7 @@ IPRangePermutation::next(bool& done) {
     // addresses between the cursor and the end of the range have been already
     // returned by this function. Therefore we focus on the remaining cursor-1
     // addresses. Let's get random address from this sub-range.
-    std::uniform_int_distribution<int> dist(0, cursor_ - 1);
+    std::uniform_int_distribution<uint64_t> dist(0, cursor_ - 1);
     auto next_loc = dist(generator_);
 
     IOAddress next_loc_address = IOAddress::IPV4_ZERO_ADDRESS();
@@ -68,7 +147,7 @@ IPRangePermutation::next(bool& done) {
         // if the range is 192.0.2.1-192.0.2.10 and the picked random position is
         // 5, the address we get is 192.0.2.6. This random address will be later
         // returned to the caller.
-        next_loc_address = offsetAddress(range_start_, next_loc * step_);
+        next_loc_address = addressAt(next_loc);
     }
 
     // Let's get the address at cursor position in the same way.
@@ -77,7 +156,7 @@ IPRangePermutation::next(bool& done) {
     if (cursor_existing != state_.end()) {
         cursor_address = cursor_existing->second;
     } else {
-        cursor_address = offsetAddress(range_start_, cursor_ * step_);
+        cursor_address = addressAt(cursor_);
     }
 
     // Now we swap them.... in fact we don't swap because as an optimization
@@ -61,8 +61,8 @@ namespace dhcp {
 /// beloging to the given  range are returned and no duplicates are returned.
 /// The addresses or delegated prefixes are returned in a random order.
 ///
-/// @todo Methods of this class should be called in thread safe context. Otherwise
-/// they should be made thread safe.
+/// Methods of this class are not thread safe: @c Pool::nextRandom protects
+/// the permutation of a pool by a mutex of the pool.
 class IPRangePermutation {
 public:
 
@@ -101,13 +101,19 @@ public:
 
 private:
 
+    /// @brief Returns the address or delegated prefix at a position of the
+    /// initial, increasing, order of the range.
+    ///
+    /// @param position position in the range.
+    /// @return address or delegated prefix at this position.
+    asiolink::IOAddress addressAt(uint64_t position) const;
+
     /// Beginning of the range.
     asiolink::IOAddress range_start_;
 
-    /// Distance between two neighboring addresses or delegated prefixes,
-    /// i.e. 1 for address range and delegated prefix size for delegated
-    /// prefixes.
-    uint64_t step_;
+    /// Delegated prefix length, i.e. 128 for IPv6 address ranges. It is
+    /// not used for IPv4 address ranges.
+    uint8_t delegated_length_;
 
     /// Keeps the position of the next address or prefix to be swapped with
     /// a randomly picked address or prefix from the range of 0..cursor-1. The
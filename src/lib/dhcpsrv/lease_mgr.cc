@@ -211,6 +211,61 @@ LeaseStatsQuery::getNextRow(LeaseStatsRow& /*row*/) {
     return (false);
 }
 
+Lease4Collection
+LeaseMgr::getClientLeases4(const HWAddrPtr& hwaddr,
+                           const ClientIdPtr& client_id,
+                           const IOAddress& addr) const {
+    Lease4Collection leases;
+    auto add_lease = [&leases](const Lease4Ptr& lease) {
+        for (auto const& l : leases) {
+            if (l->addr_ == lease->addr_) {
+                return;
+            }
+        }
+        leases.push_back(lease);
+    };
+
+    if (client_id) {
+        for (auto const& lease : getLease4(*client_id)) {
+            add_lease(lease);
+        }
+    }
+    if (hwaddr) {
+        for (auto const& lease : getLease4(*hwaddr)) {
+            add_lease(lease);
+        }
+    }
+    if (!addr.isV4Zero()) {
+        Lease4Ptr lease = getLease4(addr);
+        if (lease) {
+            add_lease(lease);
+        }
+    }
+    return (leases);
+}
+
+void
+LeaseMgr::updateLeases4(const Lease4Collection& updated_leases,
+                        const Lease4Collection& deleted_leases) {
+    for (auto const& lease : updated_leases) {
+        updateLease4(lease);
+    }
+    for (auto const& lease : deleted_leases) {
+        static_cast<void>(deleteLease(lease));
+    }
+}
+
+void
+LeaseMgr::updateLeases6(const Lease6Collection& updated_leases,
+                        const Lease6Collection& deleted_leases) {
+    for (auto const& lease : updated_leases) {
+        updateLease6(lease);
+    }
+    for (auto const& lease : deleted_leases) {
+        static_cast<void>(deleteLease(lease));
+    }
+}
+
 void
 LeaseMgr::recountLeaseStats6() {
     using namespace stats;
@@ -337,6 +337,24 @@ public:
     virtual Lease4Ptr getLease4(const ClientId& clientid,
                                 SubnetID subnet_id) const = 0;
 
+    /// @brief Returns the IPv4 leases which may belong to a client.
+    ///
+    /// This returns in one lookup the leases having the given HW address,
+    /// the leases having the given client identifier and the lease for the
+    /// given address, without duplicates. It is used by the allocation
+    /// engine to replace the separate lookups it does for a DHCPv4 client.
+    /// The default implementation issues these lookups one after another,
+    /// the SQL backends run a single query.
+    ///
+    /// @param hwaddr HW address or null pointer.
+    /// @param client_id Client identifier or null pointer.
+    /// @param addr Address of the lease or 0.0.0.0.
+    ///
+    /// @return Lease collection (may be empty if no IPv4 lease found).
+    virtual Lease4Collection getClientLeases4(const HWAddrPtr& hwaddr,
+                                              const ClientIdPtr& client_id,
+                                              const isc::asiolink::IOAddress& addr) const;
+
     /// @brief Returns all IPv4 leases for the particular subnet identifier.
     ///
     /// @param subnet_id subnet identifier.
@@ -563,6 +581,43 @@ public:
     ///        failed.
     virtual bool deleteLease(const Lease6Ptr& lease) = 0;
 
+    /// @brief Updates and deletes a batch of IPv4 leases.
+    ///
+    /// The lease reclamation uses this method to write the reclaimed
+    /// leases back to the lease database in a few round trips. The
+    /// backends supporting transactions apply the whole batch in a single
+    /// transaction: if an operation fails, the transaction is rolled back
+    /// and an exception is thrown. The default implementation calls
+    /// @c updateLease4 and @c deleteLease for each lease and stops at the
+    /// first error, leaving the previous operations applied. In both cases
+    /// the caller may retry the operations one by one: updating a lease
+    /// again with the same data or deleting a lease which no longer exists
+    /// is harmless.
+    ///
+    /// @param updated_leases IPv4 leases to be updated.
+    /// @param deleted_leases IPv4 leases to be deleted. A lease which does
+    /// not exist is silently ignored.
+    ///
+    /// @throw isc::dhcp::NoSuchLease if a lease to be updated does not exist.
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed.
+    virtual void updateLeases4(const Lease4Collection& updated_leases,
+                               const Lease4Collection& deleted_leases);
+
+    /// @brief Updates and deletes a batch of IPv6 leases.
+    ///
+    /// See @c updateLeases4 for details.
+    ///
+    /// @param updated_leases IPv6 leases to be updated.
+    /// @param deleted_leases IPv6 leases to be deleted. A lease which does
+    /// not exist is silently ignored.
+    ///
+    /// @throw isc::dhcp::NoSuchLease if a lease to be updated does not exist.
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed.
+    virtual void updateLeases6(const Lease6Collection& updated_leases,
+                               const Lease6Collection& deleted_leases);
+
     /// @brief Deletes all expired and reclaimed DHCPv4 leases.
     ///
     /// @param secs Number of seconds since expiration of leases before
@@ -13,15 +13,26 @@
 #include <dhcpsrv/memfile_lease_mgr.h>
 #include <dhcpsrv/timer_mgr.h>
 #include <exceptions/exceptions.h>
+#include <stats/stats_mgr.h>
 #include <util/multi_threading_mgr.h>
 #include <util/pid_file.h>
 #include <util/process_spawn.h>
 #include <util/signal_set.h>
+#include <util/thread_pool.h>
+
+#include <boost/functional/hash.hpp>
+#include <boost/make_shared.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
 #include <cstring>
 #include <errno.h>
 #include <iostream>
 #include <limits>
+#include <map>
+#include <mutex>
 #include <sstream>
 
 namespace {
@@ -44,6 +55,190 @@ using namespace isc::util;
 namespace isc {
 namespace dhcp {
 
+namespace {
+
+/// @brief Returns the index of the lease storage shard of an address.
+///
+/// @param addr The lease address.
+///
+/// @return The index of the shard holding the lease with this address.
+size_t
+getShardIndex(const IOAddress& addr) {
+    return (hash_value(addr) % LEASE_STORAGE_SHARD_COUNT);
+}
+
+/// @brief Returns the index of the lease storage shard of a HW address,
+/// client id or DUID.
+///
+/// @param key The HW address, client id or DUID.
+///
+/// @return The index of the shard holding the leases with this key.
+size_t
+getShardIndex(const std::vector<uint8_t>& key) {
+    return (boost::hash_range(key.begin(), key.end()) % LEASE_STORAGE_SHARD_COUNT);
+}
+
+/// @brief Adds a stored lease to the lease storage shard of a key.
+///
+/// @param shards The lease storage shards by this key.
+/// @param key The HW address, client id or DUID of the lease.
+/// @param lease The stored lease.
+template<typename ShardsType, typename LeasePtrType>
+void
+insertLease(ShardsType& shards, const std::vector<uint8_t>& key,
+            const LeasePtrType& lease) {
+    auto& shard = shards[getShardIndex(key)];
+    if (MultiThreadingMgr::instance().getMode()) {
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        shard.storage_.insert(lease);
+    } else {
+        shard.storage_.insert(lease);
+    }
+}
+
+/// @brief Removes a stored lease from a lease storage shard by key.
+///
+/// The lease is found by address: many leases may share a key, e.g. the
+/// leases without client id, so looking through the leases of the key
+/// would not take a constant time.
+///
+/// @param storage The lease storage shard of the key.
+/// @param lease The stored lease.
+template<typename StorageType, typename LeasePtrType>
+void
+eraseStoredLease(StorageType& storage, const LeasePtrType& lease) {
+    auto& idx = storage.template get<AddressHashIndexTag>();
+    auto it = idx.find(lease->addr_);
+    if ((it != idx.end()) && (*it == lease)) {
+        idx.erase(it);
+    }
+}
+
+/// @brief Replaces a stored lease in a lease storage shard by key.
+///
+/// The replaced lease is found by address, as in @c eraseStoredLease.
+///
+/// @param storage The lease storage shard of both keys.
+/// @param old_lease The replaced lease.
+/// @param new_lease The new lease.
+template<typename StorageType, typename LeasePtrType>
+void
+replaceStoredLease(StorageType& storage, const LeasePtrType& old_lease,
+                   const LeasePtrType& new_lease) {
+    auto& idx = storage.template get<AddressHashIndexTag>();
+    auto it = idx.find(old_lease->addr_);
+    if ((it != idx.end()) && (*it == old_lease)) {
+        // Use replace() to re-index the lease.
+        idx.replace(it, new_lease);
+        return;
+    }
+    storage.insert(new_lease);
+}
+
+/// @brief Removes a stored lease from the lease storage shard of a key.
+///
+/// @param shards The lease storage shards by this key.
+/// @param key The HW address, client id or DUID of the lease.
+/// @param lease The stored lease.
+template<typename ShardsType, typename LeasePtrType>
+void
+eraseLease(ShardsType& shards, const std::vector<uint8_t>& key,
+           const LeasePtrType& lease) {
+    auto& shard = shards[getShardIndex(key)];
+    if (MultiThreadingMgr::instance().getMode()) {
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        eraseStoredLease(shard.storage_, lease);
+    } else {
+        eraseStoredLease(shard.storage_, lease);
+    }
+}
+
+/// @brief Replaces a stored lease in the lease storage shards of a key.
+///
+/// When both leases are in the same shard the old lease is replaced in
+/// place. Otherwise the new lease is added before the old lease is
+/// removed, so a concurrent lookup finds either of them.
+///
+/// @param shards The lease storage shards by this key.
+/// @param old_key The key of the replaced lease.
+/// @param old_lease The replaced lease.
+/// @param new_key The key of the new lease.
+/// @param new_lease The new lease.
+template<typename ShardsType, typename LeasePtrType>
+void
+replaceLease(ShardsType& shards,
+             const std::vector<uint8_t>& old_key, const LeasePtrType& old_lease,
+             const std::vector<uint8_t>& new_key, const LeasePtrType& new_lease) {
+    if (getShardIndex(old_key) != getShardIndex(new_key)) {
+        insertLease(shards, new_key, new_lease);
+        eraseLease(shards, old_key, old_lease);
+        return;
+    }
+    auto& shard = shards[getShardIndex(new_key)];
+    if (MultiThreadingMgr::instance().getMode()) {
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        replaceStoredLease(shard.storage_, old_lease, new_lease);
+    } else {
+        replaceStoredLease(shard.storage_, old_lease, new_lease);
+    }
+}
+
+/// @brief Shares the DUID and the HW address of another stored lease.
+///
+/// @param lease The lease to be stored.
+/// @param other Another stored lease, possibly with the same DUID.
+///
+/// @return true if the other lease has the same DUID, which the lease
+/// now shares.
+bool
+shareIdentifiers(Lease6& lease, const Lease6Ptr& other) {
+    if (!other || !other->duid_ || !(*other->duid_ == *lease.duid_)) {
+        return (false);
+    }
+    lease.duid_ = other->duid_;
+    if (lease.hwaddr_ && other->hwaddr_ && (*other->hwaddr_ == *lease.hwaddr_)) {
+        lease.hwaddr_ = other->hwaddr_;
+    }
+    return (true);
+}
+
+/// @brief Orders the leases by address.
+///
+/// The lookups by subnet or hostname merge the leases found in each
+/// address shard: they are returned in the order of the addresses, so
+/// this order doesn't depend on the shards.
+struct AddressLess {
+    /// @brief Compares two leases.
+    ///
+    /// @param first The first lease.
+    /// @param second The second lease.
+    ///
+    /// @return true if the address of the first lease is lower.
+    bool operator()(const LeasePtr& first, const LeasePtr& second) const {
+        return (first->addr_ < second->addr_);
+    }
+};
+
+/// @brief Orders the leases by expiration time, then by address.
+struct ExpirationLess {
+    /// @brief Compares two leases.
+    ///
+    /// @param first The first lease.
+    /// @param second The second lease.
+    ///
+    /// @return true if the first lease expires earlier, or at the same
+    /// time with a lower address.
+    bool operator()(const LeasePtr& first, const LeasePtr& second) const {
+        int64_t first_expire = first->getExpirationTime();
+        int64_t second_expire = second->getExpirationTime();
+        return ((first_expire < second_expire) ||
+                ((first_expire == second_expire) &&
+                 (first->addr_ < second->addr_)));
+    }
+};
+
+}  // namespace
+
 /// @brief Represents a configuration for Lease File Cleanup.
 ///
 /// This class is solely used by the @c Memfile_LeaseMgr as a configuration
@@ -251,6 +446,208 @@ LFCSetup::getExitStatus() const {
     return (process_->getExitStatus(pid_));
 }
 
+/// @brief Appends the lease changes to the lease file in a dedicated thread.
+///
+/// This class is solely used by the @c Memfile_LeaseMgr to take the lease
+/// file appends out of the threads changing the leases. The appends are
+/// queued and executed in order by a single thread. The number of queued
+/// appends is bounded: when the queue is full the thread changing a lease
+/// either waits for the writer thread or gets an error, depending on the
+/// configured policy.
+///
+/// The lease change has already been applied in memory when its append
+/// fails, so the lease file no longer matches the lease database. The
+/// writer then enters a failed state in which all further appends, and
+/// thus all further lease changes, are refused.
+///
+/// The writer maintains the following statistics:
+/// - lease-file-write-queue-depth: the number of queued appends,
+/// - lease-file-write-latency: the duration of the last append,
+/// - lease-file-write-queue-full: the number of times the queue was full,
+/// - lease-file-write-errors: the number of failed appends.
+///
+/// The writer thread only updates its own counters: the statistics manager
+/// is not thread safe when the multi-threading mode is off, so the
+/// counters are published by the threads queuing or waiting for the
+/// appends.
+class LeaseFileWriter {
+public:
+
+    /// @brief Type of the lease file appends.
+    typedef std::function<void()> WriteCallBack;
+
+    /// @brief Constructor.
+    ///
+    /// Starts the writer thread.
+    ///
+    /// @param max_queue_size The maximum number of queued appends.
+    /// @param block Wait for the writer thread when the queue is full if
+    /// true, refuse the append if false.
+    /// @param idle A function called by the writer thread each time the
+    /// queue becomes empty.
+    LeaseFileWriter(size_t max_queue_size, bool block,
+                    const WriteCallBack& idle);
+
+    /// @brief Destructor.
+    ///
+    /// Executes the queued appends and stops the writer thread.
+    ~LeaseFileWriter();
+
+    /// @brief Queues a lease file append.
+    ///
+    /// @param write The lease file append.
+    /// @throw isc::db::DbOperationError if the queue is full and the
+    /// policy is not to wait, or if a previous append failed.
+    void add(const WriteCallBack& write);
+
+    /// @brief Waits for the queued appends to be executed.
+    ///
+    /// The statistics are updated once the appends have been executed.
+    void wait();
+
+private:
+
+    /// @brief Executes a lease file append in the writer thread.
+    ///
+    /// @param write The lease file append.
+    void run(const WriteCallBack& write);
+
+    /// @brief Publishes the counters to the statistics manager.
+    ///
+    /// Must be called with the mutex locked, not by the writer thread.
+    void publishStats();
+
+    /// @brief The writer thread.
+    ThreadPool<WriteCallBack> thread_pool_;
+
+    /// @brief The maximum number of queued appends.
+    size_t max_queue_size_;
+
+    /// @brief Wait for the writer thread when the queue is full.
+    bool block_;
+
+    /// @brief The function called each time the queue becomes empty.
+    WriteCallBack idle_;
+
+    /// @brief Mutex protecting the number of queued appends and the
+    /// counters.
+    std::mutex mutex_;
+
+    /// @brief Condition variable notified when an append has been executed.
+    std::condition_variable cv_;
+
+    /// @brief The number of queued appends.
+    size_t queue_size_;
+
+    /// @brief The reason of the first failed append, empty when no append
+    /// failed.
+    std::string error_;
+
+    /// @brief The duration of the last append.
+    stats::StatsDuration latency_;
+
+    /// @brief The number of times the queue was full.
+    int64_t queue_full_;
+
+    /// @brief The number of failed appends.
+    int64_t errors_;
+};
+
+LeaseFileWriter::LeaseFileWriter(size_t max_queue_size, bool block,
+                                 const WriteCallBack& idle)
+    : max_queue_size_(max_queue_size), block_(block), idle_(idle),
+      queue_size_(0), latency_(stats::StatsDuration::zero()), queue_full_(0),
+      errors_(0) {
+    publishStats();
+    thread_pool_.start(1);
+}
+
+LeaseFileWriter::~LeaseFileWriter() {
+    thread_pool_.wait();
+    thread_pool_.reset();
+    stats::StatsMgr& stats_mgr = stats::StatsMgr::instance();
+    stats_mgr.del("lease-file-write-queue-depth");
+    stats_mgr.del("lease-file-write-latency");
+    stats_mgr.del("lease-file-write-queue-full");
+    stats_mgr.del("lease-file-write-errors");
+}
+
+void
+LeaseFileWriter::add(const WriteCallBack& write) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (error_.empty() && (queue_size_ >= max_queue_size_)) {
+        ++queue_full_;
+        if (!block_) {
+            publishStats();
+            isc_throw(DbOperationError, "the lease file write queue is full ("
+                      << max_queue_size_ << " lease changes)");
+        }
+        cv_.wait(lock, [this]() {
+            return ((queue_size_ < max_queue_size_) || !error_.empty());
+        });
+    }
+    if (!error_.empty()) {
+        publishStats();
+        isc_throw(DbOperationError, "the lease file is out of date after a"
+                  " failed append: " << error_);
+    }
+    ++queue_size_;
+    publishStats();
+    // Queue under the lock so the appends are executed in the order of
+    // the queue size accounting.
+    thread_pool_.add(boost::make_shared<WriteCallBack>(
+        std::bind(&LeaseFileWriter::run, this, write)));
+}
+
+void
+LeaseFileWriter::wait() {
+    thread_pool_.wait();
+    std::lock_guard<std::mutex> lock(mutex_);
+    publishStats();
+}
+
+void
+LeaseFileWriter::run(const WriteCallBack& write) {
+    auto start = std::chrono::steady_clock::now();
+    std::string error;
+    try {
+        write();
+    } catch (const std::exception& ex) {
+        // The lease change has already been applied in memory.
+        LOG_ERROR(dhcpsrv_logger, DHCPSRV_MEMFILE_WRITE_FAIL).arg(ex.what());
+        error = ex.what();
+    }
+    auto latency = std::chrono::steady_clock::now() - start;
+
+    bool idle = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!error.empty()) {
+            ++errors_;
+            if (error_.empty()) {
+                error_ = error;
+            }
+        }
+        latency_ = std::chrono::duration_cast<stats::StatsDuration>(latency);
+        idle = (--queue_size_ == 0);
+    }
+    cv_.notify_all();
+
+    if (idle && idle_) {
+        idle_();
+    }
+}
+
+void
+LeaseFileWriter::publishStats() {
+    stats::StatsMgr& stats_mgr = stats::StatsMgr::instance();
+    stats_mgr.setValue("lease-file-write-queue-depth",
+                       static_cast<int64_t>(queue_size_));
+    stats_mgr.setValue("lease-file-write-latency", latency_);
+    stats_mgr.setValue("lease-file-write-queue-full", queue_full_);
+    stats_mgr.setValue("lease-file-write-errors", errors_);
+}
+
 
 /// @brief Base Memfile derivation of the statistical lease data query
 ///
@@ -319,7 +716,7 @@ protected:
 /// @brief Memfile derivation of the IPv4 statistical lease data query
 ///
 /// This class is used to recalculate IPv4 lease statistics for Memfile
-/// lease storage.  It does so by iterating over the given storage,
+/// lease storage.  It does so by iterating over the given storage shards,
 /// accumulating counts of leases in each of the monitored lease states
 /// for each subnet and storing these counts in an internal collection.
 /// The populated result set will contain one entry per monitored state
@@ -329,27 +726,30 @@ class MemfileLeaseStatsQuery4 : public MemfileLeaseStatsQuery {
 public:
     /// @brief Constructor for an all subnets query
     ///
-    /// @param storage4 A pointer to the v4 lease storage to be counted
-    MemfileLeaseStatsQuery4(Lease4Storage& storage4)
-        : MemfileLeaseStatsQuery(), storage4_(storage4) {
+    /// @param shards4 The v4 lease storage shards to be counted
+    MemfileLeaseStatsQuery4(const Lease4StorageShards& shards4)
+        : MemfileLeaseStatsQuery(), shards4_(shards4) {
     };
 
     /// @brief Constructor for a single subnet query
     ///
-    /// @param storage4 A pointer to the v4 lease storage to be counted
+    /// @param shards4 The v4 lease storage shards to be counted
     /// @param subnet_id ID of the desired subnet
-    MemfileLeaseStatsQuery4(Lease4Storage& storage4, const SubnetID& subnet_id)
-        : MemfileLeaseStatsQuery(subnet_id), storage4_(storage4) {
+    MemfileLeaseStatsQuery4(const Lease4StorageShards& shards4,
+                            const SubnetID& subnet_id)
+        : MemfileLeaseStatsQuery(subnet_id), shards4_(shards4) {
     };
 
     /// @brief Constructor for a subnet range query
     ///
-    /// @param storage4 A pointer to the v4 lease storage to be counted
+    /// @param shards4 The v4 lease storage shards to be counted
     /// @param first_subnet_id ID of the first subnet in the desired range
     /// @param last_subnet_id ID of the last subnet in the desired range
-    MemfileLeaseStatsQuery4(Lease4Storage& storage4, const SubnetID& first_subnet_id,
+    MemfileLeaseStatsQuery4(const Lease4StorageShards& shards4,
+                            const SubnetID& first_subnet_id,
                             const SubnetID& last_subnet_id)
-        : MemfileLeaseStatsQuery(first_subnet_id, last_subnet_id), storage4_(storage4) {
+        : MemfileLeaseStatsQuery(first_subnet_id, last_subnet_id),
+          shards4_(shards4) {
     };
 
     /// @brief Destructor
@@ -357,21 +757,56 @@ public:
 
     /// @brief Creates the IPv4 lease statistical data result set
     ///
-    /// The result set is populated by iterating over the IPv4 leases in
-    /// storage, in ascending order by address, accumulating the lease state
-    /// counts per subnet.
-    /// At the completion of all entries for a given subnet, the counts are
-    /// used to create LeaseStatsRow instances which are appended to an
-    /// internal vector.  The process results in a vector containing one entry
-    /// per state per subnet.
+    /// The result set is populated by iterating over the IPv4 leases of
+    /// each storage shard, in ascending order by subnet id, accumulating
+    /// the lease state counts per subnet. The counts are then used to
+    /// create LeaseStatsRow instances which are appended to an internal
+    /// vector in ascending order by subnet id.  The process results in a
+    /// vector containing one entry per state per subnet.
     ///
     /// Currently the states counted are:
     ///
     /// - Lease::STATE_DEFAULT (i.e. assigned)
     /// - Lease::STATE_DECLINED
     void start() {
+        // Assigned and declined leases per subnet.
+        std::map<SubnetID, std::pair<int64_t, int64_t> > counts;
+        for (auto const& shard : shards4_) {
+            if (MultiThreadingMgr::instance().getMode()) {
+                std::lock_guard<std::mutex> lock(shard.mutex_);
+                count(shard.storage_, counts);
+            } else {
+                count(shard.storage_, counts);
+            }
+        }
+
+        for (auto const& subnet : counts) {
+            if (subnet.second.first > 0) {
+                rows_.push_back(LeaseStatsRow(subnet.first,
+                                              Lease::STATE_DEFAULT,
+                                              subnet.second.first));
+            }
+
+            if (subnet.second.second > 0) {
+                rows_.push_back(LeaseStatsRow(subnet.first,
+                                              Lease::STATE_DECLINED,
+                                              subnet.second.second));
+            }
+        }
+
+        // Reset the next row position back to the beginning of the rows.
+        next_pos_ = rows_.begin();
+    }
+
+private:
+    /// @brief Counts the leases of a storage shard in the selected subnets
+    ///
+    /// @param storage4 The v4 lease storage shard
+    /// @param counts The assigned and declined lease counts per subnet
+    void count(const Lease4Storage& storage4,
+               std::map<SubnetID, std::pair<int64_t, int64_t> >& counts) const {
         const Lease4StorageSubnetIdIndex& idx
-            = storage4_.get<SubnetIdIndexTag>();
+            = storage4.get<SubnetIdIndexTag>();
 
         // Set lower and upper bounds based on select mode
         Lease4StorageSubnetIdIndex::const_iterator lower;
@@ -393,75 +828,26 @@ public:
             break;
         }
 
-        // Return an empty set if there are no rows.
-        if (lower == upper) {
-            return;
-        }
-
-        // Iterate over the leases in order by subnet, accumulating per
-        // subnet counts for each state of interest.  As we finish each
-        // subnet, add the appropriate rows to our result set.
-        SubnetID cur_id = 0;
-        int64_t assigned = 0;
-        int64_t declined = 0;
         for (Lease4StorageSubnetIdIndex::const_iterator lease = lower;
              lease != upper; ++lease) {
-            // If we've hit the next subnet, add rows for the current subnet
-            // and wipe the accumulators
-            if ((*lease)->subnet_id_ != cur_id) {
-                if (cur_id > 0) {
-                    if (assigned > 0) {
-                        rows_.push_back(LeaseStatsRow(cur_id,
-                                                      Lease::STATE_DEFAULT,
-                                                      assigned));
-                        assigned = 0;
-                    }
-
-                    if (declined > 0) {
-                        rows_.push_back(LeaseStatsRow(cur_id,
-                                                      Lease::STATE_DECLINED,
-                                                      declined));
-                        declined = 0;
-                    }
-                }
-
-                // Update current subnet id
-                cur_id = (*lease)->subnet_id_;
-            }
-
             // Bump the appropriate accumulator
             if ((*lease)->state_ == Lease::STATE_DEFAULT) {
-                ++assigned;
+                ++counts[(*lease)->subnet_id_].first;
             } else if ((*lease)->state_ == Lease::STATE_DECLINED) {
-                ++declined;
+                ++counts[(*lease)->subnet_id_].second;
             }
         }
-
-        // Make the rows for last subnet
-        if (assigned > 0) {
-            rows_.push_back(LeaseStatsRow(cur_id, Lease::STATE_DEFAULT,
-                                          assigned));
-        }
-
-        if (declined > 0) {
-            rows_.push_back(LeaseStatsRow(cur_id, Lease::STATE_DECLINED,
-                                          declined));
-        }
-
-        // Reset the next row position back to the beginning of the rows.
-        next_pos_ = rows_.begin();
     }
 
-private:
-    /// @brief The Memfile storage containing the IPv4 leases to analyze
-    Lease4Storage& storage4_;
+    /// @brief The Memfile storage shards containing the IPv4 leases to analyze
+    const Lease4StorageShards& shards4_;
 };
 
 
 /// @brief Memfile derivation of the IPv6 statistical lease data query
 ///
 /// This class is used to recalculate IPv6 lease statistics for Memfile
-/// lease storage.  It does so by iterating over the given storage,
+/// lease storage.  It does so by iterating over the given storage shards,
 /// accumulating counts of leases in each of the monitored lease states
 /// for each subnet and storing these counts in an internal collection.
 /// The populated result set will contain one entry per monitored state
@@ -471,27 +857,30 @@ class MemfileLeaseStatsQuery6 : public MemfileLeaseStatsQuery {
 public:
     /// @brief Constructor
     ///
-    /// @param storage6 A pointer to the v6 lease storage to be counted
-    MemfileLeaseStatsQuery6(Lease6Storage& storage6)
-        : MemfileLeaseStatsQuery(), storage6_(storage6) {
+    /// @param shards6 The v6 lease storage shards to be counted
+    MemfileLeaseStatsQuery6(const Lease6StorageShards& shards6)
+        : MemfileLeaseStatsQuery(), shards6_(shards6) {
     };
 
     /// @brief Constructor for a single subnet query
     ///
-    /// @param storage6 A pointer to the v6 lease storage to be counted
+    /// @param shards6 The v6 lease storage shards to be counted
     /// @param subnet_id ID of the desired subnet
-    MemfileLeaseStatsQuery6(Lease6Storage& storage6, const SubnetID& subnet_id)
-        : MemfileLeaseStatsQuery(subnet_id), storage6_(storage6) {
+    MemfileLeaseStatsQuery6(const Lease6StorageShards& shards6,
+                            const SubnetID& subnet_id)
+        : MemfileLeaseStatsQuery(subnet_id), shards6_(shards6) {
     };
 
     /// @brief Constructor for a subnet range query
     ///
-    /// @param storage6 A pointer to the v6 lease storage to be counted
+    /// @param shards6 The v6 lease storage shards to be counted
     /// @param first_subnet_id ID of the first subnet in the desired range
     /// @param last_subnet_id ID of the last subnet in the desired range
-    MemfileLeaseStatsQuery6(Lease6Storage& storage6, const SubnetID& first_subnet_id,
+    MemfileLeaseStatsQuery6(const Lease6StorageShards& shards6,
+                            const SubnetID& first_subnet_id,
                             const SubnetID& last_subnet_id)
-        : MemfileLeaseStatsQuery(first_subnet_id, last_subnet_id), storage6_(storage6) {
+        : MemfileLeaseStatsQuery(first_subnet_id, last_subnet_id),
+          shards6_(shards6) {
     };
 
     /// @brief Destructor
@@ -499,21 +888,80 @@ public:
 
     /// @brief Creates the IPv6 lease statistical data result set
     ///
-    /// The result set is populated by iterating over the IPv6 leases in
-    /// storage, in ascending order by subnet id, accumulating the lease state
-    /// counts per subnet. At the completion of all entries for a given subnet,
-    /// the counts are used to create LeaseStatsRow instances which are appended
-    /// to an internal vector.  The process results in a vector containing one
-    /// entry per state per lease type per subnet.
+    /// The result set is populated by iterating over the IPv6 leases of
+    /// each storage shard, in ascending order by subnet id, accumulating
+    /// the lease state counts per subnet. The counts are then used to
+    /// create LeaseStatsRow instances which are appended to an internal
+    /// vector in ascending order by subnet id.  The process results in a
+    /// vector containing one entry per state per lease type per subnet.
     ///
     /// Currently the states counted are:
     ///
     /// - Lease::STATE_DEFAULT (i.e. assigned)
     /// - Lease::STATE_DECLINED
     virtual void start() {
+        // Assigned addresses, declined addresses and assigned prefixes
+        // per subnet.
+        std::map<SubnetID, Counts> counts;
+        for (auto const& shard : shards6_) {
+            if (MultiThreadingMgr::instance().getMode()) {
+                std::lock_guard<std::mutex> lock(shard.mutex_);
+                count(shard.storage_, counts);
+            } else {
+                count(shard.storage_, counts);
+            }
+        }
+
+        for (auto const& subnet : counts) {
+            if (subnet.second.assigned_ > 0) {
+                rows_.push_back(LeaseStatsRow(subnet.first, Lease::TYPE_NA,
+                                              Lease::STATE_DEFAULT,
+                                              subnet.second.assigned_));
+            }
+
+            if (subnet.second.declined_ > 0) {
+                rows_.push_back(LeaseStatsRow(subnet.first, Lease::TYPE_NA,
+                                              Lease::STATE_DECLINED,
+                                              subnet.second.declined_));
+            }
+
+            if (subnet.second.assigned_pds_ > 0) {
+                rows_.push_back(LeaseStatsRow(subnet.first, Lease::TYPE_PD,
+                                              Lease::STATE_DEFAULT,
+                                              subnet.second.assigned_pds_));
+            }
+        }
+
+        // Set the next row position to the beginning of the rows.
+        next_pos_ = rows_.begin();
+    }
+
+private:
+    /// @brief The lease counts of a subnet
+    struct Counts {
+        /// @brief Constructor
+        Counts() : assigned_(0), declined_(0), assigned_pds_(0) {
+        }
+
+        /// @brief The number of assigned addresses
+        int64_t assigned_;
+
+        /// @brief The number of declined addresses
+        int64_t declined_;
+
+        /// @brief The number of assigned prefixes
+        int64_t assigned_pds_;
+    };
+
+    /// @brief Counts the leases of a storage shard in the selected subnets
+    ///
+    /// @param storage6 The v6 lease storage shard
+    /// @param counts The lease counts per subnet
+    void count(const Lease6Storage& storage6,
+               std::map<SubnetID, Counts>& counts) const {
         // Get the subnet_id index
         const Lease6StorageSubnetIdIndex& idx
-            = storage6_.get<SubnetIdIndexTag>();
+            = storage6.get<SubnetIdIndexTag>();
 
         // Set lower and upper bounds based on select mode
         Lease6StorageSubnetIdIndex::const_iterator lower;
@@ -535,58 +983,16 @@ public:
             break;
         }
 
-        // Return an empty set if there are no rows.
-        if (lower == upper) {
-            return;
-        }
-
-        // Iterate over the leases in order by subnet, accumulating per
-        // subnet counts for each state of interest.  As we finish each
-        // subnet, add the appropriate rows to our result set.
-        SubnetID cur_id = 0;
-        int64_t assigned = 0;
-        int64_t declined = 0;
-        int64_t assigned_pds = 0;
         for (Lease6StorageSubnetIdIndex::const_iterator lease = lower;
              lease != upper; ++lease) {
-            // If we've hit the next subnet, add rows for the current subnet
-            // and wipe the accumulators
-            if ((*lease)->subnet_id_ != cur_id) {
-                if (cur_id > 0) {
-                    if (assigned > 0) {
-                        rows_.push_back(LeaseStatsRow(cur_id, Lease::TYPE_NA,
-                                                      Lease::STATE_DEFAULT,
-                                                      assigned));
-                        assigned = 0;
-                    }
-
-                    if (declined > 0) {
-                        rows_.push_back(LeaseStatsRow(cur_id, Lease::TYPE_NA,
-                                                      Lease::STATE_DECLINED,
-                                                      declined));
-                        declined = 0;
-                    }
-
-                    if (assigned_pds > 0) {
-                        rows_.push_back(LeaseStatsRow(cur_id, Lease::TYPE_PD,
-                                                      Lease::STATE_DEFAULT,
-                                                      assigned_pds));
-                        assigned_pds = 0;
-                    }
-                }
-
-                // Update current subnet id
-                cur_id = (*lease)->subnet_id_;
-            }
-
             // Bump the appropriate accumulator
             if ((*lease)->state_ == Lease::STATE_DEFAULT) {
                 switch((*lease)->type_) {
                 case Lease::TYPE_NA:
-                    ++assigned;
+                    ++counts[(*lease)->subnet_id_].assigned_;
                     break;
                 case Lease::TYPE_PD:
-                    ++assigned_pds;
+                    ++counts[(*lease)->subnet_id_].assigned_pds_;
                     break;
                 default:
                     break;
@@ -594,34 +1000,14 @@ public:
             } else if ((*lease)->state_ == Lease::STATE_DECLINED) {
                 // In theory only NAs can be declined
                 if (((*lease)->type_) == Lease::TYPE_NA) {
-                    ++declined;
+                    ++counts[(*lease)->subnet_id_].declined_;
                 }
             }
         }
-
-        // Make the rows for last subnet, unless there were no rows
-        if (assigned > 0) {
-            rows_.push_back(LeaseStatsRow(cur_id, Lease::TYPE_NA,
-                                          Lease::STATE_DEFAULT, assigned));
-        }
-
-        if (declined > 0) {
-            rows_.push_back(LeaseStatsRow(cur_id, Lease::TYPE_NA,
-                                          Lease::STATE_DECLINED, declined));
-        }
-
-        if (assigned_pds > 0) {
-            rows_.push_back(LeaseStatsRow(cur_id, Lease::TYPE_PD,
-                                          Lease::STATE_DEFAULT, assigned_pds));
-        }
-
-        // Set the next row position to the beginning of the rows.
-        next_pos_ = rows_.begin();
     }
 
-private:
-    /// @brief The Memfile storage containing the IPv6 leases to analyze
-    Lease6Storage& storage6_;
+    /// @brief The Memfile storage shards containing the IPv6 leases to analyze
+    const Lease6StorageShards& shards6_;
 };
 
 // Explicit definition of class static constants.  Values are given in the
@@ -630,7 +1016,7 @@ const int Memfile_LeaseMgr::MAJOR_VERSION;
 const int Memfile_LeaseMgr::MINOR_VERSION;
 
 Memfile_LeaseMgr::Memfile_LeaseMgr(const DatabaseConnection::ParameterMap& parameters)
-    : LeaseMgr(), lfc_setup_(), conn_(parameters), mutex_() {
+    : LeaseMgr(), lfc_setup_(), conn_(parameters) {
     bool conversion_needed = false;
 
     // Check the universe and use v4 file or v6 file.
@@ -638,18 +1024,22 @@ Memfile_LeaseMgr::Memfile_LeaseMgr(const DatabaseConnection::ParameterMap& param
     if (universe == "4") {
         std::string file4 = initLeaseFilePath(V4);
         if (!file4.empty()) {
+            Lease4Storage storage;
             conversion_needed = loadLeasesFromFiles<Lease4,
                                                  CSVLeaseFile4>(file4,
                                                                 lease_file4_,
-                                                                storage4_);
+                                                                storage);
+            shardLeases(storage);
         }
     } else {
         std::string file6 = initLeaseFilePath(V6);
         if (!file6.empty()) {
+            Lease6Storage storage;
             conversion_needed = loadLeasesFromFiles<Lease6,
                                                  CSVLeaseFile6>(file6,
                                                                 lease_file6_,
-                                                                storage6_);
+                                                                storage);
+            shardLeases(storage);
         }
     }
 
@@ -665,12 +1055,26 @@ Memfile_LeaseMgr::Memfile_LeaseMgr(const DatabaseConnection::ParameterMap& param
                     .arg(MAJOR_VERSION).arg(MINOR_VERSION);
         }
         lfcSetup(conversion_needed);
+        writerSetup();
+        flushSetup();
     }
-
-    mutex_.reset(new std::mutex);
 }
 
 Memfile_LeaseMgr::~Memfile_LeaseMgr() {
+    if (flush_timer_mgr_) {
+        try {
+            flush_timer_mgr_->unregisterTimer("memfile-flush");
+
+        } catch (const std::exception& ex) {
+            // The timer may have been removed by another component during
+            // the shutdown.
+            LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE,
+                      DHCPSRV_MEMFILE_FLUSH_UNREGISTER_TIMER_FAILED)
+                .arg(ex.what());
+        }
+    }
+    // Append the queued lease changes before closing the lease file.
+    writer_.reset();
     if (lease_file4_) {
         lease_file4_->close();
         lease_file4_.reset();
@@ -689,9 +1093,92 @@ Memfile_LeaseMgr::getDBVersion() {
     return (tmp.str());
 }
 
+void
+Memfile_LeaseMgr::indexLease(const Lease4Ptr& lease) {
+    insertLease(hwaddr_shards4_, lease->getHWAddrVector(), lease);
+    insertLease(client_id_shards4_, lease->getClientIdVector(), lease);
+}
+
+void
+Memfile_LeaseMgr::indexLease(const Lease6Ptr& lease) {
+    insertLease(duid_shards6_, lease->getDuidVector(), lease);
+}
+
+void
+Memfile_LeaseMgr::reindexLease(const Lease4Ptr& old_lease,
+                               const Lease4Ptr& new_lease) {
+    replaceLease(hwaddr_shards4_, old_lease->getHWAddrVector(), old_lease,
+                 new_lease->getHWAddrVector(), new_lease);
+    replaceLease(client_id_shards4_, old_lease->getClientIdVector(), old_lease,
+                 new_lease->getClientIdVector(), new_lease);
+}
+
+void
+Memfile_LeaseMgr::reindexLease(const Lease6Ptr& old_lease,
+                               const Lease6Ptr& new_lease) {
+    replaceLease(duid_shards6_, old_lease->getDuidVector(), old_lease,
+                 new_lease->getDuidVector(), new_lease);
+}
+
+void
+Memfile_LeaseMgr::unindexLease(const Lease4Ptr& lease) {
+    eraseLease(hwaddr_shards4_, lease->getHWAddrVector(), lease);
+    eraseLease(client_id_shards4_, lease->getClientIdVector(), lease);
+}
+
+void
+Memfile_LeaseMgr::unindexLease(const Lease6Ptr& lease) {
+    eraseLease(duid_shards6_, lease->getDuidVector(), lease);
+}
+
+void
+Memfile_LeaseMgr::internIdentifiers(Lease6& lease, const Lease6Ptr& old_lease) {
+    if (!lease.duid_ || shareIdentifiers(lease, old_lease)) {
+        return;
+    }
+    Lease6Ptr other;
+    const LeaseStorageShard<Lease6DuidStorage>& shard =
+        duid_shards6_[getShardIndex(lease.getDuidVector())];
+    if (MultiThreadingMgr::instance().getMode()) {
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        const Lease6StorageDuidIndex& idx = shard.storage_.get<DuidIndexTag>();
+        Lease6StorageDuidIndex::const_iterator it = idx.find(lease.getDuidVector());
+        if (it != idx.end()) {
+            other = *it;
+        }
+    } else {
+        const Lease6StorageDuidIndex& idx = shard.storage_.get<DuidIndexTag>();
+        Lease6StorageDuidIndex::const_iterator it = idx.find(lease.getDuidVector());
+        if (it != idx.end()) {
+            other = *it;
+        }
+    }
+    shareIdentifiers(lease, other);
+}
+
+void
+Memfile_LeaseMgr::shardLeases(Lease4Storage& storage) {
+    for (auto const& lease : storage) {
+        shards4_[getShardIndex(lease->addr_)].storage_.insert(lease);
+        indexLease(lease);
+    }
+    storage.clear();
+}
+
+void
+Memfile_LeaseMgr::shardLeases(Lease6Storage& storage) {
+    for (auto const& lease : storage) {
+        internIdentifiers(*lease, Lease6Ptr());
+        shards6_[getShardIndex(lease->addr_)].storage_.insert(lease);
+        indexLease(lease);
+    }
+    storage.clear();
+}
+
 bool
-Memfile_LeaseMgr::addLeaseInternal(const Lease4Ptr& lease) {
-    if (getLease4Internal(lease->addr_)) {
+Memfile_LeaseMgr::addLeaseInternal(Lease4Storage& storage,
+                                   const Lease4Ptr& lease) {
+    if (getLease4Internal(storage, lease->addr_)) {
         // there is a lease with specified address already
         return (false);
     }
@@ -700,15 +1187,18 @@ Memfile_LeaseMgr::addLeaseInternal(const Lease4Ptr& lease) {
     // not be inserted to the memory and the disk and in-memory data will
     // remain consistent.
     if (persistLeases(V4)) {
-        lease_file4_->append(*lease);
+        writeLease(lease_file4_, *lease);
     }
 
-    storage4_.insert(lease);
-
     // Update lease current expiration time (allows update between the creation
     // of the Lease up to the point of insertion in the database).
     lease->updateCurrentExpirationTime();
 
+    // Store a copy so the caller can't modify the stored lease.
+    Lease4Ptr stored(new Lease4(*lease));
+    storage.insert(stored);
+    indexLease(stored);
+
     return (true);
 }
 
@@ -717,17 +1207,19 @@ Memfile_LeaseMgr::addLease(const Lease4Ptr& lease) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_ADD_ADDR4).arg(lease->addr_.toText());
 
+    Lease4StorageShard& shard = shards4_[getShardIndex(lease->addr_)];
     if (MultiThreadingMgr::instance().getMode()) {
-        std::lock_guard<std::mutex> lock(*mutex_);
-        return (addLeaseInternal(lease));
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        return (addLeaseInternal(shard.storage_, lease));
     } else {
-        return (addLeaseInternal(lease));
+        return (addLeaseInternal(shard.storage_, lease));
     }
 }
 
 bool
-Memfile_LeaseMgr::addLeaseInternal(const Lease6Ptr& lease) {
-    if (getLease6Internal(lease->type_, lease->addr_)) {
+Memfile_LeaseMgr::addLeaseInternal(Lease6Storage& storage,
+                                   const Lease6Ptr& lease) {
+    if (getLease6Internal(storage, lease->type_, lease->addr_)) {
         // there is a lease with specified address already
         return (false);
     }
@@ -736,15 +1228,19 @@ Memfile_LeaseMgr::addLeaseInternal(const Lease6Ptr& lease) {
     // not be inserted to the memory and the disk and in-memory data will
     // remain consistent.
     if (persistLeases(V6)) {
-        lease_file6_->append(*lease);
+        writeLease(lease_file6_, *lease);
     }
 
-    storage6_.insert(lease);
-
     // Update lease current expiration time (allows update between the creation
     // of the Lease up to the point of insertion in the database).
     lease->updateCurrentExpirationTime();
 
+    // Store a copy so the caller can't modify the stored lease.
+    Lease6Ptr stored(new Lease6(*lease));
+    internIdentifiers(*stored, Lease6Ptr());
+    storage.insert(stored);
+    indexLease(stored);
+
     return (true);
 }
 
@@ -753,18 +1249,20 @@ Memfile_LeaseMgr::addLease(const Lease6Ptr& lease) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_ADD_ADDR6).arg(lease->addr_.toText());
 
+    Lease6StorageShard& shard = shards6_[getShardIndex(lease->addr_)];
     if (MultiThreadingMgr::instance().getMode()) {
-        std::lock_guard<std::mutex> lock(*mutex_);
-        return (addLeaseInternal(lease));
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        return (addLeaseInternal(shard.storage_, lease));
     } else {
-        return (addLeaseInternal(lease));
+        return (addLeaseInternal(shard.storage_, lease));
     }
 }
 
 Lease4Ptr
-Memfile_LeaseMgr::getLease4Internal(const isc::asiolink::IOAddress& addr) const {
-    const Lease4StorageAddressIndex& idx = storage4_.get<AddressIndexTag>();
-    Lease4StorageAddressIndex::iterator l = idx.find(addr);
+Memfile_LeaseMgr::getLease4Internal(const Lease4Storage& storage,
+                                    const isc::asiolink::IOAddress& addr) const {
+    const Lease4StorageAddressHashIndex& idx = storage.get<AddressHashIndexTag>();
+    Lease4StorageAddressHashIndex::iterator l = idx.find(addr);
     if (l == idx.end()) {
         return (Lease4Ptr());
     } else {
@@ -777,24 +1275,23 @@ Memfile_LeaseMgr::getLease4(const isc::asiolink::IOAddress& addr) const {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_GET_ADDR4).arg(addr.toText());
 
+    const Lease4StorageShard& shard = shards4_[getShardIndex(addr)];
     if (MultiThreadingMgr::instance().getMode()) {
-        std::lock_guard<std::mutex> lock(*mutex_);
-        return (getLease4Internal(addr));
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        return (getLease4Internal(shard.storage_, addr));
     } else {
-        return (getLease4Internal(addr));
+        return (getLease4Internal(shard.storage_, addr));
     }
 }
 
 void
-Memfile_LeaseMgr::getLease4Internal(const HWAddr& hwaddr,
+Memfile_LeaseMgr::getLease4Internal(const Lease4HWAddressStorage& storage,
+                                    const HWAddr& hwaddr,
                                     Lease4Collection& collection) const {
-    // Using composite index by 'hw address' and 'subnet id'. It is
-    // ok to use it for searching by the 'hw address' only.
-    const Lease4StorageHWAddressSubnetIdIndex& idx =
-        storage4_.get<HWAddressSubnetIdIndexTag>();
-    std::pair<Lease4StorageHWAddressSubnetIdIndex::const_iterator,
-              Lease4StorageHWAddressSubnetIdIndex::const_iterator> l
-        = idx.equal_range(boost::make_tuple(hwaddr.hwaddr_));
+    const Lease4StorageHWAddressIndex& idx = storage.get<HWAddressIndexTag>();
+    std::pair<Lease4StorageHWAddressIndex::const_iterator,
+              Lease4StorageHWAddressIndex::const_iterator> l
+        = idx.equal_range(hwaddr.hwaddr_);
 
     for (auto lease = l.first; lease != l.second; ++lease) {
         collection.push_back(Lease4Ptr(new Lease4(**lease)));
@@ -807,22 +1304,24 @@ Memfile_LeaseMgr::getLease4(const HWAddr& hwaddr) const {
               DHCPSRV_MEMFILE_GET_HWADDR).arg(hwaddr.toText());
 
     Lease4Collection collection;
+    auto const& shard = hwaddr_shards4_[getShardIndex(hwaddr.hwaddr_)];
     if (MultiThreadingMgr::instance().getMode()) {
-        std::lock_guard<std::mutex> lock(*mutex_);
-        getLease4Internal(hwaddr, collection);
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        getLease4Internal(shard.storage_, hwaddr, collection);
     } else {
-        getLease4Internal(hwaddr, collection);
+        getLease4Internal(shard.storage_, hwaddr, collection);
     }
 
     return (collection);
 }
 
 Lease4Ptr
-Memfile_LeaseMgr::getLease4Internal(const HWAddr& hwaddr,
+Memfile_LeaseMgr::getLease4Internal(const Lease4HWAddressStorage& storage,
+                                    const HWAddr& hwaddr,
                                     SubnetID subnet_id) const {
     // Get the index by HW Address and Subnet Identifier.
     const Lease4StorageHWAddressSubnetIdIndex& idx =
-        storage4_.get<HWAddressSubnetIdIndexTag>();
+        storage.get<HWAddressSubnetIdIndexTag>();
     // Try to find the lease using HWAddr and subnet id.
     Lease4StorageHWAddressSubnetIdIndex::const_iterator lease =
         idx.find(boost::make_tuple(hwaddr.hwaddr_, subnet_id));
@@ -842,24 +1341,23 @@ Memfile_LeaseMgr::getLease4(const HWAddr& hwaddr,
               DHCPSRV_MEMFILE_GET_SUBID_HWADDR).arg(subnet_id)
         .arg(hwaddr.toText());
 
+    auto const& shard = hwaddr_shards4_[getShardIndex(hwaddr.hwaddr_)];
     if (MultiThreadingMgr::instance().getMode()) {
-        std::lock_guard<std::mutex> lock(*mutex_);
-        return (getLease4Internal(hwaddr, subnet_id));
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        return (getLease4Internal(shard.storage_, hwaddr, subnet_id));
     } else {
-        return (getLease4Internal(hwaddr, subnet_id));
+        return (getLease4Internal(shard.storage_, hwaddr, subnet_id));
     }
 }
 
 void
-Memfile_LeaseMgr::getLease4Internal(const ClientId& client_id,
+Memfile_LeaseMgr::getLease4Internal(const Lease4ClientIdStorage& storage,
+                                    const ClientId& client_id,
                                     Lease4Collection& collection) const {
-    // Using composite index by 'client id' and 'subnet id'. It is ok
-    // to use it to search by 'client id' only.
-    const Lease4StorageClientIdSubnetIdIndex& idx =
-        storage4_.get<ClientIdSubnetIdIndexTag>();
-    std::pair<Lease4StorageClientIdSubnetIdIndex::const_iterator,
-              Lease4StorageClientIdSubnetIdIndex::const_iterator> l
-        = idx.equal_range(boost::make_tuple(client_id.getClientId()));
+    const Lease4StorageClientIdIndex& idx = storage.get<ClientIdIndexTag>();
+    std::pair<Lease4StorageClientIdIndex::const_iterator,
+              Lease4StorageClientIdIndex::const_iterator> l
+        = idx.equal_range(client_id.getClientId());
 
     for (auto lease = l.first; lease != l.second; ++lease) {
         collection.push_back(Lease4Ptr(new Lease4(**lease)));
@@ -872,35 +1370,40 @@ Memfile_LeaseMgr::getLease4(const ClientId& client_id) const {
               DHCPSRV_MEMFILE_GET_CLIENTID).arg(client_id.toText());
 
     Lease4Collection collection;
+    auto const& shard = client_id_shards4_[getShardIndex(client_id.getClientId())];
     if (MultiThreadingMgr::instance().getMode()) {
-        std::lock_guard<std::mutex> lock(*mutex_);
-        getLease4Internal(client_id, collection);
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        getLease4Internal(shard.storage_, client_id, collection);
     } else {
-        getLease4Internal(client_id, collection);
+        getLease4Internal(shard.storage_, client_id, collection);
     }
 
     return (collection);
 }
 
 Lease4Ptr
-Memfile_LeaseMgr::getLease4Internal(const ClientId& client_id,
+Memfile_LeaseMgr::getLease4Internal(const Lease4ClientIdStorage& storage,
+                                    const ClientId& client_id,
                                     const HWAddr& hwaddr,
                                     SubnetID subnet_id) const {
-    // Get the index by client id, HW address and subnet id.
-    const Lease4StorageClientIdHWAddressSubnetIdIndex& idx =
-        storage4_.get<ClientIdHWAddressSubnetIdIndexTag>();
-    // Try to get the lease using client id, hardware address and subnet id.
-    Lease4StorageClientIdHWAddressSubnetIdIndex::const_iterator lease =
-        idx.find(boost::make_tuple(client_id.getClientId(), hwaddr.hwaddr_,
-                                   subnet_id));
+    // Get the index by client and subnet id.
+    const Lease4StorageClientIdSubnetIdIndex& idx =
+        storage.get<ClientIdSubnetIdIndexTag>();
+    std::pair<Lease4StorageClientIdSubnetIdIndex::const_iterator,
+              Lease4StorageClientIdSubnetIdIndex::const_iterator> l
+        = idx.equal_range(boost::make_tuple(client_id.getClientId(), subnet_id));
 
-    if (lease == idx.end()) {
-        // Lease was not found. Return empty pointer to the caller.
-        return (Lease4Ptr());
+    // Look for the lease with the hardware address among the leases of
+    // the client id in the subnet.
+    for (auto lease = l.first; lease != l.second; ++lease) {
+        if ((*lease)->getHWAddrVector() == hwaddr.hwaddr_) {
+            // Lease was found. Return it to the caller.
+            return (Lease4Ptr(new Lease4(**lease)));
+        }
     }
 
-    // Lease was found. Return it to the caller.
-    return (*lease);
+    // Lease was not found. Return empty pointer to the caller.
+    return (Lease4Ptr());
 }
 
 Lease4Ptr
@@ -912,20 +1415,22 @@ Memfile_LeaseMgr::getLease4(const ClientId& client_id,
                                                         .arg(hwaddr.toText())
                                                         .arg(subnet_id);
 
+    auto const& shard = client_id_shards4_[getShardIndex(client_id.getClientId())];
     if (MultiThreadingMgr::instance().getMode()) {
-        std::lock_guard<std::mutex> lock(*mutex_);
-        return (getLease4Internal(client_id, hwaddr, subnet_id));
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        return (getLease4Internal(shard.storage_, client_id, hwaddr, subnet_id));
     } else {
-        return (getLease4Internal(client_id, hwaddr, subnet_id));
+        return (getLease4Internal(shard.storage_, client_id, hwaddr, subnet_id));
     }
 }
 
 Lease4Ptr
-Memfile_LeaseMgr::getLease4Internal(const ClientId& client_id,
+Memfile_LeaseMgr::getLease4Internal(const Lease4ClientIdStorage& storage,
+                                    const ClientId& client_id,
                                     SubnetID subnet_id) const {
     // Get the index by client and subnet id.
     const Lease4StorageClientIdSubnetIdIndex& idx =
-        storage4_.get<ClientIdSubnetIdIndexTag>();
+        storage.get<ClientIdSubnetIdIndexTag>();
     // Try to get the lease using client id and subnet id.
     Lease4StorageClientIdSubnetIdIndex::const_iterator lease =
         idx.find(boost::make_tuple(client_id.getClientId(), subnet_id));
@@ -933,6 +1438,7 @@ Memfile_LeaseMgr::getLease4Internal(const ClientId& client_id,
     if (lease == idx.end()) {
         return (Lease4Ptr());
     }
+
     // Lease was found. Return it to the caller.
     return (Lease4Ptr(new Lease4(**lease)));
 }
@@ -944,18 +1450,20 @@ Memfile_LeaseMgr::getLease4(const ClientId& client_id,
               DHCPSRV_MEMFILE_GET_SUBID_CLIENTID).arg(subnet_id)
               .arg(client_id.toText());
 
+    auto const& shard = client_id_shards4_[getShardIndex(client_id.getClientId())];
     if (MultiThreadingMgr::instance().getMode()) {
-        std::lock_guard<std::mutex> lock(*mutex_);
-        return (getLease4Internal(client_id, subnet_id));
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        return (getLease4Internal(shard.storage_, client_id, subnet_id));
     } else {
-        return (getLease4Internal(client_id, subnet_id));
+        return (getLease4Internal(shard.storage_, client_id, subnet_id));
     }
 }
 
 void
-Memfile_LeaseMgr::getLeases4Internal(SubnetID subnet_id,
+Memfile_LeaseMgr::getLeases4Internal(const Lease4Storage& storage,
+                                     SubnetID subnet_id,
                                      Lease4Collection& collection) const {
-    const Lease4StorageSubnetIdIndex& idx = storage4_.get<SubnetIdIndexTag>();
+    const Lease4StorageSubnetIdIndex& idx = storage.get<SubnetIdIndexTag>();
     std::pair<Lease4StorageSubnetIdIndex::const_iterator,
               Lease4StorageSubnetIdIndex::const_iterator> l =
         idx.equal_range(subnet_id);
@@ -971,20 +1479,24 @@ Memfile_LeaseMgr::getLeases4(SubnetID subnet_id) const {
         .arg(subnet_id);
 
     Lease4Collection collection;
-    if (MultiThreadingMgr::instance().getMode()) {
-        std::lock_guard<std::mutex> lock(*mutex_);
-        getLeases4Internal(subnet_id, collection);
-    } else {
-        getLeases4Internal(subnet_id, collection);
+    for (auto const& shard : shards4_) {
+        if (MultiThreadingMgr::instance().getMode()) {
+            std::lock_guard<std::mutex> lock(shard.mutex_);
+            getLeases4Internal(shard.storage_, subnet_id, collection);
+        } else {
+            getLeases4Internal(shard.storage_, subnet_id, collection);
+        }
     }
+    std::sort(collection.begin(), collection.end(), AddressLess());
 
     return (collection);
 }
 
 void
-Memfile_LeaseMgr::getLeases4Internal(const std::string& hostname,
+Memfile_LeaseMgr::getLeases4Internal(const Lease4Storage& storage,
+                                     const std::string& hostname,
                                      Lease4Collection& collection) const {
-    const Lease4StorageHostnameIndex& idx = storage4_.get<HostnameIndexTag>();
+    const Lease4StorageHostnameIndex& idx = storage.get<HostnameIndexTag>();
     std::pair<Lease4StorageHostnameIndex::const_iterator,
               Lease4StorageHostnameIndex::const_iterator> l =
         idx.equal_range(hostname);
@@ -1000,19 +1512,23 @@ Memfile_LeaseMgr::getLeases4(const std::string& hostname) const {
         .arg(hostname);
 
     Lease4Collection collection;
-    if (MultiThreadingMgr::instance().getMode()) {
-        std::lock_guard<std::mutex> lock(*mutex_);
-        getLeases4Internal(hostname, collection);
-    } else {
-        getLeases4Internal(hostname, collection);
+    for (auto const& shard : shards4_) {
+        if (MultiThreadingMgr::instance().getMode()) {
+            std::lock_guard<std::mutex> lock(shard.mutex_);
+            getLeases4Internal(shard.storage_, hostname, collection);
+        } else {
+            getLeases4Internal(shard.storage_, hostname, collection);
+        }
     }
+    std::sort(collection.begin(), collection.end(), AddressLess());
 
     return (collection);
 }
 
 void
-Memfile_LeaseMgr::getLeases4Internal(Lease4Collection& collection) const {
-   for (auto lease = storage4_.begin(); lease != storage4_.end(); ++lease) {
+Memfile_LeaseMgr::getLeases4Internal(const Lease4Storage& storage,
+                                     Lease4Collection& collection) const {
+   for (auto lease = storage.begin(); lease != storage.end(); ++lease) {
        collection.push_back(Lease4Ptr(new Lease4(**lease)));
    }
 }
@@ -1022,21 +1538,25 @@ Memfile_LeaseMgr::getLeases4() const {
    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MEMFILE_GET4);
 
    Lease4Collection collection;
-   if (MultiThreadingMgr::instance().getMode()) {
-        std::lock_guard<std::mutex> lock(*mutex_);
-        getLeases4Internal(collection);
-   } else {
-        getLeases4Internal(collection);
+   for (auto const& shard : shards4_) {
+        if (MultiThreadingMgr::instance().getMode()) {
+            std::lock_guard<std::mutex> lock(shard.mutex_);
+            getLeases4Internal(shard.storage_, collection);
+        } else {
+            getLeases4Internal(shard.storage_, collection);
+        }
    }
+   std::sort(collection.begin(), collection.end(), AddressLess());
 
    return (collection);
 }
 
 void
-Memfile_LeaseMgr::getLeases4Internal(const asiolink::IOAddress& lower_bound_address,
+Memfile_LeaseMgr::getLeases4Internal(const Lease4Storage& storage,
+                                     const asiolink::IOAddress& lower_bound_address,
                                      const LeasePageSize& page_size,
                                      Lease4Collection& collection) const {
-    const Lease4StorageAddressIndex& idx = storage4_.get<AddressIndexTag>();
+    const Lease4StorageAddressIndex& idx = storage.get<AddressIndexTag>();
     Lease4StorageAddressIndex::const_iterator lb = idx.lower_bound(lower_bound_address);
 
     // Exclude the lower bound address specified by the caller.
@@ -1066,22 +1586,34 @@ Memfile_LeaseMgr::getLeases4(const asiolink::IOAddress& lower_bound_address,
         .arg(page_size.page_size_)
         .arg(lower_bound_address.toText());
 
+    // Each shard returns its page: the page of the storage is made of
+    // the leases with the lowest addresses among them.
     Lease4Collection collection;
-    if (MultiThreadingMgr::instance().getMode()) {
-        std::lock_guard<std::mutex> lock(*mutex_);
-        getLeases4Internal(lower_bound_address, page_size, collection);
-    } else {
-        getLeases4Internal(lower_bound_address, page_size, collection);
+    for (auto const& shard : shards4_) {
+        if (MultiThreadingMgr::instance().getMode()) {
+            std::lock_guard<std::mutex> lock(shard.mutex_);
+            getLeases4Internal(shard.storage_, lower_bound_address, page_size,
+                               collection);
+        } else {
+            getLeases4Internal(shard.storage_, lower_bound_address, page_size,
+                               collection);
+        }
+    }
+    std::sort(collection.begin(), collection.end(), AddressLess());
+    if (collection.size() > page_size.page_size_) {
+        collection.resize(page_size.page_size_);
     }
 
     return (collection);
 }
 
 Lease6Ptr
-Memfile_LeaseMgr::getLease6Internal(Lease::Type type,
+Memfile_LeaseMgr::getLease6Internal(const Lease6Storage& storage,
+                                    Lease::Type type,
                                     const isc::asiolink::IOAddress& addr) const {
-    Lease6Storage::iterator l = storage6_.find(addr);
-    if (l == storage6_.end() || !(*l) || ((*l)->type_ != type)) {
+    const Lease6StorageAddressHashIndex& idx = storage.get<AddressHashIndexTag>();
+    Lease6StorageAddressHashIndex::iterator l = idx.find(addr);
+    if (l == idx.end() || !(*l) || ((*l)->type_ != type)) {
         return (Lease6Ptr());
     } else {
         return (Lease6Ptr(new Lease6(**l)));
@@ -1096,21 +1628,23 @@ Memfile_LeaseMgr::getLease6(Lease::Type type,
         .arg(addr.toText())
         .arg(Lease::typeToText(type));
 
+    const Lease6StorageShard& shard = shards6_[getShardIndex(addr)];
     if (MultiThreadingMgr::instance().getMode()) {
-        std::lock_guard<std::mutex> lock(*mutex_);
-        return (getLease6Internal(type, addr));
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        return (getLease6Internal(shard.storage_, type, addr));
     } else {
-        return (getLease6Internal(type, addr));
+        return (getLease6Internal(shard.storage_, type, addr));
     }
 }
 
 void
-Memfile_LeaseMgr::getLeases6Internal(Lease::Type type,
+Memfile_LeaseMgr::getLeases6Internal(const Lease6DuidStorage& storage,
+                                     Lease::Type type,
                                      const DUID& duid,
                                      uint32_t iaid,
                                      Lease6Collection& collection) const {
     // Get the index by DUID, IAID, lease type.
-    const Lease6StorageDuidIaidTypeIndex& idx = storage6_.get<DuidIaidTypeIndexTag>();
+    const Lease6StorageDuidIaidTypeIndex& idx = storage.get<DuidIaidTypeIndexTag>();
     // Try to get the lease using the DUID, IAID and lease type.
     std::pair<Lease6StorageDuidIaidTypeIndex::const_iterator,
               Lease6StorageDuidIaidTypeIndex::const_iterator> l =
@@ -1133,24 +1667,26 @@ Memfile_LeaseMgr::getLeases6(Lease::Type type,
         .arg(Lease::typeToText(type));
 
     Lease6Collection collection;
+    auto const& shard = duid_shards6_[getShardIndex(duid.getDuid())];
     if (MultiThreadingMgr::instance().getMode()) {
-        std::lock_guard<std::mutex> lock(*mutex_);
-        getLeases6Internal(type, duid, iaid, collection);
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        getLeases6Internal(shard.storage_, type, duid, iaid, collection);
     } else {
-        getLeases6Internal(type, duid, iaid, collection);
+        getLeases6Internal(shard.storage_, type, duid, iaid, collection);
     }
 
     return (collection);
 }
 
 void
-Memfile_LeaseMgr::getLeases6Internal(Lease::Type type,
+Memfile_LeaseMgr::getLeases6Internal(const Lease6DuidStorage& storage,
+                                     Lease::Type type,
                                      const DUID& duid,
                                      uint32_t iaid,
                                      SubnetID subnet_id,
                                      Lease6Collection& collection) const {
     // Get the index by DUID, IAID, lease type.
-    const Lease6StorageDuidIaidTypeIndex& idx = storage6_.get<DuidIaidTypeIndexTag>();
+    const Lease6StorageDuidIaidTypeIndex& idx = storage.get<DuidIaidTypeIndexTag>();
     // Try to get the lease using the DUID, IAID and lease type.
     std::pair<Lease6StorageDuidIaidTypeIndex::const_iterator,
               Lease6StorageDuidIaidTypeIndex::const_iterator> l =
@@ -1178,20 +1714,24 @@ Memfile_LeaseMgr::getLeases6(Lease::Type type,
         .arg(Lease::typeToText(type));
 
     Lease6Collection collection;
+    auto const& shard = duid_shards6_[getShardIndex(duid.getDuid())];
     if (MultiThreadingMgr::instance().getMode()) {
-        std::lock_guard<std::mutex> lock(*mutex_);
-        getLeases6Internal(type, duid, iaid, subnet_id, collection);
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        getLeases6Internal(shard.storage_, type, duid, iaid, subnet_id,
+                           collection);
     } else {
-        getLeases6Internal(type, duid, iaid, subnet_id, collection);
+        getLeases6Internal(shard.storage_, type, duid, iaid, subnet_id,
+                           collection);
     }
 
     return (collection);
 }
 
 void
-Memfile_LeaseMgr::getLeases6Internal(SubnetID subnet_id,
+Memfile_LeaseMgr::getLeases6Internal(const Lease6Storage& storage,
+                                     SubnetID subnet_id,
                                      Lease6Collection& collection) const {
-    const Lease6StorageSubnetIdIndex& idx = storage6_.get<SubnetIdIndexTag>();
+    const Lease6StorageSubnetIdIndex& idx = storage.get<SubnetIdIndexTag>();
     std::pair<Lease6StorageSubnetIdIndex::const_iterator,
               Lease6StorageSubnetIdIndex::const_iterator> l =
         idx.equal_range(subnet_id);
@@ -1207,20 +1747,24 @@ Memfile_LeaseMgr::getLeases6(SubnetID subnet_id) const {
         .arg(subnet_id);
 
     Lease6Collection collection;
-    if (MultiThreadingMgr::instance().getMode()) {
-        std::lock_guard<std::mutex> lock(*mutex_);
-        getLeases6Internal(subnet_id, collection);
-    } else {
-        getLeases6Internal(subnet_id, collection);
+    for (auto const& shard : shards6_) {
+        if (MultiThreadingMgr::instance().getMode()) {
+            std::lock_guard<std::mutex> lock(shard.mutex_);
+            getLeases6Internal(shard.storage_, subnet_id, collection);
+        } else {
+            getLeases6Internal(shard.storage_, subnet_id, collection);
+        }
     }
+    std::sort(collection.begin(), collection.end(), AddressLess());
 
     return (collection);
 }
 
 void
-Memfile_LeaseMgr::getLeases6Internal(const std::string& hostname,
+Memfile_LeaseMgr::getLeases6Internal(const Lease6Storage& storage,
+                                     const std::string& hostname,
                                      Lease6Collection& collection) const {
-    const Lease6StorageHostnameIndex& idx = storage6_.get<HostnameIndexTag>();
+    const Lease6StorageHostnameIndex& idx = storage.get<HostnameIndexTag>();
     std::pair<Lease6StorageHostnameIndex::const_iterator,
               Lease6StorageHostnameIndex::const_iterator> l =
         idx.equal_range(hostname);
@@ -1236,19 +1780,23 @@ Memfile_LeaseMgr::getLeases6(const std::string& hostname) const {
         .arg(hostname);
 
     Lease6Collection collection;
-    if (MultiThreadingMgr::instance().getMode()) {
-        std::lock_guard<std::mutex> lock(*mutex_);
-        getLeases6Internal(hostname, collection);
-    } else {
-        getLeases6Internal(hostname, collection);
+    for (auto const& shard : shards6_) {
+        if (MultiThreadingMgr::instance().getMode()) {
+            std::lock_guard<std::mutex> lock(shard.mutex_);
+            getLeases6Internal(shard.storage_, hostname, collection);
+        } else {
+            getLeases6Internal(shard.storage_, hostname, collection);
+        }
     }
+    std::sort(collection.begin(), collection.end(), AddressLess());
 
     return (collection);
 }
 
 void
-Memfile_LeaseMgr::getLeases6Internal(Lease6Collection& collection) const {
-   for (auto lease = storage6_.begin(); lease != storage6_.end(); ++lease) {
+Memfile_LeaseMgr::getLeases6Internal(const Lease6Storage& storage,
+                                     Lease6Collection& collection) const {
+   for (auto lease = storage.begin(); lease != storage.end(); ++lease) {
        collection.push_back(Lease6Ptr(new Lease6(**lease)));
    }
 }
@@ -1258,20 +1806,24 @@ Memfile_LeaseMgr::getLeases6() const {
    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MEMFILE_GET6);
 
    Lease6Collection collection;
-   if (MultiThreadingMgr::instance().getMode()) {
-        std::lock_guard<std::mutex> lock(*mutex_);
-        getLeases6Internal(collection);
-   } else {
-        getLeases6Internal(collection);
+   for (auto const& shard : shards6_) {
+        if (MultiThreadingMgr::instance().getMode()) {
+            std::lock_guard<std::mutex> lock(shard.mutex_);
+            getLeases6Internal(shard.storage_, collection);
+        } else {
+            getLeases6Internal(shard.storage_, collection);
+        }
    }
+   std::sort(collection.begin(), collection.end(), AddressLess());
 
    return (collection);
 }
 
 void
-Memfile_LeaseMgr::getLeases6Internal(const DUID& duid,
+Memfile_LeaseMgr::getLeases6Internal(const Lease6DuidStorage& storage,
+                                     const DUID& duid,
                                      Lease6Collection& collection) const {
-    const Lease6StorageDuidIndex& idx = storage6_.get<DuidIndexTag>();
+    const Lease6StorageDuidIndex& idx = storage.get<DuidIndexTag>();
     std::pair<Lease6StorageDuidIndex::const_iterator,
               Lease6StorageDuidIndex::const_iterator> l =
         idx.equal_range(duid.getDuid());
@@ -1287,21 +1839,23 @@ Memfile_LeaseMgr::getLeases6(const DUID& duid) const {
        .arg(duid.toText());
 
     Lease6Collection collection;
+    auto const& shard = duid_shards6_[getShardIndex(duid.getDuid())];
     if (MultiThreadingMgr::instance().getMode()) {
-        std::lock_guard<std::mutex> lock(*mutex_);
-        getLeases6Internal(duid, collection);
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        getLeases6Internal(shard.storage_, duid, collection);
     } else {
-        getLeases6Internal(duid, collection);
+        getLeases6Internal(shard.storage_, duid, collection);
     }
 
     return (collection);
 }
 
 void
-Memfile_LeaseMgr::getLeases6Internal(const asiolink::IOAddress& lower_bound_address,
+Memfile_LeaseMgr::getLeases6Internal(const Lease6Storage& storage,
+                                     const asiolink::IOAddress& lower_bound_address,
                                      const LeasePageSize& page_size,
                                      Lease6Collection& collection) const {
-    const Lease6StorageAddressIndex& idx = storage6_.get<AddressIndexTag>();
+    const Lease6StorageAddressIndex& idx = storage.get<AddressIndexTag>();
     Lease6StorageAddressIndex::const_iterator lb = idx.lower_bound(lower_bound_address);
 
     // Exclude the lower bound address specified by the caller.
@@ -1331,22 +1885,33 @@ Memfile_LeaseMgr::getLeases6(const asiolink::IOAddress& lower_bound_address,
         .arg(page_size.page_size_)
         .arg(lower_bound_address.toText());
 
+    // Each shard returns its page: the page of the storage is made of
+    // the leases with the lowest addresses among them.
     Lease6Collection collection;
-    if (MultiThreadingMgr::instance().getMode()) {
-        std::lock_guard<std::mutex> lock(*mutex_);
-        getLeases6Internal(lower_bound_address, page_size, collection);
-    } else {
-        getLeases6Internal(lower_bound_address, page_size, collection);
+    for (auto const& shard : shards6_) {
+        if (MultiThreadingMgr::instance().getMode()) {
+            std::lock_guard<std::mutex> lock(shard.mutex_);
+            getLeases6Internal(shard.storage_, lower_bound_address, page_size,
+                               collection);
+        } else {
+            getLeases6Internal(shard.storage_, lower_bound_address, page_size,
+                               collection);
+        }
+    }
+    std::sort(collection.begin(), collection.end(), AddressLess());
+    if (collection.size() > page_size.page_size_) {
+        collection.resize(page_size.page_size_);
     }
 
     return (collection);
 }
 
 void
-Memfile_LeaseMgr::getExpiredLeases4Internal(Lease4Collection& expired_leases,
+Memfile_LeaseMgr::getExpiredLeases4Internal(const Lease4Storage& storage,
+                                            Lease4Collection& expired_leases,
                                             const size_t max_leases) const {
     // Obtain the index which segragates leases by state and time.
-    const Lease4StorageExpirationIndex& index = storage4_.get<ExpirationIndexTag>();
+    const Lease4StorageExpirationIndex& index = storage.get<ExpirationIndexTag>();
 
     // Retrieve leases which are not reclaimed and which haven't expired. The
     // 'less-than' operator will be used for both components of the index. So,
@@ -1370,19 +1935,31 @@ Memfile_LeaseMgr::getExpiredLeases4(Lease4Collection& expired_leases,
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MEMFILE_GET_EXPIRED4)
         .arg(max_leases);
 
-    if (MultiThreadingMgr::instance().getMode()) {
-        std::lock_guard<std::mutex> lock(*mutex_);
-        getExpiredLeases4Internal(expired_leases, max_leases);
-    } else {
-        getExpiredLeases4Internal(expired_leases, max_leases);
+    // Each shard returns its first expired leases: the leases which
+    // expired first in the storage are among them.
+    Lease4Collection collection;
+    for (auto const& shard : shards4_) {
+        if (MultiThreadingMgr::instance().getMode()) {
+            std::lock_guard<std::mutex> lock(shard.mutex_);
+            getExpiredLeases4Internal(shard.storage_, collection, max_leases);
+        } else {
+            getExpiredLeases4Internal(shard.storage_, collection, max_leases);
+        }
     }
+    std::sort(collection.begin(), collection.end(), ExpirationLess());
+    if ((max_leases > 0) && (collection.size() > max_leases)) {
+        collection.resize(max_leases);
+    }
+    expired_leases.insert(expired_leases.end(), collection.begin(),
+                          collection.end());
 }
 
 void
-Memfile_LeaseMgr::getExpiredLeases6Internal(Lease6Collection& expired_leases,
+Memfile_LeaseMgr::getExpiredLeases6Internal(const Lease6Storage& storage,
+                                            Lease6Collection& expired_leases,
                                             const size_t max_leases) const {
     // Obtain the index which segragates leases by state and time.
-    const Lease6StorageExpirationIndex& index = storage6_.get<ExpirationIndexTag>();
+    const Lease6StorageExpirationIndex& index = storage.get<ExpirationIndexTag>();
 
     // Retrieve leases which are not reclaimed and which haven't expired. The
     // 'less-than' operator will be used for both components of the index. So,
@@ -1406,23 +1983,35 @@ Memfile_LeaseMgr::getExpiredLeases6(Lease6Collection& expired_leases,
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MEMFILE_GET_EXPIRED6)
         .arg(max_leases);
 
-    if (MultiThreadingMgr::instance().getMode()) {
-        std::lock_guard<std::mutex> lock(*mutex_);
-        getExpiredLeases6Internal(expired_leases, max_leases);
-    } else {
-        getExpiredLeases6Internal(expired_leases, max_leases);
+    // Each shard returns its first expired leases: the leases which
+    // expired first in the storage are among them.
+    Lease6Collection collection;
+    for (auto const& shard : shards6_) {
+        if (MultiThreadingMgr::instance().getMode()) {
+            std::lock_guard<std::mutex> lock(shard.mutex_);
+            getExpiredLeases6Internal(shard.storage_, collection, max_leases);
+        } else {
+            getExpiredLeases6Internal(shard.storage_, collection, max_leases);
+        }
+    }
+    std::sort(collection.begin(), collection.end(), ExpirationLess());
+    if ((max_leases > 0) && (collection.size() > max_leases)) {
+        collection.resize(max_leases);
     }
+    expired_leases.insert(expired_leases.end(), collection.begin(),
+                          collection.end());
 }
 
 void
-Memfile_LeaseMgr::updateLease4Internal(const Lease4Ptr& lease) {
+Memfile_LeaseMgr::updateLease4Internal(Lease4Storage& storage,
+                                       const Lease4Ptr& lease) {
     // Obtain 'by address' index.
-    Lease4StorageAddressIndex& index = storage4_.get<AddressIndexTag>();
+    Lease4StorageAddressHashIndex& index = storage.get<AddressHashIndexTag>();
 
     bool persist = persistLeases(V4);
 
     // Lease must exist if it is to be updated.
-    Lease4StorageAddressIndex::const_iterator lease_it = index.find(lease->addr_);
+    Lease4StorageAddressHashIndex::const_iterator lease_it = index.find(lease->addr_);
     if (lease_it == index.end()) {
         isc_throw(NoSuchLease, "failed to update the lease with address "
                   << lease->addr_ << " - no such lease");
@@ -1438,14 +2027,17 @@ Memfile_LeaseMgr::updateLease4Internal(const Lease4Ptr& lease) {
     // not be inserted to the memory and the disk and in-memory data will
     // remain consistent.
     if (persist) {
-        lease_file4_->append(*lease);
+        writeLease(lease_file4_, *lease);
     }
 
     // Update lease current expiration time.
     lease->updateCurrentExpirationTime();
 
     // Use replace() to re-index leases.
-    index.replace(lease_it, Lease4Ptr(new Lease4(*lease)));
+    Lease4Ptr old_lease = *lease_it;
+    Lease4Ptr stored(new Lease4(*lease));
+    index.replace(lease_it, stored);
+    reindexLease(old_lease, stored);
 }
 
 void
@@ -1453,23 +2045,25 @@ Memfile_LeaseMgr::updateLease4(const Lease4Ptr& lease) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_UPDATE_ADDR4).arg(lease->addr_.toText());
 
+    Lease4StorageShard& shard = shards4_[getShardIndex(lease->addr_)];
     if (MultiThreadingMgr::instance().getMode()) {
-        std::lock_guard<std::mutex> lock(*mutex_);
-        updateLease4Internal(lease);
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        updateLease4Internal(shard.storage_, lease);
     } else {
-        updateLease4Internal(lease);
+        updateLease4Internal(shard.storage_, lease);
     }
 }
 
 void
-Memfile_LeaseMgr::updateLease6Internal(const Lease6Ptr& lease) {
+Memfile_LeaseMgr::updateLease6Internal(Lease6Storage& storage,
+                                       const Lease6Ptr& lease) {
     // Obtain 'by address' index.
-    Lease6StorageAddressIndex& index = storage6_.get<AddressIndexTag>();
+    Lease6StorageAddressHashIndex& index = storage.get<AddressHashIndexTag>();
 
     bool persist = persistLeases(V6);
 
     // Lease must exist if it is to be updated.
-    Lease6StorageAddressIndex::const_iterator lease_it = index.find(lease->addr_);
+    Lease6StorageAddressHashIndex::const_iterator lease_it = index.find(lease->addr_);
     if (lease_it == index.end()) {
         isc_throw(NoSuchLease, "failed to update the lease with address "
                   << lease->addr_ << " - no such lease");
@@ -1485,14 +2079,18 @@ Memfile_LeaseMgr::updateLease6Internal(const Lease6Ptr& lease) {
     // not be inserted to the memory and the disk and in-memory data will
     // remain consistent.
     if (persist) {
-        lease_file6_->append(*lease);
+        writeLease(lease_file6_, *lease);
     }
 
     // Update lease current expiration time.
     lease->updateCurrentExpirationTime();
 
     // Use replace() to re-index leases.
-    index.replace(lease_it, Lease6Ptr(new Lease6(*lease)));
+    Lease6Ptr old_lease = *lease_it;
+    Lease6Ptr stored(new Lease6(*lease));
+    internIdentifiers(*stored, old_lease);
+    index.replace(lease_it, stored);
+    reindexLease(old_lease, stored);
 }
 
 void
@@ -1500,19 +2098,22 @@ Memfile_LeaseMgr::updateLease6(const Lease6Ptr& lease) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_UPDATE_ADDR6).arg(lease->addr_.toText());
 
+    Lease6StorageShard& shard = shards6_[getShardIndex(lease->addr_)];
     if (MultiThreadingMgr::instance().getMode()) {
-        std::lock_guard<std::mutex> lock(*mutex_);
-        updateLease6Internal(lease);
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        updateLease6Internal(shard.storage_, lease);
     } else {
-        updateLease6Internal(lease);
+        updateLease6Internal(shard.storage_, lease);
     }
 }
 
 bool
-Memfile_LeaseMgr::deleteLeaseInternal(const Lease4Ptr& lease) {
+Memfile_LeaseMgr::deleteLeaseInternal(Lease4Storage& storage,
+                                      const Lease4Ptr& lease) {
     const isc::asiolink::IOAddress& addr = lease->addr_;
-    Lease4Storage::iterator l = storage4_.find(addr);
-    if (l == storage4_.end()) {
+    Lease4StorageAddressHashIndex& idx = storage.get<AddressHashIndexTag>();
+    Lease4StorageAddressHashIndex::iterator l = idx.find(addr);
+    if (l == idx.end()) {
         // No such lease
         return (false);
     } else {
@@ -1523,7 +2124,7 @@ Memfile_LeaseMgr::deleteLeaseInternal(const Lease4Ptr& lease) {
             // Setting valid lifetime to 0 means that lease is being
             // removed.
             lease_copy.valid_lft_ = 0;
-            lease_file4_->append(lease_copy);
+            writeLease(lease_file4_, lease_copy);
         } else {
             // For test purpose only: check that the lease has not changed in
             // the database.
@@ -1532,7 +2133,8 @@ Memfile_LeaseMgr::deleteLeaseInternal(const Lease4Ptr& lease) {
                 return false;
             }
         }
-        storage4_.erase(l);
+        unindexLease(*l);
+        idx.erase(l);
         return (true);
     }
 }
@@ -1542,19 +2144,22 @@ Memfile_LeaseMgr::deleteLease(const Lease4Ptr& lease) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_DELETE_ADDR).arg(lease->addr_.toText());
 
+    Lease4StorageShard& shard = shards4_[getShardIndex(lease->addr_)];
     if (MultiThreadingMgr::instance().getMode()) {
-        std::lock_guard<std::mutex> lock(*mutex_);
-        return (deleteLeaseInternal(lease));
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        return (deleteLeaseInternal(shard.storage_, lease));
     } else {
-        return (deleteLeaseInternal(lease));
+        return (deleteLeaseInternal(shard.storage_, lease));
     }
 }
 
 bool
-Memfile_LeaseMgr::deleteLeaseInternal(const Lease6Ptr& lease) {
+Memfile_LeaseMgr::deleteLeaseInternal(Lease6Storage& storage,
+                                      const Lease6Ptr& lease) {
     const isc::asiolink::IOAddress& addr = lease->addr_;
-    Lease6Storage::iterator l = storage6_.find(addr);
-    if (l == storage6_.end()) {
+    Lease6StorageAddressHashIndex& idx = storage.get<AddressHashIndexTag>();
+    Lease6StorageAddressHashIndex::iterator l = idx.find(addr);
+    if (l == idx.end()) {
         // No such lease
         return (false);
     } else {
@@ -1565,7 +2170,7 @@ Memfile_LeaseMgr::deleteLeaseInternal(const Lease6Ptr& lease) {
             // Setting lifetimes to 0 means that lease is being removed.
             lease_copy.valid_lft_ = 0;
             lease_copy.preferred_lft_ = 0;
-            lease_file6_->append(lease_copy);
+            writeLease(lease_file6_, lease_copy);
         } else {
             // For test purpose only: check that the lease has not changed in
             // the database.
@@ -1574,7 +2179,8 @@ Memfile_LeaseMgr::deleteLeaseInternal(const Lease6Ptr& lease) {
                 return false;
             }
         }
-        storage6_.erase(l);
+        unindexLease(*l);
+        idx.erase(l);
         return (true);
     }
 }
@@ -1584,11 +2190,12 @@ Memfile_LeaseMgr::deleteLease(const Lease6Ptr& lease) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_DELETE_ADDR).arg(lease->addr_.toText());
 
+    Lease6StorageShard& shard = shards6_[getShardIndex(lease->addr_)];
     if (MultiThreadingMgr::instance().getMode()) {
-        std::lock_guard<std::mutex> lock(*mutex_);
-        return (deleteLeaseInternal(lease));
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        return (deleteLeaseInternal(shard.storage_, lease));
     } else {
-        return (deleteLeaseInternal(lease));
+        return (deleteLeaseInternal(shard.storage_, lease));
     }
 }
 
@@ -1598,16 +2205,21 @@ Memfile_LeaseMgr::deleteExpiredReclaimedLeases4(const uint32_t secs) {
               DHCPSRV_MEMFILE_DELETE_EXPIRED_RECLAIMED4)
         .arg(secs);
 
-    if (MultiThreadingMgr::instance().getMode()) {
-        std::lock_guard<std::mutex> lock(*mutex_);
-        return (deleteExpiredReclaimedLeases<
+    uint64_t num_leases = 0;
+    for (auto& shard : shards4_) {
+        if (MultiThreadingMgr::instance().getMode()) {
+            std::lock_guard<std::mutex> lock(shard.mutex_);
+            num_leases += deleteExpiredReclaimedLeases<
                 Lease4StorageExpirationIndex, Lease4
-                >(secs, V4, storage4_, lease_file4_));
-    } else {
-        return (deleteExpiredReclaimedLeases<
+                >(secs, V4, shard.storage_, lease_file4_);
+        } else {
+            num_leases += deleteExpiredReclaimedLeases<
                 Lease4StorageExpirationIndex, Lease4
-                >(secs, V4, storage4_, lease_file4_));
+                >(secs, V4, shard.storage_, lease_file4_);
+        }
     }
+
+    return (num_leases);
 }
 
 uint64_t
@@ -1616,16 +2228,21 @@ Memfile_LeaseMgr::deleteExpiredReclaimedLeases6(const uint32_t secs) {
               DHCPSRV_MEMFILE_DELETE_EXPIRED_RECLAIMED6)
         .arg(secs);
 
-    if (MultiThreadingMgr::instance().getMode()) {
-        std::lock_guard<std::mutex> lock(*mutex_);
-        return (deleteExpiredReclaimedLeases<
+    uint64_t num_leases = 0;
+    for (auto& shard : shards6_) {
+        if (MultiThreadingMgr::instance().getMode()) {
+            std::lock_guard<std::mutex> lock(shard.mutex_);
+            num_leases += deleteExpiredReclaimedLeases<
                 Lease6StorageExpirationIndex, Lease6
-                >(secs, V6, storage6_, lease_file6_));
-    } else {
-        return (deleteExpiredReclaimedLeases<
+                >(secs, V6, shard.storage_, lease_file6_);
+        } else {
+            num_leases += deleteExpiredReclaimedLeases<
                 Lease6StorageExpirationIndex, Lease6
-                >(secs, V6, storage6_, lease_file6_));
+                >(secs, V6, shard.storage_, lease_file6_);
+        }
     }
+
+    return (num_leases);
 }
 
 template<typename IndexType, typename LeaseType, typename StorageType,
@@ -1634,7 +2251,7 @@ uint64_t
 Memfile_LeaseMgr::deleteExpiredReclaimedLeases(const uint32_t secs,
                                                const Universe& universe,
                                                StorageType& storage,
-                                               LeaseFileType& lease_file) const {
+                                               LeaseFileType& lease_file) {
     // Obtain the index which segragates leases by state and time.
     IndexType& index = storage.template get<ExpirationIndexTag>();
 
@@ -1679,11 +2296,15 @@ Memfile_LeaseMgr::deleteExpiredReclaimedLeases(const uint32_t secs,
                 // Set the valid lifetime to 0 to indicate the removal
                 // of the lease.
                 lease_copy.valid_lft_ = 0;
-                lease_file->append(lease_copy);
+                writeLease(lease_file, lease_copy);
             }
         }
 
         // Erase leases from memory.
+        for (typename IndexType::const_iterator lease = lower_limit;
+             lease != upper_limit; ++lease) {
+            unindexLease(*lease);
+        }
         index.erase(lower_limit, upper_limit);
     }
     // Return number of leases deleted.
@@ -1885,9 +2506,11 @@ Memfile_LeaseMgr::lfcCallback() {
     // Check if we're in the v4 or v6 space and use the appropriate file.
     if (lease_file4_) {
         MultiThreadingCriticalSection cs;
+        writerWait();
         lfcExecute(lease_file4_);
     } else if (lease_file6_) {
         MultiThreadingCriticalSection cs;
+        writerWait();
         lfcExecute(lease_file6_);
     }
 }
@@ -1915,6 +2538,160 @@ Memfile_LeaseMgr::lfcSetup(bool conversion_needed) {
     }
 }
 
+void
+Memfile_LeaseMgr::flushSetup() {
+    std::string flush_records_str = "1";
+    try {
+        flush_records_str = conn_.getParameter("flush-records");
+    } catch (const std::exception&) {
+        // Ignore and default to 1.
+    }
+
+    uint32_t flush_records = 1;
+    try {
+        flush_records = boost::lexical_cast<uint32_t>(flush_records_str);
+    } catch (const boost::bad_lexical_cast&) {
+        isc_throw(isc::BadValue, "invalid value of the flush-records "
+                  << flush_records_str << " specified");
+    }
+
+    std::string flush_interval_str = "0";
+    try {
+        flush_interval_str = conn_.getParameter("flush-interval");
+    } catch (const std::exception&) {
+        // Ignore and default to 0.
+    }
+
+    uint32_t flush_interval = 0;
+    try {
+        flush_interval = boost::lexical_cast<uint32_t>(flush_interval_str);
+    } catch (const boost::bad_lexical_cast&) {
+        isc_throw(isc::BadValue, "invalid value of the flush-interval "
+                  << flush_interval_str << " specified");
+    }
+
+    if (lease_file4_) {
+        lease_file4_->setFlushRows(flush_records);
+    }
+    if (lease_file6_) {
+        lease_file6_->setFlushRows(flush_records);
+    }
+
+    // Nothing to do with the default policy: flush after each change.
+    if ((flush_records == 1) && (flush_interval == 0)) {
+        return;
+    }
+    LOG_INFO(dhcpsrv_logger, DHCPSRV_MEMFILE_FLUSH_SETUP)
+        .arg(flush_records).arg(flush_interval);
+
+    // The writer thread flushes the lease file when it has nothing to do.
+    if ((flush_interval > 0) && !writer_) {
+        flush_timer_mgr_ = TimerMgr::instance();
+        flush_timer_mgr_->registerTimer("memfile-flush",
+                                        std::bind(&Memfile_LeaseMgr::flushCallback,
+                                                  this),
+                                        flush_interval,
+                                        asiolink::IntervalTimer::REPEATING);
+        flush_timer_mgr_->setup("memfile-flush");
+    }
+}
+
+void
+Memfile_LeaseMgr::flushCallback() {
+    if (MultiThreadingMgr::instance().getMode()) {
+        std::lock_guard<std::mutex> lock(file_mutex_);
+        flushInternal();
+    } else {
+        flushInternal();
+    }
+}
+
+void
+Memfile_LeaseMgr::flushInternal() {
+    try {
+        if (lease_file4_ && (lease_file4_->getPendingRows() > 0)) {
+            lease_file4_->flush();
+        }
+        if (lease_file6_ && (lease_file6_->getPendingRows() > 0)) {
+            lease_file6_->flush();
+        }
+
+    } catch (const CSVFileError& ex) {
+        LOG_ERROR(dhcpsrv_logger, DHCPSRV_MEMFILE_FLUSH_FAIL).arg(ex.what());
+    }
+}
+
+void
+Memfile_LeaseMgr::writerSetup() {
+    std::string write_queue_size_str = "0";
+    try {
+        write_queue_size_str = conn_.getParameter("write-queue-size");
+    } catch (const std::exception&) {
+        // Ignore and default to 0.
+    }
+
+    uint32_t write_queue_size = 0;
+    try {
+        write_queue_size = boost::lexical_cast<uint32_t>(write_queue_size_str);
+    } catch (const boost::bad_lexical_cast&) {
+        isc_throw(isc::BadValue, "invalid value of the write-queue-size "
+                  << write_queue_size_str << " specified");
+    }
+
+    std::string write_queue_full = "block";
+    try {
+        write_queue_full = conn_.getParameter("write-queue-full");
+    } catch (const std::exception&) {
+        // Ignore and default to block.
+    }
+
+    if ((write_queue_full != "block") && (write_queue_full != "drop")) {
+        isc_throw(isc::BadValue, "invalid value of the write-queue-full "
+                  << write_queue_full << " specified, expected block or drop");
+    }
+
+    if (write_queue_size == 0) {
+        return;
+    }
+    LOG_INFO(dhcpsrv_logger, DHCPSRV_MEMFILE_WRITER_SETUP)
+        .arg(write_queue_size).arg(write_queue_full);
+
+    writer_.reset(new LeaseFileWriter(write_queue_size,
+                                      write_queue_full == "block",
+                                      std::bind(&Memfile_LeaseMgr::flushInternal,
+                                                this)));
+}
+
+void
+Memfile_LeaseMgr::writerWait() {
+    if (writer_) {
+        writer_->wait();
+    }
+}
+
+template<typename LeaseFileType, typename LeaseType>
+void
+Memfile_LeaseMgr::writeLease(const boost::shared_ptr<LeaseFileType>& lease_file,
+                             const LeaseType& lease) const {
+    if (!writer_) {
+        if (MultiThreadingMgr::instance().getMode()) {
+            std::lock_guard<std::mutex> lock(file_mutex_);
+            lease_file->append(lease);
+        } else {
+            lease_file->append(lease);
+        }
+        return;
+    }
+
+    // The lease file cleanup waits for the queued appends before it
+    // replaces the lease file, so the queued appends use the lease file
+    // open at the time of the lease change.
+    boost::shared_ptr<LeaseType> lease_copy(new LeaseType(lease));
+    writer_->add([lease_file, lease_copy]() {
+        lease_file->append(*lease_copy);
+    });
+}
+
 template<typename LeaseFileType>
 void
 Memfile_LeaseMgr::lfcExecute(boost::shared_ptr<LeaseFileType>& lease_file) {
@@ -1978,14 +2755,14 @@ Memfile_LeaseMgr::lfcExecute(boost::shared_ptr<LeaseFileType>& lease_file) {
 
 LeaseStatsQueryPtr
 Memfile_LeaseMgr::startLeaseStatsQuery4() {
-    LeaseStatsQueryPtr query(new MemfileLeaseStatsQuery4(storage4_));
+    LeaseStatsQueryPtr query(new MemfileLeaseStatsQuery4(shards4_));
     query->start();
     return(query);
 }
 
 LeaseStatsQueryPtr
 Memfile_LeaseMgr::startSubnetLeaseStatsQuery4(const SubnetID& subnet_id) {
-    LeaseStatsQueryPtr query(new MemfileLeaseStatsQuery4(storage4_, subnet_id));
+    LeaseStatsQueryPtr query(new MemfileLeaseStatsQuery4(shards4_, subnet_id));
     query->start();
     return(query);
 }
@@ -1993,7 +2770,7 @@ Memfile_LeaseMgr::startSubnetLeaseStatsQuery4(const SubnetID& subnet_id) {
 LeaseStatsQueryPtr
 Memfile_LeaseMgr::startSubnetRangeLeaseStatsQuery4(const SubnetID& first_subnet_id,
                                                    const SubnetID& last_subnet_id) {
-    LeaseStatsQueryPtr query(new MemfileLeaseStatsQuery4(storage4_, first_subnet_id,
+    LeaseStatsQueryPtr query(new MemfileLeaseStatsQuery4(shards4_, first_subnet_id,
                                                          last_subnet_id));
     query->start();
     return(query);
@@ -2001,14 +2778,14 @@ Memfile_LeaseMgr::startSubnetRangeLeaseStatsQuery4(const SubnetID& first_subnet_
 
 LeaseStatsQueryPtr
 Memfile_LeaseMgr::startLeaseStatsQuery6() {
-    LeaseStatsQueryPtr query(new MemfileLeaseStatsQuery6(storage6_));
+    LeaseStatsQueryPtr query(new MemfileLeaseStatsQuery6(shards6_));
     query->start();
     return(query);
 }
 
 LeaseStatsQueryPtr
 Memfile_LeaseMgr::startSubnetLeaseStatsQuery6(const SubnetID& subnet_id) {
-    LeaseStatsQueryPtr query(new MemfileLeaseStatsQuery6(storage6_, subnet_id));
+    LeaseStatsQueryPtr query(new MemfileLeaseStatsQuery6(shards6_, subnet_id));
     query->start();
     return(query);
 }
@@ -2016,7 +2793,7 @@ Memfile_LeaseMgr::startSubnetLeaseStatsQuery6(const SubnetID& subnet_id) {
 LeaseStatsQueryPtr
 Memfile_LeaseMgr::startSubnetRangeLeaseStatsQuery6(const SubnetID& first_subnet_id,
                                                    const SubnetID& last_subnet_id) {
-    LeaseStatsQueryPtr query(new MemfileLeaseStatsQuery6(storage6_, first_subnet_id,
+    LeaseStatsQueryPtr query(new MemfileLeaseStatsQuery6(shards6_, first_subnet_id,
                                                          last_subnet_id));
     query->start();
     return(query);
@@ -2027,19 +2804,8 @@ Memfile_LeaseMgr::wipeLeases4(const SubnetID& subnet_id) {
     LOG_INFO(dhcpsrv_logger, DHCPSRV_MEMFILE_WIPE_LEASES4)
         .arg(subnet_id);
 
-    // Get the index by DUID, IAID, lease type.
-    const Lease4StorageSubnetIdIndex& idx = storage4_.get<SubnetIdIndexTag>();
-
-    // Try to get the lease using the DUID, IAID and lease type.
-    std::pair<Lease4StorageSubnetIdIndex::const_iterator,
-              Lease4StorageSubnetIdIndex::const_iterator> l =
-        idx.equal_range(subnet_id);
-
     // Let's collect all leases.
-    Lease4Collection leases;
-    for (auto lease = l.first; lease != l.second; ++lease) {
-        leases.push_back(*lease);
-    }
+    Lease4Collection leases = getLeases4(subnet_id);
 
     size_t num = leases.size();
     for (auto l = leases.begin(); l != leases.end(); ++l) {
@@ -2056,19 +2822,8 @@ Memfile_LeaseMgr::wipeLeases6(const SubnetID& subnet_id) {
     LOG_INFO(dhcpsrv_logger, DHCPSRV_MEMFILE_WIPE_LEASES6)
         .arg(subnet_id);
 
-    // Get the index by DUID, IAID, lease type.
-    const Lease6StorageSubnetIdIndex& idx = storage6_.get<SubnetIdIndexTag>();
-
-    // Try to get the lease using the DUID, IAID and lease type.
-    std::pair<Lease6StorageSubnetIdIndex::const_iterator,
-              Lease6StorageSubnetIdIndex::const_iterator> l =
-        idx.equal_range(subnet_id);
-
     // Let's collect all leases.
-    Lease6Collection leases;
-    for (auto lease = l.first; lease != l.second; ++lease) {
-        leases.push_back(*lease);
-    }
+    Lease6Collection leases = getLeases6(subnet_id);
 
     size_t num = leases.size();
     for (auto l = leases.begin(); l != leases.end(); ++l) {
@@ -14,6 +14,7 @@
 #include <dhcpsrv/csv_lease_file6.h>
 #include <dhcpsrv/memfile_lease_storage.h>
 #include <dhcpsrv/lease_mgr.h>
+#include <dhcpsrv/timer_mgr.h>
 #include <util/process_spawn.h>
 
 #include <boost/scoped_ptr.hpp>
@@ -25,6 +26,7 @@ namespace isc {
 namespace dhcp {
 
 class LFCSetup;
+class LeaseFileWriter;
 
 /// @brief Concrete implementation of a lease database backend using flat file.
 ///
@@ -119,6 +121,8 @@ public:
     /// - Initializes the new instance based on the parameters given
     /// - Loads (or creates) the appropriate lease file(s)
     /// - Initiates the periodic scheduling of the LFC (if enabled)
+    /// - Sets the policy of the lease file flushes
+    /// - Starts the lease file writer thread (if enabled)
     ///
     /// If any of the files loaded require conversion to the current schema
     /// (upgrade or downgrade), @c lfcSetup() will be invoked with its
@@ -506,121 +510,154 @@ public:
 
 private:
 
-    /// @name Internal methods called while holding the mutex in multi threading
-    /// mode.
+    /// @name Internal methods called on a lease storage shard while holding
+    /// the shard mutex in multi threading mode.
+    ///
+    /// The methods changing a lease are called on the shard of the lease
+    /// address. The lookups by HW address, client id or DUID are called on
+    /// the shard of this key. The lookups by other keys are called on each
+    /// shard in turn and append the matching leases to the collection.
     ///@{
 
     /// @brief Adds an IPv4 lease,
     ///
+    /// @param storage the lease storage shard of the lease address
     /// @param lease lease to be added
     ///
     /// @result true if the lease was added, false if not
-    bool addLeaseInternal(const Lease4Ptr& lease);
+    bool addLeaseInternal(Lease4Storage& storage,
+                          const Lease4Ptr& lease);
 
     /// @brief Adds an IPv6 lease.
     ///
+    /// @param storage the lease storage shard of the lease address
     /// @param lease lease to be added
     ///
     /// @result true if the lease was added, false if not
-    bool addLeaseInternal(const Lease6Ptr& lease);
+    bool addLeaseInternal(Lease6Storage& storage,
+                          const Lease6Ptr& lease);
 
     /// @brief Returns existing IPv4 lease for specified IPv4 address.
     ///
+    /// @param storage the lease storage shard to search
     /// @param addr An address of the searched lease.
     ///
     /// @return a pointer to the lease (or NULL if a lease is not found)
-    Lease4Ptr getLease4Internal(const isc::asiolink::IOAddress& addr) const;
+    Lease4Ptr getLease4Internal(const Lease4Storage& storage,
+                                const isc::asiolink::IOAddress& addr) const;
 
     /// @brief Gets existing IPv4 leases for specified hardware address.
     ///
+    /// @param storage the lease storage shard of the hardware address
     /// @param hwaddr hardware address of the client
     /// @param collection lease collection
-    void getLease4Internal(const isc::dhcp::HWAddr& hwaddr,
+    void getLease4Internal(const Lease4HWAddressStorage& storage,
+                           const isc::dhcp::HWAddr& hwaddr,
                            Lease4Collection& collection) const;
 
     /// @brief Returns existing IPv4 lease for specified hardware address
     ///        and a subnet
     ///
+    /// @param storage the lease storage shard of the hardware address
     /// @param hwaddr hardware address of the client
     /// @param subnet_id identifier of the subnet that lease must belong to
     ///
     /// @return a pointer to the lease (or NULL if a lease is not found)
-    Lease4Ptr getLease4Internal(const HWAddr& hwaddr,
+    Lease4Ptr getLease4Internal(const Lease4HWAddressStorage& storage,
+                                const HWAddr& hwaddr,
                                 SubnetID subnet_id) const;
 
     /// @brief Gets existing IPv4 lease for specified client-id
     ///
+    /// @param storage the lease storage shard of the client identifier
     /// @param client_id client identifier
     /// @param collection lease collection
-    void getLease4Internal(const ClientId& client_id,
+    void getLease4Internal(const Lease4ClientIdStorage& storage,
+                           const ClientId& client_id,
                            Lease4Collection& collection) const;
 
     /// @brief Returns IPv4 lease for specified client-id/hwaddr/subnet-id tuple
     ///
+    /// @param storage the lease storage shard of the client identifier
     /// @param clientid client identifier
     /// @param hwaddr hardware address of the client
     /// @param subnet_id identifier of the subnet that lease must belong to
     ///
     /// @return a pointer to the lease (or NULL if a lease is not found)
-    Lease4Ptr getLease4Internal(const ClientId& clientid,
+    Lease4Ptr getLease4Internal(const Lease4ClientIdStorage& storage,
+                                const ClientId& clientid,
                                 const HWAddr& hwaddr,
                                 SubnetID subnet_id) const;
 
     /// @brief Returns existing IPv4 lease for specified client-id
     ///
+    /// @param storage the lease storage shard of the client identifier
     /// @param clientid client identifier
     /// @param subnet_id identifier of the subnet that lease must belong to
     ///
     /// @return a pointer to the lease (or NULL if a lease is not found)
-    Lease4Ptr getLease4Internal(const ClientId& clientid,
+    Lease4Ptr getLease4Internal(const Lease4ClientIdStorage& storage,
+                                const ClientId& clientid,
                                 SubnetID subnet_id) const;
 
     /// @brief Gets all IPv4 leases for the particular subnet identifier.
     ///
+    /// @param storage the lease storage shard to search
     /// @param subnet_id subnet identifier.
     /// @param collection lease collection
-    void getLeases4Internal(SubnetID subnet_id,
+    void getLeases4Internal(const Lease4Storage& storage,
+                            SubnetID subnet_id,
                             Lease4Collection& collection) const;
 
     /// @brief Returns all IPv4 leases for the particular hostname.
     ///
+    /// @param storage the lease storage shard to search
     /// @param hostname hostname in lower case.
     /// @param collection lease collection
-    void getLeases4Internal(const std::string& hostname,
+    void getLeases4Internal(const Lease4Storage& storage,
+                            const std::string& hostname,
                             Lease4Collection& collection) const;
 
     /// @brief Gets all IPv4 leases.
     ///
+    /// @param storage the lease storage shard to search
     /// @param collection lease collection
-    void getLeases4Internal(Lease4Collection& collection) const;
+    void getLeases4Internal(const Lease4Storage& storage,
+                            Lease4Collection& collection) const;
 
     /// @brief Returns range of IPv4 leases using paging.
     ///
+    /// @param storage the lease storage shard to search
     /// @param lower_bound_address IPv4 address used as lower bound for the
     /// returned range.
     /// @param page_size maximum size of the page returned.
     /// @param collection lease collection
-    void getLeases4Internal(const asiolink::IOAddress& lower_bound_address,
+    void getLeases4Internal(const Lease4Storage& storage,
+                            const asiolink::IOAddress& lower_bound_address,
                             const LeasePageSize& page_size,
                             Lease4Collection& collection) const;
 
     /// @brief Returns existing IPv6 lease for a given IPv6 address.
     ///
+    /// @param storage the lease storage shard to search
     /// @param type specifies lease type: (NA, TA or PD)
     /// @param addr An address of the searched lease.
     ///
     /// @return a pointer to the lease (or NULL if a lease is not found)
-    Lease6Ptr getLease6Internal(Lease::Type type,
+    Lease6Ptr getLease6Internal(const Lease6Storage& storage,
+                                Lease::Type type,
                                 const isc::asiolink::IOAddress& addr) const;
 
     /// @brief Returns existing IPv6 lease for a given DUID + IA + lease type
     /// combination
     ///
+    /// @param storage the lease storage shard of the DUID
     /// @param type specifies lease type: (NA, TA or PD)
     /// @param duid client DUID
     /// @param iaid IA identifier
     /// @param collection lease collection
-    void getLeases6Internal(Lease::Type type,
+    void getLeases6Internal(const Lease6DuidStorage& storage,
+                            Lease::Type type,
                             const DUID& duid,
                             uint32_t iaid,
                             Lease6Collection& collection) const;
@@ -628,12 +665,14 @@ private:
     /// @brief Returns existing IPv6 lease for a given DUID + IA + subnet-id +
     /// lease type combination.
     ///
+    /// @param storage the lease storage shard of the DUID
     /// @param type specifies lease type: (NA, TA or PD)
     /// @param duid client DUID
     /// @param iaid IA identifier
     /// @param subnet_id identifier of the subnet the lease must belong to
     /// @param collection lease collection
-    void getLeases6Internal(Lease::Type type,
+    void getLeases6Internal(const Lease6DuidStorage& storage,
+                            Lease::Type type,
                             const DUID& duid,
                             uint32_t iaid,
                             SubnetID subnet_id,
@@ -641,60 +680,75 @@ private:
 
     /// @brief Returns all IPv6 leases for the particular subnet identifier.
     ///
+    /// @param storage the lease storage shard to search
     /// @param subnet_id subnet identifier.
     /// @param collection lease collection
-    void getLeases6Internal(SubnetID subnet_id,
+    void getLeases6Internal(const Lease6Storage& storage,
+                            SubnetID subnet_id,
                             Lease6Collection& collection) const;
 
     /// @brief Returns all IPv6 leases for the particular hostname.
     ///
+    /// @param storage the lease storage shard to search
     /// @param hostname hostname in lower case.
     /// @param collection lease collection
-    void getLeases6Internal(const std::string& hostname,
+    void getLeases6Internal(const Lease6Storage& storage,
+                            const std::string& hostname,
                             Lease6Collection& collection) const;
 
     /// @brief Returns all IPv6 leases.
     ///
+    /// @param storage the lease storage shard to search
     /// @param collection lease collection
-    void getLeases6Internal(Lease6Collection& collection) const;
+    void getLeases6Internal(const Lease6Storage& storage,
+                            Lease6Collection& collection) const;
 
     /// @brief Returns IPv6 leases for the DUID.
     ///
+    /// @param storage the lease storage shard of the DUID
     /// @param duid client DUID
     /// @param collection lease collection
-    void getLeases6Internal(const DUID& duid,
+    void getLeases6Internal(const Lease6DuidStorage& storage,
+                            const DUID& duid,
                             Lease6Collection& collection) const;
 
     /// @brief Returns range of IPv6 leases using paging.
     ///
+    /// @param storage the lease storage shard to search
     /// @param lower_bound_address IPv6 address used as lower bound for the
     /// returned range.
     /// @param page_size maximum size of the page returned.
     /// @param collection lease collection
-    void getLeases6Internal(const asiolink::IOAddress& lower_bound_address,
+    void getLeases6Internal(const Lease6Storage& storage,
+                            const asiolink::IOAddress& lower_bound_address,
                             const LeasePageSize& page_size,
                             Lease6Collection& collection) const;
 
     /// @brief Returns a collection of expired DHCPv4 leases.
     ///
+    /// @param storage the lease storage shard to search
     /// @param [out] expired_leases A container to which expired leases returned
     /// by the database backend are added.
     /// @param max_leases A maximum number of leases to be returned. If this
     /// value is set to 0, all expired (but not reclaimed) leases are returned.
-    void getExpiredLeases4Internal(Lease4Collection& expired_leases,
+    void getExpiredLeases4Internal(const Lease4Storage& storage,
+                                   Lease4Collection& expired_leases,
                                    const size_t max_leases) const;
 
     /// @brief Returns a collection of expired DHCPv6 leases.
     ///
+    /// @param storage the lease storage shard to search
     /// @param [out] expired_leases A container to which expired leases returned
     /// by the database backend are added.
     /// @param max_leases A maximum number of leases to be returned. If this
     /// value is set to 0, all expired (but not reclaimed) leases are returned.
-    void getExpiredLeases6Internal(Lease6Collection& expired_leases,
+    void getExpiredLeases6Internal(const Lease6Storage& storage,
+                                   Lease6Collection& expired_leases,
                                    const size_t max_leases) const;
 
     /// @brief Updates IPv4 lease.
     ///
+    /// @param storage the lease storage shard of the lease address
     /// @param lease4 The lease to be updated.
     ///
     /// @throw NoSuchLease if there is no such lease to be updated.
@@ -707,10 +761,12 @@ private:
     /// of the lease is performed only if the value matches the one received on
     /// the SELECT query, effectively enforcing no update on the lease between
     /// SELECT and UPDATE with different expiration time.
-    void updateLease4Internal(const Lease4Ptr& lease4);
+    void updateLease4Internal(Lease4Storage& storage,
+                              const Lease4Ptr& lease4);
 
     /// @brief Updates IPv6 lease.
     ///
+    /// @param storage the lease storage shard of the lease address
     /// @param lease6 The lease to be updated.
     ///
     /// @throw NoSuchLease if there is no such lease to be updated.
@@ -723,10 +779,12 @@ private:
     /// of the lease is performed only if the value matches the one received on
     /// the SELECT query, effectively enforcing no update on the lease between
     /// SELECT and UPDATE with different expiration time.
-    void updateLease6Internal(const Lease6Ptr& lease6);
+    void updateLease6Internal(Lease6Storage& storage,
+                              const Lease6Ptr& lease6);
 
     /// @brief Deletes an IPv4 lease.
     ///
+    /// @param storage the lease storage shard of the lease address
     /// @param lease IPv4 lease being deleted.
     ///
     /// @return true if deletion was successful, false if no such lease exists.
@@ -739,10 +797,12 @@ private:
     /// of the lease is performed only if the value matches the one received on
     /// the SELECT query, effectively enforcing no update on the lease between
     /// SELECT and DELETE with different expiration time.
-    bool deleteLeaseInternal(const Lease4Ptr& addr);
+    bool deleteLeaseInternal(Lease4Storage& storage,
+                             const Lease4Ptr& addr);
 
     /// @brief Deletes an IPv6 lease.
     ///
+    /// @param storage the lease storage shard of the lease address
     /// @param lease IPv6 lease being deleted.
     ///
     /// @return true if deletion was successful, false if no such lease exists.
@@ -755,7 +815,8 @@ private:
     /// of the lease is performed only if the value matches the one received on
     /// the SELECT query, effectively enforcing no update on the lease between
     /// SELECT and DELETE with different expiration time.
-    bool deleteLeaseInternal(const Lease6Ptr& addr);
+    bool deleteLeaseInternal(Lease6Storage& storage,
+                             const Lease6Ptr& addr);
 
     /// @brief Removes specified IPv4 leases.
     ///
@@ -772,6 +833,74 @@ private:
     size_t wipeLeases6Internal(const SubnetID& subnet_id);
     ///@}
 
+    /// @name Maintenance of the lease storages by HW address, client id
+    /// and DUID.
+    ///
+    /// These methods are called with the mutex of the address shard of the
+    /// lease held in multi threading mode: they lock the shards of the keys
+    /// after it, so the mutexes are always locked in the same order.
+    ///@{
+
+    /// @brief Adds a stored IPv4 lease to the storages by HW address and
+    /// by client id.
+    ///
+    /// @param lease the lease held in the address shard
+    void indexLease(const Lease4Ptr& lease);
+
+    /// @brief Adds a stored IPv6 lease to the storage by DUID.
+    ///
+    /// @param lease the lease held in the address shard
+    void indexLease(const Lease6Ptr& lease);
+
+    /// @brief Replaces a stored IPv4 lease in the storages by HW address
+    /// and by client id.
+    ///
+    /// @param old_lease the lease replaced in the address shard
+    /// @param new_lease the lease replacing it
+    void reindexLease(const Lease4Ptr& old_lease, const Lease4Ptr& new_lease);
+
+    /// @brief Replaces a stored IPv6 lease in the storage by DUID.
+    ///
+    /// @param old_lease the lease replaced in the address shard
+    /// @param new_lease the lease replacing it
+    void reindexLease(const Lease6Ptr& old_lease, const Lease6Ptr& new_lease);
+
+    /// @brief Removes a stored IPv4 lease from the storages by HW address
+    /// and by client id.
+    ///
+    /// @param lease the lease removed from the address shard
+    void unindexLease(const Lease4Ptr& lease);
+
+    /// @brief Removes a stored IPv6 lease from the storage by DUID.
+    ///
+    /// @param lease the lease removed from the address shard
+    void unindexLease(const Lease6Ptr& lease);
+
+    /// @brief Shares the client identifiers of a stored IPv6 lease.
+    ///
+    /// A client often has several leases, e.g. an address and a prefix,
+    /// and each of them gets its own DUID and HW address objects when
+    /// they come from different packets or from the lease file. The
+    /// lease uses the objects of the replaced lease or of another lease
+    /// with the same DUID instead, so they are held once per client.
+    ///
+    /// @param lease the lease to be stored
+    /// @param old_lease the lease it replaces, may be null
+    void internIdentifiers(Lease6& lease, const Lease6Ptr& old_lease);
+
+    /// @brief Moves the IPv4 leases loaded from the lease files to the
+    /// lease storage shards.
+    ///
+    /// @param storage the loaded leases, cleared on return
+    void shardLeases(Lease4Storage& storage);
+
+    /// @brief Moves the IPv6 leases loaded from the lease files to the
+    /// lease storage shards.
+    ///
+    /// @param storage the loaded leases, cleared on return
+    void shardLeases(Lease6Storage& storage);
+    ///@}
+
     /// @brief Deletes all expired-reclaimed leases.
     ///
     /// This private method is called by both of the public methods:
@@ -784,7 +913,8 @@ private:
     /// time will not be deleted.
     /// @param universe V4 or V6.
     /// @param storage Reference to the container where leases are held.
-    /// Some expired-reclaimed leases will be removed from this container.
+    /// Some expired-reclaimed leases will be removed from this container
+    /// and from the storages by HW address, client id or DUID.
     /// @param lease_file Reference to a DHCPv4 or DHCPv6 lease file
     /// instance where leases should be marked as deleted.
     ///
@@ -803,7 +933,7 @@ private:
     uint64_t deleteExpiredReclaimedLeases(const uint32_t secs,
                                           const Universe& universe,
                                           StorageType& storage,
-                                          LeaseFileType& lease_file) const;
+                                          LeaseFileType& lease_file);
 
 public:
 
@@ -1007,11 +1137,20 @@ private:
                              boost::shared_ptr<LeaseFileType>& lease_file,
                              StorageType& storage);
 
-    /// @brief stores IPv4 leases
-    Lease4Storage storage4_;
+    /// @brief stores IPv4 leases, split in shards by address
+    Lease4StorageShards shards4_;
+
+    /// @brief finds IPv4 leases by HW address, split in shards by HW address
+    Lease4HWAddressStorageShards hwaddr_shards4_;
+
+    /// @brief finds IPv4 leases by client id, split in shards by client id
+    Lease4ClientIdStorageShards client_id_shards4_;
 
-    /// @brief stores IPv6 leases
-    Lease6Storage storage6_;
+    /// @brief stores IPv6 leases, split in shards by address
+    Lease6StorageShards shards6_;
+
+    /// @brief finds IPv6 leases by DUID, split in shards by DUID
+    Lease6DuidStorageShards duid_shards6_;
 
     /// @brief Holds the pointer to the DHCPv4 lease file IO.
     boost::shared_ptr<CSVLeaseFile4> lease_file4_;
@@ -1120,6 +1259,18 @@ protected:
     virtual void lfcCallback();
     //@}
 
+    /// @name Protected methods used for the lease file writer.
+    //@{
+
+    /// @brief Waits for the lease file writer thread.
+    ///
+    /// Returns once the queued lease changes have been appended to the
+    /// lease file and the lease file writer statistics are up to date.
+    /// Does nothing when the lease changes are appended by the thread
+    /// changing the leases.
+    void writerWait();
+    //@}
+
     /// @name Private methods and members used for %Lease File Cleanup.
     //@{
 
@@ -1179,8 +1330,92 @@ private:
 
     //@}
 
-    /// @brief Manager mutex
-    boost::scoped_ptr<std::mutex> mutex_;
+    /// @name Private methods and members used for the lease file flushes.
+    //@{
+
+    /// @brief Sets the policy of the lease file flushes.
+    ///
+    /// The lease changes are appended to the lease file in groups: the file
+    /// is flushed after the number of lease changes set by the
+    /// @c flush-records parameter (1 by default, 0 to flush only when the
+    /// file buffer is full) and every @c flush-interval milliseconds when
+    /// this parameter is not 0 (the default). The lease changes not yet
+    /// flushed are lost if the server ends abruptly.
+    ///
+    /// @throw isc::BadValue if a parameter value is invalid.
+    void flushSetup();
+
+    /// @brief A callback function flushing the lease changes to the lease
+    /// file.
+    ///
+    /// This method is executed every @c flush-interval milliseconds.
+    void flushCallback();
+
+    /// @brief Flushes the lease file if lease changes were appended to it
+    /// since the last flush.
+    ///
+    /// @note The file mutex must be held in multi-threading mode, unless
+    /// this method is called by the lease file writer thread.
+    void flushInternal();
+
+    /// @brief Pointer to the timer manager running the flush timer, null
+    /// when the lease file is not flushed periodically.
+    TimerMgrPtr flush_timer_mgr_;
+
+    //@}
+
+    /// @name Private methods and members used for the lease file writer.
+    //@{
+
+    /// @brief Starts the lease file writer thread.
+    ///
+    /// When the @c write-queue-size parameter is not 0 (the default), the
+    /// lease changes are appended to the lease file by a dedicated thread
+    /// which takes them from a queue holding at most this number of
+    /// changes, so the disk latency doesn't delay the packet processing.
+    /// The @c write-queue-full parameter sets the behavior when the queue
+    /// is full: @c block (the default) waits for the writer thread while
+    /// @c drop refuses the lease change. After a failed append all further
+    /// lease changes are refused until the backend is recreated, e.g. by a
+    /// reconfiguration. The lease file is flushed each time the queue
+    /// becomes empty, which replaces the flushes every @c flush-interval
+    /// milliseconds.
+    ///
+    /// @throw isc::BadValue if a parameter value is invalid.
+    void writerSetup();
+
+    /// @brief Appends a lease change to the lease file.
+    ///
+    /// Without the writer thread the lease is appended immediately.
+    /// Otherwise a copy of the lease is queued to the writer thread,
+    /// which appends it to this lease file.
+    ///
+    /// @param lease_file A pointer to the lease file.
+    /// @param lease The lease to append.
+    ///
+    /// @tparam LeaseFileType One of @c CSVLeaseFile4 or @c CSVLeaseFile6.
+    /// @tparam LeaseType One of @c Lease4 or @c Lease6.
+    ///
+    /// @throw isc::db::DbOperationError if the queue is full and the
+    /// @c write-queue-full parameter is @c drop, or if the writer thread
+    /// failed to append a previous lease change.
+    template<typename LeaseFileType, typename LeaseType>
+    void writeLease(const boost::shared_ptr<LeaseFileType>& lease_file,
+                    const LeaseType& lease) const;
+
+    /// @brief Pointer to the lease file writer, null when the lease changes
+    /// are appended by the thread changing the leases.
+    boost::scoped_ptr<LeaseFileWriter> writer_;
+
+    //@}
+
+    /// @brief Mutex serializing the immediate lease file appends
+    ///
+    /// The changes of a lease are made while holding the mutex of its
+    /// storage shard, so they are appended in order. Without the writer
+    /// thread the appends of the changes in different shards and the
+    /// periodic flushes still share the lease file, and this mutex.
+    mutable std::mutex file_mutex_;
 };
 
 }  // namespace dhcp
@@ -1,4 +1,4 @@
-// Copyright (C) 2015-2019 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2015-2021 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -11,6 +11,7 @@
 #include <dhcpsrv/lease.h>
 #include <dhcpsrv/subnet_id.h>
 
+#include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/indexed_by.hpp>
 #include <boost/multi_index/member.hpp>
 #include <boost/multi_index/mem_fun.hpp>
@@ -18,6 +19,8 @@
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/composite_key.hpp>
 
+#include <array>
+#include <mutex>
 #include <vector>
 
 namespace isc {
@@ -27,21 +30,27 @@ namespace dhcp {
 /// @brief Tag for indexes by address.
 struct AddressIndexTag { };
 
+/// @brief Tag for hashed indexes by address.
+struct AddressHashIndexTag { };
+
 /// @brief Tag for indexes by DUID, IAID, lease type tuple.
 struct DuidIaidTypeIndexTag { };
 
 /// @brief Tag for indexes by expiration time.
 struct ExpirationIndexTag { };
 
+/// @brief Tag for indexes by HW address.
+struct HWAddressIndexTag { };
+
+/// @brief Tag for indexes by client identifier.
+struct ClientIdIndexTag { };
+
 /// @brief Tag for indexes by HW address, subnet identifier tuple.
 struct HWAddressSubnetIdIndexTag { };
 
 /// @brief Tag for indexes by client and subnet identifiers.
 struct ClientIdSubnetIdIndexTag { };
 
-/// @brief Tag for indexes by client id, HW address and subnet id.
-struct ClientIdHWAddressSubnetIdIndexTag { };
-
 /// @brief Tag for indexs by subnet-id.
 struct SubnetIdIndexTag { };
 
@@ -58,12 +67,20 @@ struct HostnameIndexTag { };
 /// @brief A multi index container holding DHCPv6 leases.
 ///
 /// The leases in the container may be accessed using different indexes:
-/// - using an IPv6 address,
-/// - using a composite index: DUID, IAID and lease type.
+/// - using an IPv6 address, in ascending order,
+/// - using an IPv6 address, hashed for the point lookups,
 /// - using a composite index: boolean flag indicating if the state is
-///   "expired-reclaimed" and expiration time.
+///   "expired-reclaimed" and expiration time,
+/// - using a subnet id,
+/// - using a hostname.
+///
+/// The index used for the point lookups by address is hashed. The ordered
+/// indexes are kept where a range is needed: the pages of leases, the
+/// lease file written in address order, the expired leases and the leases
+/// of a subnet. The leases are found by DUID in a
+/// @c Lease6DuidStorage.
 ///
-/// Indexes can be accessed using the index number (from 0 to 2) or a
+/// Indexes can be accessed using the index number (from 0 to 4) or a
 /// name tag. It is recommended to use the tags to access indexes as
 /// they do not depend on the order of indexes in the container.
 typedef boost::multi_index_container<
@@ -79,21 +96,10 @@ typedef boost::multi_index_container<
         >,
 
         // Specification of the second index starts here.
-        boost::multi_index::ordered_non_unique<
-            boost::multi_index::tag<DuidIaidTypeIndexTag>,
-            // This is a composite index that will be used to search for
-            // the lease using three attributes: DUID, IAID and lease type.
-            boost::multi_index::composite_key<
-                Lease6,
-                // The DUID can be retrieved from the Lease6 object using
-                // a getDuidVector const function.
-                boost::multi_index::const_mem_fun<Lease6, const std::vector<uint8_t>&,
-                                                  &Lease6::getDuidVector>,
-                // The two other ingredients of this index are IAID and
-                // lease type.
-                boost::multi_index::member<Lease6, uint32_t, &Lease6::iaid_>,
-                boost::multi_index::member<Lease6, Lease::Type, &Lease6::type_>
-            >
+        // This index hashes leases by IPv6 addresses.
+        boost::multi_index::hashed_unique<
+            boost::multi_index::tag<AddressHashIndexTag>,
+            boost::multi_index::member<Lease, isc::asiolink::IOAddress, &Lease::addr_>
         >,
 
         // Specification of the third index starts here.
@@ -123,15 +129,6 @@ typedef boost::multi_index_container<
         >,
 
         // Specification of the fifth index starts here
-        // This index is used to retrieve leases for matching duid.
-        boost::multi_index::ordered_non_unique<
-            boost::multi_index::tag<DuidIndexTag>,
-            boost::multi_index::const_mem_fun<Lease6,
-                                              const std::vector<uint8_t>&,
-                                              &Lease6::getDuidVector>
-        >,
-
-        // Specification of the sixth index starts here
         // This index is used to retrieve leases for matching hostname.
         boost::multi_index::ordered_non_unique<
             boost::multi_index::tag<HostnameIndexTag>,
@@ -143,12 +140,19 @@ typedef boost::multi_index_container<
 /// @brief A multi index container holding DHCPv4 leases.
 ///
 /// The leases in the container may be accessed using different indexes:
-/// - IPv6 address,
-/// - composite index: HW address and subnet id,
-/// - composite index: client id and subnet id,
-/// - composite index: HW address, client id and subnet id
+/// - IPv4 address, in ascending order,
+/// - IPv4 address, hashed for the point lookups,
 /// - using a composite index: boolean flag indicating if the state is
-///   "expired-reclaimed" and expiration time.
+///   "expired-reclaimed" and expiration time,
+/// - subnet id,
+/// - hostname.
+///
+/// The index used for the point lookups by address is hashed. The ordered
+/// indexes are kept where a range is needed: the pages of leases, the
+/// lease file written in address order, the expired leases and the leases
+/// of a subnet. The leases are found by HW address in a
+/// @c Lease4HWAddressStorage and by client id in a
+/// @c Lease4ClientIdStorage.
 ///
 /// Indexes can be accessed using the index number (from 0 to 4) or a
 /// name tag. It is recommended to use the tags to access indexes as
@@ -169,65 +173,13 @@ typedef boost::multi_index_container<
         >,
 
         // Specification of the second index starts here.
-        boost::multi_index::ordered_non_unique<
-            boost::multi_index::tag<HWAddressSubnetIdIndexTag>,
-            // This is a composite index that combines two attributes of the
-            // Lease4 object: hardware address and subnet id.
-            boost::multi_index::composite_key<
-                Lease4,
-                // The hardware address is held in the hwaddr_ member of the
-                // Lease4 object, which is a HWAddr object. Boost does not
-                // provide a key extractor for getting a member of a member,
-                // so we need a simple method for that.
-                boost::multi_index::const_mem_fun<Lease, const std::vector<uint8_t>&,
-                                                  &Lease::getHWAddrVector>,
-                // The subnet id is held in the subnet_id_ member of Lease4
-                // class. Note that the subnet_id_ is defined in the base
-                // class (Lease) so we have to point to this class rather
-                // than derived class: Lease4.
-                boost::multi_index::member<Lease, SubnetID, &Lease::subnet_id_>
-            >
+        // This index hashes leases by IPv4 addresses.
+        boost::multi_index::hashed_unique<
+            boost::multi_index::tag<AddressHashIndexTag>,
+            boost::multi_index::member<Lease, isc::asiolink::IOAddress, &Lease::addr_>
         >,
 
         // Specification of the third index starts here.
-        boost::multi_index::ordered_non_unique<
-            boost::multi_index::tag<ClientIdSubnetIdIndexTag>,
-            // This is a composite index that uses two values to search for a
-            // lease: client id and subnet id.
-            boost::multi_index::composite_key<
-                Lease4,
-                // The client id can be retrieved from the Lease4 object by
-                // calling getClientIdVector const function.
-                boost::multi_index::const_mem_fun<Lease4, const std::vector<uint8_t>&,
-                                                  &Lease4::getClientIdVector>,
-                // The subnet id is accessed through the subnet_id_ member.
-                boost::multi_index::member<Lease, uint32_t, &Lease::subnet_id_>
-            >
-        >,
-
-        // Specification of the fourth index starts here.
-        boost::multi_index::ordered_non_unique<
-            boost::multi_index::tag<ClientIdHWAddressSubnetIdIndexTag>,
-            // This is a composite index that uses three values to search for a
-            // lease: client id, HW address and subnet id.
-            boost::multi_index::composite_key<
-                Lease4,
-                // The client id can be retrieved from the Lease4 object by
-                // calling getClientIdVector const function.
-                boost::multi_index::const_mem_fun<Lease4, const std::vector<uint8_t>&,
-                                                  &Lease4::getClientIdVector>,
-                // The hardware address is held in the hwaddr_ object. We can
-                // access the raw data using lease->hwaddr_->hwaddr_, but Boost
-                // doesn't seem to provide a way to use member of a member for this,
-                // so we need a simple key extractor method (getHWAddrVector).
-                boost::multi_index::const_mem_fun<Lease, const std::vector<uint8_t>&,
-                                                  &Lease::getHWAddrVector>,
-                // The subnet id is accessed through the subnet_id_ member.
-                boost::multi_index::member<Lease, SubnetID, &Lease::subnet_id_>
-            >
-        >,
-
-        // Specification of the fifth index starts here.
         boost::multi_index::ordered_non_unique<
             boost::multi_index::tag<ExpirationIndexTag>,
             // This is a composite index that will be used to search for
@@ -245,15 +197,14 @@ typedef boost::multi_index_container<
             >
         >,
 
-        // Specification of the sixth index starts here.
+        // Specification of the fourth index starts here.
         // This index sorts leases by SubnetID.
         boost::multi_index::ordered_non_unique<
             boost::multi_index::tag<SubnetIdIndexTag>,
             boost::multi_index::member<Lease, isc::dhcp::SubnetID, &Lease::subnet_id_>
         >,
 
-
-        // Specification of the seventh index starts here
+        // Specification of the fifth index starts here
         // This index is used to retrieve leases for matching hostname.
         boost::multi_index::ordered_non_unique<
             boost::multi_index::tag<HostnameIndexTag>,
@@ -262,6 +213,154 @@ typedef boost::multi_index_container<
     >
 > Lease4Storage; // Specify the type name for this container.
 
+/// @brief A multi index container finding DHCPv6 leases by DUID.
+///
+/// It holds the same leases as the @c Lease6Storage, split in shards by
+/// the hash of the DUID rather than by the hash of the address, so the
+/// leases of a client are found in one shard. The leases may be accessed
+/// using:
+/// - the DUID,
+/// - a composite index: DUID, IAID and lease type,
+/// - the address.
+typedef boost::multi_index_container<
+    // It holds pointers to Lease6 objects.
+    Lease6Ptr,
+    boost::multi_index::indexed_by<
+        // Specification of the first index starts here.
+        // This index is used to retrieve leases for matching duid.
+        boost::multi_index::hashed_non_unique<
+            boost::multi_index::tag<DuidIndexTag>,
+            boost::multi_index::const_mem_fun<Lease6,
+                                              const std::vector<uint8_t>&,
+                                              &Lease6::getDuidVector>
+        >,
+
+        // Specification of the second index starts here.
+        boost::multi_index::hashed_non_unique<
+            boost::multi_index::tag<DuidIaidTypeIndexTag>,
+            // This is a composite index that will be used to search for
+            // the lease using three attributes: DUID, IAID and lease type.
+            boost::multi_index::composite_key<
+                Lease6,
+                // The DUID can be retrieved from the Lease6 object using
+                // a getDuidVector const function.
+                boost::multi_index::const_mem_fun<Lease6, const std::vector<uint8_t>&,
+                                                  &Lease6::getDuidVector>,
+                // The two other ingredients of this index are IAID and
+                // lease type.
+                boost::multi_index::member<Lease6, uint32_t, &Lease6::iaid_>,
+                boost::multi_index::member<Lease6, Lease::Type, &Lease6::type_>
+            >
+        >,
+
+        // Specification of the third index starts here.
+        // This index finds the stored lease to remove or replace among
+        // the leases sharing a key, e.g. the leases without DUID.
+        boost::multi_index::hashed_unique<
+            boost::multi_index::tag<AddressHashIndexTag>,
+            boost::multi_index::member<Lease, isc::asiolink::IOAddress, &Lease::addr_>
+        >
+    >
+> Lease6DuidStorage; // Specify the type name of this container.
+
+/// @brief A multi index container finding DHCPv4 leases by HW address.
+///
+/// It holds the same leases as the @c Lease4Storage, split in shards by
+/// the hash of the HW address. The leases may be accessed using:
+/// - the HW address,
+/// - a composite index: HW address and subnet id,
+/// - the address.
+///
+/// The lease of a HW address in a subnet is found with the composite
+/// index: the leases without HW address, e.g. the declined leases, share
+/// the same empty HW address, so they are not all scanned to find the
+/// lease in a subnet. For the same reason a lease is removed or replaced
+/// using the index by address.
+typedef boost::multi_index_container<
+    // It holds pointers to Lease4 objects.
+    Lease4Ptr,
+    boost::multi_index::indexed_by<
+        // Specification of the first index starts here.
+        boost::multi_index::hashed_non_unique<
+            boost::multi_index::tag<HWAddressIndexTag>,
+            // The hardware address is held in the hwaddr_ member of the
+            // Lease4 object, which is a HWAddr object. Boost does not
+            // provide a key extractor for getting a member of a member,
+            // so we need a simple method for that.
+            boost::multi_index::const_mem_fun<Lease, const std::vector<uint8_t>&,
+                                              &Lease::getHWAddrVector>
+        >,
+
+        // Specification of the second index starts here.
+        boost::multi_index::hashed_non_unique<
+            boost::multi_index::tag<HWAddressSubnetIdIndexTag>,
+            // This is a composite index that combines two attributes of the
+            // Lease4 object: hardware address and subnet id.
+            boost::multi_index::composite_key<
+                Lease4,
+                boost::multi_index::const_mem_fun<Lease, const std::vector<uint8_t>&,
+                                                  &Lease::getHWAddrVector>,
+                // The subnet id is held in the subnet_id_ member of Lease4
+                // class. Note that the subnet_id_ is defined in the base
+                // class (Lease) so we have to point to this class rather
+                // than derived class: Lease4.
+                boost::multi_index::member<Lease, SubnetID, &Lease::subnet_id_>
+            >
+        >,
+
+        // Specification of the third index starts here.
+        // This index finds the stored lease to remove or replace among
+        // the leases sharing a key, e.g. the leases without HW address.
+        boost::multi_index::hashed_unique<
+            boost::multi_index::tag<AddressHashIndexTag>,
+            boost::multi_index::member<Lease, isc::asiolink::IOAddress, &Lease::addr_>
+        >
+    >
+> Lease4HWAddressStorage; // Specify the type name for this container.
+
+/// @brief A multi index container finding DHCPv4 leases by client id.
+///
+/// It holds the same leases as the @c Lease4Storage, split in shards by
+/// the hash of the client id. The leases may be accessed using:
+/// - the client id,
+/// - a composite index: client id and subnet id,
+/// - the address.
+typedef boost::multi_index_container<
+    // It holds pointers to Lease4 objects.
+    Lease4Ptr,
+    boost::multi_index::indexed_by<
+        // Specification of the first index starts here.
+        boost::multi_index::hashed_non_unique<
+            boost::multi_index::tag<ClientIdIndexTag>,
+            // The client id can be retrieved from the Lease4 object by
+            // calling getClientIdVector const function.
+            boost::multi_index::const_mem_fun<Lease4, const std::vector<uint8_t>&,
+                                              &Lease4::getClientIdVector>
+        >,
+
+        // Specification of the second index starts here.
+        boost::multi_index::hashed_non_unique<
+            boost::multi_index::tag<ClientIdSubnetIdIndexTag>,
+            // This is a composite index that combines two attributes of the
+            // Lease4 object: client id and subnet id.
+            boost::multi_index::composite_key<
+                Lease4,
+                boost::multi_index::const_mem_fun<Lease4, const std::vector<uint8_t>&,
+                                                  &Lease4::getClientIdVector>,
+                boost::multi_index::member<Lease, SubnetID, &Lease::subnet_id_>
+            >
+        >,
+
+        // Specification of the third index starts here.
+        // This index finds the stored lease to remove or replace among
+        // the leases sharing a key, e.g. the leases without client id.
+        boost::multi_index::hashed_unique<
+            boost::multi_index::tag<AddressHashIndexTag>,
+            boost::multi_index::member<Lease, isc::asiolink::IOAddress, &Lease::addr_>
+        >
+    >
+> Lease4ClientIdStorage; // Specify the type name for this container.
+
 //@}
 
 /// @name Indexes used by the multi index containers
@@ -271,8 +370,11 @@ typedef boost::multi_index_container<
 /// @brief DHCPv6 lease storage index by address.
 typedef Lease6Storage::index<AddressIndexTag>::type Lease6StorageAddressIndex;
 
+/// @brief DHCPv6 lease storage hashed index by address.
+typedef Lease6Storage::index<AddressHashIndexTag>::type Lease6StorageAddressHashIndex;
+
 /// @brief DHCPv6 lease storage index by DUID, IAID, lease type.
-typedef Lease6Storage::index<DuidIaidTypeIndexTag>::type Lease6StorageDuidIaidTypeIndex;
+typedef Lease6DuidStorage::index<DuidIaidTypeIndexTag>::type Lease6StorageDuidIaidTypeIndex;
 
 /// @brief DHCPv6 lease storage index by expiration time.
 typedef Lease6Storage::index<ExpirationIndexTag>::type Lease6StorageExpirationIndex;
@@ -280,8 +382,8 @@ typedef Lease6Storage::index<ExpirationIndexTag>::type Lease6StorageExpirationIn
 /// @brief DHCPv6 lease storage index by Subnet-id.
 typedef Lease6Storage::index<SubnetIdIndexTag>::type Lease6StorageSubnetIdIndex;
 
-/// @brief DHCPv6 lease storage index by Subnet-id.
-typedef Lease6Storage::index<DuidIndexTag>::type Lease6StorageDuidIndex;
+/// @brief DHCPv6 lease storage index by DUID.
+typedef Lease6DuidStorage::index<DuidIndexTag>::type Lease6StorageDuidIndex;
 
 /// @brief DHCPv6 lease storage index by hostname.
 typedef Lease6Storage::index<HostnameIndexTag>::type Lease6StorageHostnameIndex;
@@ -289,27 +391,85 @@ typedef Lease6Storage::index<HostnameIndexTag>::type Lease6StorageHostnameIndex;
 /// @brief DHCPv4 lease storage index by address.
 typedef Lease4Storage::index<AddressIndexTag>::type Lease4StorageAddressIndex;
 
+/// @brief DHCPv4 lease storage hashed index by address.
+typedef Lease4Storage::index<AddressHashIndexTag>::type Lease4StorageAddressHashIndex;
+
 /// @brief DHCPv4 lease storage index by expiration time.
 typedef Lease4Storage::index<ExpirationIndexTag>::type Lease4StorageExpirationIndex;
 
+/// @brief DHCPv4 lease storage index by HW address.
+typedef Lease4HWAddressStorage::index<HWAddressIndexTag>::type Lease4StorageHWAddressIndex;
+
 /// @brief DHCPv4 lease storage index by HW address and subnet identifier.
-typedef Lease4Storage::index<HWAddressSubnetIdIndexTag>::type
+typedef Lease4HWAddressStorage::index<HWAddressSubnetIdIndexTag>::type
 Lease4StorageHWAddressSubnetIdIndex;
 
+/// @brief DHCPv4 lease storage index by client identifier.
+typedef Lease4ClientIdStorage::index<ClientIdIndexTag>::type Lease4StorageClientIdIndex;
+
 /// @brief DHCPv4 lease storage index by client and subnet identifier.
-typedef Lease4Storage::index<ClientIdSubnetIdIndexTag>::type
+typedef Lease4ClientIdStorage::index<ClientIdSubnetIdIndexTag>::type
 Lease4StorageClientIdSubnetIdIndex;
 
-/// @brief DHCPv4 lease storage index by client id, HW address and subnet id.
-typedef Lease4Storage::index<ClientIdHWAddressSubnetIdIndexTag>::type
-Lease4StorageClientIdHWAddressSubnetIdIndex;
-
-/// @brief DHCPv4 lease storage index by client id, HW address and subnet id.
+/// @brief DHCPv4 lease storage index by subnet id.
 typedef Lease4Storage::index<SubnetIdIndexTag>::type Lease4StorageSubnetIdIndex;
 
 /// @brief DHCPv4 lease storage index by hostname.
 typedef Lease4Storage::index<HostnameIndexTag>::type Lease4StorageHostnameIndex;
 
+//@}
+
+/// @name Lease storage shards
+///
+//@{
+
+/// @brief Number of shards the lease storage of a backend is split in.
+const size_t LEASE_STORAGE_SHARD_COUNT = 16;
+
+/// @brief A lease storage shard.
+///
+/// The leases are assigned to the shards of a @c Lease4Storage or
+/// @c Lease6Storage by the hash of their address, and to the shards of
+/// the storages finding them by HW address, client id or DUID by the hash
+/// of this key. Each shard has its own mutex, so in multi threading mode
+/// the lease changes of different addresses and the lookups of different
+/// clients usually lock different shards.
+///
+/// @tparam StorageType Type of the lease storage, e.g. @c Lease4Storage
+/// or @c Lease4HWAddressStorage.
+template<typename StorageType>
+struct LeaseStorageShard {
+    /// @brief The leases which key is hashed to this shard.
+    StorageType storage_;
+
+    /// @brief Mutex protecting the storage of this shard.
+    mutable std::mutex mutex_;
+};
+
+/// @brief DHCPv4 lease storage shard.
+typedef LeaseStorageShard<Lease4Storage> Lease4StorageShard;
+
+/// @brief DHCPv4 lease storage split in shards by address.
+typedef std::array<Lease4StorageShard, LEASE_STORAGE_SHARD_COUNT> Lease4StorageShards;
+
+/// @brief DHCPv4 lease storage by HW address split in shards.
+typedef std::array<LeaseStorageShard<Lease4HWAddressStorage>,
+                   LEASE_STORAGE_SHARD_COUNT> Lease4HWAddressStorageShards;
+
+/// @brief DHCPv4 lease storage by client id split in shards.
+typedef std::array<LeaseStorageShard<Lease4ClientIdStorage>,
+                   LEASE_STORAGE_SHARD_COUNT> Lease4ClientIdStorageShards;
+
+/// @brief DHCPv6 lease storage shard.
+typedef LeaseStorageShard<Lease6Storage> Lease6StorageShard;
+
+/// @brief DHCPv6 lease storage split in shards by address.
+typedef std::array<Lease6StorageShard, LEASE_STORAGE_SHARD_COUNT> Lease6StorageShards;
+
+/// @brief DHCPv6 lease storage by DUID split in shards.
+typedef std::array<LeaseStorageShard<Lease6DuidStorage>,
+                   LEASE_STORAGE_SHARD_COUNT> Lease6DuidStorageShards;
+
 //@}
 } // end of isc::dhcp namespace
 } // end of isc namespace
@@ -122,6 +122,13 @@ tagged_statements = { {
                         "state, user_context "
                             "FROM lease4 "
                             "WHERE address = ?"},
+    {MySqlLeaseMgr::GET_LEASE4_CLIENT,
+                    "SELECT address, hwaddr, client_id, "
+                        "valid_lifetime, expire, subnet_id, "
+                        "fqdn_fwd, fqdn_rev, hostname, "
+                        "state, user_context "
+                            "FROM lease4 "
+                            "WHERE hwaddr = ? OR client_id = ? OR address = ?"},
     {MySqlLeaseMgr::GET_LEASE4_CLIENTID,
                     "SELECT address, hwaddr, client_id, "
                         "valid_lifetime, expire, subnet_id, "
@@ -2319,6 +2326,71 @@ MySqlLeaseMgr::getLease4(const ClientId& clientid, SubnetID subnet_id) const {
     return (result);
 }
 
+Lease4Collection
+MySqlLeaseMgr::getClientLeases4(const HWAddrPtr& hwaddr,
+                                const ClientIdPtr& client_id,
+                                const IOAddress& addr) const {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_GET_CLIENT_LEASES4)
+        .arg(hwaddr ? hwaddr->toText() : "(none)")
+        .arg(client_id ? client_id->toText() : "(none)")
+        .arg(addr.toText());
+
+    // Set up the WHERE clause values. A missing HW address or client
+    // identifier is bound as NULL so it matches no lease.
+    MYSQL_BIND inbind[3];
+    memset(inbind, 0, sizeof(inbind));
+
+    std::vector<uint8_t> hwaddr_data;
+    unsigned long hwaddr_length = 0;
+    if (hwaddr) {
+        hwaddr_data = hwaddr->hwaddr_;
+        hwaddr_length = hwaddr_data.size();
+        // If the data happens to be empty, we have to create a 1 byte dummy
+        // buffer and pass it to the binding.
+        if (hwaddr_data.empty()) {
+            hwaddr_data.resize(1);
+        }
+        inbind[0].buffer_type = MYSQL_TYPE_BLOB;
+        inbind[0].buffer = reinterpret_cast<char*>(&hwaddr_data[0]);
+        inbind[0].buffer_length = hwaddr_length;
+        inbind[0].length = &hwaddr_length;
+    } else {
+        inbind[0].buffer_type = MYSQL_TYPE_NULL;
+    }
+
+    std::vector<uint8_t> client_data;
+    unsigned long client_data_length = 0;
+    if (client_id) {
+        client_data = client_id->getClientId();
+        client_data_length = client_data.size();
+        if (client_data.empty()) {
+            client_data.resize(1);
+        }
+        inbind[1].buffer_type = MYSQL_TYPE_BLOB;
+        inbind[1].buffer = reinterpret_cast<char*>(&client_data[0]);
+        inbind[1].buffer_length = client_data_length;
+        inbind[1].length = &client_data_length;
+    } else {
+        inbind[1].buffer_type = MYSQL_TYPE_NULL;
+    }
+
+    uint32_t addr4 = addr.toUint32();
+    inbind[2].buffer_type = MYSQL_TYPE_LONG;
+    inbind[2].buffer = reinterpret_cast<char*>(&addr4);
+    inbind[2].is_unsigned = MLM_TRUE;
+
+    // Get the data
+    Lease4Collection result;
+
+    // Get a context
+    MySqlLeaseContextAlloc get_context(*this);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
+    getLeaseCollection(ctx, GET_LEASE4_CLIENT, inbind, result);
+
+    return (result);
+}
+
 Lease4Collection
 MySqlLeaseMgr::getLeases4(SubnetID subnet_id) const {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_GET_SUBID4)
@@ -2821,8 +2893,6 @@ MySqlLeaseMgr::updateLeaseCommon(MySqlLeaseContextPtr& ctx,
 
 void
 MySqlLeaseMgr::updateLease4(const Lease4Ptr& lease) {
-    const StatementIndex stindex = UPDATE_LEASE4;
-
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_UPDATE_ADDR4)
         .arg(lease->addr_.toText());
 
@@ -2830,6 +2900,17 @@ MySqlLeaseMgr::updateLease4(const Lease4Ptr& lease) {
     MySqlLeaseContextAlloc get_context(*this);
     MySqlLeaseContextPtr ctx = get_context.ctx_;
 
+    updateLease4Internal(ctx, lease);
+
+    // Update lease current expiration time.
+    lease->updateCurrentExpirationTime();
+}
+
+void
+MySqlLeaseMgr::updateLease4Internal(MySqlLeaseContextPtr& ctx,
+                                    const Lease4Ptr& lease) {
+    const StatementIndex stindex = UPDATE_LEASE4;
+
     // Create the MYSQL_BIND array for the data being updated
     std::vector<MYSQL_BIND> bind = ctx->exchange4_->createBindForSend(lease);
 
@@ -2856,15 +2937,10 @@ MySqlLeaseMgr::updateLease4(const Lease4Ptr& lease) {
 
     // Drop to common update code
     updateLeaseCommon(ctx, stindex, &bind[0], lease);
-
-    // Update lease current expiration time.
-    lease->updateCurrentExpirationTime();
 }
 
 void
 MySqlLeaseMgr::updateLease6(const Lease6Ptr& lease) {
-    const StatementIndex stindex = UPDATE_LEASE6;
-
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_UPDATE_ADDR6)
         .arg(lease->addr_.toText())
         .arg(lease->type_);
@@ -2873,6 +2949,17 @@ MySqlLeaseMgr::updateLease6(const Lease6Ptr& lease) {
     MySqlLeaseContextAlloc get_context(*this);
     MySqlLeaseContextPtr ctx = get_context.ctx_;
 
+    updateLease6Internal(ctx, lease);
+
+    // Update lease current expiration time.
+    lease->updateCurrentExpirationTime();
+}
+
+void
+MySqlLeaseMgr::updateLease6Internal(MySqlLeaseContextPtr& ctx,
+                                    const Lease6Ptr& lease) {
+    const StatementIndex stindex = UPDATE_LEASE6;
+
     // Create the MYSQL_BIND array for the data being updated
     std::vector<MYSQL_BIND> bind = ctx->exchange6_->createBindForSend(lease);
 
@@ -2904,9 +2991,6 @@ MySqlLeaseMgr::updateLease6(const Lease6Ptr& lease) {
 
     // Drop to common update code
     updateLeaseCommon(ctx, stindex, &bind[0], lease);
-
-    // Update lease current expiration time.
-    lease->updateCurrentExpirationTime();
 }
 
 // Delete lease methods.  Similar to other groups of methods, these comprise
@@ -2915,13 +2999,9 @@ MySqlLeaseMgr::updateLease6(const Lease6Ptr& lease) {
 // handles the common processing.
 
 uint64_t
-MySqlLeaseMgr::deleteLeaseCommon(StatementIndex stindex,
+MySqlLeaseMgr::deleteLeaseCommon(MySqlLeaseContextPtr& ctx,
+                                 StatementIndex stindex,
                                  MYSQL_BIND* bind) {
-
-    // Get a context
-    MySqlLeaseContextAlloc get_context(*this);
-    MySqlLeaseContextPtr ctx = get_context.ctx_;
-
     // Bind the input parameters to the statement
     int status = mysql_stmt_bind_param(ctx->conn_.statements_[stindex], bind);
     checkError(ctx, status, stindex, "unable to bind WHERE clause parameter");
@@ -2937,9 +3017,20 @@ MySqlLeaseMgr::deleteLeaseCommon(StatementIndex stindex,
 
 bool
 MySqlLeaseMgr::deleteLease(const Lease4Ptr& lease) {
-    const IOAddress& addr = lease->addr_;
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_DELETE_ADDR)
-        .arg(addr.toText());
+        .arg(lease->addr_.toText());
+
+    // Get a context
+    MySqlLeaseContextAlloc get_context(*this);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
+    return (deleteLeaseInternal(ctx, lease));
+}
+
+bool
+MySqlLeaseMgr::deleteLeaseInternal(MySqlLeaseContextPtr& ctx,
+                                   const Lease4Ptr& lease) {
+    const IOAddress& addr = lease->addr_;
 
     // Set up the WHERE clause value
     MYSQL_BIND inbind[2];
@@ -2959,7 +3050,7 @@ MySqlLeaseMgr::deleteLease(const Lease4Ptr& lease) {
     inbind[1].buffer = reinterpret_cast<char*>(&expire);
     inbind[1].buffer_length = sizeof(expire);
 
-    auto affected_rows = deleteLeaseCommon(DELETE_LEASE4, inbind);
+    auto affected_rows = deleteLeaseCommon(ctx, DELETE_LEASE4, inbind);
 
     // Check success case first as it is the most likely outcome.
     if (affected_rows == 1) {
@@ -2979,10 +3070,21 @@ MySqlLeaseMgr::deleteLease(const Lease4Ptr& lease) {
 
 bool
 MySqlLeaseMgr::deleteLease(const Lease6Ptr& lease) {
-    const IOAddress& addr = lease->addr_;
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MYSQL_DELETE_ADDR)
-        .arg(addr.toText());
+        .arg(lease->addr_.toText());
+
+    // Get a context
+    MySqlLeaseContextAlloc get_context(*this);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
+    return (deleteLeaseInternal(ctx, lease));
+}
+
+bool
+MySqlLeaseMgr::deleteLeaseInternal(MySqlLeaseContextPtr& ctx,
+                                   const Lease6Ptr& lease) {
+    const IOAddress& addr = lease->addr_;
 
     // Set up the WHERE clause value
     MYSQL_BIND inbind[2];
@@ -3006,7 +3108,7 @@ MySqlLeaseMgr::deleteLease(const Lease6Ptr& lease) {
     inbind[1].buffer = reinterpret_cast<char*>(&expire);
     inbind[1].buffer_length = sizeof(expire);
 
-    auto affected_rows = deleteLeaseCommon(DELETE_LEASE6, inbind);
+    auto affected_rows = deleteLeaseCommon(ctx, DELETE_LEASE6, inbind);
 
     // Check success case first as it is the most likely outcome.
     if (affected_rows == 1) {
@@ -3024,6 +3126,62 @@ MySqlLeaseMgr::deleteLease(const Lease6Ptr& lease) {
               "that had the address " << lease->addr_.toText());
 }
 
+void
+MySqlLeaseMgr::updateLeases4(const Lease4Collection& updated_leases,
+                             const Lease4Collection& deleted_leases) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_UPDATE_LEASES4)
+        .arg(updated_leases.size())
+        .arg(deleted_leases.size());
+
+    // Get a context
+    MySqlLeaseContextAlloc get_context(*this);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
+    // Execute all the operations on the connection of the context within
+    // a single transaction. It is rolled back when an operation throws.
+    MySqlTransaction transaction(ctx->conn_);
+    for (auto const& lease : updated_leases) {
+        updateLease4Internal(ctx, lease);
+    }
+    for (auto const& lease : deleted_leases) {
+        static_cast<void>(deleteLeaseInternal(ctx, lease));
+    }
+    transaction.commit();
+
+    // Update the leases current expiration time once they are committed.
+    for (auto const& lease : updated_leases) {
+        lease->updateCurrentExpirationTime();
+    }
+}
+
+void
+MySqlLeaseMgr::updateLeases6(const Lease6Collection& updated_leases,
+                             const Lease6Collection& deleted_leases) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_UPDATE_LEASES6)
+        .arg(updated_leases.size())
+        .arg(deleted_leases.size());
+
+    // Get a context
+    MySqlLeaseContextAlloc get_context(*this);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
+    // Execute all the operations on the connection of the context within
+    // a single transaction. It is rolled back when an operation throws.
+    MySqlTransaction transaction(ctx->conn_);
+    for (auto const& lease : updated_leases) {
+        updateLease6Internal(ctx, lease);
+    }
+    for (auto const& lease : deleted_leases) {
+        static_cast<void>(deleteLeaseInternal(ctx, lease));
+    }
+    transaction.commit();
+
+    // Update the leases current expiration time once they are committed.
+    for (auto const& lease : updated_leases) {
+        lease->updateCurrentExpirationTime();
+    }
+}
+
 uint64_t
 MySqlLeaseMgr::deleteExpiredReclaimedLeases4(const uint32_t secs) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_DELETE_EXPIRED_RECLAIMED4)
@@ -3041,6 +3199,10 @@ MySqlLeaseMgr::deleteExpiredReclaimedLeases6(const uint32_t secs) {
 uint64_t
 MySqlLeaseMgr::deleteExpiredReclaimedLeasesCommon(const uint32_t secs,
                                                   StatementIndex statement_index) {
+    // Get a context
+    MySqlLeaseContextAlloc get_context(*this);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
     // Set up the WHERE clause value
     MYSQL_BIND inbind[2];
     memset(inbind, 0, sizeof(inbind));
@@ -3059,7 +3221,7 @@ MySqlLeaseMgr::deleteExpiredReclaimedLeasesCommon(const uint32_t secs,
     inbind[1].buffer_length = sizeof(expire_time);
 
     // Get the number of deleted leases and log it.
-    uint64_t deleted_leases = deleteLeaseCommon(statement_index, inbind);
+    uint64_t deleted_leases = deleteLeaseCommon(ctx, statement_index, inbind);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_DELETED_EXPIRED_RECLAIMED)
         .arg(deleted_leases);
 
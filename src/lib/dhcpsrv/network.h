@@ -189,7 +189,7 @@ public:
           ddns_replace_client_name_mode_(), ddns_generated_prefix_(), ddns_qualifying_suffix_(),
           hostname_char_set_(), hostname_char_replacement_(), store_extended_info_(),
           cache_threshold_(), cache_max_age_(), ddns_update_on_renew_(),
-          ddns_use_conflict_resolution_() {
+          ddns_use_conflict_resolution_(), allocator_type_() {
     }
 
     /// @brief Virtual destructor.
@@ -737,6 +737,24 @@ public:
         ddns_use_conflict_resolution_ = ddns_use_conflict_resolution;
     }
 
+    /// @brief Returns allocator type.
+    ///
+    /// @param inheritance inheritance mode to be used.
+    util::Optional<std::string>
+    getAllocatorType(const Inheritance& inheritance = Inheritance::ALL) const {
+        return (getProperty<Network>(&Network::getAllocatorType,
+                                     allocator_type_,
+                                     inheritance, "allocator"));
+    }
+
+    /// @brief Sets new allocator type.
+    ///
+    /// @param allocator_type New allocator type: iterative, random, hashed
+    /// or flq.
+    void setAllocatorType(const util::Optional<std::string>& allocator_type) {
+        allocator_type_ = allocator_type;
+    }
+
     /// @brief Unparses network object.
     ///
     /// @return A pointer to unparsed network configuration.
@@ -1121,6 +1139,9 @@ protected:
     /// @brief Used to to tell kea-dhcp-ddns whether or not to use conflict resolution.
     util::Optional<bool> ddns_use_conflict_resolution_;
 
+    /// @brief Lease allocation algorithm used for the network.
+    util::Optional<std::string> allocator_type_;
+
     /// @brief Pointer to another network that this network belongs to.
     ///
     /// The most common case is that this instance is a subnet which belongs
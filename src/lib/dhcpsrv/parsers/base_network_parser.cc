@@ -247,6 +247,26 @@ BaseNetworkParser::parseCacheParams(const ConstElementPtr& network_data,
     }
 }
 
+void
+BaseNetworkParser::parseAllocatorParams(const ConstElementPtr& network_data,
+                                        NetworkPtr& network) {
+    if (network_data->contains("allocator")) {
+        network->setAllocatorType(getAllocatorType(network_data));
+    }
+}
+
+std::string
+BaseNetworkParser::getAllocatorType(const ConstElementPtr& scope) {
+    std::string allocator = getString(scope, "allocator");
+    if ((allocator != "iterative") && (allocator != "random") &&
+        (allocator != "hashed") && (allocator != "flq")) {
+        isc_throw(DhcpConfigError, "unsupported allocator '" << allocator
+                  << "', expected 'iterative', 'random', 'hashed' or 'flq' ("
+                  << scope->get("allocator")->getPosition() << ")");
+    }
+    return (allocator);
+}
+
 void
 BaseNetworkParser::parseDdnsParams(const data::ConstElementPtr& network_data,
                                    NetworkPtr& network) {
@@ -27,6 +27,16 @@ public:
     /// and a flag are specified.
     static void moveReservationMode(isc::data::ElementPtr config);
 
+    /// @brief Returns the lease allocator of a scope.
+    ///
+    /// It is used for subnets, shared networks and the global scope.
+    ///
+    /// @param scope Data element holding the allocator parameter.
+    ///
+    /// @return The allocator: "iterative", "random", "hashed" or "flq".
+    /// @throw DhcpConfigError if the allocator is not supported.
+    static std::string getAllocatorType(const data::ConstElementPtr& scope);
+
 protected:
 
     /// @brief Parses DHCP lifetime.
@@ -91,6 +101,20 @@ protected:
     void parseCacheParams(const data::ConstElementPtr& network_data,
                      NetworkPtr& network);
 
+    /// @brief Parses the lease allocator of a network.
+    ///
+    /// The parsed parameter is allocator: one of "iterative", "random",
+    /// "hashed" or "flq".
+    ///
+    /// @param network_data Data element holding network configuration
+    /// to be parsed.
+    /// @param [out] network Pointer to a network in which parsed data is
+    /// to be stored.
+    ///
+    /// @throw DhcpConfigError if the allocator is not supported.
+    void parseAllocatorParams(const data::ConstElementPtr& network_data,
+                              NetworkPtr& network);
+
     /// @brief Parses parameters pertaining to DDNS behavior.
     ///
     /// The parsed parameters are:
@@ -6,6 +6,7 @@
 
 #include <config.h>
 #include <cc/data.h>
+#include <dhcp/iface_mgr.h>
 #include <dhcpsrv/cfgmgr.h>
 #include <dhcpsrv/dhcpsrv_log.h>
 #include <dhcpsrv/parsers/dhcp_queue_control_parser.h>
@@ -43,6 +44,17 @@ DHCPQueueControlParser::parse(const ConstElementPtr& control_elem) {
         }
     }
 
+    // receive-batch-size is optional. It applies to both direct and
+    // queued reception so it is checked whether the queue is enabled or not.
+    if (control_elem->contains("receive-batch-size")) {
+        try {
+            getInteger(control_elem, "receive-batch-size", 1,
+                       IfaceMgr::MAX_RECEIVE_BATCH_SIZE);
+        } catch (const OutOfRange& ex) {
+            isc_throw(DhcpConfigError, ex.what());
+        }
+    }
+
     // Return a copy of it.
     ElementPtr result = data::copy(control_elem);
 
@@ -56,6 +56,16 @@ ExpirationConfigParser::parse(ConstElementPtr expiration_config) {
             cfg->setUnwarnedReclaimCycles(
                 getInteger(expiration_config, param));
         }
+
+        param = "reclaim-batch-size";
+        if (expiration_config->contains(param)) {
+            cfg->setReclaimBatchSize(getInteger(expiration_config, param));
+        }
+
+        param = "reclaim-threads";
+        if (expiration_config->contains(param)) {
+            cfg->setReclaimThreads(getInteger(expiration_config, param));
+        }
     } catch (const DhcpConfigError&) {
         throw;
     } catch (const std::exception& ex) {
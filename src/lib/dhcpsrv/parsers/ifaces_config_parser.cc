@@ -9,11 +9,13 @@
 #include <dhcpsrv/cfgmgr.h>
 #include <dhcpsrv/dhcpsrv_log.h>
 #include <dhcpsrv/parsers/ifaces_config_parser.h>
+#include <util/fd_event_handler.h>
 #include <boost/foreach.hpp>
 #include <string>
 #include <sys/types.h>
 
 using namespace isc::data;
+using namespace isc::util;
 
 namespace isc {
 namespace dhcp {
@@ -85,6 +87,45 @@ IfacesConfigParser::parse(const CfgIfacePtr& cfg,
                 }
             }
 
+            if (element.first == "fd-event-handler") {
+                std::string name = element.second->stringValue();
+                FDEventHandler::HandlerType type =
+                    FDEventHandler::typeFromText(name);
+                if (!FDEventHandler::isSupported(type)) {
+                    isc_throw(DhcpConfigError, "fd-event-handler '" << name
+                              << "' is not supported on this system");
+                }
+                cfg->setFDEventHandlerType(type);
+                continue;
+            }
+
+            if (element.first == "packet-mmap") {
+                if (protocol_ == AF_INET) {
+                    bool packet_mmap = element.second->boolValue();
+#if !defined (OS_LINUX)
+                    if (packet_mmap) {
+                        isc_throw(DhcpConfigError, "packet-mmap is not"
+                                  " supported on this system");
+                    }
+#endif
+                    cfg->setPacketMmap(packet_mmap);
+                    continue;
+                } else {
+                    isc_throw(DhcpConfigError,
+                              "packet-mmap is not supported in DHCPv6");
+                }
+            }
+
+            if (element.first == "socket-sharding") {
+                cfg->setSocketSharding(element.second->boolValue());
+                continue;
+            }
+
+            if (element.first == "lazy-option-unpack") {
+                cfg->setLazyOptionUnpack(element.second->boolValue());
+                continue;
+            }
+
             if (element.first == "user-context") {
                 cfg->setContext(element.second);
                 continue;
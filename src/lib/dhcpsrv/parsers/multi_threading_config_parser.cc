@@ -64,6 +64,11 @@ MultiThreadingConfigParser::parse(SrvConfig& srv_cfg,
         }
     }
 
+    // client-affinity is not mandatory
+    if (value->get("client-affinity")) {
+        static_cast<void>(getBoolean(value, "client-affinity"));
+    }
+
     srv_cfg.setDHCPMultiThreading(value);
     MultiThreadingMgr::instance().setMode(enabled);
 }
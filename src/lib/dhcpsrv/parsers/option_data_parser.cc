@@ -415,6 +415,8 @@ void OptionDataListParser::parse(const CfgOptionPtr& cfg,
         cfg->add(option.first, option.second);
         cfg->encapsulate();
     }
+    // The options are complete: pack them once for all responses.
+    cfg->createWireData();
 }
 
 } // end of namespace isc::dhcp
@@ -197,6 +197,9 @@ SharedNetwork4Parser::parse(const data::ConstElementPtr& shared_network_data) {
 
         // Parse lease cache parameters
         parseCacheParams(shared_network_data, network);
+
+        // Parse the lease allocator
+        parseAllocatorParams(shared_network_data, network);
     } catch (const DhcpConfigError&) {
         // Position was already added
         throw;
@@ -365,6 +368,9 @@ SharedNetwork6Parser::parse(const data::ConstElementPtr& shared_network_data) {
 
         // Parse lease cache parameters
         parseCacheParams(shared_network_data, network);
+
+        // Parse the lease allocator
+        parseAllocatorParams(shared_network_data, network);
     } catch (const std::exception& ex) {
         isc_throw(DhcpConfigError, ex.what() << " ("
                   << shared_network_data->getPosition() << ")");
@@ -94,7 +94,8 @@ const SimpleKeywords SimpleParser4::GLOBAL4_PARAMETERS = {
     { "cache-max-age",                  Element::integer },
     { "ip-reservations-unique",         Element::boolean },
     { "ddns-update-on-renew",           Element::boolean },
-    { "ddns-use-conflict-resolution",   Element::boolean }
+    { "ddns-use-conflict-resolution",   Element::boolean },
+    { "allocator",                      Element::string }
 };
 
 /// @brief This table defines default global values for DHCPv4
@@ -242,7 +243,8 @@ const SimpleKeywords SimpleParser4::SUBNET4_PARAMETERS = {
     { "cache-threshold",                Element::real },
     { "cache-max-age",                  Element::integer },
     { "ddns-update-on-renew",           Element::boolean },
-    { "ddns-use-conflict-resolution",   Element::boolean }
+    { "ddns-use-conflict-resolution",   Element::boolean },
+    { "allocator",                      Element::string }
 };
 
 /// @brief This table defines default values for each IPv4 subnet.
@@ -358,7 +360,8 @@ const SimpleKeywords SimpleParser4::SHARED_NETWORK4_PARAMETERS = {
     { "cache-threshold",                Element::real },
     { "cache-max-age",                  Element::integer },
     { "ddns-update-on-renew",           Element::boolean },
-    { "ddns-use-conflict-resolution",   Element::boolean }
+    { "ddns-use-conflict-resolution",   Element::boolean },
+    { "allocator",                      Element::string }
 };
 
 /// @brief This table defines default values for each IPv4 shared network.
@@ -82,6 +82,16 @@ PgSqlTaggedStatement tagged_statements[] = {
       "FROM lease4 "
       "WHERE address = $1"},
 
+    // GET_LEASE4_CLIENT
+    { 3, { OID_BYTEA, OID_BYTEA, OID_INT8 },
+      "get_lease4_client",
+      "SELECT address, hwaddr, client_id, "
+        "valid_lifetime, extract(epoch from expire)::bigint, subnet_id, "
+        "fqdn_fwd, fqdn_rev, hostname, "
+        "state, user_context "
+      "FROM lease4 "
+      "WHERE hwaddr = $1 OR client_id = $2 OR address = $3"},
+
     // GET_LEASE4_CLIENTID
     { 1, { OID_BYTEA },
       "get_lease4_clientid",
@@ -1635,6 +1645,51 @@ PgSqlLeaseMgr::getLease4(const ClientId& clientid, SubnetID subnet_id) const {
     return (result);
 }
 
+Lease4Collection
+PgSqlLeaseMgr::getClientLeases4(const HWAddrPtr& hwaddr,
+                                const ClientIdPtr& client_id,
+                                const IOAddress& addr) const {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_PGSQL_GET_CLIENT_LEASES4)
+        .arg(hwaddr ? hwaddr->toText() : "(none)")
+        .arg(client_id ? client_id->toText() : "(none)")
+        .arg(addr.toText());
+
+    // Set up the WHERE clause values. A missing HW address or client
+    // identifier is bound as NULL so it matches no lease.
+    PsqlBindArray bind_array;
+
+    // HWADDR
+    if (!hwaddr) {
+        bind_array.addNull();
+    } else if (!hwaddr->hwaddr_.empty()) {
+        bind_array.add(hwaddr->hwaddr_);
+    } else {
+        bind_array.add("");
+    }
+
+    // CLIENT_ID
+    if (client_id) {
+        bind_array.add(client_id->getClientId());
+    } else {
+        bind_array.addNull();
+    }
+
+    // LEASE ADDRESS
+    std::string addr_str = boost::lexical_cast<std::string>(addr.toUint32());
+    bind_array.add(addr_str);
+
+    // Get the data
+    Lease4Collection result;
+
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(*this);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
+    getLeaseCollection(ctx, GET_LEASE4_CLIENT, bind_array, result);
+
+    return (result);
+}
+
 Lease4Collection
 PgSqlLeaseMgr::getLeases4(SubnetID subnet_id) const {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_PGSQL_GET_SUBID4)
@@ -2052,8 +2107,6 @@ PgSqlLeaseMgr::updateLeaseCommon(PgSqlLeaseContextPtr& ctx,
 
 void
 PgSqlLeaseMgr::updateLease4(const Lease4Ptr& lease) {
-    const StatementIndex stindex = UPDATE_LEASE4;
-
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_PGSQL_UPDATE_ADDR4)
         .arg(lease->addr_.toText());
 
@@ -2061,6 +2114,17 @@ PgSqlLeaseMgr::updateLease4(const Lease4Ptr& lease) {
     PgSqlLeaseContextAlloc get_context(*this);
     PgSqlLeaseContextPtr ctx = get_context.ctx_;
 
+    updateLease4Internal(ctx, lease);
+
+    // Update lease current expiration time.
+    lease->updateCurrentExpirationTime();
+}
+
+void
+PgSqlLeaseMgr::updateLease4Internal(PgSqlLeaseContextPtr& ctx,
+                                    const Lease4Ptr& lease) {
+    const StatementIndex stindex = UPDATE_LEASE4;
+
     // Create the BIND array for the data being updated
     PsqlBindArray bind_array;
     ctx->exchange4_->createBindForSend(lease, bind_array);
@@ -2075,15 +2139,10 @@ PgSqlLeaseMgr::updateLease4(const Lease4Ptr& lease) {
 
     // Drop to common update code
     updateLeaseCommon(ctx, stindex, bind_array, lease);
-
-    // Update lease current expiration time.
-    lease->updateCurrentExpirationTime();
 }
 
 void
 PgSqlLeaseMgr::updateLease6(const Lease6Ptr& lease) {
-    const StatementIndex stindex = UPDATE_LEASE6;
-
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_PGSQL_UPDATE_ADDR6)
         .arg(lease->addr_.toText())
         .arg(lease->type_);
@@ -2092,6 +2151,17 @@ PgSqlLeaseMgr::updateLease6(const Lease6Ptr& lease) {
     PgSqlLeaseContextAlloc get_context(*this);
     PgSqlLeaseContextPtr ctx = get_context.ctx_;
 
+    updateLease6Internal(ctx, lease);
+
+    // Update lease current expiration time.
+    lease->updateCurrentExpirationTime();
+}
+
+void
+PgSqlLeaseMgr::updateLease6Internal(PgSqlLeaseContextPtr& ctx,
+                                    const Lease6Ptr& lease) {
+    const StatementIndex stindex = UPDATE_LEASE6;
+
     // Create the BIND array for the data being updated
     PsqlBindArray bind_array;
     ctx->exchange6_->createBindForSend(lease, bind_array);
@@ -2106,18 +2176,12 @@ PgSqlLeaseMgr::updateLease6(const Lease6Ptr& lease) {
 
     // Drop to common update code
     updateLeaseCommon(ctx, stindex, bind_array, lease);
-
-    // Update lease current expiration time.
-    lease->updateCurrentExpirationTime();
 }
 
 uint64_t
-PgSqlLeaseMgr::deleteLeaseCommon(StatementIndex stindex,
+PgSqlLeaseMgr::deleteLeaseCommon(PgSqlLeaseContextPtr& ctx,
+                                 StatementIndex stindex,
                                  PsqlBindArray& bind_array) {
-    // Get a context
-    PgSqlLeaseContextAlloc get_context(*this);
-    PgSqlLeaseContextPtr ctx = get_context.ctx_;
-
     PgSqlResult r(PQexecPrepared(ctx->conn_, tagged_statements[stindex].name,
                                  tagged_statements[stindex].nbparams,
                                  &bind_array.values_[0],
@@ -2132,9 +2196,20 @@ PgSqlLeaseMgr::deleteLeaseCommon(StatementIndex stindex,
 
 bool
 PgSqlLeaseMgr::deleteLease(const Lease4Ptr& lease) {
-    const IOAddress& addr = lease->addr_;
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_PGSQL_DELETE_ADDR)
-        .arg(addr.toText());
+        .arg(lease->addr_.toText());
+
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(*this);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
+    return (deleteLeaseInternal(ctx, lease));
+}
+
+bool
+PgSqlLeaseMgr::deleteLeaseInternal(PgSqlLeaseContextPtr& ctx,
+                                   const Lease4Ptr& lease) {
+    const IOAddress& addr = lease->addr_;
 
     // Set up the WHERE clause value
     PsqlBindArray bind_array;
@@ -2146,7 +2221,7 @@ PgSqlLeaseMgr::deleteLease(const Lease4Ptr& lease) {
                                                                        lease->current_valid_lft_);
     bind_array.add(expire_str);
 
-    auto affected_rows = deleteLeaseCommon(DELETE_LEASE4, bind_array);
+    auto affected_rows = deleteLeaseCommon(ctx, DELETE_LEASE4, bind_array);
 
     // Check success case first as it is the most likely outcome.
     if (affected_rows == 1) {
@@ -2166,10 +2241,21 @@ PgSqlLeaseMgr::deleteLease(const Lease4Ptr& lease) {
 
 bool
 PgSqlLeaseMgr::deleteLease(const Lease6Ptr& lease) {
-    const IOAddress& addr = lease->addr_;
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_PGSQL_DELETE_ADDR)
-        .arg(addr.toText());
+        .arg(lease->addr_.toText());
+
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(*this);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
+    return (deleteLeaseInternal(ctx, lease));
+}
+
+bool
+PgSqlLeaseMgr::deleteLeaseInternal(PgSqlLeaseContextPtr& ctx,
+                                   const Lease6Ptr& lease) {
+    const IOAddress& addr = lease->addr_;
 
     // Set up the WHERE clause value
     PsqlBindArray bind_array;
@@ -2181,7 +2267,7 @@ PgSqlLeaseMgr::deleteLease(const Lease6Ptr& lease) {
                                                                        lease->current_valid_lft_);
     bind_array.add(expire_str);
 
-    auto affected_rows = deleteLeaseCommon(DELETE_LEASE6, bind_array);
+    auto affected_rows = deleteLeaseCommon(ctx, DELETE_LEASE6, bind_array);
 
     // Check success case first as it is the most likely outcome.
     if (affected_rows == 1) {
@@ -2199,6 +2285,62 @@ PgSqlLeaseMgr::deleteLease(const Lease6Ptr& lease) {
               "that had the address " << lease->addr_.toText());
 }
 
+void
+PgSqlLeaseMgr::updateLeases4(const Lease4Collection& updated_leases,
+                             const Lease4Collection& deleted_leases) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_PGSQL_UPDATE_LEASES4)
+        .arg(updated_leases.size())
+        .arg(deleted_leases.size());
+
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(*this);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
+    // Execute all the operations on the connection of the context within
+    // a single transaction. It is rolled back when an operation throws.
+    PgSqlTransaction transaction(ctx->conn_);
+    for (auto const& lease : updated_leases) {
+        updateLease4Internal(ctx, lease);
+    }
+    for (auto const& lease : deleted_leases) {
+        static_cast<void>(deleteLeaseInternal(ctx, lease));
+    }
+    transaction.commit();
+
+    // Update the leases current expiration time once they are committed.
+    for (auto const& lease : updated_leases) {
+        lease->updateCurrentExpirationTime();
+    }
+}
+
+void
+PgSqlLeaseMgr::updateLeases6(const Lease6Collection& updated_leases,
+                             const Lease6Collection& deleted_leases) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_PGSQL_UPDATE_LEASES6)
+        .arg(updated_leases.size())
+        .arg(deleted_leases.size());
+
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(*this);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
+    // Execute all the operations on the connection of the context within
+    // a single transaction. It is rolled back when an operation throws.
+    PgSqlTransaction transaction(ctx->conn_);
+    for (auto const& lease : updated_leases) {
+        updateLease6Internal(ctx, lease);
+    }
+    for (auto const& lease : deleted_leases) {
+        static_cast<void>(deleteLeaseInternal(ctx, lease));
+    }
+    transaction.commit();
+
+    // Update the leases current expiration time once they are committed.
+    for (auto const& lease : updated_leases) {
+        lease->updateCurrentExpirationTime();
+    }
+}
+
 uint64_t
 PgSqlLeaseMgr::deleteExpiredReclaimedLeases4(const uint32_t secs) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_PGSQL_DELETE_EXPIRED_RECLAIMED4)
@@ -2216,6 +2358,10 @@ PgSqlLeaseMgr::deleteExpiredReclaimedLeases6(const uint32_t secs) {
 uint64_t
 PgSqlLeaseMgr::deleteExpiredReclaimedLeasesCommon(const uint32_t secs,
                                                   StatementIndex statement_index) {
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(*this);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
     PsqlBindArray bind_array;
 
     // State is reclaimed.
@@ -2228,7 +2374,7 @@ PgSqlLeaseMgr::deleteExpiredReclaimedLeasesCommon(const uint32_t secs,
     bind_array.add(expiration_str);
 
     // Delete leases.
-    return (deleteLeaseCommon(statement_index, bind_array));
+    return (deleteLeaseCommon(ctx, statement_index, bind_array));
 }
 
 LeaseStatsQueryPtr
@@ -265,6 +265,23 @@ public:
     virtual Lease4Ptr getLease4(const ClientId& clientid,
                                 SubnetID subnet_id) const;
 
+    /// @brief Returns the IPv4 leases which may belong to a client.
+    ///
+    /// The leases with the HW address or the client identifier and the
+    /// lease for the address are fetched by one query.
+    ///
+    /// @param hwaddr HW address or null pointer.
+    /// @param client_id Client identifier or null pointer.
+    /// @param addr Address of the lease or 0.0.0.0.
+    ///
+    /// @return Lease collection (may be empty if no IPv4 lease found).
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed.
+    virtual Lease4Collection getClientLeases4(const HWAddrPtr& hwaddr,
+                                              const ClientIdPtr& client_id,
+                                              const isc::asiolink::IOAddress& addr) const;
+
     /// @brief Returns all IPv4 leases for the particular subnet identifier.
     ///
     /// @param subnet_id subnet identifier.
@@ -522,6 +539,36 @@ public:
     /// different expiration time.
     virtual bool deleteLease(const Lease6Ptr& lease);
 
+    /// @brief Updates and deletes a batch of IPv4 leases.
+    ///
+    /// All the operations are executed on one connection within a single
+    /// transaction, which is rolled back if any of them fails.
+    ///
+    /// @param updated_leases IPv4 leases to be updated.
+    /// @param deleted_leases IPv4 leases to be deleted.
+    ///
+    /// @throw NoSuchLease Could not update a lease because no lease matches
+    ///        the address given.
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed.
+    virtual void updateLeases4(const Lease4Collection& updated_leases,
+                               const Lease4Collection& deleted_leases);
+
+    /// @brief Updates and deletes a batch of IPv6 leases.
+    ///
+    /// All the operations are executed on one connection within a single
+    /// transaction, which is rolled back if any of them fails.
+    ///
+    /// @param updated_leases IPv6 leases to be updated.
+    /// @param deleted_leases IPv6 leases to be deleted.
+    ///
+    /// @throw NoSuchLease Could not update a lease because no lease matches
+    ///        the address given.
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed.
+    virtual void updateLeases6(const Lease6Collection& updated_leases,
+                               const Lease6Collection& deleted_leases);
+
     /// @brief Deletes all expired-reclaimed DHCPv4 leases.
     ///
     /// @param secs Number of seconds since expiration of leases before
@@ -685,6 +732,7 @@ public:
         DELETE_LEASE6_STATE_EXPIRED, // Delete expired lease6 in a given state
         GET_LEASE4,                  // Get all IPv4 leases
         GET_LEASE4_ADDR,             // Get lease4 by address
+        GET_LEASE4_CLIENT,           // Get lease4 by HW address, client ID or address
         GET_LEASE4_CLIENTID,         // Get lease4 by client ID
         GET_LEASE4_CLIENTID_SUBID,   // Get lease4 by client ID & subnet ID
         GET_LEASE4_HWADDR,           // Get lease4 by HW address
@@ -883,12 +931,65 @@ private:
                            db::PsqlBindArray& bind_array,
                            const LeasePtr& lease);
 
+    /// @brief Updates an IPv4 lease using a given context.
+    ///
+    /// The current expiration time of the lease is not updated: this is
+    /// left to the caller, which may update several leases within a
+    /// transaction.
+    ///
+    /// @param ctx Context
+    /// @param lease The lease to be updated.
+    ///
+    /// @throw NoSuchLease Could not update a lease because no lease matches
+    ///        the address given.
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed.
+    void updateLease4Internal(PgSqlLeaseContextPtr& ctx, const Lease4Ptr& lease);
+
+    /// @brief Updates an IPv6 lease using a given context.
+    ///
+    /// The current expiration time of the lease is not updated: this is
+    /// left to the caller, which may update several leases within a
+    /// transaction.
+    ///
+    /// @param ctx Context
+    /// @param lease The lease to be updated.
+    ///
+    /// @throw NoSuchLease Could not update a lease because no lease matches
+    ///        the address given.
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed.
+    void updateLease6Internal(PgSqlLeaseContextPtr& ctx, const Lease6Ptr& lease);
+
+    /// @brief Deletes an IPv4 lease using a given context.
+    ///
+    /// @param ctx Context
+    /// @param lease IPv4 lease being deleted.
+    ///
+    /// @return true if deletion was successful, false if no such lease exists.
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed.
+    bool deleteLeaseInternal(PgSqlLeaseContextPtr& ctx, const Lease4Ptr& lease);
+
+    /// @brief Deletes an IPv6 lease using a given context.
+    ///
+    /// @param ctx Context
+    /// @param lease IPv6 lease being deleted.
+    ///
+    /// @return true if deletion was successful, false if no such lease exists.
+    ///
+    /// @throw isc::db::DbOperationError An operation on the open database has
+    ///        failed.
+    bool deleteLeaseInternal(PgSqlLeaseContextPtr& ctx, const Lease6Ptr& lease);
+
     /// @brief Delete lease common code
     ///
     /// Holds the common code for deleting a lease.  It binds the parameters
     /// to the prepared statement, executes the statement and checks to
     /// see how many rows were deleted.
     ///
+    /// @param ctx Context
     /// @param stindex Index of prepared statement to be executed
     /// @param bind_array Array containing lease values and where clause
     /// parameters for the delete
@@ -897,7 +998,8 @@ private:
     ///
     /// @throw isc::db::DbOperationError An operation on the open database has
     ///        failed.
-    uint64_t deleteLeaseCommon(StatementIndex stindex,
+    uint64_t deleteLeaseCommon(PgSqlLeaseContextPtr& ctx,
+                               StatementIndex stindex,
                                db::PsqlBindArray& bind_array);
 
     /// @brief Delete expired-reclaimed leases.
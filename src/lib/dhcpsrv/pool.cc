@@ -9,11 +9,13 @@
 #include <asiolink/io_address.h>
 #include <asiolink/addr_utilities.h>
 #include <dhcpsrv/pool.h>
+#include <util/multi_threading_mgr.h>
 #include <boost/make_shared.hpp>
 #include <sstream>
 
 using namespace isc::asiolink;
 using namespace isc::data;
+using namespace isc::util;
 
 namespace isc {
 namespace dhcp {
@@ -21,9 +23,9 @@ namespace dhcp {
 Pool::Pool(Lease::Type type, const isc::asiolink::IOAddress& first,
            const isc::asiolink::IOAddress& last)
     :id_(getNextID()), first_(first), last_(last), type_(type),
-     capacity_(0), cfg_option_(new CfgOption()), client_class_(""),
+     capacity_(0), assigned_(0), cfg_option_(new CfgOption()), client_class_(""),
      last_allocated_(first), last_allocated_valid_(false),
-     permutation_() {
+     permutation_(), permutation_mutex_(new std::mutex) {
 }
 
 bool Pool::inRange(const isc::asiolink::IOAddress& addr) const {
@@ -38,6 +40,32 @@ void Pool::allowClientClass(const ClientClass& class_name) {
     client_class_ = class_name;
 }
 
+IOAddress
+Pool::nextRandom() {
+    if (MultiThreadingMgr::instance().getMode()) {
+        std::lock_guard<std::mutex> lock(*permutation_mutex_);
+        return (nextRandomInternal());
+    } else {
+        return (nextRandomInternal());
+    }
+}
+
+IOAddress
+Pool::nextRandomInternal() {
+    // Start a new permutation when all addresses have been returned, so
+    // released addresses are picked again.
+    if (!permutation_ || permutation_->exhausted()) {
+        permutation_ = createPermutation();
+    }
+    bool done = false;
+    return (permutation_->next(done));
+}
+
+IPRangePermutationPtr
+Pool::createPermutation() const {
+    return (boost::make_shared<IPRangePermutation>(AddressRange(first_, last_)));
+}
+
 std::string
 Pool::toText() const {
     std::stringstream tmp;
@@ -420,5 +448,14 @@ Pool6::toText() const {
     return (s.str());
 }
 
+IPRangePermutationPtr
+Pool6::createPermutation() const {
+    if (type_ == Lease::TYPE_PD) {
+        return (boost::make_shared<IPRangePermutation>(PrefixRange(first_, last_,
+                                                                   prefix_len_)));
+    }
+    return (Pool::createPermutation());
+}
+
 }; // end of isc::dhcp namespace
 }; // end of isc namespace
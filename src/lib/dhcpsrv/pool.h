@@ -16,8 +16,11 @@
 #include <dhcpsrv/lease.h>
 #include <dhcpsrv/ip_range_permutation.h>
 
+#include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 
+#include <atomic>
+#include <mutex>
 #include <vector>
 
 namespace isc {
@@ -87,6 +90,41 @@ public:
         return (capacity_);
     }
 
+    /// @brief Returns the number of leases in this pool.
+    ///
+    /// The leases which were reclaimed are not counted, the expired leases
+    /// which were not reclaimed yet are.
+    ///
+    /// @return number of leases in this pool
+    uint64_t getAssigned() const {
+        int64_t assigned = assigned_;
+        return (assigned > 0 ? static_cast<uint64_t>(assigned) : 0);
+    }
+
+    /// @brief Returns the number of addresses or prefixes of this pool
+    /// without lease.
+    ///
+    /// @return number of free leases in this pool
+    uint64_t getFree() const {
+        uint64_t assigned = getAssigned();
+        return (assigned < capacity_ ? capacity_ - assigned : 0);
+    }
+
+    /// @brief Sets the number of leases in this pool.
+    ///
+    /// @param assigned number of leases
+    void setAssigned(uint64_t assigned) {
+        assigned_ = static_cast<int64_t>(assigned);
+    }
+
+    /// @brief Adds to the number of leases in this pool.
+    ///
+    /// @param delta 1 when a lease is added, -1 when a lease is removed or
+    /// reclaimed
+    void addAssigned(int64_t delta) {
+        assigned_ += delta;
+    }
+
     /// @brief Returns pointer to the option data configuration for this pool.
     CfgOptionPtr getCfgOption() {
         return (cfg_option_);
@@ -174,8 +212,25 @@ public:
         return (permutation_);
     }
 
+    /// @brief Returns the next address or prefix of the pool in random
+    /// order.
+    ///
+    /// The addresses or delegated prefixes are taken from the permutation
+    /// of the pool, which is created on first use. Once all of them were
+    /// returned a new permutation is started. The permutation is protected
+    /// by a mutex of the pool, so threads picking from distinct pools don't
+    /// wait for each other.
+    ///
+    /// @return the next address or delegated prefix of the pool.
+    isc::asiolink::IOAddress nextRandom();
+
 protected:
 
+    /// @brief Creates a new permutation of the pool.
+    ///
+    /// @return Pointer to the permutation of the addresses of the pool.
+    virtual IPRangePermutationPtr createPermutation() const;
+
     /// @brief protected constructor
     ///
     /// This constructor is protected to prevent anyone from instantiating
@@ -219,6 +274,11 @@ protected:
     /// max value of uint64_t.
     uint64_t capacity_;
 
+    /// @brief Number of leases in the pool.
+    ///
+    /// It is updated by the threads processing packets without lock.
+    std::atomic<int64_t> assigned_;
+
     /// @brief Pointer to the option data configuration for this pool.
     CfgOptionPtr cfg_option_;
 
@@ -238,6 +298,8 @@ protected:
     /// @brief Last allocated address
     /// See @ref isc::dhcp::Subnet::last_allocated_ia_
     /// Initialized and reset to first
+    ///
+    /// @note: It is protected by the subnet mutex of the iterative allocator.
     isc::asiolink::IOAddress last_allocated_;
 
     /// @brief Status of last allocated address
@@ -248,6 +310,19 @@ protected:
     /// It may be initialized for some pools to provide address
     /// or delegated prefix randomization capabilities.
     IPRangePermutationPtr permutation_;
+
+    /// @brief Mutex protecting the permutation.
+    boost::scoped_ptr<std::mutex> permutation_mutex_;
+
+private:
+
+    /// @brief Returns the next address or prefix of the pool in random
+    /// order.
+    ///
+    /// Should be called in a thread safe context.
+    ///
+    /// @return the next address or delegated prefix of the pool.
+    isc::asiolink::IOAddress nextRandomInternal();
 };
 
 class Pool4;
@@ -466,6 +541,14 @@ public:
     /// @return textual representation
     virtual std::string toText() const;
 
+protected:
+
+    /// @brief Creates a new permutation of the pool.
+    ///
+    /// @return Pointer to the permutation of the addresses or delegated
+    /// prefixes of the pool.
+    virtual IPRangePermutationPtr createPermutation() const;
+
 private:
 
     /// @brief Generic method initializing a DHCPv6 pool.
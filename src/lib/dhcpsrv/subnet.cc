@@ -11,6 +11,7 @@
 #include <dhcp/option_space.h>
 #include <dhcpsrv/shared_network.h>
 #include <dhcpsrv/subnet.h>
+#include <stats/stats_mgr.h>
 #include <util/multi_threading_mgr.h>
 
 #include <boost/lexical_cast.hpp>
@@ -22,10 +23,31 @@
 using namespace isc::asiolink;
 using namespace isc::data;
 using namespace isc::dhcp;
+using namespace isc::stats;
 using namespace isc::util;
 
 namespace {
 
+/// @brief Returns the name of the statistic of the assigned leases of a
+/// pool.
+///
+/// @param type type of the lease.
+/// @return the name of the statistic or an empty string for temporary
+/// addresses which have no statistic.
+std::string
+getAssignedStatName(Lease::Type type) {
+    switch (type) {
+    case Lease::TYPE_V4:
+        return ("assigned-addresses");
+    case Lease::TYPE_NA:
+        return ("assigned-nas");
+    case Lease::TYPE_PD:
+        return ("assigned-pds");
+    default:
+        return ("");
+    }
+}
+
 /// @brief Function used in calls to std::upper_bound to check
 /// if the specified prefix is lower than the first address a pool.
 ///
@@ -35,18 +57,30 @@ prefixLessThanFirstAddress(const IOAddress& prefix, const PoolPtr& pool) {
     return (prefix < pool->getFirstAddress());
 }
 
-/// @brief Function used in calls to std::sort to compare first
-/// prefixes of the two pools.
+/// @brief Returns the pool which includes an address or prefix.
 ///
-/// @param pool1 First pool.
-/// @param pool2 Second pool.
+/// The pools are sorted by their first addresses and do not overlap, so
+/// the only candidate is the last pool with a first address lower than
+/// or equal to the address. It is found with a binary search.
 ///
-/// @return true if first prefix of the first pool is smaller than
-/// the first address of the second pool.
-bool
-comparePoolFirstAddress(const PoolPtr& pool1, const PoolPtr& pool2) {
-    return (pool1->getFirstAddress() < pool2->getFirstAddress());
-};
+/// @param pools Pools sorted by first address.
+/// @param addr Address or prefix to be matched.
+///
+/// @return Iterator to the pool including the address or @c pools.end().
+PoolCollection::const_iterator
+findPool(const PoolCollection& pools, const IOAddress& addr) {
+    PoolCollection::const_iterator ub =
+        std::upper_bound(pools.begin(), pools.end(), addr,
+                         prefixLessThanFirstAddress);
+    if (ub == pools.begin()) {
+        return (pools.end());
+    }
+    --ub;
+    if (!(*ub)->inRange(addr)) {
+        return (pools.end());
+    }
+    return (ub);
+}
 
 }
 
@@ -251,6 +285,63 @@ Subnet::sumPoolCapacity(const PoolCollection& pools,
     return (sum);
 }
 
+uint64_t
+Subnet::getPoolFree(Lease::Type type,
+                    const ClientClasses& client_classes) const {
+    const PoolCollection& pools = getPools(type);
+    uint64_t sum = 0;
+    for (auto const& pool : pools) {
+        if (!pool->clientSupported(client_classes)) {
+            continue;
+        }
+        uint64_t x = pool->getFree();
+        if (x > std::numeric_limits<uint64_t>::max() - sum) {
+            return (std::numeric_limits<uint64_t>::max());
+        }
+        sum += x;
+    }
+    return (sum);
+}
+
+void
+Subnet::updatePoolAssigned(Lease::Type type, const IOAddress& addr,
+                           int64_t delta) const {
+    const PoolCollection& pools = getPools(type);
+    PoolCollection::const_iterator pool = findPool(pools, addr);
+    if (pool == pools.end()) {
+        return;
+    }
+    (*pool)->addAssigned(delta);
+
+    std::string name = getAssignedStatName(type);
+    if (!name.empty()) {
+        StatsMgr::instance().addValue(getPoolStatName(id_,
+                                                      std::distance(pools.begin(), pool),
+                                                      name),
+                                      delta);
+    }
+}
+
+void
+Subnet::resetPoolAssigned(Lease::Type type) const {
+    const PoolCollection& pools = getPools(type);
+    std::string name = getAssignedStatName(type);
+    for (size_t index = 0; index < pools.size(); ++index) {
+        pools[index]->setAssigned(0);
+        if (!name.empty()) {
+            StatsMgr::instance().setValue(getPoolStatName(id_, index, name),
+                                          static_cast<int64_t>(0));
+        }
+    }
+}
+
+std::string
+Subnet::getPoolStatName(SubnetID subnet_id, size_t index,
+                        const std::string& name) {
+    return (StatsMgr::generateName("subnet", subnet_id,
+                                   StatsMgr::generateName("pool", index, name)));
+}
+
 std::pair<IOAddress, uint8_t>
 Subnet::parsePrefixCommon(const std::string& prefix) {
     auto pos = prefix.find('/');
@@ -409,15 +500,9 @@ const PoolPtr Subnet::getPool(Lease::Type type, const isc::asiolink::IOAddress&
         // matching prefix we use decrement operator to go back by one item.
         // If returned iterator points to begin it means that prefixes in all
         // pools are greater than out prefix, and thus there is no match.
-        PoolCollection::const_iterator ub =
-            std::upper_bound(pools.begin(), pools.end(), hint,
-                             prefixLessThanFirstAddress);
-
-        if (ub != pools.begin()) {
-            --ub;
-            if ((*ub)->inRange(hint)) {
-                candidate = *ub;
-            }
+        PoolCollection::const_iterator pool = findPool(pools, hint);
+        if (pool != pools.end()) {
+            candidate = *pool;
         }
 
         // If we don't find anything better, then let's just use the first pool
@@ -441,16 +526,10 @@ const PoolPtr Subnet::getPool(Lease::Type type,
     PoolPtr candidate;
 
     if (!pools.empty()) {
-        PoolCollection::const_iterator ub =
-            std::upper_bound(pools.begin(), pools.end(), hint,
-                             prefixLessThanFirstAddress);
-
-        if (ub != pools.begin()) {
-            --ub;
-            if ((*ub)->inRange(hint) &&
-                (*ub)->clientSupported(client_classes)) {
-                candidate = *ub;
-            }
+        PoolCollection::const_iterator pool = findPool(pools, hint);
+        if ((pool != pools.end()) &&
+            (*pool)->clientSupported(client_classes)) {
+            candidate = *pool;
         }
     }
 
@@ -505,12 +584,13 @@ Subnet::addPool(const PoolPtr& pool) {
 
     PoolCollection& pools_writable = getPoolsWritable(pool->getType());
 
-    // Add the pool to the appropriate pools collection
-    pools_writable.push_back(pool);
-
-    // Sort pools by first address.
-    std::sort(pools_writable.begin(), pools_writable.end(),
-              comparePoolFirstAddress);
+    // Add the pool to the appropriate pools collection, keeping the pools
+    // sorted by first address for the binary searches.
+    pools_writable.insert(std::upper_bound(pools_writable.begin(),
+                                           pools_writable.end(),
+                                           pool->getFirstAddress(),
+                                           prefixLessThanFirstAddress),
+                          pool);
 }
 
 void
@@ -528,14 +608,8 @@ Subnet::inPool(Lease::Type type, const isc::asiolink::IOAddress& addr) const {
 
     const PoolCollection& pools = getPools(type);
 
-    for (PoolCollection::const_iterator pool = pools.begin();
-         pool != pools.end(); ++pool) {
-        if ((*pool)->inRange(addr)) {
-            return (true);
-        }
-    }
-    // There's no pool that address belongs to
-    return (false);
+    // The pools do not overlap so at most one pool includes the address.
+    return (findPool(pools, addr) != pools.end());
 }
 
 bool
@@ -550,17 +624,9 @@ Subnet::inPool(Lease::Type type,
 
     const PoolCollection& pools = getPools(type);
 
-    for (PoolCollection::const_iterator pool = pools.begin();
-         pool != pools.end(); ++pool) {
-        if (!(*pool)->clientSupported(client_classes)) {
-            continue;
-        }
-        if ((*pool)->inRange(addr)) {
-            return (true);
-        }
-    }
-    // There's no pool that address belongs to
-    return (false);
+    // The pools do not overlap so at most one pool includes the address.
+    PoolCollection::const_iterator pool = findPool(pools, addr);
+    return ((pool != pools.end()) && (*pool)->clientSupported(client_classes));
 }
 
 bool
@@ -53,6 +53,9 @@ public:
     /// always true. For the given example, 2001::1234:abcd would return
     /// true for inRange(), but false for inPool() check.
     ///
+    /// The pools are sorted and do not overlap so the pool which may
+    /// include the address is found with a binary search.
+    ///
     /// @param type type of pools to iterate over
     /// @param addr this address will be checked if it belongs to any pools in
     ///        that subnet
@@ -61,7 +64,8 @@ public:
 
     /// @brief checks if the specified address is in allowed pools.
     ///
-    /// This takes also into account client classes
+    /// This takes also into account client classes. As for the variant
+    /// without classes, the pool is found with a binary search.
     ///
     /// @param type type of pools to iterate over
     /// @param addr this address will be checked if it belongs to any pools in
@@ -142,7 +146,8 @@ public:
     /// DHCPv6 pool.
     ///
     /// Pools held within a subnet are sorted by first pool address/prefix
-    /// from the lowest to the highest.
+    /// from the lowest to the highest: the pool is inserted at its place
+    /// so @c getPool and @c inPool can use a binary search.
     ///
     /// @param pool pool to be added
     ///
@@ -227,6 +232,50 @@ public:
     uint64_t getPoolCapacity(Lease::Type type,
                              const ClientClasses& client_classes) const;
 
+    /// @brief Returns the number of free leases for specified lease type
+    /// in the pools allowed for a client which belongs to classes.
+    ///
+    /// This sums the free counters of the pools so it does not access
+    /// the lease database. A result of 0 means that all allowed pools
+    /// are exhausted.
+    ///
+    /// @param type type of the lease
+    /// @param client_classes list of classes the client belongs to
+    /// @return number of free leases matching lease type and classes
+    uint64_t getPoolFree(Lease::Type type,
+                         const ClientClasses& client_classes) const;
+
+    /// @brief Updates the assigned leases counter of the pool containing
+    /// an address or a prefix.
+    ///
+    /// It also updates the corresponding pool statistic. It does nothing
+    /// when the address does not belong to a pool of the subnet.
+    ///
+    /// @param type type of the lease
+    /// @param addr the leased address or prefix
+    /// @param delta the change of the number of assigned leases
+    void updatePoolAssigned(Lease::Type type,
+                            const isc::asiolink::IOAddress& addr,
+                            int64_t delta) const;
+
+    /// @brief Resets the assigned leases counters of the pools.
+    ///
+    /// It is called when all the leases of the subnet are removed. The
+    /// pool statistics are reset too.
+    ///
+    /// @param type type of the lease
+    void resetPoolAssigned(Lease::Type type) const;
+
+    /// @brief Returns the name of a pool statistic.
+    ///
+    /// @param subnet_id identifier of the subnet
+    /// @param index position of the pool in the subnet pool list
+    /// @param name name of the statistic, e.g. "assigned-addresses"
+    /// @return the full statistic name, e.g.
+    /// "subnet[1].pool[0].assigned-addresses"
+    static std::string getPoolStatName(SubnetID subnet_id, size_t index,
+                                       const std::string& name);
+
     /// @brief Returns textual representation of the subnet (e.g.
     /// "2001:db8::/64").
     ///
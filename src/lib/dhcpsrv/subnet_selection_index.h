@@ -0,0 +1,205 @@
+// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef SUBNET_SELECTION_INDEX_H
+#define SUBNET_SELECTION_INDEX_H
+
+#include <asiolink/addr_utilities.h>
+#include <asiolink/io_address.h>
+#include <dhcp/option.h>
+#include <boost/functional/hash.hpp>
+#include <boost/shared_ptr.hpp>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Index of the subnets used to select a subnet for a client.
+///
+/// The subnet selection returns the first subnet, in the subnet identifier
+/// order, which matches a property of the client's packet and supports the
+/// client's classes. Instead of scanning all subnets, the configuration
+/// looks up the candidate subnets in this index and checks the client
+/// classes of the candidates only. The index maps:
+/// - each prefix length in use to a hash table of the prefixes of this
+///   length, so an address is matched with one lookup per prefix length,
+/// - the relay addresses to the subnets,
+/// - the interface names to the subnets,
+/// - the interface identifiers to the subnets.
+///
+/// The subnets must be added in the subnet identifier order so that each
+/// list of candidates is sorted in this order. The index is not updated
+/// when the subnets are modified: it is built from a committed
+/// configuration and discarded when the configuration changes.
+///
+/// @tparam SubnetPtrType Type of the pointer to a subnet, i.e.
+/// @c Subnet4Ptr or @c Subnet6Ptr.
+template<typename SubnetPtrType>
+class SubnetSelectionIndex {
+public:
+
+    /// @brief Type of the list of candidate subnets.
+    typedef std::vector<SubnetPtrType> SubnetList;
+
+    /// @brief Adds a subnet prefix.
+    ///
+    /// @param prefix Subnet prefix.
+    /// @param len Prefix length.
+    /// @param subnet Subnet to be returned for the addresses in the prefix.
+    void addPrefix(const asiolink::IOAddress& prefix, const uint8_t len,
+                   const SubnetPtrType& subnet) {
+        addSubnet(prefixes_[len][asiolink::firstAddrInPrefix(prefix, len)],
+                  subnet);
+    }
+
+    /// @brief Adds a relay address.
+    ///
+    /// @param address Relay address.
+    /// @param subnet Subnet to be returned for the relay address.
+    void addRelay(const asiolink::IOAddress& address,
+                  const SubnetPtrType& subnet) {
+        addSubnet(relays_[address], subnet);
+    }
+
+    /// @brief Adds an interface name.
+    ///
+    /// @param iface Interface name.
+    /// @param subnet Subnet to be returned for the interface name.
+    void addIface(const std::string& iface, const SubnetPtrType& subnet) {
+        addSubnet(ifaces_[iface], subnet);
+    }
+
+    /// @brief Adds an interface identifier.
+    ///
+    /// @param interface_id Interface identifier option.
+    /// @param subnet Subnet to be returned for the interface identifier.
+    void addInterfaceId(const OptionPtr& interface_id,
+                        const SubnetPtrType& subnet) {
+        addSubnet(interface_ids_[interfaceIdKey(interface_id)], subnet);
+    }
+
+    /// @brief Returns the subnets whose prefix includes an address.
+    ///
+    /// @param address Address to be matched.
+    /// @return The candidate subnets in the subnet identifier order.
+    SubnetList getByAddress(const asiolink::IOAddress& address) const {
+        SubnetList subnets;
+        const uint8_t max_len = (address.isV4() ? 32 : 128);
+        for (auto len = prefixes_.begin(); len != prefixes_.end(); ++len) {
+            if (len->first > max_len) {
+                continue;
+            }
+            auto prefix = len->second.find(asiolink::firstAddrInPrefix(address,
+                                                                        len->first));
+            if (prefix != len->second.end()) {
+                subnets.insert(subnets.end(), prefix->second.begin(),
+                               prefix->second.end());
+            }
+        }
+        // The prefixes of distinct lengths are not ordered together.
+        if (subnets.size() > 1) {
+            std::sort(subnets.begin(), subnets.end(),
+                      [](const SubnetPtrType& a, const SubnetPtrType& b) {
+                          return (a->getID() < b->getID());
+                      });
+        }
+        return (subnets);
+    }
+
+    /// @brief Returns the subnets matching a relay address.
+    ///
+    /// @param address Relay address.
+    /// @return The candidate subnets in the subnet identifier order.
+    const SubnetList& getByRelay(const asiolink::IOAddress& address) const {
+        return (find(relays_, address));
+    }
+
+    /// @brief Returns the subnets matching an interface name.
+    ///
+    /// @param iface Interface name.
+    /// @return The candidate subnets in the subnet identifier order.
+    const SubnetList& getByIface(const std::string& iface) const {
+        return (find(ifaces_, iface));
+    }
+
+    /// @brief Returns the subnets matching an interface identifier.
+    ///
+    /// @param interface_id Interface identifier option.
+    /// @return The candidate subnets in the subnet identifier order.
+    const SubnetList& getByInterfaceId(const OptionPtr& interface_id) const {
+        return (find(interface_ids_, interfaceIdKey(interface_id)));
+    }
+
+private:
+
+    /// @brief Appends a subnet to a list of candidates.
+    ///
+    /// The subnet is not appended again when it is already the last one,
+    /// e.g. when the same relay address is specified twice.
+    ///
+    /// @param subnets List of candidates.
+    /// @param subnet Subnet to be appended.
+    static void addSubnet(SubnetList& subnets, const SubnetPtrType& subnet) {
+        if (subnets.empty() || (subnets.back() != subnet)) {
+            subnets.push_back(subnet);
+        }
+    }
+
+    /// @brief Returns the key of an interface identifier.
+    ///
+    /// Two interface identifiers match when their option types and data
+    /// are equal, see @c Option::equals.
+    ///
+    /// @param interface_id Interface identifier option.
+    /// @return The option type followed by the option data.
+    static std::string interfaceIdKey(const OptionPtr& interface_id) {
+        std::string key(1, static_cast<char>(interface_id->getType() >> 8));
+        key.push_back(static_cast<char>(interface_id->getType() & 0xff));
+        const OptionBuffer& data = interface_id->getData();
+        key.append(data.begin(), data.end());
+        return (key);
+    }
+
+    /// @brief Returns the candidates of a key.
+    ///
+    /// @param map Map of the candidates.
+    /// @param key Key to be looked up.
+    /// @return The candidates or an empty list.
+    template<typename MapType, typename KeyType>
+    static const SubnetList& find(const MapType& map, const KeyType& key) {
+        static const SubnetList empty;
+        auto subnets = map.find(key);
+        return ((subnets != map.end()) ? subnets->second : empty);
+    }
+
+    /// @brief Type of the map of addresses to candidate subnets.
+    typedef std::unordered_map<asiolink::IOAddress, SubnetList,
+                               boost::hash<asiolink::IOAddress> > AddressMap;
+
+    /// @brief Type of the map of strings to candidate subnets.
+    typedef std::unordered_map<std::string, SubnetList> StringMap;
+
+    /// @brief Subnets by prefix, for each prefix length.
+    std::map<uint8_t, AddressMap> prefixes_;
+
+    /// @brief Subnets by relay address.
+    AddressMap relays_;
+
+    /// @brief Subnets by interface name.
+    StringMap ifaces_;
+
+    /// @brief Subnets by interface identifier.
+    StringMap interface_ids_;
+};
+
+}
+}
+
+#endif // SUBNET_SELECTION_INDEX_H
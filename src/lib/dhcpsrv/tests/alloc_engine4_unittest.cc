@@ -17,6 +17,8 @@
 #include <hooks/callout_handle.h>
 #include <stats/stats_mgr.h>
 
+#include <thread>
+
 using namespace std;
 using namespace isc::hooks;
 using namespace isc::asiolink;
@@ -32,11 +34,11 @@ namespace test {
 TEST_F(AllocEngine4Test, constructor) {
     boost::scoped_ptr<AllocEngine> x;
 
-    // Hashed and random allocators are not supported yet
-    ASSERT_THROW(x.reset(new AllocEngine(AllocEngine::ALLOC_HASHED, 5, false)),
-                 NotImplemented);
-    ASSERT_THROW(x.reset(new AllocEngine(AllocEngine::ALLOC_RANDOM, 5, false)),
-                 NotImplemented);
+    // Hashed and random allocators are supported
+    ASSERT_NO_THROW(x.reset(new AllocEngine(AllocEngine::ALLOC_HASHED, 5,
+                                            false)));
+    ASSERT_NO_THROW(x.reset(new AllocEngine(AllocEngine::ALLOC_RANDOM, 5,
+                                            false)));
 
     // Create V4 (ipv6=false) Allocation Engine that will try at most
     // 100 attempts to pick up a lease
@@ -910,6 +912,430 @@ TEST_F(AllocEngine4Test, IterativeAllocator_manyPools4) {
     }
 }
 
+// This test verifies that threads picking addresses concurrently from the
+// same subnet or from distinct subnets don't corrupt the iteration state:
+// the addresses of each pool are picked equally often.
+TEST_F(AllocEngine4Test, IterativeAllocator_mt) {
+    NakedAllocEngine::IterativeAllocator alloc(Lease::TYPE_V4);
+    Subnet4Ptr subnet2(new Subnet4(IOAddress("192.0.3.0"), 24, 1, 2, 3));
+    subnet2->addPool(Pool4Ptr(new Pool4(IOAddress("192.0.3.100"),
+                                        IOAddress("192.0.3.109"))));
+    ASSERT_NE(subnet_->getID(), subnet2->getID());
+
+    // Two threads pick from each subnet.
+    const int picks = 1000;
+    std::vector<Subnet4Ptr> subnets = { subnet_, subnet_, subnet2, subnet2 };
+    std::vector<std::vector<IOAddress> > picked(subnets.size());
+    isc::util::MultiThreadingMgr::instance().setMode(true);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < subnets.size(); ++t) {
+        threads.push_back(std::thread([&, t]() {
+            for (int i = 0; i < picks; ++i) {
+                picked[t].push_back(alloc.pickAddress(subnets[t], cc_,
+                                                      clientid_,
+                                                      IOAddress("0.0.0.0")));
+            }
+        }));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    isc::util::MultiThreadingMgr::instance().setMode(false);
+
+    // Each pool has 10 addresses picked 2 * picks times.
+    std::map<IOAddress, int> counts;
+    for (size_t t = 0; t < subnets.size(); ++t) {
+        for (auto const& address : picked[t]) {
+            EXPECT_TRUE(subnets[t]->inPool(Lease::TYPE_V4, address));
+            ++counts[address];
+        }
+    }
+    EXPECT_EQ(20, counts.size());
+    for (auto const& count : counts) {
+        EXPECT_EQ(2 * picks / 10, count.second) << count.first.toText();
+    }
+}
+
+// This test verifies that the random allocator picks each address of the
+// pool once before picking addresses again.
+TEST_F(AllocEngine4Test, RandomAllocator) {
+    boost::scoped_ptr<NakedAllocEngine::Allocator>
+        alloc(new NakedAllocEngine::RandomAllocator(Lease::TYPE_V4));
+
+    // The pool is 192.0.2.100 - 192.0.2.109.
+    std::set<IOAddress> generated_addrs;
+    for (int i = 0; i < 10; ++i) {
+        IOAddress candidate = alloc->pickAddress(subnet_, cc_, clientid_,
+                                                 IOAddress("0.0.0.0"));
+        EXPECT_TRUE(subnet_->inPool(Lease::TYPE_V4, candidate));
+        EXPECT_TRUE(generated_addrs.insert(candidate).second);
+    }
+
+    // The pool was walked over: the addresses are picked again.
+    for (int i = 0; i < 1000; ++i) {
+        IOAddress candidate = alloc->pickAddress(subnet_, cc_, clientid_,
+                                                 IOAddress("0.0.0.0"));
+        EXPECT_TRUE(subnet_->inPool(Lease::TYPE_V4, candidate));
+    }
+}
+
+// This test verifies that the random allocator picks addresses from the
+// pools allowed for the client classes only.
+TEST_F(AllocEngine4Test, RandomAllocator_class) {
+    boost::scoped_ptr<NakedAllocEngine::Allocator>
+        alloc(new NakedAllocEngine::RandomAllocator(Lease::TYPE_V4));
+
+    // Restrict pool_ to the foo class. Add a second pool with bar class.
+    pool_->allowClientClass("foo");
+    Pool4Ptr pool(new Pool4(IOAddress("192.0.2.200"),
+                            IOAddress("192.0.2.209")));
+    pool->allowClientClass("bar");
+    subnet_->addPool(pool);
+
+    // Clients are in bar
+    cc_.insert("bar");
+
+    for (int i = 0; i < 1000; ++i) {
+        IOAddress candidate = alloc->pickAddress(subnet_, cc_, clientid_,
+                                                 IOAddress("0.0.0.0"));
+        EXPECT_TRUE(subnet_->inPool(Lease::TYPE_V4, candidate, cc_));
+    }
+
+    // No pool is allowed for other clients.
+    ClientClasses cc;
+    cc.insert("baz");
+    EXPECT_THROW(alloc->pickAddress(subnet_, cc, clientid_,
+                                    IOAddress("0.0.0.0")),
+                 AllocFailed);
+}
+
+// This test verifies that the allocation engine using the random allocator
+// allocates all addresses of the pool.
+TEST_F(AllocEngine4Test, randomAlloc4) {
+    boost::scoped_ptr<AllocEngine> engine;
+    ASSERT_NO_THROW(engine.reset(new AllocEngine(AllocEngine::ALLOC_RANDOM,
+                                                 0, false)));
+    ASSERT_TRUE(engine);
+
+    std::set<IOAddress> addrs;
+    for (uint8_t i = 0; i < 10; ++i) {
+        std::vector<uint8_t> duid(8, i);
+        ClientIdPtr clientid(new ClientId(duid));
+        HWAddrPtr hwaddr(new HWAddr(duid, HTYPE_ETHER));
+        AllocEngine::ClientContext4 ctx(subnet_, clientid, hwaddr,
+                                        IOAddress("0.0.0.0"), false, false,
+                                        "", false);
+        ctx.query_.reset(new Pkt4(DHCPREQUEST, 1234 + i));
+        Lease4Ptr lease = engine->allocateLease4(ctx);
+        ASSERT_TRUE(lease);
+        EXPECT_TRUE(addrs.insert(lease->addr_).second);
+    }
+
+    // The pool is exhausted.
+    AllocEngine::ClientContext4 ctx(subnet_, clientid_, hwaddr_,
+                                    IOAddress("0.0.0.0"), false, false,
+                                    "", false);
+    ctx.query_.reset(new Pkt4(DHCPREQUEST, 1));
+    EXPECT_FALSE(engine->allocateLease4(ctx));
+}
+
+// This test verifies that the hashed allocator picks the same preferred
+// address for a client and then probes all addresses of the pool.
+TEST_F(AllocEngine4Test, HashedAllocator) {
+    NakedAllocEngine::HashedAllocator alloc(Lease::TYPE_V4);
+    NakedAllocEngine::HashedAllocator other(Lease::TYPE_V4);
+
+    // The preferred address only depends on the client identifier.
+    IOAddress preferred = alloc.getPreferredAddress(subnet_, cc_, clientid_);
+    EXPECT_TRUE(subnet_->inPool(Lease::TYPE_V4, preferred));
+    EXPECT_EQ(preferred, other.getPreferredAddress(subnet_, cc_, clientid_));
+    EXPECT_EQ(preferred, alloc.pickAddress(subnet_, cc_, clientid_,
+                                           IOAddress("0.0.0.0")));
+
+    // The pool is 192.0.2.100 - 192.0.2.109: the next picks probe the
+    // other addresses then the preferred address again.
+    std::set<IOAddress> generated_addrs;
+    IOAddress candidate = preferred;
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_TRUE(subnet_->inPool(Lease::TYPE_V4, candidate));
+        EXPECT_TRUE(generated_addrs.insert(candidate).second);
+        candidate = alloc.pickAddress(subnet_, cc_, clientid_, candidate);
+    }
+    EXPECT_EQ(preferred, candidate);
+
+    // Other clients get other preferred addresses.
+    std::set<IOAddress> preferred_addrs;
+    for (uint8_t i = 0; i < 100; ++i) {
+        ClientIdPtr clientid(new ClientId(std::vector<uint8_t>(8, i)));
+        preferred_addrs.insert(alloc.getPreferredAddress(subnet_, cc_,
+                                                         clientid));
+    }
+    EXPECT_LT(1, preferred_addrs.size());
+
+    // Clients without identifier get addresses as from the iterative
+    // allocator.
+    candidate = alloc.pickAddress(subnet_, cc_, DuidPtr(),
+                                  IOAddress("0.0.0.0"));
+    EXPECT_EQ("192.0.2.100", candidate.toText());
+}
+
+// This test verifies that the hashed allocator picks addresses from the
+// pools allowed for the client classes only.
+TEST_F(AllocEngine4Test, HashedAllocator_class) {
+    NakedAllocEngine::HashedAllocator alloc(Lease::TYPE_V4);
+
+    // Restrict pool_ to the foo class. Add a second pool with bar class.
+    pool_->allowClientClass("foo");
+    Pool4Ptr pool(new Pool4(IOAddress("192.0.2.200"),
+                            IOAddress("192.0.2.209")));
+    pool->allowClientClass("bar");
+    subnet_->addPool(pool);
+
+    // Clients are in bar
+    cc_.insert("bar");
+
+    IOAddress candidate("0.0.0.0");
+    for (int i = 0; i < 100; ++i) {
+        candidate = alloc.pickAddress(subnet_, cc_, clientid_, candidate);
+        EXPECT_TRUE(subnet_->inPool(Lease::TYPE_V4, candidate, cc_));
+    }
+
+    // No pool is allowed for other clients.
+    ClientClasses cc;
+    cc.insert("baz");
+    EXPECT_EQ("0.0.0.0",
+              alloc.getPreferredAddress(subnet_, cc, clientid_).toText());
+    EXPECT_THROW(alloc.pickAddress(subnet_, cc, clientid_,
+                                   IOAddress("0.0.0.0")),
+                 AllocFailed);
+}
+
+// This test verifies that the allocation engine using the hashed allocator
+// allocates all addresses of the pool, that two engines offer the same
+// address to a client and that the lease of a returning client is found
+// at its preferred address.
+TEST_F(AllocEngine4Test, hashedAlloc4) {
+    boost::scoped_ptr<AllocEngine> engine;
+    ASSERT_NO_THROW(engine.reset(new AllocEngine(AllocEngine::ALLOC_HASHED,
+                                                 0, false)));
+    boost::scoped_ptr<AllocEngine> other;
+    ASSERT_NO_THROW(other.reset(new AllocEngine(AllocEngine::ALLOC_HASHED,
+                                                0, false)));
+
+    // Both engines offer the same address.
+    AllocEngine::ClientContext4 ctx(subnet_, clientid_, hwaddr_,
+                                    IOAddress("0.0.0.0"), false, false,
+                                    "", true);
+    ctx.query_.reset(new Pkt4(DHCPDISCOVER, 1234));
+    Lease4Ptr offered = engine->allocateLease4(ctx);
+    ASSERT_TRUE(offered);
+    AllocEngine::ClientContext4 ctx2(subnet_, clientid_, hwaddr_,
+                                     IOAddress("0.0.0.0"), false, false,
+                                     "", true);
+    ctx2.query_.reset(new Pkt4(DHCPDISCOVER, 1234));
+    Lease4Ptr other_offered = other->allocateLease4(ctx2);
+    ASSERT_TRUE(other_offered);
+    EXPECT_EQ(offered->addr_, other_offered->addr_);
+
+    // Allocate the lease.
+    AllocEngine::ClientContext4 ctx3(subnet_, clientid_, hwaddr_,
+                                     IOAddress("0.0.0.0"), false, false,
+                                     "", false);
+    ctx3.query_.reset(new Pkt4(DHCPREQUEST, 1234));
+    Lease4Ptr lease = engine->allocateLease4(ctx3);
+    ASSERT_TRUE(lease);
+    EXPECT_EQ(offered->addr_, lease->addr_);
+
+    // The returning client gets its lease from the first lookup.
+    ObservationPtr hits =
+        StatsMgr::instance().getObservation("v4-hashed-allocator-hits");
+    int64_t hits_before = (hits ? hits->getInteger().first : 0);
+    AllocEngine::ClientContext4 ctx4(subnet_, clientid_, hwaddr_,
+                                     IOAddress("0.0.0.0"), false, false,
+                                     "", true);
+    ctx4.query_.reset(new Pkt4(DHCPDISCOVER, 1234));
+    Lease4Ptr renewed = engine->allocateLease4(ctx4);
+    ASSERT_TRUE(renewed);
+    EXPECT_EQ(lease->addr_, renewed->addr_);
+    hits = StatsMgr::instance().getObservation("v4-hashed-allocator-hits");
+    ASSERT_TRUE(hits);
+    EXPECT_EQ(hits_before + 1, hits->getInteger().first);
+
+    // Other clients get the other addresses of the pool.
+    std::set<IOAddress> addrs;
+    addrs.insert(lease->addr_);
+    for (uint8_t i = 0; i < 9; ++i) {
+        std::vector<uint8_t> duid(8, i);
+        ClientIdPtr clientid(new ClientId(duid));
+        HWAddrPtr hwaddr(new HWAddr(duid, HTYPE_ETHER));
+        AllocEngine::ClientContext4 client_ctx(subnet_, clientid, hwaddr,
+                                               IOAddress("0.0.0.0"), false,
+                                               false, "", false);
+        client_ctx.query_.reset(new Pkt4(DHCPREQUEST, 1234 + i));
+        Lease4Ptr client_lease = engine->allocateLease4(client_ctx);
+        ASSERT_TRUE(client_lease);
+        EXPECT_TRUE(addrs.insert(client_lease->addr_).second);
+    }
+
+    // The pool is exhausted.
+    std::vector<uint8_t> duid(8, 0x99);
+    ClientIdPtr clientid(new ClientId(duid));
+    HWAddrPtr hwaddr(new HWAddr(duid, HTYPE_ETHER));
+    AllocEngine::ClientContext4 ctx5(subnet_, clientid, hwaddr,
+                                     IOAddress("0.0.0.0"), false, false,
+                                     "", false);
+    ctx5.query_.reset(new Pkt4(DHCPREQUEST, 1));
+    EXPECT_FALSE(engine->allocateLease4(ctx5));
+}
+
+// This test verifies that the free lease queue allocator hands out each
+// free address of the pool once and skips the used addresses.
+TEST_F(AllocEngine4Test, FreeLeaseQueueAllocator) {
+    NakedAllocEngine::FreeLeaseQueueAllocator alloc(Lease::TYPE_V4);
+
+    // The pool is 192.0.2.100 - 192.0.2.109 and two addresses are leased.
+    std::set<IOAddress> used;
+    used.insert(IOAddress("192.0.2.100"));
+    used.insert(IOAddress("192.0.2.105"));
+    ASSERT_NO_THROW(alloc.populate(subnet_, used));
+
+    std::set<IOAddress> generated_addrs;
+    for (int i = 0; i < 8; ++i) {
+        IOAddress candidate = alloc.pickAddress(subnet_, cc_, clientid_,
+                                                IOAddress("0.0.0.0"));
+        EXPECT_TRUE(subnet_->inPool(Lease::TYPE_V4, candidate));
+        EXPECT_EQ(0, used.count(candidate));
+        EXPECT_TRUE(generated_addrs.insert(candidate).second);
+        alloc.addressUsed(candidate, 32);
+    }
+
+    // All addresses are used: the allocator has nothing to offer.
+    EXPECT_EQ("0.0.0.0", alloc.pickAddress(subnet_, cc_, clientid_,
+                                           IOAddress("0.0.0.0")).toText());
+
+    // A freed address is offered again.
+    alloc.addressFreed(IOAddress("192.0.2.105"), 32);
+    EXPECT_EQ("192.0.2.105", alloc.pickAddress(subnet_, cc_, clientid_,
+                                               IOAddress("0.0.0.0")).toText());
+
+    // Pools which were not populated use the iterative allocation.
+    alloc.clear();
+    IOAddress candidate = alloc.pickAddress(subnet_, cc_, clientid_,
+                                            IOAddress("0.0.0.0"));
+    EXPECT_TRUE(subnet_->inPool(Lease::TYPE_V4, candidate));
+}
+
+// This test verifies that the allocation engine using the free lease queue
+// allocator doesn't pick addresses leased before its initialization and
+// picks released addresses again.
+TEST_F(AllocEngine4Test, freeLeaseQueueAlloc4) {
+    boost::scoped_ptr<AllocEngine> engine;
+    ASSERT_NO_THROW(engine.reset(new AllocEngine(AllocEngine::ALLOC_FLQ,
+                                                 0, false)));
+    ASSERT_TRUE(engine);
+    EXPECT_EQ(AllocEngine::ALLOC_FLQ, engine->getAllocType());
+
+    // Lease the first address of the pool to another client.
+    uint8_t clientid2[] = { 8, 7, 6, 5, 4, 3, 2, 1 };
+    Lease4Ptr lease(new Lease4(IOAddress("192.0.2.100"), hwaddr2_, clientid2,
+                               sizeof(clientid2), 501, time(NULL),
+                               subnet_->getID()));
+    ASSERT_TRUE(LeaseMgrFactory::instance().addLease(lease));
+
+    ASSERT_NO_THROW(engine->initFreeLeaseQueues(CfgMgr::instance().
+        getStagingCfg()->getCfgSubnets4()));
+
+    // The 9 other addresses are allocated to distinct clients.
+    std::vector<Lease4Ptr> leases;
+    for (uint8_t i = 0; i < 9; ++i) {
+        std::vector<uint8_t> duid(8, i);
+        ClientIdPtr clientid(new ClientId(duid));
+        HWAddrPtr hwaddr(new HWAddr(duid, HTYPE_ETHER));
+        AllocEngine::ClientContext4 ctx(subnet_, clientid, hwaddr,
+                                        IOAddress("0.0.0.0"), false, false,
+                                        "", false);
+        ctx.query_.reset(new Pkt4(DHCPREQUEST, 1234 + i));
+        Lease4Ptr new_lease = engine->allocateLease4(ctx);
+        ASSERT_TRUE(new_lease);
+        EXPECT_NE("192.0.2.100", new_lease->addr_.toText());
+        leases.push_back(new_lease);
+    }
+
+    // The pool is exhausted.
+    AllocEngine::ClientContext4 ctx(subnet_, clientid_, hwaddr_,
+                                    IOAddress("0.0.0.0"), false, false,
+                                    "", false);
+    ctx.query_.reset(new Pkt4(DHCPREQUEST, 1));
+    EXPECT_FALSE(engine->allocateLease4(ctx));
+
+    // Release a lease: its address is allocated to the next client.
+    ASSERT_TRUE(LeaseMgrFactory::instance().deleteLease(leases[3]));
+    engine->leaseFreed(leases[3]);
+    ctx.query_.reset(new Pkt4(DHCPREQUEST, 2));
+    Lease4Ptr new_lease = engine->allocateLease4(ctx);
+    ASSERT_TRUE(new_lease);
+    EXPECT_EQ(leases[3]->addr_, new_lease->addr_);
+}
+
+// This test verifies that the allocation type of a subnet is given by its
+// allocator parameter and that the free lease queue is populated with the
+// pools of the subnets using the free lease queue allocator.
+TEST_F(AllocEngine4Test, subnetAllocator4) {
+    boost::scoped_ptr<AllocEngine> engine;
+    ASSERT_NO_THROW(engine.reset(new AllocEngine(AllocEngine::ALLOC_ITERATIVE,
+                                                 0, false)));
+    ASSERT_TRUE(engine);
+
+    // The subnet uses the allocation type given to the constructor
+    // unless it specifies an allocator.
+    EXPECT_EQ(AllocEngine::ALLOC_ITERATIVE, engine->getAllocType(subnet_));
+    subnet_->setAllocatorType("random");
+    EXPECT_EQ(AllocEngine::ALLOC_RANDOM, engine->getAllocType(subnet_));
+    subnet_->setAllocatorType("hashed");
+    EXPECT_EQ(AllocEngine::ALLOC_HASHED, engine->getAllocType(subnet_));
+    subnet_->setAllocatorType("flq");
+    EXPECT_EQ(AllocEngine::ALLOC_FLQ, engine->getAllocType(subnet_));
+    EXPECT_EQ(AllocEngine::ALLOC_ITERATIVE, engine->getAllocType());
+
+    // Lease the first address of the pool to another client.
+    uint8_t clientid2[] = { 8, 7, 6, 5, 4, 3, 2, 1 };
+    Lease4Ptr lease(new Lease4(IOAddress("192.0.2.100"), hwaddr2_, clientid2,
+                               sizeof(clientid2), 501, time(NULL),
+                               subnet_->getID()));
+    ASSERT_TRUE(LeaseMgrFactory::instance().addLease(lease));
+
+    // The pool of the subnet is put in the free lease queue.
+    ASSERT_NO_THROW(engine->initFreeLeaseQueues(CfgMgr::instance().
+        getStagingCfg()->getCfgSubnets4()));
+    IOAddress candidate = engine->getAllocator(Lease::TYPE_V4,
+                                               AllocEngine::ALLOC_FLQ)->
+        pickAddress(subnet_, cc_, clientid_, IOAddress("0.0.0.0"));
+    EXPECT_EQ("192.0.2.101", candidate.toText());
+
+    // The other addresses are allocated from the queue.
+    for (uint8_t i = 0; i < 9; ++i) {
+        std::vector<uint8_t> duid(8, i);
+        ClientIdPtr clientid(new ClientId(duid));
+        HWAddrPtr hwaddr(new HWAddr(duid, HTYPE_ETHER));
+        AllocEngine::ClientContext4 ctx(subnet_, clientid, hwaddr,
+                                        IOAddress("0.0.0.0"), false, false,
+                                        "", false);
+        ctx.query_.reset(new Pkt4(DHCPREQUEST, 1234 + i));
+        Lease4Ptr new_lease = engine->allocateLease4(ctx);
+        ASSERT_TRUE(new_lease);
+        EXPECT_NE("192.0.2.100", new_lease->addr_.toText());
+    }
+
+    // The subnet no longer uses the free lease queue allocator: its pool
+    // is not put in the queue.
+    subnet_->setAllocatorType(isc::util::Optional<std::string>());
+    ASSERT_NO_THROW(engine->initFreeLeaseQueues(CfgMgr::instance().
+        getStagingCfg()->getCfgSubnets4()));
+    candidate = engine->getAllocator(Lease::TYPE_V4, AllocEngine::ALLOC_FLQ)->
+        pickAddress(subnet_, cc_, clientid_, IOAddress("0.0.0.0"));
+    EXPECT_TRUE(subnet_->inPool(Lease::TYPE_V4, candidate));
+}
+
 
 // This test checks if really small pools are working
 TEST_F(AllocEngine4Test, smallPool4) {
@@ -1370,6 +1796,42 @@ TEST_F(SharedNetworkAlloc4Test, runningOut) {
     EXPECT_FALSE(lease);
 }
 
+// This test verifies that a subnet which pools are exhausted according to
+// their free leases counters is tried after the other subnets.
+TEST_F(SharedNetworkAlloc4Test, skipExhausted) {
+    // The pool of the first subnet is exhausted according to its counter
+    // but its address is not leased.
+    pool1_->setAssigned(1);
+
+    AllocEngine::ClientContext4
+        ctx(subnet1_, ClientIdPtr(), hwaddr_, IOAddress::IPV4_ZERO_ADDRESS(),
+            false, false, "host.example.com.", true);
+    ctx.query_.reset(new Pkt4(DHCPDISCOVER, 1234));
+    Lease4Ptr lease = engine_.allocateLease4(ctx);
+
+    // The address is offered from the second subnet.
+    ASSERT_TRUE(lease);
+    EXPECT_TRUE(subnet2_->inPool(Lease::TYPE_V4, lease->addr_));
+
+    // When all the pools are exhausted according to their counters, the
+    // subnets are still tried so an address is offered.
+    pool2_->setAssigned(pool2_->getCapacity());
+    ctx.subnet_ = subnet1_;
+    lease = engine_.allocateLease4(ctx);
+    ASSERT_TRUE(lease);
+
+    // When the pools are really exhausted nothing is offered.
+    insertLease("192.0.2.17", subnet1_->getID());
+    for (int i = 5; i <= 100; i++) {
+        stringstream tmp;
+        tmp << "10.1.2." << i;
+        insertLease(tmp.str(), subnet2_->getID());
+    }
+    ctx.subnet_ = subnet1_;
+    lease = engine_.allocateLease4(ctx);
+    EXPECT_FALSE(lease);
+}
+
 // This test verifies that the server can offer an address from a
 // subnet and the introduction of shared network doesn't break anything here.
 TEST_F(SharedNetworkAlloc4Test, requestSharedNetworkSimple) {
@@ -2050,6 +2512,48 @@ TEST_F(AllocEngine4Test, requestOtherClientLease) {
     EXPECT_EQ("192.0.2.101", new_lease->addr_.toText());
 }
 
+// This test checks that the leases which may belong to the client and the
+// lease for the requested address are fetched by one lookup.
+TEST_F(AllocEngine4Test, prefetchClientLeases4) {
+    Lease4Ptr lease(new Lease4(IOAddress("192.0.2.101"), hwaddr_, clientid_,
+                               100, time(NULL), subnet_->getID()));
+    Lease4Ptr lease2(new Lease4(IOAddress("192.0.2.102"), hwaddr2_, clientid2_,
+                                100, time(NULL), subnet_->getID()));
+    LeaseMgrFactory::instance().addLease(lease);
+    LeaseMgrFactory::instance().addLease(lease2);
+
+    AllocEngine engine(AllocEngine::ALLOC_ITERATIVE, 0, false);
+
+    // The client requests the address of the other client.
+    AllocEngine::ClientContext4 ctx(subnet_, clientid_, hwaddr_, IOAddress("192.0.2.102"),
+                                    false, false, "", false);
+    ctx.query_.reset(new Pkt4(DHCPREQUEST, 1234));
+    Lease4Ptr new_lease = engine.allocateLease4(ctx);
+    ASSERT_FALSE(new_lease);
+
+    // Both leases were prefetched.
+    EXPECT_TRUE(ctx.leases_prefetched_);
+    EXPECT_EQ("192.0.2.102", ctx.prefetched_address_.toText());
+    ASSERT_EQ(2, ctx.prefetched_leases_.size());
+    std::set<std::string> addresses;
+    for (auto const& l : ctx.prefetched_leases_) {
+        addresses.insert(l->addr_.toText());
+    }
+    EXPECT_EQ(1, addresses.count("192.0.2.101"));
+    EXPECT_EQ(1, addresses.count("192.0.2.102"));
+
+    // The requested address is only a hint in the DHCPDISCOVER case so
+    // only the lease of the client is prefetched.
+    ctx.fake_allocation_ = true;
+    new_lease = engine.allocateLease4(ctx);
+    ASSERT_TRUE(new_lease);
+    EXPECT_EQ("192.0.2.101", new_lease->addr_.toText());
+    EXPECT_TRUE(ctx.leases_prefetched_);
+    EXPECT_TRUE(ctx.prefetched_address_.isV4Zero());
+    ASSERT_EQ(1, ctx.prefetched_leases_.size());
+    EXPECT_EQ("192.0.2.101", ctx.prefetched_leases_[0]->addr_.toText());
+}
+
 // This test checks the behavior of the allocation engine in the following
 // scenario:
 // - Client has no lease in the database.
@@ -55,9 +55,9 @@ TEST(ClientContext6Test, addAllocatedResource) {
 TEST_F(AllocEngine6Test, constructor) {
     boost::scoped_ptr<AllocEngine> x;
 
-    // Hashed and random allocators are not supported yet
-    ASSERT_THROW(x.reset(new AllocEngine(AllocEngine::ALLOC_HASHED, 5)), NotImplemented);
-    ASSERT_THROW(x.reset(new AllocEngine(AllocEngine::ALLOC_RANDOM, 5)), NotImplemented);
+    // Hashed and random allocators are supported
+    ASSERT_NO_THROW(x.reset(new AllocEngine(AllocEngine::ALLOC_HASHED, 5)));
+    ASSERT_NO_THROW(x.reset(new AllocEngine(AllocEngine::ALLOC_RANDOM, 5)));
 
     ASSERT_NO_THROW(x.reset(new AllocEngine(AllocEngine::ALLOC_ITERATIVE, 100, true)));
 
@@ -309,6 +309,77 @@ TEST_F(AllocEngine6Test, IterativeAllocator_class) {
     }
 }
 
+// This test verifies that the random allocator picks addresses and
+// prefixes that belong to the pools, without repeats.
+TEST_F(AllocEngine6Test, RandomAllocator) {
+    NakedAllocEngine::RandomAllocator alloc(Lease::TYPE_NA);
+
+    // The pool is 2001:db8:1::10 - 2001:db8:1::20.
+    std::set<IOAddress> generated_addrs;
+    for (int i = 0; i < 17; ++i) {
+        IOAddress candidate = alloc.pickAddress(subnet_, cc_,
+                                                duid_, IOAddress("::"));
+        EXPECT_TRUE(subnet_->inPool(Lease::TYPE_NA, candidate));
+        EXPECT_TRUE(generated_addrs.insert(candidate).second);
+    }
+
+    // The prefix pool is 2001:db8:1:2::/64 with delegated /80 prefixes.
+    NakedAllocEngine::RandomAllocator pd_alloc(Lease::TYPE_PD);
+    std::set<IOAddress> generated_prefixes;
+    for (int i = 0; i < 1000; ++i) {
+        IOAddress candidate = pd_alloc.pickAddress(subnet_, cc_,
+                                                   duid_, IOAddress("::"));
+        EXPECT_TRUE(subnet_->inPool(Lease::TYPE_PD, candidate));
+        EXPECT_TRUE(generated_prefixes.insert(candidate).second);
+        // The low 48 bits of a delegated /80 prefix are zero.
+        const std::vector<uint8_t>& bytes = candidate.toBytes();
+        EXPECT_TRUE(std::all_of(bytes.begin() + 10, bytes.end(),
+                                [](uint8_t b) { return (b == 0); }))
+            << candidate.toText();
+    }
+}
+
+// This test verifies that the hashed allocator picks the same preferred
+// address or prefix for a client and then probes the pool.
+TEST_F(AllocEngine6Test, HashedAllocator) {
+    NakedAllocEngine::HashedAllocator alloc(Lease::TYPE_NA);
+    NakedAllocEngine::HashedAllocator other(Lease::TYPE_NA);
+
+    // The pool is 2001:db8:1::10 - 2001:db8:1::20.
+    IOAddress preferred = alloc.getPreferredAddress(subnet_, cc_, duid_);
+    EXPECT_TRUE(subnet_->inPool(Lease::TYPE_NA, preferred));
+    EXPECT_EQ(preferred, other.getPreferredAddress(subnet_, cc_, duid_));
+    std::set<IOAddress> generated_addrs;
+    IOAddress candidate = alloc.pickAddress(subnet_, cc_, duid_,
+                                            IOAddress("::"));
+    EXPECT_EQ(preferred, candidate);
+    for (int i = 0; i < 17; ++i) {
+        EXPECT_TRUE(subnet_->inPool(Lease::TYPE_NA, candidate));
+        EXPECT_TRUE(generated_addrs.insert(candidate).second);
+        candidate = alloc.pickAddress(subnet_, cc_, duid_, candidate);
+    }
+    EXPECT_EQ(preferred, candidate);
+
+    // The prefix pool is 2001:db8:1:2::/64 with delegated /80 prefixes.
+    NakedAllocEngine::HashedAllocator pd_alloc(Lease::TYPE_PD);
+    IOAddress preferred_prefix = pd_alloc.getPreferredAddress(subnet_, cc_,
+                                                              duid_);
+    EXPECT_EQ(preferred_prefix, pd_alloc.pickAddress(subnet_, cc_, duid_,
+                                                     IOAddress("::")));
+    std::set<IOAddress> generated_prefixes;
+    candidate = IOAddress("::");
+    for (int i = 0; i < 1000; ++i) {
+        candidate = pd_alloc.pickAddress(subnet_, cc_, duid_, candidate);
+        EXPECT_TRUE(subnet_->inPool(Lease::TYPE_PD, candidate));
+        EXPECT_TRUE(generated_prefixes.insert(candidate).second);
+        // The low 48 bits of a delegated /80 prefix are zero.
+        const std::vector<uint8_t>& bytes = candidate.toBytes();
+        EXPECT_TRUE(std::all_of(bytes.begin() + 10, bytes.end(),
+                                [](uint8_t b) { return (b == 0); }))
+            << candidate.toText();
+    }
+}
+
 TEST_F(AllocEngine6Test, IterativeAllocatorAddrStep) {
     NakedAllocEngine::NakedIterativeAllocator alloc(Lease::TYPE_NA);
 
@@ -3054,6 +3125,32 @@ TEST_F(SharedNetworkAlloc6Test, solicitSharedNetworkOutOfAddresses) {
     ASSERT_TRUE(subnet1_->inRange(lease2->addr_));
 }
 
+// This test verifies that a subnet which pools are exhausted according to
+// their free leases counters is tried after the other subnets.
+TEST_F(SharedNetworkAlloc6Test, solicitSharedNetworkSkipExhausted) {
+    // The pool of the first subnet is exhausted according to its counter
+    // but its address is not leased.
+    pool1_->setAssigned(1);
+
+    Pkt6Ptr query(new Pkt6(DHCPV6_SOLICIT, 1234));
+    AllocEngine::ClientContext6 ctx(subnet1_, duid_, false, false, "", true,
+                                    query);
+    ctx.currentIA().iaid_ = iaid_;
+
+    // The address is offered from the second subnet.
+    Lease6Ptr lease;
+    ASSERT_NO_THROW(lease = expectOneLease(engine_.allocateLeases6(ctx)));
+    ASSERT_TRUE(lease);
+    EXPECT_TRUE(subnet2_->inRange(lease->addr_));
+
+    // When all the pools are exhausted according to their counters, the
+    // subnets are still tried so an address is offered.
+    pool2_->setAssigned(pool2_->getCapacity());
+    ctx.subnet_ = subnet1_;
+    ASSERT_NO_THROW(lease = expectOneLease(engine_.allocateLeases6(ctx)));
+    ASSERT_TRUE(lease);
+}
+
 // This test verifies that the server can offer an address from a
 // different subnet than orginally selected, when the address pool in
 // the first subnet is exhausted.
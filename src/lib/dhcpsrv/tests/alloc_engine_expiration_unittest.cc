@@ -12,6 +12,7 @@
 #include <dhcpsrv/testutils/test_utils.h>
 #include <hooks/hooks_manager.h>
 #include <stats/stats_mgr.h>
+#include <testutils/multi_threading_utils.h>
 #include <gtest/gtest.h>
 #include <boost/static_assert.hpp>
 #include <functional>
@@ -29,6 +30,7 @@ using namespace isc::dhcp::test;
 using namespace isc::dhcp_ddns;
 using namespace isc::hooks;
 using namespace isc::stats;
+using namespace isc::test;
 namespace ph = std::placeholders;
 
 namespace {
@@ -1535,6 +1537,43 @@ TEST_F(ExpirationAllocEngine6Test, reclaimExpiredLeasesStats) {
     testReclaimExpiredLeasesStats();
 }
 
+// This test verifies that the reclamation batch size and threads are
+// checked.
+TEST_F(ExpirationAllocEngine6Test, reclaimBatchParameters) {
+    EXPECT_THROW(engine_->setReclaimBatchSize(0), BadValue);
+    EXPECT_THROW(engine_->setReclaimBatchSize(AllocEngine::MAX_RECLAIM_BATCH_SIZE + 1),
+                 BadValue);
+    EXPECT_THROW(engine_->setReclaimThreads(AllocEngine::MAX_RECLAIM_THREADS + 1),
+                 BadValue);
+    ASSERT_NO_THROW(engine_->setReclaimBatchSize(3));
+    EXPECT_EQ(3, engine_->getReclaimBatchSize());
+    ASSERT_NO_THROW(engine_->setReclaimThreads(2));
+    EXPECT_EQ(2, engine_->getReclaimThreads());
+    ASSERT_NO_THROW(engine_->setReclaimThreads(0));
+    EXPECT_EQ(0, engine_->getReclaimThreads());
+}
+
+// This test verifies that the leases can be reclaimed by batches.
+TEST_F(ExpirationAllocEngine6Test, reclaimExpiredLeasesBatchUpdateState) {
+    ASSERT_NO_THROW(engine_->setReclaimBatchSize(7));
+    testReclaimExpiredLeasesUpdateState();
+}
+
+// This test verifies that the leases can be deleted by batches.
+TEST_F(ExpirationAllocEngine6Test, reclaimExpiredLeasesBatchDelete) {
+    ASSERT_NO_THROW(engine_->setReclaimBatchSize(7));
+    testReclaimExpiredLeasesDelete();
+}
+
+// This test verifies that statistics is correctly updated when the leases
+// are reclaimed by batches in parallel by subnet.
+TEST_F(ExpirationAllocEngine6Test, reclaimExpiredLeasesStatsMultiThreading) {
+    MultiThreadingTest mt(true);
+    ASSERT_NO_THROW(engine_->setReclaimBatchSize(3));
+    ASSERT_NO_THROW(engine_->setReclaimThreads(2));
+    testReclaimExpiredLeasesStats();
+}
+
 // This test verifies that callouts are executed for each expired lease.
 TEST_F(ExpirationAllocEngine6Test, reclaimExpiredLeasesHooks) {
     testReclaimExpiredLeasesHooks();
@@ -2200,6 +2239,43 @@ TEST_F(ExpirationAllocEngine4Test, reclaimExpiredLeasesStats) {
     testReclaimExpiredLeasesStats();
 }
 
+// This test verifies that the reclamation batch size and threads are
+// checked.
+TEST_F(ExpirationAllocEngine4Test, reclaimBatchParameters) {
+    EXPECT_THROW(engine_->setReclaimBatchSize(0), BadValue);
+    EXPECT_THROW(engine_->setReclaimBatchSize(AllocEngine::MAX_RECLAIM_BATCH_SIZE + 1),
+                 BadValue);
+    EXPECT_THROW(engine_->setReclaimThreads(AllocEngine::MAX_RECLAIM_THREADS + 1),
+                 BadValue);
+    ASSERT_NO_THROW(engine_->setReclaimBatchSize(3));
+    EXPECT_EQ(3, engine_->getReclaimBatchSize());
+    ASSERT_NO_THROW(engine_->setReclaimThreads(2));
+    EXPECT_EQ(2, engine_->getReclaimThreads());
+    ASSERT_NO_THROW(engine_->setReclaimThreads(0));
+    EXPECT_EQ(0, engine_->getReclaimThreads());
+}
+
+// This test verifies that the leases can be reclaimed by batches.
+TEST_F(ExpirationAllocEngine4Test, reclaimExpiredLeasesBatchUpdateState) {
+    ASSERT_NO_THROW(engine_->setReclaimBatchSize(7));
+    testReclaimExpiredLeasesUpdateState();
+}
+
+// This test verifies that the leases can be deleted by batches.
+TEST_F(ExpirationAllocEngine4Test, reclaimExpiredLeasesBatchDelete) {
+    ASSERT_NO_THROW(engine_->setReclaimBatchSize(7));
+    testReclaimExpiredLeasesDelete();
+}
+
+// This test verifies that statistics is correctly updated when the leases
+// are reclaimed by batches in parallel by subnet.
+TEST_F(ExpirationAllocEngine4Test, reclaimExpiredLeasesStatsMultiThreading) {
+    MultiThreadingTest mt(true);
+    ASSERT_NO_THROW(engine_->setReclaimBatchSize(3));
+    ASSERT_NO_THROW(engine_->setReclaimThreads(2));
+    testReclaimExpiredLeasesStats();
+}
+
 // This test verifies that callouts are executed for each expired lease.
 TEST_F(ExpirationAllocEngine4Test, reclaimExpiredLeasesHooks) {
     testReclaimExpiredLeasesHooks();
@@ -73,6 +73,9 @@ public:
     // Expose internal classes for testing purposes
     using AllocEngine::Allocator;
     using AllocEngine::IterativeAllocator;
+    using AllocEngine::HashedAllocator;
+    using AllocEngine::RandomAllocator;
+    using AllocEngine::FreeLeaseQueueAllocator;
     using AllocEngine::getAllocator;
     using AllocEngine::updateLease4ExtendedInfo;
 
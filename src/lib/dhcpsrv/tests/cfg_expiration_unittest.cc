@@ -112,6 +112,10 @@ TEST(CfgExpirationTest, defaults) {
               cfg.getMaxReclaimTime());
     EXPECT_EQ(CfgExpiration::DEFAULT_UNWARNED_RECLAIM_CYCLES,
               cfg.getUnwarnedReclaimCycles());
+    EXPECT_EQ(CfgExpiration::DEFAULT_RECLAIM_BATCH_SIZE,
+              cfg.getReclaimBatchSize());
+    EXPECT_EQ(CfgExpiration::DEFAULT_RECLAIM_THREADS,
+              cfg.getReclaimThreads());
 }
 
 /// @brief Tests that unparse returns an expected value
@@ -125,6 +129,21 @@ TEST(CfgExpirationTest, unparse) {
         "\"max-reclaim-time\": 250,\n"
         "\"unwarned-reclaim-cycles\": 5 }";
     isc::test::runToElementTest<CfgExpiration>(defaults, cfg);
+
+    // The reclamation batches and threads are unparsed only when they
+    // are not the defaults.
+    cfg.setReclaimBatchSize(100);
+    cfg.setReclaimThreads(4);
+    std::string batches = "{\n"
+        "\"reclaim-timer-wait-time\": 10,\n"
+        "\"flush-reclaimed-timer-wait-time\": 25,\n"
+        "\"hold-reclaimed-time\": 3600,\n"
+        "\"max-reclaim-leases\": 100,\n"
+        "\"max-reclaim-time\": 250,\n"
+        "\"unwarned-reclaim-cycles\": 5,\n"
+        "\"reclaim-batch-size\": 100,\n"
+        "\"reclaim-threads\": 4 }";
+    isc::test::runToElementTest<CfgExpiration>(batches, cfg);
 }
 
 // Test the {get,set}ReclaimTimerWaitTime.
@@ -169,6 +188,29 @@ TEST(CfgExpirationTest, getUnwarnedReclaimCycles) {
                            &CfgExpiration::getUnwarnedReclaimCycles);
 }
 
+// Test the {get,set}ReclaimBatchSize.
+TEST(CfgExpirationTest, getReclaimBatchSize) {
+    CfgExpiration cfg;
+
+    // A batch holds at least one lease.
+    EXPECT_THROW(cfg.setReclaimBatchSize(0), OutOfRange);
+    EXPECT_THROW(cfg.setReclaimBatchSize(-1), OutOfRange);
+    EXPECT_THROW(cfg.setReclaimBatchSize(CfgExpiration::LIMIT_RECLAIM_BATCH_SIZE + 1),
+                 OutOfRange);
+
+    ASSERT_NO_THROW(cfg.setReclaimBatchSize(CfgExpiration::LIMIT_RECLAIM_BATCH_SIZE));
+    EXPECT_EQ(CfgExpiration::LIMIT_RECLAIM_BATCH_SIZE, cfg.getReclaimBatchSize());
+    ASSERT_NO_THROW(cfg.setReclaimBatchSize(1));
+    EXPECT_EQ(1, cfg.getReclaimBatchSize());
+}
+
+// Test the {get,set}ReclaimThreads.
+TEST(CfgExpirationTest, getReclaimThreads) {
+    testAccessModifyUint16(CfgExpiration::LIMIT_RECLAIM_THREADS,
+                           &CfgExpiration::setReclaimThreads,
+                           &CfgExpiration::getReclaimThreads);
+}
+
 /// @brief Implements test routines for leases reclamation.
 ///
 /// This class implements two routines called by the @c CfgExpiration object
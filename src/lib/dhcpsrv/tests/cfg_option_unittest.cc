@@ -17,9 +17,11 @@
 #include <dhcpsrv/cfg_option.h>
 #include <testutils/gtest_utils.h>
 #include <testutils/test_to_element.h>
+#include <util/buffer.h>
 #include <boost/foreach.hpp>
 #include <boost/pointer_cast.hpp>
 #include <gtest/gtest.h>
+#include <cstring>
 #include <iterator>
 #include <limits>
 #include <list>
@@ -752,6 +754,54 @@ TEST_F(CfgOptionTest, encapsulate) {
     }
 }
 
+// This test verifies that the wire data of the options is created and
+// created again when encapsulated options are deleted.
+TEST_F(CfgOptionTest, createWireData) {
+    CfgOption cfg;
+
+    generateEncapsulatedOptions(cfg);
+    ASSERT_NO_THROW(cfg.encapsulate());
+    ASSERT_NO_THROW(cfg.createWireData());
+
+    // Checks that an option has wire data matching its contents.
+    auto checkWireData = [](const OptionPtr& option) {
+        ASSERT_TRUE(option);
+        ASSERT_TRUE(option->hasWireData());
+        isc::util::OutputBuffer wire(0);
+        option->toWire(wire);
+        OptionPtr copy = option->clone();
+        ASSERT_FALSE(copy->hasWireData());
+        isc::util::OutputBuffer packed(0);
+        copy->pack(packed);
+        ASSERT_EQ(packed.getLength(), wire.getLength());
+        EXPECT_EQ(0, memcmp(packed.getData(), wire.getData(),
+                            wire.getLength()));
+    };
+
+    for (auto space : cfg.getOptionSpaceNames()) {
+        for (auto desc : *cfg.getAll(space)) {
+            checkWireData(desc.option_);
+        }
+    }
+
+    // Deleting an option of the "foo-subs" space modifies the options of
+    // the "foo" space and the top level options encapsulating them.
+    ASSERT_EQ(1, cfg.del("foo-subs", 5));
+    for (uint16_t code = 1000; code < 1020; ++code) {
+        OptionPtr option = cfg.get(DHCP6_OPTION_SPACE, code).option_;
+        checkWireData(option);
+        EXPECT_FALSE(option->getOption(1)->getOption(5));
+    }
+
+    // Same after deleting options by id.
+    ASSERT_EQ(2, cfg.del(1));
+    for (auto space : cfg.getOptionSpaceNames()) {
+        for (auto desc : *cfg.getAll(space)) {
+            checkWireData(desc.option_);
+        }
+    }
+}
+
 // This test verifies that an option can be deleted from the configuration.
 TEST_F(CfgOptionTest, deleteOptions) {
     CfgOption cfg;
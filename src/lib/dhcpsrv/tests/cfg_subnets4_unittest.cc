@@ -1010,6 +1010,184 @@ TEST(CfgSubnets4Test, 4o6subnetMatchByInterfaceName) {
     EXPECT_EQ(subnet2, cfg.selectSubnet4o6(selector));
 }
 
+// This test verifies that the subnet selection using the index returns the
+// same subnets as the scan of all subnets.
+TEST(CfgSubnets4Test, selectSubnetIndex) {
+    IfaceMgrTestConfig config(true);
+
+    CfgSubnets4 cfg;
+
+    // Create overlapping subnets: the subnet with the lowest identifier
+    // which supports the client classes is selected.
+    Subnet4Ptr subnet1(new Subnet4(IOAddress("10.1.2.0"), 24, 1, 2, 3, 1));
+    Subnet4Ptr subnet2(new Subnet4(IOAddress("10.1.0.0"), 16, 1, 2, 3, 2));
+    Subnet4Ptr subnet3(new Subnet4(IOAddress("10.0.0.0"), 8, 1, 2, 3, 3));
+    Subnet4Ptr subnet4(new Subnet4(IOAddress("192.0.2.0"), 24, 1, 2, 3, 4));
+    Subnet4Ptr subnet5(new Subnet4(IOAddress("192.0.3.0"), 24, 1, 2, 3, 5));
+    subnet1->allowClientClass("foo");
+    subnet1->addRelayAddress(IOAddress("10.2.0.1"));
+    subnet2->addRelayAddress(IOAddress("10.2.0.1"));
+    subnet3->setIface("eth0");
+    subnet4->allowClientClass("bar");
+    subnet4->setIface("eth1");
+
+    cfg.add(subnet5);
+    cfg.add(subnet4);
+    cfg.add(subnet3);
+    cfg.add(subnet2);
+    cfg.add(subnet1);
+
+    // The last subnet gets the relay address and the interface name from
+    // its shared network.
+    SharedNetwork4Ptr network(new SharedNetwork4("network"));
+    network->setIface("eth1");
+    network->addRelayAddress(IOAddress("10.2.0.2"));
+    network->add(subnet5);
+
+    std::vector<SubnetSelector> selectors;
+    for (auto const& client_class : { "", "foo", "bar" }) {
+        SubnetSelector selector;
+        if (*client_class) {
+            selector.client_classes_.insert(client_class);
+        }
+
+        // Select by relay address, then by address.
+        selector.local_address_ = IOAddress("10.0.0.100");
+        for (auto const& giaddr : { "0.0.0.0", "10.2.0.1", "10.2.0.2", "10.2.0.3" }) {
+            selector.giaddr_ = IOAddress(giaddr);
+            for (auto const& ciaddr : { "10.1.2.3", "10.1.3.3", "10.3.3.3",
+                                        "192.0.2.3", "192.0.3.3", "172.16.0.1" }) {
+                selector.ciaddr_ = IOAddress(ciaddr);
+                selectors.push_back(selector);
+            }
+        }
+
+        // Select by interface name.
+        selector.giaddr_ = IOAddress("0.0.0.0");
+        selector.ciaddr_ = IOAddress("0.0.0.0");
+        selector.local_address_ = IOAddress("255.255.255.255");
+        for (auto const& iface : { "eth0", "eth1" }) {
+            selector.iface_name_ = iface;
+            selectors.push_back(selector);
+        }
+    }
+
+    std::vector<Subnet4Ptr> scanned;
+    for (auto const& selector : selectors) {
+        scanned.push_back(cfg.selectSubnet(selector));
+    }
+
+    ASSERT_NO_THROW(cfg.initSelectionIndex());
+    for (size_t i = 0; i < selectors.size(); ++i) {
+        EXPECT_EQ(scanned[i], cfg.selectSubnet(selectors[i])) << "selector " << i;
+    }
+
+    // Check a few selections.
+    SubnetSelector selector;
+    selector.local_address_ = IOAddress("10.0.0.100");
+    selector.ciaddr_ = IOAddress("10.1.2.3");
+    EXPECT_EQ(subnet2, cfg.selectSubnet(selector));
+    selector.giaddr_ = IOAddress("10.2.0.2");
+    EXPECT_EQ(subnet5, cfg.selectSubnet(selector));
+    selector.client_classes_.insert("foo");
+    selector.giaddr_ = IOAddress("0.0.0.0");
+    EXPECT_EQ(subnet1, cfg.selectSubnet(selector));
+    selector.ciaddr_ = IOAddress("10.3.3.3");
+    EXPECT_EQ(subnet3, cfg.selectSubnet(selector));
+}
+
+// This test verifies that the subnet selection index is discarded when
+// the subnets are modified.
+TEST(CfgSubnets4Test, selectSubnetIndexReset) {
+    CfgSubnets4 cfg;
+
+    Subnet4Ptr subnet1(new Subnet4(IOAddress("192.0.2.0"), 26, 1, 2, 3, 1));
+    Subnet4Ptr subnet2(new Subnet4(IOAddress("192.0.2.64"), 26, 1, 2, 3, 2));
+    cfg.add(subnet1);
+    ASSERT_NO_THROW(cfg.initSelectionIndex());
+
+    EXPECT_EQ(subnet1, cfg.selectSubnet(IOAddress("192.0.2.1")));
+    EXPECT_FALSE(cfg.selectSubnet(IOAddress("192.0.2.65")));
+
+    // The added subnet is selected before and after the index is built.
+    cfg.add(subnet2);
+    EXPECT_EQ(subnet2, cfg.selectSubnet(IOAddress("192.0.2.65")));
+    ASSERT_NO_THROW(cfg.initSelectionIndex());
+    EXPECT_EQ(subnet2, cfg.selectSubnet(IOAddress("192.0.2.65")));
+
+    // The removed subnet is no longer selected.
+    cfg.del(subnet1);
+    EXPECT_FALSE(cfg.selectSubnet(IOAddress("192.0.2.1")));
+    ASSERT_NO_THROW(cfg.initSelectionIndex());
+    EXPECT_FALSE(cfg.selectSubnet(IOAddress("192.0.2.1")));
+
+    // The replacing subnet is selected.
+    Subnet4Ptr subnet3(new Subnet4(IOAddress("192.0.2.64"), 26, 1, 2, 3, 2));
+    subnet3->allowClientClass("foo");
+    ASSERT_TRUE(cfg.replace(subnet3));
+    EXPECT_FALSE(cfg.selectSubnet(IOAddress("192.0.2.65")));
+    ClientClasses client_classes;
+    client_classes.insert("foo");
+    EXPECT_EQ(subnet3, cfg.selectSubnet(IOAddress("192.0.2.65"), client_classes));
+}
+
+// This test verifies that the DHCPv4o6 subnet selection using the index
+// returns the same subnets as the scan of all subnets.
+TEST(CfgSubnets4Test, 4o6subnetMatchIndex) {
+    CfgSubnets4 cfg;
+
+    Subnet4Ptr subnet1(new Subnet4(IOAddress("192.0.2.0"), 26, 1, 2, 3, 123));
+    Subnet4Ptr subnet2(new Subnet4(IOAddress("192.0.2.64"), 26, 1, 2, 3, 124));
+    Subnet4Ptr subnet3(new Subnet4(IOAddress("192.0.2.128"), 26, 1, 2, 3, 125));
+
+    const uint8_t dummyPayload[] = { 1, 2, 3, 4};
+    std::vector<uint8_t> data(dummyPayload, dummyPayload + sizeof(dummyPayload));
+    OptionPtr interfaceId(new Option(Option::V6, D6O_INTERFACE_ID, data));
+
+    // Each subnet matches a different criteria.
+    subnet1->get4o6().setIface4o6("eth7");
+    subnet2->get4o6().setInterfaceId(interfaceId);
+    subnet3->get4o6().setSubnet4o6(IOAddress("2001:db8:1::"), 48);
+
+    cfg.add(subnet1);
+    cfg.add(subnet2);
+    cfg.add(subnet3);
+
+    std::vector<SubnetSelector> selectors;
+    SubnetSelector selector;
+    selector.dhcp4o6_ = true;
+    for (auto const& remote : { "2001:db8:1::dead:beef", "2001:db8:2::1" }) {
+        selector.remote_address_ = IOAddress(remote);
+        for (auto const& interface_id : { OptionPtr(), interfaceId }) {
+            selector.interface_id_ = interface_id;
+            for (auto const& iface : { "", "eth5", "eth7" }) {
+                selector.iface_name_ = iface;
+                selectors.push_back(selector);
+            }
+        }
+    }
+
+    std::vector<Subnet4Ptr> scanned;
+    for (auto const& selector : selectors) {
+        scanned.push_back(cfg.selectSubnet4o6(selector));
+    }
+
+    ASSERT_NO_THROW(cfg.initSelectionIndex());
+    for (size_t i = 0; i < selectors.size(); ++i) {
+        EXPECT_EQ(scanned[i], cfg.selectSubnet4o6(selectors[i])) << "selector " << i;
+    }
+
+    // When all criteria match, the first subnet is selected.
+    selector.remote_address_ = IOAddress("2001:db8:1::dead:beef");
+    selector.interface_id_ = interfaceId;
+    selector.iface_name_ = "eth7";
+    EXPECT_EQ(subnet1, cfg.selectSubnet4o6(selector));
+    selector.iface_name_ = "eth5";
+    EXPECT_EQ(subnet2, cfg.selectSubnet4o6(selector));
+    selector.interface_id_.reset();
+    EXPECT_EQ(subnet3, cfg.selectSubnet4o6(selector));
+}
+
 // This test check if IPv4 subnets can be unparsed in a predictable way,
 TEST(CfgSubnets4Test, unparseSubnet) {
     CfgSubnets4 cfg;
@@ -2004,6 +2182,77 @@ TEST(CfgSubnets4Test, removeStatistics) {
     ASSERT_FALSE(observation);
 }
 
+// This test verifies that the free leases counters of the pools are
+// recounted from the lease database and reported as statistics.
+TEST(CfgSubnets4Test, poolStatistics) {
+    CfgMgr::instance().clear();
+
+    CfgSubnets4Ptr cfg = CfgMgr::instance().getCurrentCfg()->getCfgSubnets4();
+    LeaseMgrFactory::create("type=memfile universe=4 persist=false");
+    StatsMgr::instance().removeAll();
+
+    // Create a subnet with two pools.
+    Subnet4Ptr subnet(new Subnet4(IOAddress("192.0.2.0"), 24, 1, 2, 3, 100));
+    PoolPtr pool0(new Pool4(IOAddress("192.0.2.10"), IOAddress("192.0.2.19")));
+    PoolPtr pool1(new Pool4(IOAddress("192.0.2.100"), IOAddress("192.0.2.103")));
+    subnet->addPool(pool0);
+    subnet->addPool(pool1);
+    cfg->add(subnet);
+
+    // Add a lease in each pool, a reclaimed lease and a lease out of
+    // the pools.
+    const char* addresses[] = {
+        "192.0.2.10", "192.0.2.101", "192.0.2.102", "192.0.2.50"
+    };
+    for (auto address : addresses) {
+        HWAddrPtr hwaddr(new HWAddr(std::vector<uint8_t>(6, 1), HTYPE_ETHER));
+        Lease4Ptr lease(new Lease4(IOAddress(address), hwaddr, ClientIdPtr(),
+                                   500, time(NULL), 100));
+        if (lease->addr_ == IOAddress("192.0.2.102")) {
+            lease->state_ = Lease::STATE_EXPIRED_RECLAIMED;
+        }
+        ASSERT_TRUE(LeaseMgrFactory::instance().addLease(lease));
+    }
+
+    cfg->updateStatistics();
+
+    EXPECT_EQ(1, pool0->getAssigned());
+    EXPECT_EQ(1, pool1->getAssigned());
+    EXPECT_EQ(12, subnet->getPoolFree(Lease::TYPE_V4, ClientClasses()));
+
+    ObservationPtr observation = StatsMgr::instance().getObservation(
+        "subnet[100].pool[0].total-addresses");
+    ASSERT_TRUE(observation);
+    EXPECT_EQ(10, observation->getInteger().first);
+    observation = StatsMgr::instance().getObservation(
+        "subnet[100].pool[1].total-addresses");
+    ASSERT_TRUE(observation);
+    EXPECT_EQ(4, observation->getInteger().first);
+    ObservationPtr assigned = StatsMgr::instance().getObservation(
+        "subnet[100].pool[1].assigned-addresses");
+    ASSERT_TRUE(assigned);
+    EXPECT_EQ(1, assigned->getInteger().first);
+
+    // Update the counter of the second pool by subnet identifier.
+    cfg->updatePoolAssigned(100, IOAddress("192.0.2.102"), 1);
+    EXPECT_EQ(2, pool1->getAssigned());
+    EXPECT_EQ(2, assigned->getInteger().first);
+
+    // Unknown subnets are ignored.
+    cfg->updatePoolAssigned(200, IOAddress("192.0.2.102"), 1);
+    EXPECT_EQ(2, pool1->getAssigned());
+
+    // The pool statistics are removed with the subnet statistics.
+    cfg->removeStatistics();
+    EXPECT_FALSE(StatsMgr::instance().getObservation(
+        "subnet[100].pool[0].total-addresses"));
+    EXPECT_FALSE(StatsMgr::instance().getObservation(
+        "subnet[100].pool[1].assigned-addresses"));
+
+    LeaseMgrFactory::destroy();
+    StatsMgr::instance().removeAll();
+}
+
 // This test verifies that in range host reservation works as expected.
 TEST(CfgSubnets4Test, host) {
     // Create a configuration.
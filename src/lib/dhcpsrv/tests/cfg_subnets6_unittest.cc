@@ -589,6 +589,138 @@ TEST(CfgSubnets6Test, selectSubnetByInterfaceIdAndClassify) {
     EXPECT_FALSE(cfg.selectSubnet(selector));
 }
 
+// This test verifies that the subnet selection using the index returns the
+// same subnets as the scan of all subnets.
+TEST(CfgSubnets6Test, selectSubnetIndex) {
+    CfgSubnets6 cfg;
+
+    // Create overlapping subnets: the subnet with the lowest identifier
+    // which supports the client classes is selected.
+    Subnet6Ptr subnet1(new Subnet6(IOAddress("2001:db8:1:2::"), 64, 1, 2, 3, 4, 1));
+    Subnet6Ptr subnet2(new Subnet6(IOAddress("2001:db8:1::"), 48, 1, 2, 3, 4, 2));
+    Subnet6Ptr subnet3(new Subnet6(IOAddress("2001:db8::"), 32, 1, 2, 3, 4, 3));
+    Subnet6Ptr subnet4(new Subnet6(IOAddress("3000::"), 48, 1, 2, 3, 4, 4));
+    Subnet6Ptr subnet5(new Subnet6(IOAddress("4000::"), 48, 1, 2, 3, 4, 5));
+    OptionPtr ifaceid1 = generateInterfaceId("relay1.eth0");
+    OptionPtr ifaceid2 = generateInterfaceId("VL32");
+    subnet1->allowClientClass("foo");
+    subnet1->addRelayAddress(IOAddress("5000::1"));
+    subnet1->setInterfaceId(ifaceid1);
+    subnet2->addRelayAddress(IOAddress("5000::1"));
+    subnet3->setIface("eth0");
+    subnet4->allowClientClass("bar");
+    subnet4->setIface("eth1");
+    subnet4->setInterfaceId(ifaceid1);
+
+    cfg.add(subnet5);
+    cfg.add(subnet4);
+    cfg.add(subnet3);
+    cfg.add(subnet2);
+    cfg.add(subnet1);
+
+    // The last subnet gets the relay address, the interface name and the
+    // interface id from its shared network.
+    SharedNetwork6Ptr network(new SharedNetwork6("network"));
+    network->setIface("eth1");
+    network->setInterfaceId(ifaceid2);
+    network->addRelayAddress(IOAddress("5000::2"));
+    network->add(subnet5);
+
+    std::vector<SubnetSelector> selectors;
+    for (auto const& client_class : { "", "foo", "bar" }) {
+        SubnetSelector selector;
+        if (*client_class) {
+            selector.client_classes_.insert(client_class);
+        }
+
+        // Select directly connected clients by interface name, then
+        // by address.
+        selector.first_relay_linkaddr_ = IOAddress("::");
+        for (auto const& iface : { "", "eth0", "eth1", "eth2" }) {
+            selector.iface_name_ = iface;
+            for (auto const& remote : { "2001:db8:1:2::1", "2001:db8:1:3::1",
+                                        "2001:db8:2::1", "3000::1", "4000::1",
+                                        "5000::1" }) {
+                selector.remote_address_ = IOAddress(remote);
+                selectors.push_back(selector);
+            }
+        }
+
+        // Select relayed clients by interface id, then by relay address,
+        // then by address.
+        selector.iface_name_ = "";
+        selector.remote_address_ = IOAddress("fe80::1");
+        for (auto const& interface_id : { OptionPtr(), ifaceid1, ifaceid2 }) {
+            selector.interface_id_ = interface_id;
+            for (auto const& linkaddr : { "5000::1", "5000::2", "5000::3",
+                                          "2001:db8:1:2::1", "2001:db8:2::1",
+                                          "4000::1" }) {
+                selector.first_relay_linkaddr_ = IOAddress(linkaddr);
+                selectors.push_back(selector);
+            }
+        }
+    }
+
+    std::vector<Subnet6Ptr> scanned;
+    for (auto const& selector : selectors) {
+        scanned.push_back(cfg.selectSubnet(selector));
+    }
+
+    ASSERT_NO_THROW(cfg.initSelectionIndex());
+    for (size_t i = 0; i < selectors.size(); ++i) {
+        EXPECT_EQ(scanned[i], cfg.selectSubnet(selectors[i])) << "selector " << i;
+    }
+
+    // Check a few selections.
+    EXPECT_EQ(subnet2, cfg.selectSubnet(IOAddress("2001:db8:1:2::1")));
+    EXPECT_EQ(subnet3, cfg.selectSubnet(IOAddress("2001:db8:2::1")));
+    ClientClasses client_classes;
+    client_classes.insert("foo");
+    EXPECT_EQ(subnet1, cfg.selectSubnet(IOAddress("2001:db8:1:2::1"),
+                                        client_classes));
+    EXPECT_EQ(subnet1, cfg.selectSubnet(IOAddress("5000::1"),
+                                        client_classes, true));
+    EXPECT_EQ(subnet2, cfg.selectSubnet(IOAddress("5000::1"),
+                                        ClientClasses(), true));
+    EXPECT_EQ(subnet5, cfg.selectSubnet(IOAddress("5000::2"),
+                                        ClientClasses(), true));
+}
+
+// This test verifies that the subnet selection index is discarded when
+// the subnets are modified.
+TEST(CfgSubnets6Test, selectSubnetIndexReset) {
+    CfgSubnets6 cfg;
+
+    Subnet6Ptr subnet1(new Subnet6(IOAddress("2000::"), 48, 1, 2, 3, 4, 1));
+    Subnet6Ptr subnet2(new Subnet6(IOAddress("3000::"), 48, 1, 2, 3, 4, 2));
+    cfg.add(subnet1);
+    ASSERT_NO_THROW(cfg.initSelectionIndex());
+
+    EXPECT_EQ(subnet1, cfg.selectSubnet(IOAddress("2000::1")));
+    EXPECT_FALSE(cfg.selectSubnet(IOAddress("3000::1")));
+
+    // The added subnet is selected before and after the index is built.
+    cfg.add(subnet2);
+    EXPECT_EQ(subnet2, cfg.selectSubnet(IOAddress("3000::1")));
+    ASSERT_NO_THROW(cfg.initSelectionIndex());
+    EXPECT_EQ(subnet2, cfg.selectSubnet(IOAddress("3000::1")));
+
+    // The removed subnet is no longer selected.
+    cfg.del(subnet1);
+    EXPECT_FALSE(cfg.selectSubnet(IOAddress("2000::1")));
+    ASSERT_NO_THROW(cfg.initSelectionIndex());
+    EXPECT_FALSE(cfg.selectSubnet(IOAddress("2000::1")));
+
+    // The replacing subnet is selected.
+    Subnet6Ptr subnet3(new Subnet6(IOAddress("3000::"), 48, 1, 2, 3, 4, 2));
+    subnet3->allowClientClass("foo");
+    ASSERT_TRUE(cfg.replace(subnet3));
+    EXPECT_FALSE(cfg.selectSubnet(IOAddress("3000::1")));
+    ClientClasses client_classes;
+    client_classes.insert("foo");
+    EXPECT_EQ(subnet3, cfg.selectSubnet(IOAddress("3000::1"), client_classes));
+}
+
 // Checks that detection of duplicated subnet IDs works as expected. It should
 // not be possible to add two IPv6 subnets holding the same ID.
 TEST(CfgSubnets6Test, duplication) {
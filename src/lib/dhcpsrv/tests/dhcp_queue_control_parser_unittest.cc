@@ -85,6 +85,13 @@ TEST_F(DHCPQueueControlParserTest, validContent) {
         "   \"foo\": \"bogus\", \n"
         "   \"random-int\" : 1234 \n"
         "} \n"
+        },
+        {
+        "queue disabled, with receive-batch-size",
+        "{ \n"
+        "   \"enable-queue\": false, \n"
+        "   \"receive-batch-size\": 32 \n"
+        "} \n"
         }
     };
 
@@ -150,6 +157,27 @@ TEST_F(DHCPQueueControlParserTest, invalidContent) {
         "   \"enable-queue\": true, \n"
         "   \"queue-type\": 7777 \n"
         "} \n"
+        },
+        {
+        "receive-batch-size not an integer",
+        "{ \n"
+        "   \"enable-queue\": false, \n"
+        "   \"receive-batch-size\": \"many\" \n"
+        "} \n"
+        },
+        {
+        "receive-batch-size too small",
+        "{ \n"
+        "   \"enable-queue\": false, \n"
+        "   \"receive-batch-size\": 0 \n"
+        "} \n"
+        },
+        {
+        "receive-batch-size too large",
+        "{ \n"
+        "   \"enable-queue\": false, \n"
+        "   \"receive-batch-size\": 100000 \n"
+        "} \n"
         }
     };
 
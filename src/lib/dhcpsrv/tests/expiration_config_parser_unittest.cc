@@ -150,6 +150,8 @@ TEST_F(ExpirationConfigParserTest, allParameters) {
     addParam("max-reclaim-leases", 50);
     addParam("max-reclaim-time", 100);
     addParam("unwarned-reclaim-cycles", 10);
+    addParam("reclaim-batch-size", 100);
+    addParam("reclaim-threads", 4);
 
     CfgExpirationPtr cfg;
     ASSERT_NO_THROW(cfg = renderConfig());
@@ -159,6 +161,8 @@ TEST_F(ExpirationConfigParserTest, allParameters) {
     EXPECT_EQ(50, cfg->getMaxReclaimLeases());
     EXPECT_EQ(100, cfg->getMaxReclaimTime());
     EXPECT_EQ(10, cfg->getUnwarnedReclaimCycles());
+    EXPECT_EQ(100, cfg->getReclaimBatchSize());
+    EXPECT_EQ(4, cfg->getReclaimThreads());
 }
 
 // This test verifies that default values are used if no parameter is
@@ -178,6 +182,10 @@ TEST_F(ExpirationConfigParserTest, noParameters) {
               cfg->getMaxReclaimTime());
     EXPECT_EQ(CfgExpiration::DEFAULT_UNWARNED_RECLAIM_CYCLES,
               cfg->getUnwarnedReclaimCycles());
+    EXPECT_EQ(CfgExpiration::DEFAULT_RECLAIM_BATCH_SIZE,
+              cfg->getReclaimBatchSize());
+    EXPECT_EQ(CfgExpiration::DEFAULT_RECLAIM_THREADS,
+              cfg->getReclaimThreads());
 }
 
 // This test verifies that a subset of parameters may be specified and
@@ -235,6 +243,22 @@ TEST_F(ExpirationConfigParserTest, outOfRangeValues) {
                    CfgExpiration::LIMIT_MAX_RECLAIM_TIME);
     testOutOfRange("unwarned-reclaim-cycles",
                    CfgExpiration::LIMIT_UNWARNED_RECLAIM_CYCLES);
+    testOutOfRange("reclaim-threads",
+                   CfgExpiration::LIMIT_RECLAIM_THREADS);
+}
+
+// This test verifies that the reclamation batches are not empty.
+TEST_F(ExpirationConfigParserTest, reclaimBatchSize) {
+    addParam("reclaim-batch-size", 0);
+    EXPECT_THROW(renderConfig(), DhcpConfigError);
+
+    addParam("reclaim-batch-size", CfgExpiration::LIMIT_RECLAIM_BATCH_SIZE + 1);
+    EXPECT_THROW(renderConfig(), DhcpConfigError);
+
+    addParam("reclaim-batch-size", CfgExpiration::LIMIT_RECLAIM_BATCH_SIZE);
+    CfgExpirationPtr cfg;
+    ASSERT_NO_THROW(cfg = renderConfig());
+    EXPECT_EQ(CfgExpiration::LIMIT_RECLAIM_BATCH_SIZE, cfg->getReclaimBatchSize());
 }
 
 // This test verifies that it is not allowed to specify a value as
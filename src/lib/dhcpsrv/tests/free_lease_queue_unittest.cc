@@ -548,6 +548,67 @@ TEST(FreeLeaseQueueTest, detectRangeFailed) {
     EXPECT_FALSE(lq.append(IOAddress("192.0.3.7")));
 }
 
+// Check that it is possible to use an address without specifying the
+// range and that the appropriate range is detected.
+TEST(FreeLeaseQueueTest, useDetectRange) {
+    FreeLeaseQueue lq;
+
+    AddressRange range1(IOAddress("192.0.2.1"), IOAddress("192.0.2.255"));
+    AddressRange range2(IOAddress("192.0.3.1"), IOAddress("192.0.3.255"));
+    ASSERT_NO_THROW(lq.addRange(range1));
+    ASSERT_NO_THROW(lq.addRange(range2));
+    EXPECT_TRUE(lq.hasRange(range1));
+    EXPECT_FALSE(lq.hasRange(AddressRange(IOAddress("10.0.0.1"),
+                                          IOAddress("10.0.0.2"))));
+
+    ASSERT_NO_THROW(lq.append(IOAddress("192.0.2.7")));
+    ASSERT_NO_THROW(lq.append(IOAddress("192.0.2.8")));
+    ASSERT_NO_THROW(lq.append(IOAddress("192.0.3.9")));
+
+    // Use the first address of the first range.
+    EXPECT_TRUE(lq.use(IOAddress("192.0.2.7")));
+    // It is gone from the queue.
+    EXPECT_FALSE(lq.use(IOAddress("192.0.2.7")));
+    IOAddress next(0);
+    ASSERT_NO_THROW(next = lq.next(range1));
+    EXPECT_EQ("192.0.2.8", next.toText());
+    ASSERT_NO_THROW(next = lq.next(range1));
+    EXPECT_EQ("192.0.2.8", next.toText());
+
+    EXPECT_TRUE(lq.use(IOAddress("192.0.3.9")));
+    ASSERT_NO_THROW(next = lq.next(range2));
+    EXPECT_TRUE(next.isV4Zero());
+
+    // Out of any range.
+    EXPECT_FALSE(lq.use(IOAddress("10.0.0.1")));
+    EXPECT_FALSE(lq.use(IOAddress("192.0.4.1")));
+}
+
+// Check that it is possible to use a delegated prefix without specifying
+// the range and that the appropriate range is detected.
+TEST(FreeLeaseQueueTest, usePrefixDetectRange) {
+    FreeLeaseQueue lq;
+
+    PrefixRange range(IOAddress("2001:db8:1::"), 64, 96);
+    ASSERT_NO_THROW(lq.addRange(range));
+    EXPECT_TRUE(lq.hasRange(range));
+
+    ASSERT_NO_THROW(lq.append(IOAddress("2001:db8:1::7:0"), 96));
+    ASSERT_NO_THROW(lq.append(IOAddress("2001:db8:1::8:0"), 96));
+
+    // The delegated length must match.
+    EXPECT_FALSE(lq.use(IOAddress("2001:db8:1::7:0"), 97));
+    EXPECT_TRUE(lq.use(IOAddress("2001:db8:1::7:0"), 96));
+    EXPECT_FALSE(lq.use(IOAddress("2001:db8:1::7:0"), 96));
+
+    IOAddress next(0);
+    ASSERT_NO_THROW(next = lq.next(range));
+    EXPECT_EQ("2001:db8:1::8:0", next.toText());
+
+    // Out of any range.
+    EXPECT_FALSE(lq.use(IOAddress("2001:db8:2::"), 96));
+}
+
 // This test verifies that it is possible to append IP addresses to the
 // selected range via random access index.
 TEST(FreeLeaseQueueTest, appendThroughRangeIndex) {
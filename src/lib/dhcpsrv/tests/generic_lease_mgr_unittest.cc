@@ -23,6 +23,7 @@
 #include <gtest/gtest.h>
 
 #include <limits>
+#include <set>
 #include <sstream>
 
 using namespace std;
@@ -416,6 +417,49 @@ GenericLeaseMgrTest::testGetLease4ClientId() {
     ASSERT_EQ(0, returned.size());
 }
 
+void
+GenericLeaseMgrTest::testGetClientLeases4() {
+    // Get the leases to be used for the test and add them to the database.
+    vector<Lease4Ptr> leases = createLeases4();
+    for (size_t i = 0; i < leases.size(); ++i) {
+        ASSERT_TRUE(lmptr_->addLease(leases[i]));
+    }
+
+    // Checks that the returned leases are the leases having the HW address,
+    // the client identifier or the address, without duplicates.
+    auto check = [&](const HWAddrPtr& hwaddr, const ClientIdPtr& client_id,
+                     const IOAddress& addr) {
+        std::set<IOAddress> expected;
+        for (auto const& lease : leases) {
+            if ((hwaddr && lease->hwaddr_ &&
+                 (lease->hwaddr_->hwaddr_ == hwaddr->hwaddr_)) ||
+                (client_id && lease->client_id_ &&
+                 (*lease->client_id_ == *client_id)) ||
+                (lease->addr_ == addr)) {
+                expected.insert(lease->addr_);
+            }
+        }
+        Lease4Collection returned = lmptr_->getClientLeases4(hwaddr, client_id,
+                                                             addr);
+        std::set<IOAddress> returned_addrs;
+        for (auto const& lease : returned) {
+            returned_addrs.insert(lease->addr_);
+        }
+        EXPECT_EQ(returned.size(), returned_addrs.size());
+        EXPECT_TRUE(expected == returned_addrs);
+    };
+
+    IOAddress zero = IOAddress::IPV4_ZERO_ADDRESS();
+    check(leases[1]->hwaddr_, leases[2]->client_id_, leases[3]->addr_);
+    check(leases[1]->hwaddr_, leases[1]->client_id_, leases[1]->addr_);
+    check(leases[1]->hwaddr_, ClientIdPtr(), zero);
+    check(HWAddrPtr(), leases[2]->client_id_, zero);
+    check(HWAddrPtr(), ClientIdPtr(), leases[3]->addr_);
+
+    // Nothing is returned for no criteria.
+    EXPECT_TRUE(lmptr_->getClientLeases4(HWAddrPtr(), ClientIdPtr(), zero).empty());
+}
+
 void
 GenericLeaseMgrTest::testGetLease4NullClientId() {
     // Let's initialize a specific lease ... But this time
@@ -2491,6 +2535,86 @@ GenericLeaseMgrTest::testDeleteExpiredReclaimedLeases4() {
     }
 }
 
+void
+GenericLeaseMgrTest::testUpdateLeases4() {
+    // Get the leases to be used for the test and add them to the database.
+    vector<Lease4Ptr> leases = createLeases4();
+    for (size_t i = 0; i < leases.size(); ++i) {
+        ASSERT_TRUE(lmptr_->addLease(leases[i]));
+    }
+
+    // Mark the first two leases reclaimed and remove the next two ones.
+    Lease4Collection updated_leases;
+    Lease4Collection deleted_leases;
+    for (size_t i = 0; i < 2; ++i) {
+        leases[i]->hostname_.clear();
+        leases[i]->state_ = Lease::STATE_EXPIRED_RECLAIMED;
+        updated_leases.push_back(leases[i]);
+        deleted_leases.push_back(leases[i + 2]);
+    }
+    ASSERT_NO_THROW(lmptr_->updateLeases4(updated_leases, deleted_leases));
+
+    for (size_t i = 0; i < leases.size(); ++i) {
+        SCOPED_TRACE("lease " + leases[i]->addr_.toText());
+        Lease4Ptr l_returned = lmptr_->getLease4(leases[i]->addr_);
+        if ((i == 2) || (i == 3)) {
+            EXPECT_FALSE(l_returned);
+        } else {
+            ASSERT_TRUE(l_returned);
+            detailCompareLease(leases[i], l_returned);
+        }
+    }
+
+    // An empty batch does nothing.
+    EXPECT_NO_THROW(lmptr_->updateLeases4(Lease4Collection(), Lease4Collection()));
+
+    // Updating a lease which is not in the database fails the batch.
+    updated_leases.clear();
+    updated_leases.push_back(leases[2]);
+    EXPECT_THROW(lmptr_->updateLeases4(updated_leases, Lease4Collection()),
+                 isc::dhcp::NoSuchLease);
+}
+
+void
+GenericLeaseMgrTest::testUpdateLeases6() {
+    // Get the leases to be used for the test and add them to the database.
+    vector<Lease6Ptr> leases = createLeases6();
+    for (size_t i = 0; i < leases.size(); ++i) {
+        ASSERT_TRUE(lmptr_->addLease(leases[i]));
+    }
+
+    // Mark the first two leases reclaimed and remove the next two ones.
+    Lease6Collection updated_leases;
+    Lease6Collection deleted_leases;
+    for (size_t i = 0; i < 2; ++i) {
+        leases[i]->hostname_.clear();
+        leases[i]->state_ = Lease::STATE_EXPIRED_RECLAIMED;
+        updated_leases.push_back(leases[i]);
+        deleted_leases.push_back(leases[i + 2]);
+    }
+    ASSERT_NO_THROW(lmptr_->updateLeases6(updated_leases, deleted_leases));
+
+    for (size_t i = 0; i < leases.size(); ++i) {
+        SCOPED_TRACE("lease " + leases[i]->addr_.toText());
+        Lease6Ptr l_returned = lmptr_->getLease6(leases[i]->type_, leases[i]->addr_);
+        if ((i == 2) || (i == 3)) {
+            EXPECT_FALSE(l_returned);
+        } else {
+            ASSERT_TRUE(l_returned);
+            detailCompareLease(leases[i], l_returned);
+        }
+    }
+
+    // An empty batch does nothing.
+    EXPECT_NO_THROW(lmptr_->updateLeases6(Lease6Collection(), Lease6Collection()));
+
+    // Updating a lease which is not in the database fails the batch.
+    updated_leases.clear();
+    updated_leases.push_back(leases[2]);
+    EXPECT_THROW(lmptr_->updateLeases6(updated_leases, Lease6Collection()),
+                 isc::dhcp::NoSuchLease);
+}
+
 void
 GenericLeaseMgrTest::testDeleteExpiredReclaimedLeases6() {
     // Get the leases to be used for the test.
@@ -165,6 +165,9 @@ public:
     /// @brief Test lease retrieval when leases with NULL client id are present.
     void testGetLease4NullClientId();
 
+    /// @brief Test retrieval of the leases which may belong to a client.
+    void testGetClientLeases4();
+
     /// @brief Test lease retrieval using HW address.
     void testGetLease4HWAddr1();
 
@@ -421,6 +424,20 @@ public:
     /// leases can be removed.
     void testDeleteExpiredReclaimedLeases4();
 
+    /// @brief Checks that a batch of IPv4 leases can be updated and deleted.
+    ///
+    /// This creates a number of DHCPv4 leases, marks some of them as
+    /// expired-reclaimed and deletes some others with one call to
+    /// @c LeaseMgr::updateLeases4.
+    void testUpdateLeases4();
+
+    /// @brief Checks that a batch of IPv6 leases can be updated and deleted.
+    ///
+    /// This creates a number of DHCPv6 leases, marks some of them as
+    /// expired-reclaimed and deletes some others with one call to
+    /// @c LeaseMgr::updateLeases6.
+    void testUpdateLeases6();
+
     /// @brief Check that the IPv4 lease statistics can be recounted
     ///
     /// This test creates two subnets and several leases associated with
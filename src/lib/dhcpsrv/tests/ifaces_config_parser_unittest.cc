@@ -17,6 +17,7 @@ using namespace isc::data;
 using namespace isc::dhcp;
 using namespace isc::dhcp::test;
 using namespace isc::test;
+using namespace isc::util;
 
 namespace {
 
@@ -275,4 +276,145 @@ TEST_F(IfacesConfigParserTest, outboundInterface) {
     EXPECT_THROW(parser6.parse(cfg_iface, config_element), DhcpConfigError);
 }
 
+// Tests that fd-event-handler is parsed properly.
+TEST_F(IfacesConfigParserTest, fdEventHandler) {
+    IfacesConfigParser parser4(AF_INET, false);
+    IfacesConfigParser parser6(AF_INET6, false);
+
+    CfgIfacePtr cfg_iface = CfgMgr::instance().getStagingCfg()->getCfgIface();
+
+    // The default is select().
+    EXPECT_EQ(FDEventHandler::TYPE_SELECT, cfg_iface->getFDEventHandlerType());
+
+    std::string config = "{ \"interfaces\": [ ],"
+        "\"fd-event-handler\": \"select\","
+        " \"re-detect\": false }";
+    ElementPtr config_element = Element::fromJSON(config);
+    ASSERT_NO_THROW(parser4.parse(cfg_iface, config_element));
+    EXPECT_EQ(FDEventHandler::TYPE_SELECT, cfg_iface->getFDEventHandlerType());
+    ASSERT_NO_THROW(parser6.parse(cfg_iface, config_element));
+    EXPECT_EQ(FDEventHandler::TYPE_SELECT, cfg_iface->getFDEventHandlerType());
+
+    // epoll() is only available on Linux.
+    config = "{ \"interfaces\": [ ],"
+        "\"fd-event-handler\": \"epoll\","
+        " \"re-detect\": false }";
+    config_element = Element::fromJSON(config);
+#if defined (OS_LINUX)
+    ASSERT_NO_THROW(parser4.parse(cfg_iface, config_element));
+    EXPECT_EQ(FDEventHandler::TYPE_EPOLL, cfg_iface->getFDEventHandlerType());
+    runToElementTest<CfgIface>(config, *cfg_iface);
+    cfg_iface->setFDEventHandlerType(FDEventHandler::TYPE_SELECT);
+    ASSERT_NO_THROW(parser6.parse(cfg_iface, config_element));
+    EXPECT_EQ(FDEventHandler::TYPE_EPOLL, cfg_iface->getFDEventHandlerType());
+#else
+    EXPECT_THROW(parser4.parse(cfg_iface, config_element), DhcpConfigError);
+    EXPECT_THROW(parser6.parse(cfg_iface, config_element), DhcpConfigError);
+#endif
+
+    // Other values are not supported.
+    config = "{ \"interfaces\": [ ],"
+        "\"fd-event-handler\": \"kqueue\","
+        " \"re-detect\": false }";
+    config_element = Element::fromJSON(config);
+    EXPECT_THROW(parser4.parse(cfg_iface, config_element), DhcpConfigError);
+    EXPECT_THROW(parser6.parse(cfg_iface, config_element), DhcpConfigError);
+}
+
+// Tests that packet-mmap is parsed properly.
+TEST_F(IfacesConfigParserTest, packetMmap) {
+    IfacesConfigParser parser4(AF_INET, false);
+    IfacesConfigParser parser6(AF_INET6, false);
+
+    CfgIfacePtr cfg_iface = CfgMgr::instance().getStagingCfg()->getCfgIface();
+
+    // The ring is not used by default.
+    EXPECT_FALSE(cfg_iface->getPacketMmap());
+
+    std::string config = "{ \"interfaces\": [ ],"
+        "\"packet-mmap\": false,"
+        " \"re-detect\": false }";
+    ElementPtr config_element = Element::fromJSON(config);
+    ASSERT_NO_THROW(parser4.parse(cfg_iface, config_element));
+    EXPECT_FALSE(cfg_iface->getPacketMmap());
+
+    // The ring is only available on Linux.
+    config = "{ \"interfaces\": [ ],"
+        "\"packet-mmap\": true,"
+        " \"re-detect\": false }";
+    config_element = Element::fromJSON(config);
+#if defined (OS_LINUX)
+    ASSERT_NO_THROW(parser4.parse(cfg_iface, config_element));
+    EXPECT_TRUE(cfg_iface->getPacketMmap());
+    runToElementTest<CfgIface>(config, *cfg_iface);
+#else
+    EXPECT_THROW(parser4.parse(cfg_iface, config_element), DhcpConfigError);
+#endif
+
+    // The DHCPv6 server has no raw sockets.
+    EXPECT_THROW(parser6.parse(cfg_iface, config_element), DhcpConfigError);
+}
+
+// Tests that socket-sharding is parsed properly.
+TEST_F(IfacesConfigParserTest, socketSharding) {
+    IfacesConfigParser parser4(AF_INET, false);
+    IfacesConfigParser parser6(AF_INET6, false);
+
+    CfgIfacePtr cfg_iface = CfgMgr::instance().getStagingCfg()->getCfgIface();
+
+    // Sockets are not sharded by default.
+    EXPECT_FALSE(cfg_iface->getSocketSharding());
+
+    std::string config = "{ \"interfaces\": [ ],"
+        "\"socket-sharding\": true,"
+        " \"re-detect\": false }";
+    ElementPtr config_element = Element::fromJSON(config);
+    ASSERT_NO_THROW(parser4.parse(cfg_iface, config_element));
+    EXPECT_TRUE(cfg_iface->getSocketSharding());
+    runToElementTest<CfgIface>(config, *cfg_iface);
+
+    cfg_iface->setSocketSharding(false);
+    ASSERT_NO_THROW(parser6.parse(cfg_iface, config_element));
+    EXPECT_TRUE(cfg_iface->getSocketSharding());
+
+    // The value must be a boolean.
+    config = "{ \"interfaces\": [ ],"
+        "\"socket-sharding\": 4,"
+        " \"re-detect\": false }";
+    config_element = Element::fromJSON(config);
+    EXPECT_THROW(parser4.parse(cfg_iface, config_element), DhcpConfigError);
+    EXPECT_THROW(parser6.parse(cfg_iface, config_element), DhcpConfigError);
+}
+
+// Tests that lazy-option-unpack is parsed properly.
+TEST_F(IfacesConfigParserTest, lazyOptionUnpack) {
+    IfacesConfigParser parser4(AF_INET, false);
+    IfacesConfigParser parser6(AF_INET6, false);
+
+    CfgIfacePtr cfg_iface = CfgMgr::instance().getStagingCfg()->getCfgIface();
+
+    // Options are unpacked eagerly by default.
+    EXPECT_FALSE(cfg_iface->getLazyOptionUnpack());
+
+    std::string config = "{ \"interfaces\": [ ],"
+        "\"lazy-option-unpack\": true,"
+        " \"re-detect\": false }";
+    ElementPtr config_element = Element::fromJSON(config);
+    ASSERT_NO_THROW(parser4.parse(cfg_iface, config_element));
+    EXPECT_TRUE(cfg_iface->getLazyOptionUnpack());
+    runToElementTest<CfgIface>(config, *cfg_iface);
+
+    cfg_iface->setLazyOptionUnpack(false);
+    ASSERT_NO_THROW(parser6.parse(cfg_iface, config_element));
+    EXPECT_TRUE(cfg_iface->getLazyOptionUnpack());
+
+    // The value must be a boolean.
+    config = "{ \"interfaces\": [ ],"
+        "\"lazy-option-unpack\": \"yes\","
+        " \"re-detect\": false }";
+    config_element = Element::fromJSON(config);
+    EXPECT_THROW(parser4.parse(cfg_iface, config_element), DhcpConfigError);
+    EXPECT_THROW(parser6.parse(cfg_iface, config_element), DhcpConfigError);
+}
+
 } // end of anonymous namespace
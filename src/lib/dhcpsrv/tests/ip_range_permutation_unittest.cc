@@ -137,4 +137,65 @@ TEST(IPRangePermutationTest, pd) {
     EXPECT_TRUE(addrs.begin()->isV6Zero());
 }
 
+// This test verifies that a permutation of a range holding a single
+// address returns this address.
+TEST(IPRangePermutationTest, singleAddress) {
+    AddressRange range(IOAddress("192.0.2.10"), IOAddress("192.0.2.10"));
+    IPRangePermutation perm(range);
+
+    bool done = false;
+    EXPECT_EQ("192.0.2.10", perm.next(done).toText());
+    EXPECT_TRUE(done);
+    EXPECT_TRUE(perm.exhausted());
+    EXPECT_EQ("0.0.0.0", perm.next(done).toText());
+}
+
+// This test verifies that a permutation of a large IPv6 address range
+// returns addresses from the whole range.
+TEST(IPRangePermutationTest, largeIPv6Range) {
+    AddressRange range(IOAddress("2001:db8:1::"),
+                       IOAddress("2001:db8:1::ffff:ffff:ffff"));
+    IPRangePermutation perm(range);
+
+    // A few addresses are above the 32 bits boundary.
+    bool done = false;
+    bool high = false;
+    for (auto i = 0; i < 100; ++i) {
+        auto next = perm.next(done);
+        EXPECT_FALSE(done);
+        EXPECT_LE(range.start_, next);
+        EXPECT_LE(next, range.end_);
+        if (IOAddress("2001:db8:1::1:0:0") <= next) {
+            high = true;
+        }
+    }
+    EXPECT_TRUE(high);
+}
+
+// This test verifies that a permutation of a prefix range given by its
+// boundaries and of delegated prefixes shorter than 64 bits can be generated.
+TEST(IPRangePermutationTest, pdShortPrefixes) {
+    PrefixRange range(IOAddress("3000::"), IOAddress("3000:0:ff00::"), 40);
+    IPRangePermutation perm(range);
+
+    std::set<IOAddress> addrs;
+    bool done = false;
+    for (auto i = 0; i < 256; ++i) {
+        auto next = perm.next(done);
+        EXPECT_LE(range.start_, next);
+        EXPECT_LE(next, range.end_);
+        // The low 88 bits of a delegated /40 prefix are zero.
+        const std::vector<uint8_t>& bytes = next.toBytes();
+        for (size_t j = 5; j < bytes.size(); ++j) {
+            EXPECT_EQ(0, bytes[j]) << next;
+        }
+        EXPECT_EQ(i == 255, done);
+        addrs.insert(next);
+    }
+
+    // All 256 prefixes were returned.
+    EXPECT_EQ(256, addrs.size());
+    EXPECT_TRUE(perm.exhausted());
+}
+
 } // end of anonymous namespace
@@ -18,6 +18,7 @@
 #include <dhcpsrv/testutils/lease_file_io.h>
 #include <dhcpsrv/testutils/test_utils.h>
 #include <dhcpsrv/tests/generic_lease_mgr_unittest.h>
+#include <stats/stats_mgr.h>
 #include <util/multi_threading_mgr.h>
 #include <util/pid_file.h>
 #include <util/range_utilities.h>
@@ -25,11 +26,13 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <cstdlib>
 #include <iostream>
 #include <fstream>
 #include <queue>
 #include <sstream>
+#include <thread>
 #include <unistd.h>
 
 using namespace std;
@@ -92,6 +95,7 @@ public:
     }
 
     using Memfile_LeaseMgr::lfcCallback;
+    using Memfile_LeaseMgr::writerWait;
 };
 
 /// @brief Test fixture class for @c Memfile_LeaseMgr
@@ -388,6 +392,26 @@ TEST_F(MemfileLeaseMgrTest, constructor) {
     pmap["persist"] = "true";
     pmap["max-row-errors"] = "-1";
     EXPECT_THROW(lease_mgr.reset(new Memfile_LeaseMgr(pmap)), isc::BadValue);
+
+    // The flush-records must be an integer.
+    pmap["max-row-errors"] = "5";
+    pmap["flush-records"] = "bogus";
+    EXPECT_THROW(lease_mgr.reset(new Memfile_LeaseMgr(pmap)), isc::BadValue);
+
+    // The flush-interval must be an integer.
+    pmap["flush-records"] = "16";
+    pmap["flush-interval"] = "bogus";
+    EXPECT_THROW(lease_mgr.reset(new Memfile_LeaseMgr(pmap)), isc::BadValue);
+
+    // The write-queue-size must be an integer.
+    pmap["flush-interval"] = "0";
+    pmap["write-queue-size"] = "bogus";
+    EXPECT_THROW(lease_mgr.reset(new Memfile_LeaseMgr(pmap)), isc::BadValue);
+
+    // The write-queue-full must be block or drop.
+    pmap["write-queue-size"] = "16";
+    pmap["write-queue-full"] = "bogus";
+    EXPECT_THROW(lease_mgr.reset(new Memfile_LeaseMgr(pmap)), isc::BadValue);
 }
 
 /// @brief Checks if there is no lease manager NoLeaseManager is thrown.
@@ -496,6 +520,170 @@ TEST_F(MemfileLeaseMgrTest, lfcTimerDisabled) {
     EXPECT_EQ(0, lease_mgr->getLFCCount());
 }
 
+/// @brief Checks that the lease changes are flushed to the lease file in
+/// groups of flush-records changes.
+TEST_F(MemfileLeaseMgrTest, flushRecords) {
+    DatabaseConnection::ParameterMap pmap;
+    pmap["type"] = "memfile";
+    pmap["universe"] = "4";
+    pmap["name"] = getLeaseFilePath("leasefile4_0.csv");
+    pmap["lfc-interval"] = "0";
+    pmap["flush-records"] = "2";
+
+    boost::scoped_ptr<Memfile_LeaseMgr> lease_mgr(new Memfile_LeaseMgr(pmap));
+    const std::string header = io4_.readFile();
+
+    Lease4Ptr lease = initiateRandomLease4(IOAddress("192.0.2.1"));
+    ASSERT_TRUE(lease_mgr->addLease(lease));
+    EXPECT_EQ(header, io4_.readFile());
+
+    lease = initiateRandomLease4(IOAddress("192.0.2.2"));
+    ASSERT_TRUE(lease_mgr->addLease(lease));
+    std::string contents = io4_.readFile();
+    EXPECT_NE(std::string::npos, contents.find("192.0.2.1,"));
+    EXPECT_NE(std::string::npos, contents.find("192.0.2.2,"));
+
+    // The pending change is written when the lease manager is destroyed.
+    EXPECT_TRUE(lease_mgr->deleteLease(lease));
+    EXPECT_EQ(contents, io4_.readFile());
+    lease_mgr.reset();
+    EXPECT_NE(contents, io4_.readFile());
+
+    // All leases are found after a reload.
+    lease_mgr.reset(new Memfile_LeaseMgr(pmap));
+    EXPECT_TRUE(lease_mgr->getLease4(IOAddress("192.0.2.1")));
+    EXPECT_FALSE(lease_mgr->getLease4(IOAddress("192.0.2.2")));
+}
+
+/// @brief Checks that the lease changes are flushed to the lease file
+/// every flush-interval milliseconds.
+TEST_F(MemfileLeaseMgrTest, flushTimer) {
+    DatabaseConnection::ParameterMap pmap;
+    pmap["type"] = "memfile";
+    pmap["universe"] = "6";
+    pmap["name"] = getLeaseFilePath("leasefile6_0.csv");
+    pmap["lfc-interval"] = "0";
+    pmap["flush-records"] = "0";
+    pmap["flush-interval"] = "100";
+
+    boost::scoped_ptr<Memfile_LeaseMgr> lease_mgr(new Memfile_LeaseMgr(pmap));
+    const std::string header = io6_.readFile();
+
+    Lease6Ptr lease = initiateRandomLease6(IOAddress("2001:db8:1::1"));
+    ASSERT_TRUE(lease_mgr->addLease(lease));
+    EXPECT_EQ(header, io6_.readFile());
+
+    // Run the timers for at most 0.3 seconds.
+    setTestTime(300);
+    EXPECT_NE(std::string::npos, io6_.readFile().find("2001:db8:1::1,"));
+}
+
+/// @brief Checks that the lease changes are appended to the lease file
+/// by the writer thread when write-queue-size is set.
+TEST_F(MemfileLeaseMgrTest, writerThread4) {
+    DatabaseConnection::ParameterMap pmap;
+    pmap["type"] = "memfile";
+    pmap["universe"] = "4";
+    pmap["name"] = getLeaseFilePath("leasefile4_0.csv");
+    pmap["lfc-interval"] = "0";
+    pmap["write-queue-size"] = "4";
+
+    MultiThreadingMgr::instance().setMode(true);
+    boost::scoped_ptr<Memfile_LeaseMgr> lease_mgr(new Memfile_LeaseMgr(pmap));
+    stats::StatsMgr& stats_mgr = stats::StatsMgr::instance();
+    EXPECT_TRUE(stats_mgr.getObservation("lease-file-write-queue-depth"));
+    EXPECT_TRUE(stats_mgr.getObservation("lease-file-write-latency"));
+    EXPECT_TRUE(stats_mgr.getObservation("lease-file-write-queue-full"));
+
+    // Add more leases than the queue can hold: the additions wait for
+    // the writer thread.
+    for (int i = 1; i <= 16; ++i) {
+        std::ostringstream address;
+        address << "192.0.2." << i;
+        Lease4Ptr lease = initiateRandomLease4(IOAddress(address.str()));
+        ASSERT_TRUE(lease_mgr->addLease(lease));
+    }
+    Lease4Ptr lease = lease_mgr->getLease4(IOAddress("192.0.2.16"));
+    ASSERT_TRUE(lease);
+    EXPECT_TRUE(lease_mgr->deleteLease(lease));
+
+    // The queued changes are appended when the lease manager is destroyed.
+    lease_mgr.reset();
+    MultiThreadingMgr::instance().setMode(false);
+    EXPECT_FALSE(stats_mgr.getObservation("lease-file-write-queue-depth"));
+    std::string contents = io4_.readFile();
+    EXPECT_NE(std::string::npos, contents.find("192.0.2.1,"));
+    EXPECT_NE(std::string::npos, contents.find("192.0.2.15,"));
+
+    // All leases are found after a reload.
+    lease_mgr.reset(new Memfile_LeaseMgr(pmap));
+    EXPECT_TRUE(lease_mgr->getLease4(IOAddress("192.0.2.1")));
+    EXPECT_TRUE(lease_mgr->getLease4(IOAddress("192.0.2.15")));
+    EXPECT_FALSE(lease_mgr->getLease4(IOAddress("192.0.2.16")));
+}
+
+/// @brief Checks that the writer thread flushes the lease file when its
+/// queue is empty.
+TEST_F(MemfileLeaseMgrTest, writerThreadFlush6) {
+    DatabaseConnection::ParameterMap pmap;
+    pmap["type"] = "memfile";
+    pmap["universe"] = "6";
+    pmap["name"] = getLeaseFilePath("leasefile6_0.csv");
+    pmap["lfc-interval"] = "0";
+    pmap["flush-records"] = "0";
+    pmap["write-queue-size"] = "16";
+    pmap["write-queue-full"] = "drop";
+
+    boost::scoped_ptr<NakedMemfileLeaseMgr> lease_mgr(new NakedMemfileLeaseMgr(pmap));
+
+    Lease6Ptr lease = initiateRandomLease6(IOAddress("2001:db8:1::1"));
+    ASSERT_TRUE(lease_mgr->addLease(lease));
+
+    // Without flushes by record count the lease reaches the lease file
+    // only because the writer thread flushes it once its queue is empty.
+    lease_mgr->writerWait();
+    EXPECT_NE(std::string::npos, io6_.readFile().find("2001:db8:1::1,"));
+
+    // The statistics are updated once the writer thread is done.
+    stats::ObservationPtr observation =
+        stats::StatsMgr::instance().getObservation("lease-file-write-queue-depth");
+    ASSERT_TRUE(observation);
+    EXPECT_EQ(0, observation->getInteger().first);
+}
+
+/// @brief Checks that the lease changes are refused after the writer thread
+/// failed to append one.
+TEST_F(MemfileLeaseMgrTest, writerThreadFailure4) {
+    DatabaseConnection::ParameterMap pmap;
+    pmap["type"] = "memfile";
+    pmap["universe"] = "4";
+    pmap["name"] = getLeaseFilePath("leasefile4_0.csv");
+    pmap["lfc-interval"] = "0";
+    pmap["write-queue-size"] = "4";
+
+    boost::scoped_ptr<NakedMemfileLeaseMgr> lease_mgr(new NakedMemfileLeaseMgr(pmap));
+
+    // A lease with neither hardware address nor client identifier can't
+    // be appended to the lease file, but this is only found by the writer
+    // thread.
+    Lease4Ptr lease = initiateRandomLease4(IOAddress("192.0.2.1"));
+    lease->hwaddr_.reset();
+    lease->client_id_.reset();
+    ASSERT_TRUE(lease_mgr->addLease(lease));
+
+    // The error is counted once the writer thread is done.
+    lease_mgr->writerWait();
+    stats::ObservationPtr observation =
+        stats::StatsMgr::instance().getObservation("lease-file-write-errors");
+    ASSERT_TRUE(observation);
+    EXPECT_EQ(1, observation->getInteger().first);
+
+    // The following lease changes are refused before being applied.
+    lease = initiateRandomLease4(IOAddress("192.0.2.2"));
+    EXPECT_THROW(lease_mgr->addLease(lease), DbOperationError);
+    EXPECT_FALSE(lease_mgr->getLease4(IOAddress("192.0.2.2")));
+}
+
 /// @brief This test checks that the callback function executing the cleanup of the
 /// DHCPv4 lease file works as expected.
 TEST_F(MemfileLeaseMgrTest, leaseFileCleanup4) {
@@ -853,6 +1041,74 @@ TEST_F(MemfileLeaseMgrTest, basicLease4MultiThread) {
     testBasicLease4();
 }
 
+/// @brief Checks that the lookups running concurrently with the updates
+/// find the leases by address, HW address and client identifier, and that
+/// the lease file records the updates in the order they were applied.
+TEST_F(MemfileLeaseMgrTest, concurrentLookupsUpdates4MultiThread) {
+    startBackend(V4);
+    MultiThreadingMgr::instance().setMode(true);
+
+    const size_t thread_count = 4;
+    const uint32_t update_count = 200;
+
+    // Each updater thread owns a lease, a lookup thread searches for it.
+    std::vector<Lease4Ptr> leases;
+    for (size_t i = 0; i < thread_count; ++i) {
+        IOAddress address(static_cast<uint32_t>(0xc0000201 + i));
+        Lease4Ptr lease = initiateRandomLease4(address);
+        ASSERT_TRUE(lmptr_->addLease(lease));
+        leases.push_back(lease);
+    }
+
+    std::atomic<bool> done(false);
+    std::atomic<size_t> errors(0);
+    std::vector<std::thread> updaters;
+    std::vector<std::thread> readers;
+    for (size_t i = 0; i < thread_count; ++i) {
+        updaters.emplace_back([&, i]() {
+            Lease4Ptr lease(new Lease4(*leases[i]));
+            for (uint32_t j = 1; j <= update_count; ++j) {
+                lease->valid_lft_ = 1200 + j;
+                try {
+                    lmptr_->updateLease4(lease);
+                } catch (...) {
+                    ++errors;
+                }
+            }
+        });
+        readers.emplace_back([&, i]() {
+            do {
+                Lease4Ptr lease = lmptr_->getLease4(leases[i]->addr_);
+                if (!lease || !(*lease->hwaddr_ == *leases[i]->hwaddr_)) {
+                    ++errors;
+                }
+                if (lmptr_->getLease4(*leases[i]->hwaddr_).size() != 1) {
+                    ++errors;
+                }
+                if (lmptr_->getLease4(*leases[i]->client_id_).size() != 1) {
+                    ++errors;
+                }
+            } while (!done);
+        });
+    }
+    for (auto& updater : updaters) {
+        updater.join();
+    }
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(0, errors.load());
+
+    // The last update of each lease must be the one loaded from the file.
+    reopen(V4);
+    for (auto const& lease : leases) {
+        Lease4Ptr from_file = lmptr_->getLease4(lease->addr_);
+        ASSERT_TRUE(from_file);
+        EXPECT_EQ(1200 + update_count, from_file->valid_lft_);
+    }
+}
+
 /// @todo Write more memfile tests
 
 /// @brief Simple test about lease4 retrieval through client id method
@@ -868,6 +1124,19 @@ TEST_F(MemfileLeaseMgrTest, getLease4ClientIdMultiThread) {
     testGetLease4ClientId();
 }
 
+/// @brief Checks retrieval of the leases which may belong to a client.
+TEST_F(MemfileLeaseMgrTest, getClientLeases4) {
+    startBackend(V4);
+    testGetClientLeases4();
+}
+
+/// @brief Checks retrieval of the leases which may belong to a client.
+TEST_F(MemfileLeaseMgrTest, getClientLeases4MultiThread) {
+    startBackend(V4);
+    MultiThreadingMgr::instance().setMode(true);
+    testGetClientLeases4();
+}
+
 /// @brief Checks that lease4 retrieval client id is null is working
 TEST_F(MemfileLeaseMgrTest, getLease4NullClientId) {
     startBackend(V4);
@@ -940,6 +1209,113 @@ TEST_F(MemfileLeaseMgrTest, lease4NullClientIdMultiThread) {
     testLease4NullClientId();
 }
 
+/// @brief Checks that the lease of a client in a subnet is found by HW
+/// address and by client id when the client has leases in several subnets.
+TEST_F(MemfileLeaseMgrTest, getLease4ClientSeveralSubnets) {
+    startBackend(V4);
+
+    Lease4Ptr first = initiateRandomLease4(IOAddress("192.0.2.1"));
+    std::vector<Lease4Ptr> leases;
+    for (SubnetID subnet_id = 1; subnet_id <= 3; ++subnet_id) {
+        IOAddress address(IOAddress("192.0.2.0").toUint32() + subnet_id);
+        Lease4Ptr lease = initiateRandomLease4(address);
+        lease->hwaddr_ = first->hwaddr_;
+        lease->client_id_ = first->client_id_;
+        lease->subnet_id_ = subnet_id;
+        ASSERT_TRUE(lmptr_->addLease(lease));
+        leases.push_back(lease);
+    }
+
+    EXPECT_EQ(3, lmptr_->getLease4(*first->hwaddr_).size());
+    EXPECT_EQ(3, lmptr_->getLease4(*first->client_id_).size());
+
+    for (auto const& lease : leases) {
+        Lease4Ptr returned = lmptr_->getLease4(*lease->hwaddr_,
+                                               lease->subnet_id_);
+        ASSERT_TRUE(returned);
+        EXPECT_EQ(lease->addr_, returned->addr_);
+
+        returned = lmptr_->getLease4(*lease->client_id_, lease->subnet_id_);
+        ASSERT_TRUE(returned);
+        EXPECT_EQ(lease->addr_, returned->addr_);
+
+        returned = lmptr_->getLease4(*lease->client_id_, *lease->hwaddr_,
+                                     lease->subnet_id_);
+        ASSERT_TRUE(returned);
+        EXPECT_EQ(lease->addr_, returned->addr_);
+    }
+
+    // No lease in another subnet.
+    EXPECT_FALSE(lmptr_->getLease4(*first->hwaddr_, 4));
+    EXPECT_FALSE(lmptr_->getLease4(*first->client_id_, 4));
+    EXPECT_FALSE(lmptr_->getLease4(*first->client_id_, *first->hwaddr_, 4));
+}
+
+/// @brief Checks that the stored lease is a copy of the added lease so
+/// modifying the added lease doesn't change the stored lease.
+TEST_F(MemfileLeaseMgrTest, addLeaseCopy4) {
+    startBackend(V4);
+
+    Lease4Ptr lease = initiateRandomLease4(IOAddress("192.0.2.1"));
+    ASSERT_TRUE(lmptr_->addLease(lease));
+    HWAddr hwaddr(*lease->hwaddr_);
+    ClientId client_id(lease->client_id_->getClientId());
+
+    // Modify the added lease without updating it.
+    ++lease->hwaddr_->hwaddr_[0];
+    lease->client_id_.reset(new ClientId(std::vector<uint8_t>(8, 1)));
+    lease->valid_lft_ += 100;
+
+    Lease4Ptr returned = lmptr_->getLease4(lease->addr_);
+    ASSERT_TRUE(returned);
+    ASSERT_TRUE(returned->hwaddr_);
+    EXPECT_TRUE(*returned->hwaddr_ == hwaddr);
+    ASSERT_TRUE(returned->client_id_);
+    EXPECT_TRUE(*returned->client_id_ == client_id);
+    EXPECT_EQ(lease->valid_lft_ - 100, returned->valid_lft_);
+
+    // The lease is still indexed by the original identifiers.
+    EXPECT_EQ(1, lmptr_->getLease4(hwaddr).size());
+    EXPECT_EQ(1, lmptr_->getLease4(client_id).size());
+}
+
+/// @brief Checks that the leases of a client share its DUID when added,
+/// updated and loaded from the lease file.
+TEST_F(MemfileLeaseMgrTest, sharedDuid6) {
+    startBackend(V6);
+
+    Lease6Ptr na = initiateRandomLease6(IOAddress("2001:db8:1::1"));
+    Lease6Ptr pd = initiateRandomLease6(IOAddress("3000::"));
+    pd->type_ = Lease::TYPE_PD;
+    pd->prefixlen_ = 64;
+    // Equal DUIDs in distinct objects.
+    pd->duid_.reset(new DUID(na->duid_->getDuid()));
+    ASSERT_TRUE(lmptr_->addLease(na));
+    ASSERT_TRUE(lmptr_->addLease(pd));
+
+    Lease6Ptr returned_na = lmptr_->getLease6(Lease::TYPE_NA, na->addr_);
+    Lease6Ptr returned_pd = lmptr_->getLease6(Lease::TYPE_PD, pd->addr_);
+    ASSERT_TRUE(returned_na && returned_pd);
+    EXPECT_EQ(returned_na->duid_, returned_pd->duid_);
+    EXPECT_NE(pd->duid_, returned_pd->duid_);
+    EXPECT_TRUE(*returned_pd->duid_ == *pd->duid_);
+
+    // Update the prefix with another copy of the DUID.
+    returned_pd->duid_.reset(new DUID(na->duid_->getDuid()));
+    ASSERT_NO_THROW(lmptr_->updateLease6(returned_pd));
+    returned_pd = lmptr_->getLease6(Lease::TYPE_PD, pd->addr_);
+    ASSERT_TRUE(returned_pd);
+    EXPECT_EQ(returned_na->duid_, returned_pd->duid_);
+
+    // Check the leases loaded from the lease file.
+    reopen(V6);
+    returned_na = lmptr_->getLease6(Lease::TYPE_NA, na->addr_);
+    returned_pd = lmptr_->getLease6(Lease::TYPE_PD, pd->addr_);
+    ASSERT_TRUE(returned_na && returned_pd);
+    EXPECT_EQ(returned_na->duid_, returned_pd->duid_);
+    EXPECT_TRUE(*returned_na->duid_ == *na->duid_);
+}
+
 /// @brief Check GetLease4 methods - access by Hardware Address & Subnet ID
 ///
 /// Adds leases to the database and checks that they can be accessed via
@@ -1221,6 +1597,19 @@ TEST_F(MemfileLeaseMgrTest, deleteExpiredReclaimedLeases6MultiThread) {
     testDeleteExpiredReclaimedLeases6();
 }
 
+/// @brief Check that a batch of DHCPv6 leases is updated and deleted.
+TEST_F(MemfileLeaseMgrTest, updateLeases6) {
+    startBackend(V6);
+    testUpdateLeases6();
+}
+
+/// @brief Check that a batch of DHCPv6 leases is updated and deleted.
+TEST_F(MemfileLeaseMgrTest, updateLeases6MultiThread) {
+    startBackend(V6);
+    MultiThreadingMgr::instance().setMode(true);
+    testUpdateLeases6();
+}
+
 /// @brief Check that expired reclaimed DHCPv4 leases are removed.
 TEST_F(MemfileLeaseMgrTest, deleteExpiredReclaimedLeases4) {
     startBackend(V4);
@@ -1234,6 +1623,19 @@ TEST_F(MemfileLeaseMgrTest, deleteExpiredReclaimedLeases4MultiThread) {
     testDeleteExpiredReclaimedLeases4();
 }
 
+/// @brief Check that a batch of DHCPv4 leases is updated and deleted.
+TEST_F(MemfileLeaseMgrTest, updateLeases4) {
+    startBackend(V4);
+    testUpdateLeases4();
+}
+
+/// @brief Check that a batch of DHCPv4 leases is updated and deleted.
+TEST_F(MemfileLeaseMgrTest, updateLeases4MultiThread) {
+    startBackend(V4);
+    MultiThreadingMgr::instance().setMode(true);
+    testUpdateLeases4();
+}
+
 /// @brief Check that getLease6 methods discriminate by lease type.
 ///
 /// Adds six leases, two per lease type all with the same duid and iad but
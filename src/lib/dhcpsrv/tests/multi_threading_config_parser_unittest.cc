@@ -70,6 +70,13 @@ TEST_F(MultiThreadingConfigParserTest, validContent) {
         "   \"thread-pool-size\": 4, \n"
         "   \"packet-queue-size\": 64 \n"
         "} \n"
+        },
+        {
+        "enable-multi-threading, with client-affinity",
+        "{ \n"
+        "   \"enable-multi-threading\": true, \n"
+        "   \"client-affinity\": true \n"
+        "} \n"
         }
     };
 
@@ -160,6 +167,13 @@ TEST_F(MultiThreadingConfigParserTest, invalidContent) {
         "{ \n"
         "   \"packet-queue-size\": 200000 \n"
         "} \n"
+        },
+        {
+        "client-affinity not boolean",
+        "{ \n"
+        "   \"enable-multi-threading\": true, \n"
+        "   \"client-affinity\": 4 \n"
+        "} \n"
         }
     };
 
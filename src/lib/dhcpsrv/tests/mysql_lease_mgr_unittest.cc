@@ -430,6 +430,17 @@ TEST_F(MySqlLeaseMgrTest, getLease4ClientIdMultiThreading) {
     testGetLease4ClientId();
 }
 
+/// @brief Checks retrieval of the leases which may belong to a client.
+TEST_F(MySqlLeaseMgrTest, getClientLeases4) {
+    testGetClientLeases4();
+}
+
+/// @brief Checks retrieval of the leases which may belong to a client.
+TEST_F(MySqlLeaseMgrTest, getClientLeases4MultiThreading) {
+    MultiThreadingTest mt(true);
+    testGetClientLeases4();
+}
+
 /// @brief Check GetLease4 methods - access by Client ID
 ///
 /// Adds leases to the database and checks that they can be accessed via
@@ -622,6 +633,17 @@ TEST_F(MySqlLeaseMgrTest, deleteExpiredReclaimedLeases4MultiThreading) {
     testDeleteExpiredReclaimedLeases4();
 }
 
+/// @brief Check that a batch of DHCPv4 leases is updated and deleted.
+TEST_F(MySqlLeaseMgrTest, updateLeases4) {
+    testUpdateLeases4();
+}
+
+/// @brief Check that a batch of DHCPv4 leases is updated and deleted.
+TEST_F(MySqlLeaseMgrTest, updateLeases4MultiThreading) {
+    MultiThreadingTest mt(true);
+    testUpdateLeases4();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// LEASE6 /////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
@@ -902,6 +924,17 @@ TEST_F(MySqlLeaseMgrTest, deleteExpiredReclaimedLeases6MultiThreading) {
     testDeleteExpiredReclaimedLeases6();
 }
 
+/// @brief Check that a batch of DHCPv6 leases is updated and deleted.
+TEST_F(MySqlLeaseMgrTest, updateLeases6) {
+    testUpdateLeases6();
+}
+
+/// @brief Check that a batch of DHCPv6 leases is updated and deleted.
+TEST_F(MySqlLeaseMgrTest, updateLeases6MultiThreading) {
+    MultiThreadingTest mt(true);
+    testUpdateLeases6();
+}
+
 /// @brief Verifies that IPv4 lease statistics can be recalculated.
 TEST_F(MySqlLeaseMgrTest, recountLeaseStats4) {
     testRecountLeaseStats4();
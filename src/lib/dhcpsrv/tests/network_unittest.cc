@@ -180,6 +180,7 @@ TEST_F(NetworkTest, inheritanceSupport4) {
     globals_->set("cache-max-age", Element::create(20));
     globals_->set("ddns-update-on-renew", Element::create(true));
     globals_->set("ddns-use-conflict-resolution", Element::create(true));
+    globals_->set("allocator", Element::create("flq"));
 
     // For each parameter for which inheritance is supported run
     // the test that checks if the values are inherited properly.
@@ -352,6 +353,12 @@ TEST_F(NetworkTest, inheritanceSupport4) {
                                              &Network4::setDdnsUseConflictResolution,
                                              false, true);
     }
+    {
+        SCOPED_TRACE("allocator");
+        testNetworkInheritance<TestNetwork4>(&Network::getAllocatorType,
+                                             &Network::setAllocatorType,
+                                             "random", "flq");
+    }
 }
 
 // This test verifies that the inheritance is supported for DHCPv6
@@ -371,6 +378,7 @@ TEST_F(NetworkTest, inheritanceSupport6) {
     globals_->set("store-extended-info", Element::create(true));
     globals_->set("ddns-update-on-renew", Element::create(true));
     globals_->set("ddns-use-conflict-resolution", Element::create(true));
+    globals_->set("allocator", Element::create("flq"));
 
     // For each parameter for which inheritance is supported run
     // the test that checks if the values are inherited properly.
@@ -455,6 +463,12 @@ TEST_F(NetworkTest, inheritanceSupport6) {
                                              &Network6::setDdnsUseConflictResolution,
                                              false, true);
     }
+    {
+        SCOPED_TRACE("allocator");
+        testNetworkInheritance<TestNetwork6>(&Network::getAllocatorType,
+                                             &Network::setAllocatorType,
+                                             "random", "flq");
+    }
 
     // Interface-id requires special type of test.
     boost::shared_ptr<TestNetwork6> net_child(new TestNetwork6());
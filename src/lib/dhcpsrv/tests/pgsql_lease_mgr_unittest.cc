@@ -386,6 +386,17 @@ TEST_F(PgSqlLeaseMgrTest, getLease4ClientIdMultiThreading) {
     testGetLease4ClientId();
 }
 
+/// @brief Checks retrieval of the leases which may belong to a client.
+TEST_F(PgSqlLeaseMgrTest, getClientLeases4) {
+    testGetClientLeases4();
+}
+
+/// @brief Checks retrieval of the leases which may belong to a client.
+TEST_F(PgSqlLeaseMgrTest, getClientLeases4MultiThreading) {
+    MultiThreadingTest mt(true);
+    testGetClientLeases4();
+}
+
 /// @brief Check GetLease4 methods - access by Client ID
 ///
 /// Adds leases to the database and checks that they can be accessed via
@@ -578,6 +589,17 @@ TEST_F(PgSqlLeaseMgrTest, deleteExpiredReclaimedLeases4MultiThreading) {
     testDeleteExpiredReclaimedLeases4();
 }
 
+/// @brief Check that a batch of DHCPv4 leases is updated and deleted.
+TEST_F(PgSqlLeaseMgrTest, updateLeases4) {
+    testUpdateLeases4();
+}
+
+/// @brief Check that a batch of DHCPv4 leases is updated and deleted.
+TEST_F(PgSqlLeaseMgrTest, updateLeases4MultiThreading) {
+    MultiThreadingTest mt(true);
+    testUpdateLeases4();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// LEASE6 /////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
@@ -858,6 +880,17 @@ TEST_F(PgSqlLeaseMgrTest, deleteExpiredReclaimedLeases6MultiThreading) {
     testDeleteExpiredReclaimedLeases6();
 }
 
+/// @brief Check that a batch of DHCPv6 leases is updated and deleted.
+TEST_F(PgSqlLeaseMgrTest, updateLeases6) {
+    testUpdateLeases6();
+}
+
+/// @brief Check that a batch of DHCPv6 leases is updated and deleted.
+TEST_F(PgSqlLeaseMgrTest, updateLeases6MultiThreading) {
+    MultiThreadingTest mt(true);
+    testUpdateLeases6();
+}
+
 /// @brief Verifies that IPv4 lease statistics can be recalculated.
 TEST_F(PgSqlLeaseMgrTest, recountLeaseStats4) {
     testRecountLeaseStats4();
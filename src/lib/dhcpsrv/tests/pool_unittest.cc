@@ -17,6 +17,7 @@
 #include <gtest/gtest.h>
 
 #include <iostream>
+#include <set>
 #include <vector>
 #include <sstream>
 
@@ -94,6 +95,35 @@ TEST(Pool4Test, leasesCount) {
     EXPECT_EQ(16777216, pool4.getCapacity());
 }
 
+// This test checks the counters of the leases of a pool.
+TEST(Pool4Test, assignedCount) {
+    Pool4 pool(IOAddress("192.0.2.10"), IOAddress("192.0.2.20"));
+    EXPECT_EQ(0, pool.getAssigned());
+    EXPECT_EQ(11, pool.getFree());
+
+    pool.addAssigned(1);
+    pool.addAssigned(1);
+    EXPECT_EQ(2, pool.getAssigned());
+    EXPECT_EQ(9, pool.getFree());
+
+    pool.addAssigned(-1);
+    EXPECT_EQ(1, pool.getAssigned());
+    EXPECT_EQ(10, pool.getFree());
+
+    // The pool is exhausted.
+    pool.setAssigned(11);
+    EXPECT_EQ(0, pool.getFree());
+
+    // The counters are bounded when they are off.
+    pool.addAssigned(1);
+    EXPECT_EQ(12, pool.getAssigned());
+    EXPECT_EQ(0, pool.getFree());
+    pool.setAssigned(0);
+    pool.addAssigned(-1);
+    EXPECT_EQ(0, pool.getAssigned());
+    EXPECT_EQ(11, pool.getFree());
+}
+
 // This test creates 100 pools and verifies that their IDs are unique.
 TEST(Pool4Test, unique_id) {
 
@@ -309,6 +339,28 @@ TEST(Pool4Test, lastAllocated) {
     EXPECT_FALSE(pool->isLastAllocatedValid());
 }
 
+// This test verifies that the addresses of the pool are returned in random
+// order, each once before the pool is walked over again.
+TEST(Pool4Test, nextRandom) {
+    Pool4 pool(IOAddress("192.0.2.1"), IOAddress("192.0.2.20"));
+    EXPECT_FALSE(pool.getPermutation());
+
+    for (int round = 0; round < 2; ++round) {
+        std::set<IOAddress> addrs;
+        for (int i = 0; i < 20; ++i) {
+            IOAddress addr = pool.nextRandom();
+            EXPECT_TRUE(pool.inRange(addr));
+            EXPECT_TRUE(addrs.insert(addr).second);
+        }
+    }
+    EXPECT_TRUE(pool.getPermutation());
+
+    // A pool of a single address.
+    Pool4 single(IOAddress("192.0.2.1"), IOAddress("192.0.2.1"));
+    EXPECT_EQ("192.0.2.1", single.nextRandom().toText());
+    EXPECT_EQ("192.0.2.1", single.nextRandom().toText());
+}
+
 TEST(Pool6Test, constructor_first_last) {
 
     // let's construct 2001:db8:1:: - 2001:db8:1::ffff:ffff:ffff:ffff pool
@@ -397,6 +449,23 @@ TEST(Pool6Test, PD) {
 }
 
 // Checks that prefix pools with excluded prefixes are handled properly.
+// This test verifies that the delegated prefixes of a prefix pool are
+// returned in random order.
+TEST(Pool6Test, nextRandom) {
+    Pool6 pool(Lease::TYPE_PD, IOAddress("2001:db8:1::"), 64, 66);
+
+    std::set<IOAddress> prefixes;
+    for (int i = 0; i < 4; ++i) {
+        IOAddress prefix = pool.nextRandom();
+        EXPECT_TRUE(pool.inRange(prefix));
+        EXPECT_TRUE(prefixes.insert(prefix).second);
+    }
+    EXPECT_EQ(1, prefixes.count(IOAddress("2001:db8:1::")));
+    EXPECT_EQ(1, prefixes.count(IOAddress("2001:db8:1:0:4000::")));
+    EXPECT_EQ(1, prefixes.count(IOAddress("2001:db8:1:0:8000::")));
+    EXPECT_EQ(1, prefixes.count(IOAddress("2001:db8:1:0:c000::")));
+}
+
 TEST(Pool6Test, PDExclude) {
     Pool6Ptr pool;
 
@@ -18,12 +18,14 @@
 #include <dhcpsrv/shared_network.h>
 #include <dhcpsrv/subnet.h>
 #include <exceptions/exceptions.h>
+#include <stats/stats_mgr.h>
 #include <testutils/multi_threading_utils.h>
 
 #include <boost/pointer_cast.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <gtest/gtest.h>
 #include <limits>
+#include <sstream>
 
 // don't import the entire boost namespace.  It will unexpectedly hide uint8_t
 // for some systems.
@@ -32,6 +34,7 @@ using boost::scoped_ptr;
 using namespace isc;
 using namespace isc::dhcp;
 using namespace isc::asiolink;
+using namespace isc::stats;
 using namespace isc::test;
 
 namespace {
@@ -454,6 +457,60 @@ TEST(Subnet4Test, getCapacity) {
     EXPECT_EQ(200, subnet->getPoolCapacity(Lease::TYPE_V4, three_classes));
 }
 
+// Checks the free leases counters of the pools.
+TEST(Subnet4Test, getPoolFree) {
+    StatsMgr::instance().removeAll();
+
+    Subnet4Ptr subnet(new Subnet4(IOAddress("192.1.2.0"), 24, 1, 2, 3, 10));
+    EXPECT_EQ(0, subnet->getPoolFree(Lease::TYPE_V4, ClientClasses()));
+
+    PoolPtr pool1(new Pool4(IOAddress("192.1.2.0"), 30));
+    subnet->addPool(pool1);
+    PoolPtr pool2(new Pool4(IOAddress("192.1.2.128"), 30));
+    pool2->allowClientClass("bar");
+    subnet->addPool(pool2);
+
+    ClientClasses no_class;
+    ClientClasses bar_class;
+    bar_class.insert("bar");
+    EXPECT_EQ(4, subnet->getPoolFree(Lease::TYPE_V4, no_class));
+    EXPECT_EQ(8, subnet->getPoolFree(Lease::TYPE_V4, bar_class));
+
+    // Lease an address of each pool.
+    subnet->updatePoolAssigned(Lease::TYPE_V4, IOAddress("192.1.2.1"), 1);
+    subnet->updatePoolAssigned(Lease::TYPE_V4, IOAddress("192.1.2.130"), 1);
+    EXPECT_EQ(1, pool1->getAssigned());
+    EXPECT_EQ(1, pool2->getAssigned());
+    EXPECT_EQ(3, subnet->getPoolFree(Lease::TYPE_V4, no_class));
+    EXPECT_EQ(6, subnet->getPoolFree(Lease::TYPE_V4, bar_class));
+
+    // The pool statistics are updated.
+    ObservationPtr stat = StatsMgr::instance().getObservation(
+        "subnet[10].pool[1].assigned-addresses");
+    ASSERT_TRUE(stat);
+    EXPECT_EQ(1, stat->getInteger().first);
+
+    // Addresses out of the pools are ignored.
+    subnet->updatePoolAssigned(Lease::TYPE_V4, IOAddress("192.1.2.64"), 1);
+    EXPECT_EQ(6, subnet->getPoolFree(Lease::TYPE_V4, bar_class));
+
+    // Exhaust the first pool.
+    pool1->setAssigned(4);
+    EXPECT_EQ(0, subnet->getPoolFree(Lease::TYPE_V4, no_class));
+    EXPECT_EQ(3, subnet->getPoolFree(Lease::TYPE_V4, bar_class));
+
+    // Free an address.
+    subnet->updatePoolAssigned(Lease::TYPE_V4, IOAddress("192.1.2.1"), -1);
+    EXPECT_EQ(1, subnet->getPoolFree(Lease::TYPE_V4, no_class));
+
+    // Reset the counters.
+    subnet->resetPoolAssigned(Lease::TYPE_V4);
+    EXPECT_EQ(8, subnet->getPoolFree(Lease::TYPE_V4, bar_class));
+    EXPECT_EQ(0, stat->getInteger().first);
+
+    StatsMgr::instance().removeAll();
+}
+
 // Checks that it is not allowed to add invalid pools.
 TEST(Subnet4Test, pool4Checks) {
 
@@ -652,6 +709,62 @@ TEST(Subnet4Test, inRangeinPool) {
     EXPECT_TRUE(subnet->inPool(Lease::TYPE_V4, IOAddress("192.2.3.4"), three_classes));
 }
 
+// This test verifies that inPool() and getPool() find the right pool
+// among many pools added in any order.
+TEST(Subnet4Test, inPoolManyPools) {
+    Subnet4Ptr subnet(new Subnet4(IOAddress("10.0.0.0"), 8, 1, 2, 3));
+
+    // Add 100 pools of 16 addresses, every other block of 32 addresses,
+    // not in the address order. Odd pools are reserved to the bar class.
+    for (uint32_t i = 0; i < 100; ++i) {
+        uint32_t index = (i * 37) % 100;
+        IOAddress first(0x0a000000 + index * 32);
+        IOAddress last(0x0a000000 + index * 32 + 15);
+        Pool4Ptr pool(new Pool4(first, last));
+        if (index % 2) {
+            pool->allowClientClass("bar");
+        }
+        ASSERT_NO_THROW(subnet->addPool(pool));
+    }
+
+    // The pools are sorted by first address.
+    const PoolCollection& pools = subnet->getPools(Lease::TYPE_V4);
+    ASSERT_EQ(100, pools.size());
+    for (size_t i = 1; i < pools.size(); ++i) {
+        EXPECT_LT(pools[i - 1]->getFirstAddress(), pools[i]->getFirstAddress());
+    }
+
+    isc::dhcp::ClientClasses no_class;
+    isc::dhcp::ClientClasses bar_class;
+    bar_class.insert("bar");
+    for (uint32_t index = 0; index < 100; ++index) {
+        uint32_t base = 0x0a000000 + index * 32;
+        for (uint32_t offset : { 0, 7, 15 }) {
+            IOAddress addr(base + offset);
+            EXPECT_TRUE(subnet->inPool(Lease::TYPE_V4, addr));
+            PoolPtr pool = subnet->getPool(Lease::TYPE_V4, addr, false);
+            ASSERT_TRUE(pool);
+            EXPECT_EQ(IOAddress(base), pool->getFirstAddress());
+            EXPECT_EQ(index % 2 == 0,
+                      subnet->inPool(Lease::TYPE_V4, addr, no_class));
+            EXPECT_TRUE(subnet->inPool(Lease::TYPE_V4, addr, bar_class));
+            EXPECT_EQ(pool, subnet->getPool(Lease::TYPE_V4, bar_class, addr));
+        }
+        // Addresses between the pools are not in any pool.
+        for (uint32_t offset : { 16, 31 }) {
+            IOAddress addr(base + offset);
+            EXPECT_FALSE(subnet->inPool(Lease::TYPE_V4, addr));
+            EXPECT_FALSE(subnet->inPool(Lease::TYPE_V4, addr, bar_class));
+            EXPECT_FALSE(subnet->getPool(Lease::TYPE_V4, addr, false));
+            EXPECT_FALSE(subnet->getPool(Lease::TYPE_V4, bar_class, addr));
+        }
+    }
+
+    // Addresses before the first pool and after the last pool.
+    EXPECT_FALSE(subnet->inPool(Lease::TYPE_V4, IOAddress("9.255.255.255")));
+    EXPECT_FALSE(subnet->inPool(Lease::TYPE_V4, IOAddress("10.255.255.255")));
+}
+
 // This test checks if the toText() method returns text representation
 TEST(Subnet4Test, toText) {
     Subnet4Ptr subnet(new Subnet4(IOAddress("192.0.2.0"), 24, 1, 2, 3));
@@ -1649,6 +1762,46 @@ TEST(Subnet6Test, PdinRangeinPool) {
     EXPECT_FALSE(subnet->inPool(Lease::TYPE_PD, IOAddress("2001:db8:0:1:0:1::")));
 }
 
+// This test verifies that inPool() and getPool() find the right prefix
+// pool among many prefix pools added in any order.
+TEST(Subnet6Test, PdinPoolManyPools) {
+    Subnet6Ptr subnet(new Subnet6(IOAddress("2001:db8::"), 64, 1, 2, 3, 4));
+
+    // Add 64 prefix pools 3000:<index * 2>::/32 delegating /48 prefixes,
+    // not in the prefix order.
+    for (uint16_t i = 0; i < 64; ++i) {
+        uint16_t index = (i * 23) % 64;
+        std::ostringstream prefix;
+        prefix << "3000:" << std::hex << index * 2 << "::";
+        Pool6Ptr pool(new Pool6(Lease::TYPE_PD, IOAddress(prefix.str()),
+                                32, 48));
+        ASSERT_NO_THROW(subnet->addPool(pool));
+    }
+
+    const PoolCollection& pools = subnet->getPools(Lease::TYPE_PD);
+    ASSERT_EQ(64, pools.size());
+    for (size_t i = 1; i < pools.size(); ++i) {
+        EXPECT_LT(pools[i - 1]->getFirstAddress(), pools[i]->getFirstAddress());
+    }
+
+    for (uint16_t index = 0; index < 64; ++index) {
+        std::ostringstream in_pool;
+        in_pool << "3000:" << std::hex << index * 2 << ":ffff::";
+        IOAddress prefix(in_pool.str());
+        EXPECT_TRUE(subnet->inPool(Lease::TYPE_PD, prefix));
+        PoolPtr pool = subnet->getPool(Lease::TYPE_PD, prefix, false);
+        ASSERT_TRUE(pool);
+        EXPECT_TRUE(pool->inRange(prefix));
+
+        std::ostringstream out_of_pool;
+        out_of_pool << "3000:" << std::hex << index * 2 + 1 << "::";
+        EXPECT_FALSE(subnet->inPool(Lease::TYPE_PD,
+                                    IOAddress(out_of_pool.str())));
+        EXPECT_FALSE(subnet->getPool(Lease::TYPE_PD,
+                                     IOAddress(out_of_pool.str()), false));
+    }
+}
+
 // This test checks if the toText() method returns text representation
 TEST(Subnet6Test, toText) {
     Subnet6 subnet(IOAddress("2001:db8::"), 32, 1, 2, 3, 4);
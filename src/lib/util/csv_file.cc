@@ -69,15 +69,20 @@ CSVRow::readAtEscaped(const size_t at) const {
 
 std::string
 CSVRow::render() const {
-    std::ostringstream s;
+    size_t length = values_.size() * separator_.size();
+    for (auto const& value : values_) {
+        length += value.size();
+    }
+    std::string text;
+    text.reserve(length);
     for (size_t i = 0; i < values_.size(); ++i) {
         // Do not put separator before the first value.
         if (i > 0) {
-            s << separator_;
+            text += separator_;
         }
-        s << values_[i];
+        text += values_[i];
     }
-    return (s.str());
+    return (text);
 }
 
 void
@@ -112,7 +117,8 @@ CSVRow::checkIndex(const size_t at) const {
 }
 
 CSVFile::CSVFile(const std::string& filename)
-    : filename_(filename), fs_(), cols_(0), read_msg_() {
+    : filename_(filename), fs_(), cols_(0), read_msg_(), flush_rows_(1),
+      pending_rows_(0) {
 }
 
 CSVFile::~CSVFile() {
@@ -127,6 +133,7 @@ CSVFile::close() {
         fs_->close();
         fs_.reset();
     }
+    pending_rows_ = 0;
 }
 
 bool
@@ -141,6 +148,7 @@ void
 CSVFile::flush() const {
     checkStreamStatusAndReset("flush");
     fs_->flush();
+    pending_rows_ = 0;
 }
 
 void
@@ -180,13 +188,22 @@ CSVFile::append(const CSVRow& row) const {
     /// content. If we come up with the scenarios when read and write is
     /// needed at the same time, we may revisit this: perhaps remember the
     /// old pointer. Also, for safety, we call both functions so as we are
-    /// sure that both pointers are moved.
-    fs_->seekp(0, std::ios_base::end);
-    fs_->seekg(0, std::ios_base::end);
-    fs_->clear();
+    /// sure that both pointers are moved. Seeking flushes the stream, so
+    /// it is skipped while rows are pending: the pointers are then at the
+    /// end of the row written last.
+    if (pending_rows_ == 0) {
+        fs_->seekp(0, std::ios_base::end);
+        fs_->seekg(0, std::ios_base::end);
+        fs_->clear();
+    }
 
     std::string text = row.render();
-    *fs_ << text << std::endl;
+    *fs_ << text << '\n';
+    ++pending_rows_;
+    if ((flush_rows_ > 0) && (pending_rows_ >= flush_rows_)) {
+        fs_->flush();
+        pending_rows_ = 0;
+    }
     if (!fs_->good()) {
         fs_->clear();
         isc_throw(CSVFileError, "failed to write CSV row '"
@@ -355,6 +355,11 @@ std::ostream& operator<<(std::ostream& os, const CSVRow& row);
 /// immediately written into it. The header consists of the column names
 /// specified with the @c addColumn function. The subsequent rows are written
 /// into this file by calling @c append.
+///
+/// By default the file is flushed after each row written by @c append. The
+/// @c setFlushRows function makes it flush after a group of rows, which
+/// saves a write to the file per row at the cost of losing the rows not yet
+/// flushed when the process ends abruptly.
 class CSVFile {
 public:
 
@@ -379,6 +384,9 @@ public:
 
     /// @brief Writes the CSV row into the file.
     ///
+    /// The file is flushed when the number of rows written since the last
+    /// flush reaches the value set with @c setFlushRows.
+    ///
     /// @param row Object representing a CSV file row.
     ///
     /// @throw CSVFileError When error occurred during IO operation or if the
@@ -399,6 +407,27 @@ public:
     /// @brief Flushes a file.
     void flush() const;
 
+    /// @brief Sets the number of rows written by @c append before the file
+    /// is flushed.
+    ///
+    /// @param flush_rows Number of rows, 1 to flush after each row (the
+    /// default), 0 to let the file stream flush when its buffer is full.
+    void setFlushRows(const size_t flush_rows) {
+        flush_rows_ = flush_rows;
+    }
+
+    /// @brief Returns the number of rows written by @c append before the
+    /// file is flushed.
+    size_t getFlushRows() const {
+        return (flush_rows_);
+    }
+
+    /// @brief Returns the number of rows written by @c append since the
+    /// file was last flushed.
+    size_t getPendingRows() const {
+        return (pending_rows_);
+    }
+
     /// @brief Returns the number of columns in the file.
     size_t getColumnCount() const {
         return (cols_.size());
@@ -567,6 +596,12 @@ private:
 
     /// @brief Holds last error during row reading or validation.
     std::string read_msg_;
+
+    /// @brief Number of rows written before the file is flushed.
+    size_t flush_rows_;
+
+    /// @brief Number of rows written since the file was last flushed.
+    mutable size_t pending_rows_;
 };
 
 } // namespace isc::util
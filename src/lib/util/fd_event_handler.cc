@@ -0,0 +1,282 @@
+// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <exceptions/exceptions.h>
+#include <util/fd_event_handler.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+#if defined (OS_LINUX)
+#include <sys/epoll.h>
+#endif
+
+namespace isc {
+namespace util {
+
+std::string
+FDEventHandler::typeToText(HandlerType type) {
+    switch (type) {
+    case TYPE_SELECT:
+        return ("select");
+    case TYPE_EPOLL:
+        return ("epoll");
+    default:
+        return ("unknown");
+    }
+}
+
+FDEventHandler::HandlerType
+FDEventHandler::typeFromText(const std::string& name) {
+    if (name == "select") {
+        return (TYPE_SELECT);
+    } else if (name == "epoll") {
+        return (TYPE_EPOLL);
+    }
+    isc_throw(BadValue, "unknown file descriptor event handler '" << name
+              << "', expected 'select' or 'epoll'");
+}
+
+bool
+FDEventHandler::isSupported(HandlerType type) {
+    switch (type) {
+    case TYPE_SELECT:
+        return (true);
+    case TYPE_EPOLL:
+#if defined (OS_LINUX)
+        return (true);
+#else
+        return (false);
+#endif
+    default:
+        return (false);
+    }
+}
+
+SelectEventHandler::SelectEventHandler() : FDEventHandler(TYPE_SELECT) {
+    FD_ZERO(&read_fd_set_);
+    FD_ZERO(&ready_fd_set_);
+}
+
+void
+SelectEventHandler::add(int fd) {
+    if ((fd < 0) || (fd >= FD_SETSIZE)) {
+        isc_throw(BadValue, "invalid file descriptor " << fd
+                  << " for select(), must be in range 0.." << FD_SETSIZE - 1);
+    }
+    FD_SET(fd, &read_fd_set_);
+    fds_.insert(fd);
+}
+
+void
+SelectEventHandler::del(int fd) {
+    if (fds_.erase(fd)) {
+        FD_CLR(fd, &read_fd_set_);
+        FD_CLR(fd, &ready_fd_set_);
+    }
+}
+
+void
+SelectEventHandler::clear() {
+    FD_ZERO(&read_fd_set_);
+    FD_ZERO(&ready_fd_set_);
+    fds_.clear();
+}
+
+int
+SelectEventHandler::waitEvent(uint32_t timeout_sec, uint32_t timeout_usec,
+                              bool use_timeout) {
+    // Sanity check for microsecond timeout.
+    if (timeout_usec >= 1000000) {
+        isc_throw(BadValue, "fractional timeout must be shorter than"
+                  " one million microseconds");
+    }
+
+    // select() modifies the set so it works on a copy.
+    ready_fd_set_ = read_fd_set_;
+    int maxfd = fds_.empty() ? -1 : *fds_.rbegin();
+
+    struct timeval select_timeout;
+    select_timeout.tv_sec = timeout_sec;
+    select_timeout.tv_usec = timeout_usec;
+
+    int result = select(maxfd + 1, &ready_fd_set_, 0, 0,
+                        use_timeout ? &select_timeout : 0);
+    if (result <= 0) {
+        // Nothing is ready on timeout and the set is undefined on error.
+        int saved_errno = errno;
+        FD_ZERO(&ready_fd_set_);
+        errno = saved_errno;
+    }
+    return (result);
+}
+
+bool
+SelectEventHandler::readReady(int fd) const {
+    if ((fd < 0) || (fd >= FD_SETSIZE)) {
+        return (false);
+    }
+    return (FD_ISSET(fd, &ready_fd_set_));
+}
+
+std::vector<int>
+SelectEventHandler::readyFds() const {
+    std::vector<int> ready;
+    for (int fd : fds_) {
+        if (FD_ISSET(fd, &ready_fd_set_)) {
+            ready.push_back(fd);
+        }
+    }
+    return (ready);
+}
+
+#if defined (OS_LINUX)
+
+EPollEventHandler::EPollEventHandler()
+    : FDEventHandler(TYPE_EPOLL), epollfd_(-1) {
+    epollfd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epollfd_ < 0) {
+        isc_throw(Unexpected, "failed to create epoll instance: "
+                  << strerror(errno));
+    }
+}
+
+EPollEventHandler::~EPollEventHandler() {
+    if (epollfd_ >= 0) {
+        close(epollfd_);
+    }
+}
+
+void
+EPollEventHandler::add(int fd) {
+    if (fd < 0) {
+        isc_throw(BadValue, "invalid negative file descriptor " << fd);
+    }
+    if (fds_.count(fd)) {
+        return;
+    }
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(epollfd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+        // A descriptor which was closed and reused without being removed
+        // is still registered under the same number.
+        if (errno != EEXIST) {
+            isc_throw(BadValue, "failed to add file descriptor " << fd
+                      << " to epoll instance: " << strerror(errno));
+        }
+    }
+    fds_.insert(fd);
+}
+
+void
+EPollEventHandler::del(int fd) {
+    if (fds_.erase(fd)) {
+        // Closed descriptors are already removed by the kernel so
+        // errors are ignored.
+        static_cast<void>(epoll_ctl(epollfd_, EPOLL_CTL_DEL, fd, 0));
+        ready_fds_.erase(std::remove(ready_fds_.begin(), ready_fds_.end(), fd),
+                         ready_fds_.end());
+    }
+}
+
+void
+EPollEventHandler::clear() {
+    for (int fd : fds_) {
+        static_cast<void>(epoll_ctl(epollfd_, EPOLL_CTL_DEL, fd, 0));
+    }
+    fds_.clear();
+    ready_fds_.clear();
+}
+
+int
+EPollEventHandler::waitEvent(uint32_t timeout_sec, uint32_t timeout_usec,
+                             bool use_timeout) {
+    // Sanity check for microsecond timeout.
+    if (timeout_usec >= 1000000) {
+        isc_throw(BadValue, "fractional timeout must be shorter than"
+                  " one million microseconds");
+    }
+
+    ready_fds_.clear();
+
+    int timeout = -1;
+    if (use_timeout) {
+        timeout = timeout_sec * 1000 + (timeout_usec + 999) / 1000;
+    }
+
+    // Descriptors are level triggered so the ones which do not fit
+    // in the events array are reported by the next wait.
+    struct epoll_event events[MAX_EVENTS];
+    int result = epoll_wait(epollfd_, events, MAX_EVENTS, timeout);
+    for (int i = 0; i < result; ++i) {
+        // Errors and hang ups are reported as read readiness like
+        // select() does so the following read returns the error.
+        ready_fds_.push_back(events[i].data.fd);
+    }
+    return (result);
+}
+
+bool
+EPollEventHandler::readReady(int fd) const {
+    return (std::find(ready_fds_.begin(), ready_fds_.end(), fd) !=
+            ready_fds_.end());
+}
+
+#else
+
+EPollEventHandler::EPollEventHandler()
+    : FDEventHandler(TYPE_EPOLL), epollfd_(-1) {
+    isc_throw(NotImplemented, "epoll is not supported on this system");
+}
+
+EPollEventHandler::~EPollEventHandler() {
+}
+
+void
+EPollEventHandler::add(int) {
+}
+
+void
+EPollEventHandler::del(int) {
+}
+
+void
+EPollEventHandler::clear() {
+}
+
+int
+EPollEventHandler::waitEvent(uint32_t, uint32_t, bool) {
+    return (-1);
+}
+
+bool
+EPollEventHandler::readReady(int) const {
+    return (false);
+}
+
+#endif
+
+FDEventHandlerPtr
+FDEventHandlerFactory::factoryFDEventHandler(FDEventHandler::HandlerType type) {
+    switch (type) {
+    case FDEventHandler::TYPE_SELECT:
+        return (FDEventHandlerPtr(new SelectEventHandler()));
+    case FDEventHandler::TYPE_EPOLL:
+        return (FDEventHandlerPtr(new EPollEventHandler()));
+    default:
+        isc_throw(NotImplemented, "unsupported file descriptor event handler"
+                  " type " << static_cast<int>(type));
+    }
+}
+
+} // namespace util
+} // namespace isc
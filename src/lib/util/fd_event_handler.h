@@ -0,0 +1,284 @@
+// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef FD_EVENT_HANDLER_H
+#define FD_EVENT_HANDLER_H
+
+/// @file fd_event_handler.h Defines the FDEventHandler class and its
+/// select() and epoll() based implementations.
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <sys/select.h>
+
+#include <stdint.h>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace isc {
+namespace util {
+
+/// @brief File descriptor event handler.
+///
+/// Waits for read readiness on a set of file descriptors. The set of
+/// watched file descriptors (the interest set) is persistent: descriptors
+/// are added and removed explicitly and stay registered across calls to
+/// @c waitEvent, so the caller does not have to rebuild it before each
+/// wait.
+///
+/// Instances are not thread safe: each thread waiting for events must use
+/// its own handler.
+class FDEventHandler : public boost::noncopyable {
+public:
+    /// @brief Type of the event handler.
+    enum HandlerType {
+        TYPE_SELECT = 0,    ///< select() based handler.
+        TYPE_EPOLL = 1      ///< epoll() based handler (Linux only).
+    };
+
+    /// @brief Constructor.
+    ///
+    /// @param type The type of the event handler.
+    FDEventHandler(HandlerType type) : type_(type) {
+    }
+
+    /// @brief Destructor.
+    virtual ~FDEventHandler() {
+    }
+
+    /// @brief Returns the type of the event handler.
+    HandlerType type() const {
+        return (type_);
+    }
+
+    /// @brief Adds a file descriptor to the interest set.
+    ///
+    /// Adding a file descriptor which is already in the set has no effect.
+    ///
+    /// @param fd The file descriptor.
+    /// @throw BadValue if the file descriptor is invalid or can't be
+    /// watched by this handler.
+    virtual void add(int fd) = 0;
+
+    /// @brief Removes a file descriptor from the interest set.
+    ///
+    /// Removing a file descriptor which is not in the set has no effect.
+    ///
+    /// @param fd The file descriptor.
+    virtual void del(int fd) = 0;
+
+    /// @brief Removes all file descriptors from the interest set.
+    virtual void clear() = 0;
+
+    /// @brief Returns the number of file descriptors in the interest set.
+    virtual size_t size() const = 0;
+
+    /// @brief Waits for events on the file descriptors of the interest set.
+    ///
+    /// @param timeout_sec Timeout in seconds.
+    /// @param timeout_usec Fractional part of the timeout in microseconds.
+    /// @param use_timeout When false the call waits until an event occurs
+    /// and the timeout is ignored.
+    /// @return The number of ready file descriptors, 0 on timeout or -1
+    /// on error with errno set.
+    virtual int waitEvent(uint32_t timeout_sec, uint32_t timeout_usec = 0,
+                          bool use_timeout = true) = 0;
+
+    /// @brief Checks if a file descriptor is ready for read.
+    ///
+    /// @param fd The file descriptor.
+    /// @return true if the last call to @c waitEvent reported the file
+    /// descriptor as ready to read (or in error), false otherwise.
+    virtual bool readReady(int fd) const = 0;
+
+    /// @brief Returns the file descriptors reported as ready by the last
+    /// call to @c waitEvent.
+    virtual std::vector<int> readyFds() const = 0;
+
+    /// @brief Converts a handler type to its textual name.
+    ///
+    /// @param type The handler type.
+    /// @return "select" or "epoll".
+    static std::string typeToText(HandlerType type);
+
+    /// @brief Converts a textual name to a handler type.
+    ///
+    /// @param name The handler name: "select" or "epoll".
+    /// @return The handler type.
+    /// @throw BadValue if the name is not recognized.
+    static HandlerType typeFromText(const std::string& name);
+
+    /// @brief Checks if a handler type is supported on this system.
+    ///
+    /// @param type The handler type.
+    /// @return true if @c FDEventHandlerFactory can create the handler.
+    static bool isSupported(HandlerType type);
+
+private:
+    /// @brief The type of the event handler.
+    HandlerType type_;
+};
+
+/// @brief Defines a pointer to a FDEventHandler.
+typedef boost::shared_ptr<FDEventHandler> FDEventHandlerPtr;
+
+/// @brief File descriptor event handler using select().
+///
+/// The descriptor set is kept between waits and copied for each call to
+/// select(), which still scans all descriptors up to the highest one.
+/// File descriptors must be below FD_SETSIZE.
+class SelectEventHandler : public FDEventHandler {
+public:
+    /// @brief Constructor.
+    SelectEventHandler();
+
+    /// @brief Destructor.
+    virtual ~SelectEventHandler() {
+    }
+
+    /// @brief Adds a file descriptor to the interest set.
+    ///
+    /// @param fd The file descriptor.
+    /// @throw BadValue if the file descriptor is negative or not below
+    /// FD_SETSIZE.
+    virtual void add(int fd);
+
+    /// @brief Removes a file descriptor from the interest set.
+    ///
+    /// @param fd The file descriptor.
+    virtual void del(int fd);
+
+    /// @brief Removes all file descriptors from the interest set.
+    virtual void clear();
+
+    /// @brief Returns the number of file descriptors in the interest set.
+    virtual size_t size() const {
+        return (fds_.size());
+    }
+
+    /// @brief Waits for events with select().
+    ///
+    /// @param timeout_sec Timeout in seconds.
+    /// @param timeout_usec Fractional part of the timeout in microseconds.
+    /// @param use_timeout When false the call waits until an event occurs.
+    /// @return The number of ready file descriptors, 0 on timeout or -1
+    /// on error with errno set.
+    virtual int waitEvent(uint32_t timeout_sec, uint32_t timeout_usec = 0,
+                          bool use_timeout = true);
+
+    /// @brief Checks if a file descriptor is ready for read.
+    ///
+    /// @param fd The file descriptor.
+    virtual bool readReady(int fd) const;
+
+    /// @brief Returns the file descriptors reported as ready by the last
+    /// call to @c waitEvent.
+    virtual std::vector<int> readyFds() const;
+
+private:
+    /// @brief The interest set.
+    fd_set read_fd_set_;
+
+    /// @brief The set filled by the last select() call.
+    fd_set ready_fd_set_;
+
+    /// @brief The watched file descriptors.
+    std::set<int> fds_;
+};
+
+/// @brief File descriptor event handler using epoll().
+///
+/// The interest set is kept by the kernel so the cost of a wait does not
+/// depend on the number of watched descriptors. Only available on Linux.
+///
+/// The kernel removes closed descriptors from the interest set, so closed
+/// descriptors are not reported as errors like with select().
+class EPollEventHandler : public FDEventHandler {
+public:
+    /// @brief Maximum number of events returned by one wait.
+    static const int MAX_EVENTS = 64;
+
+    /// @brief Constructor.
+    ///
+    /// @throw Unexpected if the epoll instance can't be created.
+    /// @throw NotImplemented if epoll is not supported on this system.
+    EPollEventHandler();
+
+    /// @brief Destructor.
+    ///
+    /// Closes the epoll instance.
+    virtual ~EPollEventHandler();
+
+    /// @brief Adds a file descriptor to the interest set.
+    ///
+    /// @param fd The file descriptor.
+    /// @throw BadValue if the file descriptor can't be watched.
+    virtual void add(int fd);
+
+    /// @brief Removes a file descriptor from the interest set.
+    ///
+    /// @param fd The file descriptor.
+    virtual void del(int fd);
+
+    /// @brief Removes all file descriptors from the interest set.
+    virtual void clear();
+
+    /// @brief Returns the number of file descriptors in the interest set.
+    virtual size_t size() const {
+        return (fds_.size());
+    }
+
+    /// @brief Waits for events with epoll_wait().
+    ///
+    /// The timeout is rounded up to the next millisecond.
+    ///
+    /// @param timeout_sec Timeout in seconds.
+    /// @param timeout_usec Fractional part of the timeout in microseconds.
+    /// @param use_timeout When false the call waits until an event occurs.
+    /// @return The number of ready file descriptors, 0 on timeout or -1
+    /// on error with errno set.
+    virtual int waitEvent(uint32_t timeout_sec, uint32_t timeout_usec = 0,
+                          bool use_timeout = true);
+
+    /// @brief Checks if a file descriptor is ready for read.
+    ///
+    /// @param fd The file descriptor.
+    virtual bool readReady(int fd) const;
+
+    /// @brief Returns the file descriptors reported as ready by the last
+    /// call to @c waitEvent.
+    virtual std::vector<int> readyFds() const {
+        return (ready_fds_);
+    }
+
+private:
+    /// @brief The epoll instance file descriptor.
+    int epollfd_;
+
+    /// @brief The watched file descriptors.
+    std::set<int> fds_;
+
+    /// @brief The file descriptors reported by the last wait.
+    std::vector<int> ready_fds_;
+};
+
+/// @brief Creates file descriptor event handlers.
+class FDEventHandlerFactory {
+public:
+    /// @brief Creates an event handler of the given type.
+    ///
+    /// @param type The handler type.
+    /// @return Pointer to the new handler.
+    /// @throw NotImplemented if the type is not supported on this system.
+    static FDEventHandlerPtr factoryFDEventHandler(FDEventHandler::HandlerType type);
+};
+
+} // namespace util
+} // namespace isc
+
+#endif // FD_EVENT_HANDLER_H
@@ -0,0 +1,423 @@
+// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef FLAT_MULTIMAP_H
+#define FLAT_MULTIMAP_H
+
+/// @file flat_multimap.h Defines a multimap stored in a sorted vector.
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace isc {
+namespace util {
+
+/// @brief Multimap stored in a sorted vector.
+///
+/// It has the interface and the ordering of @c std::multimap: elements
+/// are sorted by key and elements with the same key are kept in their
+/// insertion order. As the elements are stored contiguously, lookups and
+/// iterations don't chase pointers and the container allocates memory
+/// once for all its elements instead of once per element. It is meant
+/// for small collections, e.g. the options of a packet, built once and
+/// then mostly read: an insertion or an erasure in the middle moves the
+/// following elements.
+///
+/// The differences with @c std::multimap are:
+/// - an insertion or an erasure invalidates all iterators and references,
+/// - the keys can be modified through the iterators, which must not be
+///   done as it would break the ordering.
+///
+/// @tparam Key type of the keys.
+/// @tparam T type of the mapped values.
+/// @tparam Compare key comparison function.
+/// @tparam Allocator allocator of the elements.
+template<typename Key, typename T, typename Compare = std::less<Key>,
+         typename Allocator = std::allocator<std::pair<Key, T> > >
+class FlatMultimap {
+public:
+    /// @brief Type of the keys.
+    typedef Key key_type;
+
+    /// @brief Type of the mapped values.
+    typedef T mapped_type;
+
+    /// @brief Type of the elements.
+    typedef std::pair<Key, T> value_type;
+
+    /// @brief Key comparison function.
+    typedef Compare key_compare;
+
+    /// @brief Allocator of the elements.
+    typedef Allocator allocator_type;
+
+    /// @brief Storage of the elements.
+    typedef std::vector<value_type, Allocator> Storage;
+
+    /// @brief Iterator types.
+    typedef typename Storage::size_type size_type;
+    typedef typename Storage::difference_type difference_type;
+    typedef typename Storage::reference reference;
+    typedef typename Storage::const_reference const_reference;
+    typedef typename Storage::iterator iterator;
+    typedef typename Storage::const_iterator const_iterator;
+    typedef typename Storage::reverse_iterator reverse_iterator;
+    typedef typename Storage::const_reverse_iterator const_reverse_iterator;
+
+    /// @brief Initial capacity, reserved by the first insertion.
+    static const size_type INITIAL_CAPACITY = 8;
+
+    /// @brief Constructor.
+    FlatMultimap() : data_() {
+    }
+
+    /// @brief Constructor from a range of elements.
+    ///
+    /// @param first iterator to the first element.
+    /// @param last iterator past the last element.
+    template<typename InputIterator>
+    FlatMultimap(InputIterator first, InputIterator last) : data_() {
+        insert(first, last);
+    }
+
+    /// @brief Constructor from a list of elements.
+    ///
+    /// @param init the elements.
+    FlatMultimap(std::initializer_list<value_type> init) : data_() {
+        insert(init.begin(), init.end());
+    }
+
+    /// @name Iterators.
+    //@{
+    iterator begin() {
+        return (data_.begin());
+    }
+
+    const_iterator begin() const {
+        return (data_.begin());
+    }
+
+    const_iterator cbegin() const {
+        return (data_.cbegin());
+    }
+
+    iterator end() {
+        return (data_.end());
+    }
+
+    const_iterator end() const {
+        return (data_.end());
+    }
+
+    const_iterator cend() const {
+        return (data_.cend());
+    }
+
+    reverse_iterator rbegin() {
+        return (data_.rbegin());
+    }
+
+    const_reverse_iterator rbegin() const {
+        return (data_.rbegin());
+    }
+
+    reverse_iterator rend() {
+        return (data_.rend());
+    }
+
+    const_reverse_iterator rend() const {
+        return (data_.rend());
+    }
+    //@}
+
+    /// @brief Checks if the container is empty.
+    bool empty() const {
+        return (data_.empty());
+    }
+
+    /// @brief Returns the number of elements.
+    size_type size() const {
+        return (data_.size());
+    }
+
+    /// @brief Returns the number of elements the container can hold
+    /// without allocating memory.
+    size_type capacity() const {
+        return (data_.capacity());
+    }
+
+    /// @brief Reserves memory for a number of elements.
+    ///
+    /// @param count number of elements.
+    void reserve(size_type count) {
+        data_.reserve(count);
+    }
+
+    /// @brief Removes all elements.
+    void clear() {
+        data_.clear();
+    }
+
+    /// @brief Inserts an element.
+    ///
+    /// The element is inserted after the elements with the same key.
+    ///
+    /// @param value the element, or a pair convertible to it.
+    /// @return An iterator to the inserted element.
+    template<typename P>
+    iterator insert(P&& value) {
+        return (emplaceElement(value_type(std::forward<P>(value))));
+    }
+
+    /// @brief Inserts an element.
+    ///
+    /// @param value the element.
+    /// @return An iterator to the inserted element.
+    iterator insert(const value_type& value) {
+        return (emplaceElement(value_type(value)));
+    }
+
+    /// @brief Inserts a range of elements.
+    ///
+    /// @param first iterator to the first element.
+    /// @param last iterator past the last element.
+    template<typename InputIterator>
+    void insert(InputIterator first, InputIterator last) {
+        for (; first != last; ++first) {
+            emplaceElement(value_type(*first));
+        }
+    }
+
+    /// @brief Constructs an element in place.
+    ///
+    /// @param args arguments of the element constructor.
+    /// @return An iterator to the inserted element.
+    template<typename... Args>
+    iterator emplace(Args&&... args) {
+        return (emplaceElement(value_type(std::forward<Args>(args)...)));
+    }
+
+    /// @brief Removes an element.
+    ///
+    /// @param pos iterator to the element.
+    /// @return An iterator following the removed element.
+    iterator erase(const_iterator pos) {
+        return (data_.erase(pos));
+    }
+
+    /// @brief Removes a range of elements.
+    ///
+    /// @param first iterator to the first element.
+    /// @param last iterator past the last element.
+    /// @return An iterator following the removed elements.
+    iterator erase(const_iterator first, const_iterator last) {
+        return (data_.erase(first, last));
+    }
+
+    /// @brief Removes the elements with a key.
+    ///
+    /// @param key the key.
+    /// @return The number of removed elements.
+    size_type erase(const key_type& key) {
+        std::pair<iterator, iterator> range = equal_range(key);
+        size_type count = std::distance(range.first, range.second);
+        data_.erase(range.first, range.second);
+        return (count);
+    }
+
+    /// @brief Exchanges the contents with another container.
+    ///
+    /// @param other the other container.
+    void swap(FlatMultimap& other) {
+        data_.swap(other.data_);
+    }
+
+    /// @brief Returns the number of elements with a key.
+    ///
+    /// @param key the key.
+    size_type count(const key_type& key) const {
+        std::pair<const_iterator, const_iterator> range = equal_range(key);
+        return (std::distance(range.first, range.second));
+    }
+
+    /// @brief Finds the first element with a key.
+    ///
+    /// @param key the key.
+    /// @return An iterator to the element or @c end().
+    iterator find(const key_type& key) {
+        iterator it = lower_bound(key);
+        if ((it != data_.end()) && !compare_(key, it->first)) {
+            return (it);
+        }
+        return (data_.end());
+    }
+
+    /// @brief Finds the first element with a key.
+    ///
+    /// @param key the key.
+    /// @return An iterator to the element or @c end().
+    const_iterator find(const key_type& key) const {
+        const_iterator it = lower_bound(key);
+        if ((it != data_.end()) && !compare_(key, it->first)) {
+            return (it);
+        }
+        return (data_.end());
+    }
+
+    /// @brief Returns the range of the elements with a key.
+    ///
+    /// @param key the key.
+    std::pair<iterator, iterator> equal_range(const key_type& key) {
+        iterator first = lower_bound(key);
+        return (std::make_pair(first, upperBound(first, data_.end(), key)));
+    }
+
+    /// @brief Returns the range of the elements with a key.
+    ///
+    /// @param key the key.
+    std::pair<const_iterator, const_iterator>
+    equal_range(const key_type& key) const {
+        const_iterator first = lower_bound(key);
+        return (std::make_pair(first, upperBound(first, data_.end(), key)));
+    }
+
+    /// @brief Returns an iterator to the first element not before a key.
+    ///
+    /// @param key the key.
+    iterator lower_bound(const key_type& key) {
+        return (lowerBound(data_.begin(), data_.end(), key));
+    }
+
+    /// @brief Returns an iterator to the first element not before a key.
+    ///
+    /// @param key the key.
+    const_iterator lower_bound(const key_type& key) const {
+        return (lowerBound(data_.begin(), data_.end(), key));
+    }
+
+    /// @brief Returns an iterator to the first element after a key.
+    ///
+    /// @param key the key.
+    iterator upper_bound(const key_type& key) {
+        return (upperBound(data_.begin(), data_.end(), key));
+    }
+
+    /// @brief Returns an iterator to the first element after a key.
+    ///
+    /// @param key the key.
+    const_iterator upper_bound(const key_type& key) const {
+        return (upperBound(data_.begin(), data_.end(), key));
+    }
+
+    /// @brief Compares two containers.
+    ///
+    /// @param other the other container.
+    /// @return true if both have the same elements in the same order.
+    bool operator==(const FlatMultimap& other) const {
+        return (data_ == other.data_);
+    }
+
+    /// @brief Compares two containers.
+    ///
+    /// @param other the other container.
+    /// @return true if the containers differ.
+    bool operator!=(const FlatMultimap& other) const {
+        return (data_ != other.data_);
+    }
+
+private:
+
+    /// @brief Inserts an element after the elements with the same key.
+    ///
+    /// @param value the element.
+    /// @return An iterator to the inserted element.
+    iterator emplaceElement(value_type&& value) {
+        if (data_.capacity() == 0) {
+            data_.reserve(INITIAL_CAPACITY);
+        }
+        // Elements are usually inserted in order, e.g. when a packet
+        // is unpacked: append them without searching.
+        if (data_.empty() || !compare_(value.first, data_.back().first)) {
+            data_.push_back(std::move(value));
+            return (data_.end() - 1);
+        }
+        iterator pos = upper_bound(value.first);
+        return (data_.insert(pos, std::move(value)));
+    }
+
+    /// @brief Returns the first element of a range not before a key.
+    ///
+    /// The collections are small: short ranges are searched linearly,
+    /// longer ranges are first narrowed by a binary search.
+    ///
+    /// @param first iterator to the first element of the range.
+    /// @param last iterator past the last element of the range.
+    /// @param key the key.
+    template<typename Iterator>
+    Iterator lowerBound(Iterator first, Iterator last,
+                        const key_type& key) const {
+        difference_type count = last - first;
+        while (count > LINEAR_SEARCH_SIZE) {
+            difference_type half = count / 2;
+            first = compare_(first[half].first, key) ? first + half : first;
+            count -= half;
+        }
+        last = first + count;
+        while ((first != last) && compare_(first->first, key)) {
+            ++first;
+        }
+        return (first);
+    }
+
+    /// @brief Returns the first element of a range after a key.
+    ///
+    /// @param first iterator to the first element of the range.
+    /// @param last iterator past the last element of the range.
+    /// @param key the key.
+    template<typename Iterator>
+    Iterator upperBound(Iterator first, Iterator last,
+                        const key_type& key) const {
+        difference_type count = last - first;
+        while (count > LINEAR_SEARCH_SIZE) {
+            difference_type half = count / 2;
+            first = !compare_(key, first[half].first) ? first + half : first;
+            count -= half;
+        }
+        last = first + count;
+        while ((first != last) && !compare_(key, first->first)) {
+            ++first;
+        }
+        return (first);
+    }
+
+    /// @brief Size of the ranges searched linearly.
+    static const difference_type LINEAR_SEARCH_SIZE = 16;
+
+    /// @brief The elements, sorted by key.
+    Storage data_;
+
+    /// @brief The key comparison function.
+    Compare compare_;
+};
+
+template<typename Key, typename T, typename Compare, typename Allocator>
+const typename FlatMultimap<Key, T, Compare, Allocator>::size_type
+FlatMultimap<Key, T, Compare, Allocator>::INITIAL_CAPACITY;
+
+template<typename Key, typename T, typename Compare, typename Allocator>
+const typename FlatMultimap<Key, T, Compare, Allocator>::difference_type
+FlatMultimap<Key, T, Compare, Allocator>::LINEAR_SEARCH_SIZE;
+
+} // namespace util
+} // namespace isc
+
+#endif // FLAT_MULTIMAP_H
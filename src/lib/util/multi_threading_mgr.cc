@@ -12,7 +12,8 @@ namespace isc {
 namespace util {
 
 MultiThreadingMgr::MultiThreadingMgr()
-    : enabled_(false), critical_section_count_(0), thread_pool_size_(0) {
+    : enabled_(false), critical_section_count_(0), thread_pool_size_(0),
+      client_affinity_(false) {
 }
 
 MultiThreadingMgr::~MultiThreadingMgr() {
@@ -79,6 +80,16 @@ MultiThreadingMgr::setPacketQueueSize(uint32_t size) {
     thread_pool_.setMaxQueueSize(size);
 }
 
+bool
+MultiThreadingMgr::getClientAffinity() const {
+    return (client_affinity_);
+}
+
+void
+MultiThreadingMgr::setClientAffinity(bool affinity) {
+    client_affinity_ = affinity;
+}
+
 uint32_t
 MultiThreadingMgr::detectThreadCount() {
     return (std::thread::hardware_concurrency());
@@ -107,6 +118,7 @@ MultiThreadingMgr::apply(bool enabled, uint32_t thread_count, uint32_t queue_siz
         setPacketQueueSize(queue_size);
         setMode(true);
         if (!isInCriticalSection()) {
+            thread_pool_.setAffinity(client_affinity_);
             thread_pool_.start(thread_count);
         }
     } else {
@@ -117,9 +129,44 @@ MultiThreadingMgr::apply(bool enabled, uint32_t thread_count, uint32_t queue_siz
     }
 }
 
+void
+MultiThreadingMgr::addCriticalSectionCallbacks(const std::string& name,
+                                               const std::function<void()>& entry_cb,
+                                               const std::function<void()>& exit_cb) {
+    if (name.empty()) {
+        isc_throw(BadValue, "critical section callbacks name must not be empty");
+    }
+    for (auto const& cbs : cs_callbacks_) {
+        if (cbs.name_ == name) {
+            isc_throw(BadValue, "critical section callbacks '" << name
+                      << "' already exist");
+        }
+    }
+    CSCallbacks cbs;
+    cbs.name_ = name;
+    cbs.entry_cb_ = entry_cb;
+    cbs.exit_cb_ = exit_cb;
+    cs_callbacks_.push_back(cbs);
+}
+
+void
+MultiThreadingMgr::removeCriticalSectionCallbacks(const std::string& name) {
+    for (auto it = cs_callbacks_.begin(); it != cs_callbacks_.end(); ++it) {
+        if (it->name_ == name) {
+            cs_callbacks_.erase(it);
+            return;
+        }
+    }
+}
+
 void
 MultiThreadingMgr::stopPktProcessing() {
     if (getMode() && getThreadPoolSize() && !isInCriticalSection()) {
+        for (auto const& cbs : cs_callbacks_) {
+            if (cbs.entry_cb_) {
+                cbs.entry_cb_();
+            }
+        }
         thread_pool_.stop();
     }
 }
@@ -127,7 +174,13 @@ MultiThreadingMgr::stopPktProcessing() {
 void
 MultiThreadingMgr::startPktProcessing() {
     if (getMode() && getThreadPoolSize() && !isInCriticalSection()) {
+        thread_pool_.setAffinity(client_affinity_);
         thread_pool_.start(getThreadPoolSize());
+        for (auto const& cbs : cs_callbacks_) {
+            if (cbs.exit_cb_) {
+                cbs.exit_cb_();
+            }
+        }
     }
 }
 
@@ -11,7 +11,10 @@
 
 #include <boost/noncopyable.hpp>
 
+#include <functional>
+#include <list>
 #include <stdint.h>
+#include <string>
 
 namespace isc {
 namespace util {
@@ -112,6 +115,20 @@ public:
     /// @param size The dhcp packet queue size.
     void setPacketQueueSize(uint32_t size);
 
+    /// @brief Get the configured client affinity.
+    ///
+    /// @return true if the queries of a client are always processed by the
+    /// same thread of the dhcp thread pool, false otherwise.
+    bool getClientAffinity() const;
+
+    /// @brief Set the configured client affinity.
+    ///
+    /// It takes effect when the dhcp thread pool is (re)started, e.g. by
+    /// @ref apply.
+    ///
+    /// @param affinity The client affinity flag.
+    void setClientAffinity(bool affinity);
+
     /// @brief The system current detected hardware concurrency thread count.
     ///
     /// This function will return 0 if the value can not be determined.
@@ -129,6 +146,30 @@ public:
     /// configured, 0 for unlimited size
     void apply(bool enabled, uint32_t thread_count, uint32_t queue_size);
 
+    /// @brief Adds a pair of critical section callbacks.
+    ///
+    /// The entry callback is invoked when packet processing is stopped,
+    /// i.e. when entering the outermost critical section, before the dhcp
+    /// thread pool is stopped. The exit callback is invoked when packet
+    /// processing is started again, after the dhcp thread pool is started.
+    /// This allows packet processing threads which are not part of the
+    /// thread pool to follow the same life cycle.
+    ///
+    /// @param name Name of the callbacks, used to remove them.
+    /// @param entry_cb The callback invoked when entering a critical section.
+    /// @param exit_cb The callback invoked when exiting a critical section.
+    /// @throw BadValue if the name is empty or already used.
+    void addCriticalSectionCallbacks(const std::string& name,
+                                     const std::function<void()>& entry_cb,
+                                     const std::function<void()>& exit_cb);
+
+    /// @brief Removes a pair of critical section callbacks.
+    ///
+    /// Removing callbacks which were not added has no effect.
+    ///
+    /// @param name Name of the callbacks.
+    void removeCriticalSectionCallbacks(const std::string& name);
+
 protected:
 
     /// @brief Constructor.
@@ -166,8 +207,26 @@ private:
     /// @brief The configured size of the dhcp thread pool.
     uint32_t thread_pool_size_;
 
+    /// @brief The configured client affinity of the dhcp thread pool.
+    bool client_affinity_;
+
     /// @brief Packet processing thread pool.
     ThreadPool<std::function<void()>> thread_pool_;
+
+    /// @brief Critical section callbacks.
+    struct CSCallbacks {
+        /// @brief Name of the callbacks.
+        std::string name_;
+
+        /// @brief The callback invoked when entering a critical section.
+        std::function<void()> entry_cb_;
+
+        /// @brief The callback invoked when exiting a critical section.
+        std::function<void()> exit_cb_;
+    };
+
+    /// @brief The list of critical section callbacks.
+    std::list<CSCallbacks> cs_callbacks_;
 };
 
 /// @note: everything here MUST be used ONLY from the main thread.
@@ -487,6 +487,64 @@ TEST_F(CSVFileTest, recreate) {
               readFile());
 }
 
+// This test checks that the rows appended to the file are flushed in
+// groups of the configured number of rows.
+TEST_F(CSVFileTest, flushRows) {
+    boost::scoped_ptr<CSVFile> csv(new CSVFile(testfile_));
+    csv->addColumn("animal");
+    csv->addColumn("age");
+    ASSERT_NO_THROW(csv->recreate());
+    EXPECT_EQ(1, csv->getFlushRows());
+    csv->setFlushRows(2);
+    EXPECT_EQ(2, csv->getFlushRows());
+
+    CSVRow row(2);
+    row.writeAt(0, "dog");
+    row.writeAt(1, 3);
+    ASSERT_NO_THROW(csv->append(row));
+    EXPECT_EQ(1, csv->getPendingRows());
+    EXPECT_EQ("animal,age\n", readFile());
+
+    row.writeAt(0, "cat");
+    row.writeAt(1, 2);
+    ASSERT_NO_THROW(csv->append(row));
+    EXPECT_EQ(0, csv->getPendingRows());
+    EXPECT_EQ("animal,age\n"
+              "dog,3\n"
+              "cat,2\n",
+              readFile());
+
+    // With 0 the rows are written when the file is flushed.
+    csv->setFlushRows(0);
+    row.writeAt(0, "lion");
+    row.writeAt(1, 15);
+    ASSERT_NO_THROW(csv->append(row));
+    ASSERT_NO_THROW(csv->append(row));
+    EXPECT_EQ(2, csv->getPendingRows());
+    ASSERT_NO_THROW(csv->flush());
+    EXPECT_EQ(0, csv->getPendingRows());
+    EXPECT_EQ("animal,age\n"
+              "dog,3\n"
+              "cat,2\n"
+              "lion,15\n"
+              "lion,15\n",
+              readFile());
+
+    // Closing the file writes the pending rows.
+    row.writeAt(0, "tiger");
+    row.writeAt(1, 4);
+    ASSERT_NO_THROW(csv->append(row));
+    csv->close();
+    EXPECT_EQ(0, csv->getPendingRows());
+    EXPECT_EQ("animal,age\n"
+              "dog,3\n"
+              "cat,2\n"
+              "lion,15\n"
+              "lion,15\n"
+              "tiger,4\n",
+              readFile());
+}
+
 // This test checks that the error is reported when the size of the row being
 // read doesn't match the number of columns of the CSV file.
 TEST_F(CSVFileTest, validate) {
@@ -0,0 +1,226 @@
+// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+#include <exceptions/exceptions.h>
+#include <util/fd_event_handler.h>
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+using namespace isc;
+using namespace isc::util;
+
+namespace {
+
+/// @brief Test fixture for the file descriptor event handlers.
+///
+/// It provides two pipes whose read ends are watched by the handlers.
+class FDEventHandlerTest : public ::testing::Test {
+public:
+    /// @brief Constructor.
+    ///
+    /// Opens the pipes.
+    FDEventHandlerTest() {
+        pipe1_[0] = pipe1_[1] = -1;
+        pipe2_[0] = pipe2_[1] = -1;
+        if ((pipe(pipe1_) < 0) || (pipe(pipe2_) < 0)) {
+            ADD_FAILURE() << "failed to open pipes";
+        }
+    }
+
+    /// @brief Destructor.
+    ///
+    /// Closes the pipes.
+    virtual ~FDEventHandlerTest() {
+        for (int fd : { pipe1_[0], pipe1_[1], pipe2_[0], pipe2_[1] }) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+
+    /// @brief Writes a byte to the write end of a pipe.
+    ///
+    /// @param pipe_fds The pipe.
+    void markReady(int pipe_fds[2]) {
+        char c = 'x';
+        ASSERT_EQ(1, write(pipe_fds[1], &c, 1));
+    }
+
+    /// @brief Reads a byte from the read end of a pipe.
+    ///
+    /// @param pipe_fds The pipe.
+    void clearReady(int pipe_fds[2]) {
+        char c;
+        ASSERT_EQ(1, read(pipe_fds[0], &c, 1));
+    }
+
+    /// @brief Checks that the interest set is kept between waits and
+    /// that ready file descriptors are reported.
+    ///
+    /// @param type The handler type.
+    void testWaitEvent(FDEventHandler::HandlerType type) {
+        handler_ = FDEventHandlerFactory::factoryFDEventHandler(type);
+        ASSERT_TRUE(handler_);
+        EXPECT_EQ(type, handler_->type());
+
+        ASSERT_NO_THROW(handler_->add(pipe1_[0]));
+        ASSERT_NO_THROW(handler_->add(pipe2_[0]));
+        // Adding twice has no effect.
+        ASSERT_NO_THROW(handler_->add(pipe2_[0]));
+        EXPECT_EQ(2, handler_->size());
+
+        // Nothing is ready so the wait times out.
+        EXPECT_EQ(0, handler_->waitEvent(0, 1000));
+        EXPECT_FALSE(handler_->readReady(pipe1_[0]));
+        EXPECT_TRUE(handler_->readyFds().empty());
+
+        // Make the first pipe ready.
+        markReady(pipe1_);
+        EXPECT_EQ(1, handler_->waitEvent(1));
+        EXPECT_TRUE(handler_->readReady(pipe1_[0]));
+        EXPECT_FALSE(handler_->readReady(pipe2_[0]));
+        ASSERT_EQ(1, handler_->readyFds().size());
+        EXPECT_EQ(pipe1_[0], handler_->readyFds()[0]);
+
+        // It stays ready until the data is read.
+        EXPECT_EQ(1, handler_->waitEvent(1));
+        EXPECT_TRUE(handler_->readReady(pipe1_[0]));
+
+        // Make both pipes ready.
+        markReady(pipe2_);
+        EXPECT_EQ(2, handler_->waitEvent(1));
+        EXPECT_TRUE(handler_->readReady(pipe1_[0]));
+        EXPECT_TRUE(handler_->readReady(pipe2_[0]));
+        EXPECT_EQ(2, handler_->readyFds().size());
+
+        // Read the first pipe.
+        clearReady(pipe1_);
+        EXPECT_EQ(1, handler_->waitEvent(1));
+        EXPECT_FALSE(handler_->readReady(pipe1_[0]));
+        EXPECT_TRUE(handler_->readReady(pipe2_[0]));
+
+        // Waiting without timeout returns as the second pipe is ready.
+        EXPECT_EQ(1, handler_->waitEvent(0, 0, false));
+        EXPECT_TRUE(handler_->readReady(pipe2_[0]));
+
+        // Invalid fractional timeout.
+        EXPECT_THROW(handler_->waitEvent(0, 1000000), BadValue);
+    }
+
+    /// @brief Checks that file descriptors can be removed from the
+    /// interest set.
+    ///
+    /// @param type The handler type.
+    void testDel(FDEventHandler::HandlerType type) {
+        handler_ = FDEventHandlerFactory::factoryFDEventHandler(type);
+        ASSERT_TRUE(handler_);
+
+        ASSERT_NO_THROW(handler_->add(pipe1_[0]));
+        ASSERT_NO_THROW(handler_->add(pipe2_[0]));
+        markReady(pipe1_);
+        markReady(pipe2_);
+
+        // Removed descriptors are no longer reported.
+        handler_->del(pipe1_[0]);
+        EXPECT_EQ(1, handler_->size());
+        EXPECT_EQ(1, handler_->waitEvent(1));
+        EXPECT_FALSE(handler_->readReady(pipe1_[0]));
+        EXPECT_TRUE(handler_->readReady(pipe2_[0]));
+
+        // Removing an unknown descriptor has no effect.
+        EXPECT_NO_THROW(handler_->del(pipe1_[0]));
+
+        // Clearing the set removes everything.
+        handler_->clear();
+        EXPECT_EQ(0, handler_->size());
+        EXPECT_FALSE(handler_->readReady(pipe2_[0]));
+        EXPECT_EQ(0, handler_->waitEvent(0, 1000));
+
+        // Descriptors can be added again.
+        ASSERT_NO_THROW(handler_->add(pipe1_[0]));
+        EXPECT_EQ(1, handler_->waitEvent(1));
+        EXPECT_TRUE(handler_->readReady(pipe1_[0]));
+    }
+
+    /// @brief Checks that invalid file descriptors are rejected.
+    ///
+    /// @param type The handler type.
+    void testBadFd(FDEventHandler::HandlerType type) {
+        handler_ = FDEventHandlerFactory::factoryFDEventHandler(type);
+        ASSERT_TRUE(handler_);
+        EXPECT_THROW(handler_->add(-1), BadValue);
+        if (type == FDEventHandler::TYPE_SELECT) {
+            EXPECT_THROW(handler_->add(FD_SETSIZE), BadValue);
+        }
+    }
+
+    /// @brief First pipe.
+    int pipe1_[2];
+
+    /// @brief Second pipe.
+    int pipe2_[2];
+
+    /// @brief The handler under test.
+    FDEventHandlerPtr handler_;
+};
+
+// Verifies the conversions between handler types and names.
+TEST(FDEventHandlerTypeTest, typeText) {
+    EXPECT_EQ("select", FDEventHandler::typeToText(FDEventHandler::TYPE_SELECT));
+    EXPECT_EQ("epoll", FDEventHandler::typeToText(FDEventHandler::TYPE_EPOLL));
+    EXPECT_EQ(FDEventHandler::TYPE_SELECT, FDEventHandler::typeFromText("select"));
+    EXPECT_EQ(FDEventHandler::TYPE_EPOLL, FDEventHandler::typeFromText("epoll"));
+    EXPECT_THROW(FDEventHandler::typeFromText("poll"), BadValue);
+    EXPECT_TRUE(FDEventHandler::isSupported(FDEventHandler::TYPE_SELECT));
+}
+
+// Verifies that the select() handler reports ready file descriptors.
+TEST_F(FDEventHandlerTest, selectWaitEvent) {
+    testWaitEvent(FDEventHandler::TYPE_SELECT);
+}
+
+// Verifies that file descriptors can be removed from the select() handler.
+TEST_F(FDEventHandlerTest, selectDel) {
+    testDel(FDEventHandler::TYPE_SELECT);
+}
+
+// Verifies that the select() handler rejects invalid file descriptors.
+TEST_F(FDEventHandlerTest, selectBadFd) {
+    testBadFd(FDEventHandler::TYPE_SELECT);
+}
+
+#if defined (OS_LINUX)
+
+// Verifies that the epoll() handler reports ready file descriptors.
+TEST_F(FDEventHandlerTest, epollWaitEvent) {
+    testWaitEvent(FDEventHandler::TYPE_EPOLL);
+}
+
+// Verifies that file descriptors can be removed from the epoll() handler.
+TEST_F(FDEventHandlerTest, epollDel) {
+    testDel(FDEventHandler::TYPE_EPOLL);
+}
+
+// Verifies that the epoll() handler rejects invalid file descriptors.
+TEST_F(FDEventHandlerTest, epollBadFd) {
+    testBadFd(FDEventHandler::TYPE_EPOLL);
+}
+
+#else
+
+// Verifies that the epoll() handler is reported as not supported.
+TEST_F(FDEventHandlerTest, epollNotSupported) {
+    EXPECT_FALSE(FDEventHandler::isSupported(FDEventHandler::TYPE_EPOLL));
+    EXPECT_THROW(FDEventHandlerFactory::factoryFDEventHandler(FDEventHandler::TYPE_EPOLL),
+                 NotImplemented);
+}
+
+#endif
+
+}
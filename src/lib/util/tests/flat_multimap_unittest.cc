@@ -0,0 +1,147 @@
+// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+#include <util/flat_multimap.h>
+#include <util/thread_cache.h>
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+
+using namespace isc::util;
+
+namespace {
+
+/// @brief Type of the tested container.
+typedef FlatMultimap<unsigned int, std::string> Map;
+
+/// @brief Verifies that the container has the contents of a multimap.
+///
+/// @param expected the multimap.
+/// @param map the container.
+void
+checkContents(const std::multimap<unsigned int, std::string>& expected,
+              const Map& map) {
+    ASSERT_EQ(expected.size(), map.size());
+    auto it = map.begin();
+    for (auto const& value : expected) {
+        EXPECT_EQ(value.first, it->first);
+        EXPECT_EQ(value.second, it->second);
+        ++it;
+    }
+}
+
+/// @brief Verifies that elements are ordered as in a multimap.
+TEST(FlatMultimapTest, insert) {
+    std::multimap<unsigned int, std::string> expected;
+    Map map;
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(0, map.capacity());
+
+    // Keys out of order and duplicates.
+    const unsigned int keys[] = { 5, 1, 5, 3, 1, 9, 5, 0, 3 };
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); ++i) {
+        std::string value = std::to_string(i);
+        Map::iterator it = map.insert(std::make_pair(keys[i], value));
+        EXPECT_EQ(keys[i], it->first);
+        EXPECT_EQ(value, it->second);
+        expected.insert(std::make_pair(keys[i], value));
+    }
+    EXPECT_FALSE(map.empty());
+    EXPECT_LE(Map::INITIAL_CAPACITY, map.capacity());
+    checkContents(expected, map);
+
+    // Conversions from other pair types.
+    map.insert(std::pair<int, const char*>(2, "two"));
+    expected.insert(std::make_pair(2, "two"));
+    map.emplace(4, "four");
+    expected.insert(std::make_pair(4, "four"));
+    checkContents(expected, map);
+
+    // Copies.
+    Map copy(map.begin(), map.end());
+    EXPECT_TRUE(copy == map);
+    copy.insert(std::make_pair(2, "deux"));
+    EXPECT_TRUE(copy != map);
+    Map list = { { 1, "a" }, { 0, "b" } };
+    ASSERT_EQ(2, list.size());
+    EXPECT_EQ("b", list.begin()->second);
+}
+
+/// @brief Verifies the lookups.
+TEST(FlatMultimapTest, lookup) {
+    Map map;
+    // Enough elements to use the binary search.
+    for (unsigned int i = 0; i < 40; ++i) {
+        map.insert(std::make_pair(i / 2 * 2, std::to_string(i)));
+    }
+
+    for (unsigned int key = 0; key < 42; ++key) {
+        SCOPED_TRACE(key);
+        Map::iterator it = map.find(key);
+        std::pair<Map::iterator, Map::iterator> range = map.equal_range(key);
+        if ((key % 2) || (key >= 40)) {
+            EXPECT_TRUE(it == map.end());
+            EXPECT_TRUE(range.first == range.second);
+            EXPECT_EQ(0, map.count(key));
+            continue;
+        }
+        // find returns the first element with the key.
+        ASSERT_TRUE(it != map.end());
+        EXPECT_EQ(std::to_string(key), it->second);
+        EXPECT_TRUE(range.first == it);
+        EXPECT_EQ(2, std::distance(range.first, range.second));
+        EXPECT_EQ(2, map.count(key));
+        EXPECT_TRUE(map.lower_bound(key) == range.first);
+        EXPECT_TRUE(map.upper_bound(key) == range.second);
+
+        const Map& const_map = map;
+        Map::const_iterator cit = const_map.find(key);
+        EXPECT_TRUE(cit == it);
+    }
+}
+
+/// @brief Verifies the erasures.
+TEST(FlatMultimapTest, erase) {
+    Map map = { { 1, "a" }, { 2, "b" }, { 2, "c" }, { 3, "d" } };
+
+    EXPECT_EQ(2, map.erase(2));
+    EXPECT_EQ(0, map.erase(2));
+    ASSERT_EQ(2, map.size());
+
+    Map::iterator it = map.erase(map.find(1));
+    ASSERT_TRUE(it != map.end());
+    EXPECT_EQ(3, it->first);
+    ASSERT_EQ(1, map.size());
+
+    map.erase(map.begin(), map.end());
+    EXPECT_TRUE(map.empty());
+
+    map.insert(std::make_pair(7, "e"));
+    map.clear();
+    EXPECT_TRUE(map.empty());
+}
+
+/// @brief Verifies the container with the thread cache allocator.
+TEST(FlatMultimapTest, threadCacheAllocator) {
+    ThreadBlockCache::clear();
+    typedef FlatMultimap<unsigned int, int, std::less<unsigned int>,
+        ThreadCacheAllocator<std::pair<unsigned int, int> > > CachedMap;
+    {
+        CachedMap map;
+        for (int i = 0; i < 4; ++i) {
+            map.insert(std::make_pair(4 - i, i));
+        }
+        EXPECT_EQ(1, map.begin()->first);
+    }
+    // All elements were in a single block.
+    EXPECT_EQ(1, ThreadBlockCache::getCachedBlocks());
+    ThreadBlockCache::clear();
+}
+
+} // end of anonymous namespace
@@ -123,6 +123,35 @@ TEST(MultiThreadingMgrTest, applyConfig) {
     EXPECT_EQ(thread_pool.size(), 0);
 }
 
+/// @brief Verifies that the client affinity is applied to the thread pool.
+TEST(MultiThreadingMgrTest, clientAffinity) {
+    // get the thread pool
+    auto& thread_pool = MultiThreadingMgr::instance().getThreadPool();
+    // default client affinity is false
+    EXPECT_FALSE(MultiThreadingMgr::instance().getClientAffinity());
+    // enable the client affinity
+    EXPECT_NO_THROW(MultiThreadingMgr::instance().setClientAffinity(true));
+    EXPECT_TRUE(MultiThreadingMgr::instance().getClientAffinity());
+    // enable MT with 4 threads
+    EXPECT_NO_THROW(MultiThreadingMgr::instance().apply(true, 4, 0));
+    // the thread pool should be started with a queue per thread
+    EXPECT_EQ(thread_pool.size(), 4);
+    EXPECT_TRUE(thread_pool.getAffinity());
+    EXPECT_EQ(thread_pool.getAffinityCounts().size(), 4);
+    // the client affinity is applied when the pool is restarted
+    EXPECT_NO_THROW(MultiThreadingMgr::instance().setClientAffinity(false));
+    {
+        MultiThreadingCriticalSection cs;
+        EXPECT_EQ(thread_pool.size(), 0);
+    }
+    EXPECT_EQ(thread_pool.size(), 4);
+    EXPECT_FALSE(thread_pool.getAffinity());
+    EXPECT_TRUE(thread_pool.getAffinityCounts().empty());
+    // disable MT
+    EXPECT_NO_THROW(MultiThreadingMgr::instance().apply(false, 0, 0));
+    EXPECT_EQ(thread_pool.size(), 0);
+}
+
 /// @brief Verifies that the critical section flag works.
 TEST(MultiThreadingMgrTest, criticalSectionFlag) {
     // get the thread pool
@@ -322,3 +351,66 @@ TEST(MultiThreadingMgrTest, criticalSection) {
     // apply multi-threading configuration with 0 threads
     MultiThreadingMgr::instance().apply(false, 0, 0);
 }
+
+/// @brief Verifies that the critical section callbacks are invoked.
+TEST(MultiThreadingMgrTest, criticalSectionCallbacks) {
+    // get the thread pool instance
+    auto& thread_pool = MultiThreadingMgr::instance().getThreadPool();
+    // the number of entry and exit callback invocations
+    size_t entries = 0;
+    size_t exits = 0;
+    // the thread pool size seen by the callbacks
+    size_t entry_size = 0;
+    size_t exit_size = 0;
+    auto entry_cb = [&]() { ++entries; entry_size = thread_pool.size(); };
+    auto exit_cb = [&]() { ++exits; exit_size = thread_pool.size(); };
+    // empty name is rejected
+    EXPECT_THROW(MultiThreadingMgr::instance().addCriticalSectionCallbacks("",
+                                                                           entry_cb,
+                                                                           exit_cb),
+                 BadValue);
+    // add the callbacks
+    EXPECT_NO_THROW(MultiThreadingMgr::instance().addCriticalSectionCallbacks("test",
+                                                                              entry_cb,
+                                                                              exit_cb));
+    // duplicate name is rejected
+    EXPECT_THROW(MultiThreadingMgr::instance().addCriticalSectionCallbacks("test",
+                                                                           entry_cb,
+                                                                           exit_cb),
+                 BadValue);
+    // callbacks are not invoked when MT is disabled
+    {
+        MultiThreadingCriticalSection cs;
+    }
+    EXPECT_EQ(0, entries);
+    EXPECT_EQ(0, exits);
+    // apply multi-threading configuration with 16 threads
+    MultiThreadingMgr::instance().apply(true, 16, 256);
+    // use scope to test constructor and destructor
+    {
+        MultiThreadingCriticalSection cs;
+        // entry callback is invoked before the thread pool is stopped
+        EXPECT_EQ(1, entries);
+        EXPECT_EQ(16, entry_size);
+        EXPECT_EQ(0, exits);
+        {
+            // inner critical section does not invoke the callbacks
+            MultiThreadingCriticalSection inner_cs;
+            EXPECT_EQ(1, entries);
+        }
+        EXPECT_EQ(0, exits);
+    }
+    // exit callback is invoked after the thread pool is started
+    EXPECT_EQ(1, exits);
+    EXPECT_EQ(16, exit_size);
+    // removed callbacks are no longer invoked
+    MultiThreadingMgr::instance().removeCriticalSectionCallbacks("test");
+    EXPECT_NO_THROW(MultiThreadingMgr::instance().removeCriticalSectionCallbacks("test"));
+    {
+        MultiThreadingCriticalSection cs;
+    }
+    EXPECT_EQ(1, entries);
+    EXPECT_EQ(1, exits);
+    // apply multi-threading configuration with 0 threads
+    MultiThreadingMgr::instance().apply(false, 0, 0);
+}
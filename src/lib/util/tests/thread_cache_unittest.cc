@@ -0,0 +1,207 @@
+// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+#include <util/thread_cache.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <map>
+#include <set>
+#include <thread>
+
+using namespace isc::util;
+
+namespace {
+
+/// @brief Verifies that freed blocks are reused by the same thread.
+TEST(ThreadBlockCacheTest, reuse) {
+    ThreadBlockCache::clear();
+    EXPECT_EQ(0, ThreadBlockCache::getCachedBlocks());
+
+    void* block = ThreadBlockCache::allocate(40);
+    ASSERT_TRUE(block);
+    ThreadBlockCache::deallocate(block, 40);
+    EXPECT_EQ(1, ThreadBlockCache::getCachedBlocks());
+
+    // A block of the same size class is the cached block.
+    void* other = ThreadBlockCache::allocate(48);
+    EXPECT_EQ(block, other);
+    EXPECT_EQ(0, ThreadBlockCache::getCachedBlocks());
+    ThreadBlockCache::deallocate(other, 48);
+
+    // Another size class is not served from it.
+    void* small = ThreadBlockCache::allocate(16);
+    EXPECT_NE(block, small);
+    ThreadBlockCache::deallocate(small, 16);
+    EXPECT_EQ(2, ThreadBlockCache::getCachedBlocks());
+
+    // Large blocks are not cached.
+    void* large = ThreadBlockCache::allocate(ThreadBlockCache::MAX_BLOCK_SIZE + 1);
+    ThreadBlockCache::deallocate(large, ThreadBlockCache::MAX_BLOCK_SIZE + 1);
+    EXPECT_EQ(2, ThreadBlockCache::getCachedBlocks());
+
+    ThreadBlockCache::clear();
+    EXPECT_EQ(0, ThreadBlockCache::getCachedBlocks());
+}
+
+/// @brief Verifies that the number of cached blocks is bounded.
+TEST(ThreadBlockCacheTest, bound) {
+    ThreadBlockCache::clear();
+    const size_t count = ThreadBlockCache::MAX_CACHED_BLOCKS + 10;
+    std::vector<void*> blocks;
+    for (size_t i = 0; i < count; ++i) {
+        blocks.push_back(ThreadBlockCache::allocate(64));
+    }
+    for (auto block : blocks) {
+        ThreadBlockCache::deallocate(block, 64);
+    }
+    EXPECT_EQ(ThreadBlockCache::MAX_CACHED_BLOCKS,
+              ThreadBlockCache::getCachedBlocks());
+    ThreadBlockCache::clear();
+}
+
+/// @brief Verifies that blocks freed by another thread go back to the
+/// thread which allocated them.
+TEST(ThreadBlockCacheTest, otherThread) {
+    ThreadBlockCache::clear();
+    void* block = ThreadBlockCache::allocate(100);
+    size_t other_cached = 0;
+    std::thread thread([block, &other_cached]() {
+        ThreadBlockCache::deallocate(block, 100);
+        other_cached = ThreadBlockCache::getCachedBlocks();
+    });
+    thread.join();
+    EXPECT_EQ(0, other_cached);
+
+    // The block waits in the remote free list until it is needed.
+    EXPECT_EQ(0, ThreadBlockCache::getCachedBlocks());
+    void* other = ThreadBlockCache::allocate(100);
+    EXPECT_EQ(block, other);
+    ThreadBlockCache::deallocate(other, 100);
+    EXPECT_EQ(1, ThreadBlockCache::getCachedBlocks());
+    ThreadBlockCache::clear();
+}
+
+/// @brief Verifies that a thread allocating blocks freed by other
+/// threads reuses them, as the receiver thread does with the packets
+/// processed by the packet processing threads.
+TEST(ThreadBlockCacheTest, producerConsumer) {
+    ThreadBlockCache::clear();
+    const size_t count = 100;
+    std::vector<void*> blocks;
+    for (size_t i = 0; i < count; ++i) {
+        blocks.push_back(ThreadBlockCache::allocate(200));
+    }
+    std::thread thread([&blocks]() {
+        for (auto block : blocks) {
+            ThreadBlockCache::deallocate(block, 200);
+        }
+    });
+    thread.join();
+
+    // All the blocks are reused.
+    std::set<void*> freed(blocks.begin(), blocks.end());
+    for (size_t i = 0; i < count; ++i) {
+        void* block = ThreadBlockCache::allocate(200);
+        EXPECT_EQ(1, freed.count(block));
+        blocks[i] = block;
+    }
+    for (auto block : blocks) {
+        ThreadBlockCache::deallocate(block, 200);
+    }
+    ThreadBlockCache::clear();
+}
+
+/// @brief Verifies that blocks outlive the thread which allocated them.
+TEST(ThreadBlockCacheTest, exitedThread) {
+    void* block = 0;
+    std::thread thread([&block]() {
+        block = ThreadBlockCache::allocate(32);
+    });
+    thread.join();
+    ASSERT_TRUE(block);
+    memset(block, 0, 32);
+    ThreadBlockCache::deallocate(block, 32);
+}
+
+/// @brief Verifies the allocator with a node based container.
+TEST(ThreadBlockCacheTest, allocator) {
+    ThreadBlockCache::clear();
+    typedef std::multimap<unsigned int, int, std::less<unsigned int>,
+        ThreadCacheAllocator<std::pair<const unsigned int, int> > > Map;
+    {
+        Map map;
+        for (int i = 0; i < 10; ++i) {
+            map.insert(std::make_pair(i % 3, i));
+        }
+        EXPECT_EQ(10, map.size());
+        EXPECT_EQ(4, map.count(0));
+    }
+    EXPECT_EQ(10, ThreadBlockCache::getCachedBlocks());
+    ThreadBlockCache::clear();
+}
+
+/// @brief Verifies that buffers are reused.
+TEST(ThreadBufferCacheTest, reuse) {
+    ThreadBufferCache::clear();
+    const uint8_t data[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+
+    std::vector<uint8_t> buffer;
+    ThreadCaches* owner = ThreadBufferCache::assign(buffer, data, sizeof(data));
+    EXPECT_TRUE(owner);
+    EXPECT_EQ(std::vector<uint8_t>(data, data + sizeof(data)), buffer);
+    const uint8_t* storage = &buffer[0];
+
+    ThreadBufferCache::release(buffer, owner);
+    EXPECT_TRUE(buffer.empty());
+    EXPECT_EQ(1, ThreadBufferCache::getCachedBuffers());
+
+    // The storage is reused for the next buffer.
+    std::vector<uint8_t> other;
+    EXPECT_EQ(owner, ThreadBufferCache::assign(other, data, 4));
+    EXPECT_EQ(storage, &other[0]);
+    EXPECT_EQ(4, other.size());
+    EXPECT_EQ(0, ThreadBufferCache::getCachedBuffers());
+
+    // Empty buffers are not cached.
+    std::vector<uint8_t> empty;
+    ThreadBufferCache::release(empty, 0);
+    EXPECT_EQ(0, ThreadBufferCache::getCachedBuffers());
+
+    ThreadBufferCache::release(other, owner);
+    EXPECT_EQ(1, ThreadBufferCache::getCachedBuffers());
+    ThreadBufferCache::clear();
+    EXPECT_EQ(0, ThreadBufferCache::getCachedBuffers());
+}
+
+/// @brief Verifies that buffers released by another thread go back to
+/// the thread which filled them.
+TEST(ThreadBufferCacheTest, otherThread) {
+    ThreadBufferCache::clear();
+    const uint8_t data[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+
+    std::vector<uint8_t> buffer;
+    ThreadCaches* owner = ThreadBufferCache::assign(buffer, data, sizeof(data));
+    const uint8_t* storage = &buffer[0];
+    size_t other_cached = 0;
+    std::thread thread([&buffer, owner, &other_cached]() {
+        ThreadBufferCache::release(buffer, owner);
+        other_cached = ThreadBufferCache::getCachedBuffers();
+    });
+    thread.join();
+    EXPECT_TRUE(buffer.empty());
+    EXPECT_EQ(0, other_cached);
+
+    // The buffer is reused by the filling thread.
+    std::vector<uint8_t> other;
+    ThreadBufferCache::assign(other, data, sizeof(data));
+    EXPECT_EQ(storage, &other[0]);
+    ThreadBufferCache::clear();
+}
+
+} // end of anonymous namespace
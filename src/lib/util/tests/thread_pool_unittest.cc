@@ -1,4 +1,4 @@
-// Copyright (C) 2018-2020 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2018-2021 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -11,6 +11,9 @@
 #include <exceptions/exceptions.h>
 #include <util/thread_pool.h>
 
+#include <map>
+#include <vector>
+
 using namespace isc;
 using namespace isc::util;
 using namespace std;
@@ -638,6 +641,151 @@ TEST_F(ThreadPoolTest, addFront) {
     EXPECT_EQ(thread_pool.count(), items_count);
 }
 
+/// @brief test ThreadPool add batch.
+TEST_F(ThreadPoolTest, addBatch) {
+    CallBack call_back;
+    ThreadPool<CallBack> thread_pool;
+    // the item count should be 0
+    ASSERT_EQ(thread_pool.count(), 0);
+
+    call_back = std::bind(&ThreadPoolTest::run, this);
+
+    // add a batch of items to stopped thread pool
+    vector<boost::shared_ptr<CallBack>> items;
+    for (uint32_t i = 0; i < 8; ++i) {
+        items.push_back(boost::make_shared<CallBack>(call_back));
+    }
+    // null items are ignored
+    items.push_back(boost::shared_ptr<CallBack>());
+    bool ret = false;
+    EXPECT_NO_THROW(ret = thread_pool.add(items));
+    EXPECT_TRUE(ret);
+    EXPECT_EQ(thread_pool.count(), 8);
+
+    // adding a batch to a full queue should squeeze the queue
+    size_t max_queue_size = 10;
+    thread_pool.setMaxQueueSize(max_queue_size);
+    EXPECT_NO_THROW(ret = thread_pool.add(items));
+    EXPECT_FALSE(ret);
+    EXPECT_EQ(thread_pool.count(), max_queue_size);
+
+    // start the threads and check that all queued items are processed
+    reset(0);
+    EXPECT_NO_THROW(thread_pool.start(4));
+    EXPECT_NO_THROW(thread_pool.wait());
+    EXPECT_EQ(thread_pool.count(), 0);
+    EXPECT_EQ(count(), max_queue_size);
+    EXPECT_NO_THROW(thread_pool.stop());
+}
+
+/// @brief test ThreadPool with thread affinity.
+TEST_F(ThreadPoolTest, affinity) {
+    ThreadPool<CallBack> thread_pool;
+    EXPECT_FALSE(thread_pool.getAffinity());
+    EXPECT_NO_THROW(thread_pool.setAffinity(true));
+    EXPECT_TRUE(thread_pool.getAffinity());
+
+    // the thread affinity can't be changed while the pool runs
+    EXPECT_NO_THROW(thread_pool.start(4));
+    EXPECT_THROW(thread_pool.setAffinity(false), InvalidOperation);
+    EXPECT_EQ(thread_pool.getAffinityCounts().size(), 4);
+    EXPECT_EQ(thread_pool.getAffinityImbalance(), 1.);
+
+    // record the thread and the order in which the items of each key
+    // are processed
+    mutex history_mutex;
+    map<size_t, vector<pair<thread::id, uint32_t>>> history;
+    const size_t keys_count = 16;
+    const uint32_t items_per_key = 50;
+    for (uint32_t i = 0; i < items_per_key; ++i) {
+        for (size_t key = 0; key < keys_count; ++key) {
+            CallBack call_back = [&history_mutex, &history, key, i]() {
+                lock_guard<mutex> lk(history_mutex);
+                history[key].push_back(make_pair(this_thread::get_id(), i));
+            };
+            EXPECT_TRUE(thread_pool.add(boost::make_shared<CallBack>(call_back), key));
+        }
+    }
+    EXPECT_NO_THROW(thread_pool.wait());
+    EXPECT_EQ(thread_pool.count(), 0);
+
+    // all items of a key were processed in order by the same thread
+    ASSERT_EQ(history.size(), keys_count);
+    for (auto const& key : history) {
+        ASSERT_EQ(key.second.size(), items_per_key);
+        for (uint32_t i = 0; i < items_per_key; ++i) {
+            EXPECT_EQ(key.second[i].first, key.second[0].first);
+            EXPECT_EQ(key.second[i].second, i);
+        }
+    }
+
+    // the keys were evenly spread over the threads
+    vector<uint64_t> counts = thread_pool.getAffinityCounts();
+    ASSERT_EQ(counts.size(), 4);
+    for (auto count : counts) {
+        EXPECT_EQ(count, keys_count * items_per_key / 4);
+    }
+    EXPECT_EQ(thread_pool.getAffinityImbalance(), 1.);
+
+    // all items with the same key go to the same thread
+    for (uint32_t i = 0; i < 40; ++i) {
+        EXPECT_TRUE(thread_pool.add(boost::make_shared<CallBack>([]() {}), 3));
+    }
+    EXPECT_NO_THROW(thread_pool.wait());
+    counts = thread_pool.getAffinityCounts();
+    ASSERT_EQ(counts.size(), 4);
+    EXPECT_EQ(counts[3], keys_count * items_per_key / 4 + 40);
+    EXPECT_GT(thread_pool.getAffinityImbalance(), 1.);
+    EXPECT_NO_THROW(thread_pool.stop());
+}
+
+/// @brief test ThreadPool keeps the pending items when the thread affinity
+/// or the number of threads change.
+TEST_F(ThreadPoolTest, affinityPendingItems) {
+    CallBack call_back = std::bind(&ThreadPoolTest::run, this);
+    ThreadPool<CallBack> thread_pool;
+
+    // items added to the stopped pool without affinity are processed by the
+    // threads with affinity
+    for (uint32_t i = 0; i < 10; ++i) {
+        EXPECT_TRUE(thread_pool.add(boost::make_shared<CallBack>(call_back), i));
+    }
+    EXPECT_EQ(thread_pool.count(), 10);
+    EXPECT_TRUE(thread_pool.getAffinityCounts().empty());
+    thread_pool.setAffinity(true);
+    reset(0);
+    EXPECT_NO_THROW(thread_pool.start(2));
+    EXPECT_NO_THROW(thread_pool.wait());
+    EXPECT_EQ(count(), 10);
+    EXPECT_NO_THROW(thread_pool.stop());
+
+    // items added to the stopped pool are kept when the number of threads
+    // changes
+    for (uint32_t i = 0; i < 10; ++i) {
+        EXPECT_TRUE(thread_pool.add(boost::make_shared<CallBack>(call_back), i));
+    }
+    EXPECT_EQ(thread_pool.count(), 10);
+    reset(0);
+    EXPECT_NO_THROW(thread_pool.start(3));
+    EXPECT_EQ(thread_pool.getAffinityCounts().size(), 3);
+    EXPECT_TRUE(thread_pool.wait(10));
+    EXPECT_EQ(count(), 10);
+    EXPECT_NO_THROW(thread_pool.stop());
+
+    // and when the thread affinity is disabled
+    for (uint32_t i = 0; i < 10; ++i) {
+        EXPECT_TRUE(thread_pool.add(boost::make_shared<CallBack>(call_back)));
+    }
+    EXPECT_EQ(thread_pool.count(), 10);
+    thread_pool.setAffinity(false);
+    reset(0);
+    EXPECT_NO_THROW(thread_pool.start(2));
+    EXPECT_TRUE(thread_pool.getAffinityCounts().empty());
+    EXPECT_NO_THROW(thread_pool.wait());
+    EXPECT_EQ(count(), 10);
+    EXPECT_NO_THROW(thread_pool.stop());
+}
+
 /// @brief test ThreadPool get queue statistics.
 TEST_F(ThreadPoolTest, getQueueStat) {
     ThreadPool<CallBack> thread_pool;
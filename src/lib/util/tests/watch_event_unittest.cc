@@ -0,0 +1,102 @@
+// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+#include <util/watch_event.h>
+
+#include <gtest/gtest.h>
+
+#include <sys/select.h>
+
+#include <thread>
+#include <vector>
+
+using namespace isc;
+using namespace isc::util;
+
+namespace {
+
+/// @brief Returns the result of select() given an fd to check for read status.
+///
+/// @param fd_to_check The file descriptor to test
+///
+/// @return Returns less than one on an error, 0 if the fd is not ready to
+/// read, > 0 if it is ready to read.
+int selectCheck(int fd_to_check) {
+    fd_set read_fds;
+    FD_ZERO(&read_fds);
+    FD_SET(fd_to_check, &read_fds);
+
+    struct timeval select_timeout;
+    select_timeout.tv_sec = 0;
+    select_timeout.tv_usec = 0;
+
+    return (select(fd_to_check + 1, &read_fds, NULL, NULL, &select_timeout));
+}
+
+/// @brief Tests the basic functionality of WatchEvent.
+TEST(WatchEventTest, basics) {
+    WatchEventPtr watch;
+
+    ASSERT_NO_THROW(watch.reset(new WatchEvent()));
+    ASSERT_TRUE(watch);
+    int select_fd = watch->getSelectFd();
+    ASSERT_GE(select_fd, 0);
+
+    // Initially not ready.
+    EXPECT_FALSE(watch->isReady());
+    EXPECT_EQ(0, selectCheck(select_fd));
+
+    // Marking makes it ready.
+    ASSERT_NO_THROW(watch->markReady());
+    EXPECT_TRUE(watch->isReady());
+    EXPECT_EQ(1, selectCheck(select_fd));
+
+    // Marking again is coalesced: one clear is enough.
+    ASSERT_NO_THROW(watch->markReady());
+    ASSERT_NO_THROW(watch->markReady());
+    EXPECT_TRUE(watch->isReady());
+    ASSERT_NO_THROW(watch->clearReady());
+    EXPECT_FALSE(watch->isReady());
+    EXPECT_EQ(0, selectCheck(select_fd));
+
+    // Clearing a cleared event is harmless.
+    ASSERT_NO_THROW(watch->clearReady());
+    EXPECT_EQ(0, selectCheck(select_fd));
+
+    // It can be marked again.
+    ASSERT_NO_THROW(watch->markReady());
+    EXPECT_EQ(1, selectCheck(select_fd));
+    ASSERT_NO_THROW(watch->clearReady());
+    EXPECT_EQ(0, selectCheck(select_fd));
+}
+
+/// @brief Checks that concurrent marks wake up the consumer.
+TEST(WatchEventTest, concurrentMarks) {
+    WatchEvent watch;
+    int select_fd = watch.getSelectFd();
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.push_back(std::thread([&watch]() {
+            for (int j = 0; j < 1000; ++j) {
+                watch.markReady();
+            }
+        }));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // The marks are coalesced in a single readable state.
+    EXPECT_TRUE(watch.isReady());
+    EXPECT_EQ(1, selectCheck(select_fd));
+    watch.clearReady();
+    EXPECT_FALSE(watch.isReady());
+    EXPECT_EQ(0, selectCheck(select_fd));
+}
+
+}
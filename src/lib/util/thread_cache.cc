@@ -0,0 +1,432 @@
+// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <util/thread_cache.h>
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+namespace isc {
+namespace util {
+
+const size_t ThreadBlockCache::GRANULARITY;
+const size_t ThreadBlockCache::MAX_BLOCK_SIZE;
+const size_t ThreadBlockCache::MAX_CACHED_BLOCKS;
+const size_t ThreadBufferCache::MAX_BUFFER_CAPACITY;
+const size_t ThreadBufferCache::MAX_CACHED_BUFFERS;
+
+namespace {
+
+/// @brief Number of size classes of the block cache.
+const size_t SIZE_CLASSES =
+    ThreadBlockCache::MAX_BLOCK_SIZE / ThreadBlockCache::GRANULARITY;
+
+/// @brief Size of the header in front of each cached block.
+///
+/// It keeps the blocks aligned as the global allocator does.
+const size_t HEADER_SIZE = ThreadBlockCache::GRANULARITY;
+
+/// @brief Header of a block.
+struct BlockHeader {
+    /// @brief The caches of the thread which allocated the block, null
+    /// when the block is not cached.
+    ThreadCaches* owner_;
+
+    /// @brief The next block of the free list holding the block.
+    BlockHeader* next_;
+};
+
+static_assert(sizeof(BlockHeader) <= HEADER_SIZE,
+              "the block header does not fit in HEADER_SIZE");
+
+/// @brief Returns the size class of a block size.
+///
+/// @param size the block size, not 0 and not above MAX_BLOCK_SIZE.
+size_t
+sizeClass(size_t size) {
+    return ((size - 1) / ThreadBlockCache::GRANULARITY);
+}
+
+/// @brief Returns the header of a block.
+///
+/// @param ptr pointer to the block, as returned by allocate.
+BlockHeader*
+getHeader(void* ptr) {
+    return (reinterpret_cast<BlockHeader*>(static_cast<char*>(ptr) -
+                                           HEADER_SIZE));
+}
+
+/// @brief Returns the block following a header.
+///
+/// @param header the block header.
+void*
+getBlock(BlockHeader* header) {
+    return (reinterpret_cast<char*>(header) + HEADER_SIZE);
+}
+
+}
+
+/// @brief The caches of a thread.
+///
+/// The free lists are only used by the thread owning the caches, the
+/// remote lists by the other threads.
+class ThreadCaches {
+public:
+    /// @brief Constructor.
+    ThreadCaches() : buffers_(), remote_mutex_(), remote_buffers_() {
+        buffers_.reserve(ThreadBufferCache::MAX_CACHED_BUFFERS);
+        remote_buffers_.reserve(ThreadBufferCache::MAX_CACHED_BUFFERS);
+        memset(blocks_, 0, sizeof(blocks_));
+        memset(counts_, 0, sizeof(counts_));
+        for (size_t i = 0; i < SIZE_CLASSES; ++i) {
+            remote_blocks_[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /// @brief Takes a block from the free list of a size class.
+    ///
+    /// When the list is empty, the remote free list is taken first.
+    ///
+    /// @param index the size class.
+    /// @return The block header or null.
+    BlockHeader* popBlock(size_t index) {
+        if (!blocks_[index]) {
+            takeRemoteBlocks(index);
+        }
+        BlockHeader* block = blocks_[index];
+        if (block) {
+            blocks_[index] = block->next_;
+            --counts_[index];
+        }
+        return (block);
+    }
+
+    /// @brief Puts a block of the thread in the free list of its class.
+    ///
+    /// @param index the size class.
+    /// @param block the block header.
+    void pushBlock(size_t index, BlockHeader* block) {
+        if (counts_[index] >= ThreadBlockCache::MAX_CACHED_BLOCKS) {
+            ::operator delete(block);
+            return;
+        }
+        block->next_ = blocks_[index];
+        blocks_[index] = block;
+        ++counts_[index];
+    }
+
+    /// @brief Gives a block back from another thread.
+    ///
+    /// @param index the size class.
+    /// @param block the block header.
+    void pushRemoteBlock(size_t index, BlockHeader* block) {
+        BlockHeader* head = remote_blocks_[index].load(std::memory_order_relaxed);
+        do {
+            block->next_ = head;
+        } while (!remote_blocks_[index].compare_exchange_weak(head, block,
+                                                              std::memory_order_release,
+                                                              std::memory_order_relaxed));
+    }
+
+    /// @brief Moves the remote free list of a size class to its free list.
+    ///
+    /// The whole list is taken at once, so concurrent pushes are safe.
+    ///
+    /// @param index the size class.
+    void takeRemoteBlocks(size_t index) {
+        BlockHeader* block = remote_blocks_[index].exchange(0, std::memory_order_acquire);
+        while (block) {
+            BlockHeader* next = block->next_;
+            pushBlock(index, block);
+            block = next;
+        }
+    }
+
+    /// @brief Frees the cached blocks, including the remote ones.
+    void clearBlocks() {
+        for (size_t i = 0; i < SIZE_CLASSES; ++i) {
+            takeRemoteBlocks(i);
+            while (blocks_[i]) {
+                BlockHeader* block = blocks_[i];
+                blocks_[i] = block->next_;
+                ::operator delete(block);
+            }
+            counts_[i] = 0;
+        }
+    }
+
+    /// @brief Gives a buffer back from another thread.
+    ///
+    /// @param buffer the buffer, left empty.
+    void pushRemoteBuffer(std::vector<uint8_t>& buffer) {
+        std::lock_guard<std::mutex> lock(remote_mutex_);
+        if (remote_buffers_.size() < ThreadBufferCache::MAX_CACHED_BUFFERS) {
+            buffer.clear();
+            remote_buffers_.push_back(std::vector<uint8_t>());
+            remote_buffers_.back().swap(buffer);
+        }
+    }
+
+    /// @brief Moves the remote buffers to the cached buffers.
+    void takeRemoteBuffers() {
+        std::lock_guard<std::mutex> lock(remote_mutex_);
+        while (!remote_buffers_.empty() &&
+               (buffers_.size() < ThreadBufferCache::MAX_CACHED_BUFFERS)) {
+            buffers_.push_back(std::vector<uint8_t>());
+            buffers_.back().swap(remote_buffers_.back());
+            remote_buffers_.pop_back();
+        }
+    }
+
+    /// @brief Frees the cached buffers, including the remote ones.
+    void clearBuffers() {
+        buffers_.clear();
+        std::lock_guard<std::mutex> lock(remote_mutex_);
+        remote_buffers_.clear();
+    }
+
+    /// @brief Free lists of blocks, indexed by size class.
+    BlockHeader* blocks_[SIZE_CLASSES];
+
+    /// @brief Number of cached blocks, indexed by size class.
+    size_t counts_[SIZE_CLASSES];
+
+    /// @brief Blocks given back by other threads, indexed by size class.
+    std::atomic<BlockHeader*> remote_blocks_[SIZE_CLASSES];
+
+    /// @brief Cached buffers.
+    std::vector<std::vector<uint8_t> > buffers_;
+
+    /// @brief Mutex protecting the remote buffers.
+    std::mutex remote_mutex_;
+
+    /// @brief Buffers given back by other threads.
+    std::vector<std::vector<uint8_t> > remote_buffers_;
+};
+
+namespace {
+
+/// @brief The caches of the exited threads, kept for the next threads.
+///
+/// Blocks and buffers in use can be given back to the caches of their
+/// thread after it exited, so the caches are never deleted. They are
+/// allocated on first use and never destroyed, so threads can still
+/// exit during the static destruction.
+struct ParkedCaches {
+    /// @brief Mutex protecting the parked caches.
+    std::mutex mutex_;
+
+    /// @brief The parked caches.
+    std::vector<ThreadCaches*> caches_;
+};
+
+/// @brief Returns the caches of the exited threads.
+ParkedCaches&
+getParkedCaches() {
+    static ParkedCaches* parked = new ParkedCaches();
+    return (*parked);
+}
+
+/// @brief The caches of the calling thread, created on first use.
+///
+/// This pointer is trivially destructible, so it can still be read while
+/// the thread exits, after @c reaper has been destroyed.
+thread_local ThreadCaches* caches = 0;
+
+/// @brief Set when the calling thread released its caches.
+thread_local bool exited = false;
+
+/// @brief Releases the caches of a thread when it exits.
+struct Reaper {
+    /// @brief Destructor.
+    ///
+    /// Frees the cached memory and parks the caches.
+    ~Reaper() {
+        if (caches) {
+            caches->clearBlocks();
+            caches->clearBuffers();
+            try {
+                ParkedCaches& parked = getParkedCaches();
+                std::lock_guard<std::mutex> lock(parked.mutex_);
+                parked.caches_.push_back(caches);
+            } catch (...) {
+                // The caches can't be parked: keep them allocated.
+            }
+        }
+        caches = 0;
+        exited = true;
+    }
+};
+
+/// @brief The reaper of the calling thread.
+thread_local Reaper reaper;
+
+/// @brief Returns the caches of the calling thread.
+///
+/// The caches of an exited thread are reused when there are some.
+///
+/// @return The caches or null when the thread is exiting.
+ThreadCaches*
+getCaches() {
+    if (!caches && !exited) {
+        {
+            ParkedCaches& parked = getParkedCaches();
+            std::lock_guard<std::mutex> lock(parked.mutex_);
+            if (!parked.caches_.empty()) {
+                caches = parked.caches_.back();
+                parked.caches_.pop_back();
+            }
+        }
+        if (!caches) {
+            caches = new ThreadCaches();
+        }
+        // Touch the reaper so its destructor runs at thread exit.
+        (void)&reaper;
+    }
+    return (caches);
+}
+
+}
+
+void*
+ThreadBlockCache::allocate(size_t size) {
+    if (size == 0) {
+        size = 1;
+    }
+    if (size > MAX_BLOCK_SIZE) {
+        return (::operator new(size));
+    }
+    size_t index = sizeClass(size);
+    ThreadCaches* thread_caches = getCaches();
+    BlockHeader* block = 0;
+    if (thread_caches) {
+        block = thread_caches->popBlock(index);
+    }
+    if (!block) {
+        // Allocate the full size class so the block can serve any size of it.
+        block = static_cast<BlockHeader*>(::operator new(HEADER_SIZE +
+                                                         (index + 1) * GRANULARITY));
+        block->owner_ = thread_caches;
+    }
+    return (getBlock(block));
+}
+
+void
+ThreadBlockCache::deallocate(void* ptr, size_t size) noexcept {
+    if (!ptr) {
+        return;
+    }
+    if (size == 0) {
+        size = 1;
+    }
+    if (size > MAX_BLOCK_SIZE) {
+        ::operator delete(ptr);
+        return;
+    }
+    BlockHeader* block = getHeader(ptr);
+    ThreadCaches* owner = block->owner_;
+    if (!owner) {
+        ::operator delete(block);
+        return;
+    }
+    size_t index = sizeClass(size);
+    ThreadCaches* thread_caches = 0;
+    try {
+        thread_caches = getCaches();
+    } catch (...) {
+        // Can't get the caches: the block goes to its owner.
+    }
+    if (owner == thread_caches) {
+        thread_caches->pushBlock(index, block);
+    } else {
+        owner->pushRemoteBlock(index, block);
+    }
+}
+
+size_t
+ThreadBlockCache::getCachedBlocks() {
+    size_t count = 0;
+    ThreadCaches* thread_caches = getCaches();
+    if (thread_caches) {
+        for (size_t i = 0; i < SIZE_CLASSES; ++i) {
+            count += thread_caches->counts_[i];
+        }
+    }
+    return (count);
+}
+
+void
+ThreadBlockCache::clear() {
+    ThreadCaches* thread_caches = getCaches();
+    if (thread_caches) {
+        thread_caches->clearBlocks();
+    }
+}
+
+ThreadCaches*
+ThreadBufferCache::assign(std::vector<uint8_t>& buffer, const uint8_t* data,
+                          size_t len) {
+    ThreadCaches* thread_caches = getCaches();
+    if (thread_caches && (buffer.capacity() < len)) {
+        std::vector<std::vector<uint8_t> >& buffers = thread_caches->buffers_;
+        if (buffers.empty()) {
+            thread_caches->takeRemoteBuffers();
+        }
+        if (!buffers.empty()) {
+            // Prefer the most recently cached buffer which is large enough.
+            size_t i = buffers.size() - 1;
+            while ((i > 0) && (buffers[i].capacity() < len)) {
+                --i;
+            }
+            buffer.swap(buffers[i]);
+            buffers[i].swap(buffers.back());
+            buffers.pop_back();
+        }
+    }
+    buffer.assign(data, data + len);
+    return (thread_caches);
+}
+
+void
+ThreadBufferCache::release(std::vector<uint8_t>& buffer,
+                           ThreadCaches* owner) noexcept {
+    if ((buffer.capacity() == 0) || (buffer.capacity() > MAX_BUFFER_CAPACITY)) {
+        return;
+    }
+    try {
+        ThreadCaches* thread_caches = getCaches();
+        if (owner && (owner != thread_caches)) {
+            owner->pushRemoteBuffer(buffer);
+        } else if (thread_caches &&
+                   (thread_caches->buffers_.size() < MAX_CACHED_BUFFERS)) {
+            buffer.clear();
+            thread_caches->buffers_.push_back(std::vector<uint8_t>());
+            thread_caches->buffers_.back().swap(buffer);
+        }
+    } catch (...) {
+        // The buffer is freed with its owner.
+    }
+}
+
+size_t
+ThreadBufferCache::getCachedBuffers() {
+    ThreadCaches* thread_caches = getCaches();
+    return (thread_caches ? thread_caches->buffers_.size() : 0);
+}
+
+void
+ThreadBufferCache::clear() {
+    ThreadCaches* thread_caches = getCaches();
+    if (thread_caches) {
+        thread_caches->clearBuffers();
+    }
+}
+
+} // namespace util
+} // namespace isc
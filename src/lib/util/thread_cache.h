@@ -0,0 +1,192 @@
+// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef THREAD_CACHE_H
+#define THREAD_CACHE_H
+
+/// @file thread_cache.h Defines per-thread memory caches.
+
+#include <cstddef>
+#include <new>
+#include <stdint.h>
+#include <vector>
+
+namespace isc {
+namespace util {
+
+/// @brief The caches of a thread.
+///
+/// It is opaque to the users of the caches, which only use it to give
+/// memory back to the thread which allocated it.
+class ThreadCaches;
+
+/// @brief Per-thread cache of small memory blocks.
+///
+/// Objects which are created and destroyed for each packet, e.g. the
+/// packets, their options and the nodes of their option collections,
+/// get their memory from this cache. Freed blocks are kept in free
+/// lists of the calling thread, one list per size class, and handed out
+/// again without locking or calling the global allocator.
+///
+/// A block can be freed by another thread than the one which allocated
+/// it, e.g. a packet received by the receiver thread and processed by
+/// a packet processing thread. Each block records the caches of the
+/// thread which allocated it, so it is then pushed on a lock-free
+/// remote free list of that thread, which takes the whole list back
+/// when its own free list of the size class is empty. The number of
+/// cached blocks per size class is bounded, blocks above the bound are
+/// returned to the global allocator.
+///
+/// When a thread exits its cached blocks are released and its caches
+/// are kept for the next thread, so blocks still in use can always be
+/// given back to them.
+///
+/// Blocks larger than @c MAX_BLOCK_SIZE are not cached.
+class ThreadBlockCache {
+public:
+    /// @brief Size granularity of the size classes.
+    static const size_t GRANULARITY = 16;
+
+    /// @brief Largest size of the cached blocks.
+    static const size_t MAX_BLOCK_SIZE = 1024;
+
+    /// @brief Maximum number of cached blocks per size class and thread.
+    static const size_t MAX_CACHED_BLOCKS = 256;
+
+    /// @brief Allocates a block.
+    ///
+    /// @param size size of the block.
+    /// @return A pointer to the block.
+    /// @throw std::bad_alloc if the memory can't be allocated.
+    static void* allocate(size_t size);
+
+    /// @brief Frees a block.
+    ///
+    /// @param ptr pointer to the block, may be null.
+    /// @param size size of the block, as given to @c allocate.
+    static void deallocate(void* ptr, size_t size) noexcept;
+
+    /// @brief Returns the number of blocks cached by the calling thread.
+    ///
+    /// The blocks given back by other threads and not yet taken from
+    /// the remote free lists are not counted.
+    static size_t getCachedBlocks();
+
+    /// @brief Returns the blocks cached by the calling thread, including
+    /// the blocks given back by other threads, to the global allocator.
+    static void clear();
+};
+
+/// @brief Standard allocator drawing from the @c ThreadBlockCache.
+///
+/// It is meant for node based containers, e.g. the option collections.
+///
+/// @tparam T type of the allocated objects.
+template<typename T>
+class ThreadCacheAllocator {
+public:
+    /// @brief Type of the allocated objects.
+    typedef T value_type;
+
+    /// @brief Rebinds the allocator to another type.
+    template<typename U>
+    struct rebind {
+        /// @brief The rebound allocator.
+        typedef ThreadCacheAllocator<U> other;
+    };
+
+    /// @brief Constructor.
+    ThreadCacheAllocator() noexcept {
+    }
+
+    /// @brief Converting constructor.
+    template<typename U>
+    ThreadCacheAllocator(const ThreadCacheAllocator<U>&) noexcept {
+    }
+
+    /// @brief Allocates storage for objects.
+    ///
+    /// @param n number of objects.
+    /// @return A pointer to the storage.
+    T* allocate(size_t n) {
+        return (static_cast<T*>(ThreadBlockCache::allocate(n * sizeof(T))));
+    }
+
+    /// @brief Frees storage for objects.
+    ///
+    /// @param ptr pointer to the storage.
+    /// @param n number of objects.
+    void deallocate(T* ptr, size_t n) noexcept {
+        ThreadBlockCache::deallocate(ptr, n * sizeof(T));
+    }
+};
+
+/// @brief All thread cache allocators are interchangeable.
+template<typename T, typename U>
+bool operator==(const ThreadCacheAllocator<T>&, const ThreadCacheAllocator<U>&) {
+    return (true);
+}
+
+/// @brief All thread cache allocators are interchangeable.
+template<typename T, typename U>
+bool operator!=(const ThreadCacheAllocator<T>&, const ThreadCacheAllocator<U>&) {
+    return (false);
+}
+
+/// @brief Per-thread cache of data buffers.
+///
+/// Received packets copy their data into a vector. Instead of allocating
+/// a new vector for each packet, the vectors of destroyed packets are
+/// kept, with their capacity, and reused.
+///
+/// A buffer released by another thread than the one which filled it
+/// goes back to the filling thread, through a remote list protected by
+/// a mutex, which it takes back when it has no cached buffer left.
+class ThreadBufferCache {
+public:
+    /// @brief Largest capacity of the cached buffers.
+    static const size_t MAX_BUFFER_CAPACITY = 65536;
+
+    /// @brief Maximum number of cached buffers per thread.
+    static const size_t MAX_CACHED_BUFFERS = 64;
+
+    /// @brief Fills a buffer, reusing a cached buffer when possible.
+    ///
+    /// @param [out] buffer the buffer to fill, it should be empty.
+    /// @param data the data.
+    /// @param len the length of the data.
+    /// @return The caches of the calling thread, to be given to
+    /// @c release, or null when the thread is exiting.
+    static ThreadCaches* assign(std::vector<uint8_t>& buffer,
+                                const uint8_t* data, size_t len);
+
+    /// @brief Gives a buffer back to the cache of the thread which
+    /// filled it.
+    ///
+    /// The buffer is left empty.
+    ///
+    /// @param buffer the buffer.
+    /// @param owner the caches returned by @c assign, null for a buffer
+    /// which was not filled by @c assign: it then goes to the cache of
+    /// the calling thread.
+    static void release(std::vector<uint8_t>& buffer,
+                        ThreadCaches* owner) noexcept;
+
+    /// @brief Returns the number of buffers cached by the calling thread.
+    ///
+    /// The buffers given back by other threads and not yet taken from
+    /// the remote list are not counted.
+    static size_t getCachedBuffers();
+
+    /// @brief Frees the buffers cached by the calling thread, including
+    /// the buffers given back by other threads.
+    static void clear();
+};
+
+} // namespace util
+} // namespace isc
+
+#endif // THREAD_CACHE_H
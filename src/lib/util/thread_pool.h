@@ -1,4 +1,4 @@
-// Copyright (C) 2018-2020 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2018-2021 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -11,14 +11,17 @@
 #include <boost/make_shared.hpp>
 #include <boost/shared_ptr.hpp>
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <cmath>
 #include <condition_variable>
+#include <functional>
 #include <list>
 #include <mutex>
 #include <queue>
 #include <thread>
+#include <vector>
 
 namespace isc {
 namespace util {
@@ -26,6 +29,11 @@ namespace util {
 /// @brief Defines a thread pool which uses a thread pool queue for managing
 /// work items. Each work item is a 'functor' object.
 ///
+/// By default all threads share a single queue. With affinity enabled each
+/// thread has its own queue: the work items added with a key are always
+/// added to the queue of the thread selected by the key so the work items
+/// with the same key are processed in order by the same thread.
+///
 /// @tparam WorkItem a functor
 /// @tparam Container a 'queue like' container
 template <typename WorkItem, typename Container = std::deque<boost::shared_ptr<WorkItem>>>
@@ -43,7 +51,7 @@ struct ThreadPool {
     typedef typename boost::shared_ptr<WorkItem> WorkItemPtr;
 
     /// @brief Constructor
-    ThreadPool() {
+    ThreadPool() : affinity_(false), next_queue_(0) {
     }
 
     /// @brief Destructor
@@ -58,6 +66,7 @@ struct ThreadPool {
     void reset() {
         stopInternal();
         queue_.clear();
+        affinity_queues_.clear();
     }
 
     /// @brief start all the threads
@@ -87,13 +96,77 @@ struct ThreadPool {
         stopInternal();
     }
 
+    /// @brief enable or disable the thread affinity
+    ///
+    /// The thread affinity takes effect when the thread pool is started.
+    ///
+    /// @param affinity true if each thread has its own queue, false if
+    /// the threads share a single queue
+    /// @throw InvalidOperation if thread pool already started
+    void setAffinity(bool affinity) {
+        if (queue_.enabled()) {
+            isc_throw(InvalidOperation, "thread pool already started");
+        }
+        affinity_ = affinity;
+    }
+
+    /// @brief get the thread affinity
+    ///
+    /// @return true if each thread has its own queue, false otherwise
+    bool getAffinity() const {
+        return (affinity_);
+    }
+
     /// @brief add a work item to the thread pool
     ///
+    /// With affinity the work items without key are spread over the
+    /// threads in turn.
+    ///
     /// @param item the 'functor' object to be added to the queue
     /// @return false if the queue was full and oldest item(s) was dropped,
     /// true otherwise.
     bool add(const WorkItemPtr& item) {
-        return (queue_.pushBack(item));
+        if (affinity_queues_.empty()) {
+            return (queue_.pushBack(item));
+        }
+        return (nextQueue().pushBack(item));
+    }
+
+    /// @brief add a work item to the queue of the thread selected by a key
+    ///
+    /// Without affinity the work item is added to the shared queue.
+    ///
+    /// @param item the 'functor' object to be added to the queue
+    /// @param key the key selecting the thread, e.g. a hash of the client
+    /// identity
+    /// @return false if the queue was full and oldest item(s) was dropped,
+    /// true otherwise.
+    bool add(const WorkItemPtr& item, size_t key) {
+        if (affinity_queues_.empty()) {
+            return (queue_.pushBack(item));
+        }
+        return (affinity_queues_[key % affinity_queues_.size()]->pushBack(item));
+    }
+
+    /// @brief add a batch of work items to the thread pool
+    ///
+    /// The items are added in order under a single lock of the queue.
+    /// With affinity they are spread over the threads in turn.
+    ///
+    /// @param items the 'functor' objects to be added to the queue
+    /// @return false if the queue was full and oldest item(s) was dropped,
+    /// true otherwise.
+    bool add(const std::vector<WorkItemPtr>& items) {
+        if (affinity_queues_.empty()) {
+            return (queue_.pushBack(items));
+        }
+        bool ret = true;
+        for (auto const& item : items) {
+            if (!nextQueue().pushBack(item)) {
+                ret = false;
+            }
+        }
+        return (ret);
     }
 
     /// @brief add a work item to the thread pool at front
@@ -101,14 +174,56 @@ struct ThreadPool {
     /// @param item the 'functor' object to be added to the queue
     /// @return false if the queue was full, true otherwise.
     bool addFront(const WorkItemPtr& item) {
-        return (queue_.pushFront(item));
+        if (affinity_queues_.empty()) {
+            return (queue_.pushFront(item));
+        }
+        return (nextQueue().pushFront(item));
     }
 
     /// @brief count number of work items in the queue
     ///
-    /// @return the number of work items in the queue
+    /// @return the number of work items in the queue(s)
     size_t count() {
-        return (queue_.count());
+        size_t count = queue_.count();
+        for (auto const& queue : affinity_queues_) {
+            count += queue->count();
+        }
+        return (count);
+    }
+
+    /// @brief get the number of work items added to each thread queue
+    ///
+    /// @return the number of work items added to the queue of each thread
+    /// since the thread pool was started with affinity, empty without
+    /// affinity
+    std::vector<uint64_t> getAffinityCounts() {
+        std::vector<uint64_t> counts;
+        for (auto const& queue : affinity_queues_) {
+            counts.push_back(queue->getAddedCount());
+        }
+        return (counts);
+    }
+
+    /// @brief get the imbalance of the thread queues
+    ///
+    /// The imbalance is the ratio of the largest number of work items added
+    /// to a thread queue to the average number: 1 means the work items are
+    /// evenly spread, the number of threads means they all went to the same
+    /// thread.
+    ///
+    /// @return the imbalance, 1 without affinity or without work item
+    double getAffinityImbalance() {
+        std::vector<uint64_t> counts = getAffinityCounts();
+        uint64_t total = 0;
+        uint64_t largest = 0;
+        for (auto count : counts) {
+            total += count;
+            largest = std::max(largest, count);
+        }
+        if (!total) {
+            return (1.);
+        }
+        return (static_cast<double>(largest) * counts.size() / total);
     }
 
     /// @brief wait for current items to be processed
@@ -121,6 +236,9 @@ struct ThreadPool {
             isc_throw(InvalidOperation, "thread pool stop called by owned thread");
         }
         queue_.wait();
+        for (auto const& queue : affinity_queues_) {
+            queue->wait();
+        }
     }
 
     /// @brief wait for items to be processed or return after timeout
@@ -135,14 +253,29 @@ struct ThreadPool {
         if (checkThreadId(id)) {
             isc_throw(InvalidOperation, "thread pool stop called by owned thread");
         }
-        return (queue_.wait(seconds));
+        auto deadline = std::chrono::steady_clock::now() +
+            std::chrono::seconds(seconds);
+        if (!queue_.waitUntil(deadline)) {
+            return (false);
+        }
+        for (auto const& queue : affinity_queues_) {
+            if (!queue->waitUntil(deadline)) {
+                return (false);
+            }
+        }
+        return (true);
     }
 
     /// @brief set maximum number of work items in the queue
     ///
+    /// With affinity the maximum applies to the queue of each thread.
+    ///
     /// @param max_queue_size the maximum size (0 means unlimited)
     void setMaxQueueSize(size_t max_queue_size) {
         queue_.setMaxQueueSize(max_queue_size);
+        for (auto const& queue : affinity_queues_) {
+            queue->setMaxQueueSize(max_queue_size);
+        }
     }
 
     /// @brief get maximum number of work items in the queue
@@ -161,22 +294,70 @@ struct ThreadPool {
 
     /// @brief get queue length statistic
     ///
+    /// With affinity the statistic is the sum of the statistics of the
+    /// thread queues.
+    ///
     /// @param which select the statistic (10, 100 or 1000)
     /// @return the queue length statistic
     /// @throw InvalidParameter if which is not 10 and 100 and 1000.
     double getQueueStat(size_t which) {
-        return (queue_.getQueueStat(which));
+        if (affinity_queues_.empty()) {
+            return (queue_.getQueueStat(which));
+        }
+        double stat = 0.;
+        for (auto const& queue : affinity_queues_) {
+            stat += queue->getQueueStat(which);
+        }
+        return (stat);
     }
 
 private:
     /// @brief start all the threads
     ///
+    /// With affinity one queue is created per thread and the pending work
+    /// items are spread over them. Without affinity the pending work items
+    /// of the thread queues are moved back to the shared queue.
+    ///
     /// @param thread_count specifies the number of threads to be created and
     /// started
     void startInternal(uint32_t thread_count) {
-        queue_.enable(thread_count);
+        if (!affinity_) {
+            for (auto const& queue : affinity_queues_) {
+                for (auto const& item : queue->takeAll()) {
+                    queue_.pushBack(item);
+                }
+            }
+            affinity_queues_.clear();
+            queue_.enable(thread_count);
+            for (uint32_t i = 0; i < thread_count; ++i) {
+                threads_.push_back(boost::make_shared<std::thread>(&ThreadPool::run, this,
+                                                                   std::ref(queue_)));
+            }
+            return;
+        }
+
+        std::vector<WorkItemPtr> items = queue_.takeAll();
+        if (affinity_queues_.size() != thread_count) {
+            for (auto const& queue : affinity_queues_) {
+                std::vector<WorkItemPtr> pending = queue->takeAll();
+                items.insert(items.end(), pending.begin(), pending.end());
+            }
+            affinity_queues_.clear();
+            for (uint32_t i = 0; i < thread_count; ++i) {
+                auto queue = boost::make_shared<ThreadPoolQueue<WorkItemPtr, Container>>();
+                queue->setMaxQueueSize(queue_.getMaxQueueSize());
+                affinity_queues_.push_back(queue);
+            }
+        }
+        for (auto const& item : items) {
+            nextQueue().pushBack(item);
+        }
+        // The shared queue is enabled only to mark the pool as started.
+        queue_.enable(0);
         for (uint32_t i = 0; i < thread_count; ++i) {
-            threads_.push_back(boost::make_shared<std::thread>(&ThreadPool::run, this));
+            affinity_queues_[i]->enable(1);
+            threads_.push_back(boost::make_shared<std::thread>(&ThreadPool::run, this,
+                                                               std::ref(*affinity_queues_[i])));
         }
     }
 
@@ -187,6 +368,9 @@ private:
             isc_throw(InvalidOperation, "thread pool stop called by owned thread");
         }
         queue_.disable();
+        for (auto const& queue : affinity_queues_) {
+            queue->disable();
+        }
         for (auto thread : threads_) {
             thread->join();
         }
@@ -222,7 +406,7 @@ private:
         ///
         /// Creates the thread pool queue in 'disabled' state
         ThreadPoolQueue()
-            : enabled_(false), max_queue_size_(0), working_(0),
+            : enabled_(false), max_queue_size_(0), working_(0), added_(0),
               stat10(0.), stat100(0.), stat1000(0.) {
         }
 
@@ -275,12 +459,53 @@ private:
                     }
                 }
                 queue_.push_back(item);
+                ++added_;
             }
             // Notify pop function so that it can effectively remove a work item.
             cv_.notify_one();
             return (ret);
         }
 
+        /// @brief push a batch of work items to the queue
+        ///
+        /// Used to add several work items to the queue with a single lock.
+        /// When the queue is full oldest items are removed and false is
+        /// returned.
+        /// This function wakes up at least one thread waiting on the queue
+        /// for each added item.
+        ///
+        /// @param items the new items to be added to the queue
+        /// @return false if the queue was full and oldest item(s) dropped,
+        /// true otherwise
+        bool pushBack(const std::vector<Item>& items) {
+            bool ret = true;
+            size_t count = 0;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (auto const& item : items) {
+                    if (!item) {
+                        continue;
+                    }
+                    if (max_queue_size_ != 0) {
+                        while (queue_.size() >= max_queue_size_) {
+                            queue_.pop_front();
+                            ret = false;
+                        }
+                    }
+                    queue_.push_back(item);
+                    ++count;
+                }
+                added_ += count;
+            }
+            // Notify pop function so that it can effectively remove work items.
+            if (count > 1) {
+                cv_.notify_all();
+            } else if (count == 1) {
+                cv_.notify_one();
+            }
+            return (ret);
+        }
+
         /// @brief push work item to the queue at front.
         ///
         /// Used to add work items to the queue at front.
@@ -299,6 +524,7 @@ private:
                     return (false);
                 }
                 queue_.push_front(item);
+                ++added_;
             }
             // Notify pop function so that it can effectively remove a work item.
             cv_.notify_one();
@@ -347,6 +573,25 @@ private:
             return (queue_.size());
         }
 
+        /// @brief count number of work items added to the queue
+        ///
+        /// @return the number of work items added since the queue was
+        /// created or cleared
+        uint64_t getAddedCount() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return (added_);
+        }
+
+        /// @brief remove all work items and return them
+        ///
+        /// @return the work items in the queue order
+        std::vector<Item> takeAll() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::vector<Item> items(queue_.begin(), queue_.end());
+            queue_ = QueueContainer();
+            return (items);
+        }
+
         /// @brief wait for current items to be processed
         ///
         /// Used to block the calling thread until all items in the queue have
@@ -372,6 +617,18 @@ private:
             return (ret);
         }
 
+        /// @brief wait for items to be processed or return at a deadline
+        ///
+        /// @param deadline the time at which to stop waiting
+        /// @return true if all tasks finished, false on timeout
+        bool waitUntil(std::chrono::steady_clock::time_point deadline) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            // Wait for any item or for working threads to finish.
+            bool ret = wait_cv_.wait_until(lock, deadline,
+                                           [&]() {return (working_ == 0 && queue_.empty());});
+            return (ret);
+        }
+
         /// @brief get queue length statistic
         ///
         /// @param which select the statistic (10, 100 or 1000)
@@ -399,6 +656,7 @@ private:
             std::lock_guard<std::mutex> lock(mutex_);
             queue_ = QueueContainer();
             working_ = 0;
+            added_ = 0;
             wait_cv_.notify_all();
         }
 
@@ -459,6 +717,9 @@ private:
         /// @brief number of threads currently doing work
         uint32_t working_;
 
+        /// @brief number of work items added to the queue
+        uint64_t added_;
+
         /// @brief queue length statistic for 10 packets
         double stat10;
 
@@ -469,10 +730,19 @@ private:
         double stat1000;
     };
 
+    /// @brief return the next thread queue in turn
+    ///
+    /// @return the queue of the next thread
+    ThreadPoolQueue<WorkItemPtr, Container>& nextQueue() {
+        return (*affinity_queues_[next_queue_++ % affinity_queues_.size()]);
+    }
+
     /// @brief run function of each thread
-    void run() {
-        while (queue_.enabled()) {
-            WorkItemPtr item = queue_.pop();
+    ///
+    /// @param queue the queue the thread takes the work items from
+    void run(ThreadPoolQueue<WorkItemPtr, Container>& queue) {
+        while (queue.enabled()) {
+            WorkItemPtr item = queue.pop();
             if (item) {
                 try {
                     (*item)();
@@ -488,6 +758,15 @@ private:
 
     /// @brief underlying work items queue
     ThreadPoolQueue<WorkItemPtr, Container> queue_;
+
+    /// @brief the thread affinity flag
+    bool affinity_;
+
+    /// @brief the queues of the threads when the thread affinity is enabled
+    std::vector<boost::shared_ptr<ThreadPoolQueue<WorkItemPtr, Container>>> affinity_queues_;
+
+    /// @brief the next thread queue for the work items without key
+    std::atomic<size_t> next_queue_;
 };
 
 /// Initialize the 10 packet rounding to exp(-.1)
@@ -0,0 +1,94 @@
+// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <util/watch_event.h>
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#if defined (OS_LINUX)
+#include <sys/eventfd.h>
+#endif
+
+namespace isc {
+namespace util {
+
+WatchEvent::WatchEvent()
+    : source_(WatchSocket::SOCKET_NOT_VALID),
+      sink_(WatchSocket::SOCKET_NOT_VALID), ready_(false) {
+#if defined (OS_LINUX)
+    sink_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (sink_ < 0) {
+        const char* errstr = strerror(errno);
+        isc_throw(WatchSocketError, "Cannot construct eventfd: " << errstr);
+    }
+    source_ = sink_;
+#else
+    int fds[2];
+    if (pipe(fds)) {
+        const char* errstr = strerror(errno);
+        isc_throw(WatchSocketError, "Cannot construct pipe: " << errstr);
+    }
+    source_ = fds[1];
+    sink_ = fds[0];
+
+    for (int fd : { source_, sink_ }) {
+        if (fcntl(fd, F_SETFD, FD_CLOEXEC) ||
+            fcntl(fd, F_SETFL, O_NONBLOCK)) {
+            const char* errstr = strerror(errno);
+            close(source_);
+            close(sink_);
+            isc_throw(WatchSocketError, "Cannot set pipe flags: " << errstr);
+        }
+    }
+#endif
+}
+
+WatchEvent::~WatchEvent() {
+    if (source_ != sink_) {
+        close(source_);
+    }
+    close(sink_);
+}
+
+void
+WatchEvent::markReady() {
+    if (ready_.exchange(true)) {
+        // Already marked: the consumer has not been woken up yet.
+        return;
+    }
+    // An eventfd is written with an 8 bytes counter increment.
+    uint64_t value = 1;
+    if (write(source_, &value, sizeof(value)) < 0) {
+        // A full pipe (or eventfd counter) is readable anyway.
+        if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+            const char* errstr = strerror(errno);
+            isc_throw(WatchSocketError, "WatchEvent markReady failed: "
+                      << errstr);
+        }
+    }
+}
+
+void
+WatchEvent::clearReady() {
+    ready_ = false;
+    // Reading an eventfd resets its counter. A pipe may hold several
+    // markers after a race so it is read until it is empty.
+    uint64_t value;
+    while (read(sink_, &value, sizeof(value)) > 0) {
+        if (source_ == sink_) {
+            break;
+        }
+    }
+}
+
+} // namespace isc::util
+} // namespace isc
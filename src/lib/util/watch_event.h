@@ -0,0 +1,98 @@
+// Copyright (C) 2021 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef WATCH_EVENT_H
+#define WATCH_EVENT_H
+
+/// @file watch_event.h Defines the class, WatchEvent.
+
+#include <util/watch_socket.h>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <atomic>
+
+namespace isc {
+namespace util {
+
+/// @brief Provides a coalescing "ready" notification for use with select()
+/// or epoll().
+///
+/// Like @c WatchSocket, WatchEvent exposes a single file descriptor, the
+/// "select-fd", which can be marked as ready to read and cleared. It is
+/// meant to be marked by a producer thread and cleared by a consumer
+/// thread, e.g. to notify the consumer that packets were queued.
+///
+/// The ready state is tracked by an atomic flag, so marking an already
+/// ready event and testing it do not make any system call: a burst of
+/// notifications costs a single write. On Linux the select-fd is an
+/// eventfd, on other systems the read end of a non-blocking pipe.
+///
+/// The descriptor may be left readable while the flag is cleared when a
+/// mark and a clear race. This only causes a spurious wake up: the next
+/// @c clearReady drains it. On the other hand a consumer which finds
+/// nothing to do after a wake up must check again for work after calling
+/// @c clearReady, as a mark made in between may have been absorbed.
+class WatchEvent : public boost::noncopyable {
+public:
+    /// @brief Constructor
+    ///
+    /// Constructs an instance of the WatchEvent in the cleared state.
+    ///
+    /// @throw WatchSocketError if the descriptors can't be created.
+    WatchEvent();
+
+    /// @brief Destructor
+    ///
+    /// Closes the descriptors.
+    virtual ~WatchEvent();
+
+    /// @brief Marks the select-fd as ready to read.
+    ///
+    /// Does nothing if the event is already marked. This method can be
+    /// called from any thread.
+    ///
+    /// @throw WatchSocketError if the descriptor can't be written.
+    void markReady();
+
+    /// @brief Returns true if the event is marked as ready.
+    ///
+    /// This method does not make any system call and does not throw.
+    bool isReady() const {
+        return (ready_);
+    }
+
+    /// @brief Clears the ready marker.
+    ///
+    /// The select-fd is drained even if the event is not marked, so a
+    /// descriptor left readable by a race is cleared too.
+    void clearReady();
+
+    /// @brief Returns the file descriptor to use to monitor the event.
+    int getSelectFd() const {
+        return (sink_);
+    }
+
+private:
+    /// @brief The descriptor to which the marker is written.
+    /// It is the same as the sink with an eventfd.
+    int source_;
+
+    /// @brief The descriptor from which the marker is read.
+    int sink_;
+
+    /// @brief The ready state.
+    std::atomic<bool> ready_;
+};
+
+/// @brief Defines a smart pointer to an instance of a WatchEvent.
+typedef boost::shared_ptr<WatchEvent> WatchEventPtr;
+
+} // namespace isc::util
+} // namespace isc
+
+#endif // WATCH_EVENT_H